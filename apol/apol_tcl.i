@@ -307,14 +307,28 @@ static char *tcl_get_error(void)
 		free(s);
 		return t;
 	}
+	/* The GUI renders rule listings one rule at a time, so keep a
+	 * single buffer for the rule renderers to reuse rather than
+	 * allocating a string per rule.  Tcl calls into this extension
+	 * from only one thread. */
+	static char *apol_tcl_render_buf = NULL;
+	static size_t apol_tcl_render_buf_sz = 0;
+	static char *apol_tcl_render_buf_to_new(int retval) {
+		if (retval < 0) {
+			return new char[0];
+		}
+		char *t = new char[strlen(apol_tcl_render_buf) + 1];
+		strcpy(t, apol_tcl_render_buf);
+		return t;
+	}
 	char *apol_tcl_avrule_render(apol_policy_t *policy, qpol_avrule_t *rule) {
-		return apol_tcl_malloc_to_new(apol_avrule_render(policy, rule));
+		return apol_tcl_render_buf_to_new(apol_avrule_render_buf(policy, rule, &apol_tcl_render_buf, &apol_tcl_render_buf_sz));
 	}
 	char *apol_tcl_terule_render(apol_policy_t *policy, qpol_terule_t *rule) {
-		return apol_tcl_malloc_to_new(apol_terule_render(policy, rule));
+		return apol_tcl_render_buf_to_new(apol_terule_render_buf(policy, rule, &apol_tcl_render_buf, &apol_tcl_render_buf_sz));
 	}
 	char *apol_tcl_syn_avrule_render(apol_policy_t *policy, qpol_syn_avrule_t *rule) {
-		return apol_tcl_malloc_to_new(apol_syn_avrule_render(policy, rule));
+		return apol_tcl_render_buf_to_new(apol_syn_avrule_render_buf(policy, rule, &apol_tcl_render_buf, &apol_tcl_render_buf_sz));
 	}
 
 	char *apol_tcl_syn_terule_render(apol_policy_t *policy, qpol_syn_terule_t *rule) {
@@ -0,0 +1,110 @@
+/**
+ * @file
+ *
+ * Routines to compute the effective access between types, directly
+ * from the policy's access vector tables rather than by searching
+ * and expanding individual rules.
+ *
+ * @author agent agent@local
+ *
+ * Copyright (C) 2026 agent
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef APOL_ACCESS_QUERY_H
+#define APOL_ACCESS_QUERY_H
+
+#ifdef	__cplusplus
+extern "C"
+{
+#endif
+
+#include "policy.h"
+#include "vector.h"
+#include <qpol/policy.h>
+#include <qpol/avrule_query.h>
+
+	typedef struct apol_access_matrix apol_access_matrix_t;
+
+/**
+ * Compute the effective access one type has to another upon an
+ * object class.  All allow, auditallow, and dontaudit rules that
+ * apply to the two types, whether directly or through attributes,
+ * are combined; conditional rules count only if currently enabled.
+ * The policy must have been loaded with rules.
+ *
+ * @param p Policy in which to compute access.
+ * @param src Name of the source type.  This may be an alias but not
+ * an attribute.
+ * @param tgt Name of the target type.  This may be an alias but not
+ * an attribute.
+ * @param obj_class Name of the object class.
+ * @param access Structure in which to store the access vectors.  Bit
+ * (value - 1) is set for each permission; use
+ * qpol_class_get_perm_iter() to map them back to names.
+ *
+ * @return 0 on success, negative on error.
+ */
+	extern int apol_access_compute(const apol_policy_t * p, const char *src, const char *tgt, const char *obj_class,
+				       qpol_access_t * access);
+
+/**
+ * Compute the effective access for every combination of source type,
+ * target type, and object class.  Names are looked up once, and the
+ * (source, target) pairs are divided among several threads.
+ *
+ * @param p Policy in which to compute access.
+ * @param sources Vector of source type names.
+ * @param targets Vector of target type names.
+ * @param classes Vector of object class names.
+ * @param num_threads Number of threads to use; if 0, use one per
+ * online processor.
+ * @param m Reference to the computed matrix.  The caller must call
+ * apol_access_matrix_destroy() afterwards.  This will be set to NULL
+ * upon error.
+ *
+ * @return 0 on success, negative on error.
+ */
+	extern int apol_access_compute_matrix(const apol_policy_t * p, const apol_vector_t * sources, const apol_vector_t * targets,
+					      const apol_vector_t * classes, unsigned int num_threads, apol_access_matrix_t ** m);
+
+/**
+ * Get an entry from an access matrix.
+ *
+ * @param m Matrix from which to get the entry.
+ * @param s Index into the source type vector given when computing.
+ * @param t Index into the target type vector given when computing.
+ * @param c Index into the class vector given when computing.
+ *
+ * @return Access vectors for the entry, or NULL if an index is out of
+ * range.  Do not free this pointer.
+ */
+	extern const qpol_access_t *apol_access_matrix_get(const apol_access_matrix_t * m, size_t s, size_t t, size_t c);
+
+/**
+ * Free all memory associated with an access matrix, and then set
+ * it to NULL.  This function does nothing if the matrix is already
+ * NULL.
+ *
+ * @param m Reference to a matrix to destroy.
+ */
+	extern void apol_access_matrix_destroy(apol_access_matrix_t ** m);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif
@@ -39,6 +39,7 @@ extern "C"
 
 	typedef int (apol_bst_comp_func) (const void *a, const void *b, void *data);
 	typedef void (apol_bst_free_func) (void *elem);
+	typedef size_t(apol_bst_hash_func) (const void *elem, void *data);
 
 #include "vector.h"
 
@@ -63,6 +64,30 @@ extern "C"
  */
 	extern apol_bst_t *apol_bst_create(apol_bst_comp_func * cmp, apol_bst_free_func * fr);
 
+/**
+ *  Allocate and initialize an empty BST that is implemented as a hash
+ *  table instead of a tree.  Insertion and lookup take constant
+ *  expected time, but elements are only put into order when the
+ *  caller asks for them via apol_bst_get_vector() or
+ *  apol_bst_inorder_map().  Use this when a large number of elements
+ *  are inserted and the sorted order is needed only at the end.
+ *
+ *  @param cmp A comparison call back, as per apol_bst_create().  When
+ *  the elements are being sorted the comparison function's third
+ *  parameter will be NULL.
+ *  @param hash Function that returns a hash value for an element.
+ *  Elements that compare equal must have the same hash value.  The
+ *  second parameter is the data passed to the insertion or lookup
+ *  function.  Must be non-NULL.
+ *  @param fr Function to call when destroying the BST, as per
+ *  apol_bst_create().
+ *
+ *  @return A pointer to a newly created BST on success and NULL on
+ *  failure.  If the call fails, errno will be set.  The caller is
+ *  responsible for calling apol_bst_destroy() to free memory used.
+ */
+	extern apol_bst_t *apol_bst_create_hashed(apol_bst_comp_func * cmp, apol_bst_hash_func * hash, apol_bst_free_func * fr);
+
 /**
  *  Free a BST and any memory used by it.  This will recursively
  *  invoke the free function that was stored within the tree when it
@@ -155,6 +180,22 @@ extern "C"
  */
 	extern int apol_bst_insert_and_get(apol_bst_t * b, void **elem, void *data);
 
+/**
+ *  Remove an element from the BST.
+ *
+ *  @param b The BST from which to remove the element.
+ *  @param elem The element to remove.  (This will be the second
+ *  parameter to the comparison function given in apol_bst_create().)
+ *  @param data Arbitrary data to pass as the comparison function's
+ *  third paramater.
+ *  @param result If not NULL, location to write the removed element;
+ *  the caller then owns that element.  If NULL then the element is
+ *  freed as per the BST's free function.
+ *
+ *  @return 0 if an element was removed, or < 0 if not found.
+ */
+	extern int apol_bst_remove(apol_bst_t * b, const void *elem, void *data, void **result);
+
 /**
  * Map a function across all the elements of the BST.  Mapping occurs in
  * the sorted order as defined by the original comparison function.
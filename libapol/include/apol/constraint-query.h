@@ -33,9 +33,13 @@ extern "C"
 
 #include "policy.h"
 #include "vector.h"
+#include "context-query.h"
+#include <qpol/policy.h>
 
 	typedef struct apol_constraint_query apol_constraint_query_t;
 	typedef struct apol_validatetrans_query apol_validatetrans_query_t;
+	typedef struct apol_constraint_engine apol_constraint_engine_t;
+	typedef struct apol_constraint_request apol_constraint_request_t;
 
 /******************** constraint queries ********************/
 
@@ -181,6 +185,160 @@ extern "C"
  */
 	extern int apol_validatetrans_query_set_regex(const apol_policy_t * p, apol_validatetrans_query_t * vt, int is_regex);
 
+/******************** constraint evaluation ********************/
+
+/**
+ * Compile every constraint and validatetrans statement within a
+ * policy into an engine that evaluates them against concrete
+ * contexts.  Each expression is compiled into a postfix program over
+ * user, role, type, and level values, so that evaluation needs no
+ * symbol lookups.  The engine is only valid as long as the policy is
+ * unmodified.
+ *
+ * @param p Policy whose constraints to compile.
+ *
+ * @return A newly allocated engine, or NULL upon error; errno will be
+ * set.  The caller must call apol_constraint_engine_destroy()
+ * afterwards.
+ */
+	extern apol_constraint_engine_t *apol_constraint_engine_create(const apol_policy_t * p);
+
+/**
+ * Deallocate all memory associated with a constraint engine, and then
+ * set it to NULL.  Constraints returned by
+ * apol_constraint_request_get_constraint() and
+ * apol_constraint_request_get_validatetrans() become invalid.  This
+ * function does nothing if the engine is already NULL.
+ *
+ * @param e Reference to an engine to destroy.
+ */
+	extern void apol_constraint_engine_destroy(apol_constraint_engine_t ** e);
+
+/**
+ * Evaluate a single request, checking it against every constraint
+ * upon its class and permission, or every validatetrans upon its
+ * class.  The outcome is stored within the request.
+ *
+ * @param p Policy from which the engine was created, to report errors.
+ * @param e Engine with which to evaluate.
+ * @param r Request to evaluate.
+ *
+ * @return 1 if the request is allowed, 0 if a statement denies it,
+ * or < 0 on error.
+ */
+	extern int apol_constraint_engine_check(const apol_policy_t * p, const apol_constraint_engine_t * e,
+						apol_constraint_request_t * r);
+
+/**
+ * Evaluate a batch of requests, dividing them among a number of
+ * threads.  The engine and the requests' contexts are only read
+ * while evaluating, so requests may be shared by several engines
+ * created from the same policy.
+ *
+ * @param p Policy from which the engine was created, to report errors.
+ * @param e Engine with which to evaluate.
+ * @param requests Vector of apol_constraint_request_t to evaluate.
+ * Each request's outcome is stored within it.
+ * @param num_threads Number of threads to use, or 0 to use one per
+ * online processor.
+ *
+ * @return 0 on success, < 0 on error; if the call fails, errno will
+ * be set and some requests may not have been evaluated.
+ */
+	extern int apol_constraint_engine_check_batch(const apol_policy_t * p, const apol_constraint_engine_t * e,
+						      const apol_vector_t * requests, unsigned int num_threads);
+
+/**
+ * Allocate and return a request to check whether a permission
+ * between two contexts is permitted by the policy's constraints.
+ * The contexts are resolved into values right away; they must have a
+ * user, role, and type, and if the policy is MLS a range whose
+ * levels are not literal.
+ *
+ * @param p Policy in which to look up symbols.
+ * @param scontext Source context.
+ * @param tcontext Target context.
+ * @param obj_class Name of the object class.
+ * @param perm Name of the permission upon the class.
+ *
+ * @return A newly allocated request, or NULL upon error; errno will
+ * be set.  The caller must call apol_constraint_request_destroy()
+ * afterwards.
+ */
+	extern apol_constraint_request_t *apol_constraint_request_create(const apol_policy_t * p,
+									 const apol_context_t * scontext,
+									 const apol_context_t * tcontext, const char *obj_class,
+									 const char *perm);
+
+/**
+ * Allocate and return a request to check whether a relabel from one
+ * context to another is permitted by the policy's validatetrans
+ * statements.  The contexts are resolved as for
+ * apol_constraint_request_create().
+ *
+ * @param p Policy in which to look up symbols.
+ * @param oldcontext Object's current context.
+ * @param newcontext Object's new context.
+ * @param taskcontext Context of the process doing the relabel.
+ * @param obj_class Name of the object class.
+ *
+ * @return A newly allocated request, or NULL upon error; errno will
+ * be set.  The caller must call apol_constraint_request_destroy()
+ * afterwards.
+ */
+	extern apol_constraint_request_t *apol_constraint_request_create_validatetrans(const apol_policy_t * p,
+										       const apol_context_t * oldcontext,
+										       const apol_context_t * newcontext,
+										       const apol_context_t * taskcontext,
+										       const char *obj_class);
+
+/**
+ * Deallocate all memory associated with a request, and then set it
+ * to NULL.  This function does nothing if the request is already
+ * NULL.
+ *
+ * @param r Reference to a request to destroy.
+ */
+	extern void apol_constraint_request_destroy(apol_constraint_request_t ** r);
+
+/**
+ * Free a request; suitable for passing to apol_vector_create().
+ *
+ * @param r Request to free.
+ */
+	extern void apol_constraint_request_free(void *r);
+
+/**
+ * Get the outcome of a request's last evaluation.
+ *
+ * @param r Request to query.
+ *
+ * @return 1 if allowed, 0 if denied, or < 0 if not yet evaluated.
+ */
+	extern int apol_constraint_request_get_result(const apol_constraint_request_t * r);
+
+/**
+ * Get the first constraint that denied a request.
+ *
+ * @param r Request to query.
+ *
+ * @return The denying constraint, or NULL if the request was allowed,
+ * not evaluated, or is a validatetrans request.  The constraint
+ * belongs to the engine that evaluated the request; do not free it.
+ */
+	extern const qpol_constraint_t *apol_constraint_request_get_constraint(const apol_constraint_request_t * r);
+
+/**
+ * Get the first validatetrans statement that denied a request.
+ *
+ * @param r Request to query.
+ *
+ * @return The denying statement, or NULL if the request was allowed,
+ * not evaluated, or is not a validatetrans request.  The statement
+ * belongs to the engine that evaluated the request; do not free it.
+ */
+	extern const qpol_validatetrans_t *apol_constraint_request_get_validatetrans(const apol_constraint_request_t * r);
+
 #ifdef	__cplusplus
 }
 #endif
@@ -37,6 +37,8 @@ extern "C"
 
 	typedef struct apol_domain_trans_analysis apol_domain_trans_analysis_t;
 	typedef struct apol_domain_trans_result apol_domain_trans_result_t;
+	typedef struct apol_domain_trans_path apol_domain_trans_path_t;
+	typedef struct apol_domain_trans_edge_list apol_domain_trans_edge_list_t;
 
 #define APOL_DOMAIN_TRANS_DIRECTION_FORWARD 0x01
 #define APOL_DOMAIN_TRANS_DIRECTION_REVERSE 0x02
@@ -45,6 +47,9 @@ extern "C"
 #define APOL_DOMAIN_TRANS_SEARCH_INVALID	0x02
 #define APOL_DOMAIN_TRANS_SEARCH_BOTH		(APOL_DOMAIN_TRANS_SEARCH_VALID|APOL_DOMAIN_TRANS_SEARCH_INVALID)
 
+#define APOL_DOMAIN_TRANS_PATH_REQUIRE_SETEXEC		0x01
+#define APOL_DOMAIN_TRANS_PATH_REQUIRE_TYPE_TRANS	0x02
+
 /******************* table operation functions ****************************/
 
 /**
@@ -68,7 +73,8 @@ extern "C"
  *  in a previous call.  If calls are to be considered independent or
  *  calls in a different direction are desired, call this function
  *  prior to apol_domain_trans_analysis_do().  If the table was not
- *  built yet then this function does nothing.
+ *  built yet then this function does nothing.  Resetting takes
+ *  constant time regardless of the size of the table.
  *
  *  @param policy Policy containing the table for which the state
  *  should be reset.
@@ -80,6 +86,36 @@ extern "C"
  */
 	extern void apol_domain_trans_table_reset(apol_policy_t * policy) __attribute__ ((deprecated));
 
+/**
+ *  Find every domain transition within a policy, from every domain,
+ *  building the domain transition table first if needed.  A
+ *  transition is reported for each entrypoint of each domain to which
+ *  a domain has process transition permission (or with no entrypoint
+ *  if the end domain has none), and for each process type_transition
+ *  rule.  Transitions from a domain to itself are not reported.
+ *
+ *  The table is only read, never modified, so this neither needs nor
+ *  affects apol_policy_reset_domain_trans_table().  Domains are
+ *  divided amongst several threads; the resulting list is sorted by
+ *  start type, end type, and then entrypoint type, and so does not
+ *  depend upon the number of threads.
+ *
+ *  @param policy Policy containing the table to search.
+ *  @param num_threads Number of threads to use, including the
+ *  calling thread, or 0 to use one per online processor.
+ *  @param edges Reference to the list of transitions found.  The
+ *  caller must call apol_domain_trans_edge_list_destroy() afterwards.
+ *  The list holds its own copy of everything it needs from the
+ *  table, so it remains valid after the table is reset or rebuilt;
+ *  the types it returns, however, belong to the policy and are
+ *  invalid once the policy is destroyed.  This will be set to NULL
+ *  upon error.
+ *  @return 0 on success and < 0 on failure; if the call fails,
+ *  errno will be set and *edges will be NULL.
+ */
+	extern int apol_policy_get_domain_trans_edges(apol_policy_t * policy, unsigned int num_threads,
+						      apol_domain_trans_edge_list_t ** edges);
+
 /*************** functions to do domain transition anslysis ***************/
 
 /**
@@ -239,6 +275,55 @@ extern "C"
 	extern int apol_domain_trans_analysis_append_perm(const apol_policy_t * policy, apol_domain_trans_analysis_t * dta,
 							  const char *perm_name);
 
+/**
+ *  Set the domain at which a multi-hop path search must end.  This
+ *  is only used by apol_domain_trans_analysis_do_paths(); the path
+ *  search begins at the type given to
+ *  apol_domain_trans_analysis_set_start_type().
+ *  @param policy Policy handler, to report errors.
+ *  @param dta Domain transition analysis to set.
+ *  @param type_name Name of the type at which paths end, or NULL to
+ *  clear a previously set end type.  This string will be duplicated.
+ *  @return 0 on success, and < 0 on error; if the call fails,
+ *  errno will be set and dta will be unchanged.
+ */
+	extern int apol_domain_trans_analysis_set_end_type(const apol_policy_t * policy, apol_domain_trans_analysis_t * dta,
+							   const char *type_name);
+
+/**
+ *  Set the maximum number of transitions a path found by
+ *  apol_domain_trans_analysis_do_paths() may have.  The default for
+ *  a newly created analysis is 0, meaning that paths of any length
+ *  are searched.
+ *  @param policy Policy handler, to report errors.
+ *  @param dta Domain transition analysis to set.
+ *  @param max_depth Maximum number of transitions in a path, or 0
+ *  for no limit.
+ *  @return 0 on success, and < 0 on error; if the call fails,
+ *  errno will be set and dta will be unchanged.
+ */
+	extern int apol_domain_trans_analysis_set_max_depth(const apol_policy_t * policy, apol_domain_trans_analysis_t * dta,
+							    unsigned int max_depth);
+
+/**
+ *  Set additional requirements that every transition within a path
+ *  found by apol_domain_trans_analysis_do_paths() must satisfy.  By
+ *  default a transition need only be valid (see
+ *  apol_domain_trans_table_verify_trans()).  If
+ *  APOL_DOMAIN_TRANS_PATH_REQUIRE_SETEXEC is set then the domain
+ *  being transitioned from must also have a setexec rule; if
+ *  APOL_DOMAIN_TRANS_PATH_REQUIRE_TYPE_TRANS is set then there must
+ *  also be a type_transition rule for the transition.
+ *  @param policy Policy handler, to report errors.
+ *  @param dta Domain transition analysis to set.
+ *  @param reqs Bit-wise or'ed set of APOL_DOMAIN_TRANS_PATH_REQUIRE_*
+ *  from above, or 0 for no additional requirements.
+ *  @return 0 on success, and < 0 on error; if the call fails,
+ *  errno will be set and dta will be unchanged.
+ */
+	extern int apol_domain_trans_analysis_set_path_requirements(const apol_policy_t * policy,
+								    apol_domain_trans_analysis_t * dta, unsigned int reqs);
+
 /**
  *  Execute a domain transition analysis against a particular policy.
  *  @param policy Policy containing the table to use.
@@ -255,6 +340,35 @@ extern "C"
 	extern int apol_domain_trans_analysis_do(apol_policy_t * policy, apol_domain_trans_analysis_t * dta,
 						 apol_vector_t ** results);
 
+/**
+ *  Find every shortest chain of valid domain transitions from the
+ *  analysis's start type to its end type.  The search is a breadth
+ *  first search over the domain transition table, which is built if
+ *  not already present.  Unlike apol_domain_trans_analysis_do() the
+ *  search does not consult or change the state of the table, thus
+ *  apol_policy_reset_domain_trans_table() need not be called
+ *  beforehand.  The direction, validity, result regex, and access
+ *  criteria of the analysis are not used.  A transition that may use
+ *  more than one entrypoint appears within separate paths, one for
+ *  each entrypoint.
+ *  @param policy Policy containing the table to use.
+ *  @param dta A non-NULL structure containing parameters for
+ *  analysis; both a start and an end type must be set.
+ *  @param paths A reference pointer to a vector of
+ *  apol_domain_trans_path_t.  The vector will be allocated by this
+ *  function.  The caller must call apol_vector_destroy() afterwards.
+ *  If the end type is not reachable within the maximum depth then
+ *  the vector will be empty.  This will be set to NULL upon error.
+ *  @return 0 on success and < 0 on failure; if the call fails,
+ *  errno will be set and *paths will be NULL.
+ *
+ *  @see apol_domain_trans_analysis_set_end_type()
+ *  @see apol_domain_trans_analysis_set_max_depth()
+ *  @see apol_domain_trans_analysis_set_path_requirements()
+ */
+	extern int apol_domain_trans_analysis_do_paths(apol_policy_t * policy, apol_domain_trans_analysis_t * dta,
+						       apol_vector_t ** paths);
+
 /***************** functions for accessing results ************************/
 
 /**
@@ -389,6 +503,86 @@ extern "C"
  */
 	extern void apol_domain_trans_result_destroy(apol_domain_trans_result_t ** res);
 
+/**
+ *  Return the number of transitions within a domain transition path.
+ *  @param path Domain transition path.
+ *  @return Number of transitions, or 0 on error.
+ */
+	extern size_t apol_domain_trans_path_get_length(const apol_domain_trans_path_t * path);
+
+/**
+ *  Return the vector of transitions within a domain transition path,
+ *  ordered from the path's start type to its end type.  This is a
+ *  vector of apol_domain_trans_result_t pointers, each of which is a
+ *  valid transition; the end type of each transition is the start
+ *  type of the next.  The caller <b>should not</b> call
+ *  apol_vector_destroy() upon the returned vector.
+ *  @param path Domain transition path.
+ *  @return Vector of transitions, or NULL on error.
+ */
+	extern const apol_vector_t *apol_domain_trans_path_get_steps(const apol_domain_trans_path_t * path);
+
+/**
+ *  Free all memory used by a domain transition edge list and set it
+ *  to NULL.
+ *  @param edges Reference pointer to the list to destroy.
+ */
+	extern void apol_domain_trans_edge_list_destroy(apol_domain_trans_edge_list_t ** edges);
+
+/**
+ *  Return the number of transitions within a domain transition edge
+ *  list.
+ *  @param edges Domain transition edge list.
+ *  @return Number of transitions, or 0 on error.
+ */
+	extern size_t apol_domain_trans_edge_list_get_size(const apol_domain_trans_edge_list_t * edges);
+
+/**
+ *  Return the start type of a transition within an edge list.
+ *  @param edges Domain transition edge list.
+ *  @param i Index of the transition, less than the list's size.
+ *  @return Start type, or NULL on error.
+ */
+	extern const qpol_type_t *apol_domain_trans_edge_list_get_start_type(const apol_domain_trans_edge_list_t * edges,
+									     size_t i);
+
+/**
+ *  Return the entrypoint type of a transition within an edge list.
+ *  @param edges Domain transition edge list.
+ *  @param i Index of the transition, less than the list's size.
+ *  @return Entrypoint type, or NULL on error or if the end type has
+ *  no entrypoint at all.
+ */
+	extern const qpol_type_t *apol_domain_trans_edge_list_get_entrypoint_type(const apol_domain_trans_edge_list_t * edges,
+										  size_t i);
+
+/**
+ *  Return the end type of a transition within an edge list.
+ *  @param edges Domain transition edge list.
+ *  @param i Index of the transition, less than the list's size.
+ *  @return End type, or NULL on error.
+ */
+	extern const qpol_type_t *apol_domain_trans_edge_list_get_end_type(const apol_domain_trans_edge_list_t * edges, size_t i);
+
+/**
+ *  Return the rules a transition within an edge list lacks, as would
+ *  apol_domain_trans_table_verify_trans().
+ *  @param edges Domain transition edge list.
+ *  @param i Index of the transition, less than the list's size.
+ *  @return 0 if the transition is valid, < 0 on error, or a bit-wise
+ *  or'ed set of APOL_DOMAIN_TRANS_RULE_* representing the missing
+ *  rules.
+ */
+	extern int apol_domain_trans_edge_list_get_missing_rules(const apol_domain_trans_edge_list_t * edges, size_t i);
+
+/**
+ *  Determine if a transition within an edge list is valid.
+ *  @param edges Domain transition edge list.
+ *  @param i Index of the transition, less than the list's size.
+ *  @return 0 if invalid or on error, and non-zero if valid.
+ */
+	extern int apol_domain_trans_edge_list_is_trans_valid(const apol_domain_trans_edge_list_t * edges, size_t i);
+
 /************************ utility functions *******************************/
 /* define the following for rule type */
 #define APOL_DOMAIN_TRANS_RULE_PROC_TRANS       0x01
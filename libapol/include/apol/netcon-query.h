@@ -144,6 +144,24 @@ extern "C"
  */
 	extern char *apol_portcon_render(const apol_policy_t * p, const qpol_portcon_t * portcon);
 
+/**
+ * Find the portcon that labels a port, as the kernel does: the first
+ * portcon, in policy order, of the given protocol whose range
+ * includes the port.  The first call builds an index of the policy's
+ * portcons and nodecons, after which each lookup takes logarithmic
+ * time.
+ *
+ * @param p Policy within which to look up portcons.
+ * @param proto Protocol number of the port, such as IPPROTO_TCP.
+ * @param port Port number to resolve.
+ * @param portcon Reference to the matching portcon, or NULL if no
+ * portcon matches (in which case the port is labeled by the port
+ * initial SID).  The portcon belongs to the policy; do not free it.
+ *
+ * @return 0 on success (including no match), negative on error.
+ */
+	extern int apol_portcon_resolve(const apol_policy_t * p, int proto, uint16_t port, const qpol_portcon_t ** portcon);
+
 /******************** netifcon queries ********************/
 
 /**
@@ -357,6 +375,28 @@ extern "C"
  */
 	extern char *apol_nodecon_render(const apol_policy_t * p, const qpol_nodecon_t * nodecon);
 
+/**
+ * Find the nodecon that labels an address, as the kernel does: the
+ * first nodecon, in policy order, of the same protocol for which the
+ * address under the nodecon's netmask equals the nodecon's address.
+ * The first call builds an index of the policy's portcons and
+ * nodecons; nodecons whose netmasks are prefixes are held within a
+ * prefix trie, so that each lookup takes time proportional to the
+ * address length.
+ *
+ * @param p Policy within which to look up nodecons.
+ * @param addr Address to resolve, in the format returned by
+ * apol_str_to_internal_ip().
+ * @param proto Protocol of the address, either QPOL_IPV4 or
+ * QPOL_IPV6.
+ * @param nodecon Reference to the matching nodecon, or NULL if no
+ * nodecon matches (in which case the address is labeled by the node
+ * initial SID).  The nodecon belongs to the policy; do not free it.
+ *
+ * @return 0 on success (including no match), negative on error.
+ */
+	extern int apol_nodecon_resolve(const apol_policy_t * p, const uint32_t * addr, int proto, const qpol_nodecon_t ** nodecon);
+
 #ifdef	__cplusplus
 }
 #endif
@@ -302,6 +302,26 @@ extern "C"
  */
 	extern char *apol_terule_render(const apol_policy_t * policy, const qpol_terule_t * rule);
 
+/**
+ *  Render a terule into a caller-supplied buffer, growing the buffer
+ *  only when it is too small.  Reusing one buffer across many calls
+ *  avoids allocating a string per rule.
+ *
+ *  @param policy Policy handler, to report errors.
+ *  @param rule The rule to render.
+ *  @param buf Reference to a buffer allocated with malloc(), or to
+ *  NULL to have one allocated.  Upon success the buffer holds the
+ *  rule's null-terminated string representation, identical to that
+ *  returned by apol_terule_render().  The buffer may be reallocated; the caller is
+ *  responsible for calling free() on it, even if this call fails.
+ *  @param buf_sz Reference to the number of bytes allocated to *buf.
+ *  This is updated if the buffer is reallocated.
+ *
+ *  @return 0 on success, or < 0 on failure; if the call fails, errno
+ *  will be set.
+ */
+	extern int apol_terule_render_buf(const apol_policy_t * policy, const qpol_terule_t * rule, char **buf, size_t * buf_sz);
+
 /**
  *  Render a syntactic terule to a string.
  *
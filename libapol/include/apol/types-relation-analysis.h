@@ -54,6 +54,7 @@ extern "C"
 	typedef struct apol_types_relation_analysis apol_types_relation_analysis_t;
 	typedef struct apol_types_relation_result apol_types_relation_result_t;
 	typedef struct apol_types_relation_access apol_types_relation_access_t;
+	typedef struct apol_types_relation_similarity apol_types_relation_similarity_t;
 
 /********** functions to do types relation analysis **********/
 
@@ -373,6 +374,93 @@ extern "C"
  */
 	extern const apol_vector_t *apol_types_relation_access_get_rules(const apol_types_relation_access_t * a);
 
+/********** functions to find similar types **********/
+
+/**
+ * Find the types whose accesses most resemble those of a given type.
+ * A type's accesses are the (target type, object class) pairs of
+ * the allow rules for which it is a source, with attributes expanded
+ * on both sides.  The similarity of two types is the number of
+ * accesses they share divided by the number of accesses either has.
+ * Only types sharing at least one access are returned.
+ *
+ * The first search builds an access signature of every type, which
+ * is kept with the policy for later searches.
+ *
+ * @param p Policy within which to look up types.
+ * @param type_name Name of the type to which to compare all others.
+ * @param max_results Maximum number of types to return, or 0 for no
+ * limit.
+ * @param results Reference to a vector of
+ * apol_types_relation_similarity_t, most similar first.  The vector
+ * will be allocated by this function.  The caller must call
+ * apol_vector_destroy() afterwards.  This will be set to NULL upon
+ * error.
+ *
+ * @return 0 on success, negative on error.
+ */
+	extern int apol_types_relation_find_similar(const apol_policy_t * p, const char *type_name, size_t max_results,
+						    apol_vector_t ** results);
+
+/**
+ * Find every pair of types whose accesses are at least a given
+ * similarity, as defined by apol_types_relation_find_similar().  This
+ * is useful for finding near-duplicate types across a whole policy.
+ * Each pair is returned once, with the type of lesser value first.
+ *
+ * @param p Policy within which to look up types.
+ * @param min_similarity Smallest similarity to report, greater than
+ * 0 and at most 1.
+ * @param results Reference to a vector of
+ * apol_types_relation_similarity_t, most similar first.  The vector
+ * will be allocated by this function.  The caller must call
+ * apol_vector_destroy() afterwards.  This will be set to NULL upon
+ * error.
+ *
+ * @return 0 on success, negative on error.
+ */
+	extern int apol_types_relation_find_similar_pairs(const apol_policy_t * p, double min_similarity, apol_vector_t ** results);
+
+/**
+ * Given a type similarity result, return the first type of the pair.
+ * For apol_types_relation_find_similar() this is the type searched
+ * for.
+ *
+ * @param s Type similarity result.
+ *
+ * @return Pointer to the first type.
+ */
+	extern const qpol_type_t *apol_types_relation_similarity_get_first_type(const apol_types_relation_similarity_t * s);
+
+/**
+ * Given a type similarity result, return the other type of the pair.
+ *
+ * @param s Type similarity result.
+ *
+ * @return Pointer to the other type.
+ */
+	extern const qpol_type_t *apol_types_relation_similarity_get_other_type(const apol_types_relation_similarity_t * s);
+
+/**
+ * Given a type similarity result, return the number of accesses the
+ * two types share.
+ *
+ * @param s Type similarity result.
+ *
+ * @return Number of shared accesses.
+ */
+	extern size_t apol_types_relation_similarity_get_num_common(const apol_types_relation_similarity_t * s);
+
+/**
+ * Given a type similarity result, return the similarity of the two
+ * types, from 0 (none) to 1 (identical accesses).
+ *
+ * @param s Type similarity result.
+ *
+ * @return Similarity of the types.
+ */
+	extern double apol_types_relation_similarity_get_similarity(const apol_types_relation_similarity_t * s);
+
 #ifdef	__cplusplus
 }
 #endif
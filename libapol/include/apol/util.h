@@ -319,6 +319,17 @@ extern "C"
  */
 	extern int apol_str_strcmp(const void *a, const void *b, void *unused __attribute__ ((unused)));
 
+/**
+ * Hash a string, for use with apol_bst_create_hashed() alongside
+ * apol_str_strcmp().
+ *
+ * @param s String to hash.
+ * @param unused Not used. (exists to match expected function signature)
+ *
+ * @return Hash value for the string.
+ */
+	extern size_t apol_str_hash(const void *s, void *unused __attribute__ ((unused)));
+
 /**
  * Wrapper around strdup for use in vector and BST cloning functions.
  *
@@ -211,6 +211,45 @@ extern "C"
 	extern int apol_vector_get_index(const apol_vector_t * v, const void *elem, apol_vector_comp_func * cmp, void *data,
 					 size_t * i);
 
+/**
+ *  Find an element within a vector that has already been sorted with
+ *  apol_vector_sort() using the same comparison function.  This
+ *  performs a binary search, taking O(log n) comparisons.
+ *
+ *  @param v The sorted vector from which to get the element.
+ *  @param elem The element to find.
+ *  @param cmp A comparison call back for the type of element stored
+ *  in the vector.  The first parameter will be an existing element
+ *  from the vector; next will be elem and then data.  The expected
+ *  return value from this function is less than, equal to, or greater
+ *  than 0 if the first argument is less than, equal to, or greater
+ *  than the second respectively.  If this is NULL then treat the
+ *  vector's contents as unsigned integers.
+ *  @param data Arbitrary data to pass as the comparison function's
+ *  third paramater.
+ *  @param i Reference to where to store the index of the first
+ *  element equal to elem.  If no such element exists this is set to
+ *  the index at which elem would have to be inserted to keep the
+ *  vector sorted.
+ *
+ *  @return 0 if element was found, or < 0 if not found.
+ */
+	extern int apol_vector_get_index_sorted(const apol_vector_t * v, const void *elem, apol_vector_comp_func * cmp,
+						void *data, size_t * i);
+
+/**
+ *  Ensure that a vector can hold at least the given number of
+ *  elements without reallocating.  Use this before appending a
+ *  known number of elements.  The vector's size is unchanged.
+ *
+ *  @param v The vector to reserve space within.
+ *  @param cap Minimum capacity for the vector.
+ *
+ *  @return 0 on success and < 0 on failure.  If the call fails, errno
+ *  will be set and v will be unchanged.
+ */
+	extern int apol_vector_reserve(apol_vector_t * v, size_t cap);
+
 /**
  *  Add an element to the end of a vector.
  *
@@ -223,6 +262,19 @@ extern "C"
  */
 	extern int apol_vector_append(apol_vector_t * v, void *elem);
 
+/**
+ *  Add several elements to the end of a vector, growing it at most
+ *  once.
+ *
+ *  @param v The vector to which to add the elements.
+ *  @param elems Array of elements to add, in order.
+ *  @param n Number of elements within elems.
+ *
+ *  @return 0 on success and < 0 on failure.  If the call fails, errno
+ *  will be set and v will be unchanged.
+ */
+	extern int apol_vector_append_array(apol_vector_t * v, void **elems, size_t n);
+
 /**
  *  Add an element to the end of a vector unless that element is equal
  *  to an existing element.
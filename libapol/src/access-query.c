@@ -0,0 +1,239 @@
+/**
+ * @file
+ *
+ * Computes effective access between types from the policy's access
+ * vector tables.
+ *
+ * @author agent agent@local
+ *
+ * Copyright (C) 2026 agent
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "policy-query-internal.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+
+struct apol_access_matrix
+{
+	size_t num_sources, num_targets, num_classes;
+	/** entry (s, t, c) is at ((s * num_targets) + t) * num_classes + c */
+	qpol_access_t *entries;
+};
+
+typedef struct access_job
+{
+	const apol_policy_t *p;
+	/** looked up qpol_type_t and qpol_class_t datums */
+	const void **sources, **targets, **classes;
+	apol_access_matrix_t *m;
+} access_job_t;
+
+typedef struct access_worker
+{
+	const access_job_t *job;
+	/** range of flattened (source, target) pairs to compute */
+	size_t start, end;
+	pthread_t thread;
+	int error;
+} access_worker_t;
+
+/**
+ * Look up every name in a vector, storing the datums in a newly
+ * allocated array.
+ */
+static int access_lookup_names(const apol_policy_t * p, const apol_vector_t * names, int is_class, const void ***datums)
+{
+	size_t i, n = apol_vector_get_size(names);
+	*datums = NULL;
+	if (n > 0 && !(*datums = calloc(n, sizeof(**datums)))) {
+		ERR(p, "%s", strerror(errno));
+		return -1;
+	}
+	for (i = 0; i < n; i++) {
+		const char *name = apol_vector_get_element(names, i);
+		const qpol_class_t *c = NULL;
+		const qpol_type_t *t = NULL;
+		int retval;
+		if (is_class)
+			retval = qpol_policy_get_class_by_name(p->p, name, &c);
+		else
+			retval = qpol_policy_get_type_by_name(p->p, name, &t);
+		if (retval) {
+			free(*datums);
+			*datums = NULL;
+			return -1;	       /* qpol already reported the error */
+		}
+		(*datums)[i] = (is_class ? (const void *)c : (const void *)t);
+	}
+	return 0;
+}
+
+static void *access_worker_run(void *arg)
+{
+	access_worker_t *w = arg;
+	const access_job_t *job = w->job;
+	apol_access_matrix_t *m = job->m;
+	for (size_t pair = w->start; pair < w->end; pair++) {
+		const qpol_type_t *source = job->sources[pair / m->num_targets];
+		const qpol_type_t *target = job->targets[pair % m->num_targets];
+		qpol_access_t *entry = m->entries + pair * m->num_classes;
+		for (size_t c = 0; c < m->num_classes; c++) {
+			if (qpol_policy_compute_access(job->p->p, source, target, job->classes[c], entry + c)) {
+				w->error = errno;
+				return NULL;
+			}
+		}
+	}
+	return NULL;
+}
+
+int apol_access_compute(const apol_policy_t * p, const char *src, const char *tgt, const char *obj_class, qpol_access_t * access)
+{
+	const qpol_type_t *source, *target;
+	const qpol_class_t *c;
+	if (access)
+		memset(access, 0, sizeof(*access));
+	if (!p || !src || !tgt || !obj_class || !access) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	if (qpol_policy_get_type_by_name(p->p, src, &source) ||
+	    qpol_policy_get_type_by_name(p->p, tgt, &target) || qpol_policy_get_class_by_name(p->p, obj_class, &c)) {
+		return -1;
+	}
+	return qpol_policy_compute_access(p->p, source, target, c, access);
+}
+
+int apol_access_compute_matrix(const apol_policy_t * p, const apol_vector_t * sources, const apol_vector_t * targets,
+			       const apol_vector_t * classes, unsigned int num_threads, apol_access_matrix_t ** m)
+{
+	access_job_t job;
+	access_worker_t *workers = NULL;
+	size_t num_pairs, share, i, num_started = 0;
+	int error = 0;
+
+	memset(&job, 0, sizeof(job));
+	if (m)
+		*m = NULL;
+	if (!p || !sources || !targets || !classes || !m) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	job.p = p;
+	if (access_lookup_names(p, sources, 0, &job.sources) ||
+	    access_lookup_names(p, targets, 0, &job.targets) || access_lookup_names(p, classes, 1, &job.classes)) {
+		error = errno;
+		goto cleanup;
+	}
+	if (!(job.m = calloc(1, sizeof(*job.m)))) {
+		error = errno;
+		ERR(p, "%s", strerror(error));
+		goto cleanup;
+	}
+	job.m->num_sources = apol_vector_get_size(sources);
+	job.m->num_targets = apol_vector_get_size(targets);
+	job.m->num_classes = apol_vector_get_size(classes);
+	num_pairs = job.m->num_sources * job.m->num_targets;
+	if (num_pairs == 0 || job.m->num_classes == 0) {
+		*m = job.m;
+		job.m = NULL;
+		goto cleanup;
+	}
+	if (!(job.m->entries = calloc(num_pairs * job.m->num_classes, sizeof(qpol_access_t)))) {
+		error = errno;
+		ERR(p, "%s", strerror(error));
+		goto cleanup;
+	}
+
+	if (num_threads == 0) {
+		long n = sysconf(_SC_NPROCESSORS_ONLN);
+		num_threads = (n > 0 ? (unsigned int)n : 1);
+	}
+	if (num_threads > num_pairs)
+		num_threads = num_pairs;
+	if (!(workers = calloc(num_threads, sizeof(*workers)))) {
+		error = errno;
+		ERR(p, "%s", strerror(error));
+		goto cleanup;
+	}
+	/* pairs are dealt out in contiguous shares so that each
+	 * worker writes to its own region of the matrix */
+	share = (num_pairs + num_threads - 1) / num_threads;
+	for (i = 0; i < num_threads; i++) {
+		workers[i].job = &job;
+		workers[i].start = (i * share < num_pairs ? i * share : num_pairs);
+		workers[i].end = (workers[i].start + share < num_pairs ? workers[i].start + share : num_pairs);
+	}
+	/* the calling thread does the first share of the work itself */
+	for (i = 1; i < num_threads; i++) {
+		if ((error = pthread_create(&workers[i].thread, NULL, access_worker_run, workers + i)) != 0) {
+			ERR(p, "%s", strerror(error));
+			break;
+		}
+		num_started++;
+	}
+	if (error == 0)
+		access_worker_run(workers);
+	for (i = 1; i <= num_started; i++)
+		pthread_join(workers[i].thread, NULL);
+	if (error)
+		goto cleanup;
+	for (i = 0; i < num_threads; i++) {
+		if (workers[i].error) {
+			error = workers[i].error;
+			ERR(p, "%s", strerror(error));
+			goto cleanup;
+		}
+	}
+	*m = job.m;
+	job.m = NULL;
+
+      cleanup:
+	free(workers);
+	free(job.sources);
+	free(job.targets);
+	free(job.classes);
+	apol_access_matrix_destroy(&job.m);
+	if (error) {
+		errno = error;
+		return -1;
+	}
+	return 0;
+}
+
+const qpol_access_t *apol_access_matrix_get(const apol_access_matrix_t * m, size_t s, size_t t, size_t c)
+{
+	if (!m || s >= m->num_sources || t >= m->num_targets || c >= m->num_classes) {
+		errno = EINVAL;
+		return NULL;
+	}
+	return m->entries + ((s * m->num_targets) + t) * m->num_classes + c;
+}
+
+void apol_access_matrix_destroy(apol_access_matrix_t ** m)
+{
+	if (m && *m) {
+		free((*m)->entries);
+		free(*m);
+		*m = NULL;
+	}
+}
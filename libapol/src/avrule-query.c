@@ -738,178 +738,112 @@ apol_vector_t *apol_avrule_list_to_syn_avrules(const apol_policy_t * p, const ap
 	return v;
 }
 
-char *apol_avrule_render(const apol_policy_t * policy, const qpol_avrule_t * rule)
+int apol_avrule_render_buf(const apol_policy_t * policy, const qpol_avrule_t * rule, char **buf, size_t * buf_sz)
 {
-	char *tmp = NULL;
-	const char *rule_type_str, *tmp_name = NULL;
+	const char *rule_type_str, *source_name = NULL, *target_name = NULL, *class_name = NULL;
 	int error = 0;
-	uint32_t rule_type = 0;
+	uint32_t rule_type = 0, perm_mask = 0;
 	const qpol_type_t *type = NULL;
 	const qpol_class_t *obj_class = NULL;
-	qpol_iterator_t *iter = NULL;
-	size_t tmp_sz = 0, num_perms = 0;
+	size_t len = 0;
 
-	if (!policy || !rule) {
+	if (!policy || !rule || !buf || !buf_sz) {
 		ERR(policy, "%s", strerror(EINVAL));
 		errno = EINVAL;
-		return NULL;
+		return -1;
 	}
 
 	/* rule type */
 	if (qpol_avrule_get_rule_type(policy->p, rule, &rule_type)) {
-		return NULL;
+		return -1;
 	}
 	if (!(rule_type &= (QPOL_RULE_ALLOW | QPOL_RULE_NEVERALLOW | QPOL_RULE_AUDITALLOW | QPOL_RULE_DONTAUDIT))) {
 		ERR(policy, "%s", "Invalid AV rule type");
 		errno = EINVAL;
-		return NULL;
+		return -1;
 	}
 	if (!(rule_type_str = apol_rule_type_to_str(rule_type))) {
 		ERR(policy, "%s", "Could not get AV rule type's string");
 		errno = EINVAL;
-		return NULL;
-	}
-	if (apol_str_appendf(&tmp, &tmp_sz, "%s ", rule_type_str)) {
-		error = errno;
-		ERR(policy, "%s", strerror(error));
-		goto err;
-	}
-
-	/* source type */
-	if (qpol_avrule_get_source_type(policy->p, rule, &type)) {
-		error = errno;
-		goto err;
-	}
-	if (qpol_type_get_name(policy->p, type, &tmp_name)) {
-		error = errno;
-		goto err;
-	}
-	if (apol_str_appendf(&tmp, &tmp_sz, "%s ", tmp_name)) {
-		error = errno;
-		ERR(policy, "%s", strerror(error));
-		goto err;
+		return -1;
 	}
 
-	/* target type */
-	if (qpol_avrule_get_target_type(policy->p, rule, &type)) {
-		error = errno;
-		goto err;
-	}
-	if (qpol_type_get_name(policy->p, type, &tmp_name)) {
-		error = errno;
-		goto err;
-	}
-	if (apol_str_appendf(&tmp, &tmp_sz, "%s : ", tmp_name)) {
-		error = errno;
-		ERR(policy, "%s", strerror(error));
-		goto err;
+	if (qpol_avrule_get_source_type(policy->p, rule, &type) || qpol_type_get_name(policy->p, type, &source_name) ||
+	    qpol_avrule_get_target_type(policy->p, rule, &type) || qpol_type_get_name(policy->p, type, &target_name) ||
+	    qpol_avrule_get_object_class(policy->p, rule, &obj_class) || qpol_class_get_name(policy->p, obj_class, &class_name) ||
+	    qpol_avrule_get_perm_mask(policy->p, rule, &perm_mask)) {
+		return -1;
 	}
 
-	/* object class */
-	if (qpol_avrule_get_object_class(policy->p, rule, &obj_class)) {
-		error = errno;
-		goto err;
-	}
-	if (qpol_class_get_name(policy->p, obj_class, &tmp_name)) {
-		error = errno;
-		goto err;
-	}
-	if (apol_str_appendf(&tmp, &tmp_sz, "%s ", tmp_name)) {
+	if (render_buf_append(buf, buf_sz, &len, rule_type_str) || render_buf_append(buf, buf_sz, &len, " ") ||
+	    render_buf_append(buf, buf_sz, &len, source_name) || render_buf_append(buf, buf_sz, &len, " ") ||
+	    render_buf_append(buf, buf_sz, &len, target_name) || render_buf_append(buf, buf_sz, &len, " : ") ||
+	    render_buf_append(buf, buf_sz, &len, class_name) || render_buf_append(buf, buf_sz, &len, " ")) {
 		error = errno;
 		ERR(policy, "%s", strerror(error));
-		goto err;
+		errno = error;
+		return -1;
 	}
 
 	/* perms */
-	if (qpol_avrule_get_perm_iter(policy->p, rule, &iter)) {
-		error = errno;
-		goto err;
-	}
-	if (qpol_iterator_get_size(iter, &num_perms)) {
-		error = errno;
-		ERR(policy, "%s", strerror(error));
-		goto err;
-	}
-	if (num_perms > 1) {
-		if (apol_str_append(&tmp, &tmp_sz, "{ ")) {
-			error = errno;
-			ERR(policy, "%s", strerror(error));
-			goto err;
-		}
-	}
-	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
-		char *perm_name = NULL;
-		if (qpol_iterator_get_item(iter, (void **)&perm_name)) {
-			error = errno;
-			ERR(policy, "%s", strerror(error));
-			goto err;
-		}
-		if (apol_str_appendf(&tmp, &tmp_sz, "%s ", perm_name)) {
-			error = errno;
-			free(perm_name);
-			ERR(policy, "%s", strerror(error));
-			goto err;
-		}
-		free(perm_name);
-		tmp_name = NULL;
-	}
-	if (num_perms > 1) {
-		if (apol_str_append(&tmp, &tmp_sz, "} ")) {
-			error = errno;
-			ERR(policy, "%s", strerror(error));
-			goto err;
-		}
+	if (render_buf_append_perms(policy, obj_class, perm_mask, buf, buf_sz, &len)) {
+		return -1;
 	}
 
-	if (apol_str_append(&tmp, &tmp_sz, ";")) {
+	if (render_buf_append(buf, buf_sz, &len, ";")) {
 		error = errno;
 		ERR(policy, "%s", strerror(error));
-		goto err;
+		errno = error;
+		return -1;
 	}
+	return 0;
+}
 
-	qpol_iterator_destroy(&iter);
+char *apol_avrule_render(const apol_policy_t * policy, const qpol_avrule_t * rule)
+{
+	char *tmp = NULL;
+	size_t tmp_sz = 0;
+	if (apol_avrule_render_buf(policy, rule, &tmp, &tmp_sz) < 0) {
+		int error = errno;
+		free(tmp);
+		errno = error;
+		return NULL;
+	}
 	return tmp;
-
-      err:
-	free(tmp);
-	qpol_iterator_destroy(&iter);
-	errno = error;
-	return NULL;
 }
 
-char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule_t * rule)
+int apol_syn_avrule_render_buf(const apol_policy_t * policy, const qpol_syn_avrule_t * rule, char **buf, size_t * buf_sz)
 {
-	char *tmp = NULL;
 	const char *rule_type_str, *tmp_name = NULL;
 	int error = 0;
 	uint32_t rule_type = 0, star = 0, comp = 0, self = 0;
 	const qpol_type_t *type = NULL;
 	const qpol_class_t *obj_class = NULL;
 	qpol_iterator_t *iter = NULL, *iter2 = NULL;
-	size_t tmp_sz = 0, iter_sz = 0, iter2_sz = 0;
+	size_t len = 0, iter_sz = 0, iter2_sz = 0;
 	const qpol_type_set_t *set = NULL;
 
-	if (!policy || !rule) {
+	if (!policy || !rule || !buf || !buf_sz) {
 		ERR(policy, "%s", strerror(EINVAL));
 		errno = EINVAL;
-		return NULL;
+		return -1;
 	}
 
 	/* rule type */
 	if (qpol_syn_avrule_get_rule_type(policy->p, rule, &rule_type)) {
-		return NULL;
+		return -1;
 	}
 	if (!(rule_type &= (QPOL_RULE_ALLOW | QPOL_RULE_NEVERALLOW | QPOL_RULE_AUDITALLOW | QPOL_RULE_DONTAUDIT))) {
 		ERR(policy, "%s", "Invalid AV rule type");
 		errno = EINVAL;
-		return NULL;
+		return -1;
 	}
 	if (!(rule_type_str = apol_rule_type_to_str(rule_type))) {
 		ERR(policy, "%s", "Could not get AV rule type's string");
 		errno = EINVAL;
-		return NULL;
+		return -1;
 	}
-	if (apol_str_appendf(&tmp, &tmp_sz, "%s ", rule_type_str)) {
+	if (render_buf_append(buf, buf_sz, &len, rule_type_str) || render_buf_append(buf, buf_sz, &len, " ")) {
 		error = errno;
 		ERR(policy, "%s", strerror(error));
 		goto err;
@@ -925,7 +859,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 		goto err;
 	}
 	if (star) {
-		if (apol_str_append(&tmp, &tmp_sz, "* ")) {
+		if (render_buf_append(buf, buf_sz, &len, "* ")) {
 			error = errno;
 			ERR(policy, "%s", strerror(error));
 			goto err;
@@ -936,7 +870,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 			goto err;
 		}
 		if (comp) {
-			if (apol_str_append(&tmp, &tmp_sz, "~")) {
+			if (render_buf_append(buf, buf_sz, &len, "~")) {
 				error = errno;
 				ERR(policy, "%s", strerror(ENOMEM));
 				goto err;
@@ -956,7 +890,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 			goto err;
 		}
 		if (iter_sz + iter2_sz > 1) {
-			if (apol_str_append(&tmp, &tmp_sz, "{ ")) {
+			if (render_buf_append(buf, buf_sz, &len, "{ ")) {
 				error = errno;
 				ERR(policy, "%s", strerror(ENOMEM));
 				goto err;
@@ -972,7 +906,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 				error = errno;
 				goto err;
 			}
-			if (apol_str_appendf(&tmp, &tmp_sz, "%s ", tmp_name)) {
+			if (render_buf_append(buf, buf_sz, &len, tmp_name) || render_buf_append(buf, buf_sz, &len, " ")) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -988,7 +922,8 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 				error = errno;
 				goto err;
 			}
-			if (apol_str_appendf(&tmp, &tmp_sz, "-%s ", tmp_name)) {
+			if (render_buf_append(buf, buf_sz, &len, "-") || render_buf_append(buf, buf_sz, &len, tmp_name) ||
+			    render_buf_append(buf, buf_sz, &len, " ")) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -997,7 +932,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 		qpol_iterator_destroy(&iter);
 		qpol_iterator_destroy(&iter2);
 		if (iter_sz + iter2_sz > 1) {
-			if (apol_str_append(&tmp, &tmp_sz, "} ")) {
+			if (render_buf_append(buf, buf_sz, &len, "} ")) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -1015,7 +950,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 		goto err;
 	}
 	if (star) {
-		if (apol_str_append(&tmp, &tmp_sz, "* ")) {
+		if (render_buf_append(buf, buf_sz, &len, "* ")) {
 			error = errno;
 			ERR(policy, "%s", strerror(error));
 			goto err;
@@ -1026,7 +961,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 			goto err;
 		}
 		if (comp) {
-			if (apol_str_append(&tmp, &tmp_sz, "~")) {
+			if (render_buf_append(buf, buf_sz, &len, "~")) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -1050,7 +985,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 			goto err;
 		}
 		if (iter_sz + iter2_sz + self > 1) {
-			if (apol_str_append(&tmp, &tmp_sz, "{ ")) {
+			if (render_buf_append(buf, buf_sz, &len, "{ ")) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -1066,7 +1001,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 				error = errno;
 				goto err;
 			}
-			if (apol_str_appendf(&tmp, &tmp_sz, "%s ", tmp_name)) {
+			if (render_buf_append(buf, buf_sz, &len, tmp_name) || render_buf_append(buf, buf_sz, &len, " ")) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -1082,7 +1017,8 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 				error = errno;
 				goto err;
 			}
-			if (apol_str_appendf(&tmp, &tmp_sz, "-%s ", tmp_name)) {
+			if (render_buf_append(buf, buf_sz, &len, "-") || render_buf_append(buf, buf_sz, &len, tmp_name) ||
+			    render_buf_append(buf, buf_sz, &len, " ")) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -1091,14 +1027,14 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 		qpol_iterator_destroy(&iter);
 		qpol_iterator_destroy(&iter2);
 		if (self) {
-			if (apol_str_append(&tmp, &tmp_sz, "self ")) {
+			if (render_buf_append(buf, buf_sz, &len, "self ")) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
 			}
 		}
 		if (iter_sz + iter2_sz + self > 1) {
-			if (apol_str_append(&tmp, &tmp_sz, "} ")) {
+			if (render_buf_append(buf, buf_sz, &len, "} ")) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
@@ -1106,7 +1042,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 		}
 	}
 
-	if (apol_str_append(&tmp, &tmp_sz, ": ")) {
+	if (render_buf_append(buf, buf_sz, &len, ": ")) {
 		error = errno;
 		ERR(policy, "%s", strerror(error));
 		goto err;
@@ -1123,7 +1059,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 		goto err;
 	}
 	if (iter_sz > 1) {
-		if (apol_str_append(&tmp, &tmp_sz, "{ ")) {
+		if (render_buf_append(buf, buf_sz, &len, "{ ")) {
 			error = errno;
 			ERR(policy, "%s", strerror(error));
 			goto err;
@@ -1139,7 +1075,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 			error = errno;
 			goto err;
 		}
-		if (apol_str_appendf(&tmp, &tmp_sz, "%s ", tmp_name)) {
+		if (render_buf_append(buf, buf_sz, &len, tmp_name) || render_buf_append(buf, buf_sz, &len, " ")) {
 			error = errno;
 			ERR(policy, "%s", strerror(error));
 			goto err;
@@ -1147,7 +1083,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 	}
 	qpol_iterator_destroy(&iter);
 	if (iter_sz > 1) {
-		if (apol_str_append(&tmp, &tmp_sz, "} ")) {
+		if (render_buf_append(buf, buf_sz, &len, "} ")) {
 			error = errno;
 			ERR(policy, "%s", strerror(error));
 			goto err;
@@ -1165,7 +1101,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 		goto err;
 	}
 	if (iter_sz > 1) {
-		if (apol_str_append(&tmp, &tmp_sz, "{ ")) {
+		if (render_buf_append(buf, buf_sz, &len, "{ ")) {
 			error = errno;
 			ERR(policy, "%s", strerror(error));
 			goto err;
@@ -1177,7 +1113,7 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 			ERR(policy, "%s", strerror(error));
 			goto err;
 		}
-		if (apol_str_appendf(&tmp, &tmp_sz, "%s ", tmp_name)) {
+		if (render_buf_append(buf, buf_sz, &len, tmp_name) || render_buf_append(buf, buf_sz, &len, " ")) {
 			error = errno;
 			ERR(policy, "%s", strerror(error));
 			goto err;
@@ -1185,25 +1121,37 @@ char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule
 	}
 	qpol_iterator_destroy(&iter);
 	if (iter_sz > 1) {
-		if (apol_str_append(&tmp, &tmp_sz, "} ")) {
+		if (render_buf_append(buf, buf_sz, &len, "} ")) {
 			error = errno;
 			ERR(policy, "%s", strerror(error));
 			goto err;
 		}
 	}
 
-	if (apol_str_append(&tmp, &tmp_sz, ";")) {
+	if (render_buf_append(buf, buf_sz, &len, ";")) {
 		error = errno;
 		ERR(policy, "%s", strerror(error));
 		goto err;
 	}
 
-	return tmp;
+	return 0;
 
       err:
-	free(tmp);
 	qpol_iterator_destroy(&iter);
 	qpol_iterator_destroy(&iter2);
 	errno = error;
-	return NULL;
+	return -1;
+}
+
+char *apol_syn_avrule_render(const apol_policy_t * policy, const qpol_syn_avrule_t * rule)
+{
+	char *tmp = NULL;
+	size_t tmp_sz = 0;
+	if (apol_syn_avrule_render_buf(policy, rule, &tmp, &tmp_sz) < 0) {
+		int error = errno;
+		free(tmp);
+		errno = error;
+		return NULL;
+	}
+	return tmp;
 }
@@ -0,0 +1,230 @@
+/**
+ * @file
+ *
+ * Implementation of libapol's internal fixed size bitsets.
+ *
+ * @author agent agent@local
+ *
+ * Copyright (C) 2026 agent
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "bitset.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WORD_INDEX(bit) ((bit) / APOL_BITSET_WORD_BITS)
+#define WORD_MASK(bit) (1UL << ((bit) % APOL_BITSET_WORD_BITS))
+
+static size_t word_ctz(unsigned long w)
+{
+#ifdef __GNUC__
+	return (size_t)__builtin_ctzl(w);
+#else
+	size_t n = 0;
+	while (!(w & 1UL)) {
+		w >>= 1;
+		n++;
+	}
+	return n;
+#endif
+}
+
+static size_t word_popcount(unsigned long w)
+{
+#ifdef __GNUC__
+	return (size_t)__builtin_popcountl(w);
+#else
+	size_t n = 0;
+	for (; w; w &= w - 1)
+		n++;
+	return n;
+#endif
+}
+
+int apol_bitset_init(apol_bitset_t * b, size_t size)
+{
+	if (!b) {
+		errno = EINVAL;
+		return -1;
+	}
+	b->size = size;
+	b->num_words = (size + APOL_BITSET_WORD_BITS - 1) / APOL_BITSET_WORD_BITS;
+	if (b->num_words == 0) {
+		b->words = NULL;
+		return 0;
+	}
+	if ((b->words = calloc(b->num_words, sizeof(unsigned long))) == NULL) {
+		b->size = b->num_words = 0;
+		return -1;
+	}
+	return 0;
+}
+
+void apol_bitset_release(apol_bitset_t * b)
+{
+	if (!b)
+		return;
+	free(b->words);
+	b->words = NULL;
+	b->size = b->num_words = 0;
+}
+
+apol_bitset_t *apol_bitset_create(size_t size)
+{
+	apol_bitset_t *b = malloc(sizeof(*b));
+	int error;
+	if (!b)
+		return NULL;
+	if (apol_bitset_init(b, size) < 0) {
+		error = errno;
+		free(b);
+		errno = error;
+		return NULL;
+	}
+	return b;
+}
+
+void apol_bitset_destroy(apol_bitset_t ** b)
+{
+	if (!b || !*b)
+		return;
+	apol_bitset_release(*b);
+	free(*b);
+	*b = NULL;
+}
+
+void apol_bitset_set(apol_bitset_t * b, size_t bit, int value)
+{
+	if (!b || bit >= b->size)
+		return;
+	if (value)
+		b->words[WORD_INDEX(bit)] |= WORD_MASK(bit);
+	else
+		b->words[WORD_INDEX(bit)] &= ~WORD_MASK(bit);
+}
+
+int apol_bitset_get(const apol_bitset_t * b, size_t bit)
+{
+	if (!b || bit >= b->size)
+		return 0;
+	return (b->words[WORD_INDEX(bit)] & WORD_MASK(bit)) ? 1 : 0;
+}
+
+void apol_bitset_clear(apol_bitset_t * b)
+{
+	if (!b || !b->words)
+		return;
+	memset(b->words, 0, b->num_words * sizeof(unsigned long));
+}
+
+size_t apol_bitset_next(const apol_bitset_t * b, size_t start)
+{
+	size_t i;
+	unsigned long w;
+	if (!b || start >= b->size)
+		return (b ? b->size : 0);
+	i = WORD_INDEX(start);
+	/* mask off bits below start within the first word */
+	w = b->words[i] & (~0UL << (start % APOL_BITSET_WORD_BITS));
+	while (1) {
+		if (w) {
+			size_t bit = i * APOL_BITSET_WORD_BITS + word_ctz(w);
+			return (bit < b->size ? bit : b->size);
+		}
+		if (++i >= b->num_words)
+			break;
+		w = b->words[i];
+	}
+	return b->size;
+}
+
+size_t apol_bitset_count(const apol_bitset_t * b)
+{
+	size_t i, n = 0;
+	if (!b)
+		return 0;
+	for (i = 0; i < b->num_words; i++)
+		n += word_popcount(b->words[i]);
+	return n;
+}
+
+int apol_bitset_is_empty(const apol_bitset_t * b)
+{
+	size_t i;
+	if (!b)
+		return 1;
+	for (i = 0; i < b->num_words; i++)
+		if (b->words[i])
+			return 0;
+	return 1;
+}
+
+int apol_bitset_intersects(const apol_bitset_t * a, const apol_bitset_t * b)
+{
+	size_t i, n;
+	if (!a || !b)
+		return 0;
+	n = (a->num_words < b->num_words ? a->num_words : b->num_words);
+	for (i = 0; i < n; i++)
+		if (a->words[i] & b->words[i])
+			return 1;
+	return 0;
+}
+
+int apol_bitset_is_subset(const apol_bitset_t * a, const apol_bitset_t * b)
+{
+	size_t i, n;
+	if (!a)
+		return 1;
+	n = (b == NULL ? 0 : (a->num_words < b->num_words ? a->num_words : b->num_words));
+	for (i = 0; i < n; i++)
+		if (a->words[i] & ~b->words[i])
+			return 0;
+	for (; i < a->num_words; i++)
+		if (a->words[i])
+			return 0;
+	return 1;
+}
+
+void apol_bitset_and(apol_bitset_t * dest, const apol_bitset_t * a, const apol_bitset_t * b)
+{
+	size_t i, n;
+	if (!dest || !a || !b)
+		return;
+	n = (a->num_words < b->num_words ? a->num_words : b->num_words);
+	if (n > dest->num_words)
+		n = dest->num_words;
+	for (i = 0; i < n; i++)
+		dest->words[i] = a->words[i] & b->words[i];
+	for (; i < dest->num_words; i++)
+		dest->words[i] = 0;
+}
+
+void apol_bitset_or(apol_bitset_t * dest, const apol_bitset_t * src)
+{
+	size_t i, n;
+	if (!dest || !src)
+		return;
+	n = (dest->num_words < src->num_words ? dest->num_words : src->num_words);
+	for (i = 0; i < n; i++)
+		dest->words[i] |= src->words[i];
+	/* do not let bits past the end of dest leak in */
+	if (n == dest->num_words && n > 0 && dest->size % APOL_BITSET_WORD_BITS)
+		dest->words[n - 1] &= ~(~0UL << (dest->size % APOL_BITSET_WORD_BITS));
+}
@@ -0,0 +1,183 @@
+/**
+ * @file
+ *
+ * Fixed size bitsets, used internally by libapol's analyses to index
+ * policy symbols by their value.  These routines are declared hidden
+ * within the library by way of the linking map.
+ *
+ * @author agent agent@local
+ *
+ * Copyright (C) 2026 agent
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef APOL_BITSET_H
+#define APOL_BITSET_H
+
+#include <stddef.h>
+#include <limits.h>
+
+#define APOL_BITSET_WORD_BITS (sizeof(unsigned long) * CHAR_BIT)
+
+typedef struct apol_bitset
+{
+	/** number of bits in the set */
+	size_t size;
+	/** number of words allocated in words */
+	size_t num_words;
+	unsigned long *words;
+} apol_bitset_t;
+
+/**
+ * Initialize an embedded bitset able to hold bits 0 through size - 1.
+ * All bits are initially cleared.  The caller must call
+ * apol_bitset_release() afterwards.
+ *
+ * @param b Bitset to initialize.
+ * @param size Number of bits in the set.
+ *
+ * @return 0 on success, < 0 on error; errno will be set.
+ */
+int apol_bitset_init(apol_bitset_t * b, size_t size);
+
+/**
+ * Free the storage used by an embedded bitset, but not the bitset
+ * itself.  Afterwards the bitset is empty and has a size of zero.
+ *
+ * @param b Bitset to release.  If NULL then do nothing.
+ */
+void apol_bitset_release(apol_bitset_t * b);
+
+/**
+ * Allocate and return a new bitset able to hold bits 0 through size
+ * - 1.  The caller must call apol_bitset_destroy() upon the return
+ * value.
+ *
+ * @param size Number of bits in the set.
+ *
+ * @return A cleared bitset, or NULL upon error.
+ */
+apol_bitset_t *apol_bitset_create(size_t size);
+
+/**
+ * Free a bitset created by apol_bitset_create(), and then set the
+ * referenced pointer to NULL.
+ *
+ * @param b Reference to a bitset to destroy.
+ */
+void apol_bitset_destroy(apol_bitset_t ** b);
+
+/**
+ * Set or clear a single bit.  Bits beyond the size of the set are
+ * ignored.
+ *
+ * @param b Bitset to modify.
+ * @param bit Index of the bit.
+ * @param value Non-zero to set the bit, zero to clear it.
+ */
+void apol_bitset_set(apol_bitset_t * b, size_t bit, int value);
+
+/**
+ * Get a single bit.
+ *
+ * @param b Bitset to query.
+ * @param bit Index of the bit.
+ *
+ * @return 1 if the bit is set, 0 if it is clear, beyond the size of
+ * the set, or if b is NULL.
+ */
+int apol_bitset_get(const apol_bitset_t * b, size_t bit);
+
+/**
+ * Clear every bit within a bitset.
+ *
+ * @param b Bitset to modify.
+ */
+void apol_bitset_clear(apol_bitset_t * b);
+
+/**
+ * Find the next set bit, starting with (and including) the given
+ * index.  Use this to iterate over the set:
+ * <code>for (i = apol_bitset_next(b, 0); i < b->size; i = apol_bitset_next(b, i + 1))</code>
+ *
+ * @param b Bitset to search.
+ * @param start First bit to consider.
+ *
+ * @return Index of the next set bit, or the size of the set if there
+ * are no more set bits.
+ */
+size_t apol_bitset_next(const apol_bitset_t * b, size_t start);
+
+/**
+ * Count the number of set bits.
+ *
+ * @param b Bitset to count.
+ *
+ * @return Number of set bits.
+ */
+size_t apol_bitset_count(const apol_bitset_t * b);
+
+/**
+ * Determine if no bits are set.
+ *
+ * @param b Bitset to check.
+ *
+ * @return 1 if empty (or NULL), 0 if at least one bit is set.
+ */
+int apol_bitset_is_empty(const apol_bitset_t * b);
+
+/**
+ * Determine if two bitsets have at least one set bit in common.
+ *
+ * @param a First bitset.
+ * @param b Second bitset.
+ *
+ * @return 1 if they intersect, 0 if not.
+ */
+int apol_bitset_intersects(const apol_bitset_t * a, const apol_bitset_t * b);
+
+/**
+ * Determine if every set bit of a is also set within b.  The two sets
+ * may have different sizes.
+ *
+ * @param a Possible subset.
+ * @param b Possible superset.
+ *
+ * @return 1 if a is a subset of b, 0 if not.
+ */
+int apol_bitset_is_subset(const apol_bitset_t * a, const apol_bitset_t * b);
+
+/**
+ * Bitwise-and two sets, storing the result into dest.  dest must
+ * already be initialized; bits beyond the shorter of the two inputs
+ * are cleared.
+ *
+ * @param dest Destination bitset; may be the same as a or b.
+ * @param a First bitset.
+ * @param b Second bitset.
+ */
+void apol_bitset_and(apol_bitset_t * dest, const apol_bitset_t * a, const apol_bitset_t * b);
+
+/**
+ * Bitwise-or a set into another set.  Bits of src beyond the size of
+ * dest are ignored.
+ *
+ * @param dest Destination bitset.
+ * @param src Bitset to merge into dest.
+ */
+void apol_bitset_or(apol_bitset_t * dest, const apol_bitset_t * src);
+
+#endif
@@ -2,7 +2,11 @@
  *  @file
  *  Contains the implementation of a generic binary search tree.  The
  *  tree is implemented as a red-black tree, as inspired by Julienne
- *  Walker (http://eternallyconfuzzled.com/tuts/redblack.html).
+ *  Walker (http://eternallyconfuzzled.com/tuts/redblack.html).  Both
+ *  insertion and removal are done top-down in a single pass, and
+ *  nodes are carved out of pooled blocks rather than allocated one at
+ *  a time.  A BST may instead be created as a hash table, for callers
+ *  that only need the elements sorted once at the end.
  *
  *  @author Jeremy A. Mowery jmowery@tresys.com
  *  @author Jason Tang jtang@tresys.com
@@ -37,9 +41,29 @@ typedef struct bst_node
 {
 	void *elem;
 	int is_red;
+	/** Left and right children.  For a hashed BST, child[0] is
+	 *  the next node in the same bucket. */
 	struct bst_node *child[2];
 } bst_node_t;
 
+/** Number of nodes in the first pool block; subsequent blocks double
+ *  in size until reaching BST_POOL_MAX_BLOCK. */
+#define BST_POOL_MIN_BLOCK 16
+#define BST_POOL_MAX_BLOCK 4096
+
+/** Initial number of buckets for a hashed BST; must be a power of 2. */
+#define BST_HASH_INIT_BUCKETS 64
+
+/** A red-black tree's height is at most 2 * log2(n + 1). */
+#define BST_MAX_HEIGHT (2 * 8 * sizeof(size_t))
+
+typedef struct bst_pool_block
+{
+	struct bst_pool_block *next;
+	size_t num_nodes;
+	bst_node_t nodes[];
+} bst_pool_block_t;
+
 /**
  *  Generic binary search tree structure.  Stores elements as void*.
  */
@@ -49,93 +73,236 @@ struct apol_bst
 	apol_bst_comp_func *cmp;
 	/** Destroy function for the nodes, or NULL to not free each node. */
 	apol_bst_free_func *fr;
+	/** Hash function for elements, or NULL if this is a red-black
+	 *  tree. */
+	apol_bst_hash_func *hash;
 	/** The number of elements currently stored in the bst. */
 	size_t size;
 	/** Pointer to top of the tree. */
 	bst_node_t *head;
+	/** Array of bucket chains, if this BST is hashed. */
+	bst_node_t **buckets;
+	/** Number of buckets; always a power of 2. */
+	size_t num_buckets;
+	/** List of node blocks, most recently allocated first. */
+	bst_pool_block_t *blocks;
+	/** Number of nodes handed out from the first block. */
+	size_t block_used;
+	/** Nodes that were removed, linked through child[0]. */
+	bst_node_t *free_nodes;
 };
 
-apol_bst_t *apol_bst_create(apol_bst_comp_func * cmp, apol_bst_free_func * fr)
+static apol_bst_t *bst_create(apol_bst_comp_func * cmp, apol_bst_hash_func * hash, apol_bst_free_func * fr)
 {
 	apol_bst_t *b = NULL;
 	if ((b = calloc(1, sizeof(*b))) == NULL) {
 		return NULL;
 	}
 	b->cmp = cmp;
+	b->hash = hash;
 	b->fr = fr;
+	if (hash != NULL) {
+		if ((b->buckets = calloc(BST_HASH_INIT_BUCKETS, sizeof(*b->buckets))) == NULL) {
+			free(b);
+			return NULL;
+		}
+		b->num_buckets = BST_HASH_INIT_BUCKETS;
+	}
 	return b;
 }
 
+apol_bst_t *apol_bst_create(apol_bst_comp_func * cmp, apol_bst_free_func * fr)
+{
+	return bst_create(cmp, NULL, fr);
+}
+
+apol_bst_t *apol_bst_create_hashed(apol_bst_comp_func * cmp, apol_bst_hash_func * hash, apol_bst_free_func * fr)
+{
+	if (hash == NULL) {
+		errno = EINVAL;
+		return NULL;
+	}
+	return bst_create(cmp, hash, fr);
+}
+
 /**
- * Free the data stored within a bst node, recurse through the node's
- * children, and then the node itself.
+ * Return the next unused node from the BST's pool, allocating a new
+ * block if needed.  The node's contents are undefined.
+ *
+ * @param b BST from whose pool to allocate.
  *
- * @param node Node to free.  If NULL then do stop recursing.
- * @param fr Callback to free a node's data.  If NULL then do not free
- * the data.
+ * @return An unused node, or NULL on error.
  */
-static void bst_node_free(bst_node_t * node, apol_bst_free_func * fr)
+static bst_node_t *bst_pool_get(apol_bst_t * b)
 {
-	if (node != NULL) {
-		if (fr != NULL) {
-			fr(node->elem);
+	bst_pool_block_t *block;
+	size_t n;
+	if (b->free_nodes != NULL) {
+		bst_node_t *node = b->free_nodes;
+		b->free_nodes = node->child[0];
+		return node;
+	}
+	if (b->blocks == NULL || b->block_used >= b->blocks->num_nodes) {
+		n = (b->blocks == NULL ? BST_POOL_MIN_BLOCK : b->blocks->num_nodes * 2);
+		if (n > BST_POOL_MAX_BLOCK) {
+			n = BST_POOL_MAX_BLOCK;
+		}
+		if ((block = malloc(sizeof(*block) + n * sizeof(bst_node_t))) == NULL) {
+			return NULL;
 		}
-		bst_node_free(node->child[0], fr);
-		bst_node_free(node->child[1], fr);
-		free(node);
+		block->num_nodes = n;
+		block->next = b->blocks;
+		b->blocks = block;
+		b->block_used = 0;
+	}
+	return &b->blocks->nodes[b->block_used++];
+}
+
+/**
+ * Return a node to the BST's pool so that it may be reused.
+ */
+static void bst_pool_put(apol_bst_t * b, bst_node_t * node)
+{
+	node->child[0] = b->free_nodes;
+	b->free_nodes = node;
+}
+
+/**
+ * Call fn() upon every element within the tree rooted at node, in
+ * sorted order.
+ *
+ * @return 0 on success, or the first negative value returned by fn().
+ */
+static int bst_node_inorder_map(bst_node_t * node, int (*fn) (void *, void *), void *data)
+{
+	bst_node_t *stack[BST_MAX_HEIGHT];
+	size_t top = 0;
+	int retval;
+	while (node != NULL || top > 0) {
+		while (node != NULL) {
+			assert(top < BST_MAX_HEIGHT);
+			stack[top++] = node;
+			node = node->child[0];
+		}
+		node = stack[--top];
+		if ((retval = fn(node->elem, data)) < 0) {
+			return retval;
+		}
+		node = node->child[1];
+	}
+	return 0;
+}
+
+/**
+ * Call fr() upon every element within the tree rooted at node.  The
+ * recursion is bounded by the height of the red-black tree.
+ */
+static void bst_node_free_elems(bst_node_t * node, apol_bst_free_func * fr)
+{
+	while (node != NULL) {
+		bst_node_free_elems(node->child[0], fr);
+		fr(node->elem);
+		node = node->child[1];
 	}
 }
 
 void apol_bst_destroy(apol_bst_t ** b)
 {
+	bst_pool_block_t *block, *next;
+	bst_node_t *node;
+	size_t i;
 	if (!b || !(*b))
 		return;
-	bst_node_free((*b)->head, (*b)->fr);
+	if ((*b)->fr != NULL) {
+		if ((*b)->hash != NULL) {
+			for (i = 0; i < (*b)->num_buckets; i++) {
+				for (node = (*b)->buckets[i]; node != NULL; node = node->child[0]) {
+					(*b)->fr(node->elem);
+				}
+			}
+		} else {
+			bst_node_free_elems((*b)->head, (*b)->fr);
+		}
+	}
+	for (block = (*b)->blocks; block != NULL; block = next) {
+		next = block->next;
+		free(block);
+	}
 	(*b)->head = NULL;
+	free((*b)->buckets);
 	free(*b);
 	*b = NULL;
 }
 
+static int bst_append_elem(void *elem, void *data)
+{
+	return apol_vector_append((apol_vector_t *) data, elem);
+}
+
 /**
- * Given a BST node, traverse the node infix, appending the node's
- * element to vector v.
+ * Append every element of a BST to a vector.  If the BST is a red-black
+ * tree then the elements are appended in sorted order; if hashed then
+ * the order is arbitrary.
  *
- * @param node BST node to recurse.
+ * @param b BST to traverse.
  * @param v Vector to which append.
  *
  * @return 0 on success, < 0 on error.
  */
-static int bst_node_to_vector(bst_node_t * node, apol_vector_t * v)
+static int bst_to_vector(const apol_bst_t * b, apol_vector_t * v)
 {
-	int retval;
-	if (node == NULL) {
-		return 0;
-	}
-	if ((retval = bst_node_to_vector(node->child[0], v)) < 0) {
-		return retval;
+	bst_node_t *node;
+	size_t i;
+	if (b->hash == NULL) {
+		return bst_node_inorder_map(b->head, bst_append_elem, v);
 	}
-	if ((retval = apol_vector_append(v, node->elem)) < 0) {
-		return retval;
+	for (i = 0; i < b->num_buckets; i++) {
+		for (node = b->buckets[i]; node != NULL; node = node->child[0]) {
+			if (apol_vector_append(v, node->elem) < 0) {
+				return -1;
+			}
+		}
 	}
-	return bst_node_to_vector(node->child[1], v);
+	return 0;
 }
 
-apol_vector_t *apol_bst_get_vector(apol_bst_t * b, int change_owner)
+/**
+ * Allocate a vector holding the BST's elements in sorted order.  A
+ * hashed BST's elements are sorted at this time, with NULL passed as
+ * the comparison function's third parameter.
+ *
+ * @param b BST whose elements to copy.
+ *
+ * @return A sorted vector with no free function, or NULL on error.
+ */
+static apol_vector_t *bst_sorted_vector(const apol_bst_t * b)
 {
 	apol_vector_t *v = NULL;
-	if (!b) {
-		errno = EINVAL;
-		return NULL;
-	}
 	if ((v = apol_vector_create_with_capacity(b->size, NULL)) == NULL) {
 		return NULL;
 	}
-	if (bst_node_to_vector(b->head, v) < 0) {
+	if (bst_to_vector(b, v) < 0) {
 		int error = errno;
 		apol_vector_destroy(&v);
 		errno = error;
 		return NULL;
 	}
+	if (b->hash != NULL) {
+		apol_vector_sort(v, b->cmp, NULL);
+	}
+	return v;
+}
+
+apol_vector_t *apol_bst_get_vector(apol_bst_t * b, int change_owner)
+{
+	apol_vector_t *v = NULL;
+	if (!b) {
+		errno = EINVAL;
+		return NULL;
+	}
+	if ((v = bst_sorted_vector(b)) == NULL) {
+		return NULL;
+	}
 	if (change_owner) {
 		vector_set_free_func(v, b->fr);
 		b->fr = NULL;
@@ -153,6 +320,77 @@ size_t apol_bst_get_size(const apol_bst_t * b)
 	}
 }
 
+/**
+ * Compare an element within the BST against another element, using
+ * the BST's comparison function or pointer address comparison if
+ * there is none.
+ */
+static int bst_compare(const apol_bst_t * b, const void *node_elem, const void *elem, void *data)
+{
+	if (b->cmp != NULL) {
+		return b->cmp(node_elem, elem, data);
+	} else {
+		char *p1 = (char *)node_elem;
+		char *p2 = (char *)elem;
+		if (p1 < p2) {
+			return -1;
+		} else if (p1 > p2) {
+			return 1;
+		}
+		return 0;
+	}
+}
+
+/**
+ * Return the address of the bucket chain that would hold elem within
+ * a hashed BST.
+ */
+static bst_node_t **bst_hash_bucket(const apol_bst_t * b, const void *elem, void *data)
+{
+	return &b->buckets[b->hash(elem, data) & (b->num_buckets - 1)];
+}
+
+/**
+ * Find the link within a hashed BST that points to the node holding
+ * elem.
+ *
+ * @return Address of the pointer to the matching node, or the address
+ * of the NULL pointer terminating elem's bucket if not found.
+ */
+static bst_node_t **bst_hash_find(const apol_bst_t * b, const void *elem, void *data)
+{
+	bst_node_t **link = bst_hash_bucket(b, elem, data);
+	while (*link != NULL && bst_compare(b, (*link)->elem, elem, data) != 0) {
+		link = &(*link)->child[0];
+	}
+	return link;
+}
+
+/**
+ * Double the number of buckets within a hashed BST.  If memory cannot
+ * be allocated the BST keeps its current buckets, which is still
+ * correct albeit slower.
+ */
+static void bst_hash_grow(apol_bst_t * b, void *data)
+{
+	bst_node_t **old = b->buckets, *node, *next;
+	size_t i, old_num = b->num_buckets;
+	if ((b->buckets = calloc(old_num * 2, sizeof(*b->buckets))) == NULL) {
+		b->buckets = old;
+		return;
+	}
+	b->num_buckets = old_num * 2;
+	for (i = 0; i < old_num; i++) {
+		for (node = old[i]; node != NULL; node = next) {
+			bst_node_t **bucket = bst_hash_bucket(b, node->elem, data);
+			next = node->child[0];
+			node->child[0] = *bucket;
+			*bucket = node;
+		}
+	}
+	free(old);
+}
+
 int apol_bst_get_element(const apol_bst_t * b, const void *elem, void *data, void **result)
 {
 	bst_node_t *node;
@@ -161,21 +399,16 @@ int apol_bst_get_element(const apol_bst_t * b, const void *elem, void *data, voi
 		errno = EINVAL;
 		return -1;
 	}
+	if (b->hash != NULL) {
+		if ((node = *bst_hash_find(b, elem, data)) == NULL) {
+			return -1;
+		}
+		*result = node->elem;
+		return 0;
+	}
 	node = b->head;
 	while (node != NULL) {
-		if (b->cmp != NULL) {
-			compval = b->cmp(node->elem, elem, data);
-		} else {
-			char *p1 = (char *)node->elem;
-			char *p2 = (char *)elem;
-			if (p1 < p2) {
-				compval = -1;
-			} else if (p1 > p2) {
-				compval = 1;
-			} else {
-				compval = 0;
-			}
-		}
+		compval = bst_compare(b, node->elem, elem, data);
 		if (compval == 0) {
 			*result = node->elem;
 			return 0;
@@ -188,28 +421,6 @@ int apol_bst_get_element(const apol_bst_t * b, const void *elem, void *data, voi
 	return -1;
 }
 
-/**
- * Allocate and return a new BST node, with data set to elem and color
- * to red.  Also increment the tree's size.
- *
- * @param b BST size to increment.
- * @param elem Value for the node.
- *
- * @return Allocated BST node, which the caller must insert, or NULL
- * on error.
- */
-static bst_node_t *bst_node_make(apol_bst_t * b, void *elem)
-{
-	bst_node_t *new_node;
-	if ((new_node = calloc(1, sizeof(*new_node))) == NULL) {
-		return NULL;
-	}
-	new_node->elem = elem;
-	new_node->is_red = 1;
-	b->size++;
-	return new_node;
-}
-
 /**
  * Determines if a node is red or not.
  *
@@ -238,115 +449,260 @@ static bst_node_t *bst_rotate_double(bst_node_t * root, int dir)
 	return bst_rotate_single(root, dir);
 }
 
-static bst_node_t *bst_insert_recursive(apol_bst_t * b, bst_node_t * root, void **elem, void *data, apol_bst_free_func * fr,
-					int *not_uniq)
+/**
+ * Insert an element into a hashed BST.  Parameters and return value
+ * are the same as bst_insert().
+ */
+static int bst_hash_insert(apol_bst_t * b, void **elem, void *data, apol_bst_free_func * fr)
 {
-	int compval, dir;
-	if (root == NULL) {
-		if ((root = bst_node_make(b, *elem)) == NULL) {
-			*not_uniq = -1;
-			return NULL;
+	bst_node_t **link = bst_hash_find(b, *elem, data), *node;
+	if (*link != NULL) {
+		/* already exists */
+		if (fr != NULL) {
+			fr(*elem);
 		}
-		*not_uniq = 0;
-	} else {
-		if (b->cmp != NULL) {
-			compval = b->cmp(root->elem, *elem, data);
-		} else {
-			char *p1 = (char *)root->elem;
-			char *p2 = (char *)(*elem);
-			if (p1 < p2) {
-				compval = -1;
-			} else if (p1 > p2) {
-				compval = 1;
+		*elem = (*link)->elem;
+		return 1;
+	}
+	if ((node = bst_pool_get(b)) == NULL) {
+		return -1;
+	}
+	if (b->size >= b->num_buckets) {
+		bst_hash_grow(b, data);
+		link = bst_hash_bucket(b, *elem, data);
+	}
+	node->elem = *elem;
+	node->is_red = 0;
+	node->child[0] = *link;
+	node->child[1] = NULL;
+	*link = node;
+	b->size++;
+	return 0;
+}
+
+/**
+ * Insert an element into a BST, top-down in a single pass.
+ *
+ * @param b BST to modify.
+ * @param elem Reference to the element to insert.  If an equal
+ * element already exists then the reference is set to it.
+ * @param data Arbitrary data to pass to the comparison function.
+ * @param fr If the element already exists and this is not NULL then
+ * pass the given element to this function.
+ *
+ * @return 0 if inserted, 1 if already existed, or < 0 on error.
+ */
+static int bst_insert(apol_bst_t * b, void **elem, void *data, apol_bst_free_func * fr)
+{
+	bst_node_t head = { NULL, 0, {NULL, NULL} };
+	bst_node_t *new_node, *g, *t, *p, *q;
+	int dir = 0, last = 0, compval;
+
+	if (b->hash != NULL) {
+		return bst_hash_insert(b, elem, data, fr);
+	}
+	/* obtain the node up front, so that running out of memory
+	 * cannot interrupt the rebalancing below */
+	if ((new_node = bst_pool_get(b)) == NULL) {
+		return -1;
+	}
+	new_node->elem = *elem;
+	new_node->is_red = 1;
+	new_node->child[0] = new_node->child[1] = NULL;
+	if (b->head == NULL) {
+		b->head = new_node;
+		b->head->is_red = 0;
+		b->size++;
+		return 0;
+	}
+
+	t = &head;
+	g = p = NULL;
+	q = t->child[1] = b->head;
+	while (1) {
+		if (q == NULL) {
+			p->child[dir] = q = new_node;
+		} else if (bst_node_is_red(q->child[0]) && bst_node_is_red(q->child[1])) {
+			/* recolor myself and children */
+			q->is_red = 1;
+			q->child[0]->is_red = 0;
+			q->child[1]->is_red = 0;
+		}
+		/* fix a red violation between q and its parent */
+		if (bst_node_is_red(q) && bst_node_is_red(p)) {
+			int dir2 = (t->child[1] == g);
+			if (q == p->child[last]) {
+				t->child[dir2] = bst_rotate_single(g, !last);
 			} else {
-				compval = 0;
+				t->child[dir2] = bst_rotate_double(g, !last);
 			}
 		}
+		if (q == new_node) {
+			b->size++;
+			break;
+		}
+		compval = bst_compare(b, q->elem, *elem, data);
 		if (compval == 0) {
 			/* already exists */
+			bst_pool_put(b, new_node);
 			if (fr != NULL) {
 				fr(*elem);
 			}
-			*elem = root->elem;
-			*not_uniq = 1;
-			return root;
-		} else if (compval > 0) {
-			dir = 0;
-		} else {
-			dir = 1;
+			*elem = q->elem;
+			b->head = head.child[1];
+			b->head->is_red = 0;
+			return 1;
 		}
-		root->child[dir] = bst_insert_recursive(b, root->child[dir], elem, data, fr, not_uniq);
-		if (*not_uniq != 0) {
-			return root;
-		}
-
-		/* rebalance tree */
-		if (bst_node_is_red(root->child[dir])) {
-			if (bst_node_is_red(root->child[!dir])) {
-				/* recolor myself and children.  note
-				 * that this can't be reached if a
-				 * child is NULL */
-				root->is_red = 1;
-				root->child[0]->is_red = 0;
-				root->child[1]->is_red = 0;
-			} else {
-				if (bst_node_is_red(root->child[dir]->child[dir])) {
-					root = bst_rotate_single(root, !dir);
-				} else if (bst_node_is_red(root->child[dir]->child[!dir])) {
-					root = bst_rotate_double(root, !dir);
-				}
-			}
+		last = dir;
+		dir = (compval < 0);
+		if (g != NULL) {
+			t = g;
 		}
+		g = p;
+		p = q;
+		q = q->child[dir];
 	}
-	return root;
+	b->head = head.child[1];
+	b->head->is_red = 0;
+	return 0;
 }
 
 int apol_bst_insert(apol_bst_t * b, void *elem, void *data)
 {
-	int retval = -1;
 	if (!b || !elem) {
 		errno = EINVAL;
 		return -1;
 	}
-	b->head = bst_insert_recursive(b, b->head, &elem, data, NULL, &retval);
-	if (retval >= 0) {
-		b->head->is_red = 0;
-	}
-	return retval;
+	return bst_insert(b, &elem, data, NULL);
 }
 
 int apol_bst_insert_and_get(apol_bst_t * b, void **elem, void *data)
 {
-	int retval = -1;
 	if (!b || !elem) {
 		errno = EINVAL;
 		return -1;
 	}
-	b->head = bst_insert_recursive(b, b->head, elem, data, b->fr, &retval);
-	if (retval >= 0) {
+	return bst_insert(b, elem, data, b->fr);
+}
+
+/**
+ * Remove an element from a red-black tree, top-down in a single pass.
+ *
+ * @return The removed element, or NULL if no element matched.
+ */
+static void *bst_tree_remove(apol_bst_t * b, const void *elem, void *data)
+{
+	bst_node_t head = { NULL, 0, {NULL, NULL} };
+	bst_node_t *q, *p, *g, *found = NULL;
+	void *result = NULL;
+	int dir = 1, last, compval;
+
+	if (b->head == NULL) {
+		return NULL;
+	}
+	q = &head;
+	g = p = NULL;
+	q->child[1] = b->head;
+	/* descend to the in-order predecessor of the matching node
+	 * (or to the matching leaf), pushing a red node down along the
+	 * way so that the final node may be unlinked directly */
+	while (q->child[dir] != NULL) {
+		last = dir;
+		g = p;
+		p = q;
+		q = q->child[dir];
+		compval = bst_compare(b, q->elem, elem, data);
+		dir = (compval < 0);
+		if (compval == 0) {
+			found = q;
+		}
+		if (!bst_node_is_red(q) && !bst_node_is_red(q->child[dir])) {
+			if (bst_node_is_red(q->child[!dir])) {
+				p = p->child[last] = bst_rotate_single(q, dir);
+			} else {
+				bst_node_t *s = p->child[!last];
+				if (s != NULL) {
+					if (!bst_node_is_red(s->child[!last]) && !bst_node_is_red(s->child[last])) {
+						/* color flip */
+						p->is_red = 0;
+						s->is_red = 1;
+						q->is_red = 1;
+					} else {
+						int dir2 = (g->child[1] == p);
+						if (bst_node_is_red(s->child[last])) {
+							g->child[dir2] = bst_rotate_double(p, last);
+						} else {
+							g->child[dir2] = bst_rotate_single(p, last);
+						}
+						q->is_red = g->child[dir2]->is_red = 1;
+						g->child[dir2]->child[0]->is_red = 0;
+						g->child[dir2]->child[1]->is_red = 0;
+					}
+				}
+			}
+		}
+	}
+	if (found != NULL) {
+		result = found->elem;
+		found->elem = q->elem;
+		p->child[p->child[1] == q] = q->child[q->child[0] == NULL];
+		bst_pool_put(b, q);
+		b->size--;
+	}
+	b->head = head.child[1];
+	if (b->head != NULL) {
 		b->head->is_red = 0;
 	}
-	return retval;
+	return result;
 }
 
-static int bst_inorder_map(const bst_node_t * node, int (*fn) (void *, void *), void *data)
+int apol_bst_remove(apol_bst_t * b, const void *elem, void *data, void **result)
 {
-	int retval;
-	if (node == NULL) {
-		return 0;
+	void *removed = NULL;
+	if (!b || !elem) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (b->hash != NULL) {
+		bst_node_t **link = bst_hash_find(b, elem, data), *node;
+		if ((node = *link) != NULL) {
+			*link = node->child[0];
+			removed = node->elem;
+			bst_pool_put(b, node);
+			b->size--;
+		}
+	} else {
+		removed = bst_tree_remove(b, elem, data);
 	}
-	if ((retval = bst_inorder_map(node->child[0], fn, data)) < 0) {
-		return retval;
+	if (removed == NULL) {
+		return -1;
 	}
-	if ((retval = fn(node->elem, data)) < 0) {
-		return retval;
+	if (result != NULL) {
+		*result = removed;
+	} else if (b->fr != NULL) {
+		b->fr(removed);
 	}
-	return bst_inorder_map(node->child[1], fn, data);
+	return 0;
 }
 
 int apol_bst_inorder_map(const apol_bst_t * b, int (*fn) (void *, void *), void *data)
 {
+	apol_vector_t *v;
+	size_t i;
+	int retval = 0;
 	if (b == NULL || fn == NULL)
 		return -1;
-	return bst_inorder_map(b->head, fn, data);
+	if (b->hash == NULL) {
+		return bst_node_inorder_map(b->head, fn, data);
+	}
+	if ((v = bst_sorted_vector(b)) == NULL) {
+		return -1;
+	}
+	for (i = 0; i < apol_vector_get_size(v); i++) {
+		if ((retval = fn(apol_vector_get_element(v, i), data)) < 0) {
+			break;
+		}
+	}
+	apol_vector_destroy(&v);
+	return (retval < 0 ? retval : 0);
 }
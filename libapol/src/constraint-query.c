@@ -29,8 +29,12 @@
  */
 
 #include "policy-query-internal.h"
+#include "bitset.h"
 #include <errno.h>
 #include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
 
 struct apol_constraint_query
 {
@@ -215,3 +219,1016 @@ int apol_validatetrans_query_set_regex(const apol_policy_t * p, apol_validatetra
 {
 	return apol_query_set_regex(p, &vt->flags, is_regex);
 }
+
+/******************** constraint evaluation ********************/
+
+/* kinds of instructions within a compiled expression */
+#define CEXPR_INSN_NOT 1
+#define CEXPR_INSN_AND 2
+#define CEXPR_INSN_OR 3
+/** compare a symbol of the first two contexts */
+#define CEXPR_INSN_SYM 4
+/** compare two levels */
+#define CEXPR_INSN_LEVEL 5
+/** test a symbol for membership within a set */
+#define CEXPR_INSN_NAMES 6
+
+/* indices of symbols within a resolved context */
+#define CEXPR_SYM_USER 0
+#define CEXPR_SYM_ROLE 1
+#define CEXPR_SYM_TYPE 2
+/** only used when counting symbols */
+#define CEXPR_SYM_CLASS 3
+
+/** deepest stack an expression may need; far beyond what any real
+ *  policy uses */
+#define CEXPR_MAX_DEPTH 64
+
+typedef struct cexpr_insn
+{
+	unsigned char kind;
+	/** one of QPOL_CEXPR_OP_* */
+	unsigned char op;
+	/** for CEXPR_INSN_LEVEL, the indices of the two levels compared;
+	 *  for CEXPR_INSN_NAMES, the index of the context tested */
+	unsigned char a, b;
+	/** for CEXPR_INSN_SYM and CEXPR_INSN_NAMES, one of CEXPR_SYM_* */
+	unsigned char sym;
+	/** for CEXPR_INSN_NAMES, the set of symbol values */
+	apol_bitset_t names;
+} cexpr_insn_t;
+
+typedef struct cexpr_program
+{
+	/** the qpol_constraint_t or qpol_validatetrans_t compiled */
+	void *statement;
+	uint32_t class_value;
+	/** permissions to which a constraint applies, with bit
+	 *  (value - 1) set for each; unused for validatetrans */
+	uint32_t perms;
+	cexpr_insn_t *insns;
+	size_t num_insns;
+} cexpr_program_t;
+
+/**
+ * Programs grouped by class; those for class value v are
+ * progs[offsets[v]] through progs[offsets[v + 1] - 1], in the order
+ * the policy lists them.
+ */
+typedef struct cexpr_program_list
+{
+	cexpr_program_t *progs;
+	size_t size;
+	size_t *offsets;
+} cexpr_program_list_t;
+
+struct apol_constraint_engine
+{
+	/** one more than the highest user, role, and type values, by
+	 *  CEXPR_SYM_* */
+	size_t num_syms[3];
+	/** highest class value */
+	uint32_t num_classes;
+	cexpr_program_list_t constraints, validatetrans;
+	/** by role value, the set of roles it dominates; NULL unless
+	 *  some expression compares role dominance */
+	apol_bitset_t *role_dominates;
+};
+
+typedef struct cexpr_level
+{
+	uint32_t sens;
+	/** set of category values */
+	apol_bitset_t cats;
+} cexpr_level_t;
+
+struct apol_constraint_request
+{
+	int is_validatetrans;
+	uint32_t class_value;
+	/** value of the permission; unused for validatetrans */
+	uint32_t perm_value;
+	/** user, role, and type values of the source (or old), target
+	 *  (or new), and task contexts, by CEXPR_SYM_* */
+	uint32_t syms[3][3];
+	/** low and high levels of each of those contexts, in that order */
+	cexpr_level_t levels[6];
+	/** 1 if allowed, 0 if denied, -1 if not yet evaluated */
+	int result;
+	const cexpr_program_t *denier;
+};
+
+static void cexpr_program_release(cexpr_program_t * prog)
+{
+	size_t i;
+	for (i = 0; i < prog->num_insns; i++)
+		apol_bitset_release(&prog->insns[i].names);
+	free(prog->insns);
+	free(prog->statement);
+}
+
+static void cexpr_program_list_release(cexpr_program_list_t * list)
+{
+	size_t i;
+	for (i = 0; i < list->size; i++)
+		cexpr_program_release(list->progs + i);
+	free(list->progs);
+	free(list->offsets);
+}
+
+void apol_constraint_engine_destroy(apol_constraint_engine_t ** e)
+{
+	size_t i;
+	if (!e || !*e)
+		return;
+	cexpr_program_list_release(&(*e)->constraints);
+	cexpr_program_list_release(&(*e)->validatetrans);
+	if ((*e)->role_dominates) {
+		for (i = 0; i < (*e)->num_syms[CEXPR_SYM_ROLE]; i++)
+			apol_bitset_release((*e)->role_dominates + i);
+		free((*e)->role_dominates);
+	}
+	free(*e);
+	*e = NULL;
+}
+
+/**
+ * Find one more than the highest value of a kind of symbol.
+ */
+static int cexpr_count_values(const apol_policy_t * p, unsigned char sym, size_t * num)
+{
+	qpol_iterator_t *iter = NULL;
+	void *item;
+	uint32_t value;
+	int retval = -1;
+	*num = 1;
+	switch (sym) {
+	case CEXPR_SYM_USER:
+		retval = qpol_policy_get_user_iter(p->p, &iter);
+		break;
+	case CEXPR_SYM_ROLE:
+		retval = qpol_policy_get_role_iter(p->p, &iter);
+		break;
+	case CEXPR_SYM_TYPE:
+		retval = qpol_policy_get_type_iter(p->p, &iter);
+		break;
+	default:
+		retval = qpol_policy_get_class_iter(p->p, &iter);
+		break;
+	}
+	if (retval < 0)
+		return -1;
+	retval = -1;
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		if (qpol_iterator_get_item(iter, &item) < 0)
+			goto cleanup;
+		switch (sym) {
+		case CEXPR_SYM_USER:
+			retval = qpol_user_get_value(p->p, item, &value);
+			break;
+		case CEXPR_SYM_ROLE:
+			retval = qpol_role_get_value(p->p, item, &value);
+			break;
+		case CEXPR_SYM_TYPE:
+			retval = qpol_type_get_value(p->p, item, &value);
+			break;
+		default:
+			retval = qpol_class_get_value(p->p, item, &value);
+			break;
+		}
+		if (retval < 0)
+			goto cleanup;
+		if (value >= *num)
+			*num = (size_t) value + 1;
+	}
+	retval = 0;
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	return retval;
+}
+
+static int cexpr_count_symbols(const apol_policy_t * p, apol_constraint_engine_t * e)
+{
+	size_t num_classes;
+	unsigned char sym;
+	for (sym = CEXPR_SYM_USER; sym <= CEXPR_SYM_TYPE; sym++) {
+		if (cexpr_count_values(p, sym, e->num_syms + sym) < 0)
+			return -1;
+	}
+	if (cexpr_count_values(p, CEXPR_SYM_CLASS, &num_classes) < 0)
+		return -1;
+	e->num_classes = (uint32_t) (num_classes - 1);
+	return 0;
+}
+
+/**
+ * Build the set of roles each role dominates, for expressions that
+ * compare role dominance.
+ */
+static int cexpr_build_role_dominates(const apol_policy_t * p, apol_constraint_engine_t * e)
+{
+	qpol_iterator_t *iter = NULL, *dom_iter = NULL;
+	const qpol_role_t *role, *dom;
+	uint32_t value, dom_value;
+	size_t num_roles = e->num_syms[CEXPR_SYM_ROLE], i;
+	int retval = -1;
+	if (!(e->role_dominates = calloc(num_roles, sizeof(*e->role_dominates)))) {
+		ERR(p, "%s", strerror(errno));
+		return -1;
+	}
+	for (i = 0; i < num_roles; i++) {
+		if (apol_bitset_init(e->role_dominates + i, num_roles) < 0) {
+			ERR(p, "%s", strerror(errno));
+			return -1;
+		}
+	}
+	if (qpol_policy_get_role_iter(p->p, &iter) < 0)
+		goto cleanup;
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		if (qpol_iterator_get_item(iter, (void **)&role) < 0 || qpol_role_get_value(p->p, role, &value) < 0 ||
+		    qpol_role_get_dominate_iter(p->p, role, &dom_iter) < 0)
+			goto cleanup;
+		for (; !qpol_iterator_end(dom_iter); qpol_iterator_next(dom_iter)) {
+			if (qpol_iterator_get_item(dom_iter, (void **)&dom) < 0 || qpol_role_get_value(p->p, dom, &dom_value) < 0)
+				goto cleanup;
+			apol_bitset_set(e->role_dominates + value, dom_value, 1);
+		}
+		qpol_iterator_destroy(&dom_iter);
+	}
+	retval = 0;
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	qpol_iterator_destroy(&dom_iter);
+	return retval;
+}
+
+/**
+ * Add a name from an expression's name list to a set of symbol
+ * values.  Attributes are expanded into their member types.
+ */
+static int cexpr_names_add(const apol_policy_t * p, unsigned char sym, const char *name, apol_bitset_t * set)
+{
+	const qpol_user_t *user;
+	const qpol_role_t *role;
+	const qpol_type_t *type;
+	qpol_iterator_t *iter = NULL;
+	unsigned char isattr;
+	uint32_t value;
+	int retval = -1;
+	switch (sym) {
+	case CEXPR_SYM_USER:
+		if (qpol_policy_get_user_by_name(p->p, name, &user) < 0 || qpol_user_get_value(p->p, user, &value) < 0)
+			return -1;
+		break;
+	case CEXPR_SYM_ROLE:
+		if (qpol_policy_get_role_by_name(p->p, name, &role) < 0 || qpol_role_get_value(p->p, role, &value) < 0)
+			return -1;
+		break;
+	default:
+		if (qpol_policy_get_type_by_name(p->p, name, &type) < 0 || qpol_type_get_isattr(p->p, type, &isattr) < 0)
+			return -1;
+		if (!isattr) {
+			if (qpol_type_get_value(p->p, type, &value) < 0)
+				return -1;
+			break;
+		}
+		if (qpol_type_get_type_iter(p->p, type, &iter) < 0)
+			return -1;
+		for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+			if (qpol_iterator_get_item(iter, (void **)&type) < 0 || qpol_type_get_value(p->p, type, &value) < 0)
+				goto cleanup;
+			apol_bitset_set(set, value, 1);
+		}
+		retval = 0;
+		goto cleanup;
+	}
+	apol_bitset_set(set, value, 1);
+	retval = 0;
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	return retval;
+}
+
+/**
+ * Resolve the name list of an expression node into a set of symbol
+ * values.  The expanded list is used, so attributes, subtracted
+ * types, '*', and '~' have already been applied.
+ */
+static int cexpr_names_resolve(const apol_policy_t * p, const apol_constraint_engine_t * e,
+			       const qpol_constraint_expr_node_t * node, cexpr_insn_t * insn)
+{
+	qpol_iterator_t *iter = NULL;
+	char *name = NULL;
+	int retval = -1;
+	if (apol_bitset_init(&insn->names, e->num_syms[insn->sym]) < 0) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	if (qpol_constraint_expr_node_get_expanded_names_iter(p->p, node, &iter) < 0)
+		goto cleanup;
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		if (qpol_iterator_get_item(iter, (void **)&name) < 0 || cexpr_names_add(p, insn->sym, name, &insn->names) < 0)
+			goto cleanup;
+		free(name);
+		name = NULL;
+	}
+	retval = 0;
+      cleanup:
+	free(name);
+	qpol_iterator_destroy(&iter);
+	return retval;
+}
+
+/**
+ * Compile a single expression node into an instruction.
+ */
+static int cexpr_insn_compile(const apol_policy_t * p, apol_constraint_engine_t * e, const qpol_constraint_expr_node_t * node,
+			      cexpr_insn_t * insn)
+{
+	uint32_t expr_type, sym_type, op;
+	if (qpol_constraint_expr_node_get_expr_type(p->p, node, &expr_type) < 0)
+		return -1;
+	switch (expr_type) {
+	case QPOL_CEXPR_TYPE_NOT:
+		insn->kind = CEXPR_INSN_NOT;
+		return 0;
+	case QPOL_CEXPR_TYPE_AND:
+		insn->kind = CEXPR_INSN_AND;
+		return 0;
+	case QPOL_CEXPR_TYPE_OR:
+		insn->kind = CEXPR_INSN_OR;
+		return 0;
+	case QPOL_CEXPR_TYPE_ATTR:
+	case QPOL_CEXPR_TYPE_NAMES:
+		break;
+	default:
+		ERR(p, "Unknown constraint expression type %u.", expr_type);
+		errno = EINVAL;
+		return -1;
+	}
+	if (qpol_constraint_expr_node_get_sym_type(p->p, node, &sym_type) < 0 ||
+	    qpol_constraint_expr_node_get_op(p->p, node, &op) < 0)
+		return -1;
+	insn->op = (unsigned char)op;
+	if (sym_type & QPOL_CEXPR_SYM_USER)
+		insn->sym = CEXPR_SYM_USER;
+	else if (sym_type & QPOL_CEXPR_SYM_ROLE)
+		insn->sym = CEXPR_SYM_ROLE;
+	else
+		insn->sym = CEXPR_SYM_TYPE;
+
+	if (expr_type == QPOL_CEXPR_TYPE_NAMES) {
+		insn->kind = CEXPR_INSN_NAMES;
+		if (sym_type & QPOL_CEXPR_SYM_TARGET)
+			insn->a = 1;
+		else if (sym_type & QPOL_CEXPR_SYM_XTARGET)
+			insn->a = 2;
+		else
+			insn->a = 0;
+		return cexpr_names_resolve(p, e, node, insn);
+	}
+
+	/* levels are numbered low then high, source then target */
+	insn->kind = CEXPR_INSN_LEVEL;
+	switch (sym_type) {
+	case QPOL_CEXPR_SYM_L1L2:
+		insn->a = 0;
+		insn->b = 2;
+		break;
+	case QPOL_CEXPR_SYM_L1H2:
+		insn->a = 0;
+		insn->b = 3;
+		break;
+	case QPOL_CEXPR_SYM_H1L2:
+		insn->a = 1;
+		insn->b = 2;
+		break;
+	case QPOL_CEXPR_SYM_H1H2:
+		insn->a = 1;
+		insn->b = 3;
+		break;
+	case QPOL_CEXPR_SYM_L1H1:
+		insn->a = 0;
+		insn->b = 1;
+		break;
+	case QPOL_CEXPR_SYM_L2H2:
+		insn->a = 2;
+		insn->b = 3;
+		break;
+	default:
+		insn->kind = CEXPR_INSN_SYM;
+		if (op != QPOL_CEXPR_OP_EQ && op != QPOL_CEXPR_OP_NEQ) {
+			if (insn->sym != CEXPR_SYM_ROLE) {
+				ERR(p, "Invalid operator %u upon users or types.", op);
+				errno = EINVAL;
+				return -1;
+			}
+			if (!e->role_dominates && cexpr_build_role_dominates(p, e) < 0)
+				return -1;
+		}
+		break;
+	}
+	return 0;
+}
+
+/**
+ * Compile an expression into a program, checking that the
+ * expression is well formed so that evaluation need not.
+ */
+static int cexpr_program_compile(const apol_policy_t * p, apol_constraint_engine_t * e, qpol_iterator_t * iter,
+				 cexpr_program_t * prog)
+{
+	qpol_constraint_expr_node_t *node;
+	size_t num_nodes, depth = 0;
+	if (qpol_iterator_get_size(iter, &num_nodes) < 0)
+		return -1;
+	if (!(prog->insns = calloc(num_nodes ? num_nodes : 1, sizeof(*prog->insns)))) {
+		ERR(p, "%s", strerror(errno));
+		return -1;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		cexpr_insn_t *insn;
+		if (prog->num_insns >= num_nodes) {
+			errno = EINVAL;
+			return -1;
+		}
+		insn = prog->insns + prog->num_insns++;
+		if (qpol_iterator_get_item(iter, (void **)&node) < 0 || cexpr_insn_compile(p, e, node, insn) < 0)
+			return -1;
+		switch (insn->kind) {
+		case CEXPR_INSN_NOT:
+			if (depth < 1)
+				goto malformed;
+			break;
+		case CEXPR_INSN_AND:
+		case CEXPR_INSN_OR:
+			if (depth < 2)
+				goto malformed;
+			depth--;
+			break;
+		default:
+			if (++depth > CEXPR_MAX_DEPTH)
+				goto malformed;
+			break;
+		}
+	}
+	if (depth != 1)
+		goto malformed;
+	return 0;
+      malformed:
+	ERR(p, "%s", "Malformed constraint expression.");
+	errno = EINVAL;
+	return -1;
+}
+
+/**
+ * Group a list's programs by class, keeping their relative order.
+ */
+static int cexpr_program_list_group(const apol_policy_t * p, const apol_constraint_engine_t * e, cexpr_program_list_t * list)
+{
+	cexpr_program_t *sorted = NULL;
+	size_t i;
+	if (!(list->offsets = calloc((size_t) e->num_classes + 2, sizeof(*list->offsets)))) {
+		ERR(p, "%s", strerror(errno));
+		return -1;
+	}
+	for (i = 0; i < list->size; i++)
+		list->offsets[list->progs[i].class_value + 1]++;
+	for (i = 1; i <= (size_t) e->num_classes + 1; i++)
+		list->offsets[i] += list->offsets[i - 1];
+	if (list->size == 0)
+		return 0;
+	if (!(sorted = malloc(list->size * sizeof(*sorted)))) {
+		ERR(p, "%s", strerror(errno));
+		return -1;
+	}
+	for (i = 0; i < list->size; i++)
+		sorted[list->offsets[list->progs[i].class_value]++] = list->progs[i];
+	for (i = (size_t) e->num_classes + 1; i > 0; i--)
+		list->offsets[i] = list->offsets[i - 1];
+	list->offsets[0] = 0;
+	free(list->progs);
+	list->progs = sorted;
+	return 0;
+}
+
+/**
+ * Append a new, empty program to a list.
+ */
+static cexpr_program_t *cexpr_program_list_append(const apol_policy_t * p, cexpr_program_list_t * list, size_t capacity)
+{
+	cexpr_program_t *prog;
+	if (!list->progs && !(list->progs = calloc(capacity ? capacity : 1, sizeof(*list->progs)))) {
+		ERR(p, "%s", strerror(errno));
+		return NULL;
+	}
+	if (list->size >= capacity) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return NULL;
+	}
+	prog = list->progs + list->size++;
+	memset(prog, 0, sizeof(*prog));
+	return prog;
+}
+
+static int cexpr_compile_constraints(const apol_policy_t * p, apol_constraint_engine_t * e)
+{
+	qpol_iterator_t *iter = NULL, *sub_iter = NULL;
+	const qpol_class_t *obj_class;
+	char *perm = NULL;
+	uint32_t value;
+	size_t capacity;
+	int retval = -1;
+	if (qpol_policy_get_constraint_iter(p->p, &iter) < 0 || qpol_iterator_get_size(iter, &capacity) < 0)
+		goto cleanup;
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		qpol_constraint_t *constraint;
+		cexpr_program_t *prog;
+		if (qpol_iterator_get_item(iter, (void **)&constraint) < 0)
+			goto cleanup;
+		if (!(prog = cexpr_program_list_append(p, &e->constraints, capacity))) {
+			free(constraint);
+			goto cleanup;
+		}
+		prog->statement = constraint;
+		if (qpol_constraint_get_class(p->p, constraint, &obj_class) < 0 ||
+		    qpol_class_get_value(p->p, obj_class, &prog->class_value) < 0 ||
+		    qpol_constraint_get_perm_iter(p->p, constraint, &sub_iter) < 0)
+			goto cleanup;
+		for (; !qpol_iterator_end(sub_iter); qpol_iterator_next(sub_iter)) {
+			if (qpol_iterator_get_item(sub_iter, (void **)&perm) < 0 ||
+			    qpol_class_get_perm_value(p->p, obj_class, perm, &value) < 0)
+				goto cleanup;
+			if (value >= 1 && value <= 32)
+				prog->perms |= (uint32_t) 1 << (value - 1);
+			free(perm);
+			perm = NULL;
+		}
+		qpol_iterator_destroy(&sub_iter);
+		if (qpol_constraint_get_expr_iter(p->p, constraint, &sub_iter) < 0 ||
+		    cexpr_program_compile(p, e, sub_iter, prog) < 0)
+			goto cleanup;
+		qpol_iterator_destroy(&sub_iter);
+	}
+	retval = cexpr_program_list_group(p, e, &e->constraints);
+      cleanup:
+	free(perm);
+	qpol_iterator_destroy(&iter);
+	qpol_iterator_destroy(&sub_iter);
+	return retval;
+}
+
+static int cexpr_compile_validatetrans(const apol_policy_t * p, apol_constraint_engine_t * e)
+{
+	qpol_iterator_t *iter = NULL, *sub_iter = NULL;
+	const qpol_class_t *obj_class;
+	size_t capacity;
+	int retval = -1;
+	if (qpol_policy_get_validatetrans_iter(p->p, &iter) < 0 || qpol_iterator_get_size(iter, &capacity) < 0)
+		goto cleanup;
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		qpol_validatetrans_t *validatetrans;
+		cexpr_program_t *prog;
+		if (qpol_iterator_get_item(iter, (void **)&validatetrans) < 0)
+			goto cleanup;
+		if (!(prog = cexpr_program_list_append(p, &e->validatetrans, capacity))) {
+			free(validatetrans);
+			goto cleanup;
+		}
+		prog->statement = validatetrans;
+		if (qpol_validatetrans_get_class(p->p, validatetrans, &obj_class) < 0 ||
+		    qpol_class_get_value(p->p, obj_class, &prog->class_value) < 0 ||
+		    qpol_validatetrans_get_expr_iter(p->p, validatetrans, &sub_iter) < 0 ||
+		    cexpr_program_compile(p, e, sub_iter, prog) < 0)
+			goto cleanup;
+		qpol_iterator_destroy(&sub_iter);
+	}
+	retval = cexpr_program_list_group(p, e, &e->validatetrans);
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	qpol_iterator_destroy(&sub_iter);
+	return retval;
+}
+
+apol_constraint_engine_t *apol_constraint_engine_create(const apol_policy_t * p)
+{
+	apol_constraint_engine_t *e = NULL;
+	int error;
+	if (!p) {
+		errno = EINVAL;
+		return NULL;
+	}
+	if (!(e = calloc(1, sizeof(*e)))) {
+		ERR(p, "%s", strerror(errno));
+		return NULL;
+	}
+	if (cexpr_count_symbols(p, e) < 0 || cexpr_compile_constraints(p, e) < 0 || cexpr_compile_validatetrans(p, e) < 0) {
+		error = errno;
+		apol_constraint_engine_destroy(&e);
+		errno = error;
+		return NULL;
+	}
+	return e;
+}
+
+static int cexpr_level_eq(const cexpr_level_t * l1, const cexpr_level_t * l2)
+{
+	return l1->sens == l2->sens && apol_bitset_is_subset(&l1->cats, &l2->cats) &&
+		apol_bitset_is_subset(&l2->cats, &l1->cats);
+}
+
+static int cexpr_level_dom(const cexpr_level_t * l1, const cexpr_level_t * l2)
+{
+	return l1->sens >= l2->sens && apol_bitset_is_subset(&l2->cats, &l1->cats);
+}
+
+/**
+ * Compare two values of the same kind of symbol.  As in the kernel,
+ * dominance is only defined for roles.
+ */
+static int cexpr_sym_compare(const apol_constraint_engine_t * e, const cexpr_insn_t * insn, uint32_t v1, uint32_t v2)
+{
+	int dom, domby;
+	switch (insn->op) {
+	case QPOL_CEXPR_OP_EQ:
+		return v1 == v2;
+	case QPOL_CEXPR_OP_NEQ:
+		return v1 != v2;
+	}
+	dom = (v1 < e->num_syms[CEXPR_SYM_ROLE] && apol_bitset_get(e->role_dominates + v1, v2));
+	domby = (v2 < e->num_syms[CEXPR_SYM_ROLE] && apol_bitset_get(e->role_dominates + v2, v1));
+	switch (insn->op) {
+	case QPOL_CEXPR_OP_DOM:
+		return dom;
+	case QPOL_CEXPR_OP_DOMBY:
+		return domby;
+	default:
+		return !dom && !domby;
+	}
+}
+
+static int cexpr_level_compare(unsigned char op, const cexpr_level_t * l1, const cexpr_level_t * l2)
+{
+	switch (op) {
+	case QPOL_CEXPR_OP_EQ:
+		return cexpr_level_eq(l1, l2);
+	case QPOL_CEXPR_OP_NEQ:
+		return !cexpr_level_eq(l1, l2);
+	case QPOL_CEXPR_OP_DOM:
+		return cexpr_level_dom(l1, l2);
+	case QPOL_CEXPR_OP_DOMBY:
+		return cexpr_level_dom(l2, l1);
+	default:
+		return !cexpr_level_dom(l1, l2) && !cexpr_level_dom(l2, l1);
+	}
+}
+
+/**
+ * Run a compiled program against a request.  This only reads the
+ * engine and request, and so may be called by several threads at
+ * once.
+ */
+static int cexpr_program_eval(const apol_constraint_engine_t * e, const cexpr_program_t * prog,
+			      const apol_constraint_request_t * r)
+{
+	unsigned char stack[CEXPR_MAX_DEPTH];
+	size_t i, sp = 0;
+	for (i = 0; i < prog->num_insns; i++) {
+		const cexpr_insn_t *insn = prog->insns + i;
+		int val;
+		switch (insn->kind) {
+		case CEXPR_INSN_NOT:
+			stack[sp - 1] = !stack[sp - 1];
+			continue;
+		case CEXPR_INSN_AND:
+			sp--;
+			stack[sp - 1] = stack[sp - 1] && stack[sp];
+			continue;
+		case CEXPR_INSN_OR:
+			sp--;
+			stack[sp - 1] = stack[sp - 1] || stack[sp];
+			continue;
+		case CEXPR_INSN_SYM:
+			val = cexpr_sym_compare(e, insn, r->syms[0][insn->sym], r->syms[1][insn->sym]);
+			break;
+		case CEXPR_INSN_LEVEL:
+			val = cexpr_level_compare(insn->op, r->levels + insn->a, r->levels + insn->b);
+			break;
+		default:
+			val = apol_bitset_get(&insn->names, r->syms[insn->a][insn->sym]);
+			if (insn->op == QPOL_CEXPR_OP_NEQ)
+				val = !val;
+			break;
+		}
+		stack[sp++] = (unsigned char)val;
+	}
+	return stack[0];
+}
+
+static void cexpr_request_eval(const apol_constraint_engine_t * e, apol_constraint_request_t * r)
+{
+	const cexpr_program_list_t *list = (r->is_validatetrans ? &e->validatetrans : &e->constraints);
+	size_t i;
+	r->result = 1;
+	r->denier = NULL;
+	if (r->class_value > e->num_classes)
+		return;
+	for (i = list->offsets[r->class_value]; i < list->offsets[r->class_value + 1]; i++) {
+		const cexpr_program_t *prog = list->progs + i;
+		if (!r->is_validatetrans && !(prog->perms & ((uint32_t) 1 << (r->perm_value - 1))))
+			continue;
+		if (!cexpr_program_eval(e, prog, r)) {
+			r->result = 0;
+			r->denier = prog;
+			return;
+		}
+	}
+}
+
+int apol_constraint_engine_check(const apol_policy_t * p, const apol_constraint_engine_t * e, apol_constraint_request_t * r)
+{
+	if (!p || !e || !r) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	cexpr_request_eval(e, r);
+	return r->result;
+}
+
+typedef struct cexpr_worker
+{
+	const apol_constraint_engine_t *engine;
+	const apol_vector_t *requests;
+	/** range of requests this worker evaluates */
+	size_t start, end;
+	pthread_t thread;
+} cexpr_worker_t;
+
+static void *cexpr_worker_run(void *arg)
+{
+	cexpr_worker_t *w = arg;
+	size_t i;
+	for (i = w->start; i < w->end; i++)
+		cexpr_request_eval(w->engine, apol_vector_get_element(w->requests, i));
+	return NULL;
+}
+
+int apol_constraint_engine_check_batch(const apol_policy_t * p, const apol_constraint_engine_t * e,
+				       const apol_vector_t * requests, unsigned int num_threads)
+{
+	cexpr_worker_t *workers = NULL;
+	size_t size;
+	unsigned int i, num_started = 0;
+	int error = 0;
+	if (!p || !e || !requests) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	size = apol_vector_get_size(requests);
+	if (size == 0)
+		return 0;
+	if (num_threads == 0) {
+		long n = sysconf(_SC_NPROCESSORS_ONLN);
+		num_threads = (n > 0 ? (unsigned int)n : 1);
+	}
+	if (num_threads > size)
+		num_threads = (unsigned int)size;
+	if (!(workers = calloc(num_threads, sizeof(*workers)))) {
+		error = errno;
+		ERR(p, "%s", strerror(error));
+		errno = error;
+		return -1;
+	}
+	/* requests are split into contiguous shares, so that each
+	 * thread walks its own part of the vector */
+	for (i = 0; i < num_threads; i++) {
+		workers[i].engine = e;
+		workers[i].requests = requests;
+		workers[i].start = size * i / num_threads;
+		workers[i].end = size * (i + 1) / num_threads;
+	}
+	/* the calling thread does the first share of the work itself */
+	for (i = 1; i < num_threads; i++) {
+		if ((error = pthread_create(&workers[i].thread, NULL, cexpr_worker_run, workers + i)) != 0) {
+			ERR(p, "%s", strerror(error));
+			break;
+		}
+		num_started++;
+	}
+	if (error == 0)
+		cexpr_worker_run(workers);
+	for (i = 1; i <= num_started; i++)
+		pthread_join(workers[i].thread, NULL);
+	free(workers);
+	if (error) {
+		errno = error;
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Resolve a level into its sensitivity and category values.
+ */
+static int cexpr_level_resolve(const apol_policy_t * p, const apol_mls_level_t * level, cexpr_level_t * l)
+{
+	const char *sens = apol_mls_level_get_sens(level);
+	const apol_vector_t *cats = apol_mls_level_get_cats(level);
+	const qpol_level_t *level_datum;
+	const qpol_cat_t *cat;
+	uint32_t value, max_value = 0;
+	size_t i;
+	if (!sens || !cats) {
+		ERR(p, "%s", "Levels must be complete and not literal.");
+		errno = EINVAL;
+		return -1;
+	}
+	if (qpol_policy_get_level_by_name(p->p, sens, &level_datum) < 0 ||
+	    qpol_level_get_value(p->p, level_datum, &l->sens) < 0)
+		return -1;
+	for (i = 0; i < apol_vector_get_size(cats); i++) {
+		if (qpol_policy_get_cat_by_name(p->p, apol_vector_get_element(cats, i), &cat) < 0 ||
+		    qpol_cat_get_value(p->p, cat, &value) < 0)
+			return -1;
+		if (value > max_value)
+			max_value = value;
+	}
+	if (apol_bitset_init(&l->cats, (size_t) max_value + 1) < 0) {
+		ERR(p, "%s", strerror(errno));
+		return -1;
+	}
+	for (i = 0; i < apol_vector_get_size(cats); i++) {
+		qpol_policy_get_cat_by_name(p->p, apol_vector_get_element(cats, i), &cat);
+		qpol_cat_get_value(p->p, cat, &value);
+		apol_bitset_set(&l->cats, value, 1);
+	}
+	return 0;
+}
+
+/**
+ * Resolve one of a request's contexts into values.
+ */
+static int cexpr_context_resolve(const apol_policy_t * p, const apol_context_t * context, apol_constraint_request_t * r,
+				 size_t idx)
+{
+	const char *user = apol_context_get_user(context);
+	const char *role = apol_context_get_role(context);
+	const char *type = apol_context_get_type(context);
+	const apol_mls_range_t *range = apol_context_get_range(context);
+	const apol_mls_level_t *low, *high;
+	const qpol_user_t *user_datum;
+	const qpol_role_t *role_datum;
+	const qpol_type_t *type_datum;
+	if (!user || !role || !type) {
+		ERR(p, "%s", "Contexts must have a user, role, and type.");
+		errno = EINVAL;
+		return -1;
+	}
+	if (qpol_policy_get_user_by_name(p->p, user, &user_datum) < 0 ||
+	    qpol_user_get_value(p->p, user_datum, &r->syms[idx][CEXPR_SYM_USER]) < 0 ||
+	    qpol_policy_get_role_by_name(p->p, role, &role_datum) < 0 ||
+	    qpol_role_get_value(p->p, role_datum, &r->syms[idx][CEXPR_SYM_ROLE]) < 0 ||
+	    qpol_policy_get_type_by_name(p->p, type, &type_datum) < 0 ||
+	    qpol_type_get_value(p->p, type_datum, &r->syms[idx][CEXPR_SYM_TYPE]) < 0)
+		return -1;
+	if (!range) {
+		if (apol_policy_is_mls(p)) {
+			ERR(p, "%s", "Contexts must have a range within an MLS policy.");
+			errno = EINVAL;
+			return -1;
+		}
+		return 0;
+	}
+	low = apol_mls_range_get_low(range);
+	if ((high = apol_mls_range_get_high(range)) == NULL)
+		high = low;
+	if (!low) {
+		ERR(p, "%s", "Ranges must have a low level.");
+		errno = EINVAL;
+		return -1;
+	}
+	if (cexpr_level_resolve(p, low, r->levels + 2 * idx) < 0 || cexpr_level_resolve(p, high, r->levels + 2 * idx + 1) < 0)
+		return -1;
+	return 0;
+}
+
+/**
+ * Allocate a request and resolve its contexts and class.
+ */
+static apol_constraint_request_t *cexpr_request_create(const apol_policy_t * p, const apol_context_t ** contexts,
+						       size_t num_contexts, const char *obj_class,
+						       const qpol_class_t ** class_datum)
+{
+	apol_constraint_request_t *r = NULL;
+	size_t i;
+	int error;
+	if (!p || !obj_class) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return NULL;
+	}
+	for (i = 0; i < num_contexts; i++) {
+		if (!contexts[i]) {
+			ERR(p, "%s", strerror(EINVAL));
+			errno = EINVAL;
+			return NULL;
+		}
+	}
+	if (!(r = calloc(1, sizeof(*r)))) {
+		ERR(p, "%s", strerror(errno));
+		return NULL;
+	}
+	r->result = -1;
+	for (i = 0; i < num_contexts; i++) {
+		if (cexpr_context_resolve(p, contexts[i], r, i) < 0)
+			goto err;
+	}
+	if (qpol_policy_get_class_by_name(p->p, obj_class, class_datum) < 0 ||
+	    qpol_class_get_value(p->p, *class_datum, &r->class_value) < 0)
+		goto err;
+	return r;
+      err:
+	error = errno;
+	apol_constraint_request_destroy(&r);
+	errno = error;
+	return NULL;
+}
+
+apol_constraint_request_t *apol_constraint_request_create(const apol_policy_t * p, const apol_context_t * scontext,
+							  const apol_context_t * tcontext, const char *obj_class, const char *perm)
+{
+	const apol_context_t *contexts[2] = { scontext, tcontext };
+	const qpol_class_t *class_datum;
+	apol_constraint_request_t *r;
+	if (!perm) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return NULL;
+	}
+	if (!(r = cexpr_request_create(p, contexts, 2, obj_class, &class_datum)))
+		return NULL;
+	if (qpol_class_get_perm_value(p->p, class_datum, perm, &r->perm_value) < 0 || r->perm_value < 1 || r->perm_value > 32) {
+		ERR(p, "Permission %s is not defined for class %s.", perm, obj_class);
+		apol_constraint_request_destroy(&r);
+		errno = ENOENT;
+		return NULL;
+	}
+	return r;
+}
+
+apol_constraint_request_t *apol_constraint_request_create_validatetrans(const apol_policy_t * p,
+									const apol_context_t * oldcontext,
+									const apol_context_t * newcontext,
+									const apol_context_t * taskcontext, const char *obj_class)
+{
+	const apol_context_t *contexts[3] = { oldcontext, newcontext, taskcontext };
+	const qpol_class_t *class_datum;
+	apol_constraint_request_t *r;
+	if (!(r = cexpr_request_create(p, contexts, 3, obj_class, &class_datum)))
+		return NULL;
+	r->is_validatetrans = 1;
+	return r;
+}
+
+void apol_constraint_request_destroy(apol_constraint_request_t ** r)
+{
+	size_t i;
+	if (!r || !*r)
+		return;
+	for (i = 0; i < sizeof((*r)->levels) / sizeof((*r)->levels[0]); i++)
+		apol_bitset_release(&(*r)->levels[i].cats);
+	free(*r);
+	*r = NULL;
+}
+
+void apol_constraint_request_free(void *r)
+{
+	apol_constraint_request_t *request = r;
+	apol_constraint_request_destroy(&request);
+}
+
+int apol_constraint_request_get_result(const apol_constraint_request_t * r)
+{
+	if (!r) {
+		errno = EINVAL;
+		return -1;
+	}
+	return r->result;
+}
+
+const qpol_constraint_t *apol_constraint_request_get_constraint(const apol_constraint_request_t * r)
+{
+	if (!r || r->is_validatetrans || !r->denier)
+		return NULL;
+	return r->denier->statement;
+}
+
+const qpol_validatetrans_t *apol_constraint_request_get_validatetrans(const apol_constraint_request_t * r)
+{
+	if (!r || !r->is_validatetrans || !r->denier)
+		return NULL;
+	return r->denier->statement;
+}
@@ -27,50 +27,107 @@
 #include "domain-trans-analysis-internal.h"
 #include <apol/domain-trans-analysis.h>
 #include <apol/bst.h>
+#include "bitset.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <errno.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
 
 /* private data structure definitions */
-struct apol_domain_trans_table
+
+/**
+ * A growable array of rule nodes.  Once the table is built each list
+ * is sorted by type value so that all rules for a given type are
+ * adjacent and may be found with a binary search.
+ */
+typedef struct rule_list
 {
-	apol_bst_t *domain_table;
-	apol_bst_t *entrypoint_table;
-};
+	void *nodes;
+	size_t size;
+	size_t capacity;
+} rule_list_t;
 
 typedef struct dom_node
 {
 	const qpol_type_t *type;
-	apol_bst_t *process_transition_tree;
-	apol_bst_t *entrypoint_tree;
+	/** end types to which this domain has process transition */
+	apol_bitset_t proc_trans_targets;
+	/** types which may be an entrypoint into this domain */
+	apol_bitset_t entrypoint_targets;
+	/** avrule_node_t, sorted by the value of the end type */
+	rule_list_t proc_trans_rules;
+	/** avrule_node_t, sorted by the value of the entrypoint type */
+	rule_list_t entrypoint_rules;
 	apol_vector_t *setexec_rules;
 } dom_node_t;
 
 typedef struct ep_node
 {
 	const qpol_type_t *type;
-	apol_bst_t *execute_tree;
-	apol_bst_t *type_transition_tree;
+	/** domains which may execute this type */
+	apol_bitset_t exec_sources;
+	/** avrule_node_t, sorted by the value of the executing domain */
+	rule_list_t execute_rules;
+	/** terule_node_t, sorted by the value of the source and then
+	 *  default type */
+	rule_list_t type_transition_rules;
 } ep_node_t;
 
 typedef struct avrule_node
 {
+	uint32_t value;
 	const qpol_type_t *type;
 	const qpol_avrule_t *rule;
-	bool used;
+	/** table generation during which this node was last used */
+	unsigned int used;
 } avrule_node_t;
 
 typedef struct terule_node
 {
+	uint32_t src_value;
+	uint32_t dflt_value;
 	const qpol_type_t *src;
 	const qpol_type_t *dflt;
 	const qpol_terule_t *rule;
-	bool used;
+	/** table generation during which this node was last used */
+	unsigned int used;
 } terule_node_t;
 
+/**
+ * The domain transition table.  Every array is indexed by type value,
+ * thus a type's nodes are found in constant time.  Slots are NULL (or
+ * empty bitsets) for types that take no part in any transition.
+ */
+struct apol_domain_trans_table
+{
+	/** number of slots in each array; one more than the highest
+	 *  type value within the policy */
+	size_t size;
+	/** the primary type for each value */
+	const qpol_type_t **types;
+	/** domain nodes for types that are the source of process
+	 *  transition, entrypoint, or setexec rules */
+	dom_node_t **domains;
+	/** entrypoint nodes for types that are the target of file
+	 *  execute or process type_transition rules */
+	ep_node_t **entrypoints;
+	/** for each domain, the types it may execute */
+	apol_bitset_t *exec_targets;
+	/** for each domain, the domains which may transition into it */
+	apol_bitset_t *proc_trans_sources;
+	/** the current analysis generation; a rule node is used if
+	 *  and only if its used field equals this value, thus resetting
+	 *  the table need only increment it */
+	unsigned int generation;
+	bool requires_setexec_or_type_trans;
+};
+
 /* public data structure definitions */
 struct apol_domain_trans_analysis
 {
@@ -82,6 +139,10 @@ struct apol_domain_trans_analysis
 	apol_vector_t *access_classes;
 	apol_vector_t *access_perms;
 	regex_t *result_regex;
+	/** for multi-hop path searches */
+	char *end_type;
+	unsigned int max_depth;
+	unsigned int path_reqs;
 };
 
 struct apol_domain_trans_result
@@ -100,141 +161,174 @@ struct apol_domain_trans_result
 	apol_vector_t *access_rules;
 };
 
+struct apol_domain_trans_path
+{
+	/** vector of apol_domain_trans_result_t, from start to end */
+	apol_vector_t *steps;
+};
+
 /* private functions */
+/* rule_list */
+static void *rule_list_append(rule_list_t * list, size_t elem_size)
+{
+	void *elem;
+	if (list->size >= list->capacity) {
+		size_t new_cap = (list->capacity ? list->capacity * 2 : 4);
+		void *tmp = realloc(list->nodes, new_cap * elem_size);
+		if (!tmp)
+			return NULL;
+		list->nodes = tmp;
+		list->capacity = new_cap;
+	}
+	elem = (char *)list->nodes + list->size * elem_size;
+	memset(elem, 0, elem_size);
+	list->size++;
+	return elem;
+}
+
+/**
+ * Sort a rule list and then remove duplicate entries, such that each
+ * (type, rule) pair appears only once.
+ */
+static void rule_list_sort_uniquify(rule_list_t * list, size_t elem_size, int (*cmp) (const void *, const void *))
+{
+	size_t i, j;
+	if (list->size < 2)
+		return;
+	qsort(list->nodes, list->size, elem_size, cmp);
+	for (i = 0, j = 1; j < list->size; j++) {
+		char *prev = (char *)list->nodes + i * elem_size;
+		char *cur = (char *)list->nodes + j * elem_size;
+		if (cmp(prev, cur) != 0) {
+			i++;
+			if (i != j)
+				memcpy((char *)list->nodes + i * elem_size, cur, elem_size);
+		}
+	}
+	list->size = i + 1;
+}
+
+static void rule_list_release(rule_list_t * list)
+{
+	free(list->nodes);
+	list->nodes = NULL;
+	list->size = list->capacity = 0;
+}
+
 /* avrule_node */
-static int avrule_node_cmp(const void *a, const void *b, void *data __attribute__ ((unused)))
+static int avrule_node_cmp(const void *a, const void *b)
 {
 	const avrule_node_t *an = a;
 	const avrule_node_t *bn = b;
-	ssize_t retv = (const char *)an->type - (const char *)bn->type;
-	if (retv > 0)
-		return 1;
-	else if (retv < 0)
-		return -1;
-	retv = (const char *)an->rule - (const char *)bn->rule;
-	if (retv > 0)
-		return 1;
-	else if (retv < 0)
-		return -1;
+	if (an->value != bn->value)
+		return (an->value < bn->value ? -1 : 1);
+	if ((const char *)an->rule != (const char *)bn->rule)
+		return ((const char *)an->rule < (const char *)bn->rule ? -1 : 1);
 	return 0;
 }
 
-static int avrule_node_reset(void *a, void *b __attribute__ ((unused)))
+static void avrule_node_reset(avrule_node_t * n)
 {
-	avrule_node_t *an = a;
-	if (!a)
-		return -1;
-	an->used = false;
-	return 0;
+	n->used = 0;
 }
 
-static avrule_node_t *avrule_node_create(const qpol_type_t * type, const qpol_avrule_t * rule)
-{
-	avrule_node_t *n = calloc(1, sizeof(*n));
-	if (!n)
-		return NULL;
-
-	n->type = type;
-	n->rule = rule;
-
-	return n;
+/**
+ * Return the first node within a sorted list of avrule_node_t whose
+ * type has the given value, and set *num to the number of adjacent
+ * nodes for that value.
+ */
+static avrule_node_t *avrule_list_find(const rule_list_t * list, uint32_t value, size_t * num)
+{
+	avrule_node_t *nodes = list->nodes;
+	size_t lo = 0, hi = list->size, end;
+	*num = 0;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (nodes[mid].value < value)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	for (end = lo; end < list->size && nodes[end].value == value; end++) ;
+	*num = end - lo;
+	return (*num ? nodes + lo : NULL);
 }
 
 /* terule_node */
-static int terule_node_cmp(const void *a, const void *b, void *data __attribute__ ((unused)))
+static int terule_node_cmp(const void *a, const void *b)
 {
 	const terule_node_t *an = a;
 	const terule_node_t *bn = b;
-	ssize_t retv = (const char *)an->src - (const char *)bn->src;
-	if (retv > 0)
-		return 1;
-	else if (retv < 0)
-		return -1;
-	retv = (const char *)an->dflt - (const char *)bn->dflt;
-	if (retv > 0)
-		return 1;
-	else if (retv < 0)
-		return -1;
-	retv = (const char *)an->rule - (const char *)bn->rule;
-	if (retv > 0)
-		return 1;
-	else if (retv < 0)
-		return -1;
+	if (an->src_value != bn->src_value)
+		return (an->src_value < bn->src_value ? -1 : 1);
+	if (an->dflt_value != bn->dflt_value)
+		return (an->dflt_value < bn->dflt_value ? -1 : 1);
+	if ((const char *)an->rule != (const char *)bn->rule)
+		return ((const char *)an->rule < (const char *)bn->rule ? -1 : 1);
 	return 0;
 }
 
-static int terule_node_reset(void *a, void *b __attribute__ ((unused)))
-{
-	terule_node_t *an = a;
-	if (!a)
-		return -1;
-	an->used = false;
-	return 0;
+/**
+ * Return the first node within a sorted list of terule_node_t whose
+ * source type has the given value, and set *num to the number of
+ * adjacent nodes for that source.
+ */
+static terule_node_t *terule_list_find(const rule_list_t * list, uint32_t src_value, size_t * num)
+{
+	terule_node_t *nodes = list->nodes;
+	size_t lo = 0, hi = list->size, end;
+	*num = 0;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (nodes[mid].src_value < src_value)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	for (end = lo; end < list->size && nodes[end].src_value == src_value; end++) ;
+	*num = end - lo;
+	return (*num ? nodes + lo : NULL);
 }
 
-static terule_node_t *terule_node_create(const qpol_type_t * src, const qpol_type_t * dflt, const qpol_terule_t * rule)
+static void terule_node_reset(terule_node_t * n)
 {
-	terule_node_t *n = calloc(1, sizeof(*n));
-	if (!n)
-		return NULL;
-
-	n->src = src;
-	n->dflt = dflt;
-	n->rule = rule;
-
-	return n;
+	n->used = 0;
 }
 
 /* dom_node */
-static int dom_node_cmp(const void *a, const void *b, void *data __attribute__ ((unused)))
-{
-	const dom_node_t *an = a;
-	const dom_node_t *bn = b;
-
-	if ((const char *)(an->type) < (const char *)(bn->type))
-		return -1;
-	else if ((const char *)(an->type) > (const char *)(bn->type))
-		return 1;
-	return 0;
-}
-
-static void dom_node_free(void *x)
+static void dom_node_free(dom_node_t * n)
 {
-	if (!x)
+	if (!n)
 		return;
-	apol_bst_destroy(&(((dom_node_t *) x)->process_transition_tree));
-	apol_bst_destroy(&(((dom_node_t *) x)->entrypoint_tree));
-	apol_vector_destroy(&(((dom_node_t *) x)->setexec_rules));
-	free(x);
+	apol_bitset_release(&n->proc_trans_targets);
+	apol_bitset_release(&n->entrypoint_targets);
+	rule_list_release(&n->proc_trans_rules);
+	rule_list_release(&n->entrypoint_rules);
+	apol_vector_destroy(&n->setexec_rules);
+	free(n);
 }
 
-static int dom_node_reset(void *a, void *b __attribute__ ((unused)))
+static void dom_node_reset(dom_node_t * n)
 {
-	dom_node_t *an = a;
-	if (!a)
-		return -1;
-
-	if (apol_bst_inorder_map(an->process_transition_tree, avrule_node_reset, NULL) < 0)
-		return -1;
-	if (apol_bst_inorder_map(an->entrypoint_tree, avrule_node_reset, NULL) < 0)
-		return -1;
-
-	return 0;
+	size_t i;
+	avrule_node_t *nodes = n->proc_trans_rules.nodes;
+	for (i = 0; i < n->proc_trans_rules.size; i++)
+		avrule_node_reset(nodes + i);
+	nodes = n->entrypoint_rules.nodes;
+	for (i = 0; i < n->entrypoint_rules.size; i++)
+		avrule_node_reset(nodes + i);
 }
 
-static dom_node_t *dom_node_create(const qpol_type_t * type)
+static dom_node_t *dom_node_create(const qpol_type_t * type, size_t num_types)
 {
 	dom_node_t *n = calloc(1, sizeof(*n));
 	if (!n)
 		return NULL;
 
 	n->type = type;
-	if (!(n->process_transition_tree = apol_bst_create(avrule_node_cmp, free)) ||
-	    !(n->entrypoint_tree = apol_bst_create(avrule_node_cmp, free)) || !(n->setexec_rules = apol_vector_create(NULL))) {
-		apol_bst_destroy(&n->process_transition_tree);
-		apol_bst_destroy(&n->entrypoint_tree);
-		apol_vector_destroy(&n->setexec_rules);
-		free(n);
+	if (apol_bitset_init(&n->proc_trans_targets, num_types) || apol_bitset_init(&n->entrypoint_targets, num_types) ||
+	    !(n->setexec_rules = apol_vector_create(NULL))) {
+		dom_node_free(n);
 		return NULL;
 	}
 
@@ -242,52 +336,36 @@ static dom_node_t *dom_node_create(const qpol_type_t * type)
 }
 
 /* ep_node */
-static int ep_node_cmp(const void *a, const void *b, void *data __attribute__ ((unused)))
-{
-	const ep_node_t *an = a;
-	const ep_node_t *bn = b;
-
-	if ((const char *)(an->type) < (const char *)(bn->type))
-		return -1;
-	else if ((const char *)(an->type) > (const char *)(bn->type))
-		return 1;
-	return 0;
-}
-
-static void ep_node_free(void *x)
+static void ep_node_free(ep_node_t * n)
 {
-	if (!x)
+	if (!n)
 		return;
-	apol_bst_destroy(&(((ep_node_t *) x)->type_transition_tree));
-	apol_bst_destroy(&(((ep_node_t *) x)->execute_tree));
-	free(x);
+	apol_bitset_release(&n->exec_sources);
+	rule_list_release(&n->execute_rules);
+	rule_list_release(&n->type_transition_rules);
+	free(n);
 }
 
-static int ep_node_reset(void *a, void *b __attribute__ ((unused)))
+static void ep_node_reset(ep_node_t * n)
 {
-	ep_node_t *an = a;
-	if (!a)
-		return -1;
-
-	if (apol_bst_inorder_map(an->execute_tree, avrule_node_reset, NULL) < 0)
-		return -1;
-	if (apol_bst_inorder_map(an->type_transition_tree, terule_node_reset, NULL) < 0)
-		return -1;
-	return 0;
+	size_t i;
+	avrule_node_t *avnodes = n->execute_rules.nodes;
+	terule_node_t *tenodes = n->type_transition_rules.nodes;
+	for (i = 0; i < n->execute_rules.size; i++)
+		avrule_node_reset(avnodes + i);
+	for (i = 0; i < n->type_transition_rules.size; i++)
+		terule_node_reset(tenodes + i);
 }
 
-static ep_node_t *ep_node_create(const qpol_type_t * type)
+static ep_node_t *ep_node_create(const qpol_type_t * type, size_t num_types)
 {
 	ep_node_t *n = calloc(1, sizeof(*n));
 	if (!n)
 		return NULL;
 
 	n->type = type;
-	if (!(n->execute_tree = apol_bst_create(avrule_node_cmp, free)) ||
-	    !(n->type_transition_tree = apol_bst_create(terule_node_cmp, free))) {
-		apol_bst_destroy(&n->execute_tree);
-		apol_bst_destroy(&n->type_transition_tree);
-		free(n);
+	if (apol_bitset_init(&n->exec_sources, num_types)) {
+		ep_node_free(n);
 		return NULL;
 	}
 
@@ -295,9 +373,20 @@ static ep_node_t *ep_node_create(const qpol_type_t * type)
 }
 
 /* table */
+static bool requires_setexec_or_type_trans(apol_policy_t * policy)
+{
+	const qpol_policy_t *qp = apol_policy_get_qpol(policy);
+	unsigned int policy_version = 0;
+	qpol_policy_get_policy_version(qp, &policy_version);
+	int is_modular = qpol_policy_has_capability(policy->p, QPOL_CAP_MODULES);
+	return (policy_version >= 15 || is_modular);
+}
+
 static apol_domain_trans_table_t *apol_domain_trans_table_new(apol_policy_t * policy)
 {
 	apol_domain_trans_table_t *new_table = NULL;
+	qpol_iterator_t *iter = NULL;
+	uint32_t max_value = 0;
 	int error;
 
 	if (!policy) {
@@ -313,24 +402,110 @@ static apol_domain_trans_table_t *apol_domain_trans_table_new(apol_policy_t * po
 		goto cleanup;
 	}
 
-	if (!(new_table->domain_table = apol_bst_create(dom_node_cmp, dom_node_free))) {
-		ERR(policy, "%s", strerror(ENOMEM));
-		error = ENOMEM;
+	/* size the table by the highest type value */
+	if (qpol_policy_get_type_iter(policy->p, &iter)) {
+		error = errno;
 		goto cleanup;
 	}
-	if (!(new_table->entrypoint_table = apol_bst_create(ep_node_cmp, ep_node_free))) {
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		const qpol_type_t *type;
+		uint32_t value;
+		qpol_iterator_get_item(iter, (void **)&type);
+		qpol_type_get_value(policy->p, type, &value);
+		if (value > max_value)
+			max_value = value;
+	}
+	new_table->size = (size_t)max_value + 1;
+
+	if (!(new_table->types = calloc(new_table->size, sizeof(*new_table->types))) ||
+	    !(new_table->domains = calloc(new_table->size, sizeof(*new_table->domains))) ||
+	    !(new_table->entrypoints = calloc(new_table->size, sizeof(*new_table->entrypoints))) ||
+	    !(new_table->exec_targets = calloc(new_table->size, sizeof(*new_table->exec_targets))) ||
+	    !(new_table->proc_trans_sources = calloc(new_table->size, sizeof(*new_table->proc_trans_sources)))) {
 		ERR(policy, "%s", strerror(ENOMEM));
 		error = ENOMEM;
 		goto cleanup;
 	}
 
+	/* record the primary type for each value, so that results
+	 * refer to types and not their aliases */
+	qpol_iterator_destroy(&iter);
+	if (qpol_policy_get_type_iter(policy->p, &iter)) {
+		error = errno;
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		const qpol_type_t *type;
+		uint32_t value;
+		unsigned char isalias = 0;
+		qpol_iterator_get_item(iter, (void **)&type);
+		qpol_type_get_isalias(policy->p, type, &isalias);
+		if (isalias)
+			continue;
+		qpol_type_get_value(policy->p, type, &value);
+		new_table->types[value] = type;
+	}
+	qpol_iterator_destroy(&iter);
+
+	new_table->generation = 1;
+	new_table->requires_setexec_or_type_trans = requires_setexec_or_type_trans(policy);
+
 	return new_table;
       cleanup:
+	qpol_iterator_destroy(&iter);
 	domain_trans_table_destroy(&new_table);
 	errno = error;
 	return NULL;
 }
 
+static uint32_t table_type_value(const apol_policy_t * policy, const qpol_type_t * type)
+{
+	uint32_t value = 0;
+	if (type)
+		qpol_type_get_value(policy->p, type, &value);
+	return value;
+}
+
+static dom_node_t *table_get_dom_node(const apol_domain_trans_table_t * table, uint32_t value)
+{
+	if (value == 0 || value >= table->size)
+		return NULL;
+	return table->domains[value];
+}
+
+static ep_node_t *table_get_ep_node(const apol_domain_trans_table_t * table, uint32_t value)
+{
+	if (value == 0 || value >= table->size)
+		return NULL;
+	return table->entrypoints[value];
+}
+
+/**
+ * Set a bit within one of the table's per-type bitsets, allocating
+ * that bitset upon first use.
+ */
+static int table_bitset_set(const apol_domain_trans_table_t * table, apol_bitset_t * sets, uint32_t value, uint32_t bit)
+{
+	if (sets[value].words == NULL && apol_bitset_init(sets + value, table->size))
+		return -1;
+	apol_bitset_set(sets + value, bit, 1);
+	return 0;
+}
+
+static dom_node_t *table_get_or_create_dom_node(apol_domain_trans_table_t * table, const qpol_type_t * type, uint32_t value)
+{
+	if (!table->domains[value])
+		table->domains[value] = dom_node_create(type, table->size);
+	return table->domains[value];
+}
+
+static ep_node_t *table_get_or_create_ep_node(apol_domain_trans_table_t * table, const qpol_type_t * type, uint32_t value)
+{
+	if (!table->entrypoints[value])
+		table->entrypoints[value] = ep_node_create(type, table->size);
+	return table->entrypoints[value];
+}
+
 static int table_add_avrule(apol_policy_t * policy, apol_domain_trans_table_t * dta_table, const qpol_avrule_t * rule)
 {
 	qpol_policy_t *qp = apol_policy_get_qpol(policy);
@@ -367,17 +542,12 @@ static int table_add_avrule(apol_policy_t * policy, apol_domain_trans_table_t *
 
 	if (proc_trans || ep || setexec) {
 		for (size_t i = 0; i < apol_vector_get_size(sources); i++) {
-			dom_node_t *dnode = NULL;
-			dom_node_t dummy = { apol_vector_get_element(sources, i), NULL, NULL, NULL };
-			if (apol_bst_get_element(dta_table->domain_table, &dummy, NULL, (void **)&dnode)) {
-				dom_node_t *new_dnode = NULL;
-				if (!(new_dnode = dom_node_create(dummy.type)) ||
-				    apol_bst_insert(dta_table->domain_table, (void *)new_dnode, NULL)) {
-					error = errno;
-					dom_node_free(new_dnode);
-					goto err;
-				}
-				dnode = new_dnode;
+			const qpol_type_t *src_type = apol_vector_get_element(sources, i);
+			uint32_t src_value = table_type_value(policy, src_type);
+			dom_node_t *dnode = table_get_or_create_dom_node(dta_table, src_type, src_value);
+			if (!dnode) {
+				error = errno;
+				goto err;
 			}
 			if (setexec) {
 				if (apol_vector_append_unique(dnode->setexec_rules, (void *)rule, NULL, NULL)) {
@@ -386,51 +556,55 @@ static int table_add_avrule(apol_policy_t * policy, apol_domain_trans_table_t *
 				}
 			}
 			for (size_t j = 0; j < apol_vector_get_size(targets); j++) {
+				const qpol_type_t *tgt_type = apol_vector_get_element(targets, j);
+				uint32_t tgt_value = table_type_value(policy, tgt_type);
 				if (proc_trans) {
-					avrule_node_t *new_node =
-						avrule_node_create((const qpol_type_t *)apol_vector_get_element(targets, j), rule);
+					avrule_node_t *new_node = rule_list_append(&dnode->proc_trans_rules, sizeof(*new_node));
 					if (!new_node ||
-					    apol_bst_insert_and_get(dnode->process_transition_tree, (void **)&new_node, NULL) < 0) {
+					    table_bitset_set(dta_table, dta_table->proc_trans_sources, tgt_value, src_value)) {
 						error = errno;
-						free(new_node);
 						goto err;
 					}
+					new_node->value = tgt_value;
+					new_node->type = tgt_type;
+					new_node->rule = rule;
+					apol_bitset_set(&dnode->proc_trans_targets, tgt_value, 1);
 				}
 				if (ep) {
-					avrule_node_t *new_node =
-						avrule_node_create((const qpol_type_t *)apol_vector_get_element(targets, j), rule);
-					if (!new_node ||
-					    apol_bst_insert_and_get(dnode->entrypoint_tree, (void **)&new_node, NULL) < 0) {
+					avrule_node_t *new_node = rule_list_append(&dnode->entrypoint_rules, sizeof(*new_node));
+					if (!new_node) {
 						error = errno;
-						free(new_node);
 						goto err;
 					}
+					new_node->value = tgt_value;
+					new_node->type = tgt_type;
+					new_node->rule = rule;
+					apol_bitset_set(&dnode->entrypoint_targets, tgt_value, 1);
 				}
 			}
 		}
 	}
 	if (exec) {
 		for (size_t i = 0; i < apol_vector_get_size(targets); i++) {
-			ep_node_t *enode = NULL;
-			ep_node_t dummy = { apol_vector_get_element(targets, i), NULL, NULL };
-			if (apol_bst_get_element(dta_table->entrypoint_table, &dummy, NULL, (void **)&enode)) {
-				ep_node_t *new_enode = NULL;
-				if (!(new_enode = ep_node_create(dummy.type)) ||
-				    apol_bst_insert(dta_table->entrypoint_table, (void *)new_enode, NULL)) {
-					error = errno;
-					ep_node_free(new_enode);
-					goto err;
-				}
-				enode = new_enode;
+			const qpol_type_t *tgt_type = apol_vector_get_element(targets, i);
+			uint32_t tgt_value = table_type_value(policy, tgt_type);
+			ep_node_t *enode = table_get_or_create_ep_node(dta_table, tgt_type, tgt_value);
+			if (!enode) {
+				error = errno;
+				goto err;
 			}
 			for (size_t j = 0; j < apol_vector_get_size(sources); j++) {
-				avrule_node_t *new_node =
-					avrule_node_create((const qpol_type_t *)apol_vector_get_element(sources, j), rule);
-				if (!new_node || apol_bst_insert_and_get(enode->execute_tree, (void **)&new_node, NULL) < 0) {
+				const qpol_type_t *src_type = apol_vector_get_element(sources, j);
+				uint32_t src_value = table_type_value(policy, src_type);
+				avrule_node_t *new_node = rule_list_append(&enode->execute_rules, sizeof(*new_node));
+				if (!new_node || table_bitset_set(dta_table, dta_table->exec_targets, src_value, tgt_value)) {
 					error = errno;
-					free(new_node);
 					goto err;
 				}
+				new_node->value = src_value;
+				new_node->type = src_type;
+				new_node->rule = rule;
+				apol_bitset_set(&enode->exec_sources, src_value, 1);
 			}
 		}
 	}
@@ -458,28 +632,27 @@ static int table_add_terule(apol_policy_t * policy, apol_domain_trans_table_t *
 	qpol_terule_get_default_type(qp, rule, &dflt);
 	apol_vector_t *sources = apol_query_expand_type(policy, src);
 	apol_vector_t *targets = apol_query_expand_type(policy, tgt);
+	uint32_t dflt_value = table_type_value(policy, dflt);
 	int error = 0;
 	for (size_t i = 0; i < apol_vector_get_size(targets); i++) {
-		ep_node_t *enode = NULL;
-		ep_node_t dummy = { apol_vector_get_element(targets, i), NULL, NULL };
-		if (apol_bst_get_element(dta_table->entrypoint_table, &dummy, NULL, (void **)&enode)) {
-			ep_node_t *new_enode = NULL;
-			if (!(new_enode = ep_node_create(dummy.type)) ||
-			    apol_bst_insert(dta_table->entrypoint_table, (void *)new_enode, NULL)) {
-				error = errno;
-				ep_node_free(new_enode);
-				goto err;
-			}
-			enode = new_enode;
+		const qpol_type_t *tgt_type = apol_vector_get_element(targets, i);
+		ep_node_t *enode = table_get_or_create_ep_node(dta_table, tgt_type, table_type_value(policy, tgt_type));
+		if (!enode) {
+			error = errno;
+			goto err;
 		}
 		for (size_t j = 0; j < apol_vector_get_size(sources); j++) {
-			terule_node_t *new_node =
-				terule_node_create((const qpol_type_t *)apol_vector_get_element(sources, j), dflt, rule);
-			if (apol_bst_insert_and_get(enode->type_transition_tree, (void **)&new_node, NULL) < 0) {
+			const qpol_type_t *src_type = apol_vector_get_element(sources, j);
+			terule_node_t *new_node = rule_list_append(&enode->type_transition_rules, sizeof(*new_node));
+			if (!new_node) {
 				error = errno;
-				free(new_node);
 				goto err;
 			}
+			new_node->src_value = table_type_value(policy, src_type);
+			new_node->dflt_value = dflt_value;
+			new_node->src = src_type;
+			new_node->dflt = dflt;
+			new_node->rule = rule;
 		}
 	}
 
@@ -493,6 +666,26 @@ static int table_add_terule(apol_policy_t * policy, apol_domain_trans_table_t *
 	return -1;
 }
 
+/**
+ * Sort every rule list within the table so that lookups may use a
+ * binary search.  This must be called after all rules are added.
+ */
+static void table_sort_rules(apol_domain_trans_table_t * table)
+{
+	for (size_t i = 0; i < table->size; i++) {
+		dom_node_t *dnode = table->domains[i];
+		ep_node_t *enode = table->entrypoints[i];
+		if (dnode) {
+			rule_list_sort_uniquify(&dnode->proc_trans_rules, sizeof(avrule_node_t), avrule_node_cmp);
+			rule_list_sort_uniquify(&dnode->entrypoint_rules, sizeof(avrule_node_t), avrule_node_cmp);
+		}
+		if (enode) {
+			rule_list_sort_uniquify(&enode->execute_rules, sizeof(avrule_node_t), avrule_node_cmp);
+			rule_list_sort_uniquify(&enode->type_transition_rules, sizeof(terule_node_t), terule_node_cmp);
+		}
+	}
+}
+
 /* result */
 apol_domain_trans_result_t *domain_trans_result_create()
 {
@@ -515,6 +708,7 @@ apol_domain_trans_result_t *domain_trans_result_create()
 	return NULL;
 }
 
+/* public functions */
 /* public functions */
 /* table */
 int apol_policy_build_domain_trans_table(apol_policy_t * policy)
@@ -578,6 +772,8 @@ int apol_policy_build_domain_trans_table(apol_policy_t * policy)
 	}
 	apol_vector_destroy(&terules);
 
+	table_sort_rules(dta_table);
+
 	return 0;
 
       err:
@@ -601,8 +797,21 @@ void domain_trans_table_destroy(apol_domain_trans_table_t ** table)
 	if (!table || !(*table))
 		return;
 
-	apol_bst_destroy(&(*table)->domain_table);
-	apol_bst_destroy(&(*table)->entrypoint_table);
+	for (size_t i = 0; i < (*table)->size; i++) {
+		if ((*table)->domains)
+			dom_node_free((*table)->domains[i]);
+		if ((*table)->entrypoints)
+			ep_node_free((*table)->entrypoints[i]);
+		if ((*table)->exec_targets)
+			apol_bitset_release((*table)->exec_targets + i);
+		if ((*table)->proc_trans_sources)
+			apol_bitset_release((*table)->proc_trans_sources + i);
+	}
+	free((*table)->types);
+	free((*table)->domains);
+	free((*table)->entrypoints);
+	free((*table)->exec_targets);
+	free((*table)->proc_trans_sources);
 	free(*table);
 	*table = NULL;
 }
@@ -611,8 +820,19 @@ void apol_policy_reset_domain_trans_table(apol_policy_t * policy)
 {
 	if (!policy || !policy->domain_trans_table)
 		return;
-	apol_bst_inorder_map(policy->domain_trans_table->domain_table, dom_node_reset, NULL);
-	apol_bst_inorder_map(policy->domain_trans_table->entrypoint_table, ep_node_reset, NULL);
+	apol_domain_trans_table_t *table = policy->domain_trans_table;
+	/* rule nodes marked during earlier generations are no longer
+	 * considered used; only upon wrapping around must every node be
+	 * visited, lest a stale mark match the new generation */
+	if (++table->generation == 0) {
+		for (size_t i = 0; i < table->size; i++) {
+			if (table->domains[i])
+				dom_node_reset(table->domains[i]);
+			if (table->entrypoints[i])
+				ep_node_reset(table->entrypoints[i]);
+		}
+		table->generation = 1;
+	}
 	return;
 }
 
@@ -648,6 +868,7 @@ void apol_domain_trans_analysis_destroy(apol_domain_trans_analysis_t ** dta)
 		return;
 
 	free((*dta)->start_type);
+	free((*dta)->end_type);
 	free((*dta)->result);
 	apol_vector_destroy(&((*dta)->access_types));
 	apol_vector_destroy(&((*dta)->access_classes));
@@ -864,143 +1085,267 @@ int apol_domain_trans_analysis_append_perm(const apol_policy_t * policy, apol_do
 	return 0;
 }
 
-static bool requires_setexec_or_type_trans(apol_policy_t * policy)
+int apol_domain_trans_analysis_set_end_type(const apol_policy_t * policy, apol_domain_trans_analysis_t * dta,
+					    const char *type_name)
 {
-	const qpol_policy_t *qp = apol_policy_get_qpol(policy);
-	unsigned int policy_version = 0;
-	qpol_policy_get_policy_version(qp, &policy_version);
-	int is_modular = qpol_policy_has_capability(policy->p, QPOL_CAP_MODULES);
-	return (policy_version >= 15 || is_modular);
+	char *tmp = NULL;
+	int error = 0;
+
+	if (!dta) {
+		ERR(policy, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (type_name && !(tmp = strdup(type_name))) {
+		error = errno;
+		ERR(policy, "%s", strerror(error));
+		errno = error;
+		return -1;
+	}
+
+	free(dta->end_type);
+	dta->end_type = tmp;
+
+	return 0;
 }
 
-struct rule_map_data
+int apol_domain_trans_analysis_set_max_depth(const apol_policy_t * policy, apol_domain_trans_analysis_t * dta,
+					     unsigned int max_depth)
 {
-	const qpol_type_t *search;
-	const qpol_type_t *dflt;
-	apol_vector_t *node_list;
-	bool is_avnode;
-};
+	if (!dta) {
+		ERR(policy, "Error setting maximum path depth: %s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+
+	dta->max_depth = max_depth;
+
+	return 0;
+}
 
-static int node_list_map_fn(void *node, void *data)
+int apol_domain_trans_analysis_set_path_requirements(const apol_policy_t * policy, apol_domain_trans_analysis_t * dta,
+						     unsigned int reqs)
 {
-	struct rule_map_data *rm = data;
-	if (rm->is_avnode) {
-		avrule_node_t *anode = node;
-		if (anode->type == rm->search && !anode->used)
-			if (apol_vector_append(rm->node_list, node))
-				return -1;
-		return 0;
-	} else {
-		terule_node_t *tnode = node;
-		if ((!rm->search || (rm->search == tnode->src)) && (!rm->dflt || (rm->dflt == tnode->dflt)) &&
-		    rm->search != rm->dflt && !tnode->used)
-			if (apol_vector_append(rm->node_list, node))
-				return -1;
-		return 0;
+	if (!dta || reqs & ~(APOL_DOMAIN_TRANS_PATH_REQUIRE_SETEXEC | APOL_DOMAIN_TRANS_PATH_REQUIRE_TYPE_TRANS)) {
+		ERR(policy, "Error setting path requirements: %s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
 	}
+
+	dta->path_reqs = reqs;
+
+	return 0;
 }
 
-static apol_vector_t *find_avrules_in_node(void *node, unsigned int rule_type, const qpol_type_t * search)
+/**
+ * Return a vector of unused avrule_node_t from within a domain or
+ * entrypoint node whose type has the given value.
+ */
+static apol_vector_t *find_avrules_in_node(const apol_domain_trans_table_t * table, void *node, unsigned int rule_type,
+					   uint32_t search)
 {
-	int error = 0;
-	apol_vector_t *rule_nodes = apol_vector_create(NULL);	//shallow copies only
-	struct rule_map_data data = { search, NULL, rule_nodes, true };
+	rule_list_t *list = NULL;
+	avrule_node_t *nodes;
+	size_t num;
 	switch (rule_type) {
 	case APOL_DOMAIN_TRANS_RULE_PROC_TRANS:
-	{
-		dom_node_t *dnode = node;
-		if (apol_bst_inorder_map(dnode->process_transition_tree, node_list_map_fn, (void *)&data) < 0) {
-			error = errno;
-			goto err;
-		}
+		list = &((dom_node_t *) node)->proc_trans_rules;
 		break;
-	}
 	case APOL_DOMAIN_TRANS_RULE_ENTRYPOINT:
-	{
-		dom_node_t *dnode = node;
-		if (apol_bst_inorder_map(dnode->entrypoint_tree, node_list_map_fn, (void *)&data) < 0) {
-			error = errno;
-			goto err;
-		}
+		list = &((dom_node_t *) node)->entrypoint_rules;
 		break;
-	}
 	case APOL_DOMAIN_TRANS_RULE_EXEC:
-	{
-		ep_node_t *enode = node;
-		if (apol_bst_inorder_map(enode->execute_tree, node_list_map_fn, (void *)&data) < 0) {
-			error = errno;
-			goto err;
-		}
+		list = &((ep_node_t *) node)->execute_rules;
 		break;
-	}
 	default:
-	{
-		error = EINVAL;
-		goto err;
-	}
+		errno = EINVAL;
+		return NULL;
 	}
 
+	apol_vector_t *rule_nodes = apol_vector_create(NULL);	//shallow copies only
+	if (!rule_nodes)
+		return NULL;
+	nodes = avrule_list_find(list, search, &num);
+	for (size_t i = 0; i < num; i++) {
+		if (nodes[i].used != table->generation && apol_vector_append(rule_nodes, nodes + i)) {
+			int error = errno;
+			apol_vector_destroy(&rule_nodes);
+			errno = error;
+			return NULL;
+		}
+	}
 	return rule_nodes;
-
-      err:
-	apol_vector_destroy(&rule_nodes);
-	errno = error;
-	return NULL;
 }
 
-static apol_vector_t *find_terules_in_node(ep_node_t * node, const qpol_type_t * search, const qpol_type_t * dflt)
+/**
+ * Return a vector of unused terule_node_t from within an entrypoint
+ * node.  A search or default value of 0 matches any type.
+ */
+static apol_vector_t *find_terules_in_node(const apol_domain_trans_table_t * table, ep_node_t * node, uint32_t search,
+					   uint32_t dflt)
 {
-	int error = 0;
+	terule_node_t *nodes = node->type_transition_rules.nodes;
+	size_t num = node->type_transition_rules.size;
 	apol_vector_t *rule_nodes = apol_vector_create(NULL);	//shallow copies only
-	struct rule_map_data data = { search, dflt, rule_nodes, false };
-	if (apol_bst_inorder_map(node->type_transition_tree, node_list_map_fn, (void *)&data) < 0) {
-		error = errno;
-		goto err;
+	if (!rule_nodes)
+		return NULL;
+	if (search && search == dflt)
+		return rule_nodes;
+	if (search)
+		nodes = terule_list_find(&node->type_transition_rules, search, &num);
+	for (size_t i = 0; i < num; i++) {
+		terule_node_t *tnode = nodes + i;
+		if ((!dflt || dflt == tnode->dflt_value) && tnode->used != table->generation) {
+			if (apol_vector_append(rule_nodes, tnode)) {
+				int error = errno;
+				apol_vector_destroy(&rule_nodes);
+				errno = error;
+				return NULL;
+			}
+		}
 	}
-
 	return rule_nodes;
-
-      err:
-	apol_vector_destroy(&rule_nodes);
-	errno = error;
-	return NULL;
 }
 
-static apol_domain_trans_result_t *find_result(apol_vector_t * local_results, const qpol_type_t * src, const qpol_type_t * tgt,
-					       const qpol_type_t * dflt)
+/**
+ * Replace a result's vector of rules with the rules referenced by a
+ * vector of avrule_node_t, optionally marking those nodes as used.
+ * The node vector is destroyed afterwards.
+ */
+static int result_set_avrules(const apol_domain_trans_table_t * table, apol_vector_t ** rules, apol_vector_t ** rule_nodes,
+			      bool mark_used)
 {
-	for (size_t i = 0; i < apol_vector_get_size(local_results); i++) {
-		apol_domain_trans_result_t *res = apol_vector_get_element(local_results, i);
-		if (res->start_type == src && res->end_type == dflt && res->ep_type == tgt)
-			return res;
+	apol_vector_destroy(rules);
+	if (!*rule_nodes || !(*rules = apol_vector_create_with_capacity(apol_vector_get_size(*rule_nodes), NULL))) {
+		int error = errno;
+		apol_vector_destroy(rule_nodes);
+		errno = error;
+		return -1;
 	}
-	return NULL;
+	for (size_t i = 0; i < apol_vector_get_size(*rule_nodes); i++) {
+		avrule_node_t *n = apol_vector_get_element(*rule_nodes, i);
+		if (mark_used)
+			n->used = table->generation;
+		if (apol_vector_append(*rules, (void *)n->rule)) {
+			int error = errno;
+			apol_vector_destroy(rule_nodes);
+			errno = error;
+			return -1;
+		}
+	}
+	apol_vector_destroy(rule_nodes);
+	apol_vector_sort_uniquify(*rules, NULL, NULL);
+	return 0;
+}
+
+/**
+ * Replace a result's vector of type_transition rules with the rules
+ * referenced by a vector of terule_node_t, optionally marking those
+ * nodes as used.  The node vector is destroyed afterwards.
+ */
+static int result_set_terules(const apol_domain_trans_table_t * table, apol_vector_t ** rules, apol_vector_t ** rule_nodes,
+			      bool mark_used)
+{
+	apol_vector_destroy(rules);
+	if (!*rule_nodes || !(*rules = apol_vector_create_with_capacity(apol_vector_get_size(*rule_nodes), NULL))) {
+		int error = errno;
+		apol_vector_destroy(rule_nodes);
+		errno = error;
+		return -1;
+	}
+	for (size_t i = 0; i < apol_vector_get_size(*rule_nodes); i++) {
+		terule_node_t *n = apol_vector_get_element(*rule_nodes, i);
+		if (mark_used)
+			n->used = table->generation;
+		if (apol_vector_append(*rules, (void *)n->rule)) {
+			int error = errno;
+			apol_vector_destroy(rule_nodes);
+			errno = error;
+			return -1;
+		}
+	}
+	apol_vector_destroy(rule_nodes);
+	apol_vector_sort_uniquify(*rules, NULL, NULL);
+	return 0;
+}
+
+/**
+ * Empty a result's vector of rules.
+ */
+static int result_clear_rules(apol_vector_t ** rules)
+{
+	apol_vector_destroy(rules);
+	return ((*rules = apol_vector_create(NULL)) == NULL ? -1 : 0);
+}
+
+/**
+ * Append a copy of the template result to the list of results.
+ */
+static int append_result_copy(apol_vector_t * local_results, const apol_domain_trans_result_t * tmpl_result)
+{
+	apol_domain_trans_result_t *tmp = apol_domain_trans_result_create_from_domain_trans_result(tmpl_result);
+	if (!tmp || apol_vector_append(local_results, (void *)tmp)) {
+		int error = errno;
+		apol_domain_trans_result_destroy(&tmp);
+		errno = error;
+		return -1;
+	}
+	return 0;
+}
+
+static void validate_results(const apol_domain_trans_table_t * table, apol_vector_t * local_results)
+{
+	for (size_t i = 0; i < apol_vector_get_size(local_results); i++) {
+		apol_domain_trans_result_t *res = apol_vector_get_element(local_results, i);
+		if (res->start_type && res->ep_type && res->end_type && apol_vector_get_size(res->proc_trans_rules) &&
+		    apol_vector_get_size(res->ep_rules) && apol_vector_get_size(res->exec_rules) &&
+		    (table->requires_setexec_or_type_trans
+		     ? (apol_vector_get_size(res->setexec_rules) || apol_vector_get_size(res->type_trans_rules)) : true)) {
+			res->valid = true;
+		}
+	}
+}
+
+static apol_domain_trans_result_t *find_result(apol_vector_t * local_results, const qpol_type_t * src, const qpol_type_t * tgt,
+					       const qpol_type_t * dflt)
+{
+	for (size_t i = 0; i < apol_vector_get_size(local_results); i++) {
+		apol_domain_trans_result_t *res = apol_vector_get_element(local_results, i);
+		if (res->start_type == src && res->end_type == dflt && res->ep_type == tgt)
+			return res;
+	}
+	return NULL;
 }
 
 static int domain_trans_table_find_orphan_type_transitions(apol_policy_t * policy, apol_domain_trans_analysis_t * dta,
-							   apol_vector_t * local_results)
+							   apol_vector_t * local_results, const qpol_type_t * search)
 {
-	int error = 0;
-	const qpol_type_t *search = NULL;
-	qpol_policy_get_type_by_name(apol_policy_get_qpol(policy), dta->start_type, &search);
+	apol_domain_trans_table_t *table = policy->domain_trans_table;
+	uint32_t search_value = table_type_value(policy, search);
 	apol_domain_trans_result_t *tmp_result = NULL;
+	apol_vector_t *ttnodes = NULL, *rule_nodes = NULL;
+	bool add = false;
+	int error = 0;
 	//walk ep table
-	apol_vector_t *epnodes = apol_bst_get_vector(policy->domain_trans_table->entrypoint_table, 0);
-	if (!epnodes)
-		return -1;
-	for (size_t i = 0; i < apol_vector_get_size(epnodes); i++) {
-		ep_node_t *node = apol_vector_get_element(epnodes, i);
+	for (size_t i = 0; i < table->size; i++) {
+		ep_node_t *node = table->entrypoints[i];
+		if (!node)
+			continue;
 		//find any unused type transitions
-		apol_vector_t *ttnodes = NULL;
 		if (dta->direction == APOL_DOMAIN_TRANS_DIRECTION_FORWARD)
-			ttnodes = find_terules_in_node(node, search, NULL);
+			ttnodes = find_terules_in_node(table, node, search_value, 0);
 		else
-			ttnodes = find_terules_in_node(node, NULL, search);
+			ttnodes = find_terules_in_node(table, node, 0, search_value);
+		if (!ttnodes) {
+			error = errno;
+			goto err;
+		}
 		for (size_t j = 0; j < apol_vector_get_size(ttnodes); j++) {
-			bool add = false;
 			terule_node_t *tn = apol_vector_get_element(ttnodes, j);
-			tn->used = true;
+			tn->used = table->generation;
 			//if missing an entrypoint rule this transition may have already been added to the results
+			add = false;
 			tmp_result = find_result(local_results, tn->src, node->type, tn->dflt);
 			if (!tmp_result) {
 				add = true;
@@ -1008,30 +1353,26 @@ static int domain_trans_table_find_orphan_type_transitions(apol_policy_t * polic
 			}
 			if (!tmp_result) {
 				error = errno;
-				apol_vector_destroy(&ttnodes);
 				goto err;
 			}
 			tmp_result->start_type = tn->src;
 			tmp_result->end_type = tn->dflt;
 			tmp_result->ep_type = node->type;
 			//check for exec
-			apol_vector_t *execrules =
-				find_avrules_in_node((void *)node, APOL_DOMAIN_TRANS_RULE_EXEC, tmp_result->start_type);
-			for (size_t k = 0; k < apol_vector_get_size(execrules); k++) {
-				avrule_node_t *n = apol_vector_get_element(execrules, k);
+			if (!(rule_nodes = find_avrules_in_node(table, (void *)node, APOL_DOMAIN_TRANS_RULE_EXEC, tn->src_value))) {
+				error = errno;
+				goto err;
+			}
+			for (size_t k = 0; k < apol_vector_get_size(rule_nodes); k++) {
+				avrule_node_t *n = apol_vector_get_element(rule_nodes, k);
 				if (apol_vector_append(tmp_result->exec_rules, (void *)n->rule)) {
 					error = errno;
-					apol_vector_destroy(&execrules);
-					if (!add)
-						tmp_result = NULL;
 					goto err;
 				}
 			}
-			apol_vector_destroy(&execrules);
+			apol_vector_destroy(&rule_nodes);
 			//check for proc_trans and setexec
-			dom_node_t dummy = { tmp_result->start_type, NULL, NULL, NULL };
-			dom_node_t *start_node = NULL;
-			apol_bst_get_element(policy->domain_trans_table->domain_table, (void *)&dummy, NULL, (void **)&start_node);
+			dom_node_t *start_node = table_get_dom_node(table, tn->src_value);
 			if (start_node) {
 				//only copy setexec_rules if a new result will be added
 				if (add && apol_vector_get_size(start_node->setexec_rules)) {
@@ -1041,20 +1382,19 @@ static int domain_trans_table_find_orphan_type_transitions(apol_policy_t * polic
 					}
 				}
 				//add any unused proc_trans rules
-				apol_vector_t *proc_trans_rules =
-					find_avrules_in_node((void *)start_node, APOL_DOMAIN_TRANS_RULE_PROC_TRANS,
-							     tmp_result->end_type);
-				for (size_t k = 0; k < apol_vector_get_size(proc_trans_rules); k++) {
-					avrule_node_t *avr = apol_vector_get_element(proc_trans_rules, k);
+				if (!(rule_nodes =
+				      find_avrules_in_node(table, (void *)start_node, APOL_DOMAIN_TRANS_RULE_PROC_TRANS, tn->dflt_value))) {
+					error = errno;
+					goto err;
+				}
+				for (size_t k = 0; k < apol_vector_get_size(rule_nodes); k++) {
+					avrule_node_t *avr = apol_vector_get_element(rule_nodes, k);
 					if (apol_vector_append(tmp_result->proc_trans_rules, (void *)avr->rule)) {
 						error = errno;
-						if (!add)
-							tmp_result = NULL;
-						apol_vector_destroy(&proc_trans_rules);
 						goto err;
 					}
 				}
-				apol_vector_destroy(&proc_trans_rules);
+				apol_vector_destroy(&rule_nodes);
 				apol_vector_sort_uniquify(tmp_result->proc_trans_rules, NULL, NULL);
 			}
 			if (add) {
@@ -1067,13 +1407,14 @@ static int domain_trans_table_find_orphan_type_transitions(apol_policy_t * polic
 		}
 		apol_vector_destroy(&ttnodes);
 	}
-	apol_vector_destroy(&epnodes);
 
 	return 0;
 
       err:
-	apol_vector_destroy(&epnodes);
-	apol_domain_trans_result_destroy(&tmp_result);
+	apol_vector_destroy(&ttnodes);
+	apol_vector_destroy(&rule_nodes);
+	if (add)
+		apol_domain_trans_result_destroy(&tmp_result);
 	errno = error;
 	return -1;
 }
@@ -1081,6 +1422,9 @@ static int domain_trans_table_find_orphan_type_transitions(apol_policy_t * polic
 static int domain_trans_table_get_all_forward_trans(apol_policy_t * policy, apol_domain_trans_analysis_t * dta,
 						    apol_vector_t * local_results, const qpol_type_t * start_type)
 {
+	apol_domain_trans_table_t *table = policy->domain_trans_table;
+	apol_bitset_t candidate_eps = { 0, 0, NULL };
+	apol_vector_t *rule_nodes = NULL;
 	int error = 0;
 	//create template result this will hold common data for each step and be copied as needed
 	apol_domain_trans_result_t *tmpl_result = domain_trans_result_create();
@@ -1089,255 +1433,99 @@ static int domain_trans_table_get_all_forward_trans(apol_policy_t * policy, apol
 		goto err;
 	}
 	//find start node
-	dom_node_t dummy = { start_type, NULL, NULL, NULL };
-	dom_node_t *start_node = NULL;
-	apol_bst_get_element(policy->domain_trans_table->domain_table, (void *)&dummy, NULL, (void **)&start_node);
+	uint32_t start_value = table_type_value(policy, start_type);
+	dom_node_t *start_node = table_get_dom_node(table, start_value);
 	if (start_node) {
 		tmpl_result->start_type = start_type;
 		//if needed and present record setexec
-		if (requires_setexec_or_type_trans(policy) && apol_vector_get_size(start_node->setexec_rules)) {
+		if (table->requires_setexec_or_type_trans && apol_vector_get_size(start_node->setexec_rules)) {
 			if (apol_vector_cat(tmpl_result->setexec_rules, start_node->setexec_rules)) {
 				error = errno;
 				goto err;
 			}
 		}
-		//check all proc trans to build list of end types
-		apol_vector_t *proc_trans_rules = apol_bst_get_vector(start_node->process_transition_tree, 0);
-		apol_vector_t *potential_end_types = apol_vector_create(NULL);
-		for (size_t i = 0; i < apol_vector_get_size(proc_trans_rules); i++) {
-			avrule_node_t *ptnode = apol_vector_get_element(proc_trans_rules, i);
-			apol_vector_append(potential_end_types, (void *)ptnode->type);
+		if (apol_bitset_init(&candidate_eps, table->size)) {
+			error = errno;
+			goto err;
 		}
-		apol_vector_destroy(&proc_trans_rules);
-		apol_vector_sort_uniquify(potential_end_types, NULL, NULL);
-		//for each end check ep
-		for (size_t i = 0; i < apol_vector_get_size(potential_end_types); i++) {
-			dummy.type = tmpl_result->end_type = apol_vector_get_element(potential_end_types, i);
-			dom_node_t *end_node = NULL;
-			apol_bst_get_element(policy->domain_trans_table->domain_table, (void *)&dummy, NULL, (void **)&end_node);
-			const qpol_type_t *end_type = dummy.type;
-			if (end_type == start_type)
+		//each process transition target is a potential end type
+		for (size_t end_value = apol_bitset_next(&start_node->proc_trans_targets, 0); end_value < table->size;
+		     end_value = apol_bitset_next(&start_node->proc_trans_targets, end_value + 1)) {
+			if (end_value == start_value)
 				continue;
-			//get all proc trans rules for ths end (may be multiple due to attributes)
-			apol_vector_t *ptrules =
-				find_avrules_in_node((void *)start_node, APOL_DOMAIN_TRANS_RULE_PROC_TRANS, end_type);
-			apol_vector_destroy(&tmpl_result->proc_trans_rules);
-			tmpl_result->proc_trans_rules = apol_vector_create(NULL);
-			for (size_t j = 0; j < apol_vector_get_size(ptrules); j++) {
-				avrule_node_t *pt_ent = apol_vector_get_element(ptrules, j);
-				pt_ent->used = true;
-				if (apol_vector_append(tmpl_result->proc_trans_rules, (void *)pt_ent->rule)) {
+			tmpl_result->end_type = table->types[end_value];
+			tmpl_result->ep_type = NULL;
+			//get all proc trans rules for this end (may be multiple due to attributes)
+			rule_nodes = find_avrules_in_node(table, (void *)start_node, APOL_DOMAIN_TRANS_RULE_PROC_TRANS, end_value);
+			if (result_set_avrules(table, &tmpl_result->proc_trans_rules, &rule_nodes, true) ||
+			    result_clear_rules(&tmpl_result->ep_rules) || result_clear_rules(&tmpl_result->exec_rules) ||
+			    result_clear_rules(&tmpl_result->type_trans_rules)) {
+				error = errno;
+				goto err;
+			}
+			dom_node_t *end_node = table_get_dom_node(table, end_value);
+			if (!end_node) {
+				//have proc_trans but end has no ep
+				if (append_result_copy(local_results, tmpl_result)) {
 					error = errno;
-					apol_vector_destroy(&ptrules);
-					apol_vector_destroy(&potential_end_types);
 					goto err;
 				}
+				continue;
+			}
+			//a valid transition needs an entrypoint that the start may also execute
+			const apol_bitset_t *potential_eps = &end_node->entrypoint_targets;
+			if (dta->valid == APOL_DOMAIN_TRANS_SEARCH_VALID) {
+				apol_bitset_and(&candidate_eps, potential_eps, table->exec_targets + start_value);
+				potential_eps = &candidate_eps;
 			}
-			apol_vector_destroy(&ptrules);
-			apol_vector_sort_uniquify(tmpl_result->proc_trans_rules, NULL, NULL);
-			if (end_node) {
-				//collect potential entrypoint types
-				apol_vector_t *eprules = apol_bst_get_vector(end_node->entrypoint_tree, 0);
-				apol_vector_t *potential_ep_types = apol_vector_create(NULL);
-				if (!eprules || !potential_ep_types) {
+			for (size_t ep_value = apol_bitset_next(potential_eps, 0); ep_value < table->size;
+			     ep_value = apol_bitset_next(potential_eps, ep_value + 1)) {
+				tmpl_result->ep_type = table->types[ep_value];
+				//get all entrypoint rules for this end (may be multiple due to attributes)
+				rule_nodes = find_avrules_in_node(table, (void *)end_node, APOL_DOMAIN_TRANS_RULE_ENTRYPOINT, ep_value);
+				if (result_set_avrules(table, &tmpl_result->ep_rules, &rule_nodes, true) ||
+				    result_clear_rules(&tmpl_result->exec_rules) || result_clear_rules(&tmpl_result->type_trans_rules)) {
 					error = errno;
-					apol_vector_destroy(&eprules);
-					apol_vector_destroy(&potential_end_types);
 					goto err;
 				}
-				for (size_t j = 0; j < apol_vector_get_size(eprules); j++) {
-					avrule_node_t *epr = apol_vector_get_element(eprules, j);
-					if (apol_vector_append(potential_ep_types, (void *)epr->type)) {
+				ep_node_t *epnode = table_get_ep_node(table, ep_value);
+				if (epnode) {
+					//if present find tt
+					rule_nodes = find_terules_in_node(table, epnode, start_value, end_value);
+					if (result_set_terules(table, &tmpl_result->type_trans_rules, &rule_nodes, false)) {
 						error = errno;
-						apol_vector_destroy(&eprules);
-						apol_vector_destroy(&potential_end_types);
-						apol_vector_destroy(&potential_ep_types);
 						goto err;
 					}
-				}
-				apol_vector_destroy(&eprules);
-				apol_vector_sort_uniquify(potential_ep_types, NULL, NULL);
-				//for each ep find exec by start
-				for (size_t j = 0; j < apol_vector_get_size(potential_ep_types); j++) {
-					tmpl_result->ep_type = apol_vector_get_element(potential_ep_types, j);
-					ep_node_t edummy =
-						{ (const qpol_type_t *)apol_vector_get_element(potential_ep_types, j), NULL, NULL };
-					ep_node_t *epnode = NULL;
-					apol_bst_get_element(policy->domain_trans_table->entrypoint_table, (void *)&edummy, NULL,
-							     (void **)&epnode);
-					//get all entrypoint rules for ths end (may be multiple due to attributes)
-					apol_vector_destroy(&tmpl_result->ep_rules);
-					tmpl_result->ep_rules = apol_vector_create(NULL);
-					if (!tmpl_result->ep_rules) {
+					//find execute rules; do not mark them as used here, as it is valid to re-use them
+					rule_nodes = find_avrules_in_node(table, epnode, APOL_DOMAIN_TRANS_RULE_EXEC, start_value);
+					if (result_set_avrules(table, &tmpl_result->exec_rules, &rule_nodes, false)) {
 						error = errno;
-						apol_vector_destroy(&potential_end_types);
-						apol_vector_destroy(&potential_ep_types);
-						goto err;
-					}
-					eprules = find_avrules_in_node((void *)end_node, APOL_DOMAIN_TRANS_RULE_ENTRYPOINT,
-								       tmpl_result->ep_type);
-					for (size_t k = 0; k < apol_vector_get_size(eprules); k++) {
-						avrule_node_t *ep_ent = apol_vector_get_element(eprules, k);
-						ep_ent->used = true;
-						if (apol_vector_append(tmpl_result->ep_rules, (void *)ep_ent->rule)) {
-							error = errno;
-							apol_vector_destroy(&eprules);
-							apol_vector_destroy(&potential_end_types);
-							apol_vector_destroy(&potential_ep_types);
-							goto err;
-						}
-					}
-					apol_vector_destroy(&eprules);
-					apol_vector_sort_uniquify(tmpl_result->ep_rules, NULL, NULL);
-					if (epnode) {
-						//if present find tt
-						apol_vector_destroy(&tmpl_result->type_trans_rules);
-						tmpl_result->type_trans_rules = apol_vector_create(NULL);
-						if (!tmpl_result->type_trans_rules) {
-							error = errno;
-							apol_vector_destroy(&potential_end_types);
-							apol_vector_destroy(&potential_ep_types);
-							goto err;
-						}
-						apol_vector_t *ttrules = find_terules_in_node(epnode, start_type, end_type);
-						for (size_t l = 0; l < apol_vector_get_size(ttrules); l++) {
-							terule_node_t *tn = apol_vector_get_element(ttrules, l);
-							if (apol_vector_append(tmpl_result->type_trans_rules, (void *)tn->rule)) {
-								error = errno;
-								apol_vector_destroy(&ttrules);
-								apol_vector_destroy(&potential_end_types);
-								apol_vector_destroy(&potential_ep_types);
-								goto err;
-							}
-						}
-						apol_vector_destroy(&ttrules);
-						apol_vector_sort_uniquify(tmpl_result->type_trans_rules, NULL, NULL);
-						//find execute rules
-						apol_vector_destroy(&tmpl_result->exec_rules);
-						tmpl_result->exec_rules = apol_vector_create(NULL);
-						if (!tmpl_result->exec_rules) {
-							error = errno;
-							apol_vector_destroy(&potential_end_types);
-							apol_vector_destroy(&potential_ep_types);
-							goto err;
-						}
-						apol_vector_t *execrules =
-							find_avrules_in_node(epnode, APOL_DOMAIN_TRANS_RULE_EXEC, start_type);
-						if (apol_vector_get_size(execrules)) {
-							for (size_t l = 0; l < apol_vector_get_size(execrules); l++) {
-								avrule_node_t *xnode = apol_vector_get_element(execrules, l);
-								//do not mark xnode as used here; it is valid to re-use it.
-								if (apol_vector_append
-								    (tmpl_result->exec_rules, (void *)xnode->rule)) {
-									error = errno;
-									apol_vector_destroy(&execrules);
-									apol_vector_destroy(&potential_end_types);
-									apol_vector_destroy(&potential_ep_types);
-									goto err;
-								}
-							}
-							apol_vector_destroy(&execrules);
-							apol_vector_sort_uniquify(tmpl_result->exec_rules, NULL, NULL);
-							//found everything possible add a result
-							apol_domain_trans_result_t *tmp =
-								apol_domain_trans_result_create_from_domain_trans_result
-								(tmpl_result);
-							if (!tmp || apol_vector_append(local_results, (void *)tmp)) {
-								error = errno;
-								apol_domain_trans_result_destroy(&tmp);
-								apol_vector_destroy(&potential_end_types);
-								apol_vector_destroy(&potential_ep_types);
-								goto err;
-							}
-							//reset execute rules
-							apol_vector_destroy(&tmpl_result->exec_rules);
-							tmpl_result->exec_rules = apol_vector_create(NULL);
-							if (!tmpl_result->exec_rules) {
-								error = errno;
-								apol_vector_destroy(&potential_end_types);
-								apol_vector_destroy(&potential_ep_types);
-								goto err;
-							}
-							//reset type transition rules
-							apol_vector_destroy(&tmpl_result->type_trans_rules);
-							tmpl_result->type_trans_rules = apol_vector_create(NULL);
-							if (!tmpl_result->type_trans_rules) {
-								error = errno;
-								apol_vector_destroy(&potential_end_types);
-								apol_vector_destroy(&potential_ep_types);
-								goto err;
-							}
-						} else {
-							//have proc_trans and entrypoint but no execute
-							apol_domain_trans_result_t *tmp =
-								apol_domain_trans_result_create_from_domain_trans_result
-								(tmpl_result);
-							if (!tmp || apol_vector_append(local_results, (void *)tmp)) {
-								error = errno;
-								apol_domain_trans_result_destroy(&tmp);
-								apol_vector_destroy(&potential_end_types);
-								apol_vector_destroy(&potential_ep_types);
-								goto err;
-							}
-						}
-						apol_vector_destroy(&execrules);
-					} else {
-						//have proc_trans and entrypoint but no execute
-						apol_domain_trans_result_t *tmp =
-							apol_domain_trans_result_create_from_domain_trans_result(tmpl_result);
-						if (!tmp || apol_vector_append(local_results, (void *)tmp)) {
-							error = errno;
-							apol_domain_trans_result_destroy(&tmp);
-							apol_vector_destroy(&potential_end_types);
-							apol_vector_destroy(&potential_ep_types);
-							goto err;
-						}
-					}
-					//reset entrypoint rules
-					apol_vector_destroy(&tmpl_result->ep_rules);
-					tmpl_result->ep_rules = apol_vector_create(NULL);
-					if (!tmpl_result->ep_rules) {
-						error = errno;
-						apol_vector_destroy(&potential_end_types);
-						apol_vector_destroy(&potential_ep_types);
 						goto err;
 					}
 				}
-				apol_vector_destroy(&potential_ep_types);
-			} else {
-				//have proc_trans but end has no ep
-				apol_domain_trans_result_t *tmp =
-					apol_domain_trans_result_create_from_domain_trans_result(tmpl_result);
-				if (!tmp || apol_vector_append(local_results, (void *)tmp)) {
+				//found everything possible (or have proc_trans and entrypoint but no execute) add a result
+				if (append_result_copy(local_results, tmpl_result)) {
 					error = errno;
-					apol_domain_trans_result_destroy(&tmp);
 					goto err;
 				}
 			}
 		}
-		apol_vector_destroy(&potential_end_types);
 		//validate all
-		for (size_t i = 0; i < apol_vector_get_size(local_results); i++) {
-			apol_domain_trans_result_t *res = apol_vector_get_element(local_results, i);
-			if (res->start_type && res->ep_type && res->end_type && apol_vector_get_size(res->proc_trans_rules) &&
-			    apol_vector_get_size(res->ep_rules) && apol_vector_get_size(res->exec_rules) &&
-			    (requires_setexec_or_type_trans(policy)
-			     ? (apol_vector_get_size(res->setexec_rules) || apol_vector_get_size(res->type_trans_rules)) : true)) {
-				res->valid = true;
-			}
-		}
+		validate_results(table, local_results);
 	}
 	//iff looking for invalid find orphan type_transition rules
 	if (dta->valid & APOL_DOMAIN_TRANS_SEARCH_INVALID) {
-		if (domain_trans_table_find_orphan_type_transitions(policy, dta, local_results)) {
+		if (domain_trans_table_find_orphan_type_transitions(policy, dta, local_results, start_type)) {
 			error = errno;
 			goto err;
 		}
 	}
+	apol_bitset_release(&candidate_eps);
 	apol_domain_trans_result_destroy(&tmpl_result);
 
 	return 0;
       err:
+	apol_bitset_release(&candidate_eps);
 	apol_domain_trans_result_destroy(&tmpl_result);
 	errno = error;
 	return -1;
@@ -1346,6 +1534,9 @@ static int domain_trans_table_get_all_forward_trans(apol_policy_t * policy, apol
 static int domain_trans_table_get_all_reverse_trans(apol_policy_t * policy, apol_domain_trans_analysis_t * dta,
 						    apol_vector_t * local_results, const qpol_type_t * end_type)
 {
+	apol_domain_trans_table_t *table = policy->domain_trans_table;
+	apol_bitset_t candidate_starts = { 0, 0, NULL };
+	apol_vector_t *rule_nodes = NULL;
 	int error = 0;
 	//create template result this will hold common data for each step and be copied as needed
 	apol_domain_trans_result_t *tmpl_result = domain_trans_result_create();
@@ -1354,271 +1545,101 @@ static int domain_trans_table_get_all_reverse_trans(apol_policy_t * policy, apol
 		goto err;
 	}
 	//find end node
-	dom_node_t dummy = { end_type, NULL, NULL, NULL };
-	dom_node_t *end_node = NULL;
-	apol_bst_get_element(policy->domain_trans_table->domain_table, (void *)&dummy, NULL, (void **)&end_node);
+	uint32_t end_value = table_type_value(policy, end_type);
+	dom_node_t *end_node = table_get_dom_node(table, end_value);
 	if (end_node) {
 		tmpl_result->end_type = end_type;
-		//collect potential entrypoint types
-		apol_vector_t *eprules = apol_bst_get_vector(end_node->entrypoint_tree, 0);
-		apol_vector_t *potential_ep_types = apol_vector_create(NULL);
-		if (!eprules || !potential_ep_types) {
+		if (apol_bitset_init(&candidate_starts, table->size)) {
 			error = errno;
-			apol_vector_destroy(&eprules);
 			goto err;
 		}
-		for (size_t j = 0; j < apol_vector_get_size(eprules); j++) {
-			avrule_node_t *epr = apol_vector_get_element(eprules, j);
-			if (apol_vector_append(potential_ep_types, (void *)epr->type)) {
+		for (size_t ep_value = apol_bitset_next(&end_node->entrypoint_targets, 0); ep_value < table->size;
+		     ep_value = apol_bitset_next(&end_node->entrypoint_targets, ep_value + 1)) {
+			tmpl_result->ep_type = table->types[ep_value];
+			tmpl_result->start_type = NULL;
+			//get all ep rules for this end (may be multiple due to attributes)
+			rule_nodes = find_avrules_in_node(table, (void *)end_node, APOL_DOMAIN_TRANS_RULE_ENTRYPOINT, ep_value);
+			if (result_set_avrules(table, &tmpl_result->ep_rules, &rule_nodes, true) ||
+			    result_clear_rules(&tmpl_result->exec_rules) || result_clear_rules(&tmpl_result->type_trans_rules) ||
+			    result_clear_rules(&tmpl_result->proc_trans_rules) || result_clear_rules(&tmpl_result->setexec_rules)) {
 				error = errno;
-				apol_vector_destroy(&eprules);
-				apol_vector_destroy(&potential_ep_types);
 				goto err;
 			}
-		}
-		apol_vector_destroy(&eprules);
-		apol_vector_sort_uniquify(potential_ep_types, NULL, NULL);
-		for (size_t i = 0; i < apol_vector_get_size(potential_ep_types); i++) {
-			tmpl_result->ep_type = apol_vector_get_element(potential_ep_types, i);
-			//get all ep rules for this end (may be multiple due to attributes)
-			eprules = find_avrules_in_node((void *)end_node, APOL_DOMAIN_TRANS_RULE_ENTRYPOINT, tmpl_result->ep_type);
-			apol_vector_destroy(&tmpl_result->ep_rules);
-			tmpl_result->ep_rules = apol_vector_create(NULL);
-			for (size_t j = 0; j < apol_vector_get_size(eprules); j++) {
-				avrule_node_t *ep_ent = apol_vector_get_element(eprules, j);
-				ep_ent->used = true;
-				if (apol_vector_append(tmpl_result->ep_rules, (void *)ep_ent->rule)) {
+			ep_node_t *epnode = table_get_ep_node(table, ep_value);
+			if (!epnode) {
+				//have entrypoint but no exec
+				if (append_result_copy(local_results, tmpl_result)) {
 					error = errno;
-					apol_vector_destroy(&eprules);
-					apol_vector_destroy(&potential_ep_types);
 					goto err;
 				}
+				continue;
+			}
+			//each domain which may execute the entrypoint is a potential start type;
+			//a valid transition also needs that domain to have process transition to the end
+			const apol_bitset_t *potential_starts = &epnode->exec_sources;
+			if (dta->valid == APOL_DOMAIN_TRANS_SEARCH_VALID) {
+				apol_bitset_and(&candidate_starts, potential_starts, table->proc_trans_sources + end_value);
+				potential_starts = &candidate_starts;
 			}
-			apol_vector_destroy(&eprules);
-			apol_vector_sort_uniquify(tmpl_result->ep_rules, NULL, NULL);
-			ep_node_t edummy = { tmpl_result->ep_type, NULL, NULL };
-			ep_node_t *epnode = NULL;
-			apol_bst_get_element(policy->domain_trans_table->entrypoint_table, (void *)&edummy, NULL, (void **)&epnode);
-			//for each ep find exec rules to generate list of potential start types
-			if (epnode) {
-				apol_vector_t *execrules = apol_bst_get_vector(epnode->execute_tree, 0);
-				apol_vector_t *potential_start_types = apol_vector_create(NULL);
-				if (!execrules || !potential_start_types) {
+			for (size_t start_value = apol_bitset_next(potential_starts, 0); start_value < table->size;
+			     start_value = apol_bitset_next(potential_starts, start_value + 1)) {
+				//no transition to self
+				if (start_value == end_value)
+					continue;
+				tmpl_result->start_type = table->types[start_value];
+				//get all execute rule for this start type
+				rule_nodes = find_avrules_in_node(table, (void *)epnode, APOL_DOMAIN_TRANS_RULE_EXEC, start_value);
+				if (result_set_avrules(table, &tmpl_result->exec_rules, &rule_nodes, true)) {
 					error = errno;
-					apol_vector_destroy(&execrules);
 					goto err;
 				}
-				for (size_t k = 0; k < apol_vector_get_size(execrules); k++) {
-					avrule_node_t *n = apol_vector_get_element(execrules, k);
-					if (apol_vector_append(potential_start_types, (void *)n->type)) {
-						error = errno;
-						apol_vector_destroy(&execrules);
-						apol_vector_destroy(&potential_start_types);
-						apol_vector_destroy(&potential_ep_types);
-						goto err;
-					}
+				//check for type transition rules
+				rule_nodes = find_terules_in_node(table, epnode, start_value, end_value);
+				if (result_set_terules(table, &tmpl_result->type_trans_rules, &rule_nodes, true) ||
+				    result_clear_rules(&tmpl_result->proc_trans_rules) || result_clear_rules(&tmpl_result->setexec_rules)) {
+					error = errno;
+					goto err;
 				}
-				apol_vector_destroy(&execrules);
-				apol_vector_sort_uniquify(potential_start_types, NULL, NULL);
-				for (size_t k = 0; k < apol_vector_get_size(potential_start_types); k++) {
-					tmpl_result->start_type = apol_vector_get_element(potential_start_types, k);
-					//no transition to self
-					if (tmpl_result->end_type == tmpl_result->start_type)
-						continue;
-					//get all execute rule for this start type
-					apol_vector_t *exec_rules =
-						find_avrules_in_node((void *)epnode, APOL_DOMAIN_TRANS_RULE_EXEC,
-								     tmpl_result->start_type);
-					apol_vector_destroy(&tmpl_result->exec_rules);
-					tmpl_result->exec_rules = apol_vector_create(NULL);
-					for (size_t l = 0; l < apol_vector_get_size(exec_rules); l++) {
-						avrule_node_t *n = apol_vector_get_element(exec_rules, l);
-						n->used = true;
-						if (apol_vector_append(tmpl_result->exec_rules, (void *)n->rule)) {
-							error = errno;
-							apol_vector_destroy(&exec_rules);
-							apol_vector_destroy(&potential_start_types);
-							apol_vector_destroy(&potential_ep_types);
-							goto err;
-						}
-					}
-					apol_vector_destroy(&exec_rules);
-					apol_vector_sort_uniquify(tmpl_result->exec_rules, NULL, NULL);
-					//check for type transition rules
-					apol_vector_t *ttrules =
-						find_terules_in_node(epnode, tmpl_result->start_type, tmpl_result->end_type);
-					apol_vector_destroy(&tmpl_result->type_trans_rules);
-					tmpl_result->type_trans_rules = apol_vector_create(NULL);
-					if (!tmpl_result->type_trans_rules) {
+				dom_node_t *start_node = table_get_dom_node(table, start_value);
+				if (start_node) {
+					//for each start check setexec if needed
+					if (table->requires_setexec_or_type_trans &&
+					    apol_vector_cat(tmpl_result->setexec_rules, start_node->setexec_rules)) {
 						error = errno;
-						apol_vector_destroy(&ttrules);
-						apol_vector_destroy(&potential_start_types);
-						apol_vector_destroy(&potential_ep_types);
 						goto err;
 					}
-					for (size_t l = 0; l < apol_vector_get_size(ttrules); l++) {
-						terule_node_t *n = apol_vector_get_element(ttrules, l);
-						n->used = true;
-						if (apol_vector_append(tmpl_result->type_trans_rules, (void *)n->rule)) {
-							error = errno;
-							apol_vector_destroy(&ttrules);
-							apol_vector_destroy(&potential_start_types);
-							apol_vector_destroy(&potential_ep_types);
-							goto err;
-						}
-					}
-					apol_vector_destroy(&ttrules);
-					apol_vector_sort_uniquify(tmpl_result->type_trans_rules, NULL, NULL);
-					dummy.type = tmpl_result->start_type;
-					dom_node_t *start_node = NULL;
-					apol_bst_get_element(policy->domain_trans_table->domain_table, (void *)&dummy, NULL,
-							     (void **)&start_node);
-					if (start_node) {
-						//for each start check setexec if needed
-						if (requires_setexec_or_type_trans(policy)) {
-							apol_vector_destroy(&tmpl_result->setexec_rules);
-							tmpl_result->setexec_rules = apol_vector_create(NULL);
-							if (!tmpl_result->setexec_rules ||
-							    apol_vector_cat(tmpl_result->setexec_rules,
-									    start_node->setexec_rules)) {
-								error = errno;
-								apol_vector_destroy(&potential_start_types);
-								apol_vector_destroy(&potential_ep_types);
-								goto err;
-							}
-						}
-						//for each start find pt
-						apol_vector_destroy(&tmpl_result->proc_trans_rules);
-						tmpl_result->proc_trans_rules = apol_vector_create(NULL);
-						if (!tmpl_result->proc_trans_rules) {
-							error = errno;
-							apol_vector_destroy(&potential_start_types);
-							apol_vector_destroy(&potential_ep_types);
-							goto err;
-						}
-						apol_vector_t *pt_rules = NULL;
-						pt_rules =
-							find_avrules_in_node(start_node, APOL_DOMAIN_TRANS_RULE_PROC_TRANS,
-									     tmpl_result->end_type);
-						if (apol_vector_get_size(pt_rules)) {
-							for (size_t l = 0; l < apol_vector_get_size(pt_rules); l++) {
-								avrule_node_t *n = apol_vector_get_element(pt_rules, l);
-								apol_vector_append(tmpl_result->proc_trans_rules, (void *)n->rule);
-							}
-							apol_vector_destroy(&pt_rules);
-							apol_vector_sort_uniquify(tmpl_result->proc_trans_rules, NULL, NULL);
-							// have all possible rules add this entry
-							apol_domain_trans_result_t *tmp =
-								apol_domain_trans_result_create_from_domain_trans_result
-								(tmpl_result);
-							if (!tmp || apol_vector_append(local_results, (void *)tmp)) {
-								error = errno;
-								apol_domain_trans_result_destroy(&tmp);
-								apol_vector_destroy(&potential_start_types);
-								apol_vector_destroy(&potential_ep_types);
-								goto err;
-							}
-							//reset process transition rules
-							apol_vector_destroy(&tmpl_result->proc_trans_rules);
-							tmpl_result->proc_trans_rules = apol_vector_create(NULL);
-							if (!tmpl_result->proc_trans_rules) {
-								error = errno;
-								apol_vector_destroy(&potential_start_types);
-								apol_vector_destroy(&potential_ep_types);
-								goto err;
-							}
-							//reset setexec rules
-							apol_vector_destroy(&tmpl_result->setexec_rules);
-							tmpl_result->setexec_rules = apol_vector_create(NULL);
-							if (!tmpl_result->setexec_rules) {
-								error = errno;
-								apol_vector_destroy(&potential_start_types);
-								apol_vector_destroy(&potential_ep_types);
-								goto err;
-							}
-						} else {
-							//have entrypoint and execute rules but no process transition rule
-							apol_domain_trans_result_t *tmp =
-								apol_domain_trans_result_create_from_domain_trans_result
-								(tmpl_result);
-							if (!tmp || apol_vector_append(local_results, (void *)tmp)) {
-								error = errno;
-								apol_domain_trans_result_destroy(&tmp);
-								apol_vector_destroy(&potential_start_types);
-								apol_vector_destroy(&potential_ep_types);
-								apol_vector_destroy(&pt_rules);
-								goto err;
-							}
-						}
-						apol_vector_destroy(&pt_rules);
-					} else {
-						//have entrypoint and execute rules but no process transition rule
-						apol_domain_trans_result_t *tmp =
-							apol_domain_trans_result_create_from_domain_trans_result(tmpl_result);
-						if (!tmp || apol_vector_append(local_results, (void *)tmp)) {
-							error = errno;
-							apol_domain_trans_result_destroy(&tmp);
-							apol_vector_destroy(&potential_start_types);
-							apol_vector_destroy(&potential_ep_types);
-							goto err;
-						}
-					}
-					//reset execute rules
-					apol_vector_destroy(&tmpl_result->exec_rules);
-					tmpl_result->exec_rules = apol_vector_create(NULL);
-					if (!tmpl_result->exec_rules) {
+					//for each start find pt
+					rule_nodes = find_avrules_in_node(table, start_node, APOL_DOMAIN_TRANS_RULE_PROC_TRANS, end_value);
+					if (result_set_avrules(table, &tmpl_result->proc_trans_rules, &rule_nodes, false)) {
 						error = errno;
-						apol_vector_destroy(&potential_start_types);
-						apol_vector_destroy(&potential_ep_types);
-						goto err;
-					}
-					//reset type transition rules
-					apol_vector_destroy(&tmpl_result->type_trans_rules);
-					tmpl_result->type_trans_rules = apol_vector_create(NULL);
-					if (!tmpl_result->type_trans_rules) {
-						error = errno;
-						apol_vector_destroy(&potential_start_types);
-						apol_vector_destroy(&potential_ep_types);
 						goto err;
 					}
 				}
-				apol_vector_destroy(&potential_start_types);
-			} else {
-				//have entrypoint but no exec
-				apol_domain_trans_result_t *tmp =
-					apol_domain_trans_result_create_from_domain_trans_result(tmpl_result);
-				if (!tmp || apol_vector_append(local_results, (void *)tmp)) {
+				//have all possible rules (or entrypoint and execute rules but no process transition rule) add this entry
+				if (append_result_copy(local_results, tmpl_result)) {
 					error = errno;
-					apol_domain_trans_result_destroy(&tmp);
 					goto err;
 				}
 			}
 		}
-		apol_vector_destroy(&potential_ep_types);
 
 		//validate all
-		for (size_t i = 0; i < apol_vector_get_size(local_results); i++) {
-			apol_domain_trans_result_t *res = apol_vector_get_element(local_results, i);
-			if (res->start_type && res->ep_type && res->end_type && apol_vector_get_size(res->proc_trans_rules) &&
-			    apol_vector_get_size(res->ep_rules) && apol_vector_get_size(res->exec_rules) &&
-			    (requires_setexec_or_type_trans(policy)
-			     ? (apol_vector_get_size(res->setexec_rules) || apol_vector_get_size(res->type_trans_rules)) : true)) {
-				res->valid = true;
-			}
-		}
+		validate_results(table, local_results);
 	}
 	//iff looking for invalid find orphan type_transition rules
 	if (dta->valid & APOL_DOMAIN_TRANS_SEARCH_INVALID) {
-		if (domain_trans_table_find_orphan_type_transitions(policy, dta, local_results)) {
+		if (domain_trans_table_find_orphan_type_transitions(policy, dta, local_results, end_type)) {
 			error = errno;
 			goto err;
 		}
 	}
 
+	apol_bitset_release(&candidate_starts);
 	apol_domain_trans_result_destroy(&tmpl_result);
 	return 0;
 
       err:
+	apol_bitset_release(&candidate_starts);
 	apol_domain_trans_result_destroy(&tmpl_result);
 	errno = error;
 	return -1;
@@ -1802,6 +1823,876 @@ int apol_domain_trans_analysis_do(apol_policy_t * policy, apol_domain_trans_anal
 	return -1;
 }
 
+/* multi-hop path search */
+
+/** a single transition within the path search; results are built
+ *  once per transition and then copied into every path using it */
+typedef struct path_hop
+{
+	uint32_t start;
+	uint32_t ep;
+	uint32_t end;
+	apol_domain_trans_result_t *result;
+} path_hop_t;
+
+typedef struct path_search
+{
+	apol_domain_trans_table_t *table;
+	unsigned int reqs;
+	uint32_t start;
+	uint32_t end;
+	/** number of transitions in every shortest path */
+	size_t length;
+	/** for each type value, the number of transitions needed to
+	 *  reach it from the start, or UINT_MAX if not yet reached */
+	unsigned int *depth;
+	/** for each reached type, the domains one transition closer
+	 *  to the start which may transition into it */
+	apol_bitset_t *preds;
+	/** domain values of the path being built, from start to end */
+	uint32_t *chain;
+	/** scratch entrypoint sets, one for each transition of a path */
+	apol_bitset_t *eps;
+	/** path_hop_t already built */
+	apol_bst_t *hops;
+	/** apol_domain_trans_result_t of the path being built */
+	apol_vector_t *steps;
+	/** apol_domain_trans_path_t found thus far */
+	apol_vector_t *paths;
+} path_search_t;
+
+static int path_hop_cmp(const void *a, const void *b, void *data __attribute__ ((unused)))
+{
+	const path_hop_t *ha = a;
+	const path_hop_t *hb = b;
+	if (ha->start != hb->start)
+		return (ha->start < hb->start ? -1 : 1);
+	if (ha->ep != hb->ep)
+		return (ha->ep < hb->ep ? -1 : 1);
+	if (ha->end != hb->end)
+		return (ha->end < hb->end ? -1 : 1);
+	return 0;
+}
+
+static void path_hop_free(void *x)
+{
+	path_hop_t *hop = x;
+	if (!hop)
+		return;
+	apol_domain_trans_result_destroy(&hop->result);
+	free(hop);
+}
+
+static void domain_trans_path_free(void *x)
+{
+	apol_domain_trans_path_t *path = x;
+	if (!path)
+		return;
+	apol_vector_destroy(&path->steps);
+	free(path);
+}
+
+/**
+ * Determine if a transition satisfies the search's requirements.  The
+ * caller has already established that the start may transition to
+ * the end, that the end has the entrypoint, and that the start may
+ * execute the entrypoint.
+ */
+static bool path_hop_meets_requirements(const apol_domain_trans_table_t * table, unsigned int reqs, uint32_t start, uint32_t ep,
+					uint32_t end)
+{
+	dom_node_t *start_node = table_get_dom_node(table, start);
+	ep_node_t *ep_node = table_get_ep_node(table, ep);
+	bool sx = (start_node && apol_vector_get_size(start_node->setexec_rules) > 0);
+	bool tt = false;
+	if (ep_node) {
+		size_t num;
+		terule_node_t *nodes = terule_list_find(&ep_node->type_transition_rules, start, &num);
+		for (size_t i = 0; i < num && !tt; i++)
+			tt = (nodes[i].dflt_value == end);
+	}
+	if ((reqs & APOL_DOMAIN_TRANS_PATH_REQUIRE_SETEXEC) && !sx)
+		return false;
+	if ((reqs & APOL_DOMAIN_TRANS_PATH_REQUIRE_TYPE_TRANS) && !tt)
+		return false;
+	if (table->requires_setexec_or_type_trans)
+		return (sx || tt);
+	return true;
+}
+
+/**
+ * Find the entrypoints through which start may validly transition
+ * into end, storing them into eps.
+ *
+ * @return True if there is at least one such entrypoint.
+ */
+static bool path_find_entrypoints(const path_search_t * ps, uint32_t start, uint32_t end, apol_bitset_t * eps)
+{
+	dom_node_t *end_node = table_get_dom_node(ps->table, end);
+	bool found = false;
+	if (!end_node) {
+		apol_bitset_clear(eps);
+		return false;
+	}
+	apol_bitset_and(eps, &end_node->entrypoint_targets, ps->table->exec_targets + start);
+	for (size_t ep = apol_bitset_next(eps, 0); ep < eps->size; ep = apol_bitset_next(eps, ep + 1)) {
+		if (path_hop_meets_requirements(ps->table, ps->reqs, start, ep, end))
+			found = true;
+		else
+			apol_bitset_set(eps, ep, 0);
+	}
+	return found;
+}
+
+static int append_avrule_list_rules(apol_vector_t * rules, const rule_list_t * list, uint32_t value)
+{
+	size_t num;
+	avrule_node_t *nodes = avrule_list_find(list, value, &num);
+	for (size_t i = 0; i < num; i++) {
+		if (apol_vector_append(rules, (void *)nodes[i].rule))
+			return -1;
+	}
+	apol_vector_sort_uniquify(rules, NULL, NULL);
+	return 0;
+}
+
+/**
+ * Build the result for a single valid transition, with every rule
+ * that contributes to it.
+ */
+static apol_domain_trans_result_t *path_hop_result_create(const apol_domain_trans_table_t * table, uint32_t start, uint32_t ep,
+							  uint32_t end)
+{
+	dom_node_t *start_node = table_get_dom_node(table, start);
+	dom_node_t *end_node = table_get_dom_node(table, end);
+	ep_node_t *ep_node = table_get_ep_node(table, ep);
+	apol_domain_trans_result_t *res = domain_trans_result_create();
+	int error = 0;
+	if (!res)
+		return NULL;
+	res->start_type = table->types[start];
+	res->ep_type = table->types[ep];
+	res->end_type = table->types[end];
+	res->valid = true;
+	if (append_avrule_list_rules(res->proc_trans_rules, &start_node->proc_trans_rules, end) ||
+	    append_avrule_list_rules(res->ep_rules, &end_node->entrypoint_rules, ep) ||
+	    append_avrule_list_rules(res->exec_rules, &ep_node->execute_rules, start)) {
+		error = errno;
+		goto err;
+	}
+	if (table->requires_setexec_or_type_trans) {
+		size_t num;
+		terule_node_t *nodes = terule_list_find(&ep_node->type_transition_rules, start, &num);
+		for (size_t i = 0; i < num; i++) {
+			if (nodes[i].dflt_value == end && apol_vector_append(res->type_trans_rules, (void *)nodes[i].rule)) {
+				error = errno;
+				goto err;
+			}
+		}
+		apol_vector_sort_uniquify(res->type_trans_rules, NULL, NULL);
+		if (apol_vector_cat(res->setexec_rules, start_node->setexec_rules)) {
+			error = errno;
+			goto err;
+		}
+	}
+	return res;
+      err:
+	apol_domain_trans_result_destroy(&res);
+	errno = error;
+	return NULL;
+}
+
+static apol_domain_trans_result_t *path_search_get_hop(path_search_t * ps, uint32_t start, uint32_t ep, uint32_t end)
+{
+	path_hop_t key = { start, ep, end, NULL };
+	path_hop_t *hop = NULL;
+	int error;
+	if (apol_bst_get_element(ps->hops, &key, NULL, (void **)&hop) == 0)
+		return hop->result;
+	if (!(hop = calloc(1, sizeof(*hop))))
+		return NULL;
+	*hop = key;
+	if (!(hop->result = path_hop_result_create(ps->table, start, ep, end)) || apol_bst_insert(ps->hops, hop, NULL)) {
+		error = errno;
+		path_hop_free(hop);
+		errno = error;
+		return NULL;
+	}
+	return hop->result;
+}
+
+/**
+ * Having fixed the chain of domains, recursively choose an
+ * entrypoint for each transition within it, adding a path for each
+ * combination.
+ */
+static int path_search_expand_entrypoints(path_search_t * ps, size_t hop_index)
+{
+	apol_domain_trans_path_t *path = NULL;
+	int error = 0;
+	if (hop_index == ps->length) {
+		if (!(path = calloc(1, sizeof(*path))) ||
+		    !(path->steps = apol_vector_create_with_capacity(ps->length, domain_trans_result_free))) {
+			error = errno;
+			goto err;
+		}
+		for (size_t i = 0; i < ps->length; i++) {
+			apol_domain_trans_result_t *res =
+				apol_domain_trans_result_create_from_domain_trans_result(apol_vector_get_element(ps->steps, i));
+			if (!res || apol_vector_append(path->steps, res)) {
+				error = errno;
+				domain_trans_result_free(res);
+				goto err;
+			}
+		}
+		if (apol_vector_append(ps->paths, path)) {
+			error = errno;
+			goto err;
+		}
+		return 0;
+	}
+
+	uint32_t start = ps->chain[hop_index], end = ps->chain[hop_index + 1];
+	apol_bitset_t *eps = ps->eps + hop_index;
+	path_find_entrypoints(ps, start, end, eps);
+	for (size_t ep = apol_bitset_next(eps, 0); ep < eps->size; ep = apol_bitset_next(eps, ep + 1)) {
+		apol_domain_trans_result_t *res = path_search_get_hop(ps, start, ep, end);
+		if (!res || apol_vector_append(ps->steps, res)) {
+			error = errno;
+			goto err;
+		}
+		if (path_search_expand_entrypoints(ps, hop_index + 1)) {
+			error = errno;
+			goto err;
+		}
+		apol_vector_remove(ps->steps, hop_index);
+	}
+	return 0;
+      err:
+	domain_trans_path_free(path);
+	errno = error;
+	return -1;
+}
+
+/**
+ * Walk backwards from a domain towards the start, along the
+ * predecessors recorded by the breadth first search.  Every chain of
+ * domains so found is a shortest path.
+ */
+static int path_search_walk_chain(path_search_t * ps, uint32_t node, size_t pos)
+{
+	ps->chain[pos] = node;
+	if (pos == 0)
+		return path_search_expand_entrypoints(ps, 0);
+	apol_bitset_t *preds = ps->preds + node;
+	for (size_t pred = apol_bitset_next(preds, 0); pred < preds->size; pred = apol_bitset_next(preds, pred + 1)) {
+		if (path_search_walk_chain(ps, pred, pos - 1))
+			return -1;
+	}
+	return 0;
+}
+
+/**
+ * Breadth first search from the start domain, one level of
+ * transitions at a time, until the end domain is reached or the
+ * maximum depth is exceeded.
+ */
+static int path_search_bfs(path_search_t * ps, unsigned int max_depth)
+{
+	apol_domain_trans_table_t *table = ps->table;
+	uint32_t *frontier = NULL, *next = NULL;
+	size_t frontier_size = 0, next_size;
+	apol_bitset_t eps = { 0, 0, NULL };
+	unsigned int level = 0;
+	int error = 0;
+
+	if (!(frontier = malloc(table->size * sizeof(*frontier))) || !(next = malloc(table->size * sizeof(*next))) ||
+	    apol_bitset_init(&eps, table->size)) {
+		error = errno;
+		goto err;
+	}
+	ps->depth[ps->start] = 0;
+	frontier[frontier_size++] = ps->start;
+	while (frontier_size > 0 && ps->depth[ps->end] == UINT_MAX && (max_depth == 0 || level < max_depth)) {
+		next_size = 0;
+		for (size_t i = 0; i < frontier_size; i++) {
+			uint32_t start = frontier[i];
+			dom_node_t *start_node = table_get_dom_node(table, start);
+			if (!start_node)
+				continue;
+			for (size_t end = apol_bitset_next(&start_node->proc_trans_targets, 0); end < table->size;
+			     end = apol_bitset_next(&start_node->proc_trans_targets, end + 1)) {
+				if (end == start || ps->depth[end] < level + 1)
+					continue;
+				if (!path_find_entrypoints(ps, start, end, &eps))
+					continue;
+				if (ps->depth[end] == UINT_MAX) {
+					if (apol_bitset_init(ps->preds + end, table->size)) {
+						error = errno;
+						goto err;
+					}
+					ps->depth[end] = level + 1;
+					next[next_size++] = end;
+				}
+				apol_bitset_set(ps->preds + end, start, 1);
+			}
+		}
+		uint32_t *tmp = frontier;
+		frontier = next;
+		next = tmp;
+		frontier_size = next_size;
+		level++;
+	}
+	free(frontier);
+	free(next);
+	apol_bitset_release(&eps);
+	return 0;
+      err:
+	free(frontier);
+	free(next);
+	apol_bitset_release(&eps);
+	errno = error;
+	return -1;
+}
+
+/**
+ * Look up a type by name for an analysis, rejecting attributes.
+ */
+static int domain_trans_get_domain(apol_policy_t * policy, const char *name, const qpol_type_t ** type)
+{
+	unsigned char isattr = 0;
+	if (qpol_policy_get_type_by_name(policy->p, name, type)) {
+		ERR(policy, "Unable to perform analysis: Invalid type %s", name);
+		return -1;
+	}
+	qpol_type_get_isattr(policy->p, *type, &isattr);
+	if (isattr) {
+		ERR(policy, "%s", "Attributes are not valid here.");
+		errno = EINVAL;
+		return -1;
+	}
+	return 0;
+}
+
+int apol_domain_trans_analysis_do_paths(apol_policy_t * policy, apol_domain_trans_analysis_t * dta, apol_vector_t ** paths)
+{
+	path_search_t ps;
+	const qpol_type_t *start_type = NULL, *end_type = NULL;
+	int error = 0;
+	memset(&ps, 0, sizeof(ps));
+	if (paths)
+		*paths = NULL;
+	if (!policy || !dta || !paths || !dta->start_type || !dta->end_type) {
+		ERR(policy, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* build table if not already present */
+	if (!(policy->domain_trans_table)) {
+		if (apol_policy_build_domain_trans_table(policy))
+			return -1;     /* errors already reported by build function */
+	}
+	if (domain_trans_get_domain(policy, dta->start_type, &start_type) ||
+	    domain_trans_get_domain(policy, dta->end_type, &end_type)) {
+		error = errno;
+		goto err;
+	}
+
+	ps.table = policy->domain_trans_table;
+	ps.reqs = dta->path_reqs;
+	ps.start = table_type_value(policy, start_type);
+	ps.end = table_type_value(policy, end_type);
+	if (!(ps.paths = apol_vector_create(domain_trans_path_free))) {
+		error = errno;
+		ERR(policy, "%s", strerror(error));
+		goto err;
+	}
+	if (ps.start == ps.end) {
+		/* no transition to self */
+		*paths = ps.paths;
+		return 0;
+	}
+	if (!(ps.depth = malloc(ps.table->size * sizeof(*ps.depth))) ||
+	    !(ps.preds = calloc(ps.table->size, sizeof(*ps.preds)))) {
+		error = errno;
+		ERR(policy, "%s", strerror(error));
+		goto err;
+	}
+	for (size_t i = 0; i < ps.table->size; i++)
+		ps.depth[i] = UINT_MAX;
+	if (path_search_bfs(&ps, dta->max_depth)) {
+		error = errno;
+		ERR(policy, "%s", strerror(error));
+		goto err;
+	}
+
+	if (ps.depth[ps.end] != UINT_MAX) {
+		ps.length = ps.depth[ps.end];
+		if (!(ps.chain = calloc(ps.length + 1, sizeof(*ps.chain))) ||
+		    !(ps.eps = calloc(ps.length, sizeof(*ps.eps))) ||
+		    !(ps.hops = apol_bst_create(path_hop_cmp, path_hop_free)) ||
+		    !(ps.steps = apol_vector_create_with_capacity(ps.length, NULL))) {
+			error = errno;
+			ERR(policy, "%s", strerror(error));
+			goto err;
+		}
+		for (size_t i = 0; i < ps.length; i++) {
+			if (apol_bitset_init(ps.eps + i, ps.table->size)) {
+				error = errno;
+				ERR(policy, "%s", strerror(error));
+				goto err;
+			}
+		}
+		if (path_search_walk_chain(&ps, ps.end, ps.length)) {
+			error = errno;
+			ERR(policy, "%s", strerror(error));
+			goto err;
+		}
+	}
+
+	*paths = ps.paths;
+	ps.paths = NULL;
+	error = 0;
+      err:
+	if (ps.preds) {
+		for (size_t i = 0; i < ps.table->size; i++)
+			apol_bitset_release(ps.preds + i);
+	}
+	if (ps.eps) {
+		for (size_t i = 0; i < ps.length; i++)
+			apol_bitset_release(ps.eps + i);
+	}
+	free(ps.depth);
+	free(ps.preds);
+	free(ps.chain);
+	free(ps.eps);
+	apol_bst_destroy(&ps.hops);
+	apol_vector_destroy(&ps.steps);
+	apol_vector_destroy(&ps.paths);
+	if (error) {
+		errno = error;
+		return -1;
+	}
+	return 0;
+}
+
+/* whole policy sweep */
+
+/**
+ * A type_transition rule, indexed by its source domain.
+ */
+typedef struct sweep_tt
+{
+	uint32_t ep;
+	uint32_t dflt;
+} sweep_tt_t;
+
+/**
+ * State shared by every thread of a sweep.  Everything here,
+ * including the table, is only read once the threads start.
+ */
+typedef struct sweep
+{
+	const apol_domain_trans_table_t *table;
+	/** type_transition rules grouped by source domain; those
+	 *  for domain value v are tts[tt_offsets[v]] through
+	 *  tts[tt_offsets[v + 1] - 1] */
+	size_t *tt_offsets;
+	sweep_tt_t *tts;
+	unsigned int num_threads;
+} sweep_t;
+
+typedef struct sweep_worker
+{
+	const sweep_t *sweep;
+	unsigned int id;
+	pthread_t thread;
+	/** domain_trans_edge_t found by this worker */
+	rule_list_t edges;
+	int error;
+} sweep_worker_t;
+
+/**
+ * A single transition found by a sweep.  Types are stored by value
+ * to keep the edge list compact.
+ */
+typedef struct domain_trans_edge
+{
+	uint32_t start;
+	/** 0 if the end domain has no entrypoint at all */
+	uint32_t ep;
+	uint32_t end;
+	/** bit-wise or of APOL_DOMAIN_TRANS_RULE_*, or 0 if valid */
+	int missing_rules;
+} domain_trans_edge_t;
+
+struct apol_domain_trans_edge_list
+{
+	/** a copy of the table's type array, by which edge values are
+	 *  mapped back to types; copied so that the list outlives the
+	 *  table */
+	const qpol_type_t **types;
+	domain_trans_edge_t *edges;
+	size_t size;
+};
+
+static int domain_trans_edge_cmp(const void *a, const void *b)
+{
+	const domain_trans_edge_t *ea = a;
+	const domain_trans_edge_t *eb = b;
+	if (ea->start != eb->start)
+		return (ea->start < eb->start ? -1 : 1);
+	if (ea->end != eb->end)
+		return (ea->end < eb->end ? -1 : 1);
+	if (ea->ep != eb->ep)
+		return (ea->ep < eb->ep ? -1 : 1);
+	return 0;
+}
+
+/**
+ * Build the index of type_transition rules by source domain, so that
+ * the threads need not search every entrypoint node for them.
+ */
+static int sweep_index_type_transitions(sweep_t * sw)
+{
+	const apol_domain_trans_table_t *table = sw->table;
+	size_t i, j, total = 0;
+	if (!(sw->tt_offsets = calloc(table->size + 1, sizeof(*sw->tt_offsets))))
+		return -1;
+	for (i = 0; i < table->size; i++) {
+		ep_node_t *node = table->entrypoints[i];
+		terule_node_t *nodes;
+		if (!node)
+			continue;
+		nodes = node->type_transition_rules.nodes;
+		for (j = 0; j < node->type_transition_rules.size; j++)
+			sw->tt_offsets[nodes[j].src_value + 1]++;
+	}
+	for (i = 1; i <= table->size; i++)
+		sw->tt_offsets[i] += sw->tt_offsets[i - 1];
+	total = sw->tt_offsets[table->size];
+	if (total == 0)
+		return 0;
+	if (!(sw->tts = malloc(total * sizeof(*sw->tts))))
+		return -1;
+	/* fill each source's bucket, temporarily advancing its
+	 * offset, and then shift the offsets back */
+	for (i = 0; i < table->size; i++) {
+		ep_node_t *node = table->entrypoints[i];
+		terule_node_t *nodes;
+		if (!node)
+			continue;
+		nodes = node->type_transition_rules.nodes;
+		for (j = 0; j < node->type_transition_rules.size; j++) {
+			sweep_tt_t *tt = sw->tts + sw->tt_offsets[nodes[j].src_value]++;
+			tt->ep = i;
+			tt->dflt = nodes[j].dflt_value;
+		}
+	}
+	for (i = table->size; i > 0; i--)
+		sw->tt_offsets[i] = sw->tt_offsets[i - 1];
+	sw->tt_offsets[0] = 0;
+	return 0;
+}
+
+/**
+ * Determine which rules a transition lacks, consulting only the
+ * table's bitsets and the type_transition index.  This neither reads
+ * nor writes the table's used marks and is thus safe to call from
+ * several threads at once.
+ */
+static int sweep_missing_rules(const sweep_t * sw, uint32_t start, uint32_t ep, uint32_t end)
+{
+	const apol_domain_trans_table_t *table = sw->table;
+	dom_node_t *start_node = table_get_dom_node(table, start);
+	dom_node_t *end_node = table_get_dom_node(table, end);
+	int missing_rules = 0;
+	bool tt = false, any_tt = false, sx = false;
+
+	if (!start_node || !apol_bitset_get(&start_node->proc_trans_targets, end))
+		missing_rules |= APOL_DOMAIN_TRANS_RULE_PROC_TRANS;
+	if (!end_node || !ep || !apol_bitset_get(&end_node->entrypoint_targets, ep))
+		missing_rules |= APOL_DOMAIN_TRANS_RULE_ENTRYPOINT;
+	if (!ep || !apol_bitset_get(table->exec_targets + start, ep))
+		missing_rules |= APOL_DOMAIN_TRANS_RULE_EXEC;
+	if (!table->requires_setexec_or_type_trans)
+		return missing_rules;
+
+	sx = (start_node && apol_vector_get_size(start_node->setexec_rules) > 0);
+	for (size_t i = sw->tt_offsets[start]; i < sw->tt_offsets[start + 1]; i++) {
+		if (sw->tts[i].dflt == end) {
+			any_tt = true;
+			if (sw->tts[i].ep == ep)
+				tt = true;
+		}
+	}
+	if (!tt && !sx) {
+		missing_rules |= APOL_DOMAIN_TRANS_RULE_SETEXEC;
+		/* as in apol_domain_trans_table_verify_trans(), a
+		 * type_transition for another entrypoint means that one
+		 * is not missing, as adding it would be invalid */
+		if (!any_tt)
+			missing_rules |= APOL_DOMAIN_TRANS_RULE_TYPE_TRANS;
+	}
+	return missing_rules;
+}
+
+static int sweep_add_edge(const sweep_t * sw, rule_list_t * edges, uint32_t start, uint32_t ep, uint32_t end)
+{
+	domain_trans_edge_t *edge = rule_list_append(edges, sizeof(*edge));
+	if (!edge)
+		return -1;
+	edge->start = start;
+	edge->ep = ep;
+	edge->end = end;
+	edge->missing_rules = sweep_missing_rules(sw, start, ep, end);
+	return 0;
+}
+
+/**
+ * Find every transition out of a single domain: one for each
+ * entrypoint of each domain to which it has process transition, and
+ * one for each type_transition rule it is the source of.
+ */
+static int sweep_domain(const sweep_t * sw, rule_list_t * edges, uint32_t start)
+{
+	const apol_domain_trans_table_t *table = sw->table;
+	dom_node_t *start_node = table_get_dom_node(table, start);
+
+	if (start_node) {
+		const apol_bitset_t *ends = &start_node->proc_trans_targets;
+		for (size_t end = apol_bitset_next(ends, 0); end < ends->size; end = apol_bitset_next(ends, end + 1)) {
+			dom_node_t *end_node = table_get_dom_node(table, end);
+			if (end == start)
+				continue;
+			if (!end_node || apol_bitset_is_empty(&end_node->entrypoint_targets)) {
+				if (sweep_add_edge(sw, edges, start, 0, end))
+					return -1;
+				continue;
+			}
+			const apol_bitset_t *eps = &end_node->entrypoint_targets;
+			for (size_t ep = apol_bitset_next(eps, 0); ep < eps->size; ep = apol_bitset_next(eps, ep + 1)) {
+				if (sweep_add_edge(sw, edges, start, ep, end))
+					return -1;
+			}
+		}
+	}
+	for (size_t i = sw->tt_offsets[start]; i < sw->tt_offsets[start + 1]; i++) {
+		const sweep_tt_t *tt = sw->tts + i;
+		dom_node_t *end_node = table_get_dom_node(table, tt->dflt);
+		if (tt->dflt == start)
+			continue;
+		/* skip those already found above */
+		if (start_node && end_node && apol_bitset_get(&start_node->proc_trans_targets, tt->dflt) &&
+		    apol_bitset_get(&end_node->entrypoint_targets, tt->ep))
+			continue;
+		if (sweep_add_edge(sw, edges, start, tt->ep, tt->dflt))
+			return -1;
+	}
+	return 0;
+}
+
+static void *sweep_worker_run(void *arg)
+{
+	sweep_worker_t *w = arg;
+	const sweep_t *sw = w->sweep;
+	/* domains are dealt out round robin, as those with many
+	 * transitions tend to have adjacent values */
+	for (size_t start = w->id + 1; start < sw->table->size; start += sw->num_threads) {
+		if (sweep_domain(sw, &w->edges, start)) {
+			w->error = errno;
+			break;
+		}
+	}
+	return NULL;
+}
+
+int apol_policy_get_domain_trans_edges(apol_policy_t * policy, unsigned int num_threads, apol_domain_trans_edge_list_t ** edges)
+{
+	sweep_t sw;
+	sweep_worker_t *workers = NULL;
+	unsigned int i, num_started = 0;
+	rule_list_t all = { NULL, 0, 0 };
+	int error = 0;
+
+	memset(&sw, 0, sizeof(sw));
+	if (edges)
+		*edges = NULL;
+	if (!policy || !edges) {
+		ERR(policy, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	if (!(policy->domain_trans_table)) {
+		if (apol_policy_build_domain_trans_table(policy))
+			return -1;     /* errors already reported by build function */
+	}
+	sw.table = policy->domain_trans_table;
+
+	if (num_threads == 0) {
+		long n = sysconf(_SC_NPROCESSORS_ONLN);
+		num_threads = (n > 0 ? (unsigned int)n : 1);
+	}
+	if (num_threads > sw.table->size)
+		num_threads = sw.table->size;
+	sw.num_threads = num_threads;
+
+	if (sweep_index_type_transitions(&sw) || !(workers = calloc(num_threads, sizeof(*workers)))) {
+		error = errno;
+		ERR(policy, "%s", strerror(error));
+		goto err;
+	}
+	for (i = 0; i < num_threads; i++) {
+		workers[i].sweep = &sw;
+		workers[i].id = i;
+	}
+	/* the calling thread does the first share of the work itself */
+	for (i = 1; i < num_threads; i++) {
+		if ((error = pthread_create(&workers[i].thread, NULL, sweep_worker_run, workers + i)) != 0) {
+			ERR(policy, "%s", strerror(error));
+			break;
+		}
+		num_started++;
+	}
+	if (error == 0)
+		sweep_worker_run(workers);
+	for (i = 1; i <= num_started; i++)
+		pthread_join(workers[i].thread, NULL);
+	if (error)
+		goto err;
+
+	for (i = 0; i < num_threads; i++) {
+		if (workers[i].error) {
+			error = workers[i].error;
+			ERR(policy, "%s", strerror(error));
+			goto err;
+		}
+		all.size += workers[i].edges.size;
+	}
+	if (all.size > 0 && !(all.nodes = malloc(all.size * sizeof(domain_trans_edge_t)))) {
+		error = errno;
+		ERR(policy, "%s", strerror(error));
+		goto err;
+	}
+	all.capacity = all.size;
+	all.size = 0;
+	for (i = 0; i < num_threads; i++) {
+		memcpy((domain_trans_edge_t *) all.nodes + all.size, workers[i].edges.nodes,
+		       workers[i].edges.size * sizeof(domain_trans_edge_t));
+		all.size += workers[i].edges.size;
+	}
+	rule_list_sort_uniquify(&all, sizeof(domain_trans_edge_t), domain_trans_edge_cmp);
+
+	if (!(*edges = calloc(1, sizeof(**edges))) || !((*edges)->types = malloc(sw.table->size * sizeof(qpol_type_t *)))) {
+		error = errno;
+		ERR(policy, "%s", strerror(error));
+		apol_domain_trans_edge_list_destroy(edges);
+		goto err;
+	}
+	memcpy((*edges)->types, sw.table->types, sw.table->size * sizeof(qpol_type_t *));
+	(*edges)->edges = all.nodes;
+	(*edges)->size = all.size;
+	all.nodes = NULL;
+
+      err:
+	if (workers) {
+		for (i = 0; i < num_threads; i++)
+			rule_list_release(&workers[i].edges);
+	}
+	free(workers);
+	free(sw.tt_offsets);
+	free(sw.tts);
+	rule_list_release(&all);
+	if (error) {
+		errno = error;
+		return -1;
+	}
+	return 0;
+}
+
+/* path */
+size_t apol_domain_trans_path_get_length(const apol_domain_trans_path_t * path)
+{
+	if (!path) {
+		errno = EINVAL;
+		return 0;
+	}
+	return apol_vector_get_size(path->steps);
+}
+
+const apol_vector_t *apol_domain_trans_path_get_steps(const apol_domain_trans_path_t * path)
+{
+	if (!path) {
+		errno = EINVAL;
+		return NULL;
+	}
+	return path->steps;
+}
+
+/* edge list */
+void apol_domain_trans_edge_list_destroy(apol_domain_trans_edge_list_t ** edges)
+{
+	if (!edges || !*edges)
+		return;
+	free((*edges)->types);
+	free((*edges)->edges);
+	free(*edges);
+	*edges = NULL;
+}
+
+size_t apol_domain_trans_edge_list_get_size(const apol_domain_trans_edge_list_t * edges)
+{
+	if (!edges) {
+		errno = EINVAL;
+		return 0;
+	}
+	return edges->size;
+}
+
+/**
+ * Return an edge from a list, or NULL (setting errno) if the
+ * arguments are invalid.
+ */
+static const domain_trans_edge_t *edge_list_get_edge(const apol_domain_trans_edge_list_t * edges, size_t i)
+{
+	if (!edges || i >= edges->size) {
+		errno = EINVAL;
+		return NULL;
+	}
+	return edges->edges + i;
+}
+
+const qpol_type_t *apol_domain_trans_edge_list_get_start_type(const apol_domain_trans_edge_list_t * edges, size_t i)
+{
+	const domain_trans_edge_t *edge = edge_list_get_edge(edges, i);
+	return (edge ? edges->types[edge->start] : NULL);
+}
+
+const qpol_type_t *apol_domain_trans_edge_list_get_entrypoint_type(const apol_domain_trans_edge_list_t * edges, size_t i)
+{
+	const domain_trans_edge_t *edge = edge_list_get_edge(edges, i);
+	return (edge && edge->ep ? edges->types[edge->ep] : NULL);
+}
+
+const qpol_type_t *apol_domain_trans_edge_list_get_end_type(const apol_domain_trans_edge_list_t * edges, size_t i)
+{
+	const domain_trans_edge_t *edge = edge_list_get_edge(edges, i);
+	return (edge ? edges->types[edge->end] : NULL);
+}
+
+int apol_domain_trans_edge_list_get_missing_rules(const apol_domain_trans_edge_list_t * edges, size_t i)
+{
+	const domain_trans_edge_t *edge = edge_list_get_edge(edges, i);
+	return (edge ? edge->missing_rules : -1);
+}
+
+int apol_domain_trans_edge_list_is_trans_valid(const apol_domain_trans_edge_list_t * edges, size_t i)
+{
+	const domain_trans_edge_t *edge = edge_list_get_edge(edges, i);
+	return (edge ? edge->missing_rules == 0 : 0);
+}
+
 /* result */
 
 const qpol_type_t *apol_domain_trans_result_get_start_type(const apol_domain_trans_result_t * dtr)
@@ -1913,57 +2804,41 @@ int apol_domain_trans_table_verify_trans(apol_policy_t * policy, const qpol_type
 		errno = EINVAL;
 		return -1;
 	}
-	//reset the table
-	apol_policy_reset_domain_trans_table(policy);
-	//find nodes for each type
-	dom_node_t start_dummy = { start_dom, NULL, NULL, NULL };
-	dom_node_t *start_node = NULL;
-	if (start_dom)
-		apol_bst_get_element(policy->domain_trans_table->domain_table, (void *)&start_dummy, NULL, (void **)&start_node);
-	ep_node_t ep_dummy = { ep_type, NULL, NULL };
-	ep_node_t *ep_node = NULL;
-	if (ep_type)
-		apol_bst_get_element(policy->domain_trans_table->entrypoint_table, (void *)&ep_dummy, NULL, (void **)&ep_node);
-	dom_node_t end_dummy = { end_dom, NULL, NULL, NULL };
-	dom_node_t *end_node = NULL;
-	if (end_dom)
-		apol_bst_get_element(policy->domain_trans_table->domain_table, (void *)&end_dummy, NULL, (void **)&end_node);
+	apol_domain_trans_table_t *table = policy->domain_trans_table;
+	//find nodes for each type; membership is answered by the table's bitsets, so the table need not be reset
+	uint32_t start_value = table_type_value(policy, start_dom);
+	uint32_t ep_value = table_type_value(policy, ep_type);
+	uint32_t end_value = table_type_value(policy, end_dom);
+	dom_node_t *start_node = table_get_dom_node(table, start_value);
+	ep_node_t *ep_node = table_get_ep_node(table, ep_value);
+	dom_node_t *end_node = table_get_dom_node(table, end_value);
 
 	bool tt = false, sx = false, ex = false, pt = false, ep = false;
 
 	//find process transition rule
-	if (start_node && end_dom) {
-		apol_vector_t *v = find_avrules_in_node(start_node, APOL_DOMAIN_TRANS_RULE_PROC_TRANS, end_dom);
-		if (apol_vector_get_size(v))
-			pt = true;
-		apol_vector_destroy(&v);
-	}
+	if (start_node && end_dom)
+		pt = apol_bitset_get(&start_node->proc_trans_targets, end_value);
 	//find execute rule
-	if (start_dom && ep_node) {
-		apol_vector_t *v = find_avrules_in_node(ep_node, APOL_DOMAIN_TRANS_RULE_EXEC, start_dom);
-		if (apol_vector_get_size(v))
-			ex = true;
-		apol_vector_destroy(&v);
-	}
+	if (start_dom && ep_node)
+		ex = apol_bitset_get(&ep_node->exec_sources, start_value);
 	//find entrypoint rules
-	if (end_node && ep_type) {
-		apol_vector_t *v = find_avrules_in_node(end_node, APOL_DOMAIN_TRANS_RULE_ENTRYPOINT, ep_type);
-		if (apol_vector_get_size(v))
-			ep = true;
-		apol_vector_destroy(&v);
-	}
-	if (requires_setexec_or_type_trans(policy)) {
+	if (end_node && ep_type)
+		ep = apol_bitset_get(&end_node->entrypoint_targets, ep_value);
+	if (table->requires_setexec_or_type_trans) {
 		//find setexec rule
 		if (start_node)
 			if (apol_vector_get_size(start_node->setexec_rules))
 				sx = true;
 		//find type_transition rule
-		if (ep_node && start_dom && end_dom) {
-			apol_vector_t *v = find_terules_in_node(ep_node, start_dom, end_dom);
-			if (apol_vector_get_size(v)) {
-				tt = true;
+		if (ep_node && start_dom && end_dom && start_value != end_value) {
+			size_t num;
+			terule_node_t *nodes = terule_list_find(&ep_node->type_transition_rules, start_value, &num);
+			for (size_t i = 0; i < num; i++) {
+				if (nodes[i].dflt_value == end_value) {
+					tt = true;
+					break;
+				}
 			}
-			apol_vector_destroy(&v);
 		}
 	} else {
 		//old policy version - pretend these exist
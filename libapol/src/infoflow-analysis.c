@@ -552,51 +552,24 @@ static int apol_infoflow_graph_create_avrule(const apol_policy_t * p, apol_infof
 					     apol_bst_t * types, int max_len)
 {
 	const qpol_class_t *obj_class;
-	qpol_iterator_t *perm_iter = NULL;
-	const char *obj_class_name;
-	char *perm_name;
-	int found_read = 0, found_write = 0, perm_error = 0;
-	int read_len = INT_MAX, write_len = INT_MAX;
+	uint32_t class_value, perm_mask;
+	int found_read, found_write, perm_error;
+	int read_len, write_len;
 	int retval = -1;
 	if (qpol_avrule_get_object_class(p->p, rule, &obj_class) < 0 ||
-	    qpol_class_get_name(p->p, obj_class, &obj_class_name) < 0 || qpol_avrule_get_perm_iter(p->p, rule, &perm_iter) < 0) {
+	    qpol_class_get_value(p->p, obj_class, &class_value) < 0 || qpol_avrule_get_perm_mask(p->p, rule, &perm_mask) < 0) {
 		goto cleanup;
 	}
 
-	/* find read or write flows for each object class/perm pair */
-	for (; !qpol_iterator_end(perm_iter); qpol_iterator_next(perm_iter)) {
-		int perm_map, perm_weight, len;
-
-		if (qpol_iterator_get_item(perm_iter, (void **)&perm_name) < 0) {
-			goto cleanup;
-		}
-		if (apol_policy_get_permmap(p, obj_class_name, perm_name, &perm_map, &perm_weight) < 0) {
-			goto cleanup;
-		}
-		free(perm_name);
-		if (perm_map == APOL_PERMMAP_UNMAPPED) {
-			perm_error = 1;
-			continue;
-		}
-		len = APOL_PERMMAP_MAX_WEIGHT - perm_weight + 1;
-		if (len < APOL_PERMMAP_MIN_WEIGHT) {
-			len = APOL_PERMMAP_MIN_WEIGHT;
-		} else if (len > APOL_PERMMAP_MAX_WEIGHT) {
-			len = APOL_PERMMAP_MAX_WEIGHT;
-		}
-		if (perm_map & APOL_PERMMAP_READ) {
-			if (len < read_len && len <= max_len) {
-				found_read = 1;
-				read_len = len;
-			}
-		}
-		if (perm_map & APOL_PERMMAP_WRITE) {
-			if (len < write_len && len <= max_len) {
-				found_write = 1;
-				write_len = len;
-			}
-		}
+	/* find the strongest read and write flows among the rule's
+	 * permissions, by masking its access vector against the
+	 * permission map */
+	if ((perm_error = permmap_get_av_flows(p, class_value, perm_mask, max_len, &read_len, &write_len)) < 0) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
 	}
+	found_read = (read_len != INT_MAX);
+	found_write = (write_len != INT_MAX);
 
 	/* if we have found any flows then connect them within the graph */
 	if ((found_read || found_write) &&
@@ -609,7 +582,6 @@ static int apol_infoflow_graph_create_avrule(const apol_policy_t * p, apol_infof
 
 	retval = 0;
       cleanup:
-	qpol_iterator_destroy(&perm_iter);
 	return retval;
 }
 
@@ -33,8 +33,10 @@
 #include <string.h>
 
 #include "policy-query-internal.h"
+#include "bitset.h"
 
 #include <qpol/iterator.h>
+#include <apol/bst.h>
 #include <apol/vector.h>
 
 struct apol_mls_level
@@ -44,27 +46,53 @@ struct apol_mls_level
 	char *literal_cats;
 };
 
-/********************* miscellaneous routines *********************/
+/** A sensitivity or category name, and its value, within a policy. */
+typedef struct mls_symbol
+{
+	/** name of the symbol or of one of its aliases; this points
+	 *  into the policy itself */
+	const char *name;
+	uint32_t value;
+	/** for a sensitivity, the set of category values it permits */
+	apol_bitset_t cats;
+} mls_symbol_t;
 
-/* Given a category datum and a category name, returns < 0 if a has
- * higher value than b, > 0 if b is higher according to the given
- * policy.  If the two are equal or upon error, return 0.
+/**
+ * Every sensitivity and category of a policy, by name.  The cache is
+ * built once per policy and never modified afterwards, so it may be
+ * read from several threads without locking.
  */
-static int apol_mls_cat_vector_compare(const void *a, const void *b, void *data)
+struct apol_mls_cache
 {
-	const qpol_cat_t *cat1 = a;
-	const char *cat2_name = b;
-	apol_policy_t *p = (apol_policy_t *) data;
-	const qpol_cat_t *cat2;
-	uint32_t cat_value1, cat_value2;
-	if (qpol_policy_get_cat_by_name(p->p, cat2_name, &cat2) < 0) {
-		return 0;
-	}
-	if (qpol_cat_get_value(p->p, cat1, &cat_value1) < 0 || qpol_cat_get_value(p->p, cat2, &cat_value2) < 0) {
-		return 0;
-	}
-	return (cat_value2 - cat_value1);
-}
+	/** hashed tree of mls_symbol_t, one per sensitivity or alias */
+	apol_bst_t *sens;
+	/** hashed tree of mls_symbol_t, one per category or alias */
+	apol_bst_t *cats;
+	/** one more than the highest category value */
+	size_t num_cat_bits;
+};
+
+/** Number of words of category bits resolved upon the stack; enough
+ *  for the customary 1024 categories on 64-bit systems. */
+#define MLS_LEVEL_STACK_WORDS 16
+
+/**
+ * A level resolved against a policy, so that comparisons are done
+ * upon values rather than names.  These are filled in by the caller's
+ * own storage and never kept within the level, so that a const level
+ * may be compared from several threads and against several policies.
+ */
+typedef struct mls_level_values
+{
+	/** the level's sensitivity, within the policy's cache */
+	const mls_symbol_t *sens;
+	/** set of category values within the level */
+	apol_bitset_t cat_bits;
+	/** storage for cat_bits, unless the policy has more categories */
+	unsigned long words[MLS_LEVEL_STACK_WORDS];
+} mls_level_values_t;
+
+/********************* miscellaneous routines *********************/
 
 /**
  * Given two category names, returns < 0 if a has higher value than b,
@@ -95,6 +123,232 @@ static int apol_mls_cat_name_compare(const void *a, const void *b, void *data)
 	return (cat_value1 - cat_value2);
 }
 
+static int mls_symbol_compare(const void *a, const void *b, void *data __attribute__ ((unused)))
+{
+	const mls_symbol_t *s1 = a, *s2 = b;
+	return strcmp(s1->name, s2->name);
+}
+
+static size_t mls_symbol_hash(const void *elem, void *data)
+{
+	const mls_symbol_t *s = elem;
+	return apol_str_hash(s->name, data);
+}
+
+static void mls_symbol_free(void *elem)
+{
+	mls_symbol_t *s = elem;
+	if (s != NULL) {
+		apol_bitset_release(&s->cats);
+		free(s);
+	}
+}
+
+void mls_cache_destroy(apol_mls_cache_t ** cache)
+{
+	if (cache != NULL && *cache != NULL) {
+		apol_bst_destroy(&(*cache)->sens);
+		apol_bst_destroy(&(*cache)->cats);
+		free(*cache);
+		*cache = NULL;
+	}
+}
+
+static void mls_cache_free(void *cache)
+{
+	apol_mls_cache_t *c = cache;
+	mls_cache_destroy(&c);
+}
+
+/**
+ * Add every category (and alias) of a policy to the cache.  Aliases
+ * share the value of their primary category.
+ */
+static int mls_cache_add_cats(const apol_policy_t * p, apol_mls_cache_t * cache)
+{
+	qpol_iterator_t *iter = NULL;
+	const qpol_cat_t *cat;
+	mls_symbol_t *s = NULL;
+	int retval = -1;
+	if (qpol_policy_get_cat_iter(p->p, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		if ((s = calloc(1, sizeof(*s))) == NULL) {
+			ERR(p, "%s", strerror(errno));
+			goto cleanup;
+		}
+		if (qpol_iterator_get_item(iter, (void **)&cat) < 0 ||
+		    qpol_cat_get_name(p->p, cat, &s->name) < 0 || qpol_cat_get_value(p->p, cat, &s->value) < 0) {
+			goto cleanup;
+		}
+		if (s->value >= cache->num_cat_bits) {
+			cache->num_cat_bits = (size_t) s->value + 1;
+		}
+		if (apol_bst_insert(cache->cats, s, NULL) < 0) {
+			ERR(p, "%s", strerror(errno));
+			goto cleanup;
+		}
+		s = NULL;
+	}
+	retval = 0;
+      cleanup:
+	mls_symbol_free(s);
+	qpol_iterator_destroy(&iter);
+	return retval;
+}
+
+/**
+ * Add every sensitivity (and alias) of a policy to the cache, along
+ * with the categories each permits.  The categories must have
+ * already been added.
+ */
+static int mls_cache_add_sens(const apol_policy_t * p, apol_mls_cache_t * cache)
+{
+	qpol_iterator_t *iter = NULL, *cat_iter = NULL;
+	const qpol_level_t *level;
+	const qpol_cat_t *cat;
+	mls_symbol_t *s = NULL;
+	uint32_t value;
+	int retval = -1;
+	if (qpol_policy_get_level_iter(p->p, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		if ((s = calloc(1, sizeof(*s))) == NULL || apol_bitset_init(&s->cats, cache->num_cat_bits) < 0) {
+			ERR(p, "%s", strerror(errno));
+			goto cleanup;
+		}
+		if (qpol_iterator_get_item(iter, (void **)&level) < 0 ||
+		    qpol_level_get_name(p->p, level, &s->name) < 0 ||
+		    qpol_level_get_value(p->p, level, &s->value) < 0 || qpol_level_get_cat_iter(p->p, level, &cat_iter) < 0) {
+			goto cleanup;
+		}
+		for (; !qpol_iterator_end(cat_iter); qpol_iterator_next(cat_iter)) {
+			if (qpol_iterator_get_item(cat_iter, (void **)&cat) < 0 || qpol_cat_get_value(p->p, cat, &value) < 0) {
+				goto cleanup;
+			}
+			apol_bitset_set(&s->cats, value, 1);
+		}
+		qpol_iterator_destroy(&cat_iter);
+		if (apol_bst_insert(cache->sens, s, NULL) < 0) {
+			ERR(p, "%s", strerror(errno));
+			goto cleanup;
+		}
+		s = NULL;
+	}
+	retval = 0;
+      cleanup:
+	mls_symbol_free(s);
+	qpol_iterator_destroy(&cat_iter);
+	qpol_iterator_destroy(&iter);
+	return retval;
+}
+
+/**
+ * Build the MLS symbol cache for a policy.
+ *
+ * @param p Policy whose symbols to cache.
+ *
+ * @return A newly allocated apol_mls_cache_t, or NULL on error with
+ * errno set.
+ */
+static void *mls_cache_create(const apol_policy_t * p)
+{
+	apol_mls_cache_t *cache;
+	int error;
+	if ((cache = calloc(1, sizeof(*cache))) == NULL ||
+	    (cache->sens = apol_bst_create_hashed(mls_symbol_compare, mls_symbol_hash, mls_symbol_free)) == NULL ||
+	    (cache->cats = apol_bst_create_hashed(mls_symbol_compare, mls_symbol_hash, mls_symbol_free)) == NULL) {
+		error = errno;
+		ERR(p, "%s", strerror(error));
+		mls_cache_destroy(&cache);
+		errno = error;
+		return NULL;
+	}
+	if (mls_cache_add_cats(p, cache) < 0 || mls_cache_add_sens(p, cache) < 0) {
+		error = errno;
+		mls_cache_destroy(&cache);
+		errno = error;
+		return NULL;
+	}
+	return cache;
+}
+
+/**
+ * Look up a symbol by name within one of the cache's trees.
+ *
+ * @return The symbol, or NULL if there is none by that name.
+ */
+static const mls_symbol_t *mls_cache_find(const apol_bst_t * symbols, const char *name)
+{
+	mls_symbol_t key;
+	void *s;
+	key.name = name;
+	if (apol_bst_get_element(symbols, &key, NULL, &s) < 0) {
+		return NULL;
+	}
+	return s;
+}
+
+/**
+ * Release the category bits of resolved level values.
+ */
+static void mls_level_values_release(mls_level_values_t * values)
+{
+	if (values->cat_bits.words != values->words) {
+		apol_bitset_release(&values->cat_bits);
+	}
+}
+
+/**
+ * Resolve a level's sensitivity and categories into their values
+ * within a policy.  The category bits are kept within the values
+ * themselves unless the policy has many categories; in any case the
+ * caller must call mls_level_values_release() afterwards, even upon
+ * error.
+ *
+ * @param p Policy in which to look up symbols.
+ * @param cache The policy's MLS symbol cache.
+ * @param level Level to resolve; it must be complete.
+ * @param values Storage into which to write the resolved values.
+ *
+ * @return 0 on success, > 0 if a category is not within the policy,
+ * < 0 if the sensitivity is not within the policy or upon error.
+ */
+static int mls_level_resolve(const apol_policy_t * p, const apol_mls_cache_t * cache, const apol_mls_level_t * level,
+			     mls_level_values_t * values)
+{
+	const mls_symbol_t *cat;
+	size_t i, num_words = (cache->num_cat_bits + APOL_BITSET_WORD_BITS - 1) / APOL_BITSET_WORD_BITS;
+	values->sens = NULL;
+	values->cat_bits.words = values->words;
+	if (num_words <= MLS_LEVEL_STACK_WORDS) {
+		values->cat_bits.size = cache->num_cat_bits;
+		values->cat_bits.num_words = num_words;
+		memset(values->words, 0, sizeof(values->words));
+	} else if (apol_bitset_init(&values->cat_bits, cache->num_cat_bits) < 0) {
+		values->cat_bits.words = values->words;
+		ERR(p, "%s", strerror(errno));
+		return -1;
+	}
+	if (level->sens == NULL || level->cats == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	if ((values->sens = mls_cache_find(cache->sens, level->sens)) == NULL) {
+		errno = ENOENT;
+		return -1;
+	}
+	for (i = 0; i < apol_vector_get_size(level->cats); i++) {
+		if ((cat = mls_cache_find(cache->cats, apol_vector_get_element(level->cats, i))) == NULL) {
+			return 1;
+		}
+		apol_bitset_set(&values->cat_bits, cat->value, 1);
+	}
+	return 0;
+}
+
 /********************* level *********************/
 
 apol_mls_level_t *apol_mls_level_create(void)
@@ -370,67 +624,51 @@ const apol_vector_t *apol_mls_level_get_cats(const apol_mls_level_t * level)
 
 int apol_mls_level_compare(const apol_policy_t * p, const apol_mls_level_t * l1, const apol_mls_level_t * l2)
 {
-	const qpol_level_t *level_datum1, *level_datum2;
-	int level1_sens, level2_sens, sens_cmp;
-	size_t l1_size, l2_size, i, j;
-	int m_list, ucat = 0;
-	apol_vector_t *cat_list_master, *cat_list_subset;
+	apol_mls_cache_t *cache;
+	mls_level_values_t v1, v2;
+	int sub12, sub21, retv1, retv2, retval = -1;
 	if (l2 == NULL) {
 		return APOL_MLS_EQ;
 	}
-	if ((l1 != NULL && l1->cats == NULL) || (l2->cats == NULL)) {
+	if (p == NULL || l1 == NULL || l1->cats == NULL || l2->cats == NULL) {
 		errno = EINVAL;
 		return -1;
 	}
-	if (qpol_policy_get_level_by_name(p->p, l1->sens, &level_datum1) < 0 ||
-	    qpol_policy_get_level_by_name(p->p, l2->sens, &level_datum2) < 0) {
+	if ((cache = policy_get_cache(p, (void **)&((apol_policy_t *) p)->mls_cache, mls_cache_create, mls_cache_free)) == NULL) {
 		return -1;
 	}
-
-	/* compare the level's senstitivity value */
-	if (qpol_level_get_value(p->p, level_datum1, (uint32_t *) (&level1_sens)) < 0 ||
-	    qpol_level_get_value(p->p, level_datum2, (uint32_t *) (&level2_sens)) < 0) {
-		return -1;
-	}
-	sens_cmp = level1_sens - level2_sens;
-
-	/* determine if all the categories in one level are in the other set */
-	l1_size = apol_vector_get_size(l1->cats);
-	l2_size = apol_vector_get_size(l2->cats);
-	if (l1_size < l2_size) {
-		m_list = 2;
-		cat_list_master = l2->cats;
-		cat_list_subset = l1->cats;
-	} else {
-		m_list = 1;
-		cat_list_master = l1->cats;
-		cat_list_subset = l2->cats;
-	}
-	for (i = 0; i < apol_vector_get_size(cat_list_subset); i++) {
-		char *cat = (char *)apol_vector_get_element(cat_list_subset, i);
-		if (apol_vector_get_index(cat_list_master, cat, apol_mls_cat_name_compare, (void *)p, &j) < 0) {
-			ucat = 1;
-			break;
+	retv1 = mls_level_resolve(p, cache, l1, &v1);
+	retv2 = mls_level_resolve(p, cache, l2, &v2);
+	if (retv1 != 0 || retv2 != 0) {
+		if (retv1 > 0 || retv2 > 0) {
+			errno = ENOENT;
 		}
+		goto cleanup;
 	}
 
-	if (!sens_cmp && !ucat && l1_size == l2_size)
-		return APOL_MLS_EQ;
-	if (sens_cmp >= 0 && m_list == 1 && !ucat)
-		return APOL_MLS_DOM;
-	if (sens_cmp <= 0 && (m_list == 2 || l1_size == l2_size) && !ucat)
-		return APOL_MLS_DOMBY;
-	return APOL_MLS_INCOMP;
+	/* determine if all the categories in one level are in the other set */
+	sub12 = apol_bitset_is_subset(&v1.cat_bits, &v2.cat_bits);
+	sub21 = apol_bitset_is_subset(&v2.cat_bits, &v1.cat_bits);
+
+	if (v1.sens->value == v2.sens->value && sub12 && sub21)
+		retval = APOL_MLS_EQ;
+	else if (v1.sens->value >= v2.sens->value && sub21)
+		retval = APOL_MLS_DOM;
+	else if (v1.sens->value <= v2.sens->value && sub12)
+		retval = APOL_MLS_DOMBY;
+	else
+		retval = APOL_MLS_INCOMP;
+      cleanup:
+	mls_level_values_release(&v1);
+	mls_level_values_release(&v2);
+	return retval;
 }
 
 int apol_mls_level_validate(const apol_policy_t * p, const apol_mls_level_t * level)
 {
-	const qpol_level_t *level_datum;
-	qpol_iterator_t *iter = NULL;
-	apol_vector_t *cat_vector;
-	int retval = -1;
-	size_t i, j;
-
+	apol_mls_cache_t *cache;
+	mls_level_values_t values;
+	int retval;
 	if (p == NULL || level == NULL || level->cats == NULL) {
 		ERR(p, "%s", strerror(EINVAL));
 		errno = EINVAL;
@@ -439,27 +677,17 @@ int apol_mls_level_validate(const apol_policy_t * p, const apol_mls_level_t * le
 	if (level->sens == NULL) {
 		return 0;
 	}
-	if (qpol_policy_get_level_by_name(p->p, level->sens, &level_datum) < 0 ||
-	    qpol_level_get_cat_iter(p->p, level_datum, &iter) < 0) {
+	if ((cache = policy_get_cache(p, (void **)&((apol_policy_t *) p)->mls_cache, mls_cache_create, mls_cache_free)) == NULL) {
 		return -1;
 	}
-	if ((cat_vector = apol_vector_create_from_iter(iter, NULL)) == NULL) {
-		ERR(p, "%s", strerror(errno));
-		goto cleanup;
+	/* a category not within the policy is not permitted by the
+	 * sensitivity, so the level is invalid rather than erroneous */
+	if ((retval = mls_level_resolve(p, cache, level, &values)) == 0) {
+		retval = apol_bitset_is_subset(&values.cat_bits, &values.sens->cats);
+	} else if (retval > 0) {
+		retval = 0;
 	}
-
-	for (i = 0; i < apol_vector_get_size(level->cats); i++) {
-		char *cat_name = (char *)apol_vector_get_element(level->cats, i);
-		if (apol_vector_get_index(cat_vector, cat_name, apol_mls_cat_vector_compare, (void *)p, &j) < 0) {
-			retval = 0;
-			goto cleanup;
-		}
-	}
-
-	retval = 1;
-      cleanup:
-	qpol_iterator_destroy(&iter);
-	apol_vector_destroy(&cat_vector);
+	mls_level_values_release(&values);
 	return retval;
 }
 
@@ -590,3 +590,501 @@ char *apol_nodecon_render(const apol_policy_t * p, const qpol_nodecon_t * nodeco
 	free(context_str);
 	return retval;
 }
+
+/******************** best match resolution ********************/
+
+#define NETCON_NONE ((size_t) -1)
+
+/**
+ * A run of ports, all of the same protocol, that resolve to the same
+ * portcon.  Ports are keyed by their protocol and number together
+ * (see netcon_port_key()) so that a single sorted array covers every
+ * protocol.
+ */
+typedef struct netcon_port_span
+{
+	uint32_t low, high;
+	const qpol_portcon_t *portcon;
+} netcon_port_span_t;
+
+typedef struct netcon_trie_node
+{
+	/** index of each child node, or 0 if none; the root is node
+	 *  0 and is never a child */
+	size_t child[2];
+	/** index of the first nodecon in policy order whose prefix
+	 *  ends here, or NETCON_NONE */
+	size_t nodecon;
+} netcon_trie_node_t;
+
+typedef struct netcon_trie
+{
+	netcon_trie_node_t *nodes;
+	size_t size, capacity;
+} netcon_trie_t;
+
+struct apol_netcon_index
+{
+	/** disjoint port spans, sorted by key */
+	netcon_port_span_t *spans;
+	size_t num_spans;
+	/** every nodecon, in policy order */
+	qpol_nodecon_t **nodecons;
+	size_t num_nodecons;
+	/** prefix tries of nodecons, for IPv4 and IPv6 respectively */
+	netcon_trie_t tries[2];
+	/** indices of nodecons whose netmasks are not contiguous
+	 *  prefixes; these must be tested one by one */
+	size_t *irregular;
+	size_t num_irregular;
+};
+
+static uint32_t netcon_port_key(uint8_t proto, uint32_t port)
+{
+	return ((uint32_t) proto << 17) | port;
+}
+
+static int netcon_key_cmp(const void *a, const void *b)
+{
+	uint32_t ka = *(const uint32_t *)a, kb = *(const uint32_t *)b;
+	return (ka < kb ? -1 : (ka > kb ? 1 : 0));
+}
+
+/**
+ * Find the index of the last of the sorted points that is not
+ * greater than key.
+ */
+static size_t netcon_point_find(const uint32_t * points, size_t num_points, uint32_t key)
+{
+	size_t lo = 0, hi = num_points;
+	while (hi - lo > 1) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (points[mid] <= key)
+			lo = mid;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/**
+ * Find the next segment at or after seg that has not yet been
+ * claimed, compressing the path taken.
+ */
+static size_t netcon_segment_next(size_t * next, size_t seg)
+{
+	size_t root = seg, tmp;
+	while (next[root] != root)
+		root = next[root];
+	while (next[seg] != root) {
+		tmp = next[seg];
+		next[seg] = root;
+		seg = tmp;
+	}
+	return root;
+}
+
+/**
+ * Flatten the policy's portcons into disjoint spans.  The endpoints
+ * of every portcon divide the key space into elementary segments;
+ * each segment belongs to the first portcon, in policy order, that
+ * covers it, as that is the one the kernel would choose.  Visiting
+ * portcons in order and skipping over already claimed segments makes
+ * this linear in the number of segments.
+ */
+static int netcon_index_build_ports(const apol_policy_t * p, apol_netcon_index_t * idx)
+{
+	qpol_iterator_t *iter = NULL;
+	size_t num_portcons, num_points = 0, num_segs, i, seg;
+	const qpol_portcon_t **portcons = NULL, **owner = NULL;
+	uint32_t *points = NULL, *lows = NULL, *highs = NULL;
+	size_t *next = NULL;
+	int error = 0;
+
+	if (qpol_policy_get_portcon_iter(p->p, &iter) < 0 || qpol_iterator_get_size(iter, &num_portcons) < 0) {
+		error = errno;
+		goto cleanup;
+	}
+	if (num_portcons == 0)
+		goto cleanup;
+	if ((portcons = calloc(num_portcons, sizeof(*portcons))) == NULL ||
+	    (lows = calloc(num_portcons, sizeof(*lows))) == NULL ||
+	    (highs = calloc(num_portcons, sizeof(*highs))) == NULL ||
+	    (points = calloc(2 * num_portcons, sizeof(*points))) == NULL) {
+		error = errno;
+		ERR(p, "%s", strerror(error));
+		goto cleanup;
+	}
+	for (i = 0; !qpol_iterator_end(iter); qpol_iterator_next(iter), i++) {
+		const qpol_portcon_t *portcon;
+		uint16_t low, high;
+		uint8_t proto;
+		if (qpol_iterator_get_item(iter, (void **)&portcon) < 0 ||
+		    qpol_portcon_get_low_port(p->p, portcon, &low) < 0 ||
+		    qpol_portcon_get_high_port(p->p, portcon, &high) < 0 ||
+		    qpol_portcon_get_protocol(p->p, portcon, &proto) < 0) {
+			error = errno;
+			goto cleanup;
+		}
+		portcons[i] = portcon;
+		lows[i] = netcon_port_key(proto, low);
+		highs[i] = netcon_port_key(proto, high);
+		if (low > high)
+			continue;      /* can never match */
+		points[num_points++] = lows[i];
+		points[num_points++] = highs[i] + 1;
+	}
+	num_portcons = i;
+	if (num_points == 0)
+		goto cleanup;
+
+	qsort(points, num_points, sizeof(*points), netcon_key_cmp);
+	for (i = 1, num_segs = 1; i < num_points; i++) {
+		if (points[i] != points[num_segs - 1])
+			points[num_segs++] = points[i];
+	}
+	/* segment s spans points[s] through points[s + 1] - 1; the
+	 * last point only closes the segment before it */
+	num_segs--;
+	if ((owner = calloc(num_segs, sizeof(*owner))) == NULL || (next = calloc(num_segs + 1, sizeof(*next))) == NULL) {
+		error = errno;
+		ERR(p, "%s", strerror(error));
+		goto cleanup;
+	}
+	for (seg = 0; seg <= num_segs; seg++)
+		next[seg] = seg;
+	for (i = 0; i < num_portcons; i++) {
+		if (lows[i] > highs[i])
+			continue;
+		seg = netcon_segment_next(next, netcon_point_find(points, num_segs, lows[i]));
+		while (seg < num_segs && points[seg] <= highs[i]) {
+			owner[seg] = portcons[i];
+			next[seg] = seg + 1;
+			seg = netcon_segment_next(next, seg + 1);
+		}
+	}
+
+	/* merge adjacent segments that have the same owner */
+	if ((idx->spans = calloc(num_segs, sizeof(*idx->spans))) == NULL) {
+		error = errno;
+		ERR(p, "%s", strerror(error));
+		goto cleanup;
+	}
+	for (seg = 0; seg < num_segs; seg++) {
+		netcon_port_span_t *prev = (idx->num_spans > 0 ? idx->spans + idx->num_spans - 1 : NULL);
+		if (owner[seg] == NULL)
+			continue;
+		if (prev != NULL && prev->portcon == owner[seg] && prev->high + 1 == points[seg]) {
+			prev->high = points[seg + 1] - 1;
+			continue;
+		}
+		idx->spans[idx->num_spans].low = points[seg];
+		idx->spans[idx->num_spans].high = points[seg + 1] - 1;
+		idx->spans[idx->num_spans].portcon = owner[seg];
+		idx->num_spans++;
+	}
+
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	free(portcons);
+	free(owner);
+	free(points);
+	free(lows);
+	free(highs);
+	free(next);
+	if (error != 0) {
+		errno = error;
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Get the value of bit i of an address or netmask, counting from the
+ * most significant bit of its first byte.  Addresses are stored in
+ * network byte order.
+ */
+static int netcon_addr_bit(const uint32_t * addr, size_t i)
+{
+	const unsigned char *bytes = (const unsigned char *)addr;
+	return (bytes[i / 8] >> (7 - i % 8)) & 1;
+}
+
+/**
+ * Determine the prefix length of a netmask.
+ *
+ * @return Number of leading one bits, or -1 if the netmask is not a
+ * contiguous prefix.
+ */
+static int netcon_mask_prefix_len(const uint32_t * mask, size_t num_bits)
+{
+	size_t i, len;
+	for (len = 0; len < num_bits && netcon_addr_bit(mask, len); len++) ;
+	for (i = len; i < num_bits; i++) {
+		if (netcon_addr_bit(mask, i))
+			return -1;
+	}
+	return (int)len;
+}
+
+/**
+ * Append a childless node to a trie.
+ *
+ * @return Index of the new node, or NETCON_NONE upon error.
+ */
+static size_t netcon_trie_add_node(netcon_trie_t * trie)
+{
+	if (trie->size >= trie->capacity) {
+		size_t new_capacity = (trie->capacity > 0 ? trie->capacity * 2 : 64);
+		netcon_trie_node_t *tmp = realloc(trie->nodes, new_capacity * sizeof(*tmp));
+		if (tmp == NULL)
+			return NETCON_NONE;
+		trie->nodes = tmp;
+		trie->capacity = new_capacity;
+	}
+	trie->nodes[trie->size].child[0] = trie->nodes[trie->size].child[1] = 0;
+	trie->nodes[trie->size].nodecon = NETCON_NONE;
+	return trie->size++;
+}
+
+static int netcon_trie_insert(netcon_trie_t * trie, const uint32_t * addr, size_t prefix_len, size_t nodecon)
+{
+	size_t node = 0, i, child;
+	if (trie->size == 0 && netcon_trie_add_node(trie) == NETCON_NONE)
+		return -1;
+	for (i = 0; i < prefix_len; i++) {
+		int bit = netcon_addr_bit(addr, i);
+		if ((child = trie->nodes[node].child[bit]) == 0) {
+			if ((child = netcon_trie_add_node(trie)) == NETCON_NONE)
+				return -1;
+			trie->nodes[node].child[bit] = child;
+		}
+		node = child;
+	}
+	/* nodecons are inserted in policy order, so the first wins */
+	if (trie->nodes[node].nodecon == NETCON_NONE)
+		trie->nodes[node].nodecon = nodecon;
+	return 0;
+}
+
+/**
+ * Find the first nodecon, in policy order, of any prefix within the
+ * trie that matches an address.
+ */
+static size_t netcon_trie_find(const netcon_trie_t * trie, const uint32_t * addr, size_t num_bits)
+{
+	size_t node = 0, i, best = NETCON_NONE;
+	if (trie->size == 0)
+		return NETCON_NONE;
+	for (i = 0;; i++) {
+		if (trie->nodes[node].nodecon < best)
+			best = trie->nodes[node].nodecon;
+		if (i == num_bits || (node = trie->nodes[node].child[netcon_addr_bit(addr, i)]) == 0)
+			break;
+	}
+	return best;
+}
+
+/**
+ * Determine if a nodecon matches an address, as the kernel does: the
+ * address under the nodecon's netmask must equal the nodecon's
+ * address.
+ */
+static int netcon_nodecon_matches(const apol_policy_t * p, const qpol_nodecon_t * nodecon, const uint32_t * addr, unsigned char proto)
+{
+	uint32_t *ocon_addr, *ocon_mask;
+	unsigned char proto_a, proto_m;
+	size_t i, num_words = (proto == QPOL_IPV4 ? 1 : 4);
+	if (qpol_nodecon_get_addr(p->p, nodecon, &ocon_addr, &proto_a) < 0 ||
+	    qpol_nodecon_get_mask(p->p, nodecon, &ocon_mask, &proto_m) < 0 || proto_a != proto) {
+		return 0;
+	}
+	for (i = 0; i < num_words; i++) {
+		if ((addr[i] & ocon_mask[i]) != ocon_addr[i])
+			return 0;
+	}
+	return 1;
+}
+
+static int netcon_index_build_nodes(const apol_policy_t * p, apol_netcon_index_t * idx)
+{
+	qpol_iterator_t *iter = NULL;
+	size_t num_nodecons, i, j;
+	int error = 0;
+
+	if (qpol_policy_get_nodecon_iter(p->p, &iter) < 0 || qpol_iterator_get_size(iter, &num_nodecons) < 0) {
+		error = errno;
+		goto cleanup;
+	}
+	if (num_nodecons == 0)
+		goto cleanup;
+	if ((idx->nodecons = calloc(num_nodecons, sizeof(*idx->nodecons))) == NULL ||
+	    (idx->irregular = calloc(num_nodecons, sizeof(*idx->irregular))) == NULL) {
+		error = errno;
+		ERR(p, "%s", strerror(error));
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		qpol_nodecon_t *nodecon;
+		uint32_t *addr, *mask;
+		unsigned char proto_a, proto_m;
+		size_t num_bits;
+		int prefix_len, unmasked = 0;
+		if (qpol_iterator_get_item(iter, (void **)&nodecon) < 0) {
+			error = errno;
+			goto cleanup;
+		}
+		/* the index takes ownership of the nodecon, just as
+		 * apol_nodecon_get_by_query() hands it to its vector */
+		i = idx->num_nodecons++;
+		idx->nodecons[i] = nodecon;
+		if (qpol_nodecon_get_addr(p->p, nodecon, &addr, &proto_a) < 0 ||
+		    qpol_nodecon_get_mask(p->p, nodecon, &mask, &proto_m) < 0) {
+			error = errno;
+			goto cleanup;
+		}
+		num_bits = (proto_a == QPOL_IPV4 ? 32 : 128);
+		for (j = 0; j < num_bits / 32; j++) {
+			if (addr[j] & ~mask[j])
+				unmasked = 1;
+		}
+		if (unmasked) {
+			continue;      /* can never match */
+		}
+		if ((prefix_len = netcon_mask_prefix_len(mask, num_bits)) < 0) {
+			idx->irregular[idx->num_irregular++] = i;
+			continue;
+		}
+		if (netcon_trie_insert(idx->tries + (proto_a == QPOL_IPV4 ? 0 : 1), addr, (size_t) prefix_len, i) < 0) {
+			error = errno;
+			ERR(p, "%s", strerror(error));
+			goto cleanup;
+		}
+	}
+
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	if (error != 0) {
+		errno = error;
+		return -1;
+	}
+	return 0;
+}
+
+void netcon_index_destroy(apol_netcon_index_t ** idx)
+{
+	size_t i;
+	if (idx == NULL || *idx == NULL)
+		return;
+	for (i = 0; i < (*idx)->num_nodecons; i++)
+		free((*idx)->nodecons[i]);
+	free((*idx)->nodecons);
+	free((*idx)->spans);
+	free((*idx)->tries[0].nodes);
+	free((*idx)->tries[1].nodes);
+	free((*idx)->irregular);
+	free(*idx);
+	*idx = NULL;
+}
+
+/**
+ * Build the index of a policy's portcons and nodecons.
+ *
+ * @return A newly allocated apol_netcon_index_t, or NULL upon error
+ * with errno set.
+ */
+static void *netcon_index_create(const apol_policy_t * p)
+{
+	apol_netcon_index_t *idx;
+	int error;
+	if ((idx = calloc(1, sizeof(*idx))) == NULL) {
+		error = errno;
+		ERR(p, "%s", strerror(error));
+		errno = error;
+		return NULL;
+	}
+	if (netcon_index_build_ports(p, idx) < 0 || netcon_index_build_nodes(p, idx) < 0) {
+		error = errno;
+		netcon_index_destroy(&idx);
+		errno = error;
+		return NULL;
+	}
+	return idx;
+}
+
+static void netcon_index_free(void *idx)
+{
+	apol_netcon_index_t *i = idx;
+	netcon_index_destroy(&i);
+}
+
+/**
+ * Get the policy's index of portcons and nodecons, building it upon
+ * first use.
+ */
+static apol_netcon_index_t *netcon_index_get(const apol_policy_t * p)
+{
+	apol_policy_t *policy = (apol_policy_t *) p;
+	return policy_get_cache(p, (void **)&policy->netcon_index, netcon_index_create, netcon_index_free);
+}
+
+int apol_portcon_resolve(const apol_policy_t * p, int proto, uint16_t port, const qpol_portcon_t ** portcon)
+{
+	apol_netcon_index_t *idx;
+	size_t lo, hi;
+	uint32_t key;
+	if (portcon != NULL)
+		*portcon = NULL;
+	if (p == NULL || portcon == NULL || proto < 0 || proto > UINT8_MAX) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	if ((idx = netcon_index_get(p)) == NULL)
+		return -1;
+	key = netcon_port_key((uint8_t) proto, port);
+	lo = 0;
+	hi = idx->num_spans;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (idx->spans[mid].high < key) {
+			lo = mid + 1;
+		} else if (idx->spans[mid].low > key) {
+			hi = mid;
+		} else {
+			*portcon = idx->spans[mid].portcon;
+			break;
+		}
+	}
+	return 0;
+}
+
+int apol_nodecon_resolve(const apol_policy_t * p, const uint32_t * addr, int proto, const qpol_nodecon_t ** nodecon)
+{
+	apol_netcon_index_t *idx;
+	size_t best, i;
+	if (nodecon != NULL)
+		*nodecon = NULL;
+	if (p == NULL || addr == NULL || nodecon == NULL || (proto != QPOL_IPV4 && proto != QPOL_IPV6)) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	if ((idx = netcon_index_get(p)) == NULL)
+		return -1;
+	if (proto == QPOL_IPV4)
+		best = netcon_trie_find(idx->tries + 0, addr, 32);
+	else
+		best = netcon_trie_find(idx->tries + 1, addr, 128);
+	/* irregular nodecons are kept in policy order, so only those
+	 * before the best found so far need be tested */
+	for (i = 0; i < idx->num_irregular && idx->irregular[i] < best; i++) {
+		if (netcon_nodecon_matches(p, idx->nodecons[idx->irregular[i]], addr, (unsigned char)proto)) {
+			best = idx->irregular[i];
+			break;
+		}
+	}
+	if (best != NETCON_NONE)
+		*nodecon = idx->nodecons[best];
+	return 0;
+}
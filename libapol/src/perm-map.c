@@ -28,6 +28,7 @@
 #include <apol/perm-map.h>
 
 #include <errno.h>
+#include <limits.h>
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
@@ -41,6 +42,9 @@ struct apol_permmap
 				        * were mapped from a file, false if
 				        * using default values */
 	apol_vector_t *classes;	       /* list of apol_permmap_class_t */
+	/** the elements of classes, indexed by class value - 1 */
+	struct apol_permmap_class **by_value;
+	size_t num_values;
 };
 
 /* There is one apol_permmap_class per object class. */
@@ -51,6 +55,14 @@ typedef struct apol_permmap_class
 	const qpol_class_t *c;
 	/** vector of apol_permmap_perm, an element for each permission bit */
 	apol_vector_t *perms;
+	/** the elements of perms, indexed by permission value - 1 */
+	struct apol_permmap_perm *by_bit[32];
+	/* The following access vector masks are computed from perms
+	 * by permmap_class_update_masks() whenever perms change, so
+	 * that an access vector's flows may be found by masking. */
+	uint32_t read_mask, write_mask, unmapped_mask;
+	/** permissions with each weight, indexed by weight */
+	uint32_t weight_masks[APOL_PERMMAP_MAX_WEIGHT + 1];
 } apol_permmap_class_t;
 
 /**
@@ -139,6 +151,61 @@ static apol_permmap_perm_t *apol_permmap_perm_create(const char *name, unsigned
 	return pp;
 }
 
+/**
+ * Recompute a permission map class's access vector masks from its
+ * permissions' maps and weights.
+ *
+ * @param pc Class to update.
+ */
+static void permmap_class_update_masks(apol_permmap_class_t * pc)
+{
+	size_t i;
+	pc->read_mask = pc->write_mask = pc->unmapped_mask = 0;
+	memset(pc->weight_masks, 0, sizeof(pc->weight_masks));
+	for (i = 0; i < 32; i++) {
+		const apol_permmap_perm_t *pp = pc->by_bit[i];
+		uint32_t bit = (uint32_t) 1 << i;
+		if (pp == NULL)
+			continue;
+		if (pp->map == APOL_PERMMAP_UNMAPPED)
+			pc->unmapped_mask |= bit;
+		if (pp->map & APOL_PERMMAP_READ)
+			pc->read_mask |= bit;
+		if (pp->map & APOL_PERMMAP_WRITE)
+			pc->write_mask |= bit;
+		if (pp->weight >= APOL_PERMMAP_MIN_WEIGHT && pp->weight <= APOL_PERMMAP_MAX_WEIGHT)
+			pc->weight_masks[pp->weight] |= bit;
+	}
+}
+
+/**
+ * Add a permission to a permission map class, indexing it by its
+ * value.
+ *
+ * @param p Policy containing the class.
+ * @param pc Class to which to add the permission.
+ * @param name Name of the permission.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+static int permmap_class_add_perm(const apol_policy_t * p, apol_permmap_class_t * pc, const char *name)
+{
+	apol_permmap_perm_t *pp;
+	uint32_t value;
+	if ((pp = apol_permmap_perm_create(name, 0, (char)APOL_PERMMAP_MIN_WEIGHT)) == NULL || apol_vector_append(pc->perms, pp) < 0) {
+		ERR(p, "%s", strerror(ENOMEM));
+		permmap_perm_free(pp);
+		return -1;
+	}
+	if (qpol_class_get_perm_value(p->p, pc->c, name, &value) < 0) {
+		return -1;
+	}
+	if (value >= 1 && value <= 32) {
+		pc->by_bit[value - 1] = pp;
+	}
+	return 0;
+}
+
 /**
  * Allocate and return a new permission map from a policy, and
  * allocates space for defined object classes.
@@ -167,7 +234,9 @@ static apol_permmap_t *apol_permmap_create_from_policy(const apol_policy_t * p)
 		goto cleanup;
 	}
 	t->mapped = 0;
-	if ((t->classes = apol_vector_create_with_capacity(num_obj_classes, permmap_class_free)) == NULL) {
+	t->num_values = num_obj_classes;
+	if ((t->classes = apol_vector_create_with_capacity(num_obj_classes, permmap_class_free)) == NULL ||
+	    (t->by_value = calloc(num_obj_classes, sizeof(*t->by_value))) == NULL) {
 		ERR(p, "%s", strerror(errno));
 		goto cleanup;
 	}
@@ -175,12 +244,13 @@ static apol_permmap_t *apol_permmap_create_from_policy(const apol_policy_t * p)
 		const qpol_class_t *c;
 		const qpol_common_t *common;
 		apol_permmap_class_t *pc = NULL;
-		apol_permmap_perm_t *pp = NULL;
 		size_t num_unique_perms, num_common_perms = 0;
+		uint32_t class_value;
 		char *name;
 		if (qpol_iterator_get_item(class_iter, (void **)&c) < 0 ||
 		    qpol_class_get_perm_iter(p->p, c, &perm_iter) < 0 ||
-		    qpol_iterator_get_size(perm_iter, &num_unique_perms) < 0 || qpol_class_get_common(p->p, c, &common) < 0) {
+		    qpol_iterator_get_size(perm_iter, &num_unique_perms) < 0 || qpol_class_get_common(p->p, c, &common) < 0 ||
+		    qpol_class_get_value(p->p, c, &class_value) < 0) {
 			goto cleanup;
 		}
 		if (common != NULL &&
@@ -195,6 +265,9 @@ static apol_permmap_t *apol_permmap_create_from_policy(const apol_policy_t * p)
 		}
 		pc->mapped = 0;
 		pc->c = c;
+		if (class_value >= 1 && class_value <= t->num_values) {
+			t->by_value[class_value - 1] = pc;
+		}
 		if ((pc->perms = apol_vector_create_with_capacity(num_unique_perms + num_common_perms, permmap_perm_free)) == NULL) {
 			ERR(p, "%s", strerror(ENOMEM));
 			goto cleanup;
@@ -202,30 +275,19 @@ static apol_permmap_t *apol_permmap_create_from_policy(const apol_policy_t * p)
 		/* initialize with all the class's unique permissions
 		 * from provided policy */
 		for (; !qpol_iterator_end(perm_iter); qpol_iterator_next(perm_iter)) {
-			if (qpol_iterator_get_item(perm_iter, (void **)&name) < 0) {
-				goto cleanup;
-			}
-			if ((pp = apol_permmap_perm_create(name, 0, (char)APOL_PERMMAP_MIN_WEIGHT)) == NULL ||
-			    apol_vector_append(pc->perms, pp) < 0) {
-				ERR(p, "%s", strerror(ENOMEM));
-				permmap_perm_free(pp);
+			if (qpol_iterator_get_item(perm_iter, (void **)&name) < 0 || permmap_class_add_perm(p, pc, name) < 0) {
 				goto cleanup;
 			}
 		}
 		/* next initialize with common permissions */
 		for (; common_iter != NULL && !qpol_iterator_end(common_iter); qpol_iterator_next(common_iter)) {
-			if (qpol_iterator_get_item(common_iter, (void **)&name) < 0) {
-				goto cleanup;
-			}
-			if ((pp = apol_permmap_perm_create(name, 0, (char)APOL_PERMMAP_MIN_WEIGHT)) == NULL ||
-			    apol_vector_append(pc->perms, pp) < 0) {
-				ERR(p, "%s", strerror(ENOMEM));
-				permmap_perm_free(pp);
+			if (qpol_iterator_get_item(common_iter, (void **)&name) < 0 || permmap_class_add_perm(p, pc, name) < 0) {
 				goto cleanup;
 			}
 		}
 		qpol_iterator_destroy(&perm_iter);
 		qpol_iterator_destroy(&common_iter);
+		permmap_class_update_masks(pc);
 	}
 
 	retval = 0;
@@ -244,13 +306,13 @@ void permmap_destroy(apol_permmap_t ** p)
 	if (p == NULL || *p == NULL)
 		return;
 	apol_vector_destroy(&(*p)->classes);
+	free((*p)->by_value);
 	free(*p);
 	*p = NULL;
 }
 
 /**
- * Searches through the permission map within a policy, returning the
- * record for a given object class.
+ * Look up the permission map within a policy for an object class.
  *
  * @param p Policy containing permission map.
  * @param target Target class name.
@@ -260,42 +322,33 @@ void permmap_destroy(apol_permmap_t ** p)
  */
 static apol_permmap_class_t *find_permmap_class(const apol_policy_t * p, const char *target)
 {
-	size_t i;
 	const qpol_class_t *target_class;
-	if (qpol_policy_get_class_by_name(p->p, target, &target_class) < 0) {
+	uint32_t value;
+	if (qpol_policy_get_class_by_name(p->p, target, &target_class) < 0 ||
+	    qpol_class_get_value(p->p, target_class, &value) < 0 || value < 1 || value > p->pmap->num_values) {
 		return NULL;
 	}
-	for (i = 0; i < apol_vector_get_size(p->pmap->classes); i++) {
-		apol_permmap_class_t *pc = apol_vector_get_element(p->pmap->classes, i);
-		if (pc->c == target_class) {
-			return pc;
-		}
-	}
-	return NULL;
+	return p->pmap->by_value[value - 1];
 }
 
 /**
- * Searches through the permission map's class, returning the record
- * for a given permission.
+ * Look up the record for a given permission within a permission
+ * map's class.
  *
- * @param p Policy to use, for error handling.
+ * @param p Policy containing the class.
  * @param pc Permission map class to search.
  * @param target Target class name.
  *
  * @return Pointer to the permission record within the class, or NULL
  * if not found or on error.
  */
-static apol_permmap_perm_t *find_permmap_perm(const apol_policy_t * p
-					      __attribute__ ((unused)), const apol_permmap_class_t * pc, const char *target)
+static apol_permmap_perm_t *find_permmap_perm(const apol_policy_t * p, const apol_permmap_class_t * pc, const char *target)
 {
-	size_t i;
-	for (i = 0; i < apol_vector_get_size(pc->perms); i++) {
-		apol_permmap_perm_t *pp = apol_vector_get_element(pc->perms, i);
-		if (strcmp(pp->name, target) == 0) {
-			return pp;
-		}
+	uint32_t value;
+	if (qpol_class_get_perm_value(p->p, pc->c, target, &value) < 0 || value < 1 || value > 32) {
+		return NULL;
 	}
-	return NULL;
+	return pc->by_bit[value - 1];
 }
 
 /**
@@ -451,6 +504,9 @@ static int parse_permmap_class(apol_policy_t * p, FILE * fp, size_t num_perms, a
 		WARN(p, "There were supposed to be %zu permissions, but only %zu were found.", num_perms, perms_read);
 		retval |= APOL_PERMMAP_RET_NOT_ENOUGH;
 	}
+	if (pc != NULL) {
+		permmap_class_update_masks(pc);
+	}
 	if (pc != NULL && !are_all_perms_mapped(p, pc)) {
 		retval |= APOL_PERMMAP_RET_UNMAPPED_PERM;
 	}
@@ -688,6 +744,7 @@ int apol_policy_set_permmap(apol_policy_t * p, const char *class_name, const cha
 		weight = APOL_PERMMAP_MIN_WEIGHT;
 	}
 	pp->weight = weight;
+	permmap_class_update_masks(pc);
 	return 0;
 }
 
@@ -695,3 +752,32 @@ int apol_permmap_set(apol_policy_t * p, const char *class_name, const char *perm
 {
 	return apol_policy_set_permmap(p, class_name, perm_name, map, weight);
 }
+
+int permmap_get_av_flows(const apol_policy_t * p, uint32_t class_value, uint32_t perm_mask, int max_len, int *read_len,
+			 int *write_len)
+{
+	const apol_permmap_class_t *pc;
+	int weight, len;
+	*read_len = *write_len = INT_MAX;
+	if (p->pmap == NULL || class_value < 1 || class_value > p->pmap->num_values ||
+	    (pc = p->pmap->by_value[class_value - 1]) == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	/* visit weights from the heaviest, which is the shortest
+	 * length, so that the first flow found in each direction is
+	 * the strongest */
+	for (weight = APOL_PERMMAP_MAX_WEIGHT; weight >= APOL_PERMMAP_MIN_WEIGHT; weight--) {
+		uint32_t m = perm_mask & pc->weight_masks[weight];
+		len = APOL_PERMMAP_MAX_WEIGHT - weight + 1;
+		if (len > max_len)
+			break;
+		if (m == 0)
+			continue;
+		if (*read_len == INT_MAX && (m & pc->read_mask))
+			*read_len = len;
+		if (*write_len == INT_MAX && (m & pc->write_mask))
+			*write_len = len;
+	}
+	return ((perm_mask & pc->unmapped_mask) ? 1 : 0);
+}
@@ -40,6 +40,7 @@ extern "C"
 #include <apol/util.h>
 #include <apol/vector.h>
 
+#include <pthread.h>
 #include <regex.h>
 #include <stdlib.h>
 #include <qpol/policy.h>
@@ -50,6 +51,21 @@ extern "C"
 /* forward declaration. the definition resides within domain-trans-analysis.c */
 	typedef struct apol_domain_trans_table apol_domain_trans_table_t;
 
+/* forward declaration. the definition resides within relabel-analysis.c */
+	typedef struct apol_relabel_table apol_relabel_table_t;
+
+/* forward declaration. the definition resides within netcon-query.c */
+	typedef struct apol_netcon_index apol_netcon_index_t;
+
+/* forward declaration. the definition resides within types-relation-analysis.c */
+	typedef struct apol_types_relation_signatures apol_types_relation_signatures_t;
+
+/* forward declaration. the definition resides within render.c */
+	typedef struct apol_render_cache apol_render_cache_t;
+
+/* forward declaration. the definition resides within mls_level.c */
+	typedef struct apol_mls_cache apol_mls_cache_t;
+
 /* declared in perm-map.c */
 	typedef struct apol_permmap apol_permmap_t;
 
@@ -63,6 +79,30 @@ extern "C"
 		struct apol_permmap *pmap;
 	/** for domain trans analysis; table built as needed */
 		struct apol_domain_trans_table *domain_trans_table;
+	/** for relabel analysis; index of relabel rules built as needed */
+		struct apol_relabel_table *relabel_table;
+	/** for resolving ports and addresses; index of portcons and
+	 *  nodecons built as needed */
+		struct apol_netcon_index *netcon_index;
+	/** for types relation analysis; access signature of every
+	 *  type built as needed */
+		struct apol_types_relation_signatures *type_signatures;
+	/** for rendering rules; permission names and rendered
+	 *  permission sets built as needed */
+		struct apol_render_cache *render_cache;
+	/** for comparing MLS levels; sensitivity and category values
+	 *  built as needed */
+		struct apol_mls_cache *mls_cache;
+	/** guards the above caches that are built through a const
+	 *  policy.  Each cache holds only data derived from the
+	 *  policy, so building one does not logically modify the
+	 *  policy, yet other threads may be querying the same policy
+	 *  meanwhile.  The lock is only held while a cache pointer is
+	 *  read or published (see policy_get_cache()), or while an
+	 *  already built cache is grown in memory; it is never held
+	 *  across a call to the policy's message callback, which may
+	 *  itself query the policy. */
+		pthread_mutex_t cache_lock;
 	};
 
 /** Every query allows the treatment of strings as regular expressions
@@ -517,12 +557,117 @@ extern "C"
  */
 	void permmap_destroy(apol_permmap_t ** p);
 
+/**
+ * Find the strongest read and write flows granted by an access vector
+ * of a class, according to a policy's permission map.  The length of
+ * a flow is the inverse of its permission's weight.
+ *
+ * @param p Policy containing a permission map.
+ * @param class_value Value of the access vector's object class.
+ * @param perm_mask Access vector, as returned by
+ * qpol_avrule_get_perm_mask().
+ * @param max_len Longest length of flow to consider.
+ * @param read_len Reference to the shortest length of a read flow, or
+ * INT_MAX if there is none.
+ * @param write_len Reference to the shortest length of a write flow,
+ * or INT_MAX if there is none.
+ *
+ * @return 0 on success, > 0 on success but if any permission within
+ * the access vector is unmapped, < 0 on error.
+ */
+	int permmap_get_av_flows(const apol_policy_t * p, uint32_t class_value, uint32_t perm_mask, int max_len, int *read_len,
+				 int *write_len);
+
+/**
+ *  Get one of a policy's caches, building it upon first use.  The
+ *  cache is built without holding the policy's cache lock, so the
+ *  build may report errors through the policy's callback.  Should
+ *  another thread publish the cache first, the one just built is
+ *  destroyed and the other returned.
+ *
+ *  @param p Policy whose cache to get.
+ *  @param cache Reference to the policy's member holding the cache.
+ *  @param build Function that builds the cache, reporting any error
+ *  and returning NULL with errno set upon failure.
+ *  @param destroy Function that destroys a cache that was built but
+ *  not needed.
+ *
+ *  @return The cache, or NULL upon error with errno set.
+ */
+	void *policy_get_cache(const apol_policy_t * p, void **cache, void *(*build) (const apol_policy_t * p),
+			       void (*destroy) (void *cache));
+
 /**
  *  Destroy the domain transition table freeing all memory used.
  *  @param table Reference pointer to the table to be destroyed.
  */
 	void domain_trans_table_destroy(apol_domain_trans_table_t ** table);
 
+/**
+ *  Destroy the relabel rule index freeing all memory used.
+ *  @param table Reference pointer to the index to be destroyed.
+ */
+	void relabel_table_destroy(apol_relabel_table_t ** table);
+
+/**
+ *  Destroy the portcon and nodecon index freeing all memory used.
+ *  @param idx Reference pointer to the index to be destroyed.
+ */
+	void netcon_index_destroy(apol_netcon_index_t ** idx);
+
+/**
+ *  Destroy the types' access signatures freeing all memory used.
+ *  @param sigs Reference pointer to the signatures to be destroyed.
+ */
+	void types_relation_signatures_destroy(apol_types_relation_signatures_t ** sigs);
+
+/**
+ *  Append a string to a growable render buffer, reallocating the
+ *  buffer if needed.  The buffer remains null-terminated.
+ *
+ *  @param buf Reference to the buffer; *buf may be NULL.
+ *  @param buf_sz Reference to the number of bytes allocated to *buf.
+ *  @param len Reference to the length of the string already within
+ *  the buffer; this is updated.
+ *  @param str String to append.
+ *
+ *  @return 0 on success, < 0 on error with errno set.  On error the
+ *  buffer is left allocated and unchanged.
+ */
+	int render_buf_append(char **buf, size_t * buf_sz, size_t * len, const char *str);
+
+/**
+ *  Append a rendered permission set to a growable render buffer, as
+ *  "perm " for a single permission or "{ perm1 perm2 } " for several.
+ *  Rendered sets are cached within the policy keyed by class value
+ *  and permission mask.
+ *
+ *  @param p Policy containing the class.
+ *  @param obj_class Class to which the permissions belong.
+ *  @param perm_mask Permission bits to render; bits that do not name
+ *  one of the class's permissions are ignored.
+ *  @param buf Reference to the buffer; *buf may be NULL.
+ *  @param buf_sz Reference to the number of bytes allocated to *buf.
+ *  @param len Reference to the length of the string already within
+ *  the buffer; this is updated.
+ *
+ *  @return 0 on success, < 0 on error with errno set.
+ */
+	int render_buf_append_perms(const apol_policy_t * p, const qpol_class_t * obj_class, uint32_t perm_mask, char **buf,
+				    size_t * buf_sz, size_t * len);
+
+/**
+ *  Destroy the rendering cache freeing all memory used.
+ *  @param cache Reference pointer to the cache to be destroyed.
+ */
+	void render_cache_destroy(apol_render_cache_t ** cache);
+
+/**
+ *  Destroy the MLS symbol cache freeing all memory used.
+ *  @param cache Reference pointer to the cache to be destroyed.
+ */
+	void mls_cache_destroy(apol_mls_cache_t ** cache);
+
 #ifdef	__cplusplus
 }
 #endif
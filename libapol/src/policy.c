@@ -87,6 +87,7 @@ apol_policy_t *apol_policy_create_from_policy_path(const apol_policy_path_t * pa
 		ERR(NULL, "%s", strerror(ENOMEM));
 		return NULL;	       /* errno set by calloc */
 	}
+	pthread_mutex_init(&policy->cache_lock, NULL);
 	if (msg_callback != NULL) {
 		policy->msg_callback = msg_callback;
 	} else {
@@ -141,11 +142,45 @@ void apol_policy_destroy(apol_policy_t ** policy)
 		qpol_policy_destroy(&((*policy)->p));
 		permmap_destroy(&(*policy)->pmap);
 		domain_trans_table_destroy(&(*policy)->domain_trans_table);
+		relabel_table_destroy(&(*policy)->relabel_table);
+		netcon_index_destroy(&(*policy)->netcon_index);
+		types_relation_signatures_destroy(&(*policy)->type_signatures);
+		render_cache_destroy(&(*policy)->render_cache);
+		mls_cache_destroy(&(*policy)->mls_cache);
+		pthread_mutex_destroy(&(*policy)->cache_lock);
 		free(*policy);
 		*policy = NULL;
 	}
 }
 
+void *policy_get_cache(const apol_policy_t * p, void **cache, void *(*build) (const apol_policy_t * p),
+		       void (*destroy) (void *cache))
+{
+	apol_policy_t *policy = (apol_policy_t *) p;
+	void *c, *built;
+
+	pthread_mutex_lock(&policy->cache_lock);
+	c = *cache;
+	pthread_mutex_unlock(&policy->cache_lock);
+	if (c != NULL) {
+		return c;
+	}
+	if ((built = build(p)) == NULL) {
+		return NULL;
+	}
+	pthread_mutex_lock(&policy->cache_lock);
+	if ((c = *cache) == NULL) {
+		c = *cache = built;
+		built = NULL;
+	}
+	pthread_mutex_unlock(&policy->cache_lock);
+	if (built != NULL) {
+		/* another thread built it first */
+		destroy(built);
+	}
+	return c;
+}
+
 int apol_policy_get_policy_type(const apol_policy_t * policy)
 {
 	if (policy == NULL) {
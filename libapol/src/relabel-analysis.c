@@ -25,6 +25,8 @@
 #include "policy-query-internal.h"
 
 #include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 /* defines for mode */
@@ -60,7 +62,112 @@ struct apol_relabel_result_pair
 #define PERM_RELABELTO "relabelto"
 #define PERM_RELABELFROM "relabelfrom"
 
-/******************** actual analysis rountines ********************/
+/******************** relabel rule index ********************/
+
+/**
+ * An allow rule granting relabelto and/or relabelfrom, with those
+ * properties the analysis needs already looked up.
+ */
+typedef struct relabel_entry
+{
+	const qpol_avrule_t *rule;
+	const qpol_type_t *source, *target;
+	unsigned char source_isattr;
+	/** one of APOL_RELABEL_DIR_TO, APOL_RELABEL_DIR_FROM, or
+	 *  APOL_RELABEL_DIR_BOTH */
+	int dir;
+	/** types to which the rule's target expands */
+	const qpol_type_t **targets;
+	size_t num_targets;
+} relabel_entry_t;
+
+/**
+ * Index key; an entry appears once for each type to which its source
+ * (or target) expands.
+ */
+typedef struct relabel_key
+{
+	uint32_t type_value;
+	uint32_t class_value;
+	size_t entry;
+} relabel_key_t;
+
+/**
+ * Every relabelto/relabelfrom allow rule within a policy, indexed by
+ * source type and class and by target type and class.  Keys are
+ * sorted by type value, class value, and then entry, so that the
+ * rules for a type (and optionally one class) are adjacent and found
+ * by binary search; entries are in rule order.
+ */
+struct apol_relabel_table
+{
+	/** one more than the highest type value within the policy */
+	size_t num_types;
+	relabel_entry_t *entries;
+	size_t num_entries;
+	relabel_key_t *by_source;
+	size_t num_source_keys;
+	relabel_key_t *by_target;
+	size_t num_target_keys;
+};
+
+void relabel_table_destroy(apol_relabel_table_t ** table)
+{
+	size_t i;
+	if (table == NULL || *table == NULL)
+		return;
+	for (i = 0; i < (*table)->num_entries; i++)
+		free((*table)->entries[i].targets);
+	free((*table)->entries);
+	free((*table)->by_source);
+	free((*table)->by_target);
+	free(*table);
+	*table = NULL;
+}
+
+static int relabel_key_comp(const void *a, const void *b)
+{
+	const relabel_key_t *ka = a;
+	const relabel_key_t *kb = b;
+	if (ka->type_value != kb->type_value)
+		return (ka->type_value < kb->type_value ? -1 : 1);
+	if (ka->class_value != kb->class_value)
+		return (ka->class_value < kb->class_value ? -1 : 1);
+	if (ka->entry != kb->entry)
+		return (ka->entry < kb->entry ? -1 : 1);
+	return 0;
+}
+
+/**
+ * Append a key for each type within a vector of qpol_type_t.
+ */
+static int relabel_table_add_keys(const apol_policy_t * p, relabel_key_t ** keys, size_t * num_keys, size_t * cap,
+				  const apol_vector_t * types, uint32_t class_value, size_t entry)
+{
+	size_t i;
+	for (i = 0; i < apol_vector_get_size(types); i++) {
+		const qpol_type_t *type = apol_vector_get_element(types, i);
+		uint32_t value;
+		if (qpol_type_get_value(p->p, type, &value) < 0) {
+			return -1;
+		}
+		if (*num_keys >= *cap) {
+			size_t new_cap = (*cap ? *cap * 2 : 64);
+			relabel_key_t *tmp = realloc(*keys, new_cap * sizeof(*tmp));
+			if (tmp == NULL) {
+				ERR(p, "%s", strerror(errno));
+				return -1;
+			}
+			*keys = tmp;
+			*cap = new_cap;
+		}
+		(*keys)[*num_keys].type_value = value;
+		(*keys)[*num_keys].class_value = class_value;
+		(*keys)[*num_keys].entry = entry;
+		(*num_keys)++;
+	}
+	return 0;
+}
 
 /**
  * Given an avrule, determine which relabel direction it has (to,
@@ -106,21 +213,236 @@ static int relabel_analysis_get_direction(const apol_policy_t * p, const qpol_av
 }
 
 /**
- * Given an apol_relabel_result_t node and a qpol_type_t, determine if
- * the two match.
+ * Build the relabel rule index for a policy, with a single query for
+ * all relabelto and relabelfrom allow rules.
  *
- * @param a Pointer to a apol_relabel_result_t.
- * @param b Pointer to a type.
- * @param data (Unused).
+ * @param p Policy from which to build the index.
  *
- * @return 0 if the result node's type matches the given type,
- * non-zero if not.
+ * @return A newly allocated apol_relabel_table_t, or NULL upon error
+ * with errno set.
  */
-static int relabel_result_comp_func(const void *a, const void *b, void *data __attribute__ ((unused)))
+static void *relabel_table_create(const apol_policy_t * p)
 {
-	apol_relabel_result_t *r = (apol_relabel_result_t *) a;
-	qpol_type_t *t = (qpol_type_t *) b;
-	return (int)((char *)r->type - (char *)t);
+	apol_relabel_table_t *table = NULL;
+	apol_avrule_query_t *a = NULL;
+	apol_vector_t *avrules_v = NULL, *source_v = NULL, *target_v = NULL;
+	qpol_iterator_t *iter = NULL;
+	size_t i, j, source_cap = 0, target_cap = 0;
+	uint32_t max_value = 0;
+	int retval = -1, error = 0;
+
+	if ((table = calloc(1, sizeof(*table))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	if (qpol_policy_get_type_iter(p->p, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		qpol_type_t *type;
+		uint32_t value;
+		if (qpol_iterator_get_item(iter, (void **)&type) < 0 || qpol_type_get_value(p->p, type, &value) < 0) {
+			goto cleanup;
+		}
+		if (value > max_value)
+			max_value = value;
+	}
+	table->num_types = (size_t) max_value + 1;
+
+	if ((a = apol_avrule_query_create()) == NULL) {
+		ERR(p, "%s", strerror(ENOMEM));
+		goto cleanup;
+	}
+	if (apol_avrule_query_set_rules(p, a, QPOL_RULE_ALLOW) < 0 ||
+	    apol_avrule_query_append_perm(p, a, PERM_RELABELTO) < 0 || apol_avrule_query_append_perm(p, a, PERM_RELABELFROM) < 0) {
+		goto cleanup;
+	}
+	if (apol_avrule_get_by_query(p, a, &avrules_v) < 0) {
+		goto cleanup;
+	}
+	if (apol_vector_get_size(avrules_v) > 0 &&
+	    (table->entries = calloc(apol_vector_get_size(avrules_v), sizeof(*table->entries))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+
+	for (i = 0; i < apol_vector_get_size(avrules_v); i++) {
+		relabel_entry_t *entry = table->entries + i;
+		const qpol_class_t *obj_class;
+		uint32_t class_value;
+		entry->rule = apol_vector_get_element(avrules_v, i);
+		table->num_entries++;
+		if (qpol_avrule_get_source_type(p->p, entry->rule, &entry->source) < 0 ||
+		    qpol_avrule_get_target_type(p->p, entry->rule, &entry->target) < 0 ||
+		    qpol_avrule_get_object_class(p->p, entry->rule, &obj_class) < 0 ||
+		    qpol_class_get_value(p->p, obj_class, &class_value) < 0 ||
+		    qpol_type_get_isattr(p->p, entry->source, &entry->source_isattr) < 0 ||
+		    (entry->dir = relabel_analysis_get_direction(p, entry->rule)) < 0) {
+			goto cleanup;
+		}
+		if ((source_v = apol_query_expand_type(p, entry->source)) == NULL ||
+		    (target_v = apol_query_expand_type(p, entry->target)) == NULL) {
+			goto cleanup;
+		}
+		if (apol_vector_get_size(target_v) > 0 &&
+		    (entry->targets = malloc(apol_vector_get_size(target_v) * sizeof(*entry->targets))) == NULL) {
+			ERR(p, "%s", strerror(errno));
+			goto cleanup;
+		}
+		for (j = 0; j < apol_vector_get_size(target_v); j++) {
+			entry->targets[j] = apol_vector_get_element(target_v, j);
+		}
+		entry->num_targets = apol_vector_get_size(target_v);
+		if (relabel_table_add_keys(p, &table->by_source, &table->num_source_keys, &source_cap, source_v, class_value, i) < 0 ||
+		    relabel_table_add_keys(p, &table->by_target, &table->num_target_keys, &target_cap, target_v, class_value, i) < 0) {
+			goto cleanup;
+		}
+		apol_vector_destroy(&source_v);
+		apol_vector_destroy(&target_v);
+	}
+	qsort(table->by_source, table->num_source_keys, sizeof(relabel_key_t), relabel_key_comp);
+	qsort(table->by_target, table->num_target_keys, sizeof(relabel_key_t), relabel_key_comp);
+
+	retval = 0;
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	apol_avrule_query_destroy(&a);
+	apol_vector_destroy(&avrules_v);
+	apol_vector_destroy(&source_v);
+	apol_vector_destroy(&target_v);
+	if (retval != 0) {
+		error = errno;
+		relabel_table_destroy(&table);
+		errno = error;
+	}
+	return table;
+}
+
+static void relabel_table_free(void *table)
+{
+	apol_relabel_table_t *t = table;
+	relabel_table_destroy(&t);
+}
+
+/**
+ * Find the keys for a type and class within a sorted key array.
+ *
+ * @param keys Sorted array of keys.
+ * @param num_keys Number of keys in the array.
+ * @param type_value Value of the type to find.
+ * @param class_value Value of the class to find, or 0 for any class.
+ * @param num Reference to the number of adjacent matching keys.
+ *
+ * @return The first matching key, or NULL if there are none.
+ */
+static const relabel_key_t *relabel_table_find(const relabel_key_t * keys, size_t num_keys, uint32_t type_value,
+					       uint32_t class_value, size_t * num)
+{
+	size_t lo = 0, hi = num_keys, end;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (keys[mid].type_value < type_value || (keys[mid].type_value == type_value && keys[mid].class_value < class_value))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	for (end = lo; end < num_keys && keys[end].type_value == type_value &&
+	     (class_value == 0 || keys[end].class_value == class_value); end++) ;
+	*num = end - lo;
+	return (*num ? keys + lo : NULL);
+}
+
+/******************** actual analysis rountines ********************/
+
+/**
+ * State for a single invocation of apol_relabel_analysis_do().
+ */
+typedef struct relabel_search
+{
+	const apol_policy_t *p;
+	apol_relabel_analysis_t *r;
+	const apol_relabel_table_t *table;
+	const qpol_type_t *start_type;
+	uint32_t start_value;
+	/** values of the types to which the start type expands */
+	uint32_t *start_values;
+	size_t num_start_values;
+	/** values of the classes to search, if restricted */
+	uint32_t *classes;
+	size_t num_classes;
+	/** vector of apol_relabel_result_t being built */
+	apol_vector_t *results;
+	/** the result node for each type value, or NULL */
+	apol_relabel_result_t **result_index;
+	/** for each entry, the last time it was collected, so that
+	 *  collected entries are unique */
+	size_t *entry_marks;
+	size_t mark;
+} relabel_search_t;
+
+/**
+ * A growable array of entry indices.
+ */
+typedef struct relabel_entry_list
+{
+	size_t *entries;
+	size_t size, cap;
+} relabel_entry_list_t;
+
+static int relabel_size_t_comp(const void *a, const void *b)
+{
+	size_t x = *(const size_t *)a, y = *(const size_t *)b;
+	return (x < y ? -1 : (x > y ? 1 : 0));
+}
+
+/**
+ * Collect the entries whose keys match any of a set of types, in any
+ * of the classes being searched (or in a single given class), into a
+ * list sorted by entry, thus in rule order.
+ *
+ * @param s Search state.
+ * @param keys Sorted array of keys to search.
+ * @param num_keys Number of keys in the array.
+ * @param values Type values to find.
+ * @param num_values Number of type values.
+ * @param class_value If non-zero then only find entries with this
+ * class, otherwise find entries of any of the searched classes.
+ * @param list List to fill; its previous contents are discarded.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+static int relabel_search_collect(relabel_search_t * s, const relabel_key_t * keys, size_t num_keys,
+				  const uint32_t * values, size_t num_values, uint32_t class_value, relabel_entry_list_t * list)
+{
+	size_t i, j, k, num;
+	list->size = 0;
+	s->mark++;
+	for (i = 0; i < num_values; i++) {
+		size_t num_classes = (class_value != 0 || s->classes == NULL ? 1 : s->num_classes);
+		for (j = 0; j < num_classes; j++) {
+			uint32_t c = (class_value != 0 || s->classes == NULL ? class_value : s->classes[j]);
+			const relabel_key_t *found = relabel_table_find(keys, num_keys, values[i], c, &num);
+			for (k = 0; k < num; k++) {
+				size_t entry = found[k].entry;
+				if (s->entry_marks[entry] == s->mark)
+					continue;
+				s->entry_marks[entry] = s->mark;
+				if (list->size >= list->cap) {
+					size_t new_cap = (list->cap ? list->cap * 2 : 16);
+					size_t *tmp = realloc(list->entries, new_cap * sizeof(*tmp));
+					if (tmp == NULL) {
+						ERR(s->p, "%s", strerror(errno));
+						return -1;
+					}
+					list->entries = tmp;
+					list->cap = new_cap;
+				}
+				list->entries[list->size++] = entry;
+			}
+		}
+	}
+	qsort(list->entries, list->size, sizeof(size_t), relabel_size_t_comp);
+	return 0;
 }
 
 static void relabel_result_free(void *result)
@@ -135,36 +457,38 @@ static void relabel_result_free(void *result)
 }
 
 /**
- * Given a qpol_type_t pointer, find and return the first
- * apol_relabel_result_t node within vector v that matches the type.
- * If there does not exist a node with that type, then allocate a new
- * one, append it to the vector, and return it.  The caller is
- * expected to eventually call apol_vector_destroy() upon the vector.
+ * Given a qpol_type_t pointer, find and return the
+ * apol_relabel_result_t node within the search's results that matches
+ * the type.  If there does not exist a node with that type, then
+ * allocate a new one, append it to the results, and return it.
  *
- * @param p Policy, used for error handling.
- * @param results A vector of apol_relabel_result_t nodes.
+ * @param s Search state, containing the results.
  * @param type Target type to find.
  *
  * @return An apol_relabel_result_t node from which to append results,
  * or NULL upon error.
  */
-static apol_relabel_result_t *relabel_result_get_node(const apol_policy_t * p, apol_vector_t * results, const qpol_type_t * type)
+static apol_relabel_result_t *relabel_result_get_node(relabel_search_t * s, const qpol_type_t * type)
 {
 	apol_relabel_result_t *result;
-	size_t i;
-	if (apol_vector_get_index(results, type, relabel_result_comp_func, NULL, &i) == 0) {
-		return (apol_relabel_result_t *) apol_vector_get_element(results, i);
+	uint32_t value;
+	if (qpol_type_get_value(s->p->p, type, &value) < 0) {
+		return NULL;
+	}
+	if (s->result_index[value] != NULL) {
+		return s->result_index[value];
 	}
 	/* make a new result node */
 	if ((result = calloc(1, sizeof(*result))) == NULL ||
 	    (result->to = apol_vector_create(free)) == NULL ||
 	    (result->from = apol_vector_create(free)) == NULL ||
-	    (result->both = apol_vector_create(free)) == NULL || apol_vector_append(results, result) < 0) {
-		ERR(p, "%s", strerror(errno));
+	    (result->both = apol_vector_create(free)) == NULL || apol_vector_append(s->results, result) < 0) {
+		ERR(s->p, "%s", strerror(errno));
 		relabel_result_free(result);
 		return NULL;
 	}
 	result->type = type;
+	s->result_index[value] = result;
 	return result;
 }
 
@@ -261,87 +585,91 @@ static int relabel_analysis_compare_type_to_vector(const apol_policy_t * p, cons
 }
 
 /**
- * Given two avrules, possbily append it to the object results vector
+ * Determine if a result type passes the analysis' filters: it is not
+ * the start type itself, and it matches the result regex if any.
+ *
+ * @param s Search state.
+ * @param target Result type to check.
+ *
+ * @return 1 if the type should be reported, 0 if not, < 0 on error.
+ */
+static int relabel_search_keep_target(relabel_search_t * s, const qpol_type_t * target)
+{
+	uint32_t value;
+	int compval;
+	if (qpol_type_get_value(s->p->p, target, &value) < 0) {
+		return -1;
+	}
+	if (value == s->start_value) {
+		return 0;	       /* don't care about relabels to itself */
+	}
+	compval = apol_compare_type(s->p, target, s->r->result, APOL_QUERY_REGEX, &s->r->result_regex);
+	if (compval < 0) {
+		return -1;
+	}
+	return compval;
+}
+
+/**
+ * Given two index entries, possbily append them to the object results
  * onto the appropriate rules vector.  The decision to actually append
  * or not is dependent upon the filtering options stored within the
  * relabel analysis object.
  *
- * @param p Policy containing avrule.
- * @param r Relabel analysis query object, containing filtering options.
- * @param ruleA First AV rule to add.
- * @param ruleB Other AV rule to add.
- * @param result Results vector being built.
+ * @param s Search state, containing the results being built.
+ * @param a First entry to add.
+ * @param b Other entry to add.
  *
  * @return 0 on success, < 0 on error.
  */
-static int append_avrules_to_object_vector(const apol_policy_t * p,
-					   apol_relabel_analysis_t * r,
-					   const qpol_avrule_t * ruleA, const qpol_avrule_t * ruleB, apol_vector_t * results)
+static int append_avrules_to_object_vector(relabel_search_t * s, const relabel_entry_t * a, const relabel_entry_t * b)
 {
-	const qpol_type_t *sourceA, *sourceB, *target, *intermed;
-	unsigned char isattrA, isattrB;
-	apol_vector_t *target_v = NULL, *result_list;
+	const qpol_type_t *target, *intermed;
+	apol_vector_t *result_list;
 	size_t i;
 	apol_relabel_result_t *result;
 	apol_relabel_result_pair_t *pair = NULL;
-	int retval = -1, compval, dirA, dirB;
-	if (qpol_avrule_get_target_type(p->p, ruleB, &target) < 0 || (target_v = apol_query_expand_type(p, target)) == NULL) {
-		goto cleanup;
-	}
-	if (qpol_avrule_get_source_type(p->p, ruleA, &sourceA) < 0 ||
-	    qpol_avrule_get_source_type(p->p, ruleB, &sourceB) < 0 ||
-	    qpol_type_get_isattr(p->p, sourceA, &isattrA) < 0 || qpol_type_get_isattr(p->p, sourceB, &isattrB) < 0) {
-		goto cleanup;
-	}
+	int retval = -1, compval;
 	/* If both rules use the same attribute, retain the attribute
 	 * to minimize the number of results and to indicate that all
 	 * types with that attribute have the permission to relabel. */
-	if ((isattrA && isattrB) || !isattrA) {
-		intermed = sourceA;
+	if ((a->source_isattr && b->source_isattr) || !a->source_isattr) {
+		intermed = a->source;
 	} else {
-		intermed = sourceB;
+		intermed = b->source;
 	}
-	for (i = 0; i < apol_vector_get_size(target_v); i++) {
-		target = (qpol_type_t *) apol_vector_get_element(target_v, i);
+	for (i = 0; i < b->num_targets; i++) {
+		target = b->targets[i];
 		/* exclude if B(t) does not match search criteria */
-		compval = apol_compare_type(p, target, r->type, 0, NULL);
-		if (compval < 0) {
-			goto cleanup;
-		} else if (compval == 1) {
-			continue;      /* don't care about relabels to itself */
-		}
-		compval = apol_compare_type(p, target, r->result, APOL_QUERY_REGEX, &r->result_regex);
+		compval = relabel_search_keep_target(s, target);
 		if (compval < 0) {
 			goto cleanup;
 		} else if (compval == 0) {
 			continue;
 		}
-		if ((result = relabel_result_get_node(p, results, target)) == NULL) {
-			goto cleanup;
-		}
-		if ((dirA = relabel_analysis_get_direction(p, ruleA)) < 0 || (dirB = relabel_analysis_get_direction(p, ruleB)) < 0) {
+		if ((result = relabel_result_get_node(s, target)) == NULL) {
 			goto cleanup;
 		}
 		if ((pair = calloc(1, sizeof(*pair))) == NULL) {
-			ERR(p, "%s", strerror(ENOMEM));
+			ERR(s->p, "%s", strerror(ENOMEM));
 			goto cleanup;
 		}
-		if (dirA == APOL_RELABEL_DIR_BOTH && dirB == APOL_RELABEL_DIR_BOTH) {
+		if (a->dir == APOL_RELABEL_DIR_BOTH && b->dir == APOL_RELABEL_DIR_BOTH) {
 			result_list = result->both;
-			pair->ruleA = ruleA;
-			pair->ruleB = ruleB;
-		} else if (dirA == APOL_RELABEL_DIR_FROM || dirB == APOL_RELABEL_DIR_TO) {
+			pair->ruleA = a->rule;
+			pair->ruleB = b->rule;
+		} else if (a->dir == APOL_RELABEL_DIR_FROM || b->dir == APOL_RELABEL_DIR_TO) {
 			result_list = result->to;
-			pair->ruleA = ruleA;
-			pair->ruleB = ruleB;
+			pair->ruleA = a->rule;
+			pair->ruleB = b->rule;
 		} else {
 			result_list = result->from;
-			pair->ruleA = ruleB;
-			pair->ruleB = ruleA;
+			pair->ruleA = b->rule;
+			pair->ruleB = a->rule;
 		}
 		pair->intermed = intermed;
 		if ((apol_vector_append(result_list, pair)) < 0) {
-			ERR(p, "%s", strerror(ENOMEM));
+			ERR(s->p, "%s", strerror(ENOMEM));
 			goto cleanup;
 		}
 		pair = NULL;
@@ -349,69 +677,89 @@ static int append_avrules_to_object_vector(const apol_policy_t * p,
 	retval = 0;
       cleanup:
 	free(pair);
-	apol_vector_destroy(&target_v);
 	return retval;
 }
 
 /**
- * Search through sets av and bv, finding pairs of avrules that
- * satisfy a relabel and adding those pairs to result vector v.
+ * Find allow rules A whose target is the start type and whose
+ * permission is <i>opposite</i> of the direction given (e.g.,
+ * relabelfrom if given DIR_TO), and whose source is a member of
+ * subjects_v.  For each, join through the index to rules B of the
+ * same class whose source shares a type with A's source, that grant
+ * the direction given, and whose target is not the start type; add
+ * each such pair to the results.  Only rules whose class is being
+ * searched are considered.
  *
- * @param p Policy containing avrules.
- * @param r Relabel analysis query object.
- * @param v Vector of apol_relabel_result_t nodes.
- * @param av Vector of qpol_avrule_t pointers.
- * @param bv Vector of qpol_avrule_t pointers.
- * @param subjects_v Vector of permitted qpol_type_t subjects, or NULL
- * to allow all types.
+ * @param s Search state.
+ * @param direction Relabelling direction to search.
+ * @param subjects_v If not NULL, then a vector of qpol_type_t pointers.
  *
- * @return 0 on success, < 0 upon error.
+ * @return 0 on success, < 0 on error.
  */
-static int relabel_analysis_matchup(const apol_policy_t * p,
-				    apol_relabel_analysis_t * r,
-				    apol_vector_t * av, apol_vector_t * bv, const apol_vector_t * subjects_v, apol_vector_t * v)
+static int relabel_analysis_object(relabel_search_t * s, unsigned int direction, const apol_vector_t * subjects_v)
 {
-	const qpol_avrule_t *a_avrule, *b_avrule;
-	const qpol_type_t *a_source, *a_target, *b_source, *b_target, *start_type;
-	const qpol_class_t *a_class, *b_class;
+	const apol_relabel_table_t *table = s->table;
+	relabel_entry_list_t a_list = { NULL, 0, 0 }, b_list = { NULL, 0, 0 };
+	uint32_t *source_values = NULL;
 	apol_vector_t *start_v = NULL;
 	size_t i, j;
-	int compval, retval = -1;
+	int a_dir, b_dir, compval, retval = -1;
+
+	if (direction == APOL_RELABEL_DIR_TO) {
+		a_dir = APOL_RELABEL_DIR_FROM;
+		b_dir = APOL_RELABEL_DIR_TO;
+	} else {
+		a_dir = APOL_RELABEL_DIR_TO;
+		b_dir = APOL_RELABEL_DIR_FROM;
+	}
 
-	if (apol_query_get_type(p, r->type, &start_type) < 0) {
+	if (relabel_search_collect(s, table->by_target, table->num_target_keys, s->start_values, s->num_start_values, 0, &a_list) <
+	    0) {
 		goto cleanup;
 	}
-	for (i = 0; i < apol_vector_get_size(av); i++) {
-		a_avrule = apol_vector_get_element(av, i);
-		if (qpol_avrule_get_source_type(p->p, a_avrule, &a_source) < 0 ||
-		    qpol_avrule_get_target_type(p->p, a_avrule, &a_target) < 0 ||
-		    qpol_avrule_get_object_class(p->p, a_avrule, &a_class) < 0) {
-			goto cleanup;
+	for (i = 0; i < a_list.size; i++) {
+		const relabel_entry_t *a = table->entries + a_list.entries[i];
+		const qpol_class_t *obj_class;
+		uint32_t class_value;
+		if (!(a->dir & a_dir)) {
+			continue;
 		}
-		compval = relabel_analysis_compare_type_to_vector(p, subjects_v, a_source);
+		compval = relabel_analysis_compare_type_to_vector(s->p, subjects_v, a->source);
 		if (compval < 0) {
 			goto cleanup;
 		} else if (compval == 0) {
 			continue;
 		}
-		if ((start_v = apol_query_expand_type(p, a_source)) == NULL) {
+		if (qpol_avrule_get_object_class(s->p->p, a->rule, &obj_class) < 0 ||
+		    qpol_class_get_value(s->p->p, obj_class, &class_value) < 0) {
 			goto cleanup;
 		}
-
-		/* check if there exists a B s.t. B(s) = source and
-		 * B(t) != r->type and B(o) = A(o) */
-		for (j = 0; j < apol_vector_get_size(bv); j++) {
-			b_avrule = apol_vector_get_element(bv, j);
-			if (qpol_avrule_get_source_type(p->p, b_avrule, &b_source) < 0 ||
-			    qpol_avrule_get_target_type(p->p, b_avrule, &b_target) < 0 ||
-			    qpol_avrule_get_object_class(p->p, b_avrule, &b_class) < 0) {
+		if ((start_v = apol_query_expand_type(s->p, a->source)) == NULL) {
+			goto cleanup;
+		}
+		free(source_values);
+		if ((source_values = calloc(apol_vector_get_size(start_v) + 1, sizeof(*source_values))) == NULL) {
+			ERR(s->p, "%s", strerror(errno));
+			goto cleanup;
+		}
+		for (j = 0; j < apol_vector_get_size(start_v); j++) {
+			if (qpol_type_get_value(s->p->p, apol_vector_get_element(start_v, j), source_values + j) < 0) {
 				goto cleanup;
 			}
-			if (relabel_analysis_compare_type_to_vector(p, start_v, b_source) != 1 ||
-			    b_target == start_type || a_class != b_class) {
+		}
+
+		/* find each B s.t. B(s) = source and B(t) != r->type
+		 * and B(o) = A(o) */
+		if (relabel_search_collect(s, table->by_source, table->num_source_keys, source_values,
+					   apol_vector_get_size(start_v), class_value, &b_list) < 0) {
+			goto cleanup;
+		}
+		for (j = 0; j < b_list.size; j++) {
+			const relabel_entry_t *b = table->entries + b_list.entries[j];
+			if (!(b->dir & b_dir) || b->target == s->start_type) {
 				continue;
 			}
-			if (append_avrules_to_object_vector(p, r, a_avrule, b_avrule, v) < 0) {
+			if (append_avrules_to_object_vector(s, a, b) < 0) {
 				goto cleanup;
 			}
 		}
@@ -421,139 +769,50 @@ static int relabel_analysis_matchup(const apol_policy_t * p,
 	retval = 0;
       cleanup:
 	apol_vector_destroy(&start_v);
+	free(source_values);
+	free(a_list.entries);
+	free(b_list.entries);
 	return retval;
 }
 
 /**
- * Get a list of allow rules, whose target type matches r->type and
- * whose permission is <i>opposite</i> of the direction given (e.g.,
- * relabelfrom if given DIR_TO).  Only include rules whose class is a
- * member of r->classes and whose source is a member of subjects_v.
- *
- * @param p Policy to which look up rules.
- * @param r Structure containing parameters for subject relabel analysis.
- * @param v Target vector to which append discovered rules.
- * @param direction Relabelling direction to search.
- * @param subjects_v If not NULL, then a vector of qpol_type_t pointers.
- *
- * @return 0 on success, < 0 on error.
- */
-static int relabel_analysis_object(const apol_policy_t * p,
-				   apol_relabel_analysis_t * r,
-				   apol_vector_t * v, unsigned int direction, const apol_vector_t * subjects_v)
-{
-	apol_avrule_query_t *a = NULL, *b = NULL;
-	apol_vector_t *a_rules = NULL, *b_rules = NULL;
-	char *perm1, *perm2;
-	size_t i;
-	int retval = -1;
-
-	if (direction == APOL_RELABEL_DIR_TO) {
-		perm1 = PERM_RELABELFROM;
-		perm2 = PERM_RELABELTO;
-	} else {
-		perm1 = PERM_RELABELTO;
-		perm2 = PERM_RELABELFROM;
-	}
-
-	if ((a = apol_avrule_query_create()) == NULL) {
-		ERR(p, "%s", strerror(ENOMEM));
-		goto cleanup;
-	}
-	if (apol_avrule_query_set_rules(p, a, QPOL_RULE_ALLOW) < 0 ||
-	    apol_avrule_query_set_target(p, a, r->type, 1) < 0 || apol_avrule_query_append_perm(p, a, perm1) < 0) {
-		goto cleanup;
-	}
-	for (i = 0; r->classes != NULL && i < apol_vector_get_size(r->classes); i++) {
-		if (apol_avrule_query_append_class(p, a, apol_vector_get_element(r->classes, i)) < 0) {
-			goto cleanup;
-		}
-	}
-	if (apol_avrule_get_by_query(p, a, &a_rules) < 0) {
-		goto cleanup;
-	}
-
-	if ((b = apol_avrule_query_create()) == NULL) {
-		ERR(p, "%s", strerror(ENOMEM));
-		goto cleanup;
-	}
-	if (apol_avrule_query_set_rules(p, b, QPOL_RULE_ALLOW) < 0 || apol_avrule_query_append_perm(p, b, perm2) < 0) {
-		goto cleanup;
-	}
-	for (i = 0; r->classes != NULL && i < apol_vector_get_size(r->classes); i++) {
-		if (apol_avrule_query_append_class(p, b, apol_vector_get_element(r->classes, i)) < 0) {
-			goto cleanup;
-		}
-	}
-	if (apol_avrule_get_by_query(p, b, &b_rules) < 0) {
-		goto cleanup;
-	}
-
-	if (relabel_analysis_matchup(p, r, a_rules, b_rules, subjects_v, v) < 0) {
-		goto cleanup;
-	}
-	retval = 0;
-      cleanup:
-	apol_avrule_query_destroy(&a);
-	apol_vector_destroy(&a_rules);
-	apol_avrule_query_destroy(&b);
-	apol_vector_destroy(&b_rules);
-	return retval;
-}
-
-/**
- * Given an avrule, possbily append it to the subject results vector
+ * Given an index entry, possbily append it to the subject results
  * onto the appropriate rules vector.  The decision to actually append
  * or not is dependent upon the filtering options stored within the
  * relabel analysis object.
  *
- * @param p Policy containing avrule.
- * @param r Relabel analysis query object, containing filtering options.
- * @param avrule AV rule to add.
- * @param result Results vector being built.
+ * @param s Search state, containing the results being built.
+ * @param entry Entry to add.
  *
  * @return 0 on success, < 0 on error.
  */
-static int append_avrule_to_subject_vector(const apol_policy_t * p,
-					   apol_relabel_analysis_t * r, const qpol_avrule_t * avrule, apol_vector_t * results)
+static int append_avrule_to_subject_vector(relabel_search_t * s, const relabel_entry_t * entry)
 {
 	const qpol_type_t *target;
-	apol_vector_t *target_v = NULL, *result_list = NULL;
+	apol_vector_t *result_list = NULL;
 	size_t i;
 	apol_relabel_result_t *result;
 	apol_relabel_result_pair_t *pair = NULL;
-	int retval = -1, dir, compval;
-	if ((dir = relabel_analysis_get_direction(p, avrule)) < 0) {
-		goto cleanup;
-	}
-	if (qpol_avrule_get_target_type(p->p, avrule, &target) < 0 || (target_v = apol_query_expand_type(p, target)) == NULL) {
-		goto cleanup;
-	}
-	for (i = 0; i < apol_vector_get_size(target_v); i++) {
-		target = (qpol_type_t *) apol_vector_get_element(target_v, i);
-		compval = apol_compare_type(p, target, r->type, 0, NULL);
-		if (compval < 0) {
-			goto cleanup;
-		} else if (compval == 1) {
-			continue;      /* don't care about relabels to itself */
-		}
-		compval = apol_compare_type(p, target, r->result, APOL_QUERY_REGEX, &r->result_regex);
+	int retval = -1, compval;
+	for (i = 0; i < entry->num_targets; i++) {
+		target = entry->targets[i];
+		compval = relabel_search_keep_target(s, target);
 		if (compval < 0) {
 			goto cleanup;
 		} else if (compval == 0) {
 			continue;
 		}
-		if ((result = relabel_result_get_node(p, results, target)) == NULL) {
+		if ((result = relabel_result_get_node(s, target)) == NULL) {
 			goto cleanup;
 		}
 		if ((pair = calloc(1, sizeof(*pair))) == NULL) {
-			ERR(p, "%s", strerror(ENOMEM));
+			ERR(s->p, "%s", strerror(ENOMEM));
 			goto cleanup;
 		}
-		pair->ruleA = avrule;
+		pair->ruleA = entry->rule;
 		pair->ruleB = NULL;
 		pair->intermed = NULL;
-		switch (dir) {
+		switch (entry->dir) {
 		case APOL_RELABEL_DIR_TO:
 			result_list = result->to;
 			break;
@@ -565,84 +824,148 @@ static int append_avrule_to_subject_vector(const apol_policy_t * p,
 			break;
 		}
 		if ((apol_vector_append(result_list, pair)) < 0) {
-			ERR(p, "%s", strerror(ENOMEM));
+			ERR(s->p, "%s", strerror(ENOMEM));
 			goto cleanup;
 		}
 		pair = NULL;
 	}
 	retval = 0;
       cleanup:
-	apol_vector_destroy(&target_v);
 	free(pair);
 	return retval;
 }
 
 /**
- * Get a list of all allow rules, whose source type matches r->type
- * and whose permission list has either "relabelto" or "relabelfrom".
- * Only include rules whose class is a member of r->classes.  Add
- * instances of those to the result vector.
+ * Find all allow rules whose source type matches the start type and
+ * whose permission list has either "relabelto" or "relabelfrom".
+ * Only include rules whose class is being searched.  Add instances of
+ * those to the results.
  *
- * @param p Policy to which look up rules.
- * @param r Structure containing parameters for subject relabel analysis.
- * @param v Target vector to which append discovered rules.
+ * @param s Search state.
  *
  * @return 0 on success, < 0 on error.
  */
-static int relabel_analysis_subject(const apol_policy_t * p, apol_relabel_analysis_t * r, apol_vector_t * v)
+static int relabel_analysis_subject(relabel_search_t * s)
 {
-	apol_avrule_query_t *a = NULL;
-	apol_vector_t *avrules_v = NULL;
-	const qpol_avrule_t *avrule;
+	const apol_relabel_table_t *table = s->table;
+	relabel_entry_list_t list = { NULL, 0, 0 };
 	size_t i;
 	int retval = -1;
 
-	if ((a = apol_avrule_query_create()) == NULL) {
-		ERR(p, "%s", strerror(ENOMEM));
-		goto cleanup;
-	}
-	if (apol_avrule_query_set_rules(p, a, QPOL_RULE_ALLOW) < 0 ||
-	    apol_avrule_query_set_source(p, a, r->type, 1) < 0 ||
-	    apol_avrule_query_append_perm(p, a, PERM_RELABELTO) < 0 || apol_avrule_query_append_perm(p, a, PERM_RELABELFROM) < 0) {
+	if (relabel_search_collect(s, table->by_source, table->num_source_keys, s->start_values, s->num_start_values, 0, &list) <
+	    0) {
 		goto cleanup;
 	}
-	for (i = 0; r->classes != NULL && i < apol_vector_get_size(r->classes); i++) {
-		if (apol_avrule_query_append_class(p, a, apol_vector_get_element(r->classes, i)) < 0) {
+	for (i = 0; i < list.size; i++) {
+		if (append_avrule_to_subject_vector(s, table->entries + list.entries[i]) < 0) {
 			goto cleanup;
 		}
 	}
-	if (apol_avrule_get_by_query(p, a, &avrules_v) < 0) {
+
+	retval = 0;
+      cleanup:
+	free(list.entries);
+	return retval;
+}
+
+/**
+ * Prepare the search state for an analysis: find the start type,
+ * build the policy's relabel index if needed, and look up the classes
+ * to search.  Class names not within the policy are ignored.
+ *
+ * @param s Search state to initialize.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+static int relabel_search_init(relabel_search_t * s)
+{
+	apol_policy_t *policy = (apol_policy_t *) s->p;
+	apol_vector_t *start_v = NULL;
+	qpol_iterator_t *iter = NULL;
+	size_t i;
+	int retval = -1;
+
+	if (apol_query_get_type(s->p, s->r->type, &s->start_type) < 0 ||
+	    qpol_type_get_value(s->p->p, s->start_type, &s->start_value) < 0) {
+		goto cleanup;
+	}
+	if ((s->table = policy_get_cache(s->p, (void **)&policy->relabel_table, relabel_table_create, relabel_table_free)) == NULL) {
 		goto cleanup;
 	}
 
-	for (i = 0; i < apol_vector_get_size(avrules_v); i++) {
-		avrule = (qpol_avrule_t *) apol_vector_get_element(avrules_v, i);
-		if (append_avrule_to_subject_vector(p, r, avrule, v) < 0) {
+	if ((start_v = apol_query_expand_type(s->p, s->start_type)) == NULL) {
+		goto cleanup;
+	}
+	if ((s->start_values = calloc(apol_vector_get_size(start_v) + 1, sizeof(*s->start_values))) == NULL ||
+	    (s->result_index = calloc(s->table->num_types, sizeof(*s->result_index))) == NULL ||
+	    (s->entry_marks = calloc(s->table->num_entries + 1, sizeof(*s->entry_marks))) == NULL) {
+		ERR(s->p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	for (i = 0; i < apol_vector_get_size(start_v); i++) {
+		if (qpol_type_get_value(s->p->p, apol_vector_get_element(start_v, i), s->start_values + i) < 0) {
+			goto cleanup;
+		}
+	}
+	s->num_start_values = apol_vector_get_size(start_v);
+
+	if (s->r->classes != NULL) {
+		if ((s->classes = calloc(apol_vector_get_size(s->r->classes) + 1, sizeof(*s->classes))) == NULL) {
+			ERR(s->p, "%s", strerror(errno));
 			goto cleanup;
 		}
+		if (qpol_policy_get_class_iter(s->p->p, &iter) < 0) {
+			goto cleanup;
+		}
+		for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+			const qpol_class_t *obj_class;
+			const char *class_name;
+			if (qpol_iterator_get_item(iter, (void **)&obj_class) < 0 ||
+			    qpol_class_get_name(s->p->p, obj_class, &class_name) < 0) {
+				goto cleanup;
+			}
+			if (apol_vector_get_index(s->r->classes, class_name, apol_str_strcmp, NULL, &i) < 0) {
+				continue;
+			}
+			if (qpol_class_get_value(s->p->p, obj_class, s->classes + s->num_classes) < 0) {
+				goto cleanup;
+			}
+			s->num_classes++;
+		}
 	}
 
 	retval = 0;
       cleanup:
-	apol_avrule_query_destroy(&a);
-	apol_vector_destroy(&avrules_v);
+	apol_vector_destroy(&start_v);
+	qpol_iterator_destroy(&iter);
 	return retval;
 }
 
+static void relabel_search_release(relabel_search_t * s)
+{
+	free(s->start_values);
+	free(s->classes);
+	free(s->result_index);
+	free(s->entry_marks);
+}
+
 /******************** public functions below ********************/
 
 int apol_relabel_analysis_do(const apol_policy_t * p, apol_relabel_analysis_t * r, apol_vector_t ** v)
 {
 	apol_vector_t *subjects_v = NULL;
-	const qpol_type_t *start_type;
+	relabel_search_t s;
 	int retval = -1;
 	*v = NULL;
+	memset(&s, 0, sizeof(s));
 
 	if (r->mode == 0 || r->type == NULL) {
 		ERR(p, "%s", strerror(EINVAL));
 		goto cleanup;
 	}
-	if (apol_query_get_type(p, r->type, &start_type) < 0) {
+	s.p = p;
+	s.r = r;
+	if (relabel_search_init(&s) < 0) {
 		goto cleanup;
 	}
 
@@ -650,20 +973,20 @@ int apol_relabel_analysis_do(const apol_policy_t * p, apol_relabel_analysis_t *
 		ERR(p, "%s", strerror(ENOMEM));
 		goto cleanup;
 	}
+	s.results = *v;
 
 	if (r->mode == APOL_RELABEL_MODE_OBJ) {
 		if (r->subjects != NULL && (subjects_v = relabel_analysis_get_type_vector(p, r->subjects)) == NULL) {
 			goto cleanup;
 		}
-		if ((r->direction & APOL_RELABEL_DIR_TO) && relabel_analysis_object(p, r, *v, APOL_RELABEL_DIR_TO, subjects_v) < 0) {
+		if ((r->direction & APOL_RELABEL_DIR_TO) && relabel_analysis_object(&s, APOL_RELABEL_DIR_TO, subjects_v) < 0) {
 			goto cleanup;
 		}
-		if ((r->direction & APOL_RELABEL_DIR_FROM) &&
-		    relabel_analysis_object(p, r, *v, APOL_RELABEL_DIR_FROM, subjects_v) < 0) {
+		if ((r->direction & APOL_RELABEL_DIR_FROM) && relabel_analysis_object(&s, APOL_RELABEL_DIR_FROM, subjects_v) < 0) {
 			goto cleanup;
 		}
 	} else {
-		if (relabel_analysis_subject(p, r, *v) < 0) {
+		if (relabel_analysis_subject(&s) < 0) {
 			goto cleanup;
 		}
 	}
@@ -671,6 +994,7 @@ int apol_relabel_analysis_do(const apol_policy_t * p, apol_relabel_analysis_t *
 	retval = 0;
       cleanup:
 	apol_vector_destroy(&subjects_v);
+	relabel_search_release(&s);
 	if (retval != 0) {
 		apol_vector_destroy(v);
 	}
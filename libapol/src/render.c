@@ -29,9 +29,11 @@
 #include <apol/context-query.h>
 #include <apol/policy.h>
 #include <apol/render.h>
+#include "policy-query-internal.h"
 
 #include <errno.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #ifndef WORDS_BIGENDIAN
@@ -156,3 +158,347 @@ char *apol_qpol_context_render(const apol_policy_t * p, const qpol_context_t * c
 	apol_context_destroy(&c);
 	return rendered_context;
 }
+
+/** Initial number of buckets for rendered permission sets; must be a
+ *  power of 2. */
+#define RENDER_CACHE_INIT_BUCKETS 256
+
+/** Smallest allocation made for a render buffer. */
+#define RENDER_BUF_MIN_SIZE 128
+
+typedef struct render_perm_set
+{
+	struct render_perm_set *next;
+	uint32_t class_value;
+	uint32_t perm_mask;
+	size_t len;
+	char str[];
+} render_perm_set_t;
+
+/**
+ * Hash a rendered permission set's key into a bucket index.
+ */
+static size_t render_perm_set_hash(uint32_t class_value, uint32_t perm_mask, size_t num_buckets)
+{
+	return ((size_t) class_value * 2654435761U ^ (size_t) perm_mask * 40503U) & (num_buckets - 1);
+}
+
+typedef struct render_class
+{
+	/** non-zero once perm_names has been filled */
+	int resolved;
+	/** mask of bits that name a permission */
+	uint32_t valid_mask;
+	/** permission names indexed by bit; these point into the
+	 *  policy itself */
+	const char *perm_names[32];
+} render_class_t;
+
+struct apol_render_cache
+{
+	/** permission names for each class, indexed by class value - 1 */
+	render_class_t *classes;
+	size_t num_classes;
+	/** chains of rendered permission sets */
+	render_perm_set_t **buckets;
+	size_t num_buckets;
+	size_t num_sets;
+};
+
+int render_buf_append(char **buf, size_t * buf_sz, size_t * len, const char *str)
+{
+	size_t str_len = strlen(str), new_sz;
+	char *t;
+	if (*buf == NULL) {
+		*buf_sz = 0;
+	}
+	if (*len + str_len + 1 > *buf_sz) {
+		new_sz = (*buf_sz < RENDER_BUF_MIN_SIZE ? RENDER_BUF_MIN_SIZE : *buf_sz);
+		while (new_sz < *len + str_len + 1) {
+			new_sz *= 2;
+		}
+		if ((t = realloc(*buf, new_sz)) == NULL) {
+			return -1;
+		}
+		*buf = t;
+		*buf_sz = new_sz;
+	}
+	memcpy(*buf + *len, str, str_len + 1);
+	*len += str_len;
+	return 0;
+}
+
+void render_cache_destroy(apol_render_cache_t ** cache)
+{
+	render_perm_set_t *set, *next;
+	size_t i;
+	if (cache != NULL && *cache != NULL) {
+		for (i = 0; i < (*cache)->num_buckets; i++) {
+			for (set = (*cache)->buckets[i]; set != NULL; set = next) {
+				next = set->next;
+				free(set);
+			}
+		}
+		free((*cache)->buckets);
+		free((*cache)->classes);
+		free(*cache);
+		*cache = NULL;
+	}
+}
+
+/**
+ * Create an empty rendering cache for a policy.
+ *
+ * @param p Policy whose cache to create.
+ *
+ * @return A newly allocated apol_render_cache_t, or NULL on error
+ * with errno set.
+ */
+static void *render_cache_create(const apol_policy_t * p)
+{
+	apol_render_cache_t *cache;
+	qpol_iterator_t *iter = NULL;
+	size_t num_classes;
+	int error;
+	if (qpol_policy_get_class_iter(p->p, &iter) < 0 || qpol_iterator_get_size(iter, &num_classes) < 0) {
+		error = errno;
+		qpol_iterator_destroy(&iter);
+		errno = error;
+		return NULL;
+	}
+	qpol_iterator_destroy(&iter);
+	if ((cache = calloc(1, sizeof(*cache))) == NULL ||
+	    (cache->classes = calloc(num_classes, sizeof(*cache->classes))) == NULL ||
+	    (cache->buckets = calloc(RENDER_CACHE_INIT_BUCKETS, sizeof(*cache->buckets))) == NULL) {
+		error = errno;
+		ERR(p, "%s", strerror(error));
+		render_cache_destroy(&cache);
+		errno = error;
+		return NULL;
+	}
+	cache->num_classes = num_classes;
+	cache->num_buckets = RENDER_CACHE_INIT_BUCKETS;
+	return cache;
+}
+
+static void render_cache_free(void *cache)
+{
+	apol_render_cache_t *c = cache;
+	render_cache_destroy(&c);
+}
+
+/**
+ * Record the name of each permission within an iterator by its bit.
+ */
+static int render_class_add_perms(const apol_policy_t * p, const qpol_class_t * obj_class, render_class_t * rc,
+				  qpol_iterator_t * iter)
+{
+	const char *name;
+	uint32_t value;
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		if (qpol_iterator_get_item(iter, (void **)&name) < 0 ||
+		    qpol_class_get_perm_value(p->p, obj_class, name, &value) < 0) {
+			return -1;
+		}
+		if (value >= 1 && value <= 32) {
+			rc->perm_names[value - 1] = name;
+			rc->valid_mask |= (uint32_t) 1 << (value - 1);
+		}
+	}
+	return 0;
+}
+
+/**
+ * Get the cached permission names for a class, looking them up on
+ * first use.  The lookup is done without holding the policy's cache
+ * lock; the names are then copied into the cache under the lock.
+ * Once resolved, a class's entry never changes.
+ *
+ * @return The class's names, or NULL on error.
+ */
+static const render_class_t *render_class_get(const apol_policy_t * p, apol_render_cache_t * cache,
+					      const qpol_class_t * obj_class, uint32_t class_value)
+{
+	apol_policy_t *policy = (apol_policy_t *) p;
+	render_class_t *rc, names;
+	const qpol_common_t *common = NULL;
+	qpol_iterator_t *iter = NULL;
+	int resolved, retval = -1;
+	if (class_value < 1 || class_value > cache->num_classes) {
+		ERR(p, "%s", strerror(ERANGE));
+		errno = ERANGE;
+		return NULL;
+	}
+	rc = cache->classes + class_value - 1;
+	pthread_mutex_lock(&policy->cache_lock);
+	resolved = rc->resolved;
+	pthread_mutex_unlock(&policy->cache_lock);
+	if (resolved) {
+		return rc;
+	}
+	memset(&names, 0, sizeof(names));
+	if (qpol_class_get_perm_iter(p->p, obj_class, &iter) < 0 || render_class_add_perms(p, obj_class, &names, iter) < 0) {
+		goto cleanup;
+	}
+	qpol_iterator_destroy(&iter);
+	if (qpol_class_get_common(p->p, obj_class, &common) < 0) {
+		goto cleanup;
+	}
+	if (common != NULL &&
+	    (qpol_common_get_perm_iter(p->p, common, &iter) < 0 || render_class_add_perms(p, obj_class, &names, iter) < 0)) {
+		goto cleanup;
+	}
+	names.resolved = 1;
+	pthread_mutex_lock(&policy->cache_lock);
+	if (!rc->resolved) {
+		*rc = names;
+	}
+	pthread_mutex_unlock(&policy->cache_lock);
+	retval = 0;
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	return (retval == 0 ? rc : NULL);
+}
+
+/**
+ * Find a rendered permission set within the cache.  The caller must
+ * hold the policy's cache lock.
+ */
+static const render_perm_set_t *render_perm_set_find(const apol_render_cache_t * cache, uint32_t class_value,
+						     uint32_t perm_mask)
+{
+	const render_perm_set_t *set;
+	size_t h = render_perm_set_hash(class_value, perm_mask, cache->num_buckets);
+	for (set = cache->buckets[h]; set != NULL; set = set->next) {
+		if (set->class_value == class_value && set->perm_mask == perm_mask) {
+			break;
+		}
+	}
+	return set;
+}
+
+/**
+ * Double the number of buckets for rendered permission sets.  Failing
+ * to allocate new buckets is not an error; lookups merely get slower.
+ * The caller must hold the policy's cache lock.
+ */
+static void render_cache_grow(apol_render_cache_t * cache)
+{
+	render_perm_set_t **buckets, *set, *next;
+	size_t i, num_buckets = cache->num_buckets * 2, h;
+	if ((buckets = calloc(num_buckets, sizeof(*buckets))) == NULL) {
+		return;
+	}
+	for (i = 0; i < cache->num_buckets; i++) {
+		for (set = cache->buckets[i]; set != NULL; set = next) {
+			next = set->next;
+			h = render_perm_set_hash(set->class_value, set->perm_mask, num_buckets);
+			set->next = buckets[h];
+			buckets[h] = set;
+		}
+	}
+	free(cache->buckets);
+	cache->buckets = buckets;
+	cache->num_buckets = num_buckets;
+}
+
+/**
+ * Render a permission set, as "perm " or "{ perm1 perm2 } ".
+ *
+ * @return A newly allocated set, or NULL on error.
+ */
+static render_perm_set_t *render_perm_set_create(const apol_policy_t * p, const render_class_t * rc, uint32_t class_value,
+						 uint32_t perm_mask)
+{
+	render_perm_set_t *set = NULL;
+	char *str = NULL;
+	size_t str_sz = 0, str_len = 0, num_perms = 0;
+	uint32_t i;
+	int error;
+
+	for (i = 0; i < 32; i++) {
+		if (perm_mask & ((uint32_t) 1 << i)) {
+			num_perms++;
+		}
+	}
+	if (num_perms > 1 && render_buf_append(&str, &str_sz, &str_len, "{ ") < 0) {
+		goto err;
+	}
+	for (i = 0; i < 32; i++) {
+		if ((perm_mask & ((uint32_t) 1 << i)) &&
+		    (render_buf_append(&str, &str_sz, &str_len, rc->perm_names[i]) < 0 ||
+		     render_buf_append(&str, &str_sz, &str_len, " ") < 0)) {
+			goto err;
+		}
+	}
+	if (num_perms > 1 && render_buf_append(&str, &str_sz, &str_len, "} ") < 0) {
+		goto err;
+	}
+	if ((set = malloc(sizeof(*set) + str_len + 1)) == NULL) {
+		goto err;
+	}
+	set->class_value = class_value;
+	set->perm_mask = perm_mask;
+	set->len = str_len;
+	memcpy(set->str, (str != NULL ? str : ""), str_len + 1);
+	free(str);
+	return set;
+      err:
+	error = errno;
+	ERR(p, "%s", strerror(error));
+	free(str);
+	errno = error;
+	return NULL;
+}
+
+int render_buf_append_perms(const apol_policy_t * p, const qpol_class_t * obj_class, uint32_t perm_mask, char **buf,
+			    size_t * buf_sz, size_t * len)
+{
+	apol_policy_t *policy = (apol_policy_t *) p;
+	apol_render_cache_t *cache;
+	const render_class_t *rc;
+	const render_perm_set_t *set;
+	render_perm_set_t *new_set;
+	size_t h;
+	uint32_t class_value;
+	int error;
+
+	if (qpol_class_get_value(p->p, obj_class, &class_value) < 0 ||
+	    (cache = policy_get_cache(p, (void **)&policy->render_cache, render_cache_create, render_cache_free)) == NULL ||
+	    (rc = render_class_get(p, cache, obj_class, class_value)) == NULL) {
+		return -1;
+	}
+	perm_mask &= rc->valid_mask;
+	pthread_mutex_lock(&policy->cache_lock);
+	set = render_perm_set_find(cache, class_value, perm_mask);
+	pthread_mutex_unlock(&policy->cache_lock);
+	if (set == NULL) {
+		/* render the set without the lock, then add it unless
+		 * another thread got there first */
+		if ((new_set = render_perm_set_create(p, rc, class_value, perm_mask)) == NULL) {
+			return -1;
+		}
+		pthread_mutex_lock(&policy->cache_lock);
+		if ((set = render_perm_set_find(cache, class_value, perm_mask)) == NULL) {
+			h = render_perm_set_hash(class_value, perm_mask, cache->num_buckets);
+			new_set->next = cache->buckets[h];
+			cache->buckets[h] = new_set;
+			set = new_set;
+			new_set = NULL;
+			if (++cache->num_sets > cache->num_buckets) {
+				render_cache_grow(cache);
+			}
+		}
+		pthread_mutex_unlock(&policy->cache_lock);
+		free(new_set);
+	}
+	/* sets are never freed before the policy, so the set may be
+	 * read without the lock */
+	if (render_buf_append(buf, buf_sz, len, set->str) < 0) {
+		error = errno;
+		ERR(p, "%s", strerror(error));
+		errno = error;
+		return -1;
+	}
+	return 0;
+}
@@ -651,109 +651,67 @@ apol_vector_t *apol_terule_list_to_syn_terules(const apol_policy_t * p, const ap
 	return v;
 }
 
-char *apol_terule_render(const apol_policy_t * policy, const qpol_terule_t * rule)
+int apol_terule_render_buf(const apol_policy_t * policy, const qpol_terule_t * rule, char **buf, size_t * buf_sz)
 {
-	char *tmp = NULL;
-	const char *tmp_name = NULL;
-	const char *rule_type_str;
+	const char *rule_type_str, *source_name = NULL, *target_name = NULL, *class_name = NULL, *default_name = NULL;
 	int error = 0;
-	size_t tmp_sz = 0;
+	size_t len = 0;
 	uint32_t rule_type = 0;
 	const qpol_type_t *type = NULL;
 	const qpol_class_t *obj_class = NULL;
 
-	if (!policy || !rule) {
+	if (!policy || !rule || !buf || !buf_sz) {
 		ERR(policy, "%s", strerror(EINVAL));
 		errno = EINVAL;
-		return NULL;
+		return -1;
 	}
 
 	/* rule type */
 	if (qpol_terule_get_rule_type(policy->p, rule, &rule_type)) {
-		return NULL;
+		return -1;
 	}
 	if (!(rule_type &= (QPOL_RULE_TYPE_TRANS | QPOL_RULE_TYPE_CHANGE | QPOL_RULE_TYPE_MEMBER))) {
 		ERR(policy, "%s", "Invalid TE rule type");
 		errno = EINVAL;
-		return NULL;
+		return -1;
 	}
 	if (!(rule_type_str = apol_rule_type_to_str(rule_type))) {
 		ERR(policy, "%s", "Could not get TE rule type's string");
 		errno = EINVAL;
-		return NULL;
-	}
-	if (apol_str_appendf(&tmp, &tmp_sz, "%s ", rule_type_str)) {
-		error = errno;
-		ERR(policy, "%s", strerror(error));
-		goto err;
-	}
-
-	/* source type */
-	if (qpol_terule_get_source_type(policy->p, rule, &type)) {
-		error = errno;
-		goto err;
-	}
-	if (qpol_type_get_name(policy->p, type, &tmp_name)) {
-		error = errno;
-		goto err;
-	}
-	if (apol_str_appendf(&tmp, &tmp_sz, "%s ", tmp_name)) {
-		error = errno;
-		ERR(policy, "%s", strerror(error));
-		goto err;
+		return -1;
 	}
 
-	/* target type */
-	if (qpol_terule_get_target_type(policy->p, rule, &type)) {
-		error = errno;
-		goto err;
-	}
-	if (qpol_type_get_name(policy->p, type, &tmp_name)) {
-		error = errno;
-		goto err;
-	}
-	if (apol_str_appendf(&tmp, &tmp_sz, "%s : ", tmp_name)) {
-		error = errno;
-		ERR(policy, "%s", strerror(error));
-		goto err;
+	if (qpol_terule_get_source_type(policy->p, rule, &type) || qpol_type_get_name(policy->p, type, &source_name) ||
+	    qpol_terule_get_target_type(policy->p, rule, &type) || qpol_type_get_name(policy->p, type, &target_name) ||
+	    qpol_terule_get_object_class(policy->p, rule, &obj_class) || qpol_class_get_name(policy->p, obj_class, &class_name) ||
+	    qpol_terule_get_default_type(policy->p, rule, &type) || qpol_type_get_name(policy->p, type, &default_name)) {
+		return -1;
 	}
 
-	/* object class */
-	if (qpol_terule_get_object_class(policy->p, rule, &obj_class)) {
-		error = errno;
-		goto err;
-	}
-	if (qpol_class_get_name(policy->p, obj_class, &tmp_name)) {
-		error = errno;
-		goto err;
-	}
-	if (apol_str_appendf(&tmp, &tmp_sz, "%s ", tmp_name)) {
+	if (render_buf_append(buf, buf_sz, &len, rule_type_str) || render_buf_append(buf, buf_sz, &len, " ") ||
+	    render_buf_append(buf, buf_sz, &len, source_name) || render_buf_append(buf, buf_sz, &len, " ") ||
+	    render_buf_append(buf, buf_sz, &len, target_name) || render_buf_append(buf, buf_sz, &len, " : ") ||
+	    render_buf_append(buf, buf_sz, &len, class_name) || render_buf_append(buf, buf_sz, &len, " ") ||
+	    render_buf_append(buf, buf_sz, &len, default_name) || render_buf_append(buf, buf_sz, &len, ";")) {
 		error = errno;
 		ERR(policy, "%s", strerror(error));
-		goto err;
+		errno = error;
+		return -1;
 	}
+	return 0;
+}
 
-	/* default type */
-	if (qpol_terule_get_default_type(policy->p, rule, &type)) {
-		error = errno;
-		goto err;
-	}
-	if (qpol_type_get_name(policy->p, type, &tmp_name)) {
-		error = errno;
-		goto err;
-	}
-	if (apol_str_appendf(&tmp, &tmp_sz, "%s;", tmp_name)) {
-		error = errno;
-		ERR(policy, "%s", strerror(error));
-		goto err;
+char *apol_terule_render(const apol_policy_t * policy, const qpol_terule_t * rule)
+{
+	char *tmp = NULL;
+	size_t tmp_sz = 0;
+	if (apol_terule_render_buf(policy, rule, &tmp, &tmp_sz) < 0) {
+		int error = errno;
+		free(tmp);
+		errno = error;
+		return NULL;
 	}
-
 	return tmp;
-
-      err:
-	free(tmp);
-	errno = error;
-	return NULL;
 }
 
 char *apol_syn_terule_render(const apol_policy_t * policy, const qpol_syn_terule_t * rule)
@@ -25,8 +25,10 @@
 #include "policy-query-internal.h"
 #include "domain-trans-analysis-internal.h"
 #include "infoflow-analysis-internal.h"
+#include "bitset.h"
 
 #include <errno.h>
+#include <stdint.h>
 #include <string.h>
 
 struct apol_types_relation_analysis
@@ -918,6 +920,446 @@ static int apol_types_relation_domain(apol_policy_t * p,
 	return retval;
 }
 
+/******************** access signatures ********************/
+
+/**
+ * The access signature of every type: the set of (target type,
+ * object class) pairs that the type is allowed some access to, with
+ * attributes expanded on both sides.  A pair is keyed as target type
+ * value * num_classes + class value - 1.  Signatures are held as
+ * sorted arrays of keys, together with the inverse mapping from each
+ * key to the types whose signatures contain it, so that the types
+ * sharing keys with a given type may be found without comparing it to
+ * every other type.
+ */
+struct apol_types_relation_signatures
+{
+	/** types indexed by value, NULL for attributes and gaps */
+	const qpol_type_t **types;
+	/** one more than the largest type value */
+	size_t num_types;
+	size_t num_classes;
+	/** the signature of type value v is keys[offsets[v]] through
+	 *  keys[offsets[v + 1] - 1] */
+	size_t *offsets;
+	uint32_t *keys;
+	/** the values of the types whose signatures contain key k are
+	 *  holders[holder_offsets[k]] through
+	 *  holders[holder_offsets[k + 1] - 1] */
+	size_t *holder_offsets;
+	uint32_t *holders;
+};
+
+struct apol_types_relation_similarity
+{
+	const qpol_type_t *typeA, *typeB;
+	size_t num_common;
+	double similarity;
+};
+
+void types_relation_signatures_destroy(apol_types_relation_signatures_t ** sigs)
+{
+	if (sigs == NULL || *sigs == NULL)
+		return;
+	free((*sigs)->types);
+	free((*sigs)->offsets);
+	free((*sigs)->keys);
+	free((*sigs)->holder_offsets);
+	free((*sigs)->holders);
+	free(*sigs);
+	*sigs = NULL;
+}
+
+/**
+ * The values of the types to which a type or attribute expands,
+ * computed once per type value.
+ */
+typedef struct signature_expansion
+{
+	uint32_t *values;
+	size_t num_values;
+	int expanded;
+} signature_expansion_t;
+
+static const signature_expansion_t *signature_expand(const apol_policy_t * p, signature_expansion_t * exps, const qpol_type_t * t)
+{
+	signature_expansion_t *e;
+	apol_vector_t *v = NULL;
+	uint32_t value;
+	size_t i;
+	if (qpol_type_get_value(p->p, t, &value) < 0) {
+		return NULL;
+	}
+	e = exps + value;
+	if (e->expanded) {
+		return e;
+	}
+	if ((v = apol_query_expand_type(p, t)) == NULL) {
+		return NULL;
+	}
+	if (apol_vector_get_size(v) > 0 && (e->values = malloc(apol_vector_get_size(v) * sizeof(*e->values))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		apol_vector_destroy(&v);
+		return NULL;
+	}
+	for (i = 0; i < apol_vector_get_size(v); i++) {
+		if (qpol_type_get_value(p->p, apol_vector_get_element(v, i), e->values + i) < 0) {
+			apol_vector_destroy(&v);
+			return NULL;
+		}
+	}
+	e->num_values = apol_vector_get_size(v);
+	e->expanded = 1;
+	apol_vector_destroy(&v);
+	return e;
+}
+
+/**
+ * An allow rule reduced to what signatures need: the expansions of
+ * its source and target, and its class.
+ */
+typedef struct signature_rule
+{
+	const signature_expansion_t *source, *target;
+	uint32_t class_index;
+} signature_rule_t;
+
+static int signature_key_comp(const void *a, const void *b)
+{
+	uint32_t ka = *(const uint32_t *)a, kb = *(const uint32_t *)b;
+	return (ka < kb ? -1 : (ka > kb ? 1 : 0));
+}
+
+/**
+ * Build the access signature of every type within a policy.  The
+ * allow rules are first grouped by each type in their expanded
+ * source, and then each type's signature is gathered from its rules'
+ * expanded targets, using a bitset to remove duplicates.
+ */
+static apol_types_relation_signatures_t *types_relation_signatures_create(const apol_policy_t * p)
+{
+	apol_types_relation_signatures_t *sigs = NULL;
+	signature_expansion_t *exps = NULL;
+	signature_rule_t *rules = NULL;
+	size_t num_rules = 0, rules_cap = 0, *rule_offsets = NULL, *rule_index = NULL, *fill = NULL;
+	uint32_t *buf = NULL;
+	size_t buf_cap = 0, keys_cap = 0, num_keys, i, j, k, v;
+	apol_bitset_t seen;
+	qpol_iterator_t *iter = NULL;
+	uint32_t max_value = 0, value;
+	int retval = -1, error = 0;
+
+	memset(&seen, 0, sizeof(seen));
+	if ((sigs = calloc(1, sizeof(*sigs))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	if (qpol_policy_get_class_iter(p->p, &iter) < 0 || qpol_iterator_get_size(iter, &sigs->num_classes) < 0) {
+		goto cleanup;
+	}
+	qpol_iterator_destroy(&iter);
+	if (qpol_policy_get_type_iter(p->p, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		qpol_type_t *type;
+		if (qpol_iterator_get_item(iter, (void **)&type) < 0 || qpol_type_get_value(p->p, type, &value) < 0) {
+			goto cleanup;
+		}
+		if (value > max_value)
+			max_value = value;
+	}
+	sigs->num_types = (size_t) max_value + 1;
+	if (sigs->num_classes > 0 && sigs->num_types > UINT32_MAX / sigs->num_classes) {
+		ERR(p, "%s", strerror(EOVERFLOW));
+		errno = EOVERFLOW;
+		goto cleanup;
+	}
+	num_keys = sigs->num_types * sigs->num_classes;
+	if ((sigs->types = calloc(sigs->num_types, sizeof(*sigs->types))) == NULL ||
+	    (exps = calloc(sigs->num_types, sizeof(*exps))) == NULL ||
+	    (rule_offsets = calloc(sigs->num_types + 1, sizeof(*rule_offsets))) == NULL ||
+	    (sigs->offsets = calloc(sigs->num_types + 1, sizeof(*sigs->offsets))) == NULL ||
+	    (sigs->holder_offsets = calloc(num_keys + 1, sizeof(*sigs->holder_offsets))) == NULL ||
+	    apol_bitset_init(&seen, num_keys) < 0) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	qpol_iterator_destroy(&iter);
+	if (qpol_policy_get_type_iter(p->p, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		qpol_type_t *type;
+		unsigned char isattr;
+		if (qpol_iterator_get_item(iter, (void **)&type) < 0 || qpol_type_get_value(p->p, type, &value) < 0 ||
+		    qpol_type_get_isattr(p->p, type, &isattr) < 0) {
+			goto cleanup;
+		}
+		if (!isattr)
+			sigs->types[value] = type;
+	}
+	qpol_iterator_destroy(&iter);
+
+	/* reduce every allow rule, and count how many each type is
+	 * the source of */
+	if (qpol_policy_get_avrule_iter(p->p, QPOL_RULE_ALLOW, &iter) < 0) {
+		goto cleanup;
+	}
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		const qpol_avrule_t *rule;
+		const qpol_type_t *source, *target;
+		const qpol_class_t *obj_class;
+		signature_rule_t *sr;
+		uint32_t class_value;
+		if (qpol_iterator_get_item(iter, (void **)&rule) < 0 ||
+		    qpol_avrule_get_source_type(p->p, rule, &source) < 0 ||
+		    qpol_avrule_get_target_type(p->p, rule, &target) < 0 ||
+		    qpol_avrule_get_object_class(p->p, rule, &obj_class) < 0 ||
+		    qpol_class_get_value(p->p, obj_class, &class_value) < 0) {
+			goto cleanup;
+		}
+		if (num_rules >= rules_cap) {
+			size_t new_cap = (rules_cap > 0 ? rules_cap * 2 : 1024);
+			signature_rule_t *tmp = realloc(rules, new_cap * sizeof(*rules));
+			if (tmp == NULL) {
+				ERR(p, "%s", strerror(errno));
+				goto cleanup;
+			}
+			rules = tmp;
+			rules_cap = new_cap;
+		}
+		sr = rules + num_rules++;
+		if ((sr->source = signature_expand(p, exps, source)) == NULL ||
+		    (sr->target = signature_expand(p, exps, target)) == NULL) {
+			goto cleanup;
+		}
+		sr->class_index = class_value - 1;
+		for (i = 0; i < sr->source->num_values; i++)
+			rule_offsets[sr->source->values[i] + 1]++;
+	}
+	qpol_iterator_destroy(&iter);
+
+	/* group the rules by source type */
+	for (v = 1; v <= sigs->num_types; v++)
+		rule_offsets[v] += rule_offsets[v - 1];
+	if (rule_offsets[sigs->num_types] > 0 &&
+	    (rule_index = malloc(rule_offsets[sigs->num_types] * sizeof(*rule_index))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	if ((fill = malloc(sigs->num_types * sizeof(*fill))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	memcpy(fill, rule_offsets, sigs->num_types * sizeof(*fill));
+	for (i = 0; i < num_rules; i++) {
+		const signature_expansion_t *src = rules[i].source;
+		for (j = 0; j < src->num_values; j++)
+			rule_index[fill[src->values[j]]++] = i;
+	}
+
+	/* gather each type's signature */
+	for (v = 0; v < sigs->num_types; v++) {
+		size_t n = 0;
+		if (sigs->types[v] != NULL) {
+			for (i = rule_offsets[v]; i < rule_offsets[v + 1]; i++) {
+				const signature_rule_t *sr = rules + rule_index[i];
+				for (j = 0; j < sr->target->num_values; j++) {
+					uint32_t key = sr->target->values[j] * sigs->num_classes + sr->class_index;
+					if (apol_bitset_get(&seen, key))
+						continue;
+					apol_bitset_set(&seen, key, 1);
+					if (n >= buf_cap) {
+						size_t new_cap = (buf_cap > 0 ? buf_cap * 2 : 256);
+						uint32_t *tmp = realloc(buf, new_cap * sizeof(*buf));
+						if (tmp == NULL) {
+							ERR(p, "%s", strerror(errno));
+							goto cleanup;
+						}
+						buf = tmp;
+						buf_cap = new_cap;
+					}
+					buf[n++] = key;
+				}
+			}
+			if (n > 1)
+				qsort(buf, n, sizeof(*buf), signature_key_comp);
+			for (k = 0; k < n; k++)
+				apol_bitset_set(&seen, buf[k], 0);
+		}
+		if (sigs->offsets[v] + n > keys_cap) {
+			size_t new_cap = (keys_cap > 0 ? keys_cap * 2 : 1024);
+			uint32_t *tmp;
+			while (new_cap < sigs->offsets[v] + n)
+				new_cap *= 2;
+			if ((tmp = realloc(sigs->keys, new_cap * sizeof(*tmp))) == NULL) {
+				ERR(p, "%s", strerror(errno));
+				goto cleanup;
+			}
+			sigs->keys = tmp;
+			keys_cap = new_cap;
+		}
+		if (n > 0)
+			memcpy(sigs->keys + sigs->offsets[v], buf, n * sizeof(*buf));
+		sigs->offsets[v + 1] = sigs->offsets[v] + n;
+	}
+
+	/* invert the signatures */
+	for (k = 0; k < sigs->offsets[sigs->num_types]; k++)
+		sigs->holder_offsets[sigs->keys[k] + 1]++;
+	for (k = 1; k <= num_keys; k++)
+		sigs->holder_offsets[k] += sigs->holder_offsets[k - 1];
+	if (sigs->offsets[sigs->num_types] > 0 &&
+	    (sigs->holders = malloc(sigs->offsets[sigs->num_types] * sizeof(*sigs->holders))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	for (v = 0; v < sigs->num_types; v++) {
+		for (k = sigs->offsets[v]; k < sigs->offsets[v + 1]; k++)
+			sigs->holders[sigs->holder_offsets[sigs->keys[k]]++] = (uint32_t) v;
+	}
+	/* filling advanced each key's offset to the next key's start;
+	 * shift them back */
+	for (k = num_keys; k > 0; k--)
+		sigs->holder_offsets[k] = sigs->holder_offsets[k - 1];
+	sigs->holder_offsets[0] = 0;
+
+	retval = 0;
+      cleanup:
+	qpol_iterator_destroy(&iter);
+	if (exps != NULL) {
+		for (v = 0; v < sigs->num_types; v++)
+			free(exps[v].values);
+	}
+	free(exps);
+	free(rules);
+	free(rule_offsets);
+	free(rule_index);
+	free(fill);
+	free(buf);
+	apol_bitset_release(&seen);
+	if (retval != 0) {
+		error = errno;
+		types_relation_signatures_destroy(&sigs);
+		errno = error;
+	}
+	return sigs;
+}
+
+static void *types_relation_signatures_build(const apol_policy_t * p)
+{
+	INFO(p, "%s", "Building type access signatures.");
+	return types_relation_signatures_create(p);
+}
+
+static void types_relation_signatures_free(void *sigs)
+{
+	apol_types_relation_signatures_t *s = sigs;
+	types_relation_signatures_destroy(&s);
+}
+
+/**
+ * Get the policy's access signatures, building them upon first use.
+ */
+static const apol_types_relation_signatures_t *types_relation_signatures_get(const apol_policy_t * p)
+{
+	apol_policy_t *policy = (apol_policy_t *) p;
+	return policy_get_cache(p, (void **)&policy->type_signatures, types_relation_signatures_build,
+				types_relation_signatures_free);
+}
+
+static size_t signature_size(const apol_types_relation_signatures_t * sigs, uint32_t v)
+{
+	return sigs->offsets[v + 1] - sigs->offsets[v];
+}
+
+/**
+ * Count the keys that other types share with one type, by walking the
+ * holders of each of its keys.  Only types that share at least one
+ * key are visited.
+ *
+ * @param sigs Access signatures.
+ * @param v Value of the type to compare.
+ * @param min_value Only count types whose values are greater than
+ * this.
+ * @param min_similarity Skip types whose signature sizes alone rule
+ * out this similarity.
+ * @param counts Array of counts indexed by type value, all zero upon
+ * entry.  Upon return the counts of the touched types are set.
+ * @param touched Array to receive the values of the types with
+ * non-zero counts.
+ *
+ * @return Number of touched types.
+ */
+static size_t signature_count_common(const apol_types_relation_signatures_t * sigs, uint32_t v, uint32_t min_value,
+				     double min_similarity, uint32_t * counts, uint32_t * touched)
+{
+	size_t size_v = signature_size(sigs, v), num_touched = 0, i, j;
+	double min_size = min_similarity * size_v, max_size = (min_similarity > 0 ? size_v / min_similarity : (double)SIZE_MAX);
+	for (i = sigs->offsets[v]; i < sigs->offsets[v + 1]; i++) {
+		uint32_t key = sigs->keys[i];
+		for (j = sigs->holder_offsets[key]; j < sigs->holder_offsets[key + 1]; j++) {
+			uint32_t u = sigs->holders[j];
+			size_t size_u;
+			if (u <= min_value || u == v)
+				continue;
+			/* |A n B| / |A u B| cannot exceed min(|A|, |B|) / max(|A|, |B|) */
+			size_u = signature_size(sigs, u);
+			if (size_u < min_size || size_u > max_size)
+				continue;
+			if (counts[u]++ == 0)
+				touched[num_touched++] = u;
+		}
+	}
+	return num_touched;
+}
+
+/**
+ * Append a similarity result for a pair of types.
+ */
+static int signature_append_similarity(const apol_policy_t * p, const apol_types_relation_signatures_t * sigs, uint32_t a,
+				       uint32_t b, size_t num_common, apol_vector_t * v)
+{
+	apol_types_relation_similarity_t *s;
+	if ((s = calloc(1, sizeof(*s))) == NULL || apol_vector_append(v, s) < 0) {
+		ERR(p, "%s", strerror(errno));
+		free(s);
+		return -1;
+	}
+	s->typeA = sigs->types[a];
+	s->typeB = sigs->types[b];
+	s->num_common = num_common;
+	s->similarity = (double)num_common / (double)(signature_size(sigs, a) + signature_size(sigs, b) - num_common);
+	return 0;
+}
+
+/**
+ * Comparison function for similarity results, ordering the most
+ * similar first and breaking ties by the types' names.
+ */
+static int signature_similarity_comp(const void *a, const void *b, void *data)
+{
+	const apol_types_relation_similarity_t *sa = a;
+	const apol_types_relation_similarity_t *sb = b;
+	const apol_policy_t *p = data;
+	const char *na, *nb;
+	int cmp;
+	if (sa->similarity != sb->similarity)
+		return (sa->similarity > sb->similarity ? -1 : 1);
+	if (sa->num_common != sb->num_common)
+		return (sa->num_common > sb->num_common ? -1 : 1);
+	if (sa->typeA != sb->typeA) {
+		qpol_type_get_name(p->p, sa->typeA, &na);
+		qpol_type_get_name(p->p, sb->typeA, &nb);
+		if ((cmp = strcmp(na, nb)) != 0)
+			return cmp;
+	}
+	qpol_type_get_name(p->p, sa->typeB, &na);
+	qpol_type_get_name(p->p, sb->typeB, &nb);
+	return strcmp(na, nb);
+}
+
 /******************** public functions below ********************/
 
 int apol_types_relation_analysis_do(apol_policy_t * p, const apol_types_relation_analysis_t * tr, apol_types_relation_result_t ** r)
@@ -1038,6 +1480,117 @@ int apol_types_relation_analysis_set_analyses(const apol_policy_t * p __attribut
 	return 0;
 }
 
+int apol_types_relation_find_similar(const apol_policy_t * p, const char *type_name, size_t max_results, apol_vector_t ** results)
+{
+	const apol_types_relation_signatures_t *sigs;
+	const qpol_type_t *type;
+	unsigned char isattr;
+	uint32_t value, *counts = NULL, *touched = NULL;
+	size_t num_touched, i;
+	int retval = -1;
+
+	if (results != NULL)
+		*results = NULL;
+	if (p == NULL || type_name == NULL || results == NULL) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	if (qpol_policy_get_type_by_name(p->p, type_name, &type) < 0 || qpol_type_get_isattr(p->p, type, &isattr) < 0 ||
+	    qpol_type_get_value(p->p, type, &value) < 0) {
+		goto cleanup;
+	}
+	if (isattr) {
+		ERR(p, "%s is an attribute, not a type.", type_name);
+		errno = EINVAL;
+		goto cleanup;
+	}
+	if ((sigs = types_relation_signatures_get(p)) == NULL) {
+		goto cleanup;
+	}
+	if ((*results = apol_vector_create(free)) == NULL ||
+	    (counts = calloc(sigs->num_types, sizeof(*counts))) == NULL ||
+	    (touched = malloc(sigs->num_types * sizeof(*touched))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	num_touched = signature_count_common(sigs, value, 0, 0.0, counts, touched);
+	for (i = 0; i < num_touched; i++) {
+		if (signature_append_similarity(p, sigs, value, touched[i], counts[touched[i]], *results) < 0) {
+			goto cleanup;
+		}
+	}
+	apol_vector_sort(*results, signature_similarity_comp, (void *)p);
+	while (max_results > 0 && apol_vector_get_size(*results) > max_results) {
+		size_t last = apol_vector_get_size(*results) - 1;
+		free(apol_vector_get_element(*results, last));
+		apol_vector_remove(*results, last);
+	}
+
+	retval = 0;
+      cleanup:
+	free(counts);
+	free(touched);
+	if (retval != 0) {
+		apol_vector_destroy(results);
+	}
+	return retval;
+}
+
+int apol_types_relation_find_similar_pairs(const apol_policy_t * p, double min_similarity, apol_vector_t ** results)
+{
+	const apol_types_relation_signatures_t *sigs;
+	uint32_t v, *counts = NULL, *touched = NULL;
+	size_t num_touched, i;
+	int retval = -1;
+
+	if (results != NULL)
+		*results = NULL;
+	if (p == NULL || results == NULL || min_similarity <= 0.0 || min_similarity > 1.0) {
+		ERR(p, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	if ((sigs = types_relation_signatures_get(p)) == NULL) {
+		goto cleanup;
+	}
+	if ((*results = apol_vector_create(free)) == NULL ||
+	    (counts = calloc(sigs->num_types, sizeof(*counts))) == NULL ||
+	    (touched = malloc(sigs->num_types * sizeof(*touched))) == NULL) {
+		ERR(p, "%s", strerror(errno));
+		goto cleanup;
+	}
+	for (v = 1; v < sigs->num_types; v++) {
+		if (sigs->types[v] == NULL || signature_size(sigs, v) == 0) {
+			continue;
+		}
+		/* count only types of greater value, so each pair is
+		 * found once */
+		num_touched = signature_count_common(sigs, v, v, min_similarity, counts, touched);
+		for (i = 0; i < num_touched; i++) {
+			uint32_t u = touched[i];
+			size_t common = counts[u];
+			counts[u] = 0;
+			if ((double)common < min_similarity * (double)(signature_size(sigs, v) + signature_size(sigs, u) - common)) {
+				continue;
+			}
+			if (signature_append_similarity(p, sigs, v, u, common, *results) < 0) {
+				goto cleanup;
+			}
+		}
+	}
+	apol_vector_sort(*results, signature_similarity_comp, (void *)p);
+
+	retval = 0;
+      cleanup:
+	free(counts);
+	free(touched);
+	if (retval != 0) {
+		apol_vector_destroy(results);
+	}
+	return retval;
+}
+
 /*************** functions to access type relation results ***************/
 
 void apol_types_relation_result_destroy(apol_types_relation_result_t ** result)
@@ -1141,3 +1694,23 @@ const apol_vector_t *apol_types_relation_access_get_rules(const apol_types_relat
 {
 	return a->rules;
 }
+
+const qpol_type_t *apol_types_relation_similarity_get_first_type(const apol_types_relation_similarity_t * s)
+{
+	return s->typeA;
+}
+
+const qpol_type_t *apol_types_relation_similarity_get_other_type(const apol_types_relation_similarity_t * s)
+{
+	return s->typeB;
+}
+
+size_t apol_types_relation_similarity_get_num_common(const apol_types_relation_similarity_t * s)
+{
+	return s->num_common;
+}
+
+double apol_types_relation_similarity_get_similarity(const apol_types_relation_similarity_t * s)
+{
+	return s->similarity;
+}
@@ -653,6 +653,19 @@ int apol_str_strcmp(const void *a, const void *b, void *unused __attribute__ ((u
 	return strcmp((const char *)a, (const char *)b);
 }
 
+size_t apol_str_hash(const void *s, void *unused __attribute__ ((unused)))
+{
+	/* FNV-1a */
+	const unsigned char *c = (const unsigned char *)s;
+	size_t h = 2166136261U;
+	for (; *c != '\0'; c++) {
+		h = (h ^ *c) * 16777619U;
+	}
+	/* fold the well-mixed upper bits into the lower ones, which
+	 * are the bits used to select a bucket */
+	return h ^ (h >> 15);
+}
+
 void *apol_str_strdup(const void *elem, void *unused __attribute__ ((unused)))
 {
 	return strdup((const char *)elem);
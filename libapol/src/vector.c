@@ -24,6 +24,7 @@
 
 #include <apol/vector.h>
 #include "vector-internal.h"
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
@@ -198,21 +199,37 @@ void *apol_vector_get_element(const apol_vector_t * v, size_t idx)
 }
 
 /**
- * Grows a vector, by reallocating additional space for it.
+ * Grows a vector, by reallocating additional space for it.  The
+ * capacity is at least doubled so that a sequence of appends runs in
+ * amortized constant time.
  *
  * @param v Vector to which increase its size.
+ * @param min_capacity Minimum number of elements the vector must be
+ * able to hold afterwards.
  *
  * @return 0 on success, -1 on error.
  */
-static int apol_vector_grow(apol_vector_t * v)
+static int apol_vector_grow(apol_vector_t * v, size_t min_capacity)
 {
 	void **tmp;
 	size_t new_capacity = v->capacity;
-	if (new_capacity >= 128) {
-		new_capacity += 128;
-	} else {
+	if (new_capacity >= min_capacity) {
+		return 0;
+	}
+	if (new_capacity < APOL_VECTOR_DFLT_INIT_CAP) {
+		new_capacity = APOL_VECTOR_DFLT_INIT_CAP;
+	}
+	while (new_capacity < min_capacity) {
+		if (new_capacity > SIZE_MAX / 2 / sizeof(void *)) {
+			new_capacity = min_capacity;
+			break;
+		}
 		new_capacity *= 2;
 	}
+	if (new_capacity > SIZE_MAX / sizeof(void *)) {
+		errno = ENOMEM;
+		return -1;
+	}
 	tmp = realloc(v->array, new_capacity * sizeof(void *));
 	if (!tmp) {
 		return -1;
@@ -222,6 +239,26 @@ static int apol_vector_grow(apol_vector_t * v)
 	return 0;
 }
 
+int apol_vector_reserve(apol_vector_t * v, size_t cap)
+{
+	if (!v) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (cap <= v->capacity) {
+		return 0;
+	}
+	/* reserve exactly what was asked for; callers use this when
+	 * they already know the final size */
+	void **tmp = realloc(v->array, cap * sizeof(void *));
+	if (!tmp) {
+		return -1;
+	}
+	v->capacity = cap;
+	v->array = tmp;
+	return 0;
+}
+
 int apol_vector_get_index(const apol_vector_t * v, const void *elem, apol_vector_comp_func * cmp, void *data, size_t * i)
 {
 	if (!v || !i) {
@@ -244,7 +281,7 @@ int apol_vector_append(apol_vector_t * v, void *elem)
 		return -1;
 	}
 
-	if (v->size >= v->capacity && apol_vector_grow(v)) {
+	if (v->size >= v->capacity && apol_vector_grow(v, v->size + 1)) {
 		return -1;
 	}
 
@@ -254,6 +291,35 @@ int apol_vector_append(apol_vector_t * v, void *elem)
 	return 0;
 }
 
+int apol_vector_append_array(apol_vector_t * v, void **elems, size_t n)
+{
+	if (!v || (elems == NULL && n > 0)) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (n == 0) {
+		return 0;
+	}
+	if (n > SIZE_MAX - v->size) {
+		errno = ENOMEM;
+		return -1;
+	}
+	if (elems >= v->array && elems < v->array + v->size) {
+		/* appending part of the vector to itself; the source
+		 * moves along with the array if it is reallocated */
+		size_t offset = (size_t) (elems - v->array);
+		if (apol_vector_grow(v, v->size + n)) {
+			return -1;
+		}
+		elems = v->array + offset;
+	} else if (apol_vector_grow(v, v->size + n)) {
+		return -1;
+	}
+	memcpy(v->array + v->size, elems, n * sizeof(void *));
+	v->size += n;
+	return 0;
+}
+
 int apol_vector_append_unique(apol_vector_t * v, void *elem, apol_vector_comp_func * cmp, void *data)
 {
 	size_t i;
@@ -292,34 +358,156 @@ int apol_vector_compare(const apol_vector_t * a, const apol_vector_t * b, apol_v
 	}
 }
 
-static size_t vector_qsort_partition(void **data, size_t first, size_t last, apol_vector_comp_func * cmp, void *arg)
+/** Ranges with at most this many elements are finished by an insertion sort. */
+#define VECTOR_SORT_INSERTION_CUTOFF 16
+
+static void vector_insertion_sort(void **data, size_t first, size_t last, apol_vector_comp_func * cmp, void *arg)
 {
-	void *pivot = data[last];
-	size_t i = first, j = last;
-	while (i < j) {
-		if (cmp(data[i], pivot, arg) <= 0) {
-			i++;
-		} else {
-			data[j] = data[i];
-			data[i] = data[j - 1];
-			j--;
+	size_t i, j;
+	for (i = first + 1; i <= last; i++) {
+		void *elem = data[i];
+		for (j = i; j > first && cmp(data[j - 1], elem, arg) > 0; j--) {
+			data[j] = data[j - 1];
+		}
+		data[j] = elem;
+	}
+}
+
+static void vector_heap_sift_down(void **data, size_t root, size_t n, apol_vector_comp_func * cmp, void *arg)
+{
+	void *elem = data[root];
+	size_t child;
+	while ((child = 2 * root + 1) < n) {
+		if (child + 1 < n && cmp(data[child], data[child + 1], arg) < 0) {
+			child++;
+		}
+		if (cmp(elem, data[child], arg) >= 0) {
+			break;
+		}
+		data[root] = data[child];
+		root = child;
+	}
+	data[root] = elem;
+}
+
+/**
+ * Heapsort the n elements starting at data.  This is the fallback
+ * used once quicksort has recursed too deeply, which bounds the
+ * overall sort to O(n log n).
+ */
+static void vector_heapsort(void **data, size_t n, apol_vector_comp_func * cmp, void *arg)
+{
+	size_t i;
+	void *tmp;
+	for (i = n / 2; i > 0; i--) {
+		vector_heap_sift_down(data, i - 1, n, cmp, arg);
+	}
+	for (i = n - 1; i > 0; i--) {
+		tmp = data[0];
+		data[0] = data[i];
+		data[i] = tmp;
+		vector_heap_sift_down(data, 0, i, cmp, arg);
+	}
+}
+
+static void vector_swap(void **data, size_t i, size_t j)
+{
+	void *tmp = data[i];
+	data[i] = data[j];
+	data[j] = tmp;
+}
+
+/**
+ * Partition the range [first, last] around the median of its first,
+ * middle, and last elements.  The range must hold more than three
+ * elements.  Elements equal to the pivot are split evenly between
+ * both sides so that vectors with many duplicates still partition
+ * well.
+ *
+ * @return Final index of the pivot; this is always strictly between
+ * first and last.
+ */
+static size_t vector_sort_partition(void **data, size_t first, size_t last, apol_vector_comp_func * cmp, void *arg)
+{
+	size_t mid = first + (last - first) / 2, i, j;
+	void *pivot;
+	if (cmp(data[mid], data[first], arg) < 0) {
+		vector_swap(data, mid, first);
+	}
+	if (cmp(data[last], data[mid], arg) < 0) {
+		vector_swap(data, last, mid);
+		if (cmp(data[mid], data[first], arg) < 0) {
+			vector_swap(data, mid, first);
+		}
+	}
+	/* data[first] <= pivot <= data[last]; both act as sentinels
+	 * for the scans below */
+	vector_swap(data, mid, last - 1);
+	pivot = data[last - 1];
+	i = first;
+	j = last - 1;
+	while (1) {
+		while (cmp(data[++i], pivot, arg) < 0) ;
+		while (cmp(pivot, data[--j], arg) < 0) ;
+		if (i >= j) {
+			break;
 		}
+		vector_swap(data, i, j);
 	}
-	data[j] = pivot;
-	return j;
+	vector_swap(data, i, last - 1);
+	return i;
 }
 
-static void vector_qsort(void **data, size_t first, size_t last, apol_vector_comp_func * cmp, void *arg)
+/**
+ * Sort the n elements within data using an introsort: an iterative
+ * median-of-three quicksort that switches to heapsort when
+ * partitioning degenerates and to insertion sort for short ranges.
+ */
+static void vector_introsort(void **data, size_t n, apol_vector_comp_func * cmp, void *arg)
 {
-	if (first < last) {
-		size_t i = vector_qsort_partition(data, first, last, cmp, arg);
-		/* need this explicit check here, because i is an
-		 * unsigned integer, and subtracting 1 from 0 is
-		 * bad */
-		if (i > 0) {
-			vector_qsort(data, first, i - 1, cmp, arg);
+	/* the larger partition is always deferred, so at most
+	 * log2(n) ranges are ever pending */
+	struct
+	{
+		size_t first, last, depth;
+	} stack[sizeof(size_t) * 8];
+	size_t top = 0, first, last, depth = 0, p;
+
+	for (p = n; p > 1; p >>= 1) {
+		depth += 2;
+	}
+	stack[top].first = 0;
+	stack[top].last = n - 1;
+	stack[top].depth = depth;
+	top++;
+	while (top > 0) {
+		top--;
+		first = stack[top].first;
+		last = stack[top].last;
+		depth = stack[top].depth;
+		while (last - first >= VECTOR_SORT_INSERTION_CUTOFF) {
+			if (depth == 0) {
+				vector_heapsort(data + first, last - first + 1, cmp, arg);
+				break;
+			}
+			depth--;
+			p = vector_sort_partition(data, first, last, cmp, arg);
+			if (p - first < last - p) {
+				stack[top].first = p + 1;
+				stack[top].last = last;
+				stack[top].depth = depth;
+				last = p - 1;
+			} else {
+				stack[top].first = first;
+				stack[top].last = p - 1;
+				stack[top].depth = depth;
+				first = p + 1;
+			}
+			top++;
+		}
+		if (last - first < VECTOR_SORT_INSERTION_CUTOFF && first < last) {
+			vector_insertion_sort(data, first, last, cmp, arg);
 		}
-		vector_qsort(data, i + 1, last, cmp, arg);
 	}
 }
 
@@ -339,7 +527,7 @@ static int vector_int_comp(const void *a, const void *b, void *data __attribute_
 	return 0;
 }
 
-/* implemented as an in-place quicksort */
+/* implemented as an in-place introsort */
 void apol_vector_sort(apol_vector_t * v, apol_vector_comp_func * cmp, void *data)
 {
 	if (!v) {
@@ -350,8 +538,35 @@ void apol_vector_sort(apol_vector_t * v, apol_vector_comp_func * cmp, void *data
 		cmp = vector_int_comp;
 	}
 	if (v->size > 1) {
-		vector_qsort(v->array, 0, v->size - 1, cmp, data);
+		vector_introsort(v->array, v->size, cmp, data);
+	}
+}
+
+int apol_vector_get_index_sorted(const apol_vector_t * v, const void *elem, apol_vector_comp_func * cmp, void *data, size_t * i)
+{
+	size_t lo, hi, mid;
+	if (!v || !i) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (cmp == NULL) {
+		cmp = vector_int_comp;
+	}
+	lo = 0;
+	hi = v->size;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (cmp(v->array[mid], elem, data) < 0) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	*i = lo;
+	if (lo < v->size && cmp(v->array[lo], elem, data) == 0) {
+		return 0;
 	}
+	return -1;
 }
 
 void apol_vector_sort_uniquify(apol_vector_t * v, apol_vector_comp_func * cmp, void *data)
@@ -407,8 +622,6 @@ void apol_vector_sort_uniquify(apol_vector_t * v, apol_vector_comp_func * cmp, v
 
 int apol_vector_cat(apol_vector_t * dest, const apol_vector_t * src)
 {
-	size_t i, orig_size, cap;
-	void **a;
 	if (!src || !apol_vector_get_size(src)) {
 		return 0;	       /* nothing to append */
 	}
@@ -417,25 +630,8 @@ int apol_vector_cat(apol_vector_t * dest, const apol_vector_t * src)
 		errno = EINVAL;
 		return -1;
 	}
-	orig_size = apol_vector_get_size(dest);
-	for (i = 0; i < apol_vector_get_size(src); i++)
-		if (apol_vector_append(dest, apol_vector_get_element(src, i))) {
-			/* revert if possible */
-			if (orig_size == 0) {
-				cap = 1;
-			} else {
-				cap = orig_size;
-			}
-			a = realloc(dest->array, cap * sizeof(*a));
-			if (a != NULL) {
-				dest->array = a;
-			}
-			dest->size = orig_size;
-			dest->capacity = cap;
-			return -1;
-		}
-
-	return 0;
+	/* dest is left untouched if the single reallocation fails */
+	return apol_vector_append_array(dest, src->array, src->size);
 }
 
 int apol_vector_remove(apol_vector_t * v, const size_t idx)
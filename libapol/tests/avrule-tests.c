@@ -26,11 +26,19 @@
 #include <config.h>
 
 #include <CUnit/CUnit.h>
+#include <apol/access-query.h>
 #include <apol/avrule-query.h>
 #include <apol/policy.h>
 #include <apol/policy-path.h>
+#include <apol/util.h>
+#include <qpol/bool_query.h>
 #include <qpol/policy_extend.h>
+#include <errno.h>
 #include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 #define BIN_POLICY TEST_POLICIES "/setools-3.3/rules/rules-mls.21"
 #define SOURCE_POLICY TEST_POLICIES "/setools-3.3/rules/rules-mls.conf"
@@ -114,11 +122,223 @@ static void avrule_default(void)
 	apol_avrule_query_destroy(&aq);
 }
 
+static void avrule_access(void)
+{
+	apol_avrule_query_t *aq = apol_avrule_query_create();
+	CU_ASSERT_PTR_NOT_NULL_FATAL(aq);
+	apol_vector_t *v = NULL, *sources = apol_vector_create(NULL), *targets = apol_vector_create(NULL),
+		*classes = apol_vector_create(NULL);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(sources);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(targets);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(classes);
+
+	int retval;
+	retval = apol_avrule_query_set_rules(bp, aq, QPOL_RULE_ALLOW);
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+	retval = apol_avrule_get_by_query(bp, aq, &v);
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+
+	/* every permission of an enabled allow rule between two
+	 * types must be part of the computed access */
+	qpol_policy_t *q = apol_policy_get_qpol(bp);
+	size_t i, num_checked = 0;
+	for (i = 0; i < apol_vector_get_size(v); i++) {
+		const qpol_avrule_t *rule = apol_vector_get_element(v, i);
+		const qpol_type_t *source, *target;
+		const qpol_class_t *obj_class;
+		const char *source_name, *target_name, *class_name;
+		char *perm;
+		unsigned char source_attr, target_attr;
+		uint32_t is_enabled, value, mask = 0;
+		qpol_iterator_t *iter = NULL;
+		qpol_access_t access;
+
+		retval = qpol_avrule_get_is_enabled(q, rule, &is_enabled);
+		CU_ASSERT_EQUAL_FATAL(retval, 0);
+		qpol_avrule_get_source_type(q, rule, &source);
+		qpol_avrule_get_target_type(q, rule, &target);
+		qpol_avrule_get_object_class(q, rule, &obj_class);
+		qpol_type_get_isattr(q, source, &source_attr);
+		qpol_type_get_isattr(q, target, &target_attr);
+		if (!is_enabled || source_attr || target_attr) {
+			continue;
+		}
+		qpol_type_get_name(q, source, &source_name);
+		qpol_type_get_name(q, target, &target_name);
+		qpol_class_get_name(q, obj_class, &class_name);
+
+		retval = qpol_avrule_get_perm_iter(q, rule, &iter);
+		CU_ASSERT_EQUAL_FATAL(retval, 0);
+		for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+			qpol_iterator_get_item(iter, (void **)&perm);
+			retval = qpol_class_get_perm_value(q, obj_class, perm, &value);
+			CU_ASSERT_EQUAL_FATAL(retval, 0);
+			mask |= 1U << (value - 1);
+			free(perm);
+		}
+		qpol_iterator_destroy(&iter);
+
+		retval = apol_access_compute(bp, source_name, target_name, class_name, &access);
+		CU_ASSERT_EQUAL_FATAL(retval, 0);
+		CU_ASSERT((access.allowed & mask) == mask);
+		apol_vector_append(sources, (void *)source_name);
+		apol_vector_append(targets, (void *)target_name);
+		apol_vector_append(classes, (void *)class_name);
+		num_checked++;
+	}
+	CU_ASSERT(num_checked > 0);
+	apol_vector_destroy(&v);
+	apol_avrule_query_destroy(&aq);
+
+	/* a matrix must match computing each entry on its own */
+	apol_vector_sort_uniquify(sources, apol_str_strcmp, NULL);
+	apol_vector_sort_uniquify(targets, apol_str_strcmp, NULL);
+	apol_vector_sort_uniquify(classes, apol_str_strcmp, NULL);
+	apol_access_matrix_t *m = NULL;
+	retval = apol_access_compute_matrix(bp, sources, targets, classes, 4, &m);
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(m);
+	size_t s, t, c;
+	for (s = 0; s < apol_vector_get_size(sources); s++) {
+		for (t = 0; t < apol_vector_get_size(targets); t++) {
+			for (c = 0; c < apol_vector_get_size(classes); c++) {
+				const qpol_access_t *entry = apol_access_matrix_get(m, s, t, c);
+				qpol_access_t access;
+				CU_ASSERT_PTR_NOT_NULL_FATAL(entry);
+				retval = apol_access_compute(bp, apol_vector_get_element(sources, s),
+							     apol_vector_get_element(targets, t), apol_vector_get_element(classes, c),
+							     &access);
+				CU_ASSERT_EQUAL_FATAL(retval, 0);
+				CU_ASSERT(memcmp(entry, &access, sizeof(access)) == 0);
+			}
+		}
+	}
+	CU_ASSERT_PTR_NULL(apol_access_matrix_get(m, s, 0, 0));
+	apol_access_matrix_destroy(&m);
+	CU_ASSERT_PTR_NULL(m);
+
+	apol_vector_destroy(&sources);
+	apol_vector_destroy(&targets);
+	apol_vector_destroy(&classes);
+}
+
+/**
+ * A policy whose rules grant access through attributes, auditallow,
+ * dontaudit, and conditional rules.
+ */
+static const char *access_policy =
+	"class file\n"
+	"class dir\n"
+	"sid kernel\n"
+	"class file { read write execute getattr }\n"
+	"class dir { search }\n"
+	"attribute domain;\n"
+	"attribute files;\n"
+	"type a_t, domain;\n"
+	"type b_t, domain;\n"
+	"type f_t, files;\n"
+	"type g_t;\n"
+	"bool flag true;\n"
+	"bool other false;\n"
+	"allow domain files : file read;\n"
+	"allow a_t f_t : file write;\n"
+	"auditallow domain f_t : file read;\n"
+	"dontaudit b_t files : file { getattr execute };\n"
+	"allow a_t g_t : file getattr;\n"
+	"if (flag) { allow a_t g_t : file read; }\n"
+	"if (other) { allow a_t g_t : file write; } else { allow a_t g_t : file execute; }\n"
+	"role r types { a_t b_t f_t g_t };\n"
+	"user u roles { r };\n"
+	"sid kernel u:r:a_t\n";
+
+/**
+ * Compute access and check every vector against the expected
+ * permissions, given as space separated names.
+ */
+static void access_check(apol_policy_t * p, const char *src, const char *tgt, const char *obj_class, const char *allowed,
+			 const char *auditallow, const char *dontaudit)
+{
+	qpol_policy_t *q = apol_policy_get_qpol(p);
+	const qpol_class_t *c;
+	qpol_access_t access;
+	const char *perms[3] = { allowed, auditallow, dontaudit };
+	uint32_t masks[3] = { 0, 0, 0 };
+	size_t i;
+	CU_ASSERT_FATAL(qpol_policy_get_class_by_name(q, obj_class, &c) == 0);
+	for (i = 0; i < 3; i++) {
+		char *names = strdup(perms[i]), *name, *save = NULL;
+		uint32_t value;
+		CU_ASSERT_PTR_NOT_NULL_FATAL(names);
+		for (name = strtok_r(names, " ", &save); name != NULL; name = strtok_r(NULL, " ", &save)) {
+			CU_ASSERT_FATAL(qpol_class_get_perm_value(q, c, name, &value) == 0);
+			masks[i] |= 1U << (value - 1);
+		}
+		free(names);
+	}
+	CU_ASSERT_FATAL(apol_access_compute(p, src, tgt, obj_class, &access) == 0);
+	CU_ASSERT_EQUAL(access.allowed, masks[0]);
+	CU_ASSERT_EQUAL(access.auditallow, masks[1]);
+	CU_ASSERT_EQUAL(access.dontaudit, masks[2]);
+}
+
+static void avrule_access_sources(void)
+{
+	char filename[] = "/tmp/apol-access-XXXXXX";
+	int fd = mkstemp(filename);
+	FILE *fp;
+	apol_policy_path_t *ppath;
+	apol_policy_t *p;
+	qpol_policy_t *q;
+	qpol_bool_t *b;
+	qpol_access_t access;
+
+	CU_ASSERT_FATAL(fd >= 0);
+	fp = fdopen(fd, "w");
+	CU_ASSERT_PTR_NOT_NULL_FATAL(fp);
+	fputs(access_policy, fp);
+	fclose(fp);
+	ppath = apol_policy_path_create(APOL_POLICY_PATH_TYPE_MONOLITHIC, filename, NULL);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(ppath);
+	p = apol_policy_create_from_policy_path(ppath, 0, NULL, NULL);
+	apol_policy_path_destroy(&ppath);
+	unlink(filename);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(p);
+	q = apol_policy_get_qpol(p);
+
+	/* read comes only from the rule between the attributes */
+	access_check(p, "a_t", "f_t", "file", "read write", "read", "");
+	access_check(p, "b_t", "f_t", "file", "read", "read", "getattr execute");
+	/* g_t is in neither attribute */
+	access_check(p, "b_t", "g_t", "file", "", "", "");
+	access_check(p, "g_t", "f_t", "file", "", "", "");
+	access_check(p, "a_t", "f_t", "dir", "", "", "");
+
+	/* only the enabled branch of each conditional counts */
+	access_check(p, "a_t", "g_t", "file", "getattr read execute", "", "");
+	CU_ASSERT_FATAL(qpol_policy_get_bool_by_name(q, "flag", &b) == 0);
+	CU_ASSERT_FATAL(qpol_bool_set_state(q, b, 0) == 0);
+	CU_ASSERT_FATAL(qpol_policy_get_bool_by_name(q, "other", &b) == 0);
+	CU_ASSERT_FATAL(qpol_bool_set_state(q, b, 1) == 0);
+	access_check(p, "a_t", "g_t", "file", "getattr write", "", "");
+	access_check(p, "a_t", "f_t", "file", "read write", "read", "");
+
+	/* access is only between types */
+	CU_ASSERT(apol_access_compute(p, "domain", "f_t", "file", &access) < 0);
+	CU_ASSERT_EQUAL(errno, EINVAL);
+	CU_ASSERT(apol_access_compute(p, "a_t", "no_such_t", "file", &access) < 0);
+
+	apol_policy_destroy(&p);
+}
+
 CU_TestInfo avrule_tests[] = {
 	{"basic syntactic search", avrule_basic_syn}
 	,
 	{"default query", avrule_default}
 	,
+	{"effective access", avrule_access}
+	,
+	{"effective access sources", avrule_access_sources}
+	,
 	CU_TEST_INFO_NULL
 };
 
@@ -0,0 +1,260 @@
+/**
+ *  @file
+ *
+ *  Test the removal of elements from red-black and hashed BSTs, and
+ *  the string hash function used by hashed BSTs.
+ *
+ *  @author agent agent@local
+ *
+ *  Copyright (C) 2026 agent
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <config.h>
+
+#include <CUnit/CUnit.h>
+#include <apol/bst.h>
+#include <apol/util.h>
+#include <apol/vector.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** number of elements inserted into each BST */
+#define BST_NUM_ELEMS 500
+
+/** width of the element names, so that they sort numerically */
+#define BST_NAME_SZ 16
+
+static size_t num_freed;
+
+/** which elements are currently expected within the BST */
+static unsigned char present[BST_NUM_ELEMS];
+
+static void bst_test_free(void *elem)
+{
+	num_freed++;
+	free(elem);
+}
+
+static char *bst_test_name(size_t i)
+{
+	char *s = malloc(BST_NAME_SZ);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(s);
+	snprintf(s, BST_NAME_SZ, "elem%06zu", i);
+	return s;
+}
+
+/**
+ * Fill an array with a shuffled permutation of 0 .. n - 1, using a
+ * fixed linear congruential generator so that runs are repeatable.
+ */
+static void bst_test_shuffle(size_t * order, size_t n, unsigned long seed)
+{
+	size_t i;
+	for (i = 0; i < n; i++)
+		order[i] = i;
+	for (i = n; i > 1; i--) {
+		size_t j, tmp;
+		seed = seed * 1103515245UL + 12345UL;
+		j = (size_t) ((seed >> 8) % i);
+		tmp = order[i - 1];
+		order[i - 1] = order[j];
+		order[j] = tmp;
+	}
+}
+
+typedef struct bst_test_walk
+{
+	const char *prev;
+	size_t count;
+} bst_test_walk_t;
+
+static int bst_test_visit(void *elem, void *data)
+{
+	bst_test_walk_t *w = data;
+	const char *s = elem;
+	size_t i = (size_t) atoi(s + strlen("elem"));
+	if (w->prev != NULL)
+		CU_ASSERT(strcmp(w->prev, s) < 0);
+	CU_ASSERT(i < BST_NUM_ELEMS && present[i]);
+	w->prev = s;
+	w->count++;
+	return 0;
+}
+
+/**
+ * Check that a BST holds exactly the present elements, in sorted
+ * order, both by traversal and as a vector.
+ */
+static void bst_test_check(apol_bst_t * b, size_t expected_size)
+{
+	bst_test_walk_t w = { NULL, 0 };
+	apol_vector_t *v;
+	size_t i;
+	CU_ASSERT_EQUAL(apol_bst_get_size(b), expected_size);
+	CU_ASSERT(apol_bst_inorder_map(b, bst_test_visit, &w) == 0);
+	CU_ASSERT_EQUAL(w.count, expected_size);
+	v = apol_bst_get_vector(b, 0);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+	CU_ASSERT_EQUAL(apol_vector_get_size(v), expected_size);
+	for (i = 1; i < apol_vector_get_size(v); i++)
+		CU_ASSERT(strcmp(apol_vector_get_element(v, i - 1), apol_vector_get_element(v, i)) < 0);
+	apol_vector_destroy(&v);
+}
+
+/**
+ * Insert elements into a BST in shuffled order, then remove them in
+ * another order, checking the BST's contents after each removal.
+ */
+static void bst_test_insert_remove(apol_bst_t * b)
+{
+	size_t order[BST_NUM_ELEMS], i, size = 0;
+	char key[BST_NAME_SZ];
+	void *result;
+
+	num_freed = 0;
+	memset(present, 0, sizeof(present));
+	bst_test_shuffle(order, BST_NUM_ELEMS, 1);
+	for (i = 0; i < BST_NUM_ELEMS; i++) {
+		char *s = bst_test_name(order[i]);
+		CU_ASSERT(apol_bst_insert(b, s, NULL) == 0);
+		present[order[i]] = 1;
+		size++;
+	}
+	bst_test_check(b, size);
+
+	/* inserting an equal element does not add it, and the caller's
+	 * copy is freed when getting the existing one */
+	{
+		char *s = bst_test_name(order[0]), *orig = s;
+		CU_ASSERT(apol_bst_insert_and_get(b, (void **)&s, NULL) == 1);
+		snprintf(key, sizeof(key), "elem%06zu", order[0]);
+		CU_ASSERT(s != orig);
+		CU_ASSERT_STRING_EQUAL(s, key);
+		CU_ASSERT_EQUAL(num_freed, 1);
+		num_freed = 0;
+	}
+	bst_test_check(b, size);
+
+	bst_test_shuffle(order, BST_NUM_ELEMS, 2);
+	for (i = 0; i < BST_NUM_ELEMS; i++) {
+		snprintf(key, sizeof(key), "elem%06zu", order[i]);
+		if (i % 2 == 0) {
+			/* hand the element back to the caller */
+			result = NULL;
+			CU_ASSERT(apol_bst_remove(b, key, NULL, &result) == 0);
+			CU_ASSERT_PTR_NOT_NULL_FATAL(result);
+			CU_ASSERT(result != (void *)key);
+			CU_ASSERT_STRING_EQUAL(result, key);
+			free(result);
+		} else {
+			/* let the BST free the element */
+			size_t freed = num_freed;
+			CU_ASSERT(apol_bst_remove(b, key, NULL, NULL) == 0);
+			CU_ASSERT_EQUAL(num_freed, freed + 1);
+		}
+		present[order[i]] = 0;
+		size--;
+		/* removing it again finds nothing */
+		result = NULL;
+		CU_ASSERT(apol_bst_remove(b, key, NULL, &result) < 0);
+		CU_ASSERT_PTR_NULL(result);
+		CU_ASSERT(apol_bst_get_element(b, key, NULL, &result) < 0);
+		bst_test_check(b, size);
+	}
+	CU_ASSERT_EQUAL(num_freed, BST_NUM_ELEMS / 2);
+
+	/* removed nodes are reused by later insertions */
+	for (i = 0; i < BST_NUM_ELEMS; i += 3) {
+		CU_ASSERT(apol_bst_insert(b, bst_test_name(i), NULL) == 0);
+		present[i] = 1;
+		size++;
+	}
+	bst_test_check(b, size);
+	for (i = 0; i < BST_NUM_ELEMS; i += 3) {
+		snprintf(key, sizeof(key), "elem%06zu", i);
+		CU_ASSERT(apol_bst_get_element(b, key, NULL, &result) == 0);
+	}
+	num_freed = 0;
+	apol_bst_destroy(&b);
+	CU_ASSERT_PTR_NULL(b);
+	CU_ASSERT_EQUAL(num_freed, size);
+}
+
+static void bst_remove(void)
+{
+	apol_bst_t *b = apol_bst_create(apol_str_strcmp, bst_test_free);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(b);
+	bst_test_insert_remove(b);
+}
+
+static void bst_remove_hashed(void)
+{
+	apol_bst_t *b = apol_bst_create_hashed(apol_str_strcmp, apol_str_hash, bst_test_free);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(b);
+	bst_test_insert_remove(b);
+
+	/* a hashed BST needs a hash function */
+	CU_ASSERT_PTR_NULL(apol_bst_create_hashed(apol_str_strcmp, NULL, NULL));
+}
+
+static void bst_str_hash(void)
+{
+	size_t buckets[64], i, max = 0;
+	char a[BST_NAME_SZ], b[BST_NAME_SZ];
+
+	/* equal strings hash equally, regardless of where they live */
+	strcpy(a, "system_u");
+	strcpy(b, "system_u");
+	CU_ASSERT_EQUAL(apol_str_hash(a, NULL), apol_str_hash(b, NULL));
+	CU_ASSERT(apol_str_hash("system_u", NULL) != apol_str_hash("system_r", NULL));
+	CU_ASSERT(apol_str_hash("", NULL) != apol_str_hash("a", NULL));
+
+	/* names differing only in their last characters still spread
+	 * across the low bits used to pick a bucket */
+	memset(buckets, 0, sizeof(buckets));
+	for (i = 0; i < 64 * 16; i++) {
+		snprintf(a, sizeof(a), "elem%06zu", i);
+		buckets[apol_str_hash(a, NULL) & 63]++;
+	}
+	for (i = 0; i < 64; i++) {
+		CU_ASSERT(buckets[i] > 0);
+		if (buckets[i] > max)
+			max = buckets[i];
+	}
+	CU_ASSERT(max < 16 * 3);
+}
+
+CU_TestInfo bst_tests[] = {
+	{"insert and remove", bst_remove}
+	,
+	{"insert and remove hashed", bst_remove_hashed}
+	,
+	{"string hash", bst_str_hash}
+	,
+	CU_TEST_INFO_NULL
+};
+
+int bst_init()
+{
+	return 0;
+}
+
+int bst_cleanup()
+{
+	return 0;
+}
@@ -29,8 +29,13 @@
 #include <apol/policy.h>
 #include <apol/policy-path.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include <apol/constraint-query.h>
+#include <apol/context-query.h>
+#include <apol/mls_range.h>
+#include <apol/vector.h>
 #include <sepol/policydb/policydb.h>
 #include <sepol/policydb/constraint.h>
 #include <libqpol/src/queue.h>
@@ -476,6 +481,404 @@ static void constrain_binary(void)
 }
 
 
+/**
+ * Build a handful of contexts from the policy's users, each with the
+ * user's first role and range, and one of the first few types.
+ */
+static apol_vector_t *engine_contexts(apol_policy_t * p)
+{
+	qpol_policy_t *q = apol_policy_get_qpol(p);
+	qpol_iterator_t *users = NULL, *roles = NULL, *types = NULL;
+	apol_vector_t *v = apol_vector_create(NULL);
+	size_t num_users = 0, num_types;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+	CU_ASSERT(qpol_policy_get_user_iter(q, &users) == 0);
+	for (; !qpol_iterator_end(users) && num_users < 4; qpol_iterator_next(users), num_users++) {
+		const qpol_user_t *user;
+		const qpol_role_t *role;
+		const qpol_mls_range_t *range = NULL;
+		const char *user_name, *role_name;
+		CU_ASSERT(qpol_iterator_get_item(users, (void **)&user) == 0);
+		CU_ASSERT(qpol_user_get_name(q, user, &user_name) == 0);
+		CU_ASSERT(qpol_user_get_role_iter(q, user, &roles) == 0);
+		if (qpol_iterator_end(roles)) {
+			qpol_iterator_destroy(&roles);
+			continue;
+		}
+		CU_ASSERT(qpol_iterator_get_item(roles, (void **)&role) == 0);
+		CU_ASSERT(qpol_role_get_name(q, role, &role_name) == 0);
+		qpol_iterator_destroy(&roles);
+		if (apol_policy_is_mls(p))
+			CU_ASSERT(qpol_user_get_range(q, user, &range) == 0);
+
+		CU_ASSERT(qpol_policy_get_type_iter(q, &types) == 0);
+		for (num_types = 0; !qpol_iterator_end(types) && num_types < 8; qpol_iterator_next(types)) {
+			const qpol_type_t *type;
+			const char *type_name;
+			unsigned char isattr, isalias;
+			apol_context_t *context = apol_context_create();
+			CU_ASSERT(qpol_iterator_get_item(types, (void **)&type) == 0);
+			CU_ASSERT(qpol_type_get_isattr(q, type, &isattr) == 0);
+			CU_ASSERT(qpol_type_get_isalias(q, type, &isalias) == 0);
+			if (isattr || isalias) {
+				apol_context_destroy(&context);
+				continue;
+			}
+			CU_ASSERT(qpol_type_get_name(q, type, &type_name) == 0);
+			CU_ASSERT(apol_context_set_user(p, context, user_name) == 0);
+			CU_ASSERT(apol_context_set_role(p, context, role_name) == 0);
+			CU_ASSERT(apol_context_set_type(p, context, type_name) == 0);
+			if (range)
+				CU_ASSERT(apol_context_set_range(p, context, apol_mls_range_create_from_qpol_mls_range(p, range)) == 0);
+			CU_ASSERT(apol_vector_append(v, context) == 0);
+			num_types++;
+		}
+		qpol_iterator_destroy(&types);
+	}
+	qpol_iterator_destroy(&users);
+	return v;
+}
+
+/**
+ * Check that evaluating a batch of requests across several threads
+ * gives the same results as checking them one at a time.
+ */
+static void constrain_engine_test(apol_policy_t * p)
+{
+	qpol_policy_t *q = apol_policy_get_qpol(p);
+	qpol_iterator_t *classes = NULL, *perms = NULL;
+	apol_constraint_engine_t *e = apol_constraint_engine_create(p);
+	apol_vector_t *contexts = engine_contexts(p);
+	apol_vector_t *requests = apol_vector_create(apol_constraint_request_free);
+	int *expected = NULL;
+	size_t i, j, num_denied = 0;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(e);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(requests);
+	CU_ASSERT_FATAL(apol_vector_get_size(contexts) > 0);
+
+	CU_ASSERT(qpol_policy_get_class_iter(q, &classes) == 0);
+	for (; !qpol_iterator_end(classes); qpol_iterator_next(classes)) {
+		const qpol_class_t *obj_class;
+		const char *class_name;
+		char *perm;
+		CU_ASSERT(qpol_iterator_get_item(classes, (void **)&obj_class) == 0);
+		CU_ASSERT(qpol_class_get_name(q, obj_class, &class_name) == 0);
+		CU_ASSERT(qpol_class_get_perm_iter(q, obj_class, &perms) == 0);
+		if (qpol_iterator_end(perms)) {
+			qpol_iterator_destroy(&perms);
+			continue;
+		}
+		CU_ASSERT(qpol_iterator_get_item(perms, (void **)&perm) == 0);
+		for (i = 0; i < apol_vector_get_size(contexts); i++) {
+			for (j = 0; j < apol_vector_get_size(contexts); j++) {
+				apol_constraint_request_t *r =
+					apol_constraint_request_create(p, apol_vector_get_element(contexts, i),
+								       apol_vector_get_element(contexts, j), class_name, perm);
+				CU_ASSERT_PTR_NOT_NULL_FATAL(r);
+				CU_ASSERT(apol_constraint_request_get_result(r) < 0);
+				CU_ASSERT(apol_vector_append(requests, r) == 0);
+			}
+		}
+		qpol_iterator_destroy(&perms);
+	}
+	qpol_iterator_destroy(&classes);
+
+	expected = calloc(apol_vector_get_size(requests), sizeof(*expected));
+	CU_ASSERT_PTR_NOT_NULL_FATAL(expected);
+	for (i = 0; i < apol_vector_get_size(requests); i++) {
+		apol_constraint_request_t *r = apol_vector_get_element(requests, i);
+		expected[i] = apol_constraint_engine_check(p, e, r);
+		CU_ASSERT(expected[i] == 0 || expected[i] == 1);
+		if (expected[i] == 0) {
+			CU_ASSERT_PTR_NOT_NULL(apol_constraint_request_get_constraint(r));
+			num_denied++;
+		}
+	}
+	CU_ASSERT(apol_constraint_engine_check_batch(p, e, requests, 4) == 0);
+	for (i = 0; i < apol_vector_get_size(requests); i++)
+		CU_ASSERT_EQUAL(apol_constraint_request_get_result(apol_vector_get_element(requests, i)), expected[i]);
+#ifdef DEBUGTRACE
+	printf("engine: %zu of %zu requests denied\n", num_denied, apol_vector_get_size(requests));
+#endif
+
+	free(expected);
+	apol_vector_destroy(&requests);
+	for (i = 0; i < apol_vector_get_size(contexts); i++) {
+		apol_context_t *context = apol_vector_get_element(contexts, i);
+		apol_context_destroy(&context);
+	}
+	apol_vector_destroy(&contexts);
+	apol_constraint_engine_destroy(&e);
+}
+
+/**
+ * Create a context with the policy's first user and that user's first
+ * role, and with a range from the named sensitivities.
+ */
+static apol_context_t *verdict_context(apol_policy_t * p, const char *type, const char *low, const char *high)
+{
+	qpol_policy_t *q = apol_policy_get_qpol(p);
+	qpol_iterator_t *users = NULL, *roles = NULL;
+	apol_context_t *context = apol_context_create();
+	const char *user_name = NULL, *role_name = NULL;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(context);
+	CU_ASSERT_FATAL(qpol_policy_get_user_iter(q, &users) == 0);
+	for (; !qpol_iterator_end(users) && role_name == NULL; qpol_iterator_next(users)) {
+		const qpol_user_t *user;
+		const qpol_role_t *role;
+		CU_ASSERT_FATAL(qpol_iterator_get_item(users, (void **)&user) == 0);
+		CU_ASSERT_FATAL(qpol_user_get_role_iter(q, user, &roles) == 0);
+		if (!qpol_iterator_end(roles)) {
+			CU_ASSERT_FATAL(qpol_user_get_name(q, user, &user_name) == 0);
+			CU_ASSERT_FATAL(qpol_iterator_get_item(roles, (void **)&role) == 0);
+			CU_ASSERT_FATAL(qpol_role_get_name(q, role, &role_name) == 0);
+		}
+		qpol_iterator_destroy(&roles);
+	}
+	qpol_iterator_destroy(&users);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(role_name);
+	CU_ASSERT(apol_context_set_user(p, context, user_name) == 0);
+	CU_ASSERT(apol_context_set_role(p, context, role_name) == 0);
+	CU_ASSERT(apol_context_set_type(p, context, type) == 0);
+	if (low != NULL) {
+		apol_mls_range_t *range = apol_mls_range_create();
+		apol_mls_level_t *low_level = apol_mls_level_create(), *high_level = apol_mls_level_create();
+		CU_ASSERT_PTR_NOT_NULL_FATAL(range);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(low_level);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(high_level);
+		CU_ASSERT(apol_mls_level_set_sens(p, low_level, low) == 0);
+		CU_ASSERT(apol_mls_level_set_sens(p, high_level, high) == 0);
+		CU_ASSERT(apol_mls_range_set_low(p, range, low_level) == 0);
+		CU_ASSERT(apol_mls_range_set_high(p, range, high_level) == 0);
+		CU_ASSERT(apol_context_set_range(p, context, range) == 0);
+	}
+	return context;
+}
+
+/**
+ * Check a single request's verdict.  A denied request must name a
+ * constraint on the request's class.
+ */
+static void verdict_check(apol_policy_t * p, const apol_constraint_engine_t * e, const apol_context_t * scontext,
+			  const apol_context_t * tcontext, const char *class_name, const char *perm, int expected)
+{
+	qpol_policy_t *q = apol_policy_get_qpol(p);
+	apol_constraint_request_t *r = apol_constraint_request_create(p, scontext, tcontext, class_name, perm);
+	const qpol_constraint_t *constraint;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(r);
+	CU_ASSERT_EQUAL(apol_constraint_engine_check(p, e, r), expected);
+	CU_ASSERT_EQUAL(apol_constraint_request_get_result(r), expected);
+	constraint = apol_constraint_request_get_constraint(r);
+	if (expected == 0) {
+		const qpol_class_t *obj_class;
+		const char *name;
+		CU_ASSERT_PTR_NOT_NULL_FATAL(constraint);
+		CU_ASSERT(qpol_constraint_get_class(q, constraint, &obj_class) == 0);
+		CU_ASSERT(qpol_class_get_name(q, obj_class, &name) == 0);
+		CU_ASSERT_STRING_EQUAL(name, class_name);
+	} else {
+		CU_ASSERT_PTR_NULL(constraint);
+	}
+	apol_constraint_request_destroy(&r);
+}
+
+/**
+ * Get the names of the lowest and highest sensitivities.
+ */
+static void verdict_sensitivities(apol_policy_t * p, const char **lowest, const char **highest)
+{
+	qpol_policy_t *q = apol_policy_get_qpol(p);
+	qpol_iterator_t *iter = NULL;
+	uint32_t low_value = 0, high_value = 0;
+	*lowest = *highest = NULL;
+	CU_ASSERT_FATAL(qpol_policy_get_level_iter(q, &iter) == 0);
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		const qpol_level_t *level;
+		unsigned char isalias;
+		uint32_t value;
+		const char *name;
+		CU_ASSERT_FATAL(qpol_iterator_get_item(iter, (void **)&level) == 0);
+		CU_ASSERT_FATAL(qpol_level_get_isalias(q, level, &isalias) == 0);
+		if (isalias)
+			continue;
+		CU_ASSERT_FATAL(qpol_level_get_value(q, level, &value) == 0);
+		CU_ASSERT_FATAL(qpol_level_get_name(q, level, &name) == 0);
+		if (*lowest == NULL || value < low_value) {
+			*lowest = name;
+			low_value = value;
+		}
+		if (*highest == NULL || value > high_value) {
+			*highest = name;
+			high_value = value;
+		}
+	}
+	qpol_iterator_destroy(&iter);
+	CU_ASSERT_FATAL(*lowest != NULL && low_value < high_value);
+}
+
+/**
+ * Check the engine's verdicts against the expressions listed in
+ * test_list above.
+ */
+static void constrain_engine_verdicts(apol_policy_t * p)
+{
+	qpol_policy_t *q = apol_policy_get_qpol(p);
+	qpol_iterator_t *types = NULL;
+	apol_constraint_engine_t *e = apol_constraint_engine_create(p);
+	const char *lo, *hi, *other = NULL;
+	apol_context_t *sysadm, *other_src, *lo_lo, *lo_hi, *hi_hi, *hi_lo;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(e);
+	CU_ASSERT_FATAL(apol_policy_is_mls(p));
+	verdict_sensitivities(p, &lo, &hi);
+
+	CU_ASSERT_FATAL(qpol_policy_get_type_iter(q, &types) == 0);
+	for (; !qpol_iterator_end(types) && other == NULL; qpol_iterator_next(types)) {
+		const qpol_type_t *type;
+		unsigned char isattr, isalias;
+		const char *name;
+		CU_ASSERT_FATAL(qpol_iterator_get_item(types, (void **)&type) == 0);
+		CU_ASSERT_FATAL(qpol_type_get_isattr(q, type, &isattr) == 0);
+		CU_ASSERT_FATAL(qpol_type_get_isalias(q, type, &isalias) == 0);
+		CU_ASSERT_FATAL(qpol_type_get_name(q, type, &name) == 0);
+		if (!isattr && !isalias && strcmp(name, "sysadm_t") != 0 && strcmp(name, "secadm_t") != 0)
+			other = name;
+	}
+	qpol_iterator_destroy(&types);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(other);
+
+	sysadm = verdict_context(p, "sysadm_t", lo, lo);
+	other_src = verdict_context(p, other, lo, lo);
+	lo_lo = verdict_context(p, other, lo, lo);
+	lo_hi = verdict_context(p, other, lo, hi);
+	hi_hi = verdict_context(p, other, hi, hi);
+	/* the engine evaluates levels as given, so a range whose low
+	 * level is above its high level gives a target that is neither
+	 * dominated by nor dominating the source at both ends */
+	hi_lo = verdict_context(p, other, hi, lo);
+
+	/* dir read: t1 == { sysadm_t secadm_t } */
+	verdict_check(p, e, sysadm, lo_lo, "dir", "read", 1);
+	verdict_check(p, e, other_src, lo_lo, "dir", "read", 0);
+
+	/* file create, relabelto: l2 eq h2 */
+	verdict_check(p, e, lo_lo, lo_lo, "file", "create", 1);
+	verdict_check(p, e, lo_lo, hi_hi, "file", "relabelto", 1);
+	verdict_check(p, e, lo_lo, lo_hi, "file", "create", 0);
+	verdict_check(p, e, lo_lo, lo_hi, "file", "relabelto", 0);
+
+	/* lnk_file create, relabelto: l2 != h2 */
+	verdict_check(p, e, lo_lo, lo_hi, "lnk_file", "create", 1);
+	verdict_check(p, e, lo_lo, lo_lo, "lnk_file", "create", 0);
+	verdict_check(p, e, lo_lo, hi_hi, "lnk_file", "relabelto", 0);
+
+	/* node udp_send: (l1 dom l2) and (l1 domby h2) */
+	verdict_check(p, e, lo_lo, lo_hi, "node", "udp_send", 1);
+	verdict_check(p, e, hi_hi, hi_hi, "node", "udp_send", 1);
+	verdict_check(p, e, hi_hi, lo_lo, "node", "udp_send", 0);
+	verdict_check(p, e, lo_lo, hi_hi, "node", "udp_send", 0);
+
+	/* netif tcp_send: l1 dom l2 or l1 domby h2 */
+	verdict_check(p, e, lo_lo, hi_hi, "netif", "tcp_send", 1);
+	verdict_check(p, e, hi_hi, lo_lo, "netif", "tcp_send", 1);
+	verdict_check(p, e, lo_lo, hi_lo, "netif", "tcp_send", 0);
+
+	apol_context_destroy(&sysadm);
+	apol_context_destroy(&other_src);
+	apol_context_destroy(&lo_lo);
+	apol_context_destroy(&lo_hi);
+	apol_context_destroy(&hi_hi);
+	apol_context_destroy(&hi_lo);
+	apol_constraint_engine_destroy(&e);
+}
+
+static void constrain_engine_source(void)
+{
+	constrain_engine_test(ps);
+	constrain_engine_verdicts(ps);
+}
+
+static void constrain_engine_binary(void)
+{
+	constrain_engine_test(pb);
+	constrain_engine_verdicts(pb);
+}
+
+/**
+ * A policy whose constraints use an attribute, '~', and '*' within
+ * their type sets.
+ */
+static const char *type_set_policy =
+	"class file\n"
+	"class dir\n"
+	"sid kernel\n"
+	"class file { read write }\n"
+	"class dir { read search }\n"
+	"attribute dom;\n"
+	"type foo_t, dom;\n"
+	"type bar_t, dom;\n"
+	"type baz_t;\n"
+	"role r types { foo_t bar_t baz_t };\n"
+	"user u roles { r };\n"
+	"constrain file read ( t1 == dom );\n"
+	"constrain dir read ( t1 == ~{ foo_t } );\n"
+	"constrain dir search ( t2 == * );\n"
+	"sid kernel u:r:foo_t\n";
+
+/**
+ * Check that the engine applies the complement and wildcard flags of
+ * a type set, instead of matching only the names as written.
+ */
+static void constrain_engine_type_sets(void)
+{
+	char filename[] = "/tmp/apol-constrain-XXXXXX";
+	int fd = mkstemp(filename);
+	FILE *fp;
+	apol_policy_path_t *ppath;
+	apol_policy_t *p;
+	apol_constraint_engine_t *e;
+	apol_context_t *foo, *bar, *baz;
+
+	CU_ASSERT_FATAL(fd >= 0);
+	fp = fdopen(fd, "w");
+	CU_ASSERT_PTR_NOT_NULL_FATAL(fp);
+	fputs(type_set_policy, fp);
+	fclose(fp);
+	ppath = apol_policy_path_create(APOL_POLICY_PATH_TYPE_MONOLITHIC, filename, NULL);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(ppath);
+	p = apol_policy_create_from_policy_path(ppath, 0, NULL, NULL);
+	apol_policy_path_destroy(&ppath);
+	unlink(filename);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(p);
+	e = apol_constraint_engine_create(p);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(e);
+
+	foo = verdict_context(p, "foo_t", NULL, NULL);
+	bar = verdict_context(p, "bar_t", NULL, NULL);
+	baz = verdict_context(p, "baz_t", NULL, NULL);
+
+	/* t1 == dom */
+	verdict_check(p, e, foo, baz, "file", "read", 1);
+	verdict_check(p, e, bar, baz, "file", "read", 1);
+	verdict_check(p, e, baz, foo, "file", "read", 0);
+	verdict_check(p, e, baz, foo, "file", "write", 1);
+
+	/* t1 == ~{ foo_t } matches every type other than foo_t */
+	verdict_check(p, e, foo, bar, "dir", "read", 0);
+	verdict_check(p, e, bar, foo, "dir", "read", 1);
+	verdict_check(p, e, baz, foo, "dir", "read", 1);
+
+	/* t2 == * matches every type */
+	verdict_check(p, e, foo, foo, "dir", "search", 1);
+	verdict_check(p, e, foo, baz, "dir", "search", 1);
+
+	apol_context_destroy(&foo);
+	apol_context_destroy(&bar);
+	apol_context_destroy(&baz);
+	apol_constraint_engine_destroy(&e);
+	apol_policy_destroy(&p);
+}
+
+
 static void constrain_modular(void)
 {
 	CU_PASS("Not yet implemented")
@@ -484,6 +887,9 @@ static void constrain_modular(void)
 CU_TestInfo constrain_tests[] = {
 	{"constrain from source policy", constrain_source},
 	{"constrain from binary policy", constrain_binary},
+	{"constraint engine from source policy", constrain_engine_source},
+	{"constraint engine from binary policy", constrain_engine_binary},
+	{"constraint engine type sets", constrain_engine_type_sets},
 //	{"constrain from modular policy", constrain_modular},
 	CU_TEST_INFO_NULL
 };
@@ -484,6 +484,177 @@ static void dta_invalid(void)
 	apol_domain_trans_analysis_destroy(&d);
 }
 
+static void dta_paths(void)
+{
+	apol_domain_trans_analysis_t *d = apol_domain_trans_analysis_create();
+	CU_ASSERT_PTR_NOT_NULL_FATAL(d);
+	int retval = apol_domain_trans_analysis_set_start_type(p, d, "tuna_t");
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+	retval = apol_domain_trans_analysis_set_end_type(p, d, "sand_t");
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+
+	apol_vector_t *v = NULL;
+	retval = apol_domain_trans_analysis_do_paths(p, d, &v);
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+	CU_ASSERT(apol_vector_get_size(v) > 0);
+
+	qpol_policy_t *q = apol_policy_get_qpol(p);
+	size_t i, j, length = 0;
+	for (i = 0; i < apol_vector_get_size(v); i++) {
+		const apol_domain_trans_path_t *path = apol_vector_get_element(v, i);
+		const apol_vector_t *steps = apol_domain_trans_path_get_steps(path);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(steps);
+		if (i == 0)
+			length = apol_domain_trans_path_get_length(path);
+		/* all paths are shortest paths */
+		CU_ASSERT_EQUAL(apol_domain_trans_path_get_length(path), length);
+		CU_ASSERT_EQUAL(apol_vector_get_size(steps), length);
+
+		const qpol_type_t *prev = NULL;
+		const char *name;
+		for (j = 0; j < apol_vector_get_size(steps); j++) {
+			const apol_domain_trans_result_t *dtr = apol_vector_get_element(steps, j);
+			CU_ASSERT(apol_domain_trans_result_is_trans_valid(dtr));
+			const qpol_type_t *qt = apol_domain_trans_result_get_start_type(dtr);
+			if (j == 0) {
+				retval = qpol_type_get_name(q, qt, &name);
+				CU_ASSERT_EQUAL_FATAL(retval, 0);
+				CU_ASSERT_STRING_EQUAL(name, "tuna_t");
+			} else {
+				CU_ASSERT_PTR_EQUAL(qt, prev);
+			}
+			prev = apol_domain_trans_result_get_end_type(dtr);
+		}
+		CU_ASSERT_PTR_NOT_NULL_FATAL(prev);
+		retval = qpol_type_get_name(q, prev, &name);
+		CU_ASSERT_EQUAL_FATAL(retval, 0);
+		CU_ASSERT_STRING_EQUAL(name, "sand_t");
+	}
+	apol_vector_destroy(&v);
+
+	/* no path may be longer than the limit */
+	if (length > 1) {
+		retval = apol_domain_trans_analysis_set_max_depth(p, d, length - 1);
+		CU_ASSERT_EQUAL_FATAL(retval, 0);
+		retval = apol_domain_trans_analysis_do_paths(p, d, &v);
+		CU_ASSERT_EQUAL_FATAL(retval, 0);
+		CU_ASSERT(v != NULL && apol_vector_get_size(v) == 0);
+		apol_vector_destroy(&v);
+	}
+	apol_domain_trans_analysis_destroy(&d);
+}
+
+static void dta_edges(void)
+{
+	apol_domain_trans_edge_list_t *e1 = NULL, *e4 = NULL;
+	int retval = apol_policy_get_domain_trans_edges(p, 1, &e1);
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(e1);
+	retval = apol_policy_get_domain_trans_edges(p, 4, &e4);
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(e4);
+	CU_ASSERT(apol_domain_trans_edge_list_get_size(e1) > 0);
+	CU_ASSERT_EQUAL_FATAL(apol_domain_trans_edge_list_get_size(e1), apol_domain_trans_edge_list_get_size(e4));
+
+	qpol_policy_t *q = apol_policy_get_qpol(p);
+	bool found = false;
+	size_t i;
+	for (i = 0; i < apol_domain_trans_edge_list_get_size(e1); i++) {
+		const qpol_type_t *start = apol_domain_trans_edge_list_get_start_type(e1, i);
+		const qpol_type_t *ep = apol_domain_trans_edge_list_get_entrypoint_type(e1, i);
+		const qpol_type_t *end = apol_domain_trans_edge_list_get_end_type(e1, i);
+		int missing = apol_domain_trans_edge_list_get_missing_rules(e1, i);
+		CU_ASSERT_PTR_NOT_NULL(start);
+		CU_ASSERT_PTR_NOT_NULL(end);
+		CU_ASSERT(missing >= 0);
+
+		/* the result must not depend upon the number of threads */
+		CU_ASSERT_PTR_EQUAL(start, apol_domain_trans_edge_list_get_start_type(e4, i));
+		CU_ASSERT_PTR_EQUAL(ep, apol_domain_trans_edge_list_get_entrypoint_type(e4, i));
+		CU_ASSERT_PTR_EQUAL(end, apol_domain_trans_edge_list_get_end_type(e4, i));
+		CU_ASSERT_EQUAL(missing, apol_domain_trans_edge_list_get_missing_rules(e4, i));
+
+		if (ep != NULL) {
+			CU_ASSERT_EQUAL(missing == 0, apol_domain_trans_table_verify_trans(p, start, ep, end) == 0);
+		}
+
+		const char *start_name, *ep_name, *end_name;
+		if (ep != NULL && qpol_type_get_name(q, start, &start_name) == 0 && qpol_type_get_name(q, ep, &ep_name) == 0 &&
+		    qpol_type_get_name(q, end, &end_name) == 0 && strcmp(start_name, "tuna_t") == 0 &&
+		    strcmp(ep_name, "net_t") == 0 && strcmp(end_name, "boat_t") == 0) {
+			CU_ASSERT(apol_domain_trans_edge_list_is_trans_valid(e1, i));
+			found = true;
+		}
+	}
+	CU_ASSERT(found);
+	apol_domain_trans_edge_list_destroy(&e1);
+	apol_domain_trans_edge_list_destroy(&e4);
+	CU_ASSERT_PTR_NULL(e1);
+}
+
+/**
+ * Run a forward analysis from a start type, without first resetting
+ * the table, and return the number of valid transitions found.  If
+ * an end type is given then it must be among the results.
+ */
+static size_t dta_forward_count(const char *start, const char *end)
+{
+	apol_domain_trans_analysis_t *d = apol_domain_trans_analysis_create();
+	CU_ASSERT_PTR_NOT_NULL_FATAL(d);
+	int retval = apol_domain_trans_analysis_set_direction(p, d, APOL_DOMAIN_TRANS_DIRECTION_FORWARD);
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+	retval = apol_domain_trans_analysis_set_start_type(p, d, start);
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+
+	apol_vector_t *v = NULL;
+	retval = apol_domain_trans_analysis_do(p, d, &v);
+	apol_domain_trans_analysis_destroy(&d);
+	CU_ASSERT_EQUAL_FATAL(retval, 0);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+
+	qpol_policy_t *q = apol_policy_get_qpol(p);
+	bool found = false;
+	size_t i, num_results = apol_vector_get_size(v);
+	for (i = 0; i < num_results; i++) {
+		const apol_domain_trans_result_t *dtr = (const apol_domain_trans_result_t *)apol_vector_get_element(v, i);
+		const char *name;
+		retval = qpol_type_get_name(q, apol_domain_trans_result_get_end_type(dtr), &name);
+		CU_ASSERT_EQUAL_FATAL(retval, 0);
+		if (end != NULL && strcmp(name, end) == 0)
+			found = true;
+	}
+	if (end != NULL)
+		CU_ASSERT(found);
+	apol_vector_destroy(&v);
+	return num_results;
+}
+
+static void dta_reset(void)
+{
+	apol_policy_reset_domain_trans_table(p);
+	size_t num_tuna = dta_forward_count("tuna_t", "boat_t");
+	CU_ASSERT(num_tuna > 0);
+
+	/* without a reset, the rules used by the first analysis are not
+	 * used again, so no valid transition remains */
+	CU_ASSERT_EQUAL(dta_forward_count("tuna_t", NULL), 0);
+
+	/* each reset starts a new generation in which every rule is
+	 * unused, however many generations came before */
+	size_t i;
+	for (i = 0; i < 100; i++) {
+		apol_policy_reset_domain_trans_table(p);
+		CU_ASSERT_EQUAL(dta_forward_count("tuna_t", "boat_t"), num_tuna);
+		apol_policy_reset_domain_trans_table(p);
+		CU_ASSERT_EQUAL(dta_forward_count("shark_t", "surf_t"), 2);
+	}
+	for (i = 0; i < 100000; i++)
+		apol_policy_reset_domain_trans_table(p);
+	CU_ASSERT_EQUAL(dta_forward_count("shark_t", "sand_t"), 2);
+	CU_ASSERT_EQUAL(dta_forward_count("shark_t", NULL), 0);
+}
+
 CU_TestInfo dta_tests[] = {
 	{"dta forward", dta_forward}
 	,
@@ -499,6 +670,12 @@ CU_TestInfo dta_tests[] = {
 	,
 	{"dta invalid transitions", dta_invalid}
 	,
+	{"dta multi-hop paths", dta_paths}
+	,
+	{"dta whole policy edges", dta_edges}
+	,
+	{"dta table reset", dta_reset}
+	,
 	CU_TEST_INFO_NULL
 };
 
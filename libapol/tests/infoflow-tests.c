@@ -30,11 +30,17 @@
 #include <apol/perm-map.h>
 #include <apol/policy.h>
 #include <apol/policy-path.h>
+#include <apol/util.h>
+#include <ctype.h>
 #include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #define BIG_POLICY TEST_POLICIES "/snapshots/fc4_targeted.policy.conf"
 #define PERMMAP TOP_SRCDIR "/apol/perm_maps/apol_perm_mapping_ver19"
+#define PERMMAP_LINE_SZ 8192
 
 static apol_policy_t *p = NULL;
 
@@ -96,11 +102,226 @@ static void infoflow_trans_overview(void)
 	apol_infoflow_graph_destroy(&g);
 }
 
+/**
+ * A single permission mapping read from a permission map file.
+ */
+typedef struct permmap_entry
+{
+	char *class_name, *perm_name;
+	int map, weight;
+} permmap_entry_t;
+
+static void permmap_entry_free(void *elem)
+{
+	permmap_entry_t *e = elem;
+	if (e != NULL) {
+		free(e->class_name);
+		free(e->perm_name);
+		free(e);
+	}
+}
+
+/**
+ * Read a permission map file into a list of entries, without
+ * consulting the policy.
+ */
+static apol_vector_t *permmap_read_entries(const char *filename)
+{
+	apol_vector_t *v = apol_vector_create(permmap_entry_free);
+	FILE *fp = fopen(filename, "r");
+	char line[PERMMAP_LINE_SZ], class_name[PERMMAP_LINE_SZ] = "", name[PERMMAP_LINE_SZ];
+	int have_count = 0;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(fp);
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		char mapid;
+		int weight;
+		size_t num;
+		permmap_entry_t *e;
+		apol_str_trim(line);
+		if (line[0] == '#' || apol_str_is_only_white_space(line))
+			continue;
+		if (!have_count) {
+			have_count = (sscanf(line, "%zu", &num) == 1);
+			continue;
+		}
+		if (sscanf(line, "class %s %zu", class_name, &num) == 2)
+			continue;
+		if (sscanf(line, "%s %c %d", name, &mapid, &weight) != 3) {
+			CU_ASSERT(sscanf(line, "%s %c", name, &mapid) == 2);
+			weight = APOL_PERMMAP_MAX_WEIGHT;
+		}
+		if (weight > APOL_PERMMAP_MAX_WEIGHT)
+			weight = APOL_PERMMAP_MAX_WEIGHT;
+		else if (weight < APOL_PERMMAP_MIN_WEIGHT)
+			weight = APOL_PERMMAP_MIN_WEIGHT;
+		e = calloc(1, sizeof(*e));
+		CU_ASSERT_PTR_NOT_NULL_FATAL(e);
+		e->class_name = strdup(class_name);
+		e->perm_name = strdup(name);
+		e->weight = weight;
+		switch (tolower(mapid)) {
+		case 'r':
+			e->map = APOL_PERMMAP_READ;
+			break;
+		case 'w':
+			e->map = APOL_PERMMAP_WRITE;
+			break;
+		case 'b':
+			e->map = APOL_PERMMAP_BOTH;
+			break;
+		case 'n':
+			e->map = APOL_PERMMAP_NONE;
+			break;
+		default:
+			e->map = APOL_PERMMAP_UNMAPPED;
+		}
+		CU_ASSERT(apol_vector_append(v, e) == 0);
+	}
+	fclose(fp);
+	return v;
+}
+
+/**
+ * Find the mapping of a permission by comparing names against every
+ * entry read from the file.  Later entries override earlier ones, as
+ * they do when the file is loaded.
+ */
+static const permmap_entry_t *permmap_find_entry(const apol_vector_t * entries, const char *class_name, const char *perm_name)
+{
+	const permmap_entry_t *found = NULL;
+	size_t i;
+	for (i = 0; i < apol_vector_get_size(entries); i++) {
+		const permmap_entry_t *e = apol_vector_get_element(entries, i);
+		if (strcmp(e->class_name, class_name) == 0 && strcmp(e->perm_name, perm_name) == 0)
+			found = e;
+	}
+	return found;
+}
+
+static void permmap_check_perms(const apol_vector_t * entries, const char *class_name, qpol_iterator_t * iter,
+				size_t * num_mapped, size_t * num_unmapped)
+{
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		char *perm_name;
+		const permmap_entry_t *e;
+		int map = -1, weight = -1;
+		CU_ASSERT(qpol_iterator_get_item(iter, (void **)&perm_name) == 0);
+		e = permmap_find_entry(entries, class_name, perm_name);
+		CU_ASSERT(apol_policy_get_permmap(p, class_name, perm_name, &map, &weight) == 0);
+		if (e != NULL) {
+			CU_ASSERT_EQUAL(map, e->map);
+			CU_ASSERT_EQUAL(weight, e->weight);
+			(*num_mapped)++;
+		} else {
+			CU_ASSERT_EQUAL(map, APOL_PERMMAP_UNMAPPED);
+			CU_ASSERT_EQUAL(weight, APOL_PERMMAP_MIN_WEIGHT);
+			(*num_unmapped)++;
+		}
+	}
+}
+
+/**
+ * Load a permission map, and check that looking up every permission
+ * of every class of the policy gives the same mapping as comparing
+ * names against the file.  Also check that classes and permissions
+ * named within the file but not within the policy are not found.
+ */
+static void permmap_check_file(const char *filename, size_t * num_mapped, size_t * num_unmapped)
+{
+	qpol_policy_t *q = apol_policy_get_qpol(p);
+	qpol_iterator_t *class_iter = NULL, *perm_iter = NULL;
+	apol_vector_t *entries = permmap_read_entries(filename);
+	size_t i;
+	*num_mapped = *num_unmapped = 0;
+	CU_ASSERT(apol_policy_open_permmap(p, filename) >= 0);
+
+	CU_ASSERT_FATAL(qpol_policy_get_class_iter(q, &class_iter) == 0);
+	for (; !qpol_iterator_end(class_iter); qpol_iterator_next(class_iter)) {
+		const qpol_class_t *c;
+		const qpol_common_t *common;
+		const char *class_name;
+		CU_ASSERT(qpol_iterator_get_item(class_iter, (void **)&c) == 0);
+		CU_ASSERT(qpol_class_get_name(q, c, &class_name) == 0);
+		CU_ASSERT(qpol_class_get_perm_iter(q, c, &perm_iter) == 0);
+		permmap_check_perms(entries, class_name, perm_iter, num_mapped, num_unmapped);
+		qpol_iterator_destroy(&perm_iter);
+		CU_ASSERT(qpol_class_get_common(q, c, &common) == 0);
+		if (common != NULL) {
+			CU_ASSERT(qpol_common_get_perm_iter(q, common, &perm_iter) == 0);
+			permmap_check_perms(entries, class_name, perm_iter, num_mapped, num_unmapped);
+			qpol_iterator_destroy(&perm_iter);
+		}
+	}
+	qpol_iterator_destroy(&class_iter);
+
+	for (i = 0; i < apol_vector_get_size(entries); i++) {
+		const permmap_entry_t *e = apol_vector_get_element(entries, i);
+		const qpol_class_t *c;
+		uint32_t value;
+		int map, weight;
+		if (qpol_policy_get_class_by_name(q, e->class_name, &c) == 0 &&
+		    qpol_class_get_perm_value(q, c, e->perm_name, &value) == 0) {
+			continue;
+		}
+		CU_ASSERT(apol_policy_get_permmap(p, e->class_name, e->perm_name, &map, &weight) < 0);
+	}
+	apol_vector_destroy(&entries);
+}
+
+static void infoflow_permmap_lookup(void)
+{
+	size_t num_mapped, num_unmapped;
+	int map, weight;
+	permmap_check_file(PERMMAP, &num_mapped, &num_unmapped);
+	CU_ASSERT(num_mapped > 0);
+	CU_ASSERT(apol_policy_get_permmap(p, "no_such_class", "read", &map, &weight) < 0);
+	CU_ASSERT(apol_policy_get_permmap(p, "file", "no_such_perm", &map, &weight) < 0);
+
+	/* a changed mapping is seen by the next lookup */
+	CU_ASSERT(apol_policy_set_permmap(p, "file", "read", APOL_PERMMAP_WRITE, 3) == 0);
+	CU_ASSERT(apol_policy_get_permmap(p, "file", "read", &map, &weight) == 0);
+	CU_ASSERT_EQUAL(map, APOL_PERMMAP_WRITE);
+	CU_ASSERT_EQUAL(weight, 3);
+	CU_ASSERT(apol_policy_set_permmap(p, "no_such_class", "read", APOL_PERMMAP_WRITE, 3) < 0);
+
+	/* restore the map for the other tests */
+	CU_ASSERT(apol_policy_open_permmap(p, PERMMAP) >= 0);
+}
+
+static void infoflow_permmap_partial(void)
+{
+	char filename[] = "/tmp/apol-permmap-XXXXXX";
+	size_t num_mapped, num_unmapped;
+	int fd = mkstemp(filename);
+	FILE *fp;
+	CU_ASSERT_FATAL(fd >= 0);
+	fp = fdopen(fd, "w");
+	CU_ASSERT_PTR_NOT_NULL_FATAL(fp);
+	/* map only some of file's permissions, and also name a class
+	 * and a permission that the policy does not have */
+	fprintf(fp, "# partial map\n3\n");
+	fprintf(fp, "class file 3\nread r 5\nwrite W\nno_such_perm b 2\n");
+	fprintf(fp, "class no_such_class 1\nread r 10\n");
+	fprintf(fp, "class dir 1\nsearch n 20\n");
+	fclose(fp);
+	permmap_check_file(filename, &num_mapped, &num_unmapped);
+	CU_ASSERT_EQUAL(num_mapped, 3);
+	CU_ASSERT(num_unmapped > 0);
+	unlink(filename);
+
+	CU_ASSERT(apol_policy_open_permmap(p, PERMMAP) >= 0);
+}
+
 CU_TestInfo infoflow_tests[] = {
 	{"infoflow direct overview", infoflow_direct_overview}
 	,
 	{"infoflow trans overview", infoflow_trans_overview}
 	,
+	{"permission map lookups", infoflow_permmap_lookup}
+	,
+	{"partial permission map", infoflow_permmap_partial}
+	,
 	CU_TEST_INFO_NULL
 };
 
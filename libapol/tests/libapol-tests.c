@@ -36,6 +36,13 @@
 #include "terule-tests.h"
 #include "constrain-tests.h"
 #include "user-tests.h"
+#include "relabel-tests.h"
+#include "mls-tests.h"
+#include "netcon-tests.h"
+#include "types-relation-tests.h"
+#include "bst-tests.h"
+#include "render-tests.h"
+#include "vector-tests.h"
 
 int main(void)
 {
@@ -52,6 +59,13 @@ int main(void)
 		{"TE Rule Query", terule_init, terule_cleanup, terule_tests},
 		{"User Query", user_init, user_cleanup, user_tests},
 		{"Constrain query", constrain_init, constrain_cleanup, constrain_tests},
+		{"Relabel Analysis", relabel_init, relabel_cleanup, relabel_tests},
+		{"MLS Level", mls_init, mls_cleanup, mls_tests},
+		{"Netcon Resolution", netcon_init, netcon_cleanup, netcon_tests},
+		{"Types Relation Analysis", types_relation_init, types_relation_cleanup, types_relation_tests},
+		{"BST", bst_init, bst_cleanup, bst_tests},
+		{"Render", render_init, render_cleanup, render_tests},
+		{"Vector", vector_init, vector_cleanup, vector_tests},
 		CU_SUITE_INFO_NULL
 	};
 
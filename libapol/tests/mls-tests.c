@@ -0,0 +1,319 @@
+/**
+ *  @file
+ *
+ *  Test MLS level comparison and validation, checking the results
+ *  against a comparison of names for every pair of levels within a
+ *  policy, and after switching the levels to other policies.
+ *
+ *  @author agent agent@local
+ *
+ *  Copyright (C) 2026 agent
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <config.h>
+
+#include <CUnit/CUnit.h>
+#include <apol/mls-query.h>
+#include <apol/policy.h>
+#include <apol/policy-path.h>
+#include <apol/util.h>
+#include <qpol/mls_query.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define POLICY_A TEST_POLICIES "/setools-3.3/rules/rules-mls.conf"
+#define POLICY_B TEST_POLICIES "/setools/apol/user_mls_testing_policy.conf"
+#define POLICY_C TEST_POLICIES "/setools-3.2/apol/rangetrans_testing_policy.conf"
+
+/** maximum number of levels to build from each policy */
+#define MLS_MAX_LEVELS 48
+
+static apol_policy_t *open_policy(const char *path)
+{
+	apol_policy_t *p;
+	apol_policy_path_t *ppath = apol_policy_path_create(APOL_POLICY_PATH_TYPE_MONOLITHIC, path, NULL);
+	if (ppath == NULL) {
+		return NULL;
+	}
+	p = apol_policy_create_from_policy_path(ppath, QPOL_POLICY_OPTION_NO_RULES, NULL, NULL);
+	apol_policy_path_destroy(&ppath);
+	return p;
+}
+
+static void level_free(void *level)
+{
+	apol_mls_level_t *l = level;
+	apol_mls_level_destroy(&l);
+}
+
+static void levels_append(apol_policy_t * p, apol_vector_t * levels, const char *sens, const apol_vector_t * cats, size_t first,
+			  size_t last)
+{
+	apol_mls_level_t *l = apol_mls_level_create();
+	size_t i;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(l);
+	CU_ASSERT(apol_mls_level_set_sens(p, l, sens) == 0);
+	for (i = first; i < last; i++) {
+		CU_ASSERT(apol_mls_level_append_cats(p, l, apol_vector_get_element(cats, i)) == 0);
+	}
+	CU_ASSERT(apol_vector_append(levels, l) == 0);
+}
+
+/**
+ * Build levels from each of a policy's sensitivities: with no
+ * categories, with all that the sensitivity permits, with only the
+ * first, and with all but the first.
+ */
+static apol_vector_t *policy_levels(apol_policy_t * p)
+{
+	qpol_policy_t *q = apol_policy_get_qpol(p);
+	qpol_iterator_t *iter = NULL, *cat_iter = NULL;
+	apol_vector_t *levels = apol_vector_create(level_free);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(levels);
+	CU_ASSERT_FATAL(qpol_policy_get_level_iter(q, &iter) == 0);
+	for (; !qpol_iterator_end(iter) && apol_vector_get_size(levels) < MLS_MAX_LEVELS; qpol_iterator_next(iter)) {
+		const qpol_level_t *level;
+		const char *sens;
+		unsigned char isalias;
+		apol_vector_t *cats = apol_vector_create(NULL);
+		size_t n;
+		CU_ASSERT_PTR_NOT_NULL_FATAL(cats);
+		CU_ASSERT(qpol_iterator_get_item(iter, (void **)&level) == 0);
+		CU_ASSERT(qpol_level_get_isalias(q, level, &isalias) == 0);
+		if (isalias) {
+			apol_vector_destroy(&cats);
+			continue;
+		}
+		CU_ASSERT(qpol_level_get_name(q, level, &sens) == 0);
+		CU_ASSERT(qpol_level_get_cat_iter(q, level, &cat_iter) == 0);
+		for (; !qpol_iterator_end(cat_iter); qpol_iterator_next(cat_iter)) {
+			const qpol_cat_t *cat;
+			const char *cat_name;
+			CU_ASSERT(qpol_iterator_get_item(cat_iter, (void **)&cat) == 0);
+			CU_ASSERT(qpol_cat_get_name(q, cat, &cat_name) == 0);
+			CU_ASSERT(apol_vector_append(cats, (void *)cat_name) == 0);
+		}
+		qpol_iterator_destroy(&cat_iter);
+		n = apol_vector_get_size(cats);
+		levels_append(p, levels, sens, cats, 0, 0);
+		if (n > 0) {
+			levels_append(p, levels, sens, cats, 0, n);
+			levels_append(p, levels, sens, cats, 0, 1);
+		}
+		if (n > 1) {
+			levels_append(p, levels, sens, cats, 1, n);
+		}
+		apol_vector_destroy(&cats);
+	}
+	qpol_iterator_destroy(&iter);
+	CU_ASSERT(apol_vector_get_size(levels) > 0);
+	return levels;
+}
+
+/**
+ * Return 1 if a level's sensitivity and categories are all declared
+ * within a policy.
+ */
+static int level_names_exist(apol_policy_t * p, const apol_mls_level_t * l)
+{
+	qpol_policy_t *q = apol_policy_get_qpol(p);
+	const apol_vector_t *cats = apol_mls_level_get_cats(l);
+	const qpol_level_t *level;
+	const qpol_cat_t *cat;
+	size_t i;
+	if (qpol_policy_get_level_by_name(q, apol_mls_level_get_sens(l), &level) < 0)
+		return 0;
+	for (i = 0; i < apol_vector_get_size(cats); i++) {
+		if (qpol_policy_get_cat_by_name(q, apol_vector_get_element(cats, i), &cat) < 0)
+			return 0;
+	}
+	return 1;
+}
+
+/** Return 1 if every category name of a is within b. */
+static int cats_subset(const apol_mls_level_t * a, const apol_mls_level_t * b)
+{
+	const apol_vector_t *acats = apol_mls_level_get_cats(a), *bcats = apol_mls_level_get_cats(b);
+	size_t i, j;
+	for (i = 0; i < apol_vector_get_size(acats); i++) {
+		if (apol_vector_get_index(bcats, apol_vector_get_element(acats, i), apol_str_strcmp, NULL, &j) < 0)
+			return 0;
+	}
+	return 1;
+}
+
+static uint32_t sens_value(apol_policy_t * p, const apol_mls_level_t * l)
+{
+	qpol_policy_t *q = apol_policy_get_qpol(p);
+	const qpol_level_t *level;
+	uint32_t value = 0;
+	CU_ASSERT(qpol_policy_get_level_by_name(q, apol_mls_level_get_sens(l), &level) == 0);
+	CU_ASSERT(qpol_level_get_value(q, level, &value) == 0);
+	return value;
+}
+
+/**
+ * Compare two levels by name, using the sensitivities' order within
+ * the given policy.
+ */
+static int expected_compare(apol_policy_t * p, const apol_mls_level_t * l1, const apol_mls_level_t * l2)
+{
+	uint32_t s1 = sens_value(p, l1), s2 = sens_value(p, l2);
+	int sub12 = cats_subset(l1, l2), sub21 = cats_subset(l2, l1);
+	if (s1 == s2 && sub12 && sub21)
+		return APOL_MLS_EQ;
+	if (s1 >= s2 && sub21)
+		return APOL_MLS_DOM;
+	if (s1 <= s2 && sub12)
+		return APOL_MLS_DOMBY;
+	return APOL_MLS_INCOMP;
+}
+
+/**
+ * Determine by name if a level's categories are all permitted by its
+ * sensitivity within the given policy.
+ */
+static int expected_validate(apol_policy_t * p, const apol_mls_level_t * l)
+{
+	qpol_policy_t *q = apol_policy_get_qpol(p);
+	const apol_vector_t *cats = apol_mls_level_get_cats(l);
+	const qpol_level_t *level;
+	qpol_iterator_t *iter = NULL;
+	apol_vector_t *permitted = apol_vector_create(NULL);
+	size_t i, j;
+	int retval = 1;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(permitted);
+	CU_ASSERT(qpol_policy_get_level_by_name(q, apol_mls_level_get_sens(l), &level) == 0);
+	CU_ASSERT(qpol_level_get_cat_iter(q, level, &iter) == 0);
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		const qpol_cat_t *cat;
+		const char *cat_name;
+		CU_ASSERT(qpol_iterator_get_item(iter, (void **)&cat) == 0);
+		CU_ASSERT(qpol_cat_get_name(q, cat, &cat_name) == 0);
+		CU_ASSERT(apol_vector_append(permitted, (void *)cat_name) == 0);
+	}
+	qpol_iterator_destroy(&iter);
+	for (i = 0; retval && i < apol_vector_get_size(cats); i++) {
+		if (apol_vector_get_index(permitted, apol_vector_get_element(cats, i), apol_str_strcmp, NULL, &j) < 0)
+			retval = 0;
+	}
+	apol_vector_destroy(&permitted);
+	return retval;
+}
+
+/**
+ * Compare and validate every pair of levels whose names are declared
+ * within a policy, and check each against the name comparison.
+ *
+ * @return Number of levels that were checked.
+ */
+static size_t check_levels(apol_policy_t * p, const apol_vector_t * levels)
+{
+	size_t i, j, num_checked = 0;
+	for (i = 0; i < apol_vector_get_size(levels); i++) {
+		const apol_mls_level_t *l1 = apol_vector_get_element(levels, i);
+		if (!level_names_exist(p, l1))
+			continue;
+		num_checked++;
+		CU_ASSERT_EQUAL(apol_mls_level_validate(p, l1), expected_validate(p, l1));
+		for (j = 0; j < apol_vector_get_size(levels); j++) {
+			const apol_mls_level_t *l2 = apol_vector_get_element(levels, j);
+			if (!level_names_exist(p, l2))
+				continue;
+			CU_ASSERT_EQUAL(apol_mls_level_compare(p, l1, l2), expected_compare(p, l1, l2));
+		}
+	}
+	return num_checked;
+}
+
+static void mls_level_compare_validate(void)
+{
+	apol_policy_t *p = open_policy(POLICY_A);
+	apol_vector_t *levels;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(p);
+	levels = policy_levels(p);
+	CU_ASSERT(check_levels(p, levels) == apol_vector_get_size(levels));
+
+	/* a category not within the policy makes a level invalid, but
+	 * such a level cannot be compared */
+	CU_ASSERT_FATAL(apol_vector_get_size(levels) > 0);
+	apol_mls_level_t *known = apol_vector_get_element(levels, 0);
+	apol_mls_level_t *unknown = apol_mls_level_create_from_mls_level(known);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(unknown);
+	CU_ASSERT(apol_mls_level_append_cats(p, unknown, "no_such_category") == 0);
+	CU_ASSERT(apol_mls_level_validate(p, unknown) == 0);
+	CU_ASSERT(apol_mls_level_compare(p, known, unknown) < 0);
+	apol_mls_level_destroy(&unknown);
+
+	apol_vector_destroy(&levels);
+	apol_policy_destroy(&p);
+}
+
+/**
+ * Compare the same levels within several policies, both while the
+ * earlier policies are still open and after they are destroyed (when
+ * the next policy may well be allocated at the same address).
+ */
+static void mls_level_switch_policies(void)
+{
+	apol_policy_t *a = open_policy(POLICY_A), *b = open_policy(POLICY_B), *c = NULL;
+	apol_vector_t *levels_a, *levels_b;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(a);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(b);
+	levels_a = policy_levels(a);
+	levels_b = policy_levels(b);
+
+	CU_ASSERT(check_levels(a, levels_a) > 0);
+	CU_ASSERT(check_levels(b, levels_b) > 0);
+	check_levels(b, levels_a);
+	check_levels(a, levels_b);
+	check_levels(a, levels_a);
+
+	apol_policy_destroy(&a);
+	c = open_policy(POLICY_C);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(c);
+	check_levels(c, levels_a);
+	check_levels(c, levels_b);
+	apol_policy_destroy(&c);
+	a = open_policy(POLICY_A);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(a);
+	CU_ASSERT(check_levels(a, levels_a) == apol_vector_get_size(levels_a));
+	check_levels(a, levels_b);
+
+	apol_vector_destroy(&levels_a);
+	apol_vector_destroy(&levels_b);
+	apol_policy_destroy(&a);
+	apol_policy_destroy(&b);
+}
+
+CU_TestInfo mls_tests[] = {
+	{"level compare and validate", mls_level_compare_validate}
+	,
+	{"level compare after switching policies", mls_level_switch_policies}
+	,
+	CU_TEST_INFO_NULL
+};
+
+int mls_init()
+{
+	return 0;
+}
+
+int mls_cleanup()
+{
+	return 0;
+}
@@ -0,0 +1,233 @@
+/**
+ *  @file
+ *
+ *  Test the best-match portcon and nodecon resolution against a small
+ *  policy whose statements overlap in known ways.
+ *
+ *  @author agent agent@local
+ *
+ *  Copyright (C) 2026 agent
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <config.h>
+
+#include <CUnit/CUnit.h>
+#include <apol/netcon-query.h>
+#include <apol/policy.h>
+#include <apol/policy-path.h>
+#include <apol/util.h>
+#include <qpol/context_query.h>
+#include <qpol/nodecon_query.h>
+#include <qpol/portcon_query.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * A policy whose portcons include a port within a later range, and
+ * ranges that partially overlap, and whose nodecons include nested
+ * networks and a netmask that is not a prefix.
+ */
+static const char *netcon_policy =
+	"class file\n"
+	"sid kernel\n"
+	"sid port\n"
+	"sid node\n"
+	"class file { read }\n"
+	"type default_t;\n"
+	"type http_t;\n"
+	"type reserved_t;\n"
+	"type mid_t;\n"
+	"type dns_t;\n"
+	"type net10_t;\n"
+	"type net10_1_t;\n"
+	"type lo_t;\n"
+	"type odd_t;\n"
+	"type lo6_t;\n"
+	"type doc_t;\n"
+	"role r types { default_t http_t reserved_t mid_t dns_t net10_t net10_1_t lo_t odd_t lo6_t doc_t };\n"
+	"user u roles { r };\n"
+	"sid kernel u:r:default_t\n"
+	"sid port u:r:default_t\n"
+	"sid node u:r:default_t\n"
+	"portcon tcp 80 u:r:http_t\n"
+	"portcon tcp 1-1023 u:r:reserved_t\n"
+	"portcon tcp 1000-2000 u:r:mid_t\n"
+	"portcon udp 53 u:r:dns_t\n"
+	"nodecon 10.0.0.0 255.0.0.0 u:r:net10_t\n"
+	"nodecon 10.1.0.0 255.255.0.0 u:r:net10_1_t\n"
+	"nodecon 127.0.0.1 255.255.255.255 u:r:lo_t\n"
+	"nodecon 192.168.0.1 255.255.0.255 u:r:odd_t\n"
+	"nodecon ::1 ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff u:r:lo6_t\n"
+	"nodecon 2001:db8:: ffff:ffff:: u:r:doc_t\n";
+
+static apol_policy_t *p = NULL;
+
+/**
+ * Return the name of the type within a context, or NULL if there is
+ * no context.
+ */
+static const char *context_type_name(const qpol_context_t * context)
+{
+	qpol_policy_t *q = apol_policy_get_qpol(p);
+	const qpol_type_t *type;
+	const char *name;
+	if (context == NULL)
+		return NULL;
+	CU_ASSERT_FATAL(qpol_context_get_type(q, context, &type) == 0);
+	CU_ASSERT_FATAL(qpol_type_get_name(q, type, &name) == 0);
+	return name;
+}
+
+/**
+ * Check that a port resolves to the portcon labeling it with the
+ * given type, or to no portcon if type_name is NULL.
+ */
+static void check_portcon(int proto, uint16_t port, const char *type_name)
+{
+	qpol_policy_t *q = apol_policy_get_qpol(p);
+	const qpol_portcon_t *found = (const qpol_portcon_t *)1;
+	const qpol_context_t *context = NULL;
+	const char *name;
+	CU_ASSERT_FATAL(apol_portcon_resolve(p, proto, port, &found) == 0);
+	if (found != NULL)
+		CU_ASSERT_FATAL(qpol_portcon_get_context(q, found, &context) == 0);
+	name = context_type_name(context);
+	if (type_name == NULL) {
+		CU_ASSERT_PTR_NULL(name);
+	} else {
+		CU_ASSERT(name != NULL && strcmp(name, type_name) == 0);
+	}
+}
+
+/**
+ * Check that an address resolves to the nodecon labeling it with the
+ * given type, or to no nodecon if type_name is NULL.
+ */
+static void check_nodecon(const char *addr_str, const char *type_name)
+{
+	qpol_policy_t *q = apol_policy_get_qpol(p);
+	const qpol_nodecon_t *found = (const qpol_nodecon_t *)1;
+	const qpol_context_t *context = NULL;
+	const char *name;
+	uint32_t addr[4];
+	int proto = apol_str_to_internal_ip(addr_str, addr);
+	CU_ASSERT_FATAL(proto == QPOL_IPV4 || proto == QPOL_IPV6);
+	CU_ASSERT_FATAL(apol_nodecon_resolve(p, addr, proto, &found) == 0);
+	if (found != NULL)
+		CU_ASSERT_FATAL(qpol_nodecon_get_context(q, found, &context) == 0);
+	name = context_type_name(context);
+	if (type_name == NULL) {
+		CU_ASSERT_PTR_NULL(name);
+	} else {
+		CU_ASSERT(name != NULL && strcmp(name, type_name) == 0);
+	}
+}
+
+static void netcon_portcon_resolve(void)
+{
+	check_portcon(IPPROTO_TCP, 80, "http_t");
+	check_portcon(IPPROTO_TCP, 79, "reserved_t");
+	check_portcon(IPPROTO_TCP, 1, "reserved_t");
+	check_portcon(IPPROTO_TCP, 1023, "reserved_t");
+	/* both later ranges include 1000, but the earlier one wins */
+	check_portcon(IPPROTO_TCP, 1000, "reserved_t");
+	check_portcon(IPPROTO_TCP, 1024, "mid_t");
+	check_portcon(IPPROTO_TCP, 2000, "mid_t");
+	check_portcon(IPPROTO_TCP, 0, NULL);
+	check_portcon(IPPROTO_TCP, 2001, NULL);
+	check_portcon(IPPROTO_TCP, UINT16_MAX, NULL);
+	check_portcon(IPPROTO_UDP, 53, "dns_t");
+	check_portcon(IPPROTO_UDP, 80, NULL);
+	/* a protocol without any portcons never matches */
+	check_portcon(IPPROTO_ICMP, 80, NULL);
+}
+
+static void netcon_nodecon_resolve(void)
+{
+	/* the more specific network wins */
+	check_nodecon("10.1.2.3", "net10_1_t");
+	check_nodecon("10.1.255.255", "net10_1_t");
+	check_nodecon("10.2.0.1", "net10_t");
+	check_nodecon("10.0.0.0", "net10_t");
+	check_nodecon("11.0.0.1", NULL);
+	check_nodecon("127.0.0.1", "lo_t");
+	check_nodecon("127.0.0.2", NULL);
+	/* a netmask that is not a prefix ignores the third octet */
+	check_nodecon("192.168.0.1", "odd_t");
+	check_nodecon("192.168.7.1", "odd_t");
+	check_nodecon("192.168.7.2", NULL);
+	check_nodecon("0.0.0.0", NULL);
+	check_nodecon("255.255.255.255", NULL);
+
+	check_nodecon("::1", "lo6_t");
+	check_nodecon("::2", NULL);
+	check_nodecon("::", NULL);
+	check_nodecon("2001:db8::1", "doc_t");
+	check_nodecon("2001:db8:ffff::1", "doc_t");
+	check_nodecon("2001:db9::1", NULL);
+	check_nodecon("fe80::1", NULL);
+
+	/* an unknown protocol is an error */
+	{
+		uint32_t addr[4] = { 0, 0, 0, 0 };
+		const qpol_nodecon_t *found = NULL;
+		CU_ASSERT(apol_nodecon_resolve(p, addr, QPOL_IPV6 + 1, &found) < 0);
+		CU_ASSERT_PTR_NULL(found);
+	}
+}
+
+CU_TestInfo netcon_tests[] = {
+	{"portcon best match", netcon_portcon_resolve}
+	,
+	{"nodecon best match", netcon_nodecon_resolve}
+	,
+	CU_TEST_INFO_NULL
+};
+
+int netcon_init()
+{
+	char filename[] = "/tmp/apol-netcon-XXXXXX";
+	int fd = mkstemp(filename);
+	FILE *fp;
+	apol_policy_path_t *ppath;
+	if (fd < 0) {
+		return 1;
+	}
+	if ((fp = fdopen(fd, "w")) == NULL) {
+		close(fd);
+		unlink(filename);
+		return 1;
+	}
+	fputs(netcon_policy, fp);
+	fclose(fp);
+	ppath = apol_policy_path_create(APOL_POLICY_PATH_TYPE_MONOLITHIC, filename, NULL);
+	if (ppath != NULL) {
+		p = apol_policy_create_from_policy_path(ppath, 0, NULL, NULL);
+		apol_policy_path_destroy(&ppath);
+	}
+	unlink(filename);
+	return (p == NULL);
+}
+
+int netcon_cleanup()
+{
+	apol_policy_destroy(&p);
+	return 0;
+}
@@ -0,0 +1,268 @@
+/**
+ *  @file
+ *
+ *  Test the relabel analysis against a small policy whose relabel
+ *  rules give known results in every direction.
+ *
+ *  @author agent agent@local
+ *
+ *  Copyright (C) 2026 agent
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <config.h>
+
+#include <CUnit/CUnit.h>
+#include <apol/policy.h>
+#include <apol/policy-path.h>
+#include <apol/relabel-analysis.h>
+#include <qpol/avrule_query.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * A policy in which admin_t may relabel files among red_t, green_t,
+ * and blue_t in various directions and directories to dir_t, while
+ * the movers may relabel red_t and mover_a_t alone may relabel blue_t.
+ */
+static const char *relabel_policy =
+	"class file\n"
+	"class dir\n"
+	"sid kernel\n"
+	"class file { read relabelfrom relabelto }\n"
+	"class dir { read relabelfrom relabelto }\n"
+	"attribute movers;\n"
+	"type admin_t;\n"
+	"type mover_a_t, movers;\n"
+	"type mover_b_t, movers;\n"
+	"type red_t;\n"
+	"type green_t;\n"
+	"type blue_t;\n"
+	"type dir_t;\n"
+	"role r types { admin_t mover_a_t mover_b_t red_t green_t blue_t dir_t };\n"
+	"allow admin_t red_t:file relabelfrom;\n"
+	"allow admin_t green_t:file relabelto;\n"
+	"allow admin_t blue_t:file { relabelfrom relabelto };\n"
+	"allow admin_t dir_t:dir relabelto;\n"
+	"allow movers red_t:file { relabelfrom relabelto };\n"
+	"allow mover_a_t blue_t:file { relabelfrom relabelto };\n"
+	"user u roles { r };\n"
+	"sid kernel u:r:admin_t\n";
+
+static apol_policy_t *p = NULL;
+
+static apol_vector_t *relabel_run(const char *start, unsigned int dir, const char *obj_class)
+{
+	apol_relabel_analysis_t *r = apol_relabel_analysis_create();
+	apol_vector_t *v = NULL;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(r);
+	CU_ASSERT(apol_relabel_analysis_set_dir(p, r, dir) == 0);
+	CU_ASSERT(apol_relabel_analysis_set_type(p, r, start) == 0);
+	if (obj_class != NULL)
+		CU_ASSERT(apol_relabel_analysis_append_class(p, r, obj_class) == 0);
+	CU_ASSERT_FATAL(apol_relabel_analysis_do(p, r, &v) == 0);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+	apol_relabel_analysis_destroy(&r);
+	return v;
+}
+
+static const char *type_name(const qpol_type_t * type)
+{
+	const char *name;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(type);
+	CU_ASSERT_FATAL(qpol_type_get_name(apol_policy_get_qpol(p), type, &name) == 0);
+	return name;
+}
+
+static const char *rule_target_name(const qpol_avrule_t * rule)
+{
+	const qpol_type_t *target;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(rule);
+	CU_ASSERT_FATAL(qpol_avrule_get_target_type(apol_policy_get_qpol(p), rule, &target) == 0);
+	return type_name(target);
+}
+
+/**
+ * Find the result for a type, which must be present.
+ */
+static const apol_relabel_result_t *relabel_find(const apol_vector_t * v, const char *name)
+{
+	size_t i;
+	for (i = 0; i < apol_vector_get_size(v); i++) {
+		const apol_relabel_result_t *result = apol_vector_get_element(v, i);
+		if (strcmp(type_name(apol_relabel_result_get_result_type(result)), name) == 0)
+			return result;
+	}
+	CU_FAIL_FATAL("expected relabel result not found");
+	return NULL;
+}
+
+/**
+ * Check that a list holds exactly one pair, whose rules have the
+ * given targets and whose intermediate type is as given.  For subject
+ * mode target_b and intermed are NULL.
+ */
+static void relabel_check_pair(const apol_vector_t * list, const char *target_a, const char *target_b, const char *intermed)
+{
+	const apol_relabel_result_pair_t *pair;
+	CU_ASSERT_FATAL(apol_vector_get_size(list) == 1);
+	pair = apol_vector_get_element(list, 0);
+	CU_ASSERT_STRING_EQUAL(rule_target_name(apol_relabel_result_pair_get_ruleA(pair)), target_a);
+	if (target_b == NULL) {
+		CU_ASSERT_PTR_NULL(apol_relabel_result_pair_get_ruleB(pair));
+	} else {
+		CU_ASSERT_STRING_EQUAL(rule_target_name(apol_relabel_result_pair_get_ruleB(pair)), target_b);
+	}
+	if (intermed == NULL) {
+		CU_ASSERT_PTR_NULL(apol_relabel_result_pair_get_intermediate_type(pair));
+	} else {
+		CU_ASSERT_STRING_EQUAL(type_name(apol_relabel_result_pair_get_intermediate_type(pair)), intermed);
+	}
+}
+
+static void relabel_to(void)
+{
+	apol_vector_t *v = relabel_run("red_t", APOL_RELABEL_DIR_TO, NULL);
+	const apol_relabel_result_t *result;
+	CU_ASSERT(apol_vector_get_size(v) == 2);
+
+	/* admin_t may relabel red_t files from, and green_t to */
+	result = relabel_find(v, "green_t");
+	relabel_check_pair(apol_relabel_result_get_to(result), "red_t", "green_t", "admin_t");
+	CU_ASSERT(apol_vector_get_size(apol_relabel_result_get_from(result)) == 0);
+	CU_ASSERT(apol_vector_get_size(apol_relabel_result_get_both(result)) == 0);
+
+	/* admin_t reaches blue_t as above; mover_a_t may relabel both
+	 * red_t (through its attribute) and blue_t either way */
+	result = relabel_find(v, "blue_t");
+	relabel_check_pair(apol_relabel_result_get_to(result), "red_t", "blue_t", "admin_t");
+	CU_ASSERT(apol_vector_get_size(apol_relabel_result_get_from(result)) == 0);
+	relabel_check_pair(apol_relabel_result_get_both(result), "red_t", "blue_t", "mover_a_t");
+	apol_vector_destroy(&v);
+}
+
+static void relabel_from(void)
+{
+	apol_vector_t *v = relabel_run("red_t", APOL_RELABEL_DIR_FROM, NULL);
+	const apol_relabel_result_t *result;
+	/* admin_t may only relabel red_t from, so only the movers
+	 * lead anywhere */
+	CU_ASSERT(apol_vector_get_size(v) == 1);
+	result = relabel_find(v, "blue_t");
+	CU_ASSERT(apol_vector_get_size(apol_relabel_result_get_to(result)) == 0);
+	CU_ASSERT(apol_vector_get_size(apol_relabel_result_get_from(result)) == 0);
+	relabel_check_pair(apol_relabel_result_get_both(result), "red_t", "blue_t", "mover_a_t");
+	apol_vector_destroy(&v);
+}
+
+static void relabel_both(void)
+{
+	apol_vector_t *v = relabel_run("green_t", APOL_RELABEL_DIR_BOTH, NULL);
+	const apol_relabel_result_t *result;
+	/* nothing may relabel green_t from, so every result comes
+	 * from relabelling to green_t, with the rule upon the result
+	 * type first */
+	CU_ASSERT(apol_vector_get_size(v) == 2);
+	result = relabel_find(v, "red_t");
+	CU_ASSERT(apol_vector_get_size(apol_relabel_result_get_to(result)) == 0);
+	relabel_check_pair(apol_relabel_result_get_from(result), "red_t", "green_t", "admin_t");
+	CU_ASSERT(apol_vector_get_size(apol_relabel_result_get_both(result)) == 0);
+	result = relabel_find(v, "blue_t");
+	CU_ASSERT(apol_vector_get_size(apol_relabel_result_get_to(result)) == 0);
+	relabel_check_pair(apol_relabel_result_get_from(result), "blue_t", "green_t", "admin_t");
+	CU_ASSERT(apol_vector_get_size(apol_relabel_result_get_both(result)) == 0);
+	apol_vector_destroy(&v);
+
+	/* a type that is not relabelled has no results */
+	v = relabel_run("dir_t", APOL_RELABEL_DIR_BOTH, NULL);
+	CU_ASSERT(apol_vector_get_size(v) == 0);
+	apol_vector_destroy(&v);
+}
+
+static void relabel_subject(void)
+{
+	apol_vector_t *v = relabel_run("admin_t", APOL_RELABEL_DIR_SUBJECT, NULL);
+	const apol_relabel_result_t *result;
+	CU_ASSERT(apol_vector_get_size(v) == 4);
+	result = relabel_find(v, "red_t");
+	relabel_check_pair(apol_relabel_result_get_from(result), "red_t", NULL, NULL);
+	result = relabel_find(v, "green_t");
+	relabel_check_pair(apol_relabel_result_get_to(result), "green_t", NULL, NULL);
+	result = relabel_find(v, "blue_t");
+	relabel_check_pair(apol_relabel_result_get_both(result), "blue_t", NULL, NULL);
+	result = relabel_find(v, "dir_t");
+	relabel_check_pair(apol_relabel_result_get_to(result), "dir_t", NULL, NULL);
+	apol_vector_destroy(&v);
+
+	/* restricting the class leaves only the directory */
+	v = relabel_run("admin_t", APOL_RELABEL_DIR_SUBJECT, "dir");
+	CU_ASSERT(apol_vector_get_size(v) == 1);
+	result = relabel_find(v, "dir_t");
+	relabel_check_pair(apol_relabel_result_get_to(result), "dir_t", NULL, NULL);
+	apol_vector_destroy(&v);
+
+	/* a subject's rules include those upon its attributes */
+	v = relabel_run("mover_b_t", APOL_RELABEL_DIR_SUBJECT, NULL);
+	CU_ASSERT(apol_vector_get_size(v) == 1);
+	result = relabel_find(v, "red_t");
+	relabel_check_pair(apol_relabel_result_get_both(result), "red_t", NULL, NULL);
+	apol_vector_destroy(&v);
+}
+
+CU_TestInfo relabel_tests[] = {
+	{"relabel to", relabel_to}
+	,
+	{"relabel from", relabel_from}
+	,
+	{"relabel both", relabel_both}
+	,
+	{"relabel subject", relabel_subject}
+	,
+	CU_TEST_INFO_NULL
+};
+
+int relabel_init()
+{
+	char filename[] = "/tmp/apol-relabel-XXXXXX";
+	int fd = mkstemp(filename);
+	FILE *fp;
+	apol_policy_path_t *ppath;
+	if (fd < 0) {
+		return 1;
+	}
+	if ((fp = fdopen(fd, "w")) == NULL) {
+		close(fd);
+		unlink(filename);
+		return 1;
+	}
+	fputs(relabel_policy, fp);
+	fclose(fp);
+	ppath = apol_policy_path_create(APOL_POLICY_PATH_TYPE_MONOLITHIC, filename, NULL);
+	if (ppath != NULL) {
+		p = apol_policy_create_from_policy_path(ppath, QPOL_POLICY_OPTION_NO_NEVERALLOWS, NULL, NULL);
+		apol_policy_path_destroy(&ppath);
+	}
+	unlink(filename);
+	return (p == NULL);
+}
+
+int relabel_cleanup()
+{
+	apol_policy_destroy(&p);
+	return 0;
+}
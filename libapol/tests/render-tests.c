@@ -0,0 +1,296 @@
+/**
+ *  @file
+ *
+ *  Test rendering rules into caller-supplied buffers against the
+ *  known renderings of the rules of a small policy.
+ *
+ *  @author agent agent@local
+ *
+ *  Copyright (C) 2026 agent
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <config.h>
+
+#include <CUnit/CUnit.h>
+#include <apol/avrule-query.h>
+#include <apol/policy.h>
+#include <apol/policy-path.h>
+#include <apol/terule-query.h>
+#include <qpol/avrule_query.h>
+#include <qpol/policy_extend.h>
+#include <qpol/terule_query.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * A policy with a rule of each kind.  The file class inherits some of
+ * its permissions from a common, which are numbered (and so rendered)
+ * before the class's own.
+ */
+static const char *render_policy =
+	"class file\n"
+	"class dir\n"
+	"sid kernel\n"
+	"common file_common { ioctl read write }\n"
+	"class file inherits file_common { execute }\n"
+	"class dir { search add_name }\n"
+	"type src_t;\n"
+	"type tgt_t;\n"
+	"type new_t;\n"
+	"role r types { src_t tgt_t new_t };\n"
+	"allow src_t tgt_t:file read;\n"
+	"allow src_t tgt_t:dir { add_name search };\n"
+	"allow src_t self:file { execute ioctl read };\n"
+	"auditallow src_t tgt_t:file write;\n"
+	"dontaudit src_t tgt_t:dir search;\n"
+	"type_transition src_t tgt_t:file new_t;\n"
+	"type_change src_t tgt_t:dir new_t;\n"
+	"user u roles { r };\n"
+	"sid kernel u:r:src_t\n";
+
+/** renderings of the policy's AV rules; the first is the shortest
+ * and the third the longest */
+static const char *avrule_strs[] = {
+	"allow src_t tgt_t : file read ;",
+	"allow src_t tgt_t : dir { search add_name } ;",
+	"allow src_t src_t : file { ioctl read execute } ;",
+	"auditallow src_t tgt_t : file write ;",
+	"dontaudit src_t tgt_t : dir search ;"
+};
+
+#define NUM_AVRULES (sizeof(avrule_strs) / sizeof(avrule_strs[0]))
+
+static const char *terule_strs[] = {
+	"type_transition src_t tgt_t : file new_t;",
+	"type_change src_t tgt_t : dir new_t;"
+};
+
+#define NUM_TERULES (sizeof(terule_strs) / sizeof(terule_strs[0]))
+
+/** renderings of the policy's rules as written, keeping self */
+static const char *syn_avrule_strs[] = {
+	"allow src_t tgt_t : file read ;",
+	"allow src_t tgt_t : dir { search add_name } ;",
+	"allow src_t self : file { ioctl read execute } ;",
+	"auditallow src_t tgt_t : file write ;",
+	"dontaudit src_t tgt_t : dir search ;"
+};
+
+#define NUM_SYN_AVRULES (sizeof(syn_avrule_strs) / sizeof(syn_avrule_strs[0]))
+
+static apol_policy_t *p = NULL;
+
+/**
+ * Find a rendering among those expected, failing the test if it is
+ * not there or was already found.
+ *
+ * @return Index of the rendering.
+ */
+static size_t render_find(const char **strs, size_t num_strs, unsigned char *found, const char *buf)
+{
+	size_t i;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(buf);
+	for (i = 0; i < num_strs; i++) {
+		if (strcmp(strs[i], buf) == 0)
+			break;
+	}
+	CU_ASSERT_FATAL(i < num_strs);
+	CU_ASSERT(!found[i]);
+	found[i] = 1;
+	return i;
+}
+
+/**
+ * Check a rendering within a reused buffer against what is expected.
+ * The buffer must hold exactly the expected string, however long a
+ * string it held before, and must never shrink.
+ */
+static void render_check(const char *buf, size_t buf_sz, size_t prev_sz, const char *expected)
+{
+	CU_ASSERT_PTR_NOT_NULL_FATAL(buf);
+	CU_ASSERT_STRING_EQUAL(buf, expected);
+	CU_ASSERT(buf_sz > strlen(expected));
+	CU_ASSERT(buf_sz >= prev_sz);
+}
+
+static void render_avrule_buf(void)
+{
+	qpol_policy_t *q = apol_policy_get_qpol(p);
+	qpol_iterator_t *iter = NULL;
+	const qpol_avrule_t *rules[NUM_AVRULES];
+	unsigned char found[NUM_AVRULES];
+	char *buf = NULL;
+	size_t buf_sz = 0, prev_sz, i, pass;
+
+	/* the second pass renders from permission sets cached by the
+	 * first */
+	for (pass = 0; pass < 2; pass++) {
+		memset(found, 0, sizeof(found));
+		CU_ASSERT_FATAL(qpol_policy_get_avrule_iter(q, QPOL_RULE_ALLOW | QPOL_RULE_NEVERALLOW |
+							    QPOL_RULE_AUDITALLOW | QPOL_RULE_DONTAUDIT, &iter) == 0);
+		for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+			qpol_avrule_t *rule;
+			char *old;
+			prev_sz = buf_sz;
+			CU_ASSERT_FATAL(qpol_iterator_get_item(iter, (void **)&rule) == 0);
+			CU_ASSERT_FATAL(apol_avrule_render_buf(p, rule, &buf, &buf_sz) == 0);
+			i = render_find(avrule_strs, NUM_AVRULES, found, buf);
+			render_check(buf, buf_sz, prev_sz, avrule_strs[i]);
+			rules[i] = rule;
+			old = apol_avrule_render(p, rule);
+			CU_ASSERT_PTR_NOT_NULL_FATAL(old);
+			CU_ASSERT_STRING_EQUAL(old, avrule_strs[i]);
+			free(old);
+		}
+		qpol_iterator_destroy(&iter);
+		for (i = 0; i < NUM_AVRULES; i++)
+			CU_ASSERT_FATAL(found[i]);
+	}
+	free(buf);
+
+	/* a one-byte buffer grows to fit; a long buffer is overwritten
+	 * by a short rule without keeping any of its old tail */
+	buf_sz = 1;
+	buf = malloc(buf_sz);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(buf);
+	CU_ASSERT_FATAL(apol_avrule_render_buf(p, rules[2], &buf, &buf_sz) == 0);
+	render_check(buf, buf_sz, 1, avrule_strs[2]);
+	prev_sz = buf_sz;
+	CU_ASSERT_FATAL(apol_avrule_render_buf(p, rules[0], &buf, &buf_sz) == 0);
+	render_check(buf, buf_sz, prev_sz, avrule_strs[0]);
+	CU_ASSERT_EQUAL(buf_sz, prev_sz);
+	free(buf);
+
+	/* a NULL buffer is allocated, whatever the stale size */
+	buf = NULL;
+	buf_sz = 4096;
+	CU_ASSERT_FATAL(apol_avrule_render_buf(p, rules[0], &buf, &buf_sz) == 0);
+	render_check(buf, buf_sz, 0, avrule_strs[0]);
+	free(buf);
+
+	/* the buffer references are required */
+	errno = 0;
+	CU_ASSERT(apol_avrule_render_buf(p, rules[0], NULL, &buf_sz) < 0);
+	CU_ASSERT_EQUAL(errno, EINVAL);
+	buf = NULL;
+	CU_ASSERT(apol_avrule_render_buf(p, rules[0], &buf, NULL) < 0);
+}
+
+static void render_terule_buf(void)
+{
+	qpol_policy_t *q = apol_policy_get_qpol(p);
+	qpol_iterator_t *iter = NULL;
+	unsigned char found[NUM_TERULES];
+	char *buf = NULL;
+	size_t buf_sz = 0, i;
+	memset(found, 0, sizeof(found));
+	CU_ASSERT_FATAL(qpol_policy_get_terule_iter(q, QPOL_RULE_TYPE_TRANS | QPOL_RULE_TYPE_CHANGE | QPOL_RULE_TYPE_MEMBER, &iter) ==
+			0);
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		qpol_terule_t *rule;
+		char *old;
+		size_t prev_sz = buf_sz;
+		CU_ASSERT_FATAL(qpol_iterator_get_item(iter, (void **)&rule) == 0);
+		CU_ASSERT_FATAL(apol_terule_render_buf(p, rule, &buf, &buf_sz) == 0);
+		i = render_find(terule_strs, NUM_TERULES, found, buf);
+		render_check(buf, buf_sz, prev_sz, terule_strs[i]);
+		old = apol_terule_render(p, rule);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(old);
+		CU_ASSERT_STRING_EQUAL(old, terule_strs[i]);
+		free(old);
+	}
+	qpol_iterator_destroy(&iter);
+	for (i = 0; i < NUM_TERULES; i++)
+		CU_ASSERT(found[i]);
+	free(buf);
+}
+
+static void render_syn_avrule_buf(void)
+{
+	apol_vector_t *v = NULL;
+	unsigned char found[NUM_SYN_AVRULES];
+	char *buf = NULL;
+	size_t buf_sz = 0, i, j;
+	memset(found, 0, sizeof(found));
+	CU_ASSERT_FATAL(apol_syn_avrule_get_by_query(p, NULL, &v) == 0);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+	CU_ASSERT_EQUAL(apol_vector_get_size(v), NUM_SYN_AVRULES);
+	for (i = 0; i < apol_vector_get_size(v); i++) {
+		const qpol_syn_avrule_t *syn = apol_vector_get_element(v, i);
+		char *old;
+		size_t prev_sz = buf_sz;
+		CU_ASSERT_FATAL(apol_syn_avrule_render_buf(p, syn, &buf, &buf_sz) == 0);
+		j = render_find(syn_avrule_strs, NUM_SYN_AVRULES, found, buf);
+		render_check(buf, buf_sz, prev_sz, syn_avrule_strs[j]);
+		old = apol_syn_avrule_render(p, syn);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(old);
+		CU_ASSERT_STRING_EQUAL(old, syn_avrule_strs[j]);
+		free(old);
+	}
+	apol_vector_destroy(&v);
+	free(buf);
+}
+
+CU_TestInfo render_tests[] = {
+	{"avrule into buffer", render_avrule_buf}
+	,
+	{"terule into buffer", render_terule_buf}
+	,
+	{"syntactic avrule into buffer", render_syn_avrule_buf}
+	,
+	CU_TEST_INFO_NULL
+};
+
+int render_init()
+{
+	char filename[] = "/tmp/apol-render-XXXXXX";
+	int fd = mkstemp(filename);
+	FILE *fp;
+	apol_policy_path_t *ppath;
+	if (fd < 0) {
+		return 1;
+	}
+	if ((fp = fdopen(fd, "w")) == NULL) {
+		close(fd);
+		unlink(filename);
+		return 1;
+	}
+	fputs(render_policy, fp);
+	fclose(fp);
+	ppath = apol_policy_path_create(APOL_POLICY_PATH_TYPE_MONOLITHIC, filename, NULL);
+	if (ppath != NULL) {
+		p = apol_policy_create_from_policy_path(ppath, 0, NULL, NULL);
+		apol_policy_path_destroy(&ppath);
+	}
+	unlink(filename);
+	if (p == NULL) {
+		return 1;
+	}
+	if (qpol_policy_build_syn_rule_table(apol_policy_get_qpol(p)) != 0) {
+		return 1;
+	}
+	return 0;
+}
+
+int render_cleanup()
+{
+	apol_policy_destroy(&p);
+	return 0;
+}
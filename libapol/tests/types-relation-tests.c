@@ -0,0 +1,224 @@
+/**
+ *  @file
+ *
+ *  Test the searches for types of similar access against a small
+ *  policy whose types share known accesses.
+ *
+ *  @author agent agent@local
+ *
+ *  Copyright (C) 2026 agent
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <config.h>
+
+#include <CUnit/CUnit.h>
+#include <apol/policy.h>
+#include <apol/policy-path.h>
+#include <apol/types-relation-analysis.h>
+#include <apol/vector.h>
+#include <qpol/type_query.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * A policy in which a_t and b_t have identical accesses, c_t shares
+ * one of them, and the readers e_t and f_t share y_t's files (via
+ * their attribute) with a_t and b_t.  d_t shares only z_t's
+ * directories with e_t, and the target types have no accesses.  The
+ * types are declared in order of name, so that their values are in
+ * the same order.
+ */
+static const char *types_relation_policy =
+	"class file\n"
+	"class dir\n"
+	"sid kernel\n"
+	"class file { read write }\n"
+	"class dir { read write }\n"
+	"attribute readers;\n"
+	"type a_t;\n"
+	"type b_t;\n"
+	"type c_t;\n"
+	"type d_t;\n"
+	"type e_t, readers;\n"
+	"type f_t, readers;\n"
+	"type x_t;\n"
+	"type y_t;\n"
+	"type z_t;\n"
+	"role r types { a_t b_t c_t d_t e_t f_t x_t y_t z_t };\n"
+	"allow a_t { x_t y_t }:file read;\n"
+	"allow b_t x_t:file read;\n"
+	"allow b_t y_t:file { read write };\n"
+	"allow c_t x_t:{ file dir } read;\n"
+	"allow d_t z_t:dir read;\n"
+	"allow readers y_t:file read;\n"
+	"allow e_t z_t:dir write;\n"
+	"user u roles { r };\n"
+	"sid kernel u:r:a_t\n";
+
+static apol_policy_t *p = NULL;
+
+static const char *type_name(const qpol_type_t * t)
+{
+	const char *name = NULL;
+	CU_ASSERT_FATAL(qpol_type_get_name(apol_policy_get_qpol(p), t, &name) == 0);
+	return name;
+}
+
+static int tr_close(double a, double b)
+{
+	return (a > b ? a - b : b - a) < 1e-9;
+}
+
+/**
+ * Check one similarity result against the types and counts expected.
+ */
+static void tr_check(const apol_vector_t * v, size_t i, const char *first, const char *other, size_t num_common,
+		     double similarity)
+{
+	const apol_types_relation_similarity_t *s;
+	CU_ASSERT_FATAL(i < apol_vector_get_size(v));
+	s = apol_vector_get_element(v, i);
+	CU_ASSERT_STRING_EQUAL(type_name(apol_types_relation_similarity_get_first_type(s)), first);
+	CU_ASSERT_STRING_EQUAL(type_name(apol_types_relation_similarity_get_other_type(s)), other);
+	CU_ASSERT_EQUAL(apol_types_relation_similarity_get_num_common(s), num_common);
+	CU_ASSERT(tr_close(apol_types_relation_similarity_get_similarity(s), similarity));
+}
+
+static void types_relation_similar(void)
+{
+	apol_vector_t *v = NULL;
+
+	/* a_t reads x_t and y_t files; permissions do not matter, so b_t
+	 * is identical.  f_t shares one of two accesses, c_t and e_t
+	 * one of three, and are ordered by name. */
+	CU_ASSERT_FATAL(apol_types_relation_find_similar(p, "a_t", 0, &v) == 0);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+	CU_ASSERT_EQUAL(apol_vector_get_size(v), 4);
+	tr_check(v, 0, "a_t", "b_t", 2, 1.0);
+	tr_check(v, 1, "a_t", "f_t", 1, 1.0 / 2.0);
+	tr_check(v, 2, "a_t", "c_t", 1, 1.0 / 3.0);
+	tr_check(v, 3, "a_t", "e_t", 1, 1.0 / 3.0);
+	apol_vector_destroy(&v);
+
+	/* a limited search returns the most similar */
+	CU_ASSERT_FATAL(apol_types_relation_find_similar(p, "a_t", 2, &v) == 0);
+	CU_ASSERT_EQUAL(apol_vector_get_size(v), 2);
+	tr_check(v, 0, "a_t", "b_t", 2, 1.0);
+	tr_check(v, 1, "a_t", "f_t", 1, 1.0 / 2.0);
+	apol_vector_destroy(&v);
+
+	/* c_t's directory access on x_t is its own */
+	CU_ASSERT_FATAL(apol_types_relation_find_similar(p, "c_t", 0, &v) == 0);
+	CU_ASSERT_EQUAL(apol_vector_get_size(v), 2);
+	tr_check(v, 0, "c_t", "a_t", 1, 1.0 / 3.0);
+	tr_check(v, 1, "c_t", "b_t", 1, 1.0 / 3.0);
+	apol_vector_destroy(&v);
+
+	/* e_t gains y_t files from readers and z_t directories itself */
+	CU_ASSERT_FATAL(apol_types_relation_find_similar(p, "d_t", 0, &v) == 0);
+	CU_ASSERT_EQUAL(apol_vector_get_size(v), 1);
+	tr_check(v, 0, "d_t", "e_t", 1, 1.0 / 2.0);
+	apol_vector_destroy(&v);
+
+	/* a type with no accesses is like no other */
+	CU_ASSERT_FATAL(apol_types_relation_find_similar(p, "x_t", 0, &v) == 0);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+	CU_ASSERT_EQUAL(apol_vector_get_size(v), 0);
+	apol_vector_destroy(&v);
+
+	/* searching by an attribute or an unknown name is an error */
+	CU_ASSERT(apol_types_relation_find_similar(p, "readers", 0, &v) < 0);
+	CU_ASSERT_PTR_NULL(v);
+	CU_ASSERT(apol_types_relation_find_similar(p, "no_such_t", 0, &v) < 0);
+	CU_ASSERT_PTR_NULL(v);
+}
+
+static void types_relation_similar_pairs(void)
+{
+	apol_vector_t *v = NULL;
+
+	CU_ASSERT_FATAL(apol_types_relation_find_similar_pairs(p, 1.0, &v) == 0);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+	CU_ASSERT_EQUAL(apol_vector_get_size(v), 1);
+	tr_check(v, 0, "a_t", "b_t", 2, 1.0);
+	apol_vector_destroy(&v);
+
+	/* each pair once, lesser type first, ties ordered by name */
+	CU_ASSERT_FATAL(apol_types_relation_find_similar_pairs(p, 0.5, &v) == 0);
+	CU_ASSERT_EQUAL(apol_vector_get_size(v), 5);
+	tr_check(v, 0, "a_t", "b_t", 2, 1.0);
+	tr_check(v, 1, "a_t", "f_t", 1, 1.0 / 2.0);
+	tr_check(v, 2, "b_t", "f_t", 1, 1.0 / 2.0);
+	tr_check(v, 3, "d_t", "e_t", 1, 1.0 / 2.0);
+	tr_check(v, 4, "e_t", "f_t", 1, 1.0 / 2.0);
+	apol_vector_destroy(&v);
+
+	CU_ASSERT_FATAL(apol_types_relation_find_similar_pairs(p, 0.3, &v) == 0);
+	CU_ASSERT_EQUAL(apol_vector_get_size(v), 9);
+	tr_check(v, 5, "a_t", "c_t", 1, 1.0 / 3.0);
+	tr_check(v, 6, "a_t", "e_t", 1, 1.0 / 3.0);
+	tr_check(v, 7, "b_t", "c_t", 1, 1.0 / 3.0);
+	tr_check(v, 8, "b_t", "e_t", 1, 1.0 / 3.0);
+	apol_vector_destroy(&v);
+
+	/* thresholds outside of (0, 1] are errors */
+	CU_ASSERT(apol_types_relation_find_similar_pairs(p, 0.0, &v) < 0);
+	CU_ASSERT_PTR_NULL(v);
+	CU_ASSERT(apol_types_relation_find_similar_pairs(p, 1.5, &v) < 0);
+	CU_ASSERT_PTR_NULL(v);
+}
+
+CU_TestInfo types_relation_tests[] = {
+	{"find similar types", types_relation_similar}
+	,
+	{"find similar pairs", types_relation_similar_pairs}
+	,
+	CU_TEST_INFO_NULL
+};
+
+int types_relation_init()
+{
+	char filename[] = "/tmp/apol-types-relation-XXXXXX";
+	int fd = mkstemp(filename);
+	FILE *fp;
+	apol_policy_path_t *ppath;
+	if (fd < 0) {
+		return 1;
+	}
+	if ((fp = fdopen(fd, "w")) == NULL) {
+		close(fd);
+		unlink(filename);
+		return 1;
+	}
+	fputs(types_relation_policy, fp);
+	fclose(fp);
+	ppath = apol_policy_path_create(APOL_POLICY_PATH_TYPE_MONOLITHIC, filename, NULL);
+	if (ppath != NULL) {
+		p = apol_policy_create_from_policy_path(ppath, QPOL_POLICY_OPTION_NO_NEVERALLOWS, NULL, NULL);
+		apol_policy_path_destroy(&ppath);
+	}
+	unlink(filename);
+	return (p == NULL);
+}
+
+int types_relation_cleanup()
+{
+	apol_policy_destroy(&p);
+	return 0;
+}
@@ -0,0 +1,107 @@
+/**
+ *  @file
+ *
+ *  Benchmark for apol_vector_sort() and apol_vector_get_index_sorted().
+ *  Run as "vector-bench [number of elements]"; timings for several
+ *  input orderings are written to standard output.
+ *
+ *  @author agent agent@local
+ *
+ *  Copyright (C) 2026 agent
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <config.h>
+
+#include <apol/vector.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static unsigned long num_comps;
+
+static int bench_comp(const void *a, const void *b, void *data __attribute__ ((unused)))
+{
+	long x = (long)a, y = (long)b;
+	num_comps++;
+	if (x < y) {
+		return -1;
+	} else if (x > y) {
+		return 1;
+	}
+	return 0;
+}
+
+static double bench_elapsed(const struct timespec *start)
+{
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (double)(end.tv_sec - start->tv_sec) + (double)(end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+	static const char *orders[] = { "random", "sorted", "reversed", "few unique", "organ pipe" };
+	size_t n = 1000000, i, j, idx;
+	struct timespec start;
+	apol_vector_t *v = NULL;
+	long x;
+
+	if (argc > 1) {
+		n = strtoul(argv[1], NULL, 10);
+	}
+	srandom(1);
+	for (j = 0; j < sizeof(orders) / sizeof(orders[0]); j++) {
+		apol_vector_destroy(&v);
+		if ((v = apol_vector_create_with_capacity(n, NULL)) == NULL) {
+			perror("apol_vector_create_with_capacity");
+			return 1;
+		}
+		for (i = 0; i < n; i++) {
+			switch (j) {
+			case 0:
+				x = random();
+				break;
+			case 1:
+				x = (long)i;
+				break;
+			case 2:
+				x = (long)(n - i);
+				break;
+			case 3:
+				x = random() % 16;
+				break;
+			default:
+				x = (long)(i < n / 2 ? i : n - i);
+				break;
+			}
+			apol_vector_append(v, (void *)x);
+		}
+		num_comps = 0;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		apol_vector_sort(v, bench_comp, NULL);
+		printf("sort %-10s %10zu elements %8.3f s %12lu comparisons\n", orders[j], n, bench_elapsed(&start), num_comps);
+	}
+
+	num_comps = 0;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < n; i++) {
+		apol_vector_get_index_sorted(v, apol_vector_get_element(v, i), bench_comp, NULL, &idx);
+	}
+	printf("get_index_sorted %10zu lookups %8.3f s %12lu comparisons\n", n, bench_elapsed(&start), num_comps);
+	apol_vector_destroy(&v);
+	return 0;
+}
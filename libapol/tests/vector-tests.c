@@ -0,0 +1,178 @@
+/**
+ *  @file
+ *
+ *  Test the vector sorting, searching, and bulk append routines.
+ *
+ *  @author agent agent@local
+ *
+ *  Copyright (C) 2026 agent
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <config.h>
+
+#include <CUnit/CUnit.h>
+#include <apol/vector.h>
+#include <stdlib.h>
+
+#define VECTOR_TEST_SIZE 5000
+
+static int vector_long_comp(const void *a, const void *b, void *data __attribute__ ((unused)))
+{
+	long x = (long)a, y = (long)b;
+	if (x < y) {
+		return -1;
+	} else if (x > y) {
+		return 1;
+	}
+	return 0;
+}
+
+static int vector_is_sorted(const apol_vector_t * v)
+{
+	size_t i;
+	for (i = 1; i < apol_vector_get_size(v); i++) {
+		if ((long)apol_vector_get_element(v, i - 1) > (long)apol_vector_get_element(v, i)) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static void vector_sort_inputs(void)
+{
+	size_t i, j;
+	long sum, x;
+	for (j = 0; j < 5; j++) {
+		apol_vector_t *v = apol_vector_create(NULL);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+		sum = 0;
+		for (i = 0; i < VECTOR_TEST_SIZE; i++) {
+			switch (j) {
+			case 0:
+				x = random() % 100000;
+				break;
+			case 1:
+				x = (long)i;
+				break;
+			case 2:
+				x = VECTOR_TEST_SIZE - (long)i;
+				break;
+			case 3:
+				x = 42;
+				break;
+			default:
+				x = (i % 2 ? (long)i : VECTOR_TEST_SIZE - (long)i);
+				break;
+			}
+			sum += x;
+			CU_ASSERT(apol_vector_append(v, (void *)x) == 0);
+		}
+		apol_vector_sort(v, vector_long_comp, NULL);
+		CU_ASSERT(apol_vector_get_size(v) == VECTOR_TEST_SIZE);
+		CU_ASSERT(vector_is_sorted(v));
+		for (i = 0; i < VECTOR_TEST_SIZE; i++) {
+			sum -= (long)apol_vector_get_element(v, i);
+		}
+		CU_ASSERT(sum == 0);
+		apol_vector_destroy(&v);
+	}
+}
+
+static void vector_sorted_index(void)
+{
+	apol_vector_t *v = apol_vector_create(NULL);
+	size_t i, idx;
+	long x;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+
+	CU_ASSERT(apol_vector_get_index_sorted(v, (void *)1, vector_long_comp, NULL, &idx) < 0);
+	CU_ASSERT(idx == 0);
+	for (i = 0; i < 100; i++) {
+		/* even numbers only, each twice */
+		x = (long)(i / 2) * 2;
+		CU_ASSERT(apol_vector_append(v, (void *)x) == 0);
+	}
+	apol_vector_sort(v, vector_long_comp, NULL);
+	for (x = 0; x < 100; x += 2) {
+		CU_ASSERT(apol_vector_get_index_sorted(v, (void *)x, vector_long_comp, NULL, &idx) == 0);
+		CU_ASSERT(idx == (size_t) x);
+		CU_ASSERT(apol_vector_get_index_sorted(v, (void *)(x + 1), vector_long_comp, NULL, &idx) < 0);
+		CU_ASSERT(idx == (size_t) x + 2);
+	}
+	CU_ASSERT(apol_vector_get_index_sorted(v, (void *)-1, vector_long_comp, NULL, &idx) < 0);
+	CU_ASSERT(idx == 0);
+	CU_ASSERT(apol_vector_get_index_sorted(NULL, (void *)0, vector_long_comp, NULL, &idx) < 0);
+	apol_vector_destroy(&v);
+}
+
+static void vector_bulk_append(void)
+{
+	apol_vector_t *v = apol_vector_create_with_capacity(1, NULL);
+	apol_vector_t *w = NULL;
+	void *elems[VECTOR_TEST_SIZE];
+	size_t i;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+
+	CU_ASSERT(apol_vector_reserve(v, VECTOR_TEST_SIZE) == 0);
+	CU_ASSERT(apol_vector_get_capacity(v) >= VECTOR_TEST_SIZE);
+	CU_ASSERT(apol_vector_get_size(v) == 0);
+	CU_ASSERT(apol_vector_reserve(v, 1) == 0);
+	CU_ASSERT(apol_vector_get_capacity(v) >= VECTOR_TEST_SIZE);
+
+	for (i = 0; i < VECTOR_TEST_SIZE; i++) {
+		elems[i] = (void *)(i + 1);
+	}
+	CU_ASSERT(apol_vector_append_array(v, elems, 0) == 0);
+	CU_ASSERT(apol_vector_get_size(v) == 0);
+	CU_ASSERT(apol_vector_append_array(v, elems, VECTOR_TEST_SIZE) == 0);
+	CU_ASSERT(apol_vector_get_size(v) == VECTOR_TEST_SIZE);
+	for (i = 0; i < VECTOR_TEST_SIZE; i++) {
+		CU_ASSERT(apol_vector_get_element(v, i) == elems[i]);
+	}
+
+	w = apol_vector_create(NULL);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(w);
+	CU_ASSERT(apol_vector_append(w, (void *)1) == 0);
+	CU_ASSERT(apol_vector_cat(w, v) == 0);
+	CU_ASSERT(apol_vector_get_size(w) == VECTOR_TEST_SIZE + 1);
+	CU_ASSERT(apol_vector_get_element(w, VECTOR_TEST_SIZE) == elems[VECTOR_TEST_SIZE - 1]);
+	apol_vector_sort_uniquify(w, NULL, NULL);
+	CU_ASSERT(apol_vector_get_size(w) == VECTOR_TEST_SIZE);
+	apol_vector_destroy(&w);
+	apol_vector_destroy(&v);
+}
+
+CU_TestInfo vector_tests[] = {
+	{"sort inputs", vector_sort_inputs}
+	,
+	{"sorted index", vector_sorted_index}
+	,
+	{"bulk append", vector_bulk_append}
+	,
+	CU_TEST_INFO_NULL
+};
+
+int vector_init()
+{
+	srandom(1);
+	return 0;
+}
+
+int vector_cleanup()
+{
+	return 0;
+}
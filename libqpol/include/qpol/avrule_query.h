@@ -38,6 +38,19 @@ extern "C"
 
 	typedef struct qpol_avrule qpol_avrule_t;
 
+/**
+ * Effective access between two types upon a class, with bit (value -
+ * 1) set for each permission.
+ */
+	typedef struct qpol_access
+	{
+		uint32_t allowed;
+		uint32_t auditallow;
+		uint32_t dontaudit;
+		/** only filled in if neverallows were loaded */
+		uint32_t neverallow;
+	} qpol_access_t;
+
 /* rule type defines (values copied from "sepol/policydb/policydb.h") */
 #define QPOL_RULE_ALLOW         1
 #define QPOL_RULE_NEVERALLOW  128
@@ -114,6 +127,18 @@ extern "C"
  */
 	extern int qpol_avrule_get_perm_iter(const qpol_policy_t * policy, const qpol_avrule_t * rule, qpol_iterator_t ** perms);
 
+/**
+ *  Get the permissions in an av rule as a bit mask.  Bit i of the
+ *  mask is set if the permission with value i + 1 within the rule's
+ *  object class is in the rule; see qpol_class_get_perm_value().
+ *  @param policy Policy from which the rule comes.
+ *  @param rule The rule from which to get the permissions.
+ *  @param perm_mask Pointer to the mask to set.
+ *  @return 0 on success and < 0 on failure; if the call fails,
+ *  errno will be set and *perm_mask will be 0.
+ */
+	extern int qpol_avrule_get_perm_mask(const qpol_policy_t * policy, const qpol_avrule_t * rule, uint32_t * perm_mask);
+
 /**
  *  Get the rule type value for an av rule.
  *  @param policy Policy from which the rule comes.
@@ -160,6 +185,28 @@ extern "C"
  */
 	extern int qpol_avrule_get_which_list(const qpol_policy_t * policy, const qpol_avrule_t * rule, uint32_t * which_list);
 
+/**
+ *  Compute the access one type has to another upon a class, as the
+ *  kernel would: the rules for every pair of the source's and
+ *  target's attributes (including the types themselves) are looked
+ *  up in the policy's access vector tables and combined.
+ *  Conditional rules count only if enabled by the current state of
+ *  the policy's booleans.  It is an error to call this function if
+ *  rules are not loaded.  This function only reads the policy, so it
+ *  may be called by several threads at once.
+ *  @param policy Policy in which to look up rules.
+ *  @param source Source type; this may be an alias but not an
+ *  attribute.
+ *  @param target Target type; this may be an alias but not an
+ *  attribute.
+ *  @param obj_class Object class.
+ *  @param access Structure in which to store the access vectors.
+ *  @return 0 on success and < 0 on failure; if the call fails,
+ *  errno will be set and *access will be cleared.
+ */
+	extern int qpol_policy_compute_access(const qpol_policy_t * policy, const qpol_type_t * source, const qpol_type_t * target,
+					      const qpol_class_t * obj_class, qpol_access_t * access);
+
 #ifdef	__cplusplus
 }
 #endif
@@ -132,6 +132,22 @@ extern "C"
  */
 	extern int qpol_class_get_perm_iter(const qpol_policy_t * policy, const qpol_class_t * obj_class, qpol_iterator_t ** perms);
 
+/**
+ *  Get the integer value of one of a class's permissions, either
+ *  unique to the class or from its common.  Values range from 1 to
+ *  the number of permissions in the class, including those of its
+ *  common.
+ *  @param policy The policy with which the class is associated.
+ *  @param obj_class The class to which the permission belongs.
+ *  @param perm Name of the permission.
+ *  @param value Pointer to the integer to be set to the value.
+ *  @return Returns 0 on success and < 0 on failure; if the call
+ *  fails (including if the class has no such permission), errno will
+ *  be set and *value will be 0.
+ */
+	extern int qpol_class_get_perm_value(const qpol_policy_t * policy, const qpol_class_t * obj_class, const char *perm,
+					     uint32_t * value);
+
 /**
  *  Get the name which identifies a class.
  *  @param policy The policy with which the class is associated.
@@ -223,6 +223,28 @@ extern "C"
 	extern int qpol_constraint_expr_node_get_names_iter(const qpol_policy_t * policy, const qpol_constraint_expr_node_t * expr,
 							    qpol_iterator_t ** iter);
 
+/**
+ *  Get an iterator of the names that an expression node matches.
+ *  Unlike qpol_constraint_expr_node_get_names_iter(), which returns
+ *  the names as written, attributes are replaced by their types and
+ *  subtracted types, '*', and '~' have been applied, so a name is
+ *  returned if and only if the expression's set contains it.
+ *  @param policy The policy from which the expression comes.
+ *  @param expr The expression node from which to create the iterator.
+ *  Must be of expression type QPOL_CEXPR_TYPE_NAMES.
+ *  @param iter Iterator over items of type char* returned.
+ *  The caller is responsible for calling qpol_iterator_destroy()
+ *  to free memory used by this iterator. <b>The caller should call
+ *  free() on the strings returned by qpol_iterator_get_item().</b>
+ *  It is important to note that this iterator is only valid as long
+ *  as the policy is unmodified.
+ *  @return 0 on success and < 0 on failure; if the call fails,
+ *  errno will be set and *iter will be NULL.
+ */
+	extern int qpol_constraint_expr_node_get_expanded_names_iter(const qpol_policy_t * policy,
+								     const qpol_constraint_expr_node_t * expr,
+								     qpol_iterator_t ** iter);
+
 /**
  *  Get an iterator for the constraints on a class.
  *  @param policy The policy associated with the class.
@@ -0,0 +1,168 @@
+/**
+ *  @file
+ *  Defines the public interface for the policy's table of interned
+ *  symbol names.  Every type, class, common, role, user, boolean, and
+ *  permission name within a policy is stored exactly once, along with
+ *  its length and hash.  Two names from the same policy are equal if
+ *  and only if their qpol_name_t pointers are equal.
+ *
+ *  @author agent agent@local
+ *
+ *  Copyright (C) 2026 agent
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef QPOL_NAME_TABLE_H
+#define QPOL_NAME_TABLE_H
+
+#ifdef	__cplusplus
+extern "C"
+{
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <qpol/policy.h>
+
+/**
+ *  An interned symbol name.  The table is built when the policy is
+ *  loaded or rebuilt and is not modified afterwards, so it may be read
+ *  by several threads at once.  All names remain valid until the
+ *  policy is rebuilt or destroyed.
+ */
+	typedef struct qpol_name
+	{
+	/** the null-terminated name */
+		const char *str;
+	/** length of str, not counting the terminating null */
+		size_t len;
+	/** hash of str, as per qpol_name_hash() */
+		uint32_t hash;
+	} qpol_name_t;
+
+/**
+ *  Compute the hash of a string, using the same function as the name
+ *  table.  Names from different policies may be compared by first
+ *  comparing their hash values.
+ *  @param str String to hash.
+ *  @param len Number of bytes of str to hash.
+ *  @return Hash of the string.
+ */
+	extern uint32_t qpol_name_hash(const char *str, size_t len);
+
+/**
+ *  Find the interned name that equals a string.
+ *  @param policy The policy whose names to search.
+ *  @param str String to find.
+ *  @param name Pointer in which to store the interned name.  Must be
+ *  non-NULL.  The caller should not free this pointer.
+ *  @return Returns 0 on success and < 0 on failure; if the call fails,
+ *  errno will be set and *name will be NULL.  If no symbol within the
+ *  policy has that name then errno will be ENOENT.
+ */
+	extern int qpol_name_lookup(const qpol_policy_t * policy, const char *str, const qpol_name_t ** name);
+
+/**
+ *  Get the interned name of a type.  For an alias this is the name of
+ *  its primary type, the same as qpol_type_get_name().
+ *  @param policy The policy associated with the type.
+ *  @param datum Type whose name to get.
+ *  @param name Pointer in which to store the interned name.  Must be
+ *  non-NULL.  The caller should not free this pointer.
+ *  @return Returns 0 on success and < 0 on failure; if the call fails,
+ *  errno will be set and *name will be NULL.
+ */
+	extern int qpol_type_get_interned_name(const qpol_policy_t * policy, const qpol_type_t * datum, const qpol_name_t ** name);
+
+/**
+ *  Get the interned name of an object class.
+ *  @param policy The policy associated with the class.
+ *  @param obj_class Class whose name to get.
+ *  @param name Pointer in which to store the interned name.  Must be
+ *  non-NULL.  The caller should not free this pointer.
+ *  @return Returns 0 on success and < 0 on failure; if the call fails,
+ *  errno will be set and *name will be NULL.
+ */
+	extern int qpol_class_get_interned_name(const qpol_policy_t * policy, const qpol_class_t * obj_class,
+						const qpol_name_t ** name);
+
+/**
+ *  Get the interned name of one of a class's permissions, including
+ *  those inherited from its common.
+ *  @param policy The policy associated with the class.
+ *  @param obj_class Class whose permission name to get.
+ *  @param perm_value Value of the permission, as returned by
+ *  qpol_class_get_perm_value(); permission n is bit n - 1 of an
+ *  access vector.
+ *  @param name Pointer in which to store the interned name.  Must be
+ *  non-NULL.  The caller should not free this pointer.
+ *  @return Returns 0 on success and < 0 on failure; if the call fails,
+ *  errno will be set and *name will be NULL.  If the class has no
+ *  such permission then errno will be ENOENT.
+ */
+	extern int qpol_class_get_interned_perm_name(const qpol_policy_t * policy, const qpol_class_t * obj_class,
+						     uint32_t perm_value, const qpol_name_t ** name);
+
+/**
+ *  Get the interned name of a common.
+ *  @param policy The policy associated with the common.
+ *  @param common Common whose name to get.
+ *  @param name Pointer in which to store the interned name.  Must be
+ *  non-NULL.  The caller should not free this pointer.
+ *  @return Returns 0 on success and < 0 on failure; if the call fails,
+ *  errno will be set and *name will be NULL.
+ */
+	extern int qpol_common_get_interned_name(const qpol_policy_t * policy, const qpol_common_t * common,
+						 const qpol_name_t ** name);
+
+/**
+ *  Get the interned name of a role.
+ *  @param policy The policy associated with the role.
+ *  @param datum Role whose name to get.
+ *  @param name Pointer in which to store the interned name.  Must be
+ *  non-NULL.  The caller should not free this pointer.
+ *  @return Returns 0 on success and < 0 on failure; if the call fails,
+ *  errno will be set and *name will be NULL.
+ */
+	extern int qpol_role_get_interned_name(const qpol_policy_t * policy, const qpol_role_t * datum, const qpol_name_t ** name);
+
+/**
+ *  Get the interned name of a user.
+ *  @param policy The policy associated with the user.
+ *  @param datum User whose name to get.
+ *  @param name Pointer in which to store the interned name.  Must be
+ *  non-NULL.  The caller should not free this pointer.
+ *  @return Returns 0 on success and < 0 on failure; if the call fails,
+ *  errno will be set and *name will be NULL.
+ */
+	extern int qpol_user_get_interned_name(const qpol_policy_t * policy, const qpol_user_t * datum, const qpol_name_t ** name);
+
+/**
+ *  Get the interned name of a conditional boolean.
+ *  @param policy The policy associated with the boolean.
+ *  @param datum Boolean whose name to get.
+ *  @param name Pointer in which to store the interned name.  Must be
+ *  non-NULL.  The caller should not free this pointer.
+ *  @return Returns 0 on success and < 0 on failure; if the call fails,
+ *  errno will be set and *name will be NULL.
+ */
+	extern int qpol_bool_get_interned_name(const qpol_policy_t * policy, const qpol_bool_t * datum, const qpol_name_t ** name);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif				       /* QPOL_NAME_TABLE_H */
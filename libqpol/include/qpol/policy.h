@@ -63,6 +63,7 @@ extern "C"
 #include <qpol/terule_query.h>
 #include <qpol/type_query.h>
 #include <qpol/user_query.h>
+#include <qpol/name_table.h>
 
 	typedef void (*qpol_callback_fn_t) (void *varg, const struct qpol_policy * policy, int level, const char *fmt,
 					    va_list va_args);
@@ -194,6 +194,30 @@ int qpol_avrule_get_perm_iter(const qpol_policy_t * policy, const qpol_avrule_t
 	return STATUS_SUCCESS;
 }
 
+int qpol_avrule_get_perm_mask(const qpol_policy_t * policy, const qpol_avrule_t * rule, uint32_t * perm_mask)
+{
+	avtab_ptr_t avrule = NULL;
+
+	if (perm_mask) {
+		*perm_mask = 0;
+	}
+
+	if (!policy || !rule || !perm_mask) {
+		ERR(policy, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return STATUS_ERR;
+	}
+
+	avrule = (avtab_ptr_t) rule;
+	if (avrule->key.specified & QPOL_RULE_DONTAUDIT) {
+		*perm_mask = ~(avrule->datum.data);	/* stored as auditdeny flip the bits */
+	} else {
+		*perm_mask = avrule->datum.data;
+	}
+
+	return STATUS_SUCCESS;
+}
+
 int qpol_avrule_get_rule_type(const qpol_policy_t * policy, const qpol_avrule_t * rule, uint32_t * rule_type)
 {
 	policydb_t *db = NULL;
@@ -286,3 +310,104 @@ int qpol_avrule_get_which_list(const qpol_policy_t * policy, const qpol_avrule_t
 
 	return STATUS_SUCCESS;
 }
+
+/**
+ * Combine every rule in an access vector table with the given key
+ * into the access computed so far.  Conditional rules are skipped
+ * unless enabled.
+ */
+static void compute_access_search(avtab_t * avtab, avtab_key_t * key, int is_cond, qpol_access_t * access, uint32_t * auditdeny)
+{
+	avtab_ptr_t node;
+
+	for (node = avtab_search_node(avtab, key); node != NULL; node = avtab_search_node_next(node, key->specified)) {
+		if (is_cond && !(node->merged & QPOL_COND_RULE_ENABLED))
+			continue;
+		if (node->key.specified & QPOL_RULE_ALLOW)
+			access->allowed |= node->datum.data;
+		else if (node->key.specified & QPOL_RULE_AUDITALLOW)
+			access->auditallow |= node->datum.data;
+		else if (node->key.specified & QPOL_RULE_DONTAUDIT)
+			*auditdeny &= node->datum.data;
+		else if (node->key.specified & QPOL_RULE_NEVERALLOW)
+			access->neverallow |= node->datum.data;
+	}
+}
+
+/**
+ * Look up the rules from a single source value to the target type
+ * and each of its attributes.
+ */
+static void compute_access_target(policydb_t * db, avtab_key_t * key, const type_datum_t * target, uint32_t target_value,
+				  qpol_access_t * access, uint32_t * auditdeny)
+{
+	ebitmap_node_t *node;
+	uint32_t bit;
+
+	key->target_type = target_value;
+	compute_access_search(&db->te_avtab, key, 0, access, auditdeny);
+	compute_access_search(&db->te_cond_avtab, key, 1, access, auditdeny);
+	ebitmap_for_each_bit(&target->types, node, bit) {
+		if (!ebitmap_node_get_bit(node, bit) || bit + 1 == target_value)
+			continue;
+		key->target_type = bit + 1;
+		compute_access_search(&db->te_avtab, key, 0, access, auditdeny);
+		compute_access_search(&db->te_cond_avtab, key, 1, access, auditdeny);
+	}
+}
+
+int qpol_policy_compute_access(const qpol_policy_t * policy, const qpol_type_t * source, const qpol_type_t * target,
+			       const qpol_class_t * obj_class, qpol_access_t * access)
+{
+	policydb_t *db;
+	const type_datum_t *src, *tgt;
+	avtab_key_t key;
+	ebitmap_node_t *node;
+	uint32_t src_value, tgt_value, class_value, bit, auditdeny = ~0U;
+
+	if (access != NULL) {
+		memset(access, 0, sizeof(*access));
+	}
+	if (policy == NULL || source == NULL || target == NULL || obj_class == NULL || access == NULL) {
+		ERR(policy, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return STATUS_ERR;
+	}
+	if (!qpol_policy_has_capability(policy, QPOL_CAP_RULES_LOADED)) {
+		ERR(policy, "%s", "Cannot compute access: Rules not loaded");
+		errno = ENOTSUP;
+		return STATUS_ERR;
+	}
+
+	db = &policy->p->p;
+	if (qpol_type_get_value(policy, source, &src_value) || qpol_type_get_value(policy, target, &tgt_value) ||
+	    qpol_class_get_value(policy, obj_class, &class_value)) {
+		return STATUS_ERR;
+	}
+	/* aliases resolve to their primary's value */
+	src = db->type_val_to_struct[src_value - 1];
+	tgt = db->type_val_to_struct[tgt_value - 1];
+	if (src->flavor == TYPE_ATTRIB || tgt->flavor == TYPE_ATTRIB) {
+		ERR(policy, "%s", "Access may only be computed between types, not attributes");
+		errno = EINVAL;
+		return STATUS_ERR;
+	}
+
+	/* as in the kernel, look up the rules for every pair of
+	 * attributes; a non-attribute type's bitmap holds the
+	 * attributes to which it belongs */
+	memset(&key, 0, sizeof(key));
+	key.target_class = (uint16_t) class_value;
+	key.specified = QPOL_RULE_ALLOW | QPOL_RULE_AUDITALLOW | QPOL_RULE_DONTAUDIT | QPOL_RULE_NEVERALLOW;
+	key.source_type = (uint16_t) src_value;
+	compute_access_target(db, &key, tgt, tgt_value, access, &auditdeny);
+	ebitmap_for_each_bit(&src->types, node, bit) {
+		if (!ebitmap_node_get_bit(node, bit) || bit + 1 == src_value)
+			continue;
+		key.source_type = (uint16_t) (bit + 1);
+		compute_access_target(db, &key, tgt, tgt_value, access, &auditdeny);
+	}
+	access->dontaudit = ~auditdeny;
+
+	return STATUS_SUCCESS;
+}
@@ -746,11 +746,74 @@ static void *cexpr_name_state_get_cur_type(const qpol_iterator_t * iter)
 	return name;
 }
 
+/**
+ * Create an iterator over the names within one or two of an
+ * expression node's bitmaps.
+ * @param policy The policy from which the expression comes.
+ * @param internal_expr The expression node.
+ * @param inc Bitmap of names to return.
+ * @param sub If not NULL, bitmap of subtracted names to return after
+ * those in inc.
+ * @param iter Iterator over items of type char* returned.
+ * @return 0 on success and < 0 on failure.
+ */
+static int cexpr_names_iter_create(const qpol_policy_t * policy, const constraint_expr_t * internal_expr, ebitmap_t * inc,
+				   ebitmap_t * sub, qpol_iterator_t ** iter)
+{
+	cexpr_name_state_t *cns = NULL;
+	ebitmap_t *bmap = NULL;
+	void *(*get_cur) (const qpol_iterator_t *) = NULL;
+
+	switch (internal_expr->attr & ~(QPOL_CEXPR_SYM_TARGET | QPOL_CEXPR_SYM_XTARGET)) {
+	case QPOL_CEXPR_SYM_USER:
+		get_cur = cexpr_name_state_get_cur_user;
+		break;
+	case QPOL_CEXPR_SYM_ROLE:
+		get_cur = cexpr_name_state_get_cur_role;
+		break;
+	case QPOL_CEXPR_SYM_TYPE:
+		get_cur = cexpr_name_state_get_cur_type;
+		break;
+	default:
+		ERR(policy, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return STATUS_ERR;
+	}
+
+	if (!(cns = calloc(1, sizeof(cexpr_name_state_t)))) {
+		ERR(policy, "%s", strerror(ENOMEM));
+		errno = ENOMEM;
+		return STATUS_ERR;
+	}
+	cns->inc = inc;
+	cns->sub = sub;
+	if (cns->inc->node) {
+		cns->list = QPOL_CEXPR_NAME_STATE_INC_LIST;
+		cns->cur = cns->inc->node->startbit;
+	} else {
+		/* nothing is included, so start with the subtracted names */
+		cns->list = QPOL_CEXPR_NAME_STATE_SUB_LIST;
+		cns->cur = (cns->sub && cns->sub->node) ? cns->sub->node->startbit : 0;
+	}
+
+	if (qpol_iterator_create(policy, (void *)cns, get_cur, cexpr_name_state_next,
+				 cexpr_name_state_end, cexpr_name_state_size, free, iter)) {
+		free(cns);
+		return STATUS_ERR;
+	}
+
+	bmap = (cns->list == QPOL_CEXPR_NAME_STATE_INC_LIST ? cns->inc : cns->sub);
+	if (bmap && bmap->node && !ebitmap_get_bit(bmap, cns->cur))
+		qpol_iterator_next(*iter);
+
+	return STATUS_SUCCESS;
+}
+
 int qpol_constraint_expr_node_get_names_iter(const qpol_policy_t * policy, const qpol_constraint_expr_node_t * expr,
 					     qpol_iterator_t ** iter)
 {
 	constraint_expr_t *internal_expr = NULL;
-	cexpr_name_state_t *cns = NULL;
+	ebitmap_t *inc = NULL, *sub = NULL;
 	int policy_type = 0;
 
 	if (iter)
@@ -773,72 +836,51 @@ int qpol_constraint_expr_node_get_names_iter(const qpol_policy_t * policy, const
 		return STATUS_ERR;
 	}
 
-	if (!(cns = calloc(1, sizeof(cexpr_name_state_t)))) {
-		ERR(policy, "%s", strerror(ENOMEM));
-		errno = ENOMEM;
-		return STATUS_ERR;
-	}
-
 	int policy_version;
 	if (qpol_policy_get_policy_version(policy, &policy_version))
 		return STATUS_ERR;
 
 	if (internal_expr->attr & QPOL_CEXPR_SYM_TYPE) {
 		if (policy_type == QPOL_POLICY_KERNEL_BINARY && policy_version <= 28) {
-			cns->inc = &(internal_expr->names);
+			inc = &(internal_expr->names);
 		} else if (policy_type == QPOL_POLICY_KERNEL_BINARY && policy_version > 28) {
-			cns->inc = &(internal_expr->type_names->types);
+			inc = &(internal_expr->type_names->types);
 		} else {
-			cns->inc = &(internal_expr->type_names->types);
-			cns->sub = &(internal_expr->type_names->negset);
+			inc = &(internal_expr->type_names->types);
+			sub = &(internal_expr->type_names->negset);
 		}
 	} else {
-		cns->inc = &(internal_expr->names);
+		inc = &(internal_expr->names);
 	}
-	cns->list = QPOL_CEXPR_NAME_STATE_INC_LIST;
-	cns->cur = cns->inc->node ? cns->inc->node->startbit : 0;
 
-	switch (internal_expr->attr & ~(QPOL_CEXPR_SYM_TARGET | QPOL_CEXPR_SYM_XTARGET)) {
-	case QPOL_CEXPR_SYM_USER:
-	{
-		if (qpol_iterator_create(policy, (void *)cns,
-					 cexpr_name_state_get_cur_user, cexpr_name_state_next,
-					 cexpr_name_state_end, cexpr_name_state_size, free, iter)) {
-			return STATUS_ERR;
-		}
-		break;
-	}
-	case QPOL_CEXPR_SYM_ROLE:
-	{
-		if (qpol_iterator_create(policy, (void *)cns,
-					 cexpr_name_state_get_cur_role, cexpr_name_state_next,
-					 cexpr_name_state_end, cexpr_name_state_size, free, iter)) {
-			return STATUS_ERR;
-		}
-		break;
-	}
-	case QPOL_CEXPR_SYM_TYPE:
-	{
-		if (qpol_iterator_create(policy, (void *)cns,
-					 cexpr_name_state_get_cur_type, cexpr_name_state_next,
-					 cexpr_name_state_end, cexpr_name_state_size, free, iter)) {
-			return STATUS_ERR;
-		}
-		break;
-	}
-	default:
-	{
+	return cexpr_names_iter_create(policy, internal_expr, inc, sub, iter);
+}
+
+int qpol_constraint_expr_node_get_expanded_names_iter(const qpol_policy_t * policy, const qpol_constraint_expr_node_t * expr,
+						      qpol_iterator_t ** iter)
+{
+	constraint_expr_t *internal_expr = NULL;
+
+	if (iter)
+		*iter = NULL;
+
+	if (!policy || !expr || !iter) {
 		ERR(policy, "%s", strerror(EINVAL));
-		free(cns);
 		errno = EINVAL;
 		return STATUS_ERR;
 	}
-	}
 
-	if (cns->inc->node && !ebitmap_get_bit(cns->inc, cns->cur))
-		qpol_iterator_next(*iter);
+	internal_expr = (constraint_expr_t *) expr;
 
-	return STATUS_SUCCESS;
+	if (internal_expr->expr_type != QPOL_CEXPR_TYPE_NAMES) {
+		ERR(policy, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return STATUS_ERR;
+	}
+
+	/* for every kind of policy, names holds the set after
+	 * attributes, subtracted types, '*', and '~' are applied */
+	return cexpr_names_iter_create(policy, internal_expr, &(internal_expr->names), NULL, iter);
 }
 
 typedef struct class_constr_state
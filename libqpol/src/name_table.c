@@ -0,0 +1,381 @@
+/**
+ *  @file
+ *  Implementation of the policy's table of interned symbol names.
+ *
+ *  @author agent agent@local
+ *
+ *  Copyright (C) 2026 agent
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <qpol/policy.h>
+#include <qpol/name_table.h>
+#include <sepol/policydb/policydb.h>
+#include <sepol/policydb/hashtab.h>
+#include "qpol_internal.h"
+
+/** Initial number of hash buckets; must be a power of 2. */
+#define NAME_TABLE_INIT_BUCKETS 1024
+
+typedef struct name_entry
+{
+	qpol_name_t name;
+	struct name_entry *next;
+	/** storage for name.str */
+	char buf[];
+} name_entry_t;
+
+/** The kinds of symbols indexed by value. */
+enum name_kind
+{
+	NAME_KIND_TYPE = 0,
+	NAME_KIND_CLASS,
+	NAME_KIND_COMMON,
+	NAME_KIND_ROLE,
+	NAME_KIND_USER,
+	NAME_KIND_BOOL,
+	NAME_KIND_NUM
+};
+
+struct qpol_name_table
+{
+	/** every interned name, chained by hash */
+	name_entry_t **buckets;
+	size_t num_buckets;
+	size_t num_names;
+	/** for each kind of symbol, its names indexed by value - 1 */
+	const qpol_name_t **by_value[NAME_KIND_NUM];
+	size_t num_values[NAME_KIND_NUM];
+	/** permission names for each class indexed by class value - 1,
+	 *  then by permission value - 1 */
+	const qpol_name_t *(*perms)[32];
+};
+
+uint32_t qpol_name_hash(const char *str, size_t len)
+{
+	/* FNV-1a */
+	uint32_t h = 2166136261U;
+	size_t i;
+	for (i = 0; i < len; i++) {
+		h = (h ^ (unsigned char)str[i]) * 16777619U;
+	}
+	return h;
+}
+
+void qpol_name_table_destroy(struct qpol_name_table **table)
+{
+	name_entry_t *entry, *next;
+	size_t i;
+	if (table == NULL || *table == NULL)
+		return;
+	for (i = 0; i < (*table)->num_buckets; i++) {
+		for (entry = (*table)->buckets[i]; entry != NULL; entry = next) {
+			next = entry->next;
+			free(entry);
+		}
+	}
+	free((*table)->buckets);
+	for (i = 0; i < NAME_KIND_NUM; i++) {
+		free((*table)->by_value[i]);
+	}
+	free((*table)->perms);
+	free(*table);
+	*table = NULL;
+}
+
+static const qpol_name_t *name_table_find(const struct qpol_name_table *table, const char *str, size_t len, uint32_t hash)
+{
+	name_entry_t *entry;
+	for (entry = table->buckets[hash & (table->num_buckets - 1)]; entry != NULL; entry = entry->next) {
+		if (entry->name.hash == hash && entry->name.len == len && memcmp(entry->name.str, str, len) == 0) {
+			return &entry->name;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Double the number of buckets.  Failing to allocate new buckets is
+ * not an error; lookups merely get slower.
+ */
+static void name_table_grow(struct qpol_name_table *table)
+{
+	name_entry_t **buckets, *entry, *next;
+	size_t i, num_buckets = table->num_buckets * 2;
+	if ((buckets = calloc(num_buckets, sizeof(*buckets))) == NULL) {
+		return;
+	}
+	for (i = 0; i < table->num_buckets; i++) {
+		for (entry = table->buckets[i]; entry != NULL; entry = next) {
+			next = entry->next;
+			entry->next = buckets[entry->name.hash & (num_buckets - 1)];
+			buckets[entry->name.hash & (num_buckets - 1)] = entry;
+		}
+	}
+	free(table->buckets);
+	table->buckets = buckets;
+	table->num_buckets = num_buckets;
+}
+
+/**
+ * Return the interned copy of a string, adding it to the table if
+ * it is not already there.
+ *
+ * @return The interned name, or NULL on error.
+ */
+static const qpol_name_t *name_table_intern(struct qpol_name_table *table, const char *str)
+{
+	size_t len = strlen(str);
+	uint32_t hash = qpol_name_hash(str, len);
+	const qpol_name_t *name;
+	name_entry_t *entry;
+	if ((name = name_table_find(table, str, len, hash)) != NULL) {
+		return name;
+	}
+	if ((entry = malloc(sizeof(*entry) + len + 1)) == NULL) {
+		return NULL;
+	}
+	memcpy(entry->buf, str, len + 1);
+	entry->name.str = entry->buf;
+	entry->name.len = len;
+	entry->name.hash = hash;
+	entry->next = table->buckets[hash & (table->num_buckets - 1)];
+	table->buckets[hash & (table->num_buckets - 1)] = entry;
+	if (++table->num_names > table->num_buckets) {
+		name_table_grow(table);
+	}
+	return &entry->name;
+}
+
+/**
+ * Intern every name within a symbol's value to name array.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+static int name_table_add_kind(struct qpol_name_table *table, enum name_kind kind, char **val_to_name, uint32_t nprim)
+{
+	uint32_t i;
+	table->num_values[kind] = nprim;
+	if (nprim == 0) {
+		return 0;
+	}
+	if ((table->by_value[kind] = calloc(nprim, sizeof(*table->by_value[kind]))) == NULL) {
+		return -1;
+	}
+	for (i = 0; i < nprim; i++) {
+		/* a symbol may have no name, such as an attribute
+		 * within a binary policy without an extended image */
+		if (val_to_name[i] != NULL && (table->by_value[kind][i] = name_table_intern(table, val_to_name[i])) == NULL) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+struct name_table_perm_arg
+{
+	struct qpol_name_table *table;
+	const qpol_name_t **perms;
+};
+
+static int name_table_add_perm(hashtab_key_t key, hashtab_datum_t datum, void *args)
+{
+	struct name_table_perm_arg *arg = (struct name_table_perm_arg *)args;
+	perm_datum_t *perm = (perm_datum_t *) datum;
+	if (perm->s.value >= 1 && perm->s.value <= 32) {
+		if ((arg->perms[perm->s.value - 1] = name_table_intern(arg->table, (const char *)key)) == NULL) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+int qpol_policy_build_name_table(qpol_policy_t * policy)
+{
+	struct qpol_name_table *table = NULL;
+	struct name_table_perm_arg arg;
+	policydb_t *db;
+	class_datum_t *cls;
+	uint32_t i;
+	int error;
+
+	db = &policy->p->p;
+	if ((table = calloc(1, sizeof(*table))) == NULL ||
+	    (table->buckets = calloc(NAME_TABLE_INIT_BUCKETS, sizeof(*table->buckets))) == NULL) {
+		goto err;
+	}
+	table->num_buckets = NAME_TABLE_INIT_BUCKETS;
+	if (name_table_add_kind(table, NAME_KIND_TYPE, db->p_type_val_to_name, db->p_types.nprim) < 0 ||
+	    name_table_add_kind(table, NAME_KIND_CLASS, db->p_class_val_to_name, db->p_classes.nprim) < 0 ||
+	    name_table_add_kind(table, NAME_KIND_COMMON, db->p_common_val_to_name, db->p_commons.nprim) < 0 ||
+	    name_table_add_kind(table, NAME_KIND_ROLE, db->p_role_val_to_name, db->p_roles.nprim) < 0 ||
+	    name_table_add_kind(table, NAME_KIND_USER, db->p_user_val_to_name, db->p_users.nprim) < 0 ||
+	    name_table_add_kind(table, NAME_KIND_BOOL, db->p_bool_val_to_name, db->p_bools.nprim) < 0) {
+		goto err;
+	}
+	if (db->p_classes.nprim > 0 && (table->perms = calloc(db->p_classes.nprim, sizeof(*table->perms))) == NULL) {
+		goto err;
+	}
+	arg.table = table;
+	for (i = 0; i < db->p_classes.nprim; i++) {
+		if ((cls = db->class_val_to_struct[i]) == NULL) {
+			continue;
+		}
+		arg.perms = table->perms[i];
+		if (hashtab_map(cls->permissions.table, name_table_add_perm, &arg) != 0 ||
+		    (cls->comdatum != NULL && hashtab_map(cls->comdatum->permissions.table, name_table_add_perm, &arg) != 0)) {
+			goto err;
+		}
+	}
+	qpol_name_table_destroy(&policy->names);
+	policy->names = table;
+	return STATUS_SUCCESS;
+
+      err:
+	error = ENOMEM;
+	ERR(policy, "%s", strerror(error));
+	qpol_name_table_destroy(&table);
+	errno = error;
+	return STATUS_ERR;
+}
+
+/**
+ * Get the policy's name table.
+ *
+ * @param policy Policy whose names to get.
+ *
+ * @return The table, or NULL on error with errno set.
+ */
+static const struct qpol_name_table *name_table_get(const qpol_policy_t * policy)
+{
+	if (policy->names == NULL) {
+		ERR(policy, "%s", "Policy has no name table.");
+		errno = ENOTSUP;
+		return NULL;
+	}
+	return policy->names;
+}
+
+int qpol_name_lookup(const qpol_policy_t * policy, const char *str, const qpol_name_t ** name)
+{
+	const struct qpol_name_table *table;
+	size_t len;
+
+	if (name != NULL)
+		*name = NULL;
+	if (policy == NULL || str == NULL || name == NULL) {
+		ERR(policy, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return STATUS_ERR;
+	}
+	if ((table = name_table_get(policy)) == NULL) {
+		return STATUS_ERR;
+	}
+	len = strlen(str);
+	if ((*name = name_table_find(table, str, len, qpol_name_hash(str, len))) == NULL) {
+		errno = ENOENT;
+		return STATUS_ERR;
+	}
+	return STATUS_SUCCESS;
+}
+
+/**
+ * Get the interned name of the symbol whose datum begins with the
+ * given symtab datum.
+ */
+static int name_table_get_symbol(const qpol_policy_t * policy, enum name_kind kind, const symtab_datum_t * datum,
+				 const qpol_name_t ** name)
+{
+	const struct qpol_name_table *table;
+
+	if (name != NULL)
+		*name = NULL;
+	if (policy == NULL || datum == NULL || name == NULL) {
+		ERR(policy, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return STATUS_ERR;
+	}
+	if ((table = name_table_get(policy)) == NULL) {
+		return STATUS_ERR;
+	}
+	if (datum->value < 1 || datum->value > table->num_values[kind] || table->by_value[kind][datum->value - 1] == NULL) {
+		ERR(policy, "%s", strerror(ENOENT));
+		errno = ENOENT;
+		return STATUS_ERR;
+	}
+	*name = table->by_value[kind][datum->value - 1];
+	return STATUS_SUCCESS;
+}
+
+int qpol_type_get_interned_name(const qpol_policy_t * policy, const qpol_type_t * datum, const qpol_name_t ** name)
+{
+	return name_table_get_symbol(policy, NAME_KIND_TYPE, &((const type_datum_t *)datum)->s, name);
+}
+
+int qpol_class_get_interned_name(const qpol_policy_t * policy, const qpol_class_t * obj_class, const qpol_name_t ** name)
+{
+	return name_table_get_symbol(policy, NAME_KIND_CLASS, &((const class_datum_t *)obj_class)->s, name);
+}
+
+int qpol_common_get_interned_name(const qpol_policy_t * policy, const qpol_common_t * common, const qpol_name_t ** name)
+{
+	return name_table_get_symbol(policy, NAME_KIND_COMMON, &((const common_datum_t *)common)->s, name);
+}
+
+int qpol_role_get_interned_name(const qpol_policy_t * policy, const qpol_role_t * datum, const qpol_name_t ** name)
+{
+	return name_table_get_symbol(policy, NAME_KIND_ROLE, &((const role_datum_t *)datum)->s, name);
+}
+
+int qpol_user_get_interned_name(const qpol_policy_t * policy, const qpol_user_t * datum, const qpol_name_t ** name)
+{
+	return name_table_get_symbol(policy, NAME_KIND_USER, &((const user_datum_t *)datum)->s, name);
+}
+
+int qpol_bool_get_interned_name(const qpol_policy_t * policy, const qpol_bool_t * datum, const qpol_name_t ** name)
+{
+	return name_table_get_symbol(policy, NAME_KIND_BOOL, &((const cond_bool_datum_t *)datum)->s, name);
+}
+
+int qpol_class_get_interned_perm_name(const qpol_policy_t * policy, const qpol_class_t * obj_class, uint32_t perm_value,
+				      const qpol_name_t ** name)
+{
+	const struct qpol_name_table *table;
+	uint32_t class_value;
+
+	if (name != NULL)
+		*name = NULL;
+	if (policy == NULL || obj_class == NULL || name == NULL) {
+		ERR(policy, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return STATUS_ERR;
+	}
+	if ((table = name_table_get(policy)) == NULL) {
+		return STATUS_ERR;
+	}
+	class_value = ((const class_datum_t *)obj_class)->s.value;
+	if (class_value < 1 || class_value > table->num_values[NAME_KIND_CLASS] || perm_value < 1 || perm_value > 32 ||
+	    (*name = table->perms[class_value - 1][perm_value - 1]) == NULL) {
+		errno = ENOENT;
+		return STATUS_ERR;
+	}
+	return STATUS_SUCCESS;
+}
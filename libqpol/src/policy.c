@@ -808,6 +808,10 @@ int qpol_policy_rebuild_opt(qpol_policy_t * policy, const int options)
 	policy->p = NULL;
 	struct qpol_extended_image *ext = policy->ext;
 	policy->ext = NULL;
+	/* symbol values may change, so the extension builds a new table
+	 * of names */
+	struct qpol_name_table *names = policy->names;
+	policy->names = NULL;
 	old_options = policy->options;
 	policy->options = options;
 
@@ -899,6 +903,7 @@ int qpol_policy_rebuild_opt(qpol_policy_t * policy, const int options)
 		goto err;
 	}
 	qpol_extended_image_destroy(&ext);
+	qpol_name_table_destroy(&names);
 
 	sepol_policydb_free(old_p);
 
@@ -909,6 +914,8 @@ int qpol_policy_rebuild_opt(qpol_policy_t * policy, const int options)
 
 	policy->p = old_p;
 	policy->ext = ext;
+	qpol_name_table_destroy(&policy->names);
+	policy->names = names;
 	policy->options = old_options;
 	errno = error;
 	return STATUS_ERR;
@@ -1236,6 +1243,11 @@ int qpol_policy_open_from_memory_opt(qpol_policy_t ** policy, const char *fileda
 		goto err;
 	}
 
+	if (qpol_policy_build_name_table(*policy)) {
+		error = errno;
+		goto err;
+	}
+
 	return 0;
       err:
 	qpol_policy_destroy(policy);
@@ -1278,6 +1290,7 @@ void qpol_policy_destroy(qpol_policy_t ** policy)
 		sepol_policydb_free((*policy)->p);
 		sepol_handle_destroy((*policy)->sh);
 		qpol_extended_image_destroy(&((*policy)->ext));
+		qpol_name_table_destroy(&((*policy)->names));
 		if ((*policy)->modules) {
 			size_t i = 0;
 			for (i = 0; i < (*policy)->num_modules; i++) {
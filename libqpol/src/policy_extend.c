@@ -1111,6 +1111,12 @@ int policy_extend(qpol_policy_t * policy)
 		goto err;
 	}
 
+	/* all symbols are now present, so intern their names */
+	if (qpol_policy_build_name_table(policy)) {
+		error = errno;
+		goto err;
+	}
+
 	if (policy->options & QPOL_POLICY_OPTION_NO_RULES)
 		return STATUS_SUCCESS;
 
@@ -43,6 +43,7 @@ extern "C"
 #define QPOL_MSG_INFO 3
 
 	struct qpol_extended_image;
+	struct qpol_name_table;
 	struct qpol_policy;
 
 	struct qpol_module
@@ -66,6 +67,9 @@ extern "C"
 		int type;
 		int modified;
 		struct qpol_extended_image *ext;
+	/** interned symbol names, built when the policy is loaded;
+	 *  see name_table.c */
+		struct qpol_name_table *names;
 		struct qpol_module **modules;
 		size_t num_modules;
 		char *file_data;
@@ -93,6 +97,23 @@ extern "C"
  */
 	int policy_extend(qpol_policy_t * policy);
 
+/**
+ *  Build a policy's table of interned names, replacing any existing
+ *  table.  This is done once the policy's symbols are final, so that
+ *  the table is never modified while the policy is being queried.
+ *  @param policy The policy whose names to intern.
+ *  @return Returns 0 on success and < 0 on failure; if the call fails,
+ *  errno will be set and the policy's existing table is unchanged.
+ */
+	int qpol_policy_build_name_table(qpol_policy_t * policy);
+
+/**
+ *  Destroy a policy's table of interned names, freeing all memory
+ *  used.
+ *  @param table Reference pointer to the table to be destroyed.
+ */
+	void qpol_name_table_destroy(struct qpol_name_table **table);
+
 	extern void qpol_handle_msg(const qpol_policy_t * policy, int level, const char *fmt, ...);
 	int qpol_is_file_binpol(FILE * fp);
 	int qpol_is_file_mod_pkg(FILE * fp);
@@ -26,6 +26,7 @@
 #include <config.h>
 
 #include <qpol/syn_rule_query.h>
+#include <qpol/name_table.h>
 #include <sepol/policydb/policydb.h>
 #include <sepol/policydb/util.h>
 #include <sepol/policydb/conditional.h>
@@ -435,7 +436,8 @@ int qpol_syn_avrule_get_perm_iter(const qpol_policy_t * policy, const qpol_syn_a
 {
 	avrule_t *internal_rule = NULL;
 	policydb_t *db = NULL;
-	char **perm_list, *tmp = NULL, **tmp_copy = NULL;
+	char **perm_list, **tmp_copy = NULL;
+	const qpol_name_t *name = NULL, **names = NULL;
 	class_perm_node_t *node = NULL;
 	size_t node_num = 0, i, cur, perm_list_sz = 0;
 	int error = 0;
@@ -457,9 +459,12 @@ int qpol_syn_avrule_get_perm_iter(const qpol_policy_t * policy, const qpol_syn_a
 
 	/* for now allocate space for maximum number of unique perms */
 	perm_list = calloc(node_num * 32, sizeof(char *));
-	if (!perm_list) {
+	names = calloc(node_num * 32, sizeof(*names));
+	if (!perm_list || !names) {
 		error = errno;
 		ERR(policy, "%s", strerror(error));
+		free(perm_list);
+		free(names);
 		errno = error;
 		return STATUS_ERR;
 	}
@@ -468,26 +473,27 @@ int qpol_syn_avrule_get_perm_iter(const qpol_policy_t * policy, const qpol_syn_a
 		for (i = 0; i < db->class_val_to_struct[node->tclass - 1]->permissions.nprim; i++) {
 			if (!(node->data & (1 << i)))
 				continue;
-			tmp = sepol_av_to_string(db, node->tclass, (sepol_access_vector_t) (1 << i));
-			if (tmp) {
-				tmp++; /* remove prepended space */
-				for (cur = 0; cur < perm_list_sz; cur++)
-					if (!strcmp(tmp, perm_list[cur]))
-						break;
-				if (cur < perm_list_sz)
-					continue;
-				perm_list[perm_list_sz] = strdup(tmp);
-				if (!(perm_list[perm_list_sz])) {
-					error = errno;
-					ERR(policy, "%s", strerror(error));
-					goto err;
-				}
-				perm_list_sz++;
-			} else {
+			if (qpol_class_get_interned_perm_name(policy, (qpol_class_t *) db->class_val_to_struct[node->tclass - 1], i + 1,
+							      &name)) {
 				error = errno;
 				ERR(policy, "%s", strerror(error));
 				goto err;
 			}
+			/* the same permission within different classes has
+			 * the same interned name */
+			for (cur = 0; cur < perm_list_sz; cur++)
+				if (names[cur] == name)
+					break;
+			if (cur < perm_list_sz)
+				continue;
+			perm_list[perm_list_sz] = strdup(name->str);
+			if (!(perm_list[perm_list_sz])) {
+				error = errno;
+				ERR(policy, "%s", strerror(error));
+				goto err;
+			}
+			names[perm_list_sz] = name;
+			perm_list_sz++;
 		}
 	}
 
@@ -499,6 +505,8 @@ int qpol_syn_avrule_get_perm_iter(const qpol_policy_t * policy, const qpol_syn_a
 		goto err;
 	}
 	perm_list = tmp_copy;
+	free(names);
+	names = NULL;
 
 	srps = calloc(1, sizeof(syn_rule_perm_state_t));
 	if (!srps) {
@@ -524,6 +532,7 @@ int qpol_syn_avrule_get_perm_iter(const qpol_policy_t * policy, const qpol_syn_a
 	for (i = 0; i < perm_list_sz; i++)
 		free(perm_list[i]);
 	free(perm_list);
+	free(names);
 	errno = error;
 	return STATUS_ERR;
 }
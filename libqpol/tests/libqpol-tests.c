@@ -30,6 +30,7 @@
 
 #include "capabilities-tests.h"
 #include "iterators-tests.h"
+#include "name-table-tests.h"
 #include "policy-features-tests.h"
 
 int main(void)
@@ -43,6 +44,8 @@ int main(void)
 		,
 		{"Iterators", iterators_init, iterators_cleanup, iterators_tests}
 		,
+		{"Name Table", name_table_init, name_table_cleanup, name_table_tests}
+		,
 		{"Policy Featurens", policy_features_init, policy_features_cleanup, policy_features_tests}
 		,
 		CU_SUITE_INFO_NULL
@@ -0,0 +1,335 @@
+/**
+ *  @file
+ *
+ *  Test the policy's table of interned names, and the syntactic rule
+ *  permission lookups that use it, against a small policy.
+ *
+ *  @author agent agent@local
+ *
+ *  Copyright (C) 2026 agent
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <config.h>
+
+#include <CUnit/CUnit.h>
+#include <qpol/policy.h>
+#include <qpol/avrule_query.h>
+#include <qpol/bool_query.h>
+#include <qpol/class_perm_query.h>
+#include <qpol/name_table.h>
+#include <qpol/policy_extend.h>
+#include <qpol/role_query.h>
+#include <qpol/syn_rule_query.h>
+#include <qpol/type_query.h>
+#include <qpol/user_query.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * A policy in which read is a permission of both classes, inherited
+ * by file from its common but dir's own, and is granted to both
+ * classes by one rule.
+ */
+static const char *name_table_policy =
+	"class file\n"
+	"class dir\n"
+	"sid kernel\n"
+	"common file_common { ioctl read write }\n"
+	"class file inherits file_common { execute }\n"
+	"class dir { read search }\n"
+	"type user_t;\n"
+	"type etc_t;\n"
+	"bool secure_mode false;\n"
+	"role user_r types { user_t etc_t };\n"
+	"allow user_t etc_t:file { execute read };\n"
+	"allow user_t etc_t:{ file dir } read;\n"
+	"allow user_t etc_t:dir search;\n"
+	"user user_u roles { user_r };\n"
+	"sid kernel user_u:user_r:user_t\n";
+
+static qpol_policy_t *qp = NULL;
+
+/**
+ * Check that an interned name matches a symbol's name, and that
+ * looking up that name finds the same interned name.
+ */
+static void name_table_check(const char *str, const qpol_name_t * name)
+{
+	const qpol_name_t *found = NULL;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(name);
+	CU_ASSERT_STRING_EQUAL(name->str, str);
+	CU_ASSERT_EQUAL(name->len, strlen(str));
+	CU_ASSERT_EQUAL(name->hash, qpol_name_hash(str, strlen(str)));
+	CU_ASSERT(qpol_name_lookup(qp, str, &found) == 0);
+	CU_ASSERT_PTR_EQUAL(found, name);
+}
+
+static void name_table_symbols(void)
+{
+	qpol_iterator_t *iter = NULL;
+	const qpol_type_t *type;
+	const qpol_class_t *obj_class;
+	const qpol_common_t *common;
+	const qpol_role_t *role;
+	const qpol_user_t *user;
+	qpol_bool_t *cond_bool;
+	const qpol_name_t *name;
+	size_t num_types = 0;
+
+	CU_ASSERT_FATAL(qpol_policy_get_type_by_name(qp, "user_t", &type) == 0);
+	CU_ASSERT(qpol_type_get_interned_name(qp, type, &name) == 0);
+	name_table_check("user_t", name);
+	CU_ASSERT_FATAL(qpol_policy_get_type_by_name(qp, "etc_t", &type) == 0);
+	CU_ASSERT(qpol_type_get_interned_name(qp, type, &name) == 0);
+	name_table_check("etc_t", name);
+	CU_ASSERT_FATAL(qpol_policy_get_type_iter(qp, &iter) == 0);
+	CU_ASSERT_FATAL(qpol_iterator_get_size(iter, &num_types) == 0);
+	qpol_iterator_destroy(&iter);
+	CU_ASSERT_EQUAL(num_types, 2);
+
+	CU_ASSERT_FATAL(qpol_policy_get_class_by_name(qp, "file", &obj_class) == 0);
+	CU_ASSERT(qpol_class_get_interned_name(qp, obj_class, &name) == 0);
+	name_table_check("file", name);
+	CU_ASSERT_FATAL(qpol_policy_get_class_by_name(qp, "dir", &obj_class) == 0);
+	CU_ASSERT(qpol_class_get_interned_name(qp, obj_class, &name) == 0);
+	name_table_check("dir", name);
+
+	CU_ASSERT_FATAL(qpol_policy_get_common_by_name(qp, "file_common", &common) == 0);
+	CU_ASSERT(qpol_common_get_interned_name(qp, common, &name) == 0);
+	name_table_check("file_common", name);
+
+	CU_ASSERT_FATAL(qpol_policy_get_role_by_name(qp, "user_r", &role) == 0);
+	CU_ASSERT(qpol_role_get_interned_name(qp, role, &name) == 0);
+	name_table_check("user_r", name);
+	/* object_r is declared implicitly */
+	CU_ASSERT_FATAL(qpol_policy_get_role_by_name(qp, "object_r", &role) == 0);
+	CU_ASSERT(qpol_role_get_interned_name(qp, role, &name) == 0);
+	name_table_check("object_r", name);
+
+	CU_ASSERT_FATAL(qpol_policy_get_user_by_name(qp, "user_u", &user) == 0);
+	CU_ASSERT(qpol_user_get_interned_name(qp, user, &name) == 0);
+	name_table_check("user_u", name);
+
+	CU_ASSERT_FATAL(qpol_policy_get_bool_by_name(qp, "secure_mode", &cond_bool) == 0);
+	CU_ASSERT(qpol_bool_get_interned_name(qp, cond_bool, &name) == 0);
+	name_table_check("secure_mode", name);
+}
+
+/**
+ * Check a class's interned permission names, by value, ending with the
+ * first value after its last permission.
+ */
+static void name_table_check_perms(const char *class_name, const char **perms, size_t num_perms)
+{
+	const qpol_class_t *obj_class;
+	const qpol_name_t *name;
+	uint32_t value;
+	CU_ASSERT_FATAL(qpol_policy_get_class_by_name(qp, class_name, &obj_class) == 0);
+	for (value = 1; value <= num_perms; value++) {
+		CU_ASSERT_FATAL(qpol_class_get_interned_perm_name(qp, obj_class, value, &name) == 0);
+		name_table_check(perms[value - 1], name);
+	}
+	name = (const qpol_name_t *)1;
+	CU_ASSERT(qpol_class_get_interned_perm_name(qp, obj_class, value, &name) < 0);
+	CU_ASSERT_EQUAL(errno, ENOENT);
+	CU_ASSERT_PTR_NULL(name);
+	CU_ASSERT(qpol_class_get_interned_perm_name(qp, obj_class, 0, &name) < 0);
+	CU_ASSERT(qpol_class_get_interned_perm_name(qp, obj_class, 33, &name) < 0);
+}
+
+static void name_table_perms(void)
+{
+	/* a common's permissions are numbered before the class's own */
+	const char *file_perms[] = { "ioctl", "read", "write", "execute" };
+	const char *dir_perms[] = { "read", "search" };
+	const qpol_class_t *obj_class;
+	const qpol_name_t *file_read = NULL, *dir_read = NULL;
+
+	name_table_check_perms("file", file_perms, sizeof(file_perms) / sizeof(file_perms[0]));
+	name_table_check_perms("dir", dir_perms, sizeof(dir_perms) / sizeof(dir_perms[0]));
+
+	/* a permission shared by several classes has a single interned
+	 * name */
+	CU_ASSERT_FATAL(qpol_policy_get_class_by_name(qp, "file", &obj_class) == 0);
+	CU_ASSERT_FATAL(qpol_class_get_interned_perm_name(qp, obj_class, 2, &file_read) == 0);
+	CU_ASSERT_FATAL(qpol_policy_get_class_by_name(qp, "dir", &obj_class) == 0);
+	CU_ASSERT_FATAL(qpol_class_get_interned_perm_name(qp, obj_class, 1, &dir_read) == 0);
+	CU_ASSERT_PTR_EQUAL(file_read, dir_read);
+}
+
+static void name_table_unknown(void)
+{
+	const qpol_name_t *name = (const qpol_name_t *)1;
+	CU_ASSERT(qpol_name_lookup(qp, "no_such_name_t", &name) < 0);
+	CU_ASSERT_EQUAL(errno, ENOENT);
+	CU_ASSERT_PTR_NULL(name);
+	CU_ASSERT(qpol_name_lookup(qp, "", &name) < 0);
+	CU_ASSERT(qpol_name_lookup(NULL, "user_t", &name) < 0);
+	CU_ASSERT_EQUAL(errno, EINVAL);
+	CU_ASSERT(qpol_name_lookup(qp, NULL, &name) < 0);
+	CU_ASSERT_EQUAL(errno, EINVAL);
+	CU_ASSERT(qpol_type_get_interned_name(qp, NULL, &name) < 0);
+	CU_ASSERT_EQUAL(errno, EINVAL);
+}
+
+/**
+ * Check the permissions of the syntactic rules behind the allow rule
+ * for a class, each rule's permissions joined by spaces.
+ */
+static void name_table_check_syn_perms(const char *class_name, const char **perms, size_t num_rules)
+{
+	qpol_iterator_t *iter = NULL, *syn_iter = NULL, *perm_iter = NULL;
+	unsigned char found[2] = { 0, 0 };
+	size_t num_avrules = 0, num_syn_rules = 0, i;
+
+	CU_ASSERT_FATAL(num_rules <= sizeof(found));
+	CU_ASSERT_FATAL(qpol_policy_get_avrule_iter(qp, QPOL_RULE_ALLOW, &iter) == 0);
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		qpol_avrule_t *rule;
+		const qpol_class_t *obj_class;
+		const char *name;
+		CU_ASSERT_FATAL(qpol_iterator_get_item(iter, (void **)&rule) == 0);
+		CU_ASSERT_FATAL(qpol_avrule_get_object_class(qp, rule, &obj_class) == 0 &&
+				qpol_class_get_name(qp, obj_class, &name) == 0);
+		if (strcmp(name, class_name) != 0)
+			continue;
+		num_avrules++;
+		CU_ASSERT_FATAL(qpol_avrule_get_syn_avrule_iter(qp, rule, &syn_iter) == 0);
+		for (; !qpol_iterator_end(syn_iter); qpol_iterator_next(syn_iter)) {
+			qpol_syn_avrule_t *syn_rule;
+			char joined[64] = "";
+			CU_ASSERT_FATAL(qpol_iterator_get_item(syn_iter, (void **)&syn_rule) == 0);
+			CU_ASSERT_FATAL(qpol_syn_avrule_get_perm_iter(qp, syn_rule, &perm_iter) == 0);
+			for (; !qpol_iterator_end(perm_iter); qpol_iterator_next(perm_iter)) {
+				char *perm;
+				CU_ASSERT_FATAL(qpol_iterator_get_item(perm_iter, (void **)&perm) == 0);
+				CU_ASSERT_FATAL(strlen(joined) + strlen(perm) + 2 <= sizeof(joined));
+				if (joined[0] != '\0')
+					strcat(joined, " ");
+				strcat(joined, perm);
+			}
+			qpol_iterator_destroy(&perm_iter);
+			for (i = 0; i < num_rules; i++) {
+				if (strcmp(perms[i], joined) == 0)
+					break;
+			}
+			CU_ASSERT_FATAL(i < num_rules);
+			CU_ASSERT(!found[i]);
+			found[i] = 1;
+			num_syn_rules++;
+		}
+		qpol_iterator_destroy(&syn_iter);
+	}
+	qpol_iterator_destroy(&iter);
+	CU_ASSERT_EQUAL(num_avrules, 1);
+	CU_ASSERT_EQUAL(num_syn_rules, num_rules);
+}
+
+static void name_table_syn_perms(void)
+{
+	/* the rule for both classes lists read once */
+	const char *file_rules[] = { "read execute", "read" };
+	const char *dir_rules[] = { "read", "search" };
+	name_table_check_syn_perms("file", file_rules, sizeof(file_rules) / sizeof(file_rules[0]));
+	name_table_check_syn_perms("dir", dir_rules, sizeof(dir_rules) / sizeof(dir_rules[0]));
+}
+
+static void name_table_memory(void)
+{
+	qpol_policy_t *mem_qp = NULL;
+	const qpol_name_t *name = NULL;
+	const qpol_type_t *type = NULL;
+
+	/* a policy read from memory also has a table of names */
+	CU_ASSERT_FATAL(qpol_policy_open_from_memory(&mem_qp, name_table_policy, strlen(name_table_policy), NULL, NULL,
+						     QPOL_POLICY_OPTION_NO_RULES) == 0);
+	CU_ASSERT(qpol_policy_get_type_by_name(mem_qp, "etc_t", &type) == 0);
+	CU_ASSERT(qpol_type_get_interned_name(mem_qp, type, &name) == 0);
+	CU_ASSERT_PTR_NOT_NULL(name);
+	if (name != NULL)
+		CU_ASSERT_STRING_EQUAL(name->str, "etc_t");
+	qpol_policy_destroy(&mem_qp);
+}
+
+static void name_table_rebuild(void)
+{
+	const qpol_name_t *before = NULL, *after = NULL;
+	const qpol_type_t *type = NULL;
+
+	/* rebuilding the policy replaces the table with one that
+	 * matches the rebuilt symbols */
+	CU_ASSERT_FATAL(qpol_name_lookup(qp, "user_t", &before) == 0);
+	CU_ASSERT_FATAL(qpol_policy_rebuild(qp, QPOL_POLICY_OPTION_NO_RULES) == 0);
+	CU_ASSERT(qpol_name_lookup(qp, "user_t", &after) == 0);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(after);
+	CU_ASSERT_STRING_EQUAL(after->str, "user_t");
+	CU_ASSERT(qpol_policy_get_type_by_name(qp, "user_t", &type) == 0);
+	CU_ASSERT(qpol_type_get_interned_name(qp, type, &before) == 0);
+	CU_ASSERT_PTR_EQUAL(before, after);
+	name_table_symbols();
+}
+
+CU_TestInfo name_table_tests[] = {
+	{"symbol names", name_table_symbols}
+	,
+	{"permission names", name_table_perms}
+	,
+	{"unknown names", name_table_unknown}
+	,
+	{"syntactic rule permissions", name_table_syn_perms}
+	,
+	{"policy from memory", name_table_memory}
+	,
+	{"rebuild", name_table_rebuild}
+	,
+	CU_TEST_INFO_NULL
+};
+
+int name_table_init()
+{
+	char filename[] = "/tmp/qpol-name-table-XXXXXX";
+	int fd = mkstemp(filename), policy_type;
+	FILE *fp;
+	if (fd < 0) {
+		return 1;
+	}
+	if ((fp = fdopen(fd, "w")) == NULL) {
+		close(fd);
+		unlink(filename);
+		return 1;
+	}
+	fputs(name_table_policy, fp);
+	fclose(fp);
+	policy_type = qpol_policy_open_from_file(filename, &qp, NULL, NULL, 0);
+	unlink(filename);
+	if (policy_type < 0) {
+		return 1;
+	}
+	if (qpol_policy_build_syn_rule_table(qp) < 0) {
+		return 1;
+	}
+	return 0;
+}
+
+int name_table_cleanup()
+{
+	qpol_policy_destroy(&qp);
+	return 0;
+}
@@ -36,6 +36,7 @@ extern "C"
 #endif
 
 #include <stdarg.h>
+#include <stdbool.h>
 #include <apol/vector.h>
 
 	typedef struct seaudit_log seaudit_log_t;
@@ -88,6 +89,57 @@ extern "C"
  */
 	extern void seaudit_log_clear(seaudit_log_t * log);
 
+/**
+ * Choose how the log stores the messages it parses.  By default each
+ * message and each of its strings is allocated separately.  A compact
+ * log instead allocates AVC messages in large blocks, keeps a single
+ * copy of each distinct executable, command, path, address, and
+ * similar string, and shares each distinct list of permissions among
+ * all messages with that list.  For large logs with many repeated
+ * strings this uses less memory and places messages contiguously, at
+ * the cost of looking up each string while parsing.  Each message is
+ * still a complete record, with its own struct tm and string
+ * pointers, because accessors such as seaudit_message_get_time() and
+ * seaudit_avc_message_get_perm() return pointers into it; only where
+ * those records and strings live changes.  The storage may only be
+ * changed while the log has no messages, such as after
+ * seaudit_log_clear().
+ *
+ * @param log Log to modify.
+ * @param compact If true then store messages compactly.
+ *
+ * @return 0 on success, < 0 on error (such as if the log already has
+ * messages).
+ */
+	extern int seaudit_log_set_compact(seaudit_log_t * log, bool compact);
+
+/**
+ * Determine if a log stores its messages compactly.
+ *
+ * @param log Log to query.
+ *
+ * @return True if the log is compact, false if not or upon error.
+ */
+	extern bool seaudit_log_get_compact(const seaudit_log_t * log);
+
+/**
+ * Bring up to date every model watching a log, such as before
+ * redrawing several views of the same log.  Rather than each model
+ * scanning the log upon seaudit_model_get_messages(), the filters of
+ * all models that need recalculating are evaluated together in a
+ * single pass over the log's messages, divided among several threads.
+ * Each model ends up with exactly the messages it would otherwise
+ * have; seaudit_model_is_changed() continues to report such models as
+ * changed until their messages are next retrieved.
+ *
+ * @param log Log whose models to refresh.
+ * @param num_threads Maximum number of threads to use; if 0, use one
+ * per online processor.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+	extern int seaudit_log_refresh_models(seaudit_log_t * log, unsigned int num_threads);
+
 /**
  * Return a vector of strings corresponding to all users found within
  * the log file.  The vector will be sorted alphabetically.
@@ -65,6 +65,112 @@ extern "C"
  */
 	extern int seaudit_log_parse_buffer(seaudit_log_t * log, const char *buffer, const size_t bufsize);
 
+/**
+ * Parse a string buffer as per seaudit_log_parse_buffer(), dividing
+ * the buffer at line boundaries among several threads.  Each thread
+ * parses its share into a private log; these are then merged into
+ * the given log, in order.  The resulting messages, malformed
+ * messages, and their order are identical to those from
+ * seaudit_log_parse_buffer(), including messages that span lines
+ * divided among threads.  Small buffers are parsed by the calling
+ * thread alone.
+ *
+ * @param log Audit log to which append messages.
+ * @param buffer Buffer containing SELinux audit messages.
+ * @param bufsize Number of bytes in the buffer.
+ * @param num_threads Maximum number of threads to use; if 0, use one
+ * per online processor.
+ *
+ * @return 0 on success, > 0 on warnings, < 0 on error and errno will
+ * be set.
+ */
+	extern int seaudit_log_parse_buffer_parallel(seaudit_log_t * log, const char *buffer, const size_t bufsize,
+						     unsigned int num_threads);
+
+/**
+ * Parse the remainder of an opened file and put all selinux audit
+ * messages into the log, as per seaudit_log_parse().  If the file is
+ * a regular file then it is memory-mapped and its lines are parsed
+ * in place, which is considerably faster than reading it line by
+ * line.  Otherwise (e.g., for a pipe) this behaves exactly as
+ * seaudit_log_parse().  Afterwards the file is positioned after the
+ * last byte parsed, so that a later call to this function or to
+ * seaudit_log_parse() will parse only what has since been appended.
+ *
+ * The file must not shrink while it is being parsed.  If it is
+ * truncated (e.g., by logrotate's copytruncate) while mapped then
+ * the process receives SIGBUS.  A live log that is still being
+ * written and rotated, such as /var/log/audit/audit.log, should
+ * instead be given to seaudit_log_follow(), which reads rather than
+ * maps, or to seaudit_log_parse().
+ *
+ * To parse a rotated set of logs, call this function once per file,
+ * oldest first.  Logs that must first be decompressed should instead
+ * be decompressed into memory and given to
+ * seaudit_log_parse_buffer(), which also parses lines in place.
+ *
+ * @param log Audit log to which append messages.
+ * @param syslog Handler to an opened file containing audit messages.
+ *
+ * @return 0 on success, > 0 on warnings, < 0 on error and errno will
+ * be set.
+ */
+	extern int seaudit_log_parse_file(seaudit_log_t * log, FILE * syslog);
+
+/**
+ * Parse the remainder of an opened file as per
+ * seaudit_log_parse_file(), dividing a memory-mapped file among
+ * several threads as per seaudit_log_parse_buffer_parallel().  The
+ * same restriction applies: the file must not be truncated while it
+ * is being parsed.
+ *
+ * @param log Audit log to which append messages.
+ * @param syslog Handler to an opened file containing audit messages.
+ * @param num_threads Maximum number of threads to use; if 0, use one
+ * per online processor.
+ *
+ * @return 0 on success, > 0 on warnings, < 0 on error and errno will
+ * be set.
+ */
+	extern int seaudit_log_parse_file_parallel(seaudit_log_t * log, FILE * syslog, unsigned int num_threads);
+
+/**
+ * Begin following a log file, for real-time monitoring.  The file is
+ * opened and its device and inode remembered, but nothing is parsed
+ * until seaudit_log_follow_update() is called.  If the log was
+ * already following a file then it stops doing so.
+ *
+ * @param log Audit log to which append messages.
+ * @param filename Path to a regular file containing audit messages.
+ *
+ * @return 0 on success, < 0 on error and errno will be set.
+ */
+	extern int seaudit_log_follow(seaudit_log_t * log, const char *filename);
+
+/**
+ * Parse every complete line appended to the followed file since the
+ * last time this function was called (or, the first time, the entire
+ * file), dividing the work among threads as per
+ * seaudit_log_parse_file_parallel().  The file is read a block at a
+ * time rather than memory-mapped, so it may safely be written or
+ * truncated meanwhile.  A trailing line not yet terminated by a
+ * newline is left for a later call.  If the file at the followed path
+ * has been replaced (i.e., the log was rotated) then the remainder of
+ * the old file is parsed, after which the new file is followed from
+ * its beginning; if the followed file was truncated then it is
+ * followed from its beginning.
+ *
+ * Afterwards all models watching this log are told which messages
+ * are new; a model that has not otherwise changed will then only
+ * filter and count those new messages.
+ *
+ * @param log Audit log that is following a file.
+ *
+ * @return 0 on success, > 0 on warnings, < 0 on error and errno will
+ * be set.
+ */
+	extern int seaudit_log_follow_update(seaudit_log_t * log);
+
 #ifdef  __cplusplus
 }
 #endif
@@ -38,6 +38,7 @@ extern "C"
 #endif
 
 #include "model.h"
+#include <stdio.h>
 
 	typedef struct seaudit_report seaudit_report_t;
 
@@ -79,6 +80,34 @@ extern "C"
  */
 	extern int seaudit_report_write(const seaudit_log_t * log, const seaudit_report_t * report, const char *out_file);
 
+/**
+ * Write the report with messages read from audit log files, using
+ * memory that does not grow with the size of the files.  Each file is
+ * read once, a block at a time.  Every block is parsed into the log,
+ * given to all of the report's sections in a single pass, and then
+ * cleared from the log.  Each section's listing is kept within a
+ * temporary file until the report is printed.  A message that spans
+ * lines is held until it is complete, but only for a few blocks; one
+ * that is still unterminated after that is ended early, with a
+ * warning, rather than holding the rest of the file.
+ *
+ * The report's model must watch only the given log, which should be
+ * empty beforehand and will be empty afterwards.  The model's sorts
+ * are not applied; messages are listed in the order they were read.
+ *
+ * @param log Log into which to parse the files, and error handler.
+ * @param report Report to write.
+ * @param files Array of audit log files opened for reading, read in
+ * order.
+ * @param num_files Number of elements within files.
+ * @param out_file File name for the report.  If this is NULL then
+ * write to standard output.
+ *
+ * @return 0 on successful write, < 0 on error.
+ */
+	extern int seaudit_report_write_stream(seaudit_log_t * log, const seaudit_report_t * report, FILE ** files,
+					       size_t num_files, const char *out_file);
+
 /**
  * Set the output format of the report.  The default format is plain
  * text.
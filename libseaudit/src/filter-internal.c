@@ -1209,10 +1209,315 @@ static void filter_date_print(const seaudit_filter_t * filter, const char *name,
 	fprintf(f, "</criteria>\n");
 }
 
+/******************** compiled filter programs ********************/
+
+/* string pools within a log to which compiled programs refer */
+enum filter_pool_index
+{
+	FILTER_POOL_USERS = 0, FILTER_POOL_ROLES, FILTER_POOL_TYPES, FILTER_POOL_MLS_LVL, FILTER_POOL_MLS_CLR,
+	FILTER_POOL_CLASSES, FILTER_POOL_PERMS, FILTER_POOL_HOSTS, FILTER_NUM_POOLS
+};
+
+/* criteria that are compiled into sets of interned strings */
+enum filter_set_index
+{
+	FILTER_SET_SRC_USER = 0, FILTER_SET_SRC_ROLE, FILTER_SET_SRC_TYPE, FILTER_SET_SRC_MLS_LVL, FILTER_SET_SRC_MLS_CLR,
+	FILTER_SET_TGT_USER, FILTER_SET_TGT_ROLE, FILTER_SET_TGT_TYPE, FILTER_SET_TGT_MLS_LVL, FILTER_SET_TGT_MLS_CLR,
+	FILTER_SET_TGT_CLASS, FILTER_SET_PERM, FILTER_SET_HOST, FILTER_NUM_SETS
+};
+
+/* glob criteria upon strings that are not interned */
+enum filter_glob_index
+{
+	FILTER_GLOB_EXE = 0, FILTER_GLOB_PATH, FILTER_GLOB_COMM, FILTER_GLOB_ANYADDR, FILTER_GLOB_LADDR, FILTER_GLOB_FADDR,
+	FILTER_GLOB_SADDR, FILTER_GLOB_DADDR, FILTER_NUM_GLOBS
+};
+
+/* how a glob expression is matched */
+typedef enum filter_glob_kind
+{
+	/** matches every string */
+	FILTER_GLOB_KIND_ANY = 0,
+	/** no wildcards, so the string must equal the text */
+	FILTER_GLOB_KIND_LITERAL,
+	/** text followed by '*' */
+	FILTER_GLOB_KIND_PREFIX,
+	/** '*' followed by text */
+	FILTER_GLOB_KIND_SUFFIX,
+	/** text surrounded by '*' */
+	FILTER_GLOB_KIND_SUBSTRING,
+	/** anything else, which requires fnmatch() */
+	FILTER_GLOB_KIND_FNMATCH
+} filter_glob_kind_e;
+
+typedef struct filter_glob
+{
+	filter_glob_kind_e kind;
+	/** the original expression; this is owned by the filter */
+	const char *pattern;
+	/** the text that the kind of match looks for, pointing into
+	 *  pattern (not necessarily nul-terminated) */
+	const char *text;
+	size_t len;
+} filter_glob_t;
+
+struct filter_program
+{
+	/** log whose interned strings this program refers to */
+	const seaudit_log_t *log;
+	/** sizes of the log's string pools when this was compiled; if
+	 *  any have grown since then the program must be recompiled */
+	size_t pool_sizes[FILTER_NUM_POOLS];
+	/** for set criteria, vectors of the log's interned strings that
+	 *  are accepted, sorted by address */
+	apol_vector_t *sets[FILTER_NUM_SETS];
+	filter_glob_t globs[FILTER_NUM_GLOBS];
+	/** indices into filter_criteria[] of the criteria that are set */
+	size_t *steps;
+	size_t num_steps;
+};
+
+static void filter_get_pool_sizes(const seaudit_log_t * log, size_t * sizes)
+{
+	sizes[FILTER_POOL_USERS] = apol_bst_get_size(log->users);
+	sizes[FILTER_POOL_ROLES] = apol_bst_get_size(log->roles);
+	sizes[FILTER_POOL_TYPES] = apol_bst_get_size(log->types);
+	sizes[FILTER_POOL_MLS_LVL] = apol_bst_get_size(log->mls_lvl);
+	sizes[FILTER_POOL_MLS_CLR] = apol_bst_get_size(log->mls_clr);
+	sizes[FILTER_POOL_CLASSES] = apol_bst_get_size(log->classes);
+	sizes[FILTER_POOL_PERMS] = apol_bst_get_size(log->perms);
+	sizes[FILTER_POOL_HOSTS] = apol_bst_get_size(log->hosts);
+}
+
+/**
+ * Build the set of a pool's interned strings that equal any of the
+ * given strings.  Strings that were never interned cannot appear
+ * within any message, so they are dropped.
+ */
+static int filter_set_compile(apol_vector_t ** set, const apol_vector_t * strings, const apol_bst_t * pool)
+{
+	size_t i;
+	void *result;
+	if ((*set = apol_vector_create_with_capacity(apol_vector_get_size(strings), NULL)) == NULL) {
+		return -1;
+	}
+	for (i = 0; i < apol_vector_get_size(strings); i++) {
+		if (apol_bst_get_element(pool, apol_vector_get_element(strings, i), NULL, &result) == 0 &&
+		    apol_vector_append(*set, result) < 0) {
+			return -1;
+		}
+	}
+	apol_vector_sort_uniquify(*set, NULL, NULL);
+	return 0;
+}
+
+/**
+ * Build the set of a pool's interned strings that match a glob
+ * expression.  The expression is thus evaluated once per distinct
+ * string rather than once per message.
+ */
+static int filter_set_compile_glob(apol_vector_t ** set, const char *pattern, apol_bst_t * pool)
+{
+	apol_vector_t *v;
+	size_t i;
+	int retval = -1;
+	if ((v = apol_bst_get_vector(pool, 0)) == NULL || (*set = apol_vector_create(NULL)) == NULL) {
+		goto cleanup;
+	}
+	for (i = 0; i < apol_vector_get_size(v); i++) {
+		char *s = apol_vector_get_element(v, i);
+		if (fnmatch(pattern, s, 0) == 0 && apol_vector_append(*set, s) < 0) {
+			goto cleanup;
+		}
+	}
+	apol_vector_sort(*set, NULL, NULL);
+	retval = 0;
+      cleanup:
+	apol_vector_destroy(&v);
+	return retval;
+}
+
+static int filter_set_contains(const apol_vector_t * set, const char *s)
+{
+	size_t i;
+	return apol_vector_get_index_sorted(set, s, NULL, NULL, &i) == 0;
+}
+
+/**
+ * Classify a glob expression.  Because fnmatch() is called without
+ * flags, '*' matches any characters including '/' and a leading '.',
+ * so an expression whose only wildcards are leading or trailing '*'
+ * may be matched by comparing strings instead.
+ */
+static void filter_glob_compile(filter_glob_t * g, const char *pattern)
+{
+	size_t len = strlen(pattern), lead = 0, trail = 0;
+	g->pattern = pattern;
+	while (lead < len && pattern[lead] == '*') {
+		lead++;
+	}
+	while (trail < len - lead && pattern[len - trail - 1] == '*') {
+		trail++;
+	}
+	g->text = pattern + lead;
+	g->len = len - lead - trail;
+	if (memchr(g->text, '*', g->len) != NULL || memchr(g->text, '?', g->len) != NULL ||
+	    memchr(g->text, '[', g->len) != NULL || memchr(g->text, '\\', g->len) != NULL) {
+		g->kind = FILTER_GLOB_KIND_FNMATCH;
+	} else if (g->len == 0 && len > 0) {
+		g->kind = FILTER_GLOB_KIND_ANY;
+	} else if (lead == 0 && trail == 0) {
+		g->kind = FILTER_GLOB_KIND_LITERAL;
+	} else if (lead == 0) {
+		g->kind = FILTER_GLOB_KIND_PREFIX;
+	} else if (trail == 0) {
+		g->kind = FILTER_GLOB_KIND_SUFFIX;
+	} else {
+		g->kind = FILTER_GLOB_KIND_SUBSTRING;
+	}
+}
+
+static int filter_glob_match(const filter_glob_t * g, const char *s)
+{
+	size_t len;
+	switch (g->kind) {
+	case FILTER_GLOB_KIND_ANY:
+		return 1;
+	case FILTER_GLOB_KIND_LITERAL:
+		return strcmp(g->text, s) == 0;
+	case FILTER_GLOB_KIND_PREFIX:
+		return strncmp(g->text, s, g->len) == 0;
+	case FILTER_GLOB_KIND_SUFFIX:
+		len = strlen(s);
+		return len >= g->len && memcmp(s + len - g->len, g->text, g->len) == 0;
+	case FILTER_GLOB_KIND_SUBSTRING:
+		return memmem(s, strlen(s), g->text, g->len) != NULL;
+	default:
+		return fnmatch(g->pattern, s, 0) == 0;
+	}
+}
+
+static int filter_src_user_run(const struct filter_program *prog, const seaudit_message_t * msg)
+{
+	return filter_set_contains(prog->sets[FILTER_SET_SRC_USER], msg->data.avc->suser);
+}
+
+static int filter_src_role_run(const struct filter_program *prog, const seaudit_message_t * msg)
+{
+	return filter_set_contains(prog->sets[FILTER_SET_SRC_ROLE], msg->data.avc->srole);
+}
+
+static int filter_src_type_run(const struct filter_program *prog, const seaudit_message_t * msg)
+{
+	return filter_set_contains(prog->sets[FILTER_SET_SRC_TYPE], msg->data.avc->stype);
+}
+
+static int filter_src_mls_lvl_run(const struct filter_program *prog, const seaudit_message_t * msg)
+{
+	return filter_set_contains(prog->sets[FILTER_SET_SRC_MLS_LVL], msg->data.avc->smls_lvl);
+}
+
+static int filter_src_mls_clr_run(const struct filter_program *prog, const seaudit_message_t * msg)
+{
+	return filter_set_contains(prog->sets[FILTER_SET_SRC_MLS_CLR], msg->data.avc->smls_clr);
+}
+
+static int filter_tgt_user_run(const struct filter_program *prog, const seaudit_message_t * msg)
+{
+	return filter_set_contains(prog->sets[FILTER_SET_TGT_USER], msg->data.avc->tuser);
+}
+
+static int filter_tgt_role_run(const struct filter_program *prog, const seaudit_message_t * msg)
+{
+	return filter_set_contains(prog->sets[FILTER_SET_TGT_ROLE], msg->data.avc->trole);
+}
+
+static int filter_tgt_type_run(const struct filter_program *prog, const seaudit_message_t * msg)
+{
+	return filter_set_contains(prog->sets[FILTER_SET_TGT_TYPE], msg->data.avc->ttype);
+}
+
+static int filter_tgt_mls_lvl_run(const struct filter_program *prog, const seaudit_message_t * msg)
+{
+	return filter_set_contains(prog->sets[FILTER_SET_TGT_MLS_LVL], msg->data.avc->tmls_lvl);
+}
+
+static int filter_tgt_mls_clr_run(const struct filter_program *prog, const seaudit_message_t * msg)
+{
+	return filter_set_contains(prog->sets[FILTER_SET_TGT_MLS_CLR], msg->data.avc->tmls_clr);
+}
+
+static int filter_tgt_class_run(const struct filter_program *prog, const seaudit_message_t * msg)
+{
+	return filter_set_contains(prog->sets[FILTER_SET_TGT_CLASS], msg->data.avc->tclass);
+}
+
+static int filter_perm_run(const struct filter_program *prog, const seaudit_message_t * msg)
+{
+	size_t i;
+	for (i = 0; i < apol_vector_get_size(msg->data.avc->perms); i++) {
+		if (filter_set_contains(prog->sets[FILTER_SET_PERM], apol_vector_get_element(msg->data.avc->perms, i))) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static int filter_exe_run(const struct filter_program *prog, const seaudit_message_t * msg)
+{
+	return filter_glob_match(&prog->globs[FILTER_GLOB_EXE], msg->data.avc->exe);
+}
+
+static int filter_host_run(const struct filter_program *prog, const seaudit_message_t * msg)
+{
+	return filter_set_contains(prog->sets[FILTER_SET_HOST], msg->host);
+}
+
+static int filter_path_run(const struct filter_program *prog, const seaudit_message_t * msg)
+{
+	return filter_glob_match(&prog->globs[FILTER_GLOB_PATH], msg->data.avc->path);
+}
+
+static int filter_comm_run(const struct filter_program *prog, const seaudit_message_t * msg)
+{
+	return filter_glob_match(&prog->globs[FILTER_GLOB_COMM], msg->data.avc->comm);
+}
+
+static int filter_anyaddr_run(const struct filter_program *prog, const seaudit_message_t * msg)
+{
+	const filter_glob_t *g = &prog->globs[FILTER_GLOB_ANYADDR];
+	const seaudit_avc_message_t *avc = msg->data.avc;
+	return (avc->saddr != NULL && filter_glob_match(g, avc->saddr)) ||
+		(avc->daddr != NULL && filter_glob_match(g, avc->daddr)) ||
+		(avc->faddr != NULL && filter_glob_match(g, avc->faddr)) ||
+		(avc->laddr != NULL && filter_glob_match(g, avc->laddr)) || (avc->ipaddr != NULL && filter_glob_match(g, avc->ipaddr));
+}
+
+static int filter_laddr_run(const struct filter_program *prog, const seaudit_message_t * msg)
+{
+	return filter_glob_match(&prog->globs[FILTER_GLOB_LADDR], msg->data.avc->laddr);
+}
+
+static int filter_faddr_run(const struct filter_program *prog, const seaudit_message_t * msg)
+{
+	return filter_glob_match(&prog->globs[FILTER_GLOB_FADDR], msg->data.avc->faddr);
+}
+
+static int filter_saddr_run(const struct filter_program *prog, const seaudit_message_t * msg)
+{
+	return filter_glob_match(&prog->globs[FILTER_GLOB_SADDR], msg->data.avc->saddr);
+}
+
+static int filter_daddr_run(const struct filter_program *prog, const seaudit_message_t * msg)
+{
+	return filter_glob_match(&prog->globs[FILTER_GLOB_DADDR], msg->data.avc->daddr);
+}
+
 typedef bool(filter_is_set_func) (const seaudit_filter_t * filter);
 typedef int (filter_support_func) (const seaudit_message_t * msg);
 typedef int (filter_accept_func) (const seaudit_filter_t * filter, const seaudit_message_t * msg);
 typedef void (filter_print_func) (const seaudit_filter_t * filter, const char *name, FILE * f, int tabs);
+typedef int (filter_run_func) (const struct filter_program * prog, const seaudit_message_t * msg);
 
 struct filter_criteria_t
 {
@@ -1222,6 +1527,9 @@ struct filter_criteria_t
 	filter_accept_func *accept;
 	filter_read_func *read;
 	filter_print_func *print;
+	/** accept function for a compiled program, or NULL to use
+	 *  accept() */
+	filter_run_func *run;
 };
 
 /**
@@ -1230,88 +1538,199 @@ struct filter_criteria_t
  * of this table is retrieved; if the support functions returns
  * non-zero then the accept function is called.  To add new filter
  * criteria, implement their support and accept functions and then
- * append new entries to this table.
+ * append new entries to this table.  Criteria that can be compiled
+ * against a log's interned strings (see filter_compile()) also have
+ * a run function that takes the place of their accept function.
  */
 static const struct filter_criteria_t filter_criteria[] = {
 	{"src_user", filter_src_user_is_set, filter_src_user_support, filter_src_user_accept, filter_src_user_read,
-	 filter_src_user_print},
+	 filter_src_user_print, filter_src_user_run},
 	{"src_role", filter_src_role_is_set, filter_src_role_support, filter_src_role_accept, filter_src_role_read,
-	 filter_src_role_print},
+	 filter_src_role_print, filter_src_role_run},
 	{"src_type", filter_src_type_is_set, filter_src_type_support, filter_src_type_accept, filter_src_type_read,
-	 filter_src_type_print},
+	 filter_src_type_print, filter_src_type_run},
 	{"src_mls_lvl", filter_src_mls_lvl_is_set, filter_src_mls_lvl_support, filter_src_mls_lvl_accept, filter_src_mls_lvl_read,
-	 filter_src_mls_lvl_print},
+	 filter_src_mls_lvl_print, filter_src_mls_lvl_run},
 	{"src_mls_clr", filter_src_mls_clr_is_set, filter_src_mls_clr_support, filter_src_mls_clr_accept, filter_src_mls_clr_read,
-	 filter_src_mls_clr_print},
+	 filter_src_mls_clr_print, filter_src_mls_clr_run},
 	{"tgt_user", filter_tgt_user_is_set, filter_tgt_user_support, filter_tgt_user_accept, filter_tgt_user_read,
-	 filter_tgt_user_print},
+	 filter_tgt_user_print, filter_tgt_user_run},
 	{"tgt_role", filter_tgt_role_is_set, filter_tgt_role_support, filter_tgt_role_accept, filter_tgt_role_read,
-	 filter_tgt_role_print},
+	 filter_tgt_role_print, filter_tgt_role_run},
 	{"tgt_type", filter_tgt_type_is_set, filter_tgt_type_support, filter_tgt_type_accept, filter_tgt_type_read,
-	 filter_tgt_type_print},
+	 filter_tgt_type_print, filter_tgt_type_run},
 	{"tgt_mls_lvl", filter_tgt_mls_lvl_is_set, filter_tgt_mls_lvl_support, filter_tgt_mls_lvl_accept, filter_tgt_mls_lvl_read,
-	 filter_src_mls_lvl_print},
+	 filter_src_mls_lvl_print, filter_tgt_mls_lvl_run},
 	{"tgt_mls_clr", filter_tgt_mls_clr_is_set, filter_tgt_mls_clr_support, filter_tgt_mls_clr_accept, filter_tgt_mls_clr_read,
-	 filter_src_mls_clr_print},
+	 filter_src_mls_clr_print, filter_tgt_mls_clr_run},
 	{"obj_class", filter_tgt_class_is_set, filter_tgt_class_support, filter_tgt_class_accept, filter_tgt_class_read,
-	 filter_tgt_class_print},
-	{"perm", filter_perm_is_set, filter_perm_support, filter_perm_accept, filter_perm_read, filter_perm_print},
-	{"exe", filter_exe_is_set, filter_exe_support, filter_exe_accept, filter_exe_read, filter_exe_print},
-	{"host", filter_host_is_set, filter_host_support, filter_host_accept, filter_host_read, filter_host_print},
-	{"path", filter_path_is_set, filter_path_support, filter_path_accept, filter_path_read, filter_path_print},
-	{"inode", filter_inode_is_set, filter_inode_support, filter_inode_accept, filter_inode_read, filter_inode_print},
-	{"pid", filter_pid_is_set, filter_pid_support, filter_pid_accept, filter_pid_read, filter_pid_print},
-	{"comm", filter_comm_is_set, filter_comm_support, filter_comm_accept, filter_comm_read, filter_comm_print},
-	{"ipaddr", filter_anyaddr_is_set, filter_anyaddr_support, filter_anyaddr_accept, filter_anyaddr_read, filter_anyaddr_print},
+	 filter_tgt_class_print, filter_tgt_class_run},
+	{"perm", filter_perm_is_set, filter_perm_support, filter_perm_accept, filter_perm_read, filter_perm_print, filter_perm_run},
+	{"exe", filter_exe_is_set, filter_exe_support, filter_exe_accept, filter_exe_read, filter_exe_print, filter_exe_run},
+	{"host", filter_host_is_set, filter_host_support, filter_host_accept, filter_host_read, filter_host_print, filter_host_run},
+	{"path", filter_path_is_set, filter_path_support, filter_path_accept, filter_path_read, filter_path_print, filter_path_run},
+	{"inode", filter_inode_is_set, filter_inode_support, filter_inode_accept, filter_inode_read, filter_inode_print, NULL},
+	{"pid", filter_pid_is_set, filter_pid_support, filter_pid_accept, filter_pid_read, filter_pid_print, NULL},
+	{"comm", filter_comm_is_set, filter_comm_support, filter_comm_accept, filter_comm_read, filter_comm_print, filter_comm_run},
+	{"ipaddr", filter_anyaddr_is_set, filter_anyaddr_support, filter_anyaddr_accept, filter_anyaddr_read, filter_anyaddr_print, filter_anyaddr_run},
 	{"anyport", filter_anyport_is_set, filter_anyport_support, filter_anyport_accept, filter_anyport_read,
-	 filter_anyport_print},
-	{"laddr", filter_laddr_is_set, filter_laddr_support, filter_laddr_accept, filter_laddr_read, filter_laddr_print},
-	{"lport", filter_lport_is_set, filter_lport_support, filter_lport_accept, filter_lport_read, filter_lport_print},
-	{"faddr", filter_faddr_is_set, filter_faddr_support, filter_faddr_accept, filter_faddr_read, filter_faddr_print},
-	{"fport", filter_fport_is_set, filter_fport_support, filter_fport_accept, filter_fport_read, filter_fport_print},
-	{"saddr", filter_saddr_is_set, filter_saddr_support, filter_saddr_accept, filter_saddr_read, filter_saddr_print},
-	{"sport", filter_sport_is_set, filter_sport_support, filter_sport_accept, filter_sport_read, filter_sport_print},
-	{"daddr", filter_daddr_is_set, filter_daddr_support, filter_daddr_accept, filter_daddr_read, filter_daddr_print},
-	{"dport", filter_dport_is_set, filter_dport_support, filter_dport_accept, filter_dport_read, filter_dport_print},
-	{"port", filter_port_is_set, filter_port_support, filter_port_accept, filter_port_read, filter_port_print},
-	{"netif", filter_netif_is_set, filter_netif_support, filter_netif_accept, filter_netif_read, filter_netif_print},
-	{"key", filter_key_is_set, filter_key_support, filter_key_accept, filter_key_read, filter_key_print},
-	{"cap", filter_cap_is_set, filter_cap_support, filter_cap_accept, filter_cap_read, filter_cap_print},
+	 filter_anyport_print, NULL},
+	{"laddr", filter_laddr_is_set, filter_laddr_support, filter_laddr_accept, filter_laddr_read, filter_laddr_print, filter_laddr_run},
+	{"lport", filter_lport_is_set, filter_lport_support, filter_lport_accept, filter_lport_read, filter_lport_print, NULL},
+	{"faddr", filter_faddr_is_set, filter_faddr_support, filter_faddr_accept, filter_faddr_read, filter_faddr_print, filter_faddr_run},
+	{"fport", filter_fport_is_set, filter_fport_support, filter_fport_accept, filter_fport_read, filter_fport_print, NULL},
+	{"saddr", filter_saddr_is_set, filter_saddr_support, filter_saddr_accept, filter_saddr_read, filter_saddr_print, filter_saddr_run},
+	{"sport", filter_sport_is_set, filter_sport_support, filter_sport_accept, filter_sport_read, filter_sport_print, NULL},
+	{"daddr", filter_daddr_is_set, filter_daddr_support, filter_daddr_accept, filter_daddr_read, filter_daddr_print, filter_daddr_run},
+	{"dport", filter_dport_is_set, filter_dport_support, filter_dport_accept, filter_dport_read, filter_dport_print, NULL},
+	{"port", filter_port_is_set, filter_port_support, filter_port_accept, filter_port_read, filter_port_print, NULL},
+	{"netif", filter_netif_is_set, filter_netif_support, filter_netif_accept, filter_netif_read, filter_netif_print, NULL},
+	{"key", filter_key_is_set, filter_key_support, filter_key_accept, filter_key_read, filter_key_print, NULL},
+	{"cap", filter_cap_is_set, filter_cap_support, filter_cap_accept, filter_cap_read, filter_cap_print, NULL},
 	{"msg", filter_avc_msg_type_is_set, filter_avc_msg_type_support, filter_avc_msg_type_accept, filter_avc_msg_type_read,
-	 filter_avc_msg_type_print},
-	{"date_time", filter_date_is_set, filter_date_support, filter_date_accept, filter_date_read, filter_date_print}
+	 filter_avc_msg_type_print, NULL},
+	{"date_time", filter_date_is_set, filter_date_support, filter_date_accept, filter_date_read, filter_date_print, NULL}
 };
 
 /******************** protected functions below ********************/
 
-int filter_is_accepted(const seaudit_filter_t * filter, const seaudit_message_t * msg)
+void filter_discard_program(seaudit_filter_t * filter)
 {
-	bool tried_criterion = false;
-	int acceptval;
+	struct filter_program *prog = filter->program;
 	size_t i;
+	if (prog == NULL) {
+		return;
+	}
+	for (i = 0; i < FILTER_NUM_SETS; i++) {
+		apol_vector_destroy(&prog->sets[i]);
+	}
+	free(prog->steps);
+	free(prog);
+	filter->program = NULL;
+}
 
+int filter_compile(seaudit_filter_t * filter, const seaudit_log_t * log)
+{
+	struct filter_program *prog = filter->program;
+	size_t sizes[FILTER_NUM_POOLS], i;
+	int error;
+
+	filter_get_pool_sizes(log, sizes);
+	if (prog != NULL && prog->log == log && memcmp(prog->pool_sizes, sizes, sizeof(sizes)) == 0) {
+		return 0;
+	}
+	filter_discard_program(filter);
+	if ((prog = calloc(1, sizeof(*prog))) == NULL ||
+	    (prog->steps = malloc(sizeof(filter_criteria) / sizeof(filter_criteria[0]) * sizeof(size_t))) == NULL) {
+		error = errno;
+		goto err;
+	}
+	prog->log = log;
+	memcpy(prog->pool_sizes, sizes, sizeof(sizes));
 	for (i = 0; i < sizeof(filter_criteria) / sizeof(filter_criteria[0]); i++) {
 		if (filter_criteria[i].is_set(filter)) {
-			tried_criterion = true;
-			if (filter_criteria[i].support(msg)) {
-				acceptval = filter_criteria[i].accept(filter, msg);
-			} else if (filter->strict) {
-				/* if filter is strict, then an
-				   unsupported criterion is assumed to
-				   not match */
-				acceptval = 0;
+			prog->steps[prog->num_steps++] = i;
+		}
+	}
+	if ((filter->src_users != NULL && filter_set_compile(&prog->sets[FILTER_SET_SRC_USER], filter->src_users, log->users) < 0) ||
+	    (filter->src_roles != NULL && filter_set_compile(&prog->sets[FILTER_SET_SRC_ROLE], filter->src_roles, log->roles) < 0) ||
+	    (filter->src_types != NULL && filter_set_compile(&prog->sets[FILTER_SET_SRC_TYPE], filter->src_types, log->types) < 0) ||
+	    (filter->src_mls_lvl != NULL &&
+	     filter_set_compile(&prog->sets[FILTER_SET_SRC_MLS_LVL], filter->src_mls_lvl, log->mls_lvl) < 0) ||
+	    (filter->src_mls_clr != NULL &&
+	     filter_set_compile(&prog->sets[FILTER_SET_SRC_MLS_CLR], filter->src_mls_clr, log->mls_clr) < 0) ||
+	    (filter->tgt_users != NULL && filter_set_compile(&prog->sets[FILTER_SET_TGT_USER], filter->tgt_users, log->users) < 0) ||
+	    (filter->tgt_roles != NULL && filter_set_compile(&prog->sets[FILTER_SET_TGT_ROLE], filter->tgt_roles, log->roles) < 0) ||
+	    (filter->tgt_types != NULL && filter_set_compile(&prog->sets[FILTER_SET_TGT_TYPE], filter->tgt_types, log->types) < 0) ||
+	    (filter->tgt_mls_lvl != NULL &&
+	     filter_set_compile(&prog->sets[FILTER_SET_TGT_MLS_LVL], filter->tgt_mls_lvl, log->mls_lvl) < 0) ||
+	    (filter->tgt_mls_clr != NULL &&
+	     filter_set_compile(&prog->sets[FILTER_SET_TGT_MLS_CLR], filter->tgt_mls_clr, log->mls_clr) < 0) ||
+	    (filter->tgt_classes != NULL &&
+	     filter_set_compile(&prog->sets[FILTER_SET_TGT_CLASS], filter->tgt_classes, log->classes) < 0) ||
+	    (filter->perm != NULL && filter_set_compile_glob(&prog->sets[FILTER_SET_PERM], filter->perm, log->perms) < 0) ||
+	    (filter->host != NULL && filter_set_compile_glob(&prog->sets[FILTER_SET_HOST], filter->host, log->hosts) < 0)) {
+		error = errno;
+		goto err;
+	}
+	if (filter->exe != NULL) {
+		filter_glob_compile(&prog->globs[FILTER_GLOB_EXE], filter->exe);
+	}
+	if (filter->path != NULL) {
+		filter_glob_compile(&prog->globs[FILTER_GLOB_PATH], filter->path);
+	}
+	if (filter->comm != NULL) {
+		filter_glob_compile(&prog->globs[FILTER_GLOB_COMM], filter->comm);
+	}
+	if (filter->anyaddr != NULL) {
+		filter_glob_compile(&prog->globs[FILTER_GLOB_ANYADDR], filter->anyaddr);
+	}
+	if (filter->laddr != NULL) {
+		filter_glob_compile(&prog->globs[FILTER_GLOB_LADDR], filter->laddr);
+	}
+	if (filter->faddr != NULL) {
+		filter_glob_compile(&prog->globs[FILTER_GLOB_FADDR], filter->faddr);
+	}
+	if (filter->saddr != NULL) {
+		filter_glob_compile(&prog->globs[FILTER_GLOB_SADDR], filter->saddr);
+	}
+	if (filter->daddr != NULL) {
+		filter_glob_compile(&prog->globs[FILTER_GLOB_DADDR], filter->daddr);
+	}
+	filter->program = prog;
+	return 0;
+      err:
+	if (prog != NULL) {
+		filter->program = prog;
+		filter_discard_program(filter);
+	}
+	ERR(log, "%s", strerror(error));
+	errno = error;
+	return -1;
+}
+
+int filter_is_accepted(const seaudit_filter_t * filter, const seaudit_log_t * log, const seaudit_message_t * msg)
+{
+	const struct filter_program *prog = filter->program;
+	bool tried_criterion = false;
+	int acceptval;
+	size_t i, j, num_criteria;
+
+	if (prog != NULL && prog->log != log) {
+		prog = NULL;
+	}
+	num_criteria = (prog != NULL ? prog->num_steps : sizeof(filter_criteria) / sizeof(filter_criteria[0]));
+	for (j = 0; j < num_criteria; j++) {
+		if (prog != NULL) {
+			i = prog->steps[j];
+		} else if (filter_criteria[j].is_set(filter)) {
+			i = j;
+		} else {
+			continue;
+		}
+		tried_criterion = true;
+		if (filter_criteria[i].support(msg)) {
+			if (prog != NULL && filter_criteria[i].run != NULL) {
+				acceptval = filter_criteria[i].run(prog, msg);
 			} else {
-				/* for unstrict filters, unsupported
-				   criterion is assumed to be a don't
-				   care state */
-				continue;
-			}
-			if (filter->match == SEAUDIT_FILTER_MATCH_ANY && acceptval == 1) {
-				return 1;
-			}
-			if (filter->match == SEAUDIT_FILTER_MATCH_ALL && acceptval == 0) {
-				return 0;
+				acceptval = filter_criteria[i].accept(filter, msg);
 			}
+		} else if (filter->strict) {
+			/* if filter is strict, then an
+			   unsupported criterion is assumed to
+			   not match */
+			acceptval = 0;
+		} else {
+			/* for unstrict filters, unsupported
+			   criterion is assumed to be a don't
+			   care state */
+			continue;
+		}
+		if (filter->match == SEAUDIT_FILTER_MATCH_ANY && acceptval == 1) {
+			return 1;
+		}
+		if (filter->match == SEAUDIT_FILTER_MATCH_ALL && acceptval == 0) {
+			return 0;
 		}
 	}
 	if (!tried_criterion) {
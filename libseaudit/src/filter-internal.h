@@ -104,6 +104,8 @@ struct seaudit_filter
 	seaudit_avc_message_type_e avc_msg_type;
 	struct tm *start, *end;
 	seaudit_filter_date_match_e date_match;
+	/** criteria compiled against a particular log, or NULL */
+	struct filter_program *program;
 };
 
 #endif
@@ -45,6 +45,19 @@
 #include <string.h>
 #include <time.h>
 
+/**
+ * Called whenever one of the filter's criteria changes.  Any program
+ * compiled from the old criteria is now wrong, and the model watching
+ * this filter must refilter its messages.
+ */
+static void filter_changed(seaudit_filter_t * filter)
+{
+	filter_discard_program(filter);
+	if (filter->model != NULL) {
+		model_notify_filter_changed(filter->model, filter);
+	}
+}
+
 seaudit_filter_t *seaudit_filter_create(const char *name)
 {
 	seaudit_filter_t *s = calloc(1, sizeof(*s));
@@ -214,6 +227,7 @@ void seaudit_filter_destroy(seaudit_filter_t ** filter)
 		free((*filter)->netif);
 		free((*filter)->start);
 		free((*filter)->end);
+		filter_discard_program(*filter);
 		free(*filter);
 		*filter = NULL;
 	}
@@ -226,9 +240,7 @@ int seaudit_filter_set_match(seaudit_filter_t * filter, seaudit_filter_match_e m
 		return -1;
 	}
 	filter->match = match;
-	if (filter->model != NULL) {
-		model_notify_filter_changed(filter->model, filter);
-	}
+	filter_changed(filter);
 	return 0;
 }
 
@@ -301,9 +313,7 @@ int seaudit_filter_set_strict(seaudit_filter_t * filter, bool is_strict)
 	}
 	if (filter->strict != is_strict) {
 		filter->strict = is_strict;
-		if (filter->model != NULL) {
-			model_notify_filter_changed(filter->model, filter);
-		}
+		filter_changed(filter);
 	}
 	return 0;
 }
@@ -332,9 +342,7 @@ static int filter_set_vector(seaudit_filter_t * filter, apol_vector_t ** tgt, co
 	}
 	apol_vector_destroy(tgt);
 	*tgt = new_v;
-	if (filter->model != NULL) {
-		model_notify_filter_changed(filter->model, filter);
-	}
+	filter_changed(filter);
 	return 0;
 }
 
@@ -352,9 +360,7 @@ static int filter_set_string(seaudit_filter_t * filter, char **dest, const char
 		}
 		free(*dest);
 		*dest = new_s;
-		if (filter->model != NULL) {
-			model_notify_filter_changed(filter->model, filter);
-		}
+		filter_changed(filter);
 	}
 	return 0;
 }
@@ -363,9 +369,7 @@ static int filter_set_ulong(seaudit_filter_t * filter, unsigned long *dest, cons
 {
 	if (src != *dest) {
 		*dest = src;
-		if (filter->model != NULL) {
-			model_notify_filter_changed(filter->model, filter);
-		}
+		filter_changed(filter);
 	}
 	return 0;
 }
@@ -374,9 +378,7 @@ static int filter_set_uint(seaudit_filter_t * filter, unsigned int *dest, const
 {
 	if (src != *dest) {
 		*dest = src;
-		if (filter->model != NULL) {
-			model_notify_filter_changed(filter->model, filter);
-		}
+		filter_changed(filter);
 	}
 	return 0;
 }
@@ -389,9 +391,7 @@ static int filter_set_int(seaudit_filter_t * filter, int *dest, const int src)
 	}
 	if (s != *dest) {
 		*dest = s;
-		if (filter->model != NULL) {
-			model_notify_filter_changed(filter->model, filter);
-		}
+		filter_changed(filter);
 	}
 	return 0;
 }
@@ -1014,9 +1014,7 @@ int seaudit_filter_set_message_type(seaudit_filter_t * filter, const seaudit_avc
 		return -1;
 	}
 	filter->avc_msg_type = message_type;
-	if (filter->model != NULL) {
-		model_notify_filter_changed(filter->model, filter);
-	}
+	filter_changed(filter);
 	return 0;
 }
 
@@ -1069,9 +1067,7 @@ int seaudit_filter_set_date(seaudit_filter_t * filter, const struct tm *start, c
 		filter->end = NULL;
 	}
 	filter->date_match = date_match;
-	if (filter->model != NULL) {
-		model_notify_filter_changed(filter->model, filter);
-	}
+	filter_changed(filter);
 	return 0;
 }
 
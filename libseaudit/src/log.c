@@ -33,6 +33,29 @@
 #include <stdlib.h>
 #include <string.h>
 
+/**
+ * Order permission lists by their pointers, which for lists from the
+ * same log is the same as comparing their strings for equality.
+ */
+static int log_perm_list_comp(const void *a, const void *b, void *data __attribute__ ((unused)))
+{
+	const apol_vector_t *v1 = a, *v2 = b;
+	size_t i, n1 = apol_vector_get_size(v1), n2 = apol_vector_get_size(v2);
+	for (i = 0; i < n1 && i < n2; i++) {
+		const void *p1 = apol_vector_get_element(v1, i), *p2 = apol_vector_get_element(v2, i);
+		if (p1 != p2) {
+			return (p1 < p2 ? -1 : 1);
+		}
+	}
+	return (n1 < n2 ? -1 : (n1 > n2 ? 1 : 0));
+}
+
+static void log_perm_list_free(void *elem)
+{
+	apol_vector_t *v = elem;
+	apol_vector_destroy(&v);
+}
+
 seaudit_log_t *seaudit_log_create(seaudit_handle_fn_t fn, void *callback_arg)
 {
 	seaudit_log_t *log = NULL;
@@ -45,16 +68,19 @@ seaudit_log_t *seaudit_log_create(seaudit_handle_fn_t fn, void *callback_arg)
 	if ((log->messages = apol_vector_create(message_free)) == NULL ||
 	    (log->malformed_msgs = apol_vector_create(free)) == NULL ||
 	    (log->models = apol_vector_create(NULL)) == NULL ||
-	    (log->types = apol_bst_create(apol_str_strcmp, free)) == NULL ||
-	    (log->classes = apol_bst_create(apol_str_strcmp, free)) == NULL ||
-	    (log->roles = apol_bst_create(apol_str_strcmp, free)) == NULL ||
-	    (log->users = apol_bst_create(apol_str_strcmp, free)) == NULL ||
-	    (log->perms = apol_bst_create(apol_str_strcmp, free)) == NULL ||
-	    (log->mls_lvl = apol_bst_create(apol_str_strcmp, free)) == NULL ||
-	    (log->mls_clr = apol_bst_create(apol_str_strcmp, free)) == NULL ||
-	    (log->hosts = apol_bst_create(apol_str_strcmp, free)) == NULL
-	    || (log->bools = apol_bst_create(apol_str_strcmp, free)) == NULL
-	    || (log->managers = apol_bst_create(apol_str_strcmp, free)) == NULL) {
+	    (log->types = apol_bst_create_hashed(apol_str_strcmp, apol_str_hash, free)) == NULL ||
+	    (log->classes = apol_bst_create_hashed(apol_str_strcmp, apol_str_hash, free)) == NULL ||
+	    (log->roles = apol_bst_create_hashed(apol_str_strcmp, apol_str_hash, free)) == NULL ||
+	    (log->users = apol_bst_create_hashed(apol_str_strcmp, apol_str_hash, free)) == NULL ||
+	    (log->perms = apol_bst_create_hashed(apol_str_strcmp, apol_str_hash, free)) == NULL ||
+	    (log->mls_lvl = apol_bst_create_hashed(apol_str_strcmp, apol_str_hash, free)) == NULL ||
+	    (log->mls_clr = apol_bst_create_hashed(apol_str_strcmp, apol_str_hash, free)) == NULL ||
+	    (log->hosts = apol_bst_create_hashed(apol_str_strcmp, apol_str_hash, free)) == NULL
+	    || (log->bools = apol_bst_create_hashed(apol_str_strcmp, apol_str_hash, free)) == NULL
+	    || (log->managers = apol_bst_create_hashed(apol_str_strcmp, apol_str_hash, free)) == NULL
+	    || (log->strings = apol_bst_create_hashed(apol_str_strcmp, apol_str_hash, free)) == NULL
+	    || (log->perm_lists = apol_bst_create(log_perm_list_comp, log_perm_list_free)) == NULL
+	    || (log->slabs = apol_vector_create(NULL)) == NULL) {
 		error = errno;
 		seaudit_log_destroy(&log);
 		errno = error;
@@ -76,6 +102,11 @@ void seaudit_log_destroy(seaudit_log_t ** log)
 	apol_vector_destroy(&(*log)->messages);
 	apol_vector_destroy(&(*log)->malformed_msgs);
 	apol_vector_destroy(&(*log)->models);
+	log_free_slabs(*log);
+	apol_vector_destroy(&(*log)->slabs);
+	apol_vector_destroy(&(*log)->parse_perms);
+	apol_bst_destroy(&(*log)->strings);
+	apol_bst_destroy(&(*log)->perm_lists);
 	apol_bst_destroy(&(*log)->types);
 	apol_bst_destroy(&(*log)->classes);
 	apol_bst_destroy(&(*log)->roles);
@@ -86,6 +117,12 @@ void seaudit_log_destroy(seaudit_log_t ** log)
 	apol_bst_destroy(&(*log)->managers);
 	apol_bst_destroy(&(*log)->mls_lvl);
 	apol_bst_destroy(&(*log)->mls_clr);
+	free((*log)->parse_buf);
+	free((*log)->parse_tokens);
+	if ((*log)->follow_file != NULL) {
+		fclose((*log)->follow_file);
+	}
+	free((*log)->follow_path);
 	free(*log);
 	*log = NULL;
 }
@@ -98,6 +135,9 @@ void seaudit_log_clear(seaudit_log_t * log)
 	}
 	apol_vector_destroy(&log->messages);
 	apol_vector_destroy(&log->malformed_msgs);
+	log_free_slabs(log);
+	apol_bst_destroy(&log->strings);
+	apol_bst_destroy(&log->perm_lists);
 	apol_bst_destroy(&log->types);
 	apol_bst_destroy(&log->classes);
 	apol_bst_destroy(&log->roles);
@@ -108,18 +148,22 @@ void seaudit_log_clear(seaudit_log_t * log)
 	apol_bst_destroy(&log->managers);
 	apol_bst_destroy(&log->mls_lvl);
 	apol_bst_destroy(&log->mls_clr);
-	if ((log->messages = apol_vector_create(message_free)) == NULL ||
+	/* there is no longer a message for the next line to continue */
+	log->next_line = 0;
+	if ((log->messages = apol_vector_create(log->compact ? message_free_compact : message_free)) == NULL ||
 	    (log->malformed_msgs = apol_vector_create(free)) == NULL ||
-	    (log->types = apol_bst_create(apol_str_strcmp, free)) == NULL ||
-	    (log->classes = apol_bst_create(apol_str_strcmp, free)) == NULL ||
-	    (log->roles = apol_bst_create(apol_str_strcmp, free)) == NULL ||
-	    (log->users = apol_bst_create(apol_str_strcmp, free)) == NULL ||
-	    (log->perms = apol_bst_create(apol_str_strcmp, free)) == NULL ||
-	    (log->mls_lvl = apol_bst_create(apol_str_strcmp, free)) == NULL ||
-	    (log->mls_clr = apol_bst_create(apol_str_strcmp, free)) == NULL ||
-	    (log->hosts = apol_bst_create(apol_str_strcmp, free)) == NULL
-	    || (log->bools = apol_bst_create(apol_str_strcmp, free)) == NULL
-	    || (log->managers = apol_bst_create(apol_str_strcmp, free)) == NULL) {
+	    (log->types = apol_bst_create_hashed(apol_str_strcmp, apol_str_hash, free)) == NULL ||
+	    (log->classes = apol_bst_create_hashed(apol_str_strcmp, apol_str_hash, free)) == NULL ||
+	    (log->roles = apol_bst_create_hashed(apol_str_strcmp, apol_str_hash, free)) == NULL ||
+	    (log->users = apol_bst_create_hashed(apol_str_strcmp, apol_str_hash, free)) == NULL ||
+	    (log->perms = apol_bst_create_hashed(apol_str_strcmp, apol_str_hash, free)) == NULL ||
+	    (log->mls_lvl = apol_bst_create_hashed(apol_str_strcmp, apol_str_hash, free)) == NULL ||
+	    (log->mls_clr = apol_bst_create_hashed(apol_str_strcmp, apol_str_hash, free)) == NULL ||
+	    (log->hosts = apol_bst_create_hashed(apol_str_strcmp, apol_str_hash, free)) == NULL
+	    || (log->bools = apol_bst_create_hashed(apol_str_strcmp, apol_str_hash, free)) == NULL
+	    || (log->managers = apol_bst_create_hashed(apol_str_strcmp, apol_str_hash, free)) == NULL
+	    || (log->strings = apol_bst_create_hashed(apol_str_strcmp, apol_str_hash, free)) == NULL
+	    || (log->perm_lists = apol_bst_create(log_perm_list_comp, log_perm_list_free)) == NULL) {
 		/* hopefully will never get here... */
 		return;
 	}
@@ -129,6 +173,49 @@ void seaudit_log_clear(seaudit_log_t * log)
 	}
 }
 
+int seaudit_log_set_compact(seaudit_log_t * log, bool compact)
+{
+	apol_vector_t *v;
+	int error;
+	if (log == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (apol_vector_get_size(log->messages) > 0) {
+		ERR(log, "%s", "Cannot change how a log stores messages after it has parsed some.");
+		errno = EINVAL;
+		return -1;
+	}
+	if ((v = apol_vector_create(compact ? message_free_compact : message_free)) == NULL) {
+		error = errno;
+		ERR(log, "%s", strerror(error));
+		errno = error;
+		return -1;
+	}
+	apol_vector_destroy(&log->messages);
+	log->messages = v;
+	log->compact = compact;
+	return 0;
+}
+
+bool seaudit_log_get_compact(const seaudit_log_t * log)
+{
+	if (log == NULL) {
+		errno = EINVAL;
+		return false;
+	}
+	return log->compact != 0;
+}
+
+int seaudit_log_refresh_models(seaudit_log_t * log, unsigned int num_threads)
+{
+	if (log == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	return model_refresh_batch(log, log->models, num_threads);
+}
+
 apol_vector_t *seaudit_log_get_users(const seaudit_log_t * log)
 {
 	if (log == NULL) {
@@ -214,6 +301,37 @@ const apol_vector_t *log_get_malformed_messages(const seaudit_log_t * log)
 	return log->malformed_msgs;
 }
 
+int log_intern_perms(const seaudit_log_t * log, const apol_vector_t * perms, apol_vector_t ** result)
+{
+	apol_vector_t *v;
+	int error;
+	if (apol_bst_get_element(log->perm_lists, perms, NULL, (void **)result) == 0) {
+		return 0;
+	}
+	if ((v = apol_vector_create_from_vector(perms, NULL, NULL, NULL)) == NULL ||
+	    apol_bst_insert(log->perm_lists, v, NULL) < 0) {
+		error = errno;
+		apol_vector_destroy(&v);
+		ERR(log, "%s", strerror(error));
+		errno = error;
+		return -1;
+	}
+	*result = v;
+	return 0;
+}
+
+void log_free_slabs(seaudit_log_t * log)
+{
+	size_t i;
+	for (i = 0; log->slabs != NULL && i < apol_vector_get_size(log->slabs); i++) {
+		free(apol_vector_get_element(log->slabs, i));
+	}
+	while (apol_vector_get_size(log->slabs) > 0) {
+		apol_vector_remove(log->slabs, apol_vector_get_size(log->slabs) - 1);
+	}
+	log->slab_used = 0;
+}
+
 static void seaudit_handle_default_callback(void *arg __attribute__ ((unused)),
 					    const seaudit_log_t * log __attribute__ ((unused)),
 					    int level, const char *fmt, va_list va_args)
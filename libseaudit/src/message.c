@@ -136,6 +136,63 @@ char *seaudit_message_to_misc_string(const seaudit_message_t * msg)
 
 /******************** protected functions below ********************/
 
+/** number of AVC messages within each block of a compact log */
+#define MESSAGE_SLAB_SIZE 1024
+
+/**
+ * Everything for an AVC message within a compact log, allocated
+ * together.  The message must be the first member.
+ */
+typedef struct message_avc_record
+{
+	seaudit_message_t msg;
+	struct tm date_stamp;
+	seaudit_avc_message_t avc;
+} message_avc_record_t;
+
+/**
+ * Allocate an AVC message from a compact log's blocks, and append the
+ * message to the log.  Its permissions start as the log's shared
+ * empty list.
+ */
+static seaudit_message_t *message_create_compact_avc(seaudit_log_t * log)
+{
+	message_avc_record_t *r;
+	size_t num_slabs = apol_vector_get_size(log->slabs);
+	int error;
+
+	if (log->parse_perms == NULL && (log->parse_perms = apol_vector_create(NULL)) == NULL) {
+		error = errno;
+		goto err;
+	}
+	if (num_slabs == 0 || log->slab_used == MESSAGE_SLAB_SIZE) {
+		if ((r = malloc(MESSAGE_SLAB_SIZE * sizeof(*r))) == NULL || apol_vector_append(log->slabs, r) < 0) {
+			error = errno;
+			free(r);
+			goto err;
+		}
+		num_slabs++;
+		log->slab_used = 0;
+	}
+	r = (message_avc_record_t *) apol_vector_get_element(log->slabs, num_slabs - 1) + log->slab_used;
+	memset(r, 0, sizeof(*r));
+	while (apol_vector_get_size(log->parse_perms) > 0) {
+		apol_vector_remove(log->parse_perms, apol_vector_get_size(log->parse_perms) - 1);
+	}
+	if (log_intern_perms(log, log->parse_perms, &r->avc.perms) < 0 || apol_vector_append(log->messages, &r->msg) < 0) {
+		error = errno;
+		goto err;
+	}
+	log->slab_used++;
+	r->msg.type = SEAUDIT_MESSAGE_TYPE_AVC;
+	r->msg.data.avc = &r->avc;
+	return &r->msg;
+      err:
+	ERR(log, "%s", strerror(error));
+	errno = error;
+	return NULL;
+}
+
 seaudit_message_t *message_create(seaudit_log_t * log, seaudit_message_type_e type)
 {
 	seaudit_message_t *m;
@@ -145,6 +202,9 @@ seaudit_message_t *message_create(seaudit_log_t * log, seaudit_message_type_e ty
 		errno = EINVAL;
 		return NULL;
 	}
+	if (log->compact && type == SEAUDIT_MESSAGE_TYPE_AVC) {
+		return message_create_compact_avc(log);
+	}
 	if ((m = calloc(1, sizeof(*m))) == NULL || apol_vector_append(log->messages, m) < 0) {
 		error = errno;
 		message_free(m);
@@ -202,3 +262,28 @@ void message_free(void *msg)
 		free(m);
 	}
 }
+
+void message_free_compact(void *msg)
+{
+	seaudit_message_t *m = msg;
+	if (m != NULL && m->type != SEAUDIT_MESSAGE_TYPE_AVC) {
+		message_free(m);
+	}
+}
+
+int message_create_date(const seaudit_log_t * log, seaudit_message_t * msg)
+{
+	if (msg->date_stamp != NULL) {
+		return 0;
+	}
+	if (log->compact && msg->type == SEAUDIT_MESSAGE_TYPE_AVC) {
+		msg->date_stamp = &((message_avc_record_t *) msg)->date_stamp;
+		memset(msg->date_stamp, 0, sizeof(*msg->date_stamp));
+	} else if ((msg->date_stamp = calloc(1, sizeof(*msg->date_stamp))) == NULL) {
+		int error = errno;
+		ERR(log, "%s", strerror(error));
+		errno = error;
+		return -1;
+	}
+	return 0;
+}
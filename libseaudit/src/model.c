@@ -26,8 +26,10 @@
 
 #include <apol/bst.h>
 #include <errno.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include <libxml/uri.h>
 
 #define DEFAULT_MODEL_NAME "Untitled"
@@ -66,17 +68,32 @@ struct seaudit_model
 	size_t num_loads;
 	/** non-zero whenever this model needs to be recalculated */
 	int dirty;
+	/** non-zero if messages were removed from the model without
+	 * it needing to be recalculated */
+	int changed;
+	/** non-zero if messages were appended to the watched log
+	 * since the model was last calculated; only those messages
+	 * need to be considered (only meaningful if dirty == 0) */
+	int appended;
+	/** number of messages and malformed messages from the watched
+	 * log that have been considered (only valid if dirty == 0) */
+	size_t num_log_messages, num_log_malformed;
+	/** number of messages at the start of messages that are in
+	 * sorted order; those afterwards are not supported by any of
+	 * the sorts (only valid if dirty == 0) */
+	size_t num_sorted;
 };
 
 /**
  * Apply all of the model's filters to the message.
  *
  * @param model Model containing filters to apply.
+ * @param log Log to which the message belongs.
  * @param m Message to check.
  *
  * @return Non-zero if the message is accepted by the filters, 0 if not.
  */
-static int model_filter_message(seaudit_model_t * model, const seaudit_message_t * m)
+static int model_filter_message(seaudit_model_t * model, const seaudit_log_t * log, const seaudit_message_t * m)
 {
 	size_t i;
 	int compval, filters_passed = 0;
@@ -85,7 +102,7 @@ static int model_filter_message(seaudit_model_t * model, const seaudit_message_t
 	}
 	for (i = 0; i < apol_vector_get_size(model->filters); i++) {
 		seaudit_filter_t *f = apol_vector_get_element(model->filters, i);
-		compval = filter_is_accepted(f, m);
+		compval = filter_is_accepted(f, log, m);
 		if (compval) {
 			if (model->match == SEAUDIT_FILTER_MATCH_ANY) {
 				return 1;
@@ -147,69 +164,460 @@ static int message_comp(const void *a, const void *b, void *data)
 }
 
 /**
- * Sort the model's messages.  Create two temporary vectors.  The
- * first holds messages that are sortable, according to the list of
- * sort objects.  Sort them in their priority order.  The second
- * vector holds messages that are not sortable; append those messages
- * to the end of the first (now sorted) vector.
+ * Return non-zero if any of the model's sorts supports the message.
+ */
+static int model_is_sortable(const seaudit_model_t * model, const seaudit_message_t * m)
+{
+	size_t i;
+	for (i = 0; i < apol_vector_get_size(model->sorts); i++) {
+		if (sort_is_supported(apol_vector_get_element(model->sorts, i), m)) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/** Sort at least this many messages per thread. */
+#define MODEL_SORT_MIN_MESSAGES 16384
+/** Ranges with at most this many records are sorted by insertion. */
+#define MODEL_SORT_INSERTION_CUTOFF 16
+
+/**
+ * A message along with its keys, one per sort object in the sorts'
+ * priority order.
+ */
+typedef struct model_sort_record
+{
+	seaudit_message_t *msg;
+	const uint64_t *keys;
+} model_sort_record_t;
+
+/**
+ * One thread's share of sorting messages.
+ */
+typedef struct model_sort_job
+{
+	const apol_vector_t *sorts;
+	const apol_vector_t *messages;
+	/** keys of all of the messages, num_keys per message */
+	uint64_t *keys;
+	size_t num_keys;
+	/** records of all of the messages, and scratch space of the same
+	 * size for merging them */
+	model_sort_record_t *recs, *tmp;
+	/** range of records [first, last) to sort, or when merging the
+	 * two sorted ranges [first, mid) and [mid, last) */
+	size_t first, mid, last;
+} model_sort_job_t;
+
+static int model_record_comp(const model_sort_record_t * a, const model_sort_record_t * b, size_t num_keys)
+{
+	size_t i;
+	for (i = 0; i < num_keys; i++) {
+		if (a->keys[i] != b->keys[i]) {
+			return (a->keys[i] < b->keys[i] ? -1 : 1);
+		}
+	}
+	return 0;
+}
+
+/**
+ * Merge the adjacent sorted ranges of records [first, mid) and [mid,
+ * last), using the same range of tmp as scratch space.  Records from
+ * the first range are placed before equal ones from the second.
+ */
+static void model_records_merge(model_sort_record_t * recs, model_sort_record_t * tmp, size_t first, size_t mid, size_t last,
+				size_t num_keys)
+{
+	size_t i = first, j = mid, k = first;
+	if (first == mid || mid == last || model_record_comp(recs + mid - 1, recs + mid, num_keys) <= 0) {
+		/* already in order, as is typical for messages sorted by
+		 * date */
+		return;
+	}
+	while (i < mid && j < last) {
+		if (model_record_comp(recs + j, recs + i, num_keys) < 0) {
+			tmp[k++] = recs[j++];
+		} else {
+			tmp[k++] = recs[i++];
+		}
+	}
+	/* records remaining from the second range are already in place */
+	memcpy(tmp + k, recs + i, (mid - i) * sizeof(*tmp));
+	k += mid - i;
+	memcpy(recs + first, tmp + first, (k - first) * sizeof(*recs));
+}
+
+/**
+ * Stable merge sort of the records [first, last).
+ */
+static void model_records_sort(model_sort_record_t * recs, model_sort_record_t * tmp, size_t first, size_t last, size_t num_keys)
+{
+	size_t i, j, mid;
+	model_sort_record_t r;
+	if (last - first <= MODEL_SORT_INSERTION_CUTOFF) {
+		for (i = first + 1; i < last; i++) {
+			r = recs[i];
+			for (j = i; j > first && model_record_comp(recs + j - 1, &r, num_keys) > 0; j--) {
+				recs[j] = recs[j - 1];
+			}
+			recs[j] = r;
+		}
+		return;
+	}
+	mid = first + (last - first) / 2;
+	model_records_sort(recs, tmp, first, mid, num_keys);
+	model_records_sort(recs, tmp, mid, last, num_keys);
+	model_records_merge(recs, tmp, first, mid, last, num_keys);
+}
+
+/**
+ * Thread function that calculates the keys of a job's messages and
+ * then sorts their records.
+ */
+static void *model_sort_job_sort(void *arg)
+{
+	model_sort_job_t *job = arg;
+	size_t i, k;
+	uint64_t *keys;
+	for (i = job->first; i < job->last; i++) {
+		job->recs[i].msg = apol_vector_get_element(job->messages, i);
+		job->recs[i].keys = keys = job->keys + i * job->num_keys;
+		for (k = 0; k < job->num_keys; k++) {
+			keys[k] = sort_get_key(apol_vector_get_element(job->sorts, k), job->recs[i].msg);
+		}
+	}
+	model_records_sort(job->recs, job->tmp, job->first, job->last, job->num_keys);
+	return NULL;
+}
+
+/**
+ * Thread function that merges a job's two ranges of records.
+ */
+static void *model_sort_job_merge(void *arg)
+{
+	model_sort_job_t *job = arg;
+	model_records_merge(job->recs, job->tmp, job->first, job->mid, job->last, job->num_keys);
+	return NULL;
+}
+
+/**
+ * Run a function upon every job, each in its own thread.
  *
  * @param log Error handling log.
- * @param model Model to sort.
+ * @param jobs Array of jobs.
+ * @param job_size Size of each job.
+ * @param num_jobs Number of jobs.
+ * @param fn Function to run, given a pointer to its job.
  *
- * @return 0 on successful sort, < 0 on error.
+ * @return 0 on success, < 0 if a thread could not be created.
  */
-static int model_sort(const seaudit_log_t * log, seaudit_model_t * model)
+static int model_jobs_run(const seaudit_log_t * log, void *jobs, size_t job_size, size_t num_jobs, void *(*fn) (void *))
 {
-	size_t i, j, num_messages = apol_vector_get_size(model->messages);
-	apol_vector_t *sup = NULL, *unsup = NULL;
-	seaudit_message_t *m;
-	seaudit_sort_t *s;
-	int supported = 0, retval = -1, error = 0;
-	if (apol_vector_get_size(model->sorts) == 0) {
+	pthread_t *threads = NULL;
+	size_t i, num_started = 0;
+	int error = 0;
+
+	if (num_jobs > 1 && (threads = calloc(num_jobs, sizeof(*threads))) == NULL) {
+		error = errno;
+		ERR(log, "%s", strerror(error));
+		errno = error;
+		return -1;
+	}
+	/* the calling thread does the first job itself */
+	for (i = 1; i < num_jobs; i++) {
+		if ((error = pthread_create(threads + i, NULL, fn, (char *)jobs + i * job_size)) != 0) {
+			ERR(log, "%s", strerror(error));
+			break;
+		}
+		num_started++;
+	}
+	if (error == 0 && num_jobs > 0) {
+		fn(jobs);
+	}
+	for (i = 1; i <= num_started; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	free(threads);
+	if (error) {
+		errno = error;
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Return the number of threads among which divide some work.
+ *
+ * @param num_threads Maximum number of threads; if 0, use one per
+ * online processor.
+ * @param num_items Number of items of work.
+ * @param min_items Minimum number of items for each thread.
+ *
+ * @return Number of threads, at least 1.
+ */
+static size_t model_num_threads(unsigned int num_threads, size_t num_items, size_t min_items)
+{
+	size_t n = num_threads;
+	if (n == 0) {
+		long nproc = sysconf(_SC_NPROCESSORS_ONLN);
+		n = (nproc > 0 ? (size_t) nproc : 1);
+	}
+	if (n > num_items / min_items) {
+		n = num_items / min_items;
+	}
+	return (n > 0 ? n : 1);
+}
+
+/**
+ * Return the index of the first message in a run of messages.
+ */
+static size_t model_run_bound(size_t num_messages, size_t num_runs, size_t run)
+{
+	return (run >= num_runs ? num_messages : num_messages / num_runs * run);
+}
+
+/**
+ * Sort messages according to the model's sorts, in their priority
+ * order.  Every sort first calculates a fixed-width key for each
+ * message; the messages are then merge sorted by their keys, in
+ * parallel for large numbers of messages.  Messages that are not
+ * sortable (i.e., not supported by any of the sorts) end up after
+ * those that are, in their original order, as do sortable messages
+ * that compare equal.
+ *
+ * @param log Error handling log.
+ * @param model Model whose sorts to apply.
+ * @param v Vector of messages to sort.
+ * @param sorted Reference to a new vector of sorted messages.
+ * @param num_sortable Reference to the number of sortable messages.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+static int model_sort_messages(const seaudit_log_t * log, seaudit_model_t * model, const apol_vector_t * v,
+			       apol_vector_t ** sorted, size_t * num_sortable)
+{
+	size_t i, k, width, num_jobs, num_runs, num_messages = apol_vector_get_size(v), num_keys =
+		apol_vector_get_size(model->sorts);
+	uint64_t *keys = NULL;
+	model_sort_record_t *recs = NULL, *tmp = NULL;
+	model_sort_job_t *jobs = NULL;
+	int retval = -1, error = 0;
+
+	*num_sortable = 0;
+	if ((*sorted = apol_vector_create_with_capacity(num_messages, NULL)) == NULL) {
+		error = errno;
+		ERR(log, "%s", strerror(error));
+		goto cleanup;
+	}
+	if (num_messages == 0) {
 		retval = 0;
 		goto cleanup;
 	}
-
-	if ((sup = apol_vector_create_with_capacity(num_messages, NULL)) == NULL ||
-	    (unsup = apol_vector_create_with_capacity(num_messages, NULL)) == NULL) {
+	for (k = 0; k < num_keys; k++) {
+		if (sort_prepare_keys(log, apol_vector_get_element(model->sorts, k), v) < 0) {
+			error = errno;
+			goto cleanup;
+		}
+	}
+	num_runs = model_num_threads(0, num_messages, MODEL_SORT_MIN_MESSAGES);
+	if ((keys = malloc(num_messages * num_keys * sizeof(*keys))) == NULL ||
+	    (recs = malloc(num_messages * sizeof(*recs))) == NULL ||
+	    (tmp = malloc(num_messages * sizeof(*tmp))) == NULL || (jobs = calloc(num_runs, sizeof(*jobs))) == NULL) {
 		error = errno;
 		ERR(log, "%s", strerror(error));
 		goto cleanup;
 	}
+
+	/* each job calculates the keys of a run of messages and sorts
+	 * it; adjacent runs are then merged pairwise */
+	for (i = 0; i < num_runs; i++) {
+		jobs[i].sorts = model->sorts;
+		jobs[i].messages = v;
+		jobs[i].keys = keys;
+		jobs[i].num_keys = num_keys;
+		jobs[i].recs = recs;
+		jobs[i].tmp = tmp;
+		jobs[i].first = model_run_bound(num_messages, num_runs, i);
+		jobs[i].last = model_run_bound(num_messages, num_runs, i + 1);
+	}
+	if (model_jobs_run(log, jobs, sizeof(*jobs), num_runs, model_sort_job_sort) < 0) {
+		error = errno;
+		goto cleanup;
+	}
+	for (width = 1; width < num_runs; width *= 2) {
+		for (i = 0, num_jobs = 0; i + width < num_runs; i += 2 * width, num_jobs++) {
+			jobs[num_jobs].first = model_run_bound(num_messages, num_runs, i);
+			jobs[num_jobs].mid = model_run_bound(num_messages, num_runs, i + width);
+			jobs[num_jobs].last = model_run_bound(num_messages, num_runs, i + 2 * width);
+		}
+		if (model_jobs_run(log, jobs, sizeof(*jobs), num_jobs, model_sort_job_merge) < 0) {
+			error = errno;
+			goto cleanup;
+		}
+	}
+
 	for (i = 0; i < num_messages; i++) {
-		m = apol_vector_get_element(model->messages, i);
-		supported = 0;
-		for (j = 0; j < apol_vector_get_size(model->sorts); j++) {
-			s = apol_vector_get_element(model->sorts, j);
-			if ((supported = sort_is_supported(s, m)) != 0) {
-				break;
+		apol_vector_append(*sorted, recs[i].msg);
+		for (k = 0; k < num_keys && *num_sortable == i; k++) {
+			if (recs[i].keys[k] != SORT_KEY_UNSUPPORTED) {
+				(*num_sortable)++;
 			}
 		}
-		if ((supported && apol_vector_append(sup, m) < 0) || (!supported && apol_vector_append(unsup, m) < 0)) {
+	}
+	retval = 0;
+      cleanup:
+	for (k = 0; k < num_keys; k++) {
+		sort_discard_keys(apol_vector_get_element(model->sorts, k));
+	}
+	free(keys);
+	free(recs);
+	free(tmp);
+	free(jobs);
+	if (retval != 0) {
+		apol_vector_destroy(sorted);
+		errno = error;
+	}
+	return retval;
+}
+
+/**
+ * Sort the model's messages.  Messages that are sortable are sorted
+ * in the sorts' priority order; messages that are not sortable are
+ * then appended to the end of the sorted ones.
+ *
+ * @param log Error handling log.
+ * @param model Model to sort.
+ *
+ * @return 0 on successful sort, < 0 on error.
+ */
+static int model_sort(const seaudit_log_t * log, seaudit_model_t * model)
+{
+	apol_vector_t *sorted = NULL;
+	size_t num_sorted;
+	if (apol_vector_get_size(model->sorts) == 0) {
+		model->num_sorted = 0;
+		return 0;
+	}
+	if (model_sort_messages(log, model, model->messages, &sorted, &num_sorted) < 0) {
+		return -1;
+	}
+	apol_vector_destroy(&model->messages);
+	model->messages = sorted;
+	model->num_sorted = num_sorted;
+	return 0;
+}
+
+/**
+ * Add messages to a model whose messages are already sorted.  The
+ * new sortable messages are sorted among themselves and then merged
+ * into the model's sorted messages; a new message that compares
+ * equal to an existing one is placed after it.  New messages that
+ * are not sortable are appended to the end.
+ *
+ * @param log Error handling log.
+ * @param model Model to which add messages.
+ * @param added Vector of messages to add.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+static int model_merge(const seaudit_log_t * log, seaudit_model_t * model, const apol_vector_t * added)
+{
+	apol_vector_t *sorted = NULL, *merged = NULL;
+	size_t i = 0, j = 0, num_sortable, num_added = apol_vector_get_size(added), num_messages =
+		apol_vector_get_size(model->messages);
+	void *m;
+	int retval = -1, error = 0;
+
+	if (apol_vector_get_size(model->sorts) == 0) {
+		if (apol_vector_cat(model->messages, added) < 0) {
 			error = errno;
 			ERR(log, "%s", strerror(error));
-			goto cleanup;
+			errno = error;
+			return -1;
 		}
+		return 0;
+	}
+	if (model_sort_messages(log, model, added, &sorted, &num_sortable) < 0) {
+		return -1;
 	}
-	apol_vector_sort(sup, message_comp, model);
-	if (apol_vector_cat(sup, unsup) < 0) {
+	if ((merged = apol_vector_create_with_capacity(num_messages + num_added, NULL)) == NULL) {
 		error = errno;
 		ERR(log, "%s", strerror(error));
 		goto cleanup;
 	}
+	while (i < model->num_sorted || j < num_sortable) {
+		if (j == num_sortable ||
+		    (i < model->num_sorted &&
+		     message_comp(apol_vector_get_element(model->messages, i), apol_vector_get_element(sorted, j), model) <= 0)) {
+			m = apol_vector_get_element(model->messages, i++);
+		} else {
+			m = apol_vector_get_element(sorted, j++);
+		}
+		if (apol_vector_append(merged, m) < 0) {
+			error = errno;
+			ERR(log, "%s", strerror(error));
+			goto cleanup;
+		}
+	}
+	for (; i < num_messages; i++) {
+		if (apol_vector_append(merged, apol_vector_get_element(model->messages, i)) < 0) {
+			error = errno;
+			ERR(log, "%s", strerror(error));
+			goto cleanup;
+		}
+	}
+	for (; j < num_added; j++) {
+		if (apol_vector_append(merged, apol_vector_get_element(sorted, j)) < 0) {
+			error = errno;
+			ERR(log, "%s", strerror(error));
+			goto cleanup;
+		}
+	}
+	model->num_sorted += num_sortable;
 	apol_vector_destroy(&model->messages);
-	model->messages = sup;
-	sup = NULL;
+	model->messages = merged;
+	merged = NULL;
 	retval = 0;
       cleanup:
-	apol_vector_destroy(&sup);
-	apol_vector_destroy(&unsup);
+	apol_vector_destroy(&sorted);
+	apol_vector_destroy(&merged);
 	if (retval != 0) {
 		errno = error;
 	}
 	return retval;
 }
 
+/**
+ * Get the model's count of messages of the same type as a message.
+ *
+ * @param model Model whose statistics to get.
+ * @param msg Message whose type to count.
+ *
+ * @return Pointer to the counter, or NULL if messages of this type
+ * are not counted.
+ */
+static size_t *model_get_counter(seaudit_model_t * model, const seaudit_message_t * msg)
+{
+	seaudit_message_type_e type;
+	void *v;
+	seaudit_avc_message_t *avc;
+	v = seaudit_message_get_data(msg, &type);
+	if (type == SEAUDIT_MESSAGE_TYPE_AVC) {
+		avc = (seaudit_avc_message_t *) v;
+		if (avc->msg == SEAUDIT_AVC_DENIED) {
+			return &model->num_denies;
+		} else if (avc->msg == SEAUDIT_AVC_GRANTED) {
+			return &model->num_allows;
+		}
+	} else if (type == SEAUDIT_MESSAGE_TYPE_BOOL) {
+		return &model->num_bools;
+	} else if (type == SEAUDIT_MESSAGE_TYPE_LOAD) {
+		return &model->num_loads;
+	}
+	return NULL;
+}
+
 /**
  * Iterate through the model's messages and recalculate the number of
  * each type of message is stored within.
@@ -219,33 +627,202 @@ static int model_sort(const seaudit_log_t * log, seaudit_model_t * model)
 static void model_recalc_stats(seaudit_model_t * model)
 {
 	size_t i;
-	seaudit_message_t *msg;
-	seaudit_message_type_e type;
-	void *v;
-	seaudit_avc_message_t *avc;
 	model->num_allows = model->num_denies = model->num_bools = model->num_loads = 0;
+	size_t *counter;
 	for (i = 0; i < apol_vector_get_size(model->messages); i++) {
-		msg = apol_vector_get_element(model->messages, i);
-		v = seaudit_message_get_data(msg, &type);
-		if (type == SEAUDIT_MESSAGE_TYPE_AVC) {
-			avc = (seaudit_avc_message_t *) v;
-			if (avc->msg == SEAUDIT_AVC_DENIED) {
-				model->num_denies++;
-			} else if (avc->msg == SEAUDIT_AVC_GRANTED) {
-				model->num_allows++;
+		if ((counter = model_get_counter(model, apol_vector_get_element(model->messages, i))) != NULL) {
+			(*counter)++;
+		}
+	}
+}
+
+/**
+ * Compile all of the model's filters against a log's strings, prior
+ * to filtering that log's messages.
+ *
+ * @param model Model whose filters to compile.
+ * @param log Log whose messages will be filtered.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+static int model_compile_filters(seaudit_model_t * model, const seaudit_log_t * log)
+{
+	size_t i;
+	for (i = 0; i < apol_vector_get_size(model->filters); i++) {
+		if (filter_compile(apol_vector_get_element(model->filters, i), log) < 0) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Return non-zero if the message is to be shown by the model, based
+ * upon its hidden messages and its filters.
+ */
+static int model_is_visible(seaudit_model_t * model, const seaudit_log_t * log, const seaudit_message_t * message)
+{
+	void *result;
+	int filter_match;
+	if (apol_bst_get_size(model->hidden_messages) > 0 &&
+	    apol_bst_get_element(model->hidden_messages, (void *)message, NULL, &result) == 0) {
+		return 0;
+	}
+	filter_match = model_filter_message(model, log, message);
+	return ((filter_match && model->visible == SEAUDIT_FILTER_VISIBLE_SHOW) ||
+		(!filter_match && model->visible == SEAUDIT_FILTER_VISIBLE_HIDE));
+}
+
+/**
+ * Add to a model the messages appended to its log that passed its
+ * filters, along with all of the appended malformed messages, and
+ * update its statistics by just those messages.
+ *
+ * @param log Log to which report error messages.
+ * @param model Model to update; it must watch exactly one log.
+ * @param added Vector of visible messages appended to the log, in
+ * the log's order.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+static int model_add_appended(const seaudit_log_t * log, seaudit_model_t * model, const apol_vector_t * added)
+{
+	seaudit_log_t *l = apol_vector_get_element(model->logs, 0);
+	const apol_vector_t *mv = log_get_malformed_messages(l);
+	size_t i, *counter;
+	int error;
+
+	for (i = model->num_log_malformed; i < apol_vector_get_size(mv); i++) {
+		if (apol_vector_append(model->malformed_messages, apol_vector_get_element(mv, i)) < 0) {
+			error = errno;
+			ERR(log, "%s", strerror(error));
+			errno = error;
+			return -1;
+		}
+	}
+	if (model_merge(log, model, added) < 0) {
+		return -1;
+	}
+	for (i = 0; i < apol_vector_get_size(added); i++) {
+		if ((counter = model_get_counter(model, apol_vector_get_element(added, i))) != NULL) {
+			(*counter)++;
+		}
+	}
+	model->num_log_messages = apol_vector_get_size(log_get_messages(l));
+	model->num_log_malformed = apol_vector_get_size(mv);
+	return 0;
+}
+
+/**
+ * Consider only those messages that were appended to the model's log
+ * since the model was last calculated.  The new messages that pass
+ * the model's filters are merged into its messages and its
+ * statistics are updated by just those messages.
+ *
+ * @param log Log to which report error messages.
+ * @param model Model to update; it must watch exactly one log.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+static int model_refresh_appended(const seaudit_log_t * log, seaudit_model_t * model)
+{
+	seaudit_log_t *l = apol_vector_get_element(model->logs, 0);
+	const apol_vector_t *v = log_get_messages(l);
+	apol_vector_t *added = NULL;
+	seaudit_message_t *message;
+	size_t i;
+	int retval = -1, error = 0;
+
+	if ((added = apol_vector_create(NULL)) == NULL) {
+		error = errno;
+		ERR(log, "%s", strerror(error));
+		goto cleanup;
+	}
+	if (model_compile_filters(model, l) < 0) {
+		error = errno;
+		goto cleanup;
+	}
+	for (i = model->num_log_messages; i < apol_vector_get_size(v); i++) {
+		message = apol_vector_get_element(v, i);
+		if (model_is_visible(model, l, message) && apol_vector_append(added, message) < 0) {
+			error = errno;
+			ERR(log, "%s", strerror(error));
+			goto cleanup;
+		}
+	}
+	if (model_add_appended(log, model, added) < 0) {
+		error = errno;
+		goto cleanup;
+	}
+	retval = 0;
+      cleanup:
+	apol_vector_destroy(&added);
+	if (retval != 0) {
+		errno = error;
+	}
+	return retval;
+}
+
+/**
+ * Remove a message from a model that is otherwise up to date,
+ * without recalculating the model.  A sortable message is located by
+ * a binary search among the sorted messages.
+ *
+ * @param model Model from which remove the message.
+ * @param message Message to remove.  If the model does not contain
+ * it then do nothing.
+ */
+static void model_remove_message(seaudit_model_t * model, const seaudit_message_t * message)
+{
+	size_t num_messages = apol_vector_get_size(model->messages), i = num_messages, lo = 0, hi, mid, *counter;
+	seaudit_message_t *m;
+
+	if (model->num_sorted > 0 && model_is_sortable(model, message)) {
+		hi = model->num_sorted;
+		while (lo < hi) {
+			mid = lo + (hi - lo) / 2;
+			if (message_comp(apol_vector_get_element(model->messages, mid), message, model) < 0) {
+				lo = mid + 1;
+			} else {
+				hi = mid;
+			}
+		}
+		/* scan past messages that compare equal to this one */
+		for (; lo < model->num_sorted; lo++) {
+			m = apol_vector_get_element(model->messages, lo);
+			if (m == message) {
+				i = lo;
+				break;
+			}
+			if (message_comp(m, message, model) != 0) {
+				break;
 			}
-		} else if (type == SEAUDIT_MESSAGE_TYPE_BOOL) {
-			model->num_bools++;
-		} else if (type == SEAUDIT_MESSAGE_TYPE_LOAD) {
-			model->num_loads++;
 		}
 	}
+	if (i == num_messages) {
+		/* either the message is not sortable, or the sorts do not
+		 * totally order messages (e.g., dates with and without
+		 * years), so look everywhere */
+		for (i = 0; i < num_messages && apol_vector_get_element(model->messages, i) != message; i++) ;
+		if (i == num_messages) {
+			return;
+		}
+	}
+	apol_vector_remove(model->messages, i);
+	if (i < model->num_sorted) {
+		model->num_sorted--;
+	}
+	if ((counter = model_get_counter(model, message)) != NULL) {
+		(*counter)--;
+	}
+	model->changed = 1;
 }
 
 /**
  * Recalculate all of the messages associated with a particular model,
  * based upon that model's criteria.  If the model is marked as not
- * dirty then do nothing and return success.
+ * dirty then only consider messages that were appended to its log;
+ * if none were then do nothing and return success.
  *
  * @param log Log to which report error messages.
  * @param model Model whose messages list to refresh.
@@ -258,10 +835,18 @@ static int model_refresh(const seaudit_log_t * log, seaudit_model_t * model)
 	seaudit_log_t *l;
 	const apol_vector_t *v;
 	seaudit_message_t *message;
-	void *result;
-	int error, filter_match;
+	int error;
 
 	if (!model->dirty) {
+		if (model->appended) {
+			if (model_refresh_appended(log, model) < 0) {
+				/* start over upon the next refresh */
+				model->dirty = 1;
+				return -1;
+			}
+			model->appended = 0;
+		}
+		model->changed = 0;
 		return 0;
 	}
 	apol_vector_destroy(&model->messages);
@@ -274,22 +859,20 @@ static int model_refresh(const seaudit_log_t * log, seaudit_model_t * model)
 	}
 	for (i = 0; i < apol_vector_get_size(model->logs); i++) {
 		l = apol_vector_get_element(model->logs, i);
+		if (model_compile_filters(model, l) < 0) {
+			return -1;
+		}
 		v = log_get_messages(l);
 		for (j = 0; j < apol_vector_get_size(v); j++) {
 			message = apol_vector_get_element(v, j);
-			if (apol_bst_get_element(model->hidden_messages, message, NULL, &result) == 0) {
-				continue;
-			}
-			filter_match = model_filter_message(model, message);
-			if (((filter_match && model->visible == SEAUDIT_FILTER_VISIBLE_SHOW) ||
-			     (!filter_match && model->visible == SEAUDIT_FILTER_VISIBLE_HIDE)) &&
-			    apol_vector_append(model->messages, message) < 0) {
+			if (model_is_visible(model, l, message) && apol_vector_append(model->messages, message) < 0) {
 				error = errno;
 				ERR(log, "%s", strerror(error));
 				errno = error;
 				return -1;
 			}
 		}
+		model->num_log_messages = apol_vector_get_size(v);
 		v = log_get_malformed_messages(l);
 		if (apol_vector_cat(model->malformed_messages, v) < 0) {
 			error = errno;
@@ -297,15 +880,247 @@ static int model_refresh(const seaudit_log_t * log, seaudit_model_t * model)
 			errno = error;
 			return -1;
 		}
+		model->num_log_malformed = apol_vector_get_size(v);
 	}
 	if (model_sort(log, model) < 0) {
 		return -1;
 	}
 	model_recalc_stats(model);
 	model->dirty = 0;
+	model->appended = 0;
+	model->changed = 0;
 	return 0;
 }
 
+/** Filter at least this many messages per thread when refreshing
+ * models together. */
+#define MODEL_REFRESH_MIN_MESSAGES 16384
+
+/**
+ * One thread's share of refreshing several models that watch the
+ * same log.
+ */
+typedef struct model_refresh_job
+{
+	const seaudit_log_t *log;
+	/** vector of seaudit_model_t being refreshed */
+	const apol_vector_t *models;
+	/** for each model, index of the first of the log's messages
+	 * that it must consider */
+	const size_t *starts;
+	/** range of the log's messages [first, last) to filter */
+	size_t first, last;
+	/** for each model, vector of the messages within the range that
+	 * it shows, in the log's order */
+	apol_vector_t **visible;
+	/** errno of the first error, or 0 */
+	int error;
+} model_refresh_job_t;
+
+/**
+ * Thread function that filters a job's range of messages through
+ * every model, one message at a time.
+ */
+static void *model_refresh_job_filter(void *arg)
+{
+	model_refresh_job_t *job = arg;
+	const apol_vector_t *v = log_get_messages(job->log);
+	seaudit_message_t *message;
+	size_t i, k, num_models = apol_vector_get_size(job->models);
+	for (i = job->first; i < job->last && job->error == 0; i++) {
+		message = apol_vector_get_element(v, i);
+		for (k = 0; k < num_models; k++) {
+			if (i >= job->starts[k] && model_is_visible(apol_vector_get_element(job->models, k), job->log, message) &&
+			    apol_vector_append(job->visible[k], message) < 0) {
+				job->error = errno;
+				break;
+			}
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Replace all of the messages of a model that watches exactly one
+ * log, then sort them and recalculate the model's statistics.
+ *
+ * @param log Log to which report error messages.
+ * @param model Model to recalculate.
+ * @param messages Reference to a vector of the log's messages that
+ * the model shows, in the log's order.  Upon success the model takes
+ * ownership of the vector and the reference is set to NULL.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+static int model_refresh_from(const seaudit_log_t * log, seaudit_model_t * model, apol_vector_t ** messages)
+{
+	seaudit_log_t *l = apol_vector_get_element(model->logs, 0);
+	apol_vector_t *malformed;
+	int error;
+	if ((malformed = apol_vector_create_from_vector(log_get_malformed_messages(l), NULL, NULL, NULL)) == NULL) {
+		error = errno;
+		ERR(log, "%s", strerror(error));
+		errno = error;
+		return -1;
+	}
+	apol_vector_destroy(&model->messages);
+	apol_vector_destroy(&model->malformed_messages);
+	model->messages = *messages;
+	*messages = NULL;
+	model->malformed_messages = malformed;
+	model->num_log_messages = apol_vector_get_size(log_get_messages(l));
+	model->num_log_malformed = apol_vector_get_size(malformed);
+	if (model_sort(log, model) < 0) {
+		return -1;
+	}
+	model_recalc_stats(model);
+	model->dirty = 0;
+	return 0;
+}
+
+int model_refresh_batch(const seaudit_log_t * log, const apol_vector_t * models, unsigned int num_threads)
+{
+	apol_vector_t *batch = NULL, *v = NULL;
+	size_t num_messages = apol_vector_get_size(log_get_messages(log));
+	size_t *starts = NULL, i, j, k, first, num_batched = 0, num_jobs = 0;
+	model_refresh_job_t *jobs = NULL;
+	seaudit_model_t *model;
+	int retval = -1, error = 0;
+
+	if ((batch = apol_vector_create(NULL)) == NULL) {
+		error = errno;
+		ERR(log, "%s", strerror(error));
+		goto cleanup;
+	}
+	for (i = 0; i < apol_vector_get_size(models); i++) {
+		model = apol_vector_get_element(models, i);
+		if (!model->dirty && !model->appended) {
+			continue;
+		}
+		if (apol_vector_get_size(model->logs) != 1) {
+			/* only models watching just this log can share
+			 * its pass */
+			if (model_refresh(log, model) < 0) {
+				error = errno;
+				goto cleanup;
+			}
+			model->changed = 1;
+			continue;
+		}
+		if (model_compile_filters(model, log) < 0) {
+			error = errno;
+			goto cleanup;
+		}
+		if (apol_vector_append(batch, model) < 0) {
+			error = errno;
+			ERR(log, "%s", strerror(error));
+			goto cleanup;
+		}
+	}
+	if ((num_batched = apol_vector_get_size(batch)) == 0) {
+		retval = 0;
+		goto cleanup;
+	}
+
+	/* models that are not dirty need only consider appended
+	 * messages */
+	if ((starts = malloc(num_batched * sizeof(*starts))) == NULL) {
+		error = errno;
+		ERR(log, "%s", strerror(error));
+		goto cleanup;
+	}
+	first = num_messages;
+	for (k = 0; k < num_batched; k++) {
+		model = apol_vector_get_element(batch, k);
+		starts[k] = (model->dirty ? 0 : model->num_log_messages);
+		if (starts[k] < first) {
+			first = starts[k];
+		}
+	}
+	num_jobs = model_num_threads(num_threads, num_messages - first, MODEL_REFRESH_MIN_MESSAGES);
+	if ((jobs = calloc(num_jobs, sizeof(*jobs))) == NULL) {
+		error = errno;
+		ERR(log, "%s", strerror(error));
+		goto cleanup;
+	}
+	for (j = 0; j < num_jobs; j++) {
+		jobs[j].log = log;
+		jobs[j].models = batch;
+		jobs[j].starts = starts;
+		jobs[j].first = first + model_run_bound(num_messages - first, num_jobs, j);
+		jobs[j].last = first + model_run_bound(num_messages - first, num_jobs, j + 1);
+		if ((jobs[j].visible = calloc(num_batched, sizeof(*jobs[j].visible))) == NULL) {
+			error = errno;
+			ERR(log, "%s", strerror(error));
+			goto cleanup;
+		}
+		for (k = 0; k < num_batched; k++) {
+			if ((jobs[j].visible[k] = apol_vector_create(NULL)) == NULL) {
+				error = errno;
+				ERR(log, "%s", strerror(error));
+				goto cleanup;
+			}
+		}
+	}
+	if (model_jobs_run(log, jobs, sizeof(*jobs), num_jobs, model_refresh_job_filter) < 0) {
+		error = errno;
+		goto cleanup;
+	}
+	for (j = 0; j < num_jobs; j++) {
+		if (jobs[j].error != 0) {
+			error = jobs[j].error;
+			ERR(log, "%s", strerror(error));
+			goto cleanup;
+		}
+	}
+
+	/* each model's messages are those shown from each job's range,
+	 * in order */
+	for (k = 0; k < num_batched; k++) {
+		model = apol_vector_get_element(batch, k);
+		v = jobs[0].visible[k];
+		jobs[0].visible[k] = NULL;
+		for (j = 1; j < num_jobs; j++) {
+			if (apol_vector_cat(v, jobs[j].visible[k]) < 0) {
+				error = errno;
+				ERR(log, "%s", strerror(error));
+				goto cleanup;
+			}
+		}
+		if (model->dirty) {
+			if (model_refresh_from(log, model, &v) < 0) {
+				error = errno;
+				goto cleanup;
+			}
+		} else if (model_add_appended(log, model, v) < 0) {
+			error = errno;
+			/* start over upon the next refresh */
+			model->dirty = 1;
+			goto cleanup;
+		}
+		model->appended = 0;
+		/* the model's messages have not yet been retrieved */
+		model->changed = 1;
+		apol_vector_destroy(&v);
+	}
+	retval = 0;
+      cleanup:
+	apol_vector_destroy(&v);
+	for (j = 0; jobs != NULL && j < num_jobs; j++) {
+		for (k = 0; jobs[j].visible != NULL && k < num_batched; k++) {
+			apol_vector_destroy(&jobs[j].visible[k]);
+		}
+		free(jobs[j].visible);
+	}
+	free(jobs);
+	free(starts);
+	apol_vector_destroy(&batch);
+	if (retval != 0) {
+		errno = error;
+	}
+	return retval;
+}
+
 /**
  * Callback invoked when free()ing a vector of filters.
  *
@@ -380,21 +1195,13 @@ static void *model_filter_dup(const void *elem, void *data)
 static void *model_sort_dup(const void *elem, void *data __attribute__ ((unused)))
 {
 	const seaudit_sort_t *sort = elem;
-	seaudit_model_t *model = data;
-	seaudit_sort_t *s;
-	if ((s = sort_create_from_sort(sort)) == NULL) {
-		return NULL;
-	}
-	if (seaudit_model_append_sort(model, s) < 0) {
-		seaudit_sort_destroy(&s);
-		return NULL;
-	}
-	return s;
+	return sort_create_from_sort(sort);
 }
 
 seaudit_model_t *seaudit_model_create_from_model(const seaudit_model_t * model)
 {
 	seaudit_model_t *m = NULL;
+	apol_vector_t *hidden = NULL;
 	int error = 0;
 	size_t i;
 	const char *name;
@@ -427,6 +1234,17 @@ seaudit_model_t *seaudit_model_create_from_model(const seaudit_model_t * model)
 		error = errno;
 		goto cleanup;
 	}
+	if ((m->hidden_messages = apol_bst_create(NULL, NULL)) == NULL ||
+	    (hidden = apol_bst_get_vector(model->hidden_messages, 0)) == NULL) {
+		error = errno;
+		goto cleanup;
+	}
+	for (i = 0; i < apol_vector_get_size(hidden); i++) {
+		if (apol_bst_insert(m->hidden_messages, apol_vector_get_element(hidden, i), NULL) < 0) {
+			error = errno;
+			goto cleanup;
+		}
+	}
 	m->match = model->match;
 	m->visible = model->visible;
 	/* link this new model to the old model's logs */
@@ -438,6 +1256,7 @@ seaudit_model_t *seaudit_model_create_from_model(const seaudit_model_t * model)
 		}
 	}
       cleanup:
+	apol_vector_destroy(&hidden);
 	if (error != 0) {
 		seaudit_model_destroy(&m);
 		errno = error;
@@ -685,7 +1504,7 @@ int seaudit_model_is_changed(const seaudit_model_t * model)
 		errno = EINVAL;
 		return -1;
 	}
-	return model->dirty;
+	return model->dirty || model->appended || model->changed;
 }
 
 apol_vector_t *seaudit_model_get_messages(const seaudit_log_t * log, seaudit_model_t * model)
@@ -723,8 +1542,10 @@ void seaudit_model_hide_message(seaudit_model_t * model, const seaudit_message_t
 	if (message == NULL) {
 		return;
 	}
-	if (apol_bst_insert(model->hidden_messages, (seaudit_message_t *) message, NULL) == 0) {
-		model->dirty = 1;
+	/* a model that is otherwise up to date need only drop the
+	 * message, rather than be recalculated */
+	if (apol_bst_insert(model->hidden_messages, (seaudit_message_t *) message, NULL) == 0 && !model->dirty) {
+		model_remove_message(model, message);
 	}
 }
 
@@ -782,11 +1603,24 @@ size_t seaudit_model_get_num_loads(const seaudit_log_t * log, seaudit_model_t *
 
 /******************** protected functions below ********************/
 
+/**
+ * Discard the filters' compiled programs, because the strings to
+ * which they refer are about to be freed.
+ */
+static void model_discard_programs(seaudit_model_t * model)
+{
+	size_t i;
+	for (i = 0; i < apol_vector_get_size(model->filters); i++) {
+		filter_discard_program(apol_vector_get_element(model->filters, i));
+	}
+}
+
 void model_remove_log(seaudit_model_t * model, seaudit_log_t * log)
 {
 	size_t i;
 	if (apol_vector_get_index(model->logs, log, NULL, NULL, &i) == 0) {
 		apol_vector_remove(model->logs, i);
+		model_discard_programs(model);
 		model->dirty = 1;
 	}
 }
@@ -795,7 +1629,26 @@ void model_notify_log_changed(seaudit_model_t * model, seaudit_log_t * log)
 {
 	size_t i;
 	if (apol_vector_get_index(model->logs, log, NULL, NULL, &i) == 0) {
+		model_discard_programs(model);
+		model->dirty = 1;
+	}
+}
+
+void model_notify_log_appended(seaudit_model_t * model, seaudit_log_t * log, size_t first_message, size_t first_malformed)
+{
+	size_t i;
+	if (apol_vector_get_index(model->logs, log, NULL, NULL, &i) < 0 || model->dirty) {
+		return;
+	}
+	/* only a model watching a single log can merely append, for
+	 * otherwise the new messages belong between those of the
+	 * other logs */
+	if (apol_vector_get_size(model->logs) > 1 || first_message < model->num_log_messages ||
+	    first_malformed < model->num_log_malformed) {
 		model->dirty = 1;
+	} else if (first_message < apol_vector_get_size(log_get_messages(log)) ||
+		   first_malformed < apol_vector_get_size(log_get_malformed_messages(log))) {
+		model->appended = 1;
 	}
 }
 
@@ -32,9 +32,15 @@
 #include <ctype.h>
 #include <errno.h>
 #include <limits.h>
+#include <pthread.h>
+#include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include <selinux/context.h>
 
@@ -49,55 +55,160 @@
 #define SYSCALL_STRING "audit("
 
 /**
- * Given a line from an audit log, create and return a vector of
- * tokens from that line.  The caller is responsible for calling
- * apol_vector_destroy() upon that vector.  Note that this function
- * will modify the passed in line.
+ * Tokens of a single line, as split by parse_tokenize().
  */
-static int get_tokens(seaudit_log_t * log, char *line, apol_vector_t ** tokens)
+typedef struct parse_tokens
 {
-	char *line_ptr, *next;
-	*tokens = NULL;
-	int error = 0;
+	/** pointers into the log's parse buffer, followed by a NULL */
+	char **tok;
+	size_t num;
+} parse_tokens_t;
+
+/* markers found by parse_tokenize() while splitting a line */
+#define PARSE_HAS_KERNEL   0x01
+#define PARSE_HAS_AUDITD   0x02
+#define PARSE_HAS_AVC      0x04
+#define PARSE_HAS_LOAD     0x08
+#define PARSE_HAS_BOOL     0x10
 
-	if ((*tokens = apol_vector_create(NULL)) == NULL) {
-		error = errno;
-		ERR(log, "%s", strerror(error));
-		goto cleanup;
+/**
+ * Return non-zero if the len bytes at s contain the string needle.
+ */
+static int parse_run_contains(const char *s, size_t len, const char *needle, size_t needle_len)
+{
+	const char *end = s + len;
+	while (len >= needle_len && (s = memchr(s, needle[0], len - needle_len + 1)) != NULL) {
+		if (memcmp(s, needle, needle_len) == 0) {
+			return 1;
+		}
+		s++;
+		len = end - s;
 	}
-	line_ptr = line;
-	/* Tokenize line while ignoring any adjacent whitespace chars. */
-	while ((next = strsep(&line_ptr, " ")) != NULL) {
-		if (strcmp(next, "") && !apol_str_is_only_white_space(next)) {
-			if (apol_vector_append(*tokens, next) < 0) {
-				error = errno;
-				ERR(log, "%s", strerror(error));
-				goto cleanup;
+	return 0;
+}
+
+/**
+ * Copy a line into the log's parse buffer, splitting it at spaces
+ * into tokens; tokens consisting only of whitespace are skipped.
+ * While doing so determine what type of audit message the line is,
+ * in the same way as if the entire line were searched for each of
+ * the message markers.  The original line is not modified.
+ *
+ * @param log Log whose parse buffer to use.
+ * @param line Line to split; this need not be nul-terminated.
+ * @param len Number of bytes in the line.
+ * @param tokens Structure to fill with the line's tokens.  These
+ * remain valid until the next call to this function.
+ * @param type Reference to the type of message found.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+static int parse_tokenize(seaudit_log_t * log, const char *line, size_t len, parse_tokens_t * tokens, seaudit_message_type_e * type)
+{
+	/* there can be no more than one token for every two
+	 * characters, plus a terminating NULL */
+	size_t max_tokens = (len + 1) / 2 + 1, i = 0, start, run_len, prev_end = 0;
+	int markers = 0, prev_committed = 0;
+	char *buf;
+
+	if (len + 1 > log->parse_buf_size) {
+		if ((buf = realloc(log->parse_buf, len + 1)) == NULL) {
+			ERR(log, "%s", strerror(errno));
+			return -1;
+		}
+		log->parse_buf = buf;
+		log->parse_buf_size = len + 1;
+	}
+	if (max_tokens > log->parse_tokens_size) {
+		char **t;
+		if ((t = realloc(log->parse_tokens, max_tokens * sizeof(*t))) == NULL) {
+			ERR(log, "%s", strerror(errno));
+			return -1;
+		}
+		log->parse_tokens = t;
+		log->parse_tokens_size = max_tokens;
+	}
+	buf = log->parse_buf;
+	tokens->tok = log->parse_tokens;
+	tokens->num = 0;
+
+	while (i < len) {
+		if (line[i] == ' ') {
+			buf[i++] = '\0';
+			continue;
+		}
+		start = i;
+		while (i < len && line[i] != ' ') {
+			buf[i] = line[i];
+			i++;
+		}
+		buf[i] = '\0';
+		run_len = i - start;
+
+		/* none of the markers contain a space, so each must be
+		 * wholly within a run of non-space characters */
+		if (!(markers & PARSE_HAS_KERNEL) && parse_run_contains(line + start, run_len, "kernel", 6)) {
+			markers |= PARSE_HAS_KERNEL;
+		}
+		if (!(markers & PARSE_HAS_AUDITD) && parse_run_contains(line + start, run_len, AUDITD_MSG, 5)) {
+			markers |= PARSE_HAS_AUDITD;
+		}
+		if (start > 0 && i < len) {
+			/* " avc: " and " security: " require a space on
+			 * either side */
+			if (run_len == 4 && memcmp(line + start, "avc:", 4) == 0) {
+				markers |= PARSE_HAS_AVC;
+			} else if (run_len == 9 && memcmp(line + start, "security:", 9) == 0) {
+				markers |= PARSE_HAS_LOAD;
 			}
 		}
+		if (prev_committed && start == prev_end + 1 && run_len >= 8 && memcmp(line + start, "booleans", 8) == 0) {
+			markers |= PARSE_HAS_BOOL;
+		}
+		prev_committed = (run_len >= 9 && memcmp(line + i - 9, "committed", 9) == 0);
+		prev_end = i;
+
+		if (!isspace((unsigned char)buf[start]) || !apol_str_is_only_white_space(buf + start)) {
+			tokens->tok[tokens->num++] = buf + start;
+		}
 	}
-      cleanup:
-	if (error != 0) {
-		apol_vector_destroy(tokens);
-		errno = error;
-		return -1;
+	if (len == 0) {
+		buf[0] = '\0';
 	}
+	tokens->tok[tokens->num] = NULL;
+
+	if (!(markers & (PARSE_HAS_KERNEL | PARSE_HAS_AUDITD)))
+		*type = SEAUDIT_MESSAGE_TYPE_INVALID;
+	else if (markers & PARSE_HAS_BOOL)
+		*type = SEAUDIT_MESSAGE_TYPE_BOOL;
+	else if (markers & PARSE_HAS_LOAD)
+		*type = SEAUDIT_MESSAGE_TYPE_LOAD;
+	else if (markers & PARSE_HAS_AVC)
+		*type = SEAUDIT_MESSAGE_TYPE_AVC;
+	else
+		*type = SEAUDIT_MESSAGE_TYPE_INVALID;
 	return 0;
 }
 
 /**
- * Given a line, determine what type of audit message it is.
+ * Get the log's copy of a string from one of its BSTs, adding a copy
+ * of the string if it is not already there.  The string is only
+ * duplicated when it is new.
+ *
+ * @return 0 on success, < 0 on error.
  */
-static seaudit_message_type_e is_selinux(const char *line)
+static int parse_intern(apol_bst_t * b, const char *s, char **result)
 {
-	if (strstr(line, BOOLMSG) && (strstr(line, "kernel") || strstr(line, AUDITD_MSG)))
-		return SEAUDIT_MESSAGE_TYPE_BOOL;
-	else if (strstr(line, LOADMSG) && (strstr(line, "kernel") || strstr(line, AUDITD_MSG)))
-		return SEAUDIT_MESSAGE_TYPE_LOAD;
-	else if (strstr(line, AVCMSG) && (strstr(line, "kernel") || strstr(line, AUDITD_MSG)))
-		return SEAUDIT_MESSAGE_TYPE_AVC;
-	else
-		return SEAUDIT_MESSAGE_TYPE_INVALID;
+	char *t;
+	if (apol_bst_get_element(b, s, NULL, (void **)result) == 0) {
+		return 0;
+	}
+	if ((t = strdup(s)) == NULL || apol_bst_insert_and_get(b, (void **)&t, NULL) < 0) {
+		free(t);
+		return -1;
+	}
+	*result = t;
+	return 0;
 }
 
 extern int daylight;
@@ -108,45 +219,45 @@ extern int daylight;
  *
  * @return 0 on success, > 0 on warning, < 0 on error.
  */
-static int insert_time(const seaudit_log_t * log, const apol_vector_t * tokens, size_t * position, seaudit_message_t * msg)
+static int insert_time(const seaudit_log_t * log, const parse_tokens_t * tokens, size_t * position, seaudit_message_t * msg)
 {
-	char *t = NULL;
+	char buf[64], *t = buf;
 	size_t i, length = 0;
 	int error;
 
-	if (*position + NUM_TIME_COMPONENTS >= apol_vector_get_size(tokens)) {
+	if (*position + NUM_TIME_COMPONENTS >= tokens->num) {
 		WARN(log, "%s", "Not enough tokens for time.");
 		return 1;
 	}
 	for (i = 0; i < NUM_TIME_COMPONENTS; i++) {
-		length += strlen((char *)apol_vector_get_element(tokens, i + *position));
+		length += strlen(tokens->tok[i + *position]);
 	}
 
-	/* Increase size for terminating string char and whitespace within. */
+	/* Increase size for terminating string char and whitespace
+	 * within.  Timestamps almost always fit on the stack. */
 	length += NUM_TIME_COMPONENTS;
-	if ((t = (char *)calloc(1, length)) == NULL) {
+	if (length > sizeof(buf) && (t = (char *)malloc(length)) == NULL) {
 		error = errno;
 		ERR(log, "%s", strerror(error));
 		errno = error;
 		return -1;
 	}
+	t[0] = '\0';
 
 	for (i = 0; i < NUM_TIME_COMPONENTS; i++) {
 		if (i > 0) {
 			strcat(t, " ");
 		}
-		strcat(t, (char *)apol_vector_get_element(tokens, *position));
+		strcat(t, tokens->tok[*position]);
 		(*position)++;
 	}
 
-	if (!msg->date_stamp) {
-		if ((msg->date_stamp = (struct tm *)calloc(1, sizeof(struct tm))) == NULL) {
-			error = errno;
-			ERR(log, "%s", strerror(error));
+	if (message_create_date(log, msg) < 0) {
+		error = errno;
+		if (t != buf)
 			free(t);
-			errno = error;
-			return -1;
-		}
+		errno = error;
+		return -1;
 	}
 
 	if (strptime(t, "%b %d %T", msg->date_stamp) != NULL) {
@@ -156,7 +267,8 @@ static int insert_time(const seaudit_log_t * log, const apol_vector_t * tokens,
 		msg->date_stamp->tm_isdst = 0;
 		msg->date_stamp->tm_year = 0;
 	}
-	free(t);
+	if (t != buf)
+		free(t);
 	return 0;
 }
 
@@ -165,14 +277,14 @@ static int insert_time(const seaudit_log_t * log, const apol_vector_t * tokens,
  *
  * @return 0 on success, > 0 on warning, < 0 on error.
  */
-static int insert_hostname(const seaudit_log_t * log, const apol_vector_t * tokens, size_t * position, seaudit_message_t * msg)
+static int insert_hostname(const seaudit_log_t * log, const parse_tokens_t * tokens, size_t * position, seaudit_message_t * msg)
 {
 	char *s, *host;
-	if (*position >= apol_vector_get_size(tokens)) {
+	if (*position >= tokens->num) {
 		WARN(log, "%s", "Not enough tokens for hostname.");
 		return 1;
 	}
-	s = apol_vector_get_element(tokens, *position);
+	s = tokens->tok[*position];
 	/* Make sure this is not the kernel string identifier, which
 	 * may indicate that the hostname is empty. */
 	if (strstr(s, "kernel")) {
@@ -180,7 +292,7 @@ static int insert_hostname(const seaudit_log_t * log, const apol_vector_t * toke
 		return 1;
 	}
 	(*position)++;
-	if ((host = strdup(s)) == NULL || apol_bst_insert_and_get(log->hosts, (void **)&host, NULL) < 0) {
+	if (parse_intern(log->hosts, s, &host) < 0) {
 		int error = errno;
 		ERR(log, "%s", strerror(error));
 		errno = error;
@@ -190,7 +302,7 @@ static int insert_hostname(const seaudit_log_t * log, const apol_vector_t * toke
 	return 0;
 }
 
-static int insert_standard_msg_header(const seaudit_log_t * log, const apol_vector_t * tokens, size_t * position,
+static int insert_standard_msg_header(const seaudit_log_t * log, const parse_tokens_t * tokens, size_t * position,
 				      seaudit_message_t * msg)
 {
 	int ret = 0;
@@ -209,7 +321,7 @@ static int insert_standard_msg_header(const seaudit_log_t * log, const apol_vect
 static int insert_manager(const seaudit_log_t * log, seaudit_message_t * msg, const char *manager)
 {
 	char *m;
-	if ((m = strdup(manager)) == NULL || apol_bst_insert_and_get(log->managers, (void **)&m, NULL) < 0) {
+	if (parse_intern(log->managers, manager, &m) < 0) {
 		int error = errno;
 		ERR(log, "%s", strerror(error));
 		errno = error;
@@ -236,7 +348,7 @@ static int parse_context(seaudit_log_t * log, char *token, char **user, char **r
 		goto out;
 	}
 
-	if ((s = strdup(context_user_get(con))) == NULL || apol_bst_insert_and_get(log->users, (void **)&s, NULL) < 0) {
+	if (parse_intern(log->users, context_user_get(con), &s) < 0) {
 		error = errno;
 		ERR(log, "%s", strerror(error));
 		errno = error;
@@ -245,7 +357,7 @@ static int parse_context(seaudit_log_t * log, char *token, char **user, char **r
 	}
 	*user = s;
 
-	if ((s = strdup(context_role_get(con))) == NULL || apol_bst_insert_and_get(log->roles, (void **)&s, NULL) < 0) {
+	if (parse_intern(log->roles, context_role_get(con), &s) < 0) {
 		error = errno;
 		ERR(log, "%s", strerror(error));
 		errno = error;
@@ -254,7 +366,7 @@ static int parse_context(seaudit_log_t * log, char *token, char **user, char **r
 	}
 	*role = s;
 
-	if ((s = strdup(context_type_get(con))) == NULL || apol_bst_insert_and_get(log->types, (void **)&s, NULL) < 0) {
+	if (parse_intern(log->types, context_type_get(con), &s) < 0) {
 		error = errno;
 		ERR(log, "%s", strerror(error));
 		errno = error;
@@ -271,7 +383,7 @@ static int parse_context(seaudit_log_t * log, char *token, char **user, char **r
 			/* level and clearance are the same */
 			clr = lvl;
 
-		if ((s = strdup(lvl)) == NULL || apol_bst_insert_and_get(log->mls_lvl, (void **)&s, NULL) < 0) {
+		if (parse_intern(log->mls_lvl, lvl, &s) < 0) {
 			error = errno;
 			ERR(log, "%s", strerror(error));
 			errno = error;
@@ -280,7 +392,7 @@ static int parse_context(seaudit_log_t * log, char *token, char **user, char **r
 		}
 		*mls_lvl = s;
 
-		if ((s = strdup(clr)) == NULL || apol_bst_insert_and_get(log->mls_clr, (void **)&s, NULL) < 0) {
+		if (parse_intern(log->mls_clr, clr, &s) < 0) {
 			error = errno;
 			ERR(log, "%s", strerror(error));
 			errno = error;
@@ -336,36 +448,49 @@ static int avc_msg_is_prefix(char *token, char *prefix, char **result)
  *
  * @return 0 on success, > 0 on warning, < 0 on error.
  */
-static int avc_msg_insert_perms(const seaudit_log_t * log, apol_vector_t * tokens, size_t * position, seaudit_avc_message_t * avc)
+static int avc_msg_insert_perms(const seaudit_log_t * log, const parse_tokens_t * tokens, size_t * position, seaudit_avc_message_t * avc)
 {
+	/* a compact log gathers the permissions separately, then
+	 * shares the log's copy of the list */
+	apol_vector_t *perms = (log->compact ? log->parse_perms : avc->perms);
 	char *s, *perm;
-	int error;
-	if ((s = apol_vector_get_element(tokens, *position)) == NULL || strcmp(s, "{") != 0) {
+	int retval = 1, error;
+	if ((s = tokens->tok[*position]) == NULL || strcmp(s, "{") != 0) {
 		WARN(log, "%s", "Expected an opening brace while parsing permissions.");
 		return 1;
 	}
 	(*position)++;
 
-	while (*position < apol_vector_get_size(tokens)) {
-		s = apol_vector_get_element(tokens, *position);
+	if (log->compact) {
+		while (apol_vector_get_size(perms) > 0) {
+			apol_vector_remove(perms, apol_vector_get_size(perms) - 1);
+		}
+	}
+	while (*position < tokens->num) {
+		s = tokens->tok[*position];
 		assert(s != NULL);
 		(*position)++;
 		if (strcmp(s, "}") == 0) {
-			return 0;
+			retval = 0;
+			break;
 		}
 
-		if ((perm = strdup(s)) == NULL ||
-		    apol_bst_insert_and_get(log->perms, (void **)&perm, NULL) < 0 || apol_vector_append(avc->perms, perm) < 0) {
+		if (parse_intern(log->perms, s, &perm) < 0 || apol_vector_append(perms, perm) < 0) {
 			error = errno;
 			ERR(log, "%s", strerror(error));
 			errno = error;
 			return -1;
 		}
 	}
+	if (log->compact && log_intern_perms(log, perms, &avc->perms) < 0) {
+		return -1;
+	}
 
-	/* if got here, then message is too short */
-	WARN(log, "%s", "Expected a closing brace while parsing permissions.");
-	return 1;
+	if (retval > 0) {
+		/* if got here, then message is too short */
+		WARN(log, "%s", "Expected a closing brace while parsing permissions.");
+	}
+	return retval;
 }
 
 static int avc_msg_insert_syscall_info(const seaudit_log_t * log, char *token, seaudit_message_t * msg, seaudit_avc_message_t * avc)
@@ -410,13 +535,8 @@ static int avc_msg_insert_syscall_info(const seaudit_log_t * log, char *token, s
 	avc->tm_stmp_nano = atoi(fields[1]);
 	avc->serial = atoi(fields[2]);
 
-	if (msg->date_stamp == NULL) {
-		if ((msg->date_stamp = (struct tm *)malloc(sizeof(struct tm))) == NULL) {
-			int error = errno;
-			ERR(log, "%s", strerror(error));
-			errno = error;
-			return -1;
-		}
+	if (message_create_date(log, msg) < 0) {
+		return -1;
 	}
 	localtime_r(&temp, msg->date_stamp);
 	return 0;
@@ -479,7 +599,7 @@ static int avc_msg_insert_tcon(seaudit_log_t * log, seaudit_avc_message_t * avc,
 static int avc_msg_insert_tclass(seaudit_log_t * log, seaudit_avc_message_t * avc, const char *tmp)
 {
 	char *tclass;
-	if ((tclass = strdup(tmp)) == NULL || apol_bst_insert_and_get(log->classes, (void **)&tclass, NULL) < 0) {
+	if (parse_intern(log->classes, tmp, &tclass) < 0) {
 		int error = errno;
 		ERR(log, "%s", strerror(error));
 		errno = error;
@@ -489,9 +609,20 @@ static int avc_msg_insert_tclass(seaudit_log_t * log, seaudit_avc_message_t * av
 	return 0;
 }
 
+/**
+ * Set one of an AVC message's free-form strings.  A compact log
+ * keeps one copy of each distinct string; otherwise the message
+ * gets its own copy.
+ */
 static int avc_msg_insert_string(const seaudit_log_t * log, char *src, char **dest)
 {
-	if ((*dest = strdup(src)) == NULL) {
+	int retval;
+	if (log->compact) {
+		retval = parse_intern(log->strings, src, dest);
+	} else {
+		retval = ((*dest = strdup(src)) == NULL ? -1 : 0);
+	}
+	if (retval < 0) {
 		int error = errno;
 		ERR(log, "%s", strerror(error));
 		errno = error;
@@ -502,7 +633,8 @@ static int avc_msg_insert_string(const seaudit_log_t * log, char *src, char **de
 
 /**
  * Removes quotes from a string, this is currently to remove quotes
- * from the command argument.
+ * from the command argument.  The quotes are removed from src in
+ * place.
  */
 static int avc_msg_remove_quotes_insert_string(const seaudit_log_t * log, char *src, char **dest)
 {
@@ -512,21 +644,15 @@ static int avc_msg_remove_quotes_insert_string(const seaudit_log_t * log, char *
 	/* see if there are any quotes to begin with if there aren't
 	 * just run insert string */
 	if (src[0] == '\"' && l > 0 && src[l - 1] == '\"') {
-		if ((*dest = calloc(1, l + 1)) == NULL) {
-			int error = errno;
-			ERR(log, "%s", strerror(error));
-			errno = error;
-			return -1;
-		}
 		for (i = 0, j = 0; i < l; i++) {
 			if (src[i] != '\"') {
-				(*dest)[j] = src[i];
+				src[j] = src[i];
 				j++;
 			}
 		}
-		return 0;
-	} else
-		return avc_msg_insert_string(log, src, dest);
+		src[j] = '\0';
+	}
+	return avc_msg_insert_string(log, src, dest);
 }
 
 /**
@@ -546,28 +672,28 @@ static int avc_msg_is_valid_additional_field(const char *orig_token)
 	return 1;
 }
 
-static int avc_msg_reformat_path(const seaudit_log_t * log, seaudit_avc_message_t * avc, const char *token)
+static int avc_msg_reformat_path(const seaudit_log_t * log, char **path, const char *token)
 {
 	int error;
-	if (avc->path == NULL) {
-		if ((avc->path = strdup(token)) == NULL) {
+	if (*path == NULL) {
+		if ((*path = strdup(token)) == NULL) {
 			error = errno;
 			ERR(log, "%s", strerror(error));
 			errno = error;
 			return -1;
 		}
 	} else {
-		size_t len = strlen(avc->path) + strlen(token) + 2;
-		char *s = realloc(avc->path, len);
+		size_t len = strlen(*path) + strlen(token) + 2;
+		char *s = realloc(*path, len);
 		if (s == NULL) {
 			error = errno;
 			ERR(log, "%s", strerror(error));
 			errno = error;
 			return -1;
 		}
-		avc->path = s;
-		strcat(avc->path, " ");
-		strcat(avc->path, token);
+		*path = s;
+		strcat(*path, " ");
+		strcat(*path, token);
 	}
 	return 0;
 }
@@ -578,15 +704,15 @@ static int avc_msg_reformat_path(const seaudit_log_t * log, seaudit_avc_message_
  *
  * @return 0 on success, > 0 if warnings, < 0 on error
  */
-static int avc_msg_insert_additional_field_data(seaudit_log_t * log, apol_vector_t * tokens, seaudit_avc_message_t * avc,
+static int avc_msg_insert_additional_field_data(seaudit_log_t * log, const parse_tokens_t * tokens, seaudit_avc_message_t * avc,
 						size_t * position)
 {
 	char *token, *v;
 	int retval, has_warnings = 0;
 
 	avc->avc_type = SEAUDIT_AVC_DATA_FS;
-	for (; (*position) < apol_vector_get_size(tokens); (*position)++) {
-		token = apol_vector_get_element(tokens, (*position));
+	for (; (*position) < tokens->num; (*position)++) {
+		token = tokens->tok[*position];
 		v = NULL;
 		if (strcmp(token, "") == 0) {
 			break;
@@ -619,18 +745,29 @@ static int avc_msg_insert_additional_field_data(seaudit_log_t * log, apol_vector
 		 * make sure not to access memory beyond the total
 		 * number of tokens. */
 		if (!avc->path && avc_msg_is_prefix(token, "path=", &v)) {
-			if (avc_msg_reformat_path(log, avc, v) < 0) {
+			char *path = NULL;
+			if (avc_msg_reformat_path(log, &path, v) < 0) {
 				return -1;
 			}
-			while (*position + 1 < apol_vector_get_size(tokens)) {
-				token = apol_vector_get_element(tokens, *position + 1);
+			while (*position + 1 < tokens->num) {
+				token = tokens->tok[*position + 1];
 				if (avc_msg_is_valid_additional_field(token)) {
 					break;
 				}
 				(*position)++;
-				if (avc_msg_reformat_path(log, avc, token) < 0) {
+				if (avc_msg_reformat_path(log, &path, token) < 0) {
+					free(path);
+					return -1;
+				}
+			}
+			if (log->compact) {
+				retval = avc_msg_insert_string(log, path, &avc->path);
+				free(path);
+				if (retval < 0) {
 					return -1;
 				}
+			} else {
+				avc->path = path;
 			}
 			continue;
 		}
@@ -798,13 +935,13 @@ static int avc_msg_insert_additional_field_data(seaudit_log_t * log, apol_vector
 	return has_warnings;
 }
 
-static int avc_parse(seaudit_log_t * log, apol_vector_t * tokens)
+static int avc_parse(seaudit_log_t * log, const parse_tokens_t * tokens)
 {
 	seaudit_message_t *msg;
 	seaudit_avc_message_t *avc;
 	seaudit_message_type_e type;
 	int ret, has_warnings = 0;
-	size_t position = 0, num_tokens = apol_vector_get_size(tokens);
+	size_t position = 0, num_tokens = tokens->num;
 	char *token, *t;
 
 	if ((msg = message_create(log, SEAUDIT_MESSAGE_TYPE_AVC)) == NULL) {
@@ -812,7 +949,7 @@ static int avc_parse(seaudit_log_t * log, apol_vector_t * tokens)
 	}
 	avc = seaudit_message_get_data(msg, &type);
 
-	token = apol_vector_get_element(tokens, position);
+	token = tokens->tok[position];
 
 	/* Check for new auditd log format */
 	if (strstr(token, AUDITD_MSG)) {
@@ -822,7 +959,7 @@ static int avc_parse(seaudit_log_t * log, apol_vector_t * tokens)
 			return 1;
 		}
 		log->logtype = SEAUDIT_LOG_TYPE_AUDITD;
-		token = apol_vector_get_element(tokens, position);
+		token = tokens->tok[position];
 	}
 
 	/* Insert the audit header if it exists */
@@ -838,7 +975,7 @@ static int avc_parse(seaudit_log_t * log, apol_vector_t * tokens)
 				WARN(log, "%s", "Not enough tokens for new audit header.");
 				return 1;
 			}
-			token = apol_vector_get_element(tokens, position);
+			token = tokens->tok[position];
 		}
 	} else {
 		ret = insert_standard_msg_header(log, tokens, &position, msg);
@@ -851,7 +988,7 @@ static int avc_parse(seaudit_log_t * log, apol_vector_t * tokens)
 			WARN(log, "%s", "Not enough tokens for new audit header.");
 			return 1;
 		}
-		token = apol_vector_get_element(tokens, position);
+		token = tokens->tok[position];
 
 		/* for now, only let avc messages set their object
 		 * manager */
@@ -869,7 +1006,7 @@ static int avc_parse(seaudit_log_t * log, apol_vector_t * tokens)
 				WARN(log, "%s", "Not enough tokens for new audit header.");
 				return 1;
 			}
-			token = apol_vector_get_element(tokens, position);
+			token = tokens->tok[position];
 		}
 
 		/* new style audit messages can show up in syslog
@@ -890,7 +1027,7 @@ static int avc_parse(seaudit_log_t * log, apol_vector_t * tokens)
 					WARN(log, "%s", "Not enough tokens for new audit header.");
 					return 1;
 				}
-				token = apol_vector_get_element(tokens, position);
+				token = tokens->tok[position];
 			}
 		}
 	}
@@ -906,7 +1043,7 @@ static int avc_parse(seaudit_log_t * log, apol_vector_t * tokens)
 			WARN(log, "%s", "Not enough tokens for new audit header.");
 			return 1;
 		}
-		token = apol_vector_get_element(tokens, position);
+		token = tokens->tok[position];
 	}
 
 	/* Insert denied or granted */
@@ -918,7 +1055,7 @@ static int avc_parse(seaudit_log_t * log, apol_vector_t * tokens)
 			WARN(log, "%s", "Not enough tokens for new audit header.");
 			return 1;
 		}
-		token = apol_vector_get_element(tokens, position);
+		token = tokens->tok[position];
 	}
 
 	/* Insert perm(s) */
@@ -932,7 +1069,7 @@ static int avc_parse(seaudit_log_t * log, apol_vector_t * tokens)
 		WARN(log, "%s", "Message appears to be truncated.");
 		return 1;
 	}
-	token = apol_vector_get_element(tokens, position);
+	token = tokens->tok[position];
 
 	if (strcmp(token, "for") != 0) {
 		/* Hold the position */
@@ -944,7 +1081,7 @@ static int avc_parse(seaudit_log_t * log, apol_vector_t * tokens)
 			WARN(log, "%s", "Not enough tokens for new audit header.");
 			return 1;
 		}
-		token = apol_vector_get_element(tokens, position);
+		token = tokens->tok[position];
 	}
 
 	/* At this point we have a valid message, for we have gathered
@@ -993,13 +1130,13 @@ static int boolean_msg_insert_bool(seaudit_log_t * log, seaudit_bool_message_t *
 	return bool_change_append(log, boolm, token, value);
 }
 
-static int bool_parse(seaudit_log_t * log, apol_vector_t * tokens)
+static int bool_parse(seaudit_log_t * log, const parse_tokens_t * tokens)
 {
 	seaudit_message_t *msg;
 	seaudit_bool_message_t *boolm;
 	seaudit_message_type_e type;
 	int ret, has_warnings = 0, next_line = log->next_line;
-	size_t position = 0, num_tokens = apol_vector_get_size(tokens);
+	size_t position = 0, num_tokens = tokens->num;
 	char *token;
 
 	if (log->next_line) {
@@ -1026,7 +1163,7 @@ static int bool_parse(seaudit_log_t * log, apol_vector_t * tokens)
 		WARN(log, "%s", "Not enough tokens for boolean change.");
 		return 1;
 	}
-	token = apol_vector_get_element(tokens, position);
+	token = tokens->tok[position];
 
 	/* Make sure the following token is the string "kernel:" */
 	if (!strstr(token, "kernel:")) {
@@ -1042,7 +1179,7 @@ static int bool_parse(seaudit_log_t * log, apol_vector_t * tokens)
 			WARN(log, "%s", "Not enough tokens for boolean change.");
 			return 1;
 		}
-		token = apol_vector_get_element(tokens, position);
+		token = tokens->tok[position];
 	}
 
 	if (!next_line) {
@@ -1056,7 +1193,7 @@ static int bool_parse(seaudit_log_t * log, apol_vector_t * tokens)
 				WARN(log, "%s", "Not enough tokens for boolean change.");
 				return 1;
 			}
-			token = apol_vector_get_element(tokens, position);
+			token = tokens->tok[position];
 		}
 
 		if (!strstr(token, "committed")) {
@@ -1069,7 +1206,7 @@ static int bool_parse(seaudit_log_t * log, apol_vector_t * tokens)
 				WARN(log, "%s", "Not enough tokens for boolean change.");
 				return 1;
 			}
-			token = apol_vector_get_element(tokens, position);
+			token = tokens->tok[position];
 		}
 
 		if (!strstr(token, "booleans")) {
@@ -1082,7 +1219,7 @@ static int bool_parse(seaudit_log_t * log, apol_vector_t * tokens)
 				WARN(log, "%s", "Not enough tokens for boolean change.");
 				return 1;
 			}
-			token = apol_vector_get_element(tokens, position);
+			token = tokens->tok[position];
 		}
 
 		if (!strstr(token, "{")) {
@@ -1095,14 +1232,14 @@ static int bool_parse(seaudit_log_t * log, apol_vector_t * tokens)
 				WARN(log, "%s", "Not enough tokens for boolean change.");
 				return 1;
 			}
-			token = apol_vector_get_element(tokens, position);
+			token = tokens->tok[position];
 		}
 	}
 
 	/* keep parsing until a closing brace is found.  if end of
 	 * tokens is reached, then keep parsing the next line */
 	while (position < num_tokens) {
-		token = apol_vector_get_element(tokens, position);
+		token = tokens->tok[position];
 		position++;
 
 		if (!strcmp(token, "}")) {
@@ -1136,17 +1273,17 @@ static int bool_parse(seaudit_log_t * log, apol_vector_t * tokens)
  * error.  If it is the older style, then increment reference pointer
  * position to point to the next unprocessed token.
  */
-static int load_policy_msg_is_old_load_policy_string(const seaudit_log_t * log, const apol_vector_t * tokens, size_t * position)
+static int load_policy_msg_is_old_load_policy_string(const seaudit_log_t * log, const parse_tokens_t * tokens, size_t * position)
 {
 	size_t i, length = 0;
 	int rt;
 	char *tmp = NULL;
-	if (*position + 4 >= apol_vector_get_size(tokens)) {
+	if (*position + 4 >= tokens->num) {
 		return 0;
 	}
 
 	for (i = 0; i < 4; i++) {
-		length += strlen((char *)apol_vector_get_element(tokens, i + *position));
+		length += strlen(tokens->tok[i + *position]);
 	}
 
 	if ((tmp = (char *)calloc(length + 1, sizeof(char))) == NULL) {
@@ -1157,7 +1294,7 @@ static int load_policy_msg_is_old_load_policy_string(const seaudit_log_t * log,
 	}
 
 	for (i = 0; i < 4; i++) {
-		strcat(tmp, (char *)apol_vector_get_element(tokens, i + *position));
+		strcat(tmp, tokens->tok[i + *position]);
 	}
 
 	rt = strcmp(tmp, OLD_LOAD_POLICY_STRING);
@@ -1170,9 +1307,9 @@ static int load_policy_msg_is_old_load_policy_string(const seaudit_log_t * log,
 		return 0;
 }
 
-static void load_policy_msg_get_policy_components(seaudit_load_message_t * load, const apol_vector_t * tokens, size_t * position)
+static void load_policy_msg_get_policy_components(seaudit_load_message_t * load, const parse_tokens_t * tokens, size_t * position)
 {
-	char *arg = apol_vector_get_element(tokens, *position);
+	char *arg = tokens->tok[*position];
 	char *endptr;
 	unsigned int val = (unsigned int)strtoul(arg, &endptr, 10);
 	if (*endptr != '\0') {
@@ -1181,7 +1318,7 @@ static void load_policy_msg_get_policy_components(seaudit_load_message_t * load,
 		(*position)++;
 		return;
 	}
-	char *id = apol_vector_get_element(tokens, *position + 1);
+	char *id = tokens->tok[*position + 1];
 	assert(id != NULL && arg != NULL);
 	if (load->classes == 0 && strstr(id, "classes")) {
 		load->classes = val;
@@ -1199,13 +1336,13 @@ static void load_policy_msg_get_policy_components(seaudit_load_message_t * load,
 	*position += 2;
 }
 
-static int load_parse(seaudit_log_t * log, const apol_vector_t * tokens)
+static int load_parse(seaudit_log_t * log, const parse_tokens_t * tokens)
 {
 	seaudit_message_t *msg;
 	seaudit_load_message_t *load;
 	seaudit_message_type_e type;
 	int ret, error, has_warnings = 0;
-	size_t position = 0, num_tokens = apol_vector_get_size(tokens);
+	size_t position = 0, num_tokens = tokens->num;
 	char *token;
 
 	if (log->next_line) {
@@ -1232,7 +1369,7 @@ static int load_parse(seaudit_log_t * log, const apol_vector_t * tokens)
 		WARN(log, "%s", "Not enough tokens for policy load.");
 		return 1;
 	}
-	token = apol_vector_get_element(tokens, position);
+	token = tokens->tok[position];
 
 	if (strcmp(token, "invalidating") == 0) {
 		WARN(log, "%s", "Got an unexpected invalidating message.");
@@ -1243,7 +1380,7 @@ static int load_parse(seaudit_log_t * log, const apol_vector_t * tokens)
 		WARN(log, "%s", "Not enough tokens for policy load.");
 		return 1;
 	}
-	if (strcmp((char *)apol_vector_get_element(tokens, position + 1), "bools") == 0) {
+	if (strcmp(tokens->tok[position + 1], "bools") == 0) {
 		WARN(log, "%s", "Got an unexpected bools message.");
 		return 1;
 	}
@@ -1262,7 +1399,7 @@ static int load_parse(seaudit_log_t * log, const apol_vector_t * tokens)
 			WARN(log, "%s", "Not enough tokens for policy load.");
 			return 1;
 		}
-		token = apol_vector_get_element(tokens, position);
+		token = tokens->tok[position];
 	}
 
 	if (strcmp(token, "security:")) {
@@ -1275,7 +1412,7 @@ static int load_parse(seaudit_log_t * log, const apol_vector_t * tokens)
 			WARN(log, "%s", "Not enough tokens for policy load.");
 			return 1;
 		}
-		token = apol_vector_get_element(tokens, position);
+		token = tokens->tok[position];
 	}
 
 	ret = load_policy_msg_is_old_load_policy_string(log, tokens, &position);
@@ -1286,7 +1423,7 @@ static int load_parse(seaudit_log_t * log, const apol_vector_t * tokens)
 			WARN(log, "%s", "Not enough tokens for policy load.");
 			return 1;
 		}
-		token = apol_vector_get_element(tokens, position);
+		token = tokens->tok[position];
 		if ((load->binary = strdup(token)) == NULL) {
 			error = errno;
 			ERR(log, "%s", strerror(error));
@@ -1309,17 +1446,27 @@ static int load_parse(seaudit_log_t * log, const apol_vector_t * tokens)
 }
 
 /**
- * Parse a single nul-terminated line from an selinux audit log.
+ * Parse a single line from an selinux audit log.  The line need not
+ * be nul-terminated and is not modified.
  */
-static int seaudit_log_parse_line(seaudit_log_t * log, char *line)
+static int seaudit_log_parse_line(seaudit_log_t * log, const char *line, size_t len)
 {
 	char *orig_line = NULL;
 	seaudit_message_t *prev_message;
 	seaudit_message_type_e is_sel, prev_message_type;
-	apol_vector_t *tokens = NULL;
-	int retval = -1, retval2, has_warnings = 0, error = 0;
+	parse_tokens_t tokens;
+	int retval2, has_warnings = 0, error = 0;
 
-	is_sel = is_selinux(line);
+	while (len > 0 && isspace((unsigned char)line[0])) {
+		line++;
+		len--;
+	}
+	while (len > 0 && isspace((unsigned char)line[len - 1])) {
+		len--;
+	}
+	if (parse_tokenize(log, line, len, &tokens, &is_sel) < 0) {
+		return -1;
+	}
 	if (log->next_line) {
 		prev_message = apol_vector_get_element(log->messages, apol_vector_get_size(log->messages) - 1);
 		seaudit_message_get_data(prev_message, &prev_message_type);
@@ -1337,26 +1484,15 @@ static int seaudit_log_parse_line(seaudit_log_t * log, char *line)
 		return 0;
 	}
 
-	if ((orig_line = strdup(line)) == NULL) {
-		error = errno;
-		ERR(log, "%s", strerror(error));
-		goto cleanup;
-	}
-	if (get_tokens(log, line, &tokens) < 0) {
-		error = errno;
-		ERR(log, "%s", strerror(error));
-		goto cleanup;
-	}
-
 	switch (is_sel) {
 	case SEAUDIT_MESSAGE_TYPE_AVC:
-		retval2 = avc_parse(log, tokens);
+		retval2 = avc_parse(log, &tokens);
 		break;
 	case SEAUDIT_MESSAGE_TYPE_BOOL:
-		retval2 = bool_parse(log, tokens);
+		retval2 = bool_parse(log, &tokens);
 		break;
 	case SEAUDIT_MESSAGE_TYPE_LOAD:
-		retval2 = load_parse(log, tokens);
+		retval2 = load_parse(log, &tokens);
 		break;
 	default:
 		/* should never get here */
@@ -1367,147 +1503,1176 @@ static int seaudit_log_parse_line(seaudit_log_t * log, char *line)
 	if (retval2 < 0) {
 		error = errno;
 		ERR(log, "%s", strerror(error));
-		goto cleanup;
+		errno = error;
+		return -1;
 	} else if (retval2 > 0) {
-		if (apol_vector_append(log->malformed_msgs, orig_line) < 0) {
+		/* only now is a copy of the line needed */
+		if ((orig_line = strndup(line, len)) == NULL || apol_vector_append(log->malformed_msgs, orig_line) < 0) {
 			error = errno;
+			free(orig_line);
 			ERR(log, "%s", strerror(error));
-			goto cleanup;
+			errno = error;
+			return -1;
 		}
-		orig_line = NULL;
 		has_warnings = 1;
 	}
+	return has_warnings;
+}
 
-	retval = 0;
-      cleanup:
-	free(orig_line);
-	apol_vector_destroy(&tokens);
-	if (retval < 0) {
-		errno = error;
-		return -1;
+/**
+ * Parse every line within a buffer, in place.  The buffer need not
+ * end with a newline, nor need it be nul-terminated.
+ *
+ * @return 0 on success, > 0 on warnings, < 0 on error.
+ */
+static int parse_lines(seaudit_log_t * log, const char *buffer, size_t bufsize)
+{
+	const char *s = buffer, *end = buffer + bufsize, *eol;
+	int retval, has_warnings = 0;
+
+	while (s < end) {
+		if ((eol = memchr(s, '\n', end - s)) == NULL) {
+			eol = end;
+		}
+		if ((retval = seaudit_log_parse_line(log, s, eol - s)) < 0) {
+			return -1;
+		} else if (retval > 0) {
+			has_warnings = 1;
+		}
+		s = eol + 1;
 	}
 	return has_warnings;
 }
 
-/******************** public functions below ********************/
+/******************** parallel parsing ********************/
+
+/* A large buffer is split at line boundaries into chunks, each of
+ * which is parsed by its own thread into a private log with its own
+ * string pools.  The private logs are then merged, in order, into
+ * the real log.  A worker cannot know if the preceding chunk ended
+ * in the middle of a multi-line boolean or policy load message; when
+ * that happens the start of its chunk is parsed again, serially,
+ * until the serial parser and the worker agree that they are between
+ * messages.  Everything the worker parsed before that point is
+ * discarded, so the messages are the same as from parsing the whole
+ * buffer serially.  Only the strings that the kept messages refer to
+ * are then interned into the real log's pools; strings that the
+ * worker found only within discarded lines never reach them. */
+
+/** chunks are never made smaller than this many bytes */
+#define PARSE_CHUNK_MIN_SIZE (256 * 1024)
+/** number of line boundaries per chunk at which the merge may
+ *  resynchronize with the worker; the first half are consecutive and
+ *  the rest progressively further apart, so that serially parsing up
+ *  to the next one never costs more than what was already parsed */
+#define PARSE_CHUNK_CHECKPOINTS 64
+/** number of bytes of a followed file read and parsed at a time */
+#define PARSE_READ_SIZE (4 * 1024 * 1024)
+
+/* indices into the arrays of string pools built by parse_get_pools() */
+#define PARSE_POOL_TYPES 0
+#define PARSE_POOL_CLASSES 1
+#define PARSE_POOL_ROLES 2
+#define PARSE_POOL_USERS 3
+#define PARSE_POOL_PERMS 4
+#define PARSE_POOL_HOSTS 5
+#define PARSE_POOL_BOOLS 6
+#define PARSE_POOL_MANAGERS 7
+#define PARSE_POOL_MLS_LVL 8
+#define PARSE_POOL_MLS_CLR 9
+#define PARSE_POOL_STRINGS 10
+#define PARSE_NUM_STRING_POOLS 11
+/* not a pool of strings, but mapped in the same way */
+#define PARSE_POOL_PERM_LISTS 11
+#define PARSE_NUM_POOLS 12
 
-int seaudit_log_parse(seaudit_log_t * log, FILE * syslog)
+/**
+ * A line boundary within a chunk at which its worker was not in the
+ * middle of a message.
+ */
+typedef struct parse_checkpoint
 {
-	FILE *audit_file = syslog;
-	char *line = NULL;
-	int retval = -1, retval2, has_warnings = 0, error = 0;
-	size_t line_size = 0, i;
+	/** offset of the following line from the start of the chunk */
+	size_t offset;
+	/** number of messages and malformed messages parsed so far */
+	size_t num_messages, num_malformed;
+} parse_checkpoint_t;
 
-	if (log == NULL || syslog == NULL) {
-		ERR(log, "%s", strerror(EINVAL));
-		error = EINVAL;
-		goto cleanup;
-	}
+/**
+ * An error or warning raised while parsing a chunk, held until the
+ * chunk is merged so that they are reported in log order.
+ */
+typedef struct parse_chunk_msg
+{
+	/** offset of the line that raised it */
+	size_t offset;
+	int level;
+	char *text;
+} parse_chunk_msg_t;
 
-	if (!log->tz_initialized) {
-		tzset();
-		log->tz_initialized = 1;
-	}
+typedef struct parse_chunk
+{
+	/** private log into which this chunk is parsed; its message
+	 *  vectors do not own their elements */
+	seaudit_log_t *log;
+	const char *start;
+	size_t size;
+	/** offset of the line currently being parsed */
+	size_t line_offset;
+	parse_checkpoint_t checkpoints[PARSE_CHUNK_CHECKPOINTS];
+	size_t num_checkpoints;
+	/** offset of the last line that had warnings, if has_warnings */
+	size_t last_warning;
+	int has_warnings;
+	/** vector of parse_chunk_msg_t */
+	apol_vector_t *msgs;
+	/** for each string pool, the private log's strings sorted by
+	 *  address */
+	apol_vector_t *pool_from[PARSE_NUM_POOLS];
+	/** for each string pool, the real log's copies of the strings
+	 *  in pool_from, or NULL for those not yet interned there */
+	void **pool_to[PARSE_NUM_POOLS];
+	/** non-zero once the private log's messages have been moved
+	 *  into the real log */
+	int merged;
+	pthread_t thread;
+	int error;
+} parse_chunk_t;
 
-	clearerr(audit_file);
+static void parse_get_pools(const seaudit_log_t * log, apol_bst_t ** pools)
+{
+	pools[PARSE_POOL_TYPES] = log->types;
+	pools[PARSE_POOL_CLASSES] = log->classes;
+	pools[PARSE_POOL_ROLES] = log->roles;
+	pools[PARSE_POOL_USERS] = log->users;
+	pools[PARSE_POOL_PERMS] = log->perms;
+	pools[PARSE_POOL_HOSTS] = log->hosts;
+	pools[PARSE_POOL_BOOLS] = log->bools;
+	pools[PARSE_POOL_MANAGERS] = log->managers;
+	pools[PARSE_POOL_MLS_LVL] = log->mls_lvl;
+	pools[PARSE_POOL_MLS_CLR] = log->mls_clr;
+	pools[PARSE_POOL_STRINGS] = log->strings;
+}
 
-	while (1) {
-		if (getline(&line, &line_size, audit_file) < 0) {
-			error = errno;
-			if (!feof(audit_file)) {
-				ERR(log, "%s", strerror(error));
-				goto cleanup;
-			}
-			break;
-		}
-		apol_str_trim(line);
-		retval2 = seaudit_log_parse_line(log, line);
-		if (retval2 < 0) {
-			error = errno;
-			goto cleanup;
-		} else if (retval2 > 0) {
-			has_warnings = 1;
-		}
+static void parse_chunk_msg_free(void *elem)
+{
+	parse_chunk_msg_t *m = elem;
+	if (m != NULL) {
+		free(m->text);
+		free(m);
 	}
+}
 
-	retval = 0;
-      cleanup:
-	free(line);
-	for (i = 0; i < apol_vector_get_size(log->models); i++) {
-		seaudit_model_t *m = apol_vector_get_element(log->models, i);
-		model_notify_log_changed(m, log);
+/**
+ * Callback for a chunk's private log, which records messages rather
+ * than reporting them.
+ */
+static void parse_chunk_handle(void *arg, const seaudit_log_t * log __attribute__ ((unused)), int level, const char *fmt,
+			       va_list va_args)
+{
+	parse_chunk_t *c = arg;
+	parse_chunk_msg_t *m;
+	char *s;
+	if ((m = calloc(1, sizeof(*m))) == NULL) {
+		return;
 	}
-	if (retval < 0) {
-		errno = error;
-		return -1;
+	if (vasprintf(&s, fmt, va_args) < 0) {
+		free(m);
+		return;
 	}
-	if (has_warnings) {
-		WARN(log, "%s", "Audit log was parsed, but there were one or more invalid message found within it.");
+	m->offset = c->line_offset;
+	m->level = level;
+	m->text = s;
+	if (apol_vector_append(c->msgs, m) < 0) {
+		parse_chunk_msg_free(m);
 	}
-	return has_warnings;
 }
 
-int seaudit_log_parse_buffer(seaudit_log_t * log, const char *buffer, const size_t bufsize)
+static int parse_chunk_init(parse_chunk_t * c, const seaudit_log_t * log, const char *start, size_t size)
 {
-	const char *s;
-	char *line = NULL, *l;
-	int retval = -1, retval2, has_warnings = 0, error = 0;
-	size_t offset = 0, line_size, i;
-
-	if (log == NULL || buffer == NULL) {
-		ERR(log, "%s", strerror(EINVAL));
-		error = EINVAL;
-		goto cleanup;
+	memset(c, 0, sizeof(*c));
+	c->start = start;
+	c->size = size;
+	if ((c->msgs = apol_vector_create(parse_chunk_msg_free)) == NULL ||
+	    (c->log = seaudit_log_create(parse_chunk_handle, c)) == NULL || seaudit_log_set_compact(c->log, log->compact) < 0) {
+		return -1;
+	}
+	/* the messages are destined for the real log, so they are
+	 * freed explicitly if they never get there */
+	apol_vector_destroy(&c->log->messages);
+	apol_vector_destroy(&c->log->malformed_msgs);
+	if ((c->log->messages = apol_vector_create(NULL)) == NULL || (c->log->malformed_msgs = apol_vector_create(NULL)) == NULL) {
+		return -1;
 	}
+	return 0;
+}
 
-	if (!log->tz_initialized) {
-		tzset();
-		log->tz_initialized = 1;
+static void parse_chunk_destroy(parse_chunk_t * c)
+{
+	size_t i;
+	if (c->log != NULL && !c->merged) {
+		for (i = 0; c->log->messages != NULL && i < apol_vector_get_size(c->log->messages); i++) {
+			if (c->log->compact) {
+				message_free_compact(apol_vector_get_element(c->log->messages, i));
+			} else {
+				message_free(apol_vector_get_element(c->log->messages, i));
+			}
+		}
+		for (i = 0; c->log->malformed_msgs != NULL && i < apol_vector_get_size(c->log->malformed_msgs); i++) {
+			free(apol_vector_get_element(c->log->malformed_msgs, i));
+		}
+	}
+	seaudit_log_destroy(&c->log);
+	for (i = 0; i < PARSE_NUM_POOLS; i++) {
+		apol_vector_destroy(&c->pool_from[i]);
+		free(c->pool_to[i]);
 	}
+	apol_vector_destroy(&c->msgs);
+}
 
-	while (offset < bufsize) {
-		/* create a new string up to the first newline or end of
-		 * buffer, whichever comes first */
-		for (s = buffer + offset; s < buffer + bufsize && *s != '\n'; s++) ;
-		line_size = s - (buffer + offset);
-		assert(line_size > 0);
-		if ((l = realloc(line, line_size + 1)) == NULL) {
-			error = errno;
-			ERR(log, "%s", strerror(error));
-			goto cleanup;
+/**
+ * Sort a chunk's private pools by address, and allocate the
+ * (initially empty) maps into the real log's pools that
+ * parse_pool_map() fills in.  This only reads the real log, so
+ * workers may do it concurrently.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+static int parse_chunk_sort_pools(parse_chunk_t * c)
+{
+	apol_bst_t *from[PARSE_NUM_STRING_POOLS];
+	size_t i;
+
+	parse_get_pools(c->log, from);
+	for (i = 0; i < PARSE_NUM_POOLS; i++) {
+		if (i == PARSE_POOL_PERM_LISTS) {
+			if (!c->log->compact) {
+				continue;
+			}
+			c->pool_from[i] = apol_bst_get_vector(c->log->perm_lists, 0);
+		} else {
+			c->pool_from[i] = apol_bst_get_vector(from[i], 0);
 		}
-		line = l;
-		memcpy(line, buffer + offset, line_size);
-		line[line_size] = '\0';
-		offset += line_size;
-		if (s < buffer + bufsize) {
-			/* this branch can only be true if not at end of file */
-			assert(*s == '\n');
-			offset++;
-		}
-		apol_str_trim(line);
-		retval2 = seaudit_log_parse_line(log, line);
-		if (retval2 < 0) {
-			error = errno;
-			goto cleanup;
-		} else if (retval2 > 0) {
-			has_warnings = 1;
+		if (c->pool_from[i] == NULL ||
+		    (c->pool_to[i] = calloc(apol_vector_get_size(c->pool_from[i]) + 1, sizeof(*c->pool_to[i]))) == NULL) {
+			return -1;
 		}
+		apol_vector_sort(c->pool_from[i], NULL, NULL);
 	}
+	return 0;
+}
 
-	retval = 0;
-      cleanup:
-	free(line);
-	for (i = 0; i < apol_vector_get_size(log->models); i++) {
-		seaudit_model_t *m = apol_vector_get_element(log->models, i);
-		model_notify_log_changed(m, log);
+/**
+ * Parse all of a chunk's lines into its private log, remembering
+ * some of the line boundaries at which the parser is between
+ * messages, then sort the private log's pools for the merge.
+ */
+static void *parse_chunk_parse(void *arg)
+{
+	parse_chunk_t *c = arg;
+	const char *s = c->start, *end = c->start + c->size, *eol;
+	parse_checkpoint_t *cp;
+	size_t num_lines = 0, spacing = 1;
+	int retval;
+
+	c->num_checkpoints = 1;	       /* the start of the chunk */
+	while (s < end) {
+		if ((eol = memchr(s, '\n', end - s)) == NULL) {
+			eol = end;
+		}
+		c->line_offset = s - c->start;
+		if ((retval = seaudit_log_parse_line(c->log, s, eol - s)) < 0) {
+			c->error = errno;
+			return NULL;
+		} else if (retval > 0) {
+			c->has_warnings = 1;
+			c->last_warning = c->line_offset;
+		}
+		s = (eol < end ? eol + 1 : end);
+		num_lines++;
+		if (!c->log->next_line && c->num_checkpoints < PARSE_CHUNK_CHECKPOINTS && num_lines >= spacing) {
+			cp = c->checkpoints + c->num_checkpoints++;
+			cp->offset = s - c->start;
+			cp->num_messages = apol_vector_get_size(c->log->messages);
+			cp->num_malformed = apol_vector_get_size(c->log->malformed_msgs);
+			num_lines = 0;
+			if (c->num_checkpoints >= PARSE_CHUNK_CHECKPOINTS / 2) {
+				spacing *= 2;
+			}
+		}
 	}
-	if (retval < 0) {
-		errno = error;
-		return -1;
+	if (parse_chunk_sort_pools(c) < 0) {
+		c->error = errno;
+		ERR(c->log, "%s", strerror(c->error));
 	}
-	if (has_warnings) {
-		WARN(log, "%s", "Audit log was parsed, but there were one or more invalid message found within it.");
+	return NULL;
+}
+
+/**
+ * Find the real log's copy of a string (or, for the
+ * PARSE_POOL_PERM_LISTS pool, of a permission list) from a chunk's
+ * private pool, interning it into the real log the first time that
+ * it is needed.  Interning only upon demand means that strings used
+ * solely by messages that the merge discards never reach the real
+ * log's pools.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+static int parse_pool_map(seaudit_log_t * log, parse_chunk_t * c, size_t pool, const void *s, void **result)
+{
+	apol_bst_t *to[PARSE_NUM_STRING_POOLS];
+	apol_vector_t *list, *perms = NULL;
+	void *perm;
+	char *str;
+	size_t i, j;
+	int retval;
+
+	*result = NULL;
+	if (s == NULL) {
+		return 0;
 	}
-	return has_warnings;
+	if (apol_vector_get_index_sorted(c->pool_from[pool], s, NULL, NULL, &i) < 0) {
+		/* should never get here */
+		assert(0);
+		errno = ENOENT;
+		return -1;
+	}
+	if (c->pool_to[pool][i] == NULL) {
+		if (pool == PARSE_POOL_PERM_LISTS) {
+			/* translate the list into the real log's
+			 * strings, then find the real log's copy */
+			list = apol_vector_get_element(c->pool_from[pool], i);
+			if ((perms = apol_vector_create_with_capacity(apol_vector_get_size(list), NULL)) == NULL) {
+				return -1;
+			}
+			for (j = 0; j < apol_vector_get_size(list); j++) {
+				if (parse_pool_map(log, c, PARSE_POOL_PERMS, apol_vector_get_element(list, j), &perm) < 0 ||
+				    apol_vector_append(perms, perm) < 0) {
+					apol_vector_destroy(&perms);
+					return -1;
+				}
+			}
+			retval = log_intern_perms(log, perms, &list);
+			apol_vector_destroy(&perms);
+			if (retval < 0) {
+				return -1;
+			}
+			c->pool_to[pool][i] = list;
+		} else {
+			parse_get_pools(log, to);
+			if (parse_intern(to[pool], s, &str) < 0) {
+				return -1;
+			}
+			c->pool_to[pool][i] = str;
+		}
+	}
+	*result = c->pool_to[pool][i];
+	return 0;
+}
+
+/**
+ * Point a string field of a chunk's message at the real log's copy.
+ */
+#define PARSE_REMAP(pool, field) \
+	do { \
+		void *remapped_; \
+		if (parse_pool_map(log, c, (pool), (field), &remapped_) < 0) { \
+			return -1; \
+		} \
+		(field) = remapped_; \
+	} while (0)
+
+/**
+ * Point all of the strings within some of a chunk's messages at the
+ * real log's copies, interning those strings as necessary.
+ *
+ * @param log Real log into which the messages will be moved.
+ * @param c Chunk whose messages to remap.
+ * @param first Index of the first of the chunk's messages to remap;
+ * the messages before it are about to be discarded.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+static int parse_chunk_remap(seaudit_log_t * log, parse_chunk_t * c, size_t first)
+{
+	seaudit_message_t *msg;
+	seaudit_avc_message_t *avc;
+	seaudit_bool_message_change_t *bc;
+	apol_vector_t *perms;
+	void *perm;
+	size_t i, j;
+
+	for (i = first; i < apol_vector_get_size(c->log->messages); i++) {
+		msg = apol_vector_get_element(c->log->messages, i);
+		PARSE_REMAP(PARSE_POOL_HOSTS, msg->host);
+		PARSE_REMAP(PARSE_POOL_MANAGERS, msg->manager);
+		switch (msg->type) {
+		case SEAUDIT_MESSAGE_TYPE_AVC:
+			avc = msg->data.avc;
+			PARSE_REMAP(PARSE_POOL_USERS, avc->suser);
+			PARSE_REMAP(PARSE_POOL_ROLES, avc->srole);
+			PARSE_REMAP(PARSE_POOL_TYPES, avc->stype);
+			PARSE_REMAP(PARSE_POOL_MLS_LVL, avc->smls_lvl);
+			PARSE_REMAP(PARSE_POOL_MLS_CLR, avc->smls_clr);
+			PARSE_REMAP(PARSE_POOL_USERS, avc->tuser);
+			PARSE_REMAP(PARSE_POOL_ROLES, avc->trole);
+			PARSE_REMAP(PARSE_POOL_TYPES, avc->ttype);
+			PARSE_REMAP(PARSE_POOL_MLS_LVL, avc->tmls_lvl);
+			PARSE_REMAP(PARSE_POOL_MLS_CLR, avc->tmls_clr);
+			PARSE_REMAP(PARSE_POOL_CLASSES, avc->tclass);
+			if (c->log->compact) {
+				PARSE_REMAP(PARSE_POOL_STRINGS, avc->exe);
+				PARSE_REMAP(PARSE_POOL_STRINGS, avc->comm);
+				PARSE_REMAP(PARSE_POOL_STRINGS, avc->path);
+				PARSE_REMAP(PARSE_POOL_STRINGS, avc->dev);
+				PARSE_REMAP(PARSE_POOL_STRINGS, avc->netif);
+				PARSE_REMAP(PARSE_POOL_STRINGS, avc->laddr);
+				PARSE_REMAP(PARSE_POOL_STRINGS, avc->faddr);
+				PARSE_REMAP(PARSE_POOL_STRINGS, avc->saddr);
+				PARSE_REMAP(PARSE_POOL_STRINGS, avc->daddr);
+				PARSE_REMAP(PARSE_POOL_STRINGS, avc->name);
+				PARSE_REMAP(PARSE_POOL_STRINGS, avc->ipaddr);
+				PARSE_REMAP(PARSE_POOL_PERM_LISTS, avc->perms);
+			} else if (apol_vector_get_size(avc->perms) > 0) {
+				if ((perms = apol_vector_create_with_capacity(apol_vector_get_size(avc->perms), NULL)) == NULL) {
+					return -1;
+				}
+				for (j = 0; j < apol_vector_get_size(avc->perms); j++) {
+					if (parse_pool_map(log, c, PARSE_POOL_PERMS, apol_vector_get_element(avc->perms, j), &perm) < 0 ||
+					    apol_vector_append(perms, perm) < 0) {
+						apol_vector_destroy(&perms);
+						return -1;
+					}
+				}
+				apol_vector_destroy(&avc->perms);
+				avc->perms = perms;
+			}
+			break;
+		case SEAUDIT_MESSAGE_TYPE_BOOL:
+			for (j = 0; j < apol_vector_get_size(msg->data.boolm->changes); j++) {
+				bc = apol_vector_get_element(msg->data.boolm->changes, j);
+				PARSE_REMAP(PARSE_POOL_BOOLS, bc->boolean);
+			}
+			break;
+		default:
+			break;
+		}
+	}
+	return 0;
+}
+
+#undef PARSE_REMAP
+
+/**
+ * Move a chunk's messages into the real log.  If the log is in the
+ * middle of a message then first parse the chunk's leading lines
+ * serially, until reaching a line boundary at which the chunk's
+ * worker was also between messages; if there is no such boundary
+ * then parse the entire chunk serially.  Only the strings of the
+ * messages that are kept are interned into the real log.
+ *
+ * @return 0 on success, > 0 on warnings, < 0 on error.
+ */
+static int parse_chunk_merge(seaudit_log_t * log, parse_chunk_t * c)
+{
+	const char *s = c->start, *end = c->start + c->size, *eol;
+	const parse_checkpoint_t *cp = c->checkpoints;
+	size_t pos = 0, num_cp = 1, num_messages, num_malformed, i;
+	int retval, has_warnings = 0, error;
+
+	if (log->next_line) {
+		cp = NULL;
+		while (s < end) {
+			if ((eol = memchr(s, '\n', end - s)) == NULL) {
+				eol = end;
+			}
+			if ((retval = seaudit_log_parse_line(log, s, eol - s)) < 0) {
+				return -1;
+			} else if (retval > 0) {
+				has_warnings = 1;
+			}
+			s = (eol < end ? eol + 1 : end);
+			pos = s - c->start;
+			if (!log->next_line) {
+				while (num_cp < c->num_checkpoints && c->checkpoints[num_cp].offset < pos) {
+					num_cp++;
+				}
+				if (num_cp < c->num_checkpoints && c->checkpoints[num_cp].offset == pos) {
+					cp = c->checkpoints + num_cp;
+					break;
+				}
+			}
+		}
+	}
+
+	num_messages = apol_vector_get_size(c->log->messages);
+	num_malformed = apol_vector_get_size(c->log->malformed_msgs);
+	if (cp != NULL) {
+		if (parse_chunk_remap(log, c, cp->num_messages) < 0 ||
+		    apol_vector_reserve(log->messages, apol_vector_get_size(log->messages) + num_messages - cp->num_messages) < 0 ||
+		    apol_vector_reserve(log->malformed_msgs,
+					apol_vector_get_size(log->malformed_msgs) + num_malformed - cp->num_malformed) < 0 ||
+		    apol_vector_reserve(log->slabs, apol_vector_get_size(log->slabs) + apol_vector_get_size(c->log->slabs)) < 0) {
+			error = errno;
+			ERR(log, "%s", strerror(error));
+			errno = error;
+			return -1;
+		}
+	}
+	/* having reserved space, the rest cannot fail */
+	for (i = 0; i < num_messages; i++) {
+		seaudit_message_t *msg = apol_vector_get_element(c->log->messages, i);
+		if (cp == NULL || i < cp->num_messages) {
+			if (c->log->compact) {
+				message_free_compact(msg);
+			} else {
+				message_free(msg);
+			}
+		} else {
+			apol_vector_append(log->messages, msg);
+		}
+	}
+	for (i = 0; i < num_malformed; i++) {
+		char *line = apol_vector_get_element(c->log->malformed_msgs, i);
+		if (cp == NULL || i < cp->num_malformed) {
+			free(line);
+		} else {
+			apol_vector_append(log->malformed_msgs, line);
+		}
+	}
+	c->merged = 1;
+	if (cp != NULL && apol_vector_get_size(c->log->slabs) > 0) {
+		/* the moved messages live within the chunk's blocks */
+		for (i = 0; i < apol_vector_get_size(c->log->slabs); i++) {
+			apol_vector_append(log->slabs, apol_vector_get_element(c->log->slabs, i));
+		}
+		while (apol_vector_get_size(c->log->slabs) > 0) {
+			apol_vector_remove(c->log->slabs, apol_vector_get_size(c->log->slabs) - 1);
+		}
+		log->slab_used = c->log->slab_used;
+	}
+	if (cp != NULL) {
+		for (i = 0; i < apol_vector_get_size(c->msgs); i++) {
+			parse_chunk_msg_t *m = apol_vector_get_element(c->msgs, i);
+			if (m->offset >= cp->offset) {
+				seaudit_handle_msg(log, m->level, "%s", m->text);
+			}
+		}
+		if (c->has_warnings && c->last_warning >= cp->offset) {
+			has_warnings = 1;
+		}
+		log->next_line = c->log->next_line;
+		if (c->log->logtype == SEAUDIT_LOG_TYPE_AUDITD) {
+			log->logtype = SEAUDIT_LOG_TYPE_AUDITD;
+		}
+	}
+	return has_warnings;
+}
+
+/**
+ * Run a function upon every chunk, one thread per chunk.
+ *
+ * @return 0 on success, < 0 if a thread could not be started.
+ */
+static int parse_chunks_run(seaudit_log_t * log, parse_chunk_t * chunks, size_t num_chunks, void *(*fn) (void *))
+{
+	size_t i, num_started = 0;
+	int error = 0;
+
+	/* the calling thread does the first chunk itself */
+	for (i = 1; i < num_chunks; i++) {
+		if ((error = pthread_create(&chunks[i].thread, NULL, fn, chunks + i)) != 0) {
+			ERR(log, "%s", strerror(error));
+			break;
+		}
+		num_started++;
+	}
+	if (error == 0) {
+		fn(chunks);
+	}
+	for (i = 1; i <= num_started; i++) {
+		pthread_join(chunks[i].thread, NULL);
+	}
+	if (error) {
+		errno = error;
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Parse every line within a buffer, in place, dividing the buffer
+ * among up to num_threads threads.  The log's messages end up
+ * exactly as if parse_lines() had been called.
+ *
+ * @return 0 on success, > 0 on warnings, < 0 on error.
+ */
+static int parse_lines_parallel(seaudit_log_t * log, const char *buffer, size_t bufsize, unsigned int num_threads)
+{
+	parse_chunk_t *chunks = NULL;
+	const char *s = buffer, *end = buffer + bufsize, *eol;
+	size_t num_chunks = 0, chunk_size, i;
+	int retval = -1, retval2, has_warnings = 0, error = 0;
+
+	if (num_threads == 0) {
+		long n = sysconf(_SC_NPROCESSORS_ONLN);
+		num_threads = (n > 0 ? (unsigned int)n : 1);
+	}
+	if (num_threads > bufsize / PARSE_CHUNK_MIN_SIZE) {
+		num_threads = bufsize / PARSE_CHUNK_MIN_SIZE;
+	}
+	if (num_threads <= 1) {
+		return parse_lines(log, buffer, bufsize);
+	}
+
+	if ((chunks = calloc(num_threads, sizeof(*chunks))) == NULL) {
+		error = errno;
+		ERR(log, "%s", strerror(error));
+		goto cleanup;
+	}
+	chunk_size = bufsize / num_threads;
+	while (s < end && num_chunks < num_threads) {
+		/* end each chunk just after a newline */
+		eol = (num_chunks + 1 < num_threads && (size_t)(end - s) > chunk_size ? s + chunk_size - 1 : end - 1);
+		if ((eol = memchr(eol, '\n', end - eol)) == NULL) {
+			eol = end - 1;
+		}
+		if (parse_chunk_init(chunks + num_chunks, log, s, eol + 1 - s) < 0) {
+			error = errno;
+			ERR(log, "%s", strerror(error));
+			num_chunks++;
+			goto cleanup;
+		}
+		num_chunks++;
+		s = eol + 1;
+	}
+
+	if (parse_chunks_run(log, chunks, num_chunks, parse_chunk_parse) < 0) {
+		error = errno;
+		goto cleanup;
+	}
+	for (i = 0; i < num_chunks; i++) {
+		if (chunks[i].error) {
+			/* report whatever the failed worker reported */
+			for (size_t j = 0; j < apol_vector_get_size(chunks[i].msgs); j++) {
+				parse_chunk_msg_t *m = apol_vector_get_element(chunks[i].msgs, j);
+				seaudit_handle_msg(log, m->level, "%s", m->text);
+			}
+			error = chunks[i].error;
+			goto cleanup;
+		}
+	}
+
+	for (i = 0; i < num_chunks; i++) {
+		if ((retval2 = parse_chunk_merge(log, chunks + i)) < 0) {
+			error = errno;
+			goto cleanup;
+		} else if (retval2 > 0) {
+			has_warnings = 1;
+		}
+	}
+	retval = has_warnings;
+      cleanup:
+	for (i = 0; i < num_chunks; i++) {
+		parse_chunk_destroy(chunks + i);
+	}
+	free(chunks);
+	if (retval < 0) {
+		errno = error;
+	}
+	return retval;
+}
+
+/**
+ * Record how many messages and malformed messages a log holds before
+ * a parse, so that its models may later be told which are new.  A
+ * line that continues the last message could still modify that
+ * message, so it is counted as new.
+ */
+static void parse_get_marks(const seaudit_log_t * log, size_t * first_message, size_t * first_malformed)
+{
+	*first_message = apol_vector_get_size(log->messages);
+	if (log->next_line && *first_message > 0) {
+		(*first_message)--;
+	}
+	*first_malformed = apol_vector_get_size(log->malformed_msgs);
+}
+
+/**
+ * Notify all models watching the log that messages starting at
+ * first_message, and malformed messages starting at first_malformed,
+ * have been appended to it.
+ */
+static void parse_notify_models(seaudit_log_t * log, size_t first_message, size_t first_malformed)
+{
+	size_t i;
+	for (i = 0; i < apol_vector_get_size(log->models); i++) {
+		seaudit_model_t *m = apol_vector_get_element(log->models, i);
+		model_notify_log_appended(m, log, first_message, first_malformed);
+	}
+}
+
+int parse_buffer_quietly(seaudit_log_t * log, const char *buffer, size_t bufsize, unsigned int num_threads)
+{
+	int retval, error = 0;
+	size_t first_message, first_malformed;
+
+	if (log == NULL || buffer == NULL) {
+		ERR(log, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (!log->tz_initialized) {
+		tzset();
+		log->tz_initialized = 1;
+	}
+
+	parse_get_marks(log, &first_message, &first_malformed);
+	if ((retval = parse_lines_parallel(log, buffer, bufsize, num_threads)) < 0) {
+		error = errno;
+	}
+	parse_notify_models(log, first_message, first_malformed);
+	if (retval < 0) {
+		errno = error;
+		return -1;
+	}
+	return retval;
+}
+
+/**
+ * Parse a buffer, notifying the log's models afterwards.
+ */
+static int parse_buffer(seaudit_log_t * log, const char *buffer, size_t bufsize, unsigned int num_threads)
+{
+	int retval = parse_buffer_quietly(log, buffer, bufsize, num_threads);
+	if (retval > 0) {
+		WARN(log, "%s", "Audit log was parsed, but there were one or more invalid message found within it.");
+	}
+	return retval;
+}
+
+/**
+ * Memory-map the bytes of an open file from start up to end, and
+ * parse them.  If whole_lines is non-zero then a trailing partial
+ * line (one not yet terminated by a newline) is left unparsed.  This
+ * neither notifies the log's models nor warns about invalid
+ * messages.
+ *
+ * @param log Log to which append messages.
+ * @param fd Descriptor of a regular file.
+ * @param start Offset of the first byte to parse.
+ * @param end Offset just past the last byte to parse.
+ * @param whole_lines If non-zero, parse only complete lines.
+ * @param num_threads Maximum number of threads to use.
+ * @param next Reference to the offset just past the last byte
+ * parsed; upon error this is left unchanged.
+ *
+ * @return 0 on success, > 0 on warnings, < 0 on error.  If the range
+ * could not be mapped then return -2 with errno set, without having
+ * parsed or reported anything.
+ */
+static int parse_mapped_range(seaudit_log_t * log, int fd, off_t start, off_t end, int whole_lines, unsigned int num_threads,
+			      off_t * next)
+{
+	off_t map_start;
+	long page_size;
+	void *map;
+	const char *buf, *eol;
+	size_t len;
+	int retval;
+
+	if (start >= end) {
+		*next = start;
+		return 0;
+	}
+	if ((page_size = sysconf(_SC_PAGESIZE)) <= 0) {
+		return -2;
+	}
+	map_start = start - start % page_size;
+	if ((map = mmap(NULL, end - map_start, PROT_READ, MAP_PRIVATE, fd, map_start)) == MAP_FAILED) {
+		return -2;
+	}
+	madvise(map, end - map_start, (num_threads == 1 ? MADV_SEQUENTIAL : MADV_WILLNEED));
+	buf = (const char *)map + (start - map_start);
+	len = end - start;
+	if (whole_lines) {
+		if ((eol = memrchr(buf, '\n', len)) == NULL) {
+			len = 0;
+		} else {
+			len = eol - buf + 1;
+		}
+	}
+	if ((retval = parse_lines_parallel(log, buf, len, num_threads)) >= 0) {
+		*next = start + len;
+	}
+	munmap(map, end - map_start);
+	return retval;
+}
+
+/**
+ * Read the bytes of an open file from start up to end, a block at a
+ * time, and parse them.  Unlike parse_mapped_range() this is safe
+ * for a file that is being written and might shrink (the read then
+ * simply stops early).  If whole_lines is non-zero then a trailing
+ * partial line is left unparsed.  This neither notifies the log's
+ * models nor warns about invalid messages.
+ *
+ * @param log Log to which append messages.
+ * @param fd Descriptor of a regular file.
+ * @param start Offset of the first byte to parse.
+ * @param end Offset just past the last byte to parse.
+ * @param whole_lines If non-zero, parse only complete lines.
+ * @param num_threads Maximum number of threads to use.
+ * @param next Reference to the offset just past the last byte
+ * parsed; it is advanced as each block is parsed, even if a later
+ * one fails.
+ *
+ * @return 0 on success, > 0 on warnings, < 0 on error.
+ */
+static int parse_read_range(seaudit_log_t * log, int fd, off_t start, off_t end, int whole_lines, unsigned int num_threads,
+			    off_t * next)
+{
+	char *buf = NULL, *tmp;
+	const char *eol;
+	size_t len = 0, cap = 0, want, parsed;
+	ssize_t n;
+	int retval = -1, retval2, has_warnings = 0, error = 0;
+
+	*next = start;
+	while (start + (off_t) len < end) {
+		want = end - start - len;
+		if (want > PARSE_READ_SIZE) {
+			want = PARSE_READ_SIZE;
+		}
+		if (len + want > cap) {
+			if ((tmp = realloc(buf, len + want)) == NULL) {
+				error = errno;
+				ERR(log, "%s", strerror(error));
+				goto cleanup;
+			}
+			buf = tmp;
+			cap = len + want;
+		}
+		if ((n = pread(fd, buf + len, want, start + len)) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			error = errno;
+			ERR(log, "%s", strerror(error));
+			goto cleanup;
+		}
+		if (n == 0) {
+			/* the file shrank since it was stat()ed */
+			break;
+		}
+		len += n;
+		/* parse the complete lines read so far, carrying any
+		 * partial line over to the next block */
+		if ((eol = memrchr(buf, '\n', len)) == NULL) {
+			continue;
+		}
+		parsed = eol - buf + 1;
+		if ((retval2 = parse_lines_parallel(log, buf, parsed, num_threads)) < 0) {
+			error = errno;
+			goto cleanup;
+		} else if (retval2 > 0) {
+			has_warnings = 1;
+		}
+		memmove(buf, buf + parsed, len - parsed);
+		len -= parsed;
+		start += parsed;
+		*next = start;
+	}
+	if (!whole_lines && len > 0) {
+		if ((retval2 = parse_lines_parallel(log, buf, len, num_threads)) < 0) {
+			error = errno;
+			goto cleanup;
+		} else if (retval2 > 0) {
+			has_warnings = 1;
+		}
+		*next = start + len;
+	}
+	retval = has_warnings;
+      cleanup:
+	free(buf);
+	if (retval < 0) {
+		errno = error;
+	}
+	return retval;
+}
+
+/**
+ * Parse the remainder of a file, memory-mapping it if possible, and
+ * notify the log's models afterwards.  Touching the map of a file
+ * that was truncated after the fstat() raises SIGBUS, so this is
+ * only for files that are not being truncated; see
+ * seaudit_log_parse_file().
+ */
+static int parse_file(seaudit_log_t * log, FILE * syslog, unsigned int num_threads)
+{
+	struct stat sb;
+	off_t start, next;
+	int fd, retval, error = 0;
+	size_t first_message, first_malformed;
+
+	if (log == NULL || syslog == NULL) {
+		ERR(log, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	/* pipes, terminals, and the like cannot be mapped, nor can a
+	 * file that has nothing left to read */
+	if ((fd = fileno(syslog)) < 0 || fstat(fd, &sb) < 0 || !S_ISREG(sb.st_mode) ||
+	    (start = ftello(syslog)) < 0 || sb.st_size <= start) {
+		return seaudit_log_parse(log, syslog);
+	}
+
+	if (!log->tz_initialized) {
+		tzset();
+		log->tz_initialized = 1;
+	}
+
+	parse_get_marks(log, &first_message, &first_malformed);
+	if ((retval = parse_mapped_range(log, fd, start, sb.st_size, 0, num_threads, &next)) == -2) {
+		return seaudit_log_parse(log, syslog);
+	}
+	if (retval < 0) {
+		error = errno;
+	}
+	/* leave the file positioned after what was parsed, so that a
+	 * later call can pick up anything appended to it */
+	else if (fseeko(syslog, next, SEEK_SET) < 0) {
+		error = errno;
+		ERR(log, "%s", strerror(error));
+		retval = -1;
+	}
+	parse_notify_models(log, first_message, first_malformed);
+	if (retval < 0) {
+		errno = error;
+		return -1;
+	}
+	if (retval > 0) {
+		WARN(log, "%s", "Audit log was parsed, but there were one or more invalid message found within it.");
+	}
+	return retval;
+}
+
+/**
+ * Parse the complete lines appended to the log's followed file since
+ * the last time it was parsed, then advance the followed offset.
+ * The caller notifies the log's models.
+ *
+ * @return 0 on success, > 0 on warnings, < 0 on error.
+ */
+static int parse_follow_file(seaudit_log_t * log, int whole_lines)
+{
+	struct stat sb;
+	int fd, error;
+
+	if ((fd = fileno(log->follow_file)) < 0 || fstat(fd, &sb) < 0) {
+		error = errno;
+		ERR(log, "%s", strerror(error));
+		errno = error;
+		return -1;
+	}
+	if (sb.st_size < log->follow_offset) {
+		/* the file was truncated in place (e.g., by logrotate's
+		 * copytruncate), so start again at its beginning */
+		log->follow_offset = 0;
+	}
+	/* the followed file is live and may be truncated at any
+	 * moment, so it is read rather than mapped */
+	return parse_read_range(log, fd, log->follow_offset, sb.st_size, whole_lines, 0, &log->follow_offset);
+}
+
+/**
+ * Begin following a file, replacing whatever file the log had been
+ * following.  Nothing is parsed yet.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+static int parse_follow_open(seaudit_log_t * log, const char *filename)
+{
+	struct stat sb;
+	FILE *f = NULL;
+	char *path = NULL;
+	int error;
+
+	if ((f = fopen(filename, "r")) == NULL || fstat(fileno(f), &sb) < 0) {
+		error = errno;
+		ERR(log, "Could not open %s: %s", filename, strerror(error));
+		goto err;
+	}
+	if (!S_ISREG(sb.st_mode)) {
+		error = EINVAL;
+		ERR(log, "%s is not a regular file.", filename);
+		goto err;
+	}
+	if (filename != log->follow_path && (path = strdup(filename)) == NULL) {
+		error = errno;
+		ERR(log, "%s", strerror(error));
+		goto err;
+	}
+	if (log->follow_file != NULL) {
+		fclose(log->follow_file);
+	}
+	if (path != NULL) {
+		free(log->follow_path);
+		log->follow_path = path;
+	}
+	log->follow_file = f;
+	log->follow_dev = sb.st_dev;
+	log->follow_ino = sb.st_ino;
+	log->follow_offset = 0;
+	return 0;
+      err:
+	if (f != NULL) {
+		fclose(f);
+	}
+	free(path);
+	errno = error;
+	return -1;
+}
+
+/******************** public functions below ********************/
+
+int seaudit_log_parse(seaudit_log_t * log, FILE * syslog)
+{
+	FILE *audit_file = syslog;
+	char *line = NULL;
+	int retval = -1, retval2, has_warnings = 0, error = 0;
+	size_t line_size = 0, first_message = 0, first_malformed = 0;
+
+	if (log == NULL || syslog == NULL) {
+		ERR(log, "%s", strerror(EINVAL));
+		error = EINVAL;
+		goto cleanup;
+	}
+
+	if (!log->tz_initialized) {
+		tzset();
+		log->tz_initialized = 1;
+	}
+
+	parse_get_marks(log, &first_message, &first_malformed);
+	clearerr(audit_file);
+
+	while (1) {
+		if (getline(&line, &line_size, audit_file) < 0) {
+			error = errno;
+			if (!feof(audit_file)) {
+				ERR(log, "%s", strerror(error));
+				goto cleanup;
+			}
+			break;
+		}
+		retval2 = seaudit_log_parse_line(log, line, strlen(line));
+		if (retval2 < 0) {
+			error = errno;
+			goto cleanup;
+		} else if (retval2 > 0) {
+			has_warnings = 1;
+		}
+	}
+
+	retval = 0;
+      cleanup:
+	free(line);
+	if (log != NULL) {
+		parse_notify_models(log, first_message, first_malformed);
+	}
+	if (retval < 0) {
+		errno = error;
+		return -1;
+	}
+	if (has_warnings) {
+		WARN(log, "%s", "Audit log was parsed, but there were one or more invalid message found within it.");
+	}
+	return has_warnings;
+}
+
+int seaudit_log_parse_buffer(seaudit_log_t * log, const char *buffer, const size_t bufsize)
+{
+	return parse_buffer(log, buffer, bufsize, 1);
+}
+
+int seaudit_log_parse_buffer_parallel(seaudit_log_t * log, const char *buffer, const size_t bufsize, unsigned int num_threads)
+{
+	return parse_buffer(log, buffer, bufsize, num_threads);
+}
+
+int seaudit_log_parse_file(seaudit_log_t * log, FILE * syslog)
+{
+	return parse_file(log, syslog, 1);
+}
+
+int seaudit_log_parse_file_parallel(seaudit_log_t * log, FILE * syslog, unsigned int num_threads)
+{
+	return parse_file(log, syslog, num_threads);
+}
+
+int seaudit_log_follow(seaudit_log_t * log, const char *filename)
+{
+	if (log == NULL || filename == NULL) {
+		ERR(log, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	return parse_follow_open(log, filename);
+}
+
+int seaudit_log_follow_update(seaudit_log_t * log)
+{
+	struct stat sb;
+	int retval, has_warnings = 0, error = 0;
+	size_t first_message, first_malformed;
+
+	if (log == NULL || log->follow_file == NULL) {
+		ERR(log, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (!log->tz_initialized) {
+		tzset();
+		log->tz_initialized = 1;
+	}
+
+	parse_get_marks(log, &first_message, &first_malformed);
+	if (stat(log->follow_path, &sb) == 0 && (sb.st_dev != log->follow_dev || sb.st_ino != log->follow_ino)) {
+		/* the log was rotated; the old file will no longer be
+		 * written to, so finish it (including any unterminated
+		 * last line) before switching to the new one */
+		if ((retval = parse_follow_file(log, 0)) < 0) {
+			error = errno;
+			goto cleanup;
+		}
+		has_warnings = retval;
+		if (parse_follow_open(log, log->follow_path) < 0) {
+			error = errno;
+			retval = -1;
+			goto cleanup;
+		}
+	}
+	/* if the path does not exist then the log was rotated but not
+	 * yet recreated; keep reading the old file until it is */
+	if ((retval = parse_follow_file(log, 1)) < 0) {
+		error = errno;
+		goto cleanup;
+	}
+	if (retval > 0) {
+		has_warnings = 1;
+	}
+	retval = has_warnings;
+      cleanup:
+	parse_notify_models(log, first_message, first_malformed);
+	if (retval < 0) {
+		errno = error;
+		return -1;
+	}
+	if (retval > 0) {
+		WARN(log, "%s", "Audit log was parsed, but there were one or more invalid message found within it.");
+	}
+	return retval;
 }
@@ -39,6 +39,10 @@
 #define CONFIG_FILE "seaudit-report.conf"
 #define STYLESHEET_FILE "seaudit-report.css"
 #define LINE_MAX 1024
+#define REPORT_STREAM_BLOCK_SIZE (16 * 1024 * 1024)
+/** number of consecutive blocks that a multi-line message may span
+ *  before it is ended early, bounding how much of the log is held */
+#define REPORT_STREAM_MAX_PENDING 4
 
 struct seaudit_report
 {
@@ -74,6 +78,63 @@ static const char *seaudit_standard_section_names[] = {
 	NULL
 };
 
+/**
+ * Kinds of sections within a streamed report.  Standard sections
+ * share the index of their name within
+ * seaudit_standard_section_names.
+ */
+typedef enum report_stream_kind
+{
+	REPORT_STREAM_LOADS = 0,
+	REPORT_STREAM_TOGGLES,
+	REPORT_STREAM_BOOLS,
+	REPORT_STREAM_STATS,
+	REPORT_STREAM_ALLOWS,
+	REPORT_STREAM_DENIES,
+	REPORT_STREAM_VIEW
+} report_stream_kind_e;
+
+/**
+ * What has been gathered so far for one section of a streamed
+ * report.
+ */
+typedef struct report_stream_section
+{
+	report_stream_kind_e kind;
+	/** model selecting the section's messages, owned by the stream */
+	seaudit_model_t *model;
+	/** number of messages listed, or for statistics the total
+	 *  number of messages */
+	size_t num_messages;
+	/** for statistics, the number of each type of message */
+	size_t num_loads, num_bools, num_allows, num_denies;
+	/** the section's rendered messages, or NULL for statistics */
+	FILE *spool;
+} report_stream_section_t;
+
+/**
+ * State of a report whose messages are read a block at a time.  Every
+ * section named by the configuration file is gathered during a single
+ * pass over the logs, then printed afterwards.
+ */
+typedef struct report_stream
+{
+	/** vector of report_stream_section_t, in configuration order */
+	apol_vector_t *sections;
+	/** vector of seaudit_model_t, one for each distinct selection
+	 *  of messages */
+	apol_vector_t *models;
+	/** model shared by the standard sections that add no filters
+	 *  of their own, or NULL if there are none */
+	seaudit_model_t *base;
+	/** rendered malformed messages, or NULL if not printing them */
+	FILE *malformed;
+	/** index of the next section to be printed */
+	size_t next;
+	/** non-zero if any invalid messages were found */
+	int has_warnings;
+} report_stream_t;
+
 seaudit_report_t *seaudit_report_create(seaudit_model_t * model)
 {
 	seaudit_report_t *r = calloc(1, sizeof(*r));
@@ -663,38 +724,115 @@ static int report_print_avc_listing(const seaudit_log_t * log, const seaudit_rep
 	return 0;
 }
 
-static int report_print_stats(const seaudit_log_t * log, const seaudit_report_t * report, FILE * outfile)
+static int report_print_stats_counts(const seaudit_report_t * report, size_t num_messages, size_t num_loads, size_t num_bools,
+				     size_t num_allows, size_t num_denies, FILE * outfile)
 {
-	apol_vector_t *v = seaudit_model_get_messages(log, report->model);
-	size_t num_messages = apol_vector_get_size(v);
-	apol_vector_destroy(&v);
 	if (report->format == SEAUDIT_REPORT_FORMAT_HTML) {
 		fprintf(outfile,
 			"<font class=\"stats_label\">Number of total messages:</font> <b class=\"stats_count\">%zd</b><br>\n",
 			num_messages);
 		fprintf(outfile,
 			"<font class=\"stats_label\">Number of policy load messages:</font> <b class=\"stats_count\">%zd</b><br>\n",
-			seaudit_model_get_num_loads(log, report->model));
+			num_loads);
 		fprintf(outfile,
 			"<font class=\"stats_label\">Number of policy boolean messages:</font> <b class=\"stats_count\">%zd</b><br>\n",
-			seaudit_model_get_num_bools(log, report->model));
+			num_bools);
 		fprintf(outfile,
 			"<font class=\"stats_label\">Number of allow messages:</font> <b class=\"stats_count\">%zd</b><br>\n",
-			seaudit_model_get_num_allows(log, report->model));
+			num_allows);
 		fprintf(outfile,
 			"<font class=\"stats_label\">Number of denied messages:</font> <b class=\"stats_count\">%zd</b><br>\n",
-			seaudit_model_get_num_denies(log, report->model));
+			num_denies);
 	} else {
 		fprintf(outfile, "Number of total messages: %zd\n", num_messages);
-		fprintf(outfile, "Number of policy load messages: %zd\n", seaudit_model_get_num_loads(log, report->model));
-		fprintf(outfile, "Number of policy boolean messages: %zd\n", seaudit_model_get_num_bools(log, report->model));
-		fprintf(outfile, "Number of allow messages: %zd\n", seaudit_model_get_num_allows(log, report->model));
-		fprintf(outfile, "Number of denied messages: %zd\n", seaudit_model_get_num_denies(log, report->model));
+		fprintf(outfile, "Number of policy load messages: %zd\n", num_loads);
+		fprintf(outfile, "Number of policy boolean messages: %zd\n", num_bools);
+		fprintf(outfile, "Number of allow messages: %zd\n", num_allows);
+		fprintf(outfile, "Number of denied messages: %zd\n", num_denies);
 	}
 	return 0;
 }
 
-static int report_print_standard_section(const seaudit_log_t * log, const seaudit_report_t * report,
+static int report_print_stats(const seaudit_log_t * log, const seaudit_report_t * report, FILE * outfile)
+{
+	apol_vector_t *v = seaudit_model_get_messages(log, report->model);
+	size_t num_messages = apol_vector_get_size(v);
+	apol_vector_destroy(&v);
+	return report_print_stats_counts(report, num_messages, seaudit_model_get_num_loads(log, report->model),
+					 seaudit_model_get_num_bools(log, report->model),
+					 seaudit_model_get_num_allows(log, report->model),
+					 seaudit_model_get_num_denies(log, report->model), outfile);
+}
+
+/**
+ * Copy the contents of a spooled section to the output file.
+ */
+static int report_stream_copy(const seaudit_log_t * log, FILE * spool, FILE * outfile)
+{
+	char buf[BUFSIZ];
+	size_t n;
+	int error;
+
+	rewind(spool);
+	while ((n = fread(buf, 1, sizeof(buf), spool)) > 0) {
+		if (fwrite(buf, 1, n, outfile) < n) {
+			break;
+		}
+	}
+	if (ferror(spool) || ferror(outfile)) {
+		error = errno;
+		ERR(log, "%s", strerror(error));
+		errno = error;
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Print the next section gathered by a streamed report, which must be
+ * of the given kind.
+ */
+static int report_stream_print_section(const seaudit_log_t * log, const seaudit_report_t * report, report_stream_t * stream,
+				       report_stream_kind_e kind, FILE * outfile)
+{
+	report_stream_section_t *sec = NULL;
+
+	if (stream->next < apol_vector_get_size(stream->sections)) {
+		sec = apol_vector_get_element(stream->sections, stream->next);
+	}
+	if (sec == NULL || sec->kind != kind) {
+		ERR(log, "Configuration file %s changed while the report was being written.", report->config);
+		errno = EIO;
+		return -1;
+	}
+	stream->next++;
+	if (kind == REPORT_STREAM_STATS) {
+		return report_print_stats_counts(report, sec->num_messages, sec->num_loads, sec->num_bools, sec->num_allows,
+						 sec->num_denies, outfile);
+	}
+	if (report->format == SEAUDIT_REPORT_FORMAT_HTML)
+		fprintf(outfile,
+			"<font class=\"message_count_label\">Number of messages:</font> <b class=\"message_count\">%zd</b><br>\n<br>\n",
+			sec->num_messages);
+	else
+		fprintf(outfile, "Number of messages: %zd\n\n", sec->num_messages);
+	return report_stream_copy(log, sec->spool, outfile);
+}
+
+/**
+ * Return the index of a standard section's name, or -1 if it is not
+ * the name of a standard section.
+ */
+static int report_get_section_index(const char *name)
+{
+	int i;
+	for (i = 0; seaudit_standard_section_names[i] != NULL; i++)
+		if (strcmp(seaudit_standard_section_names[i], name) == 0)
+			return i;
+	return -1;
+}
+
+static int report_print_standard_section(const seaudit_log_t * log, const seaudit_report_t * report, report_stream_t * stream,
 					 xmlChar * id, xmlChar * title, FILE * outfile)
 {
 	size_t sz, len, i;
@@ -718,7 +856,9 @@ static int report_print_standard_section(const seaudit_log_t * log, const seaudi
 			fprintf(outfile, "\n");
 		}
 	}
-	if (strncasecmp((char *)id, "PolicyLoads", sz) == 0) {
+	if (stream != NULL) {
+		rt = report_stream_print_section(log, report, stream, report_get_section_index((char *)id), outfile);
+	} else if (strncasecmp((char *)id, "PolicyLoads", sz) == 0) {
 		rt = report_print_policy_loads(log, report, outfile);
 	} else if (strncasecmp((char *)id, "EnforcementToggles", sz) == 0) {
 		rt = report_print_enforce_toggles(log, report, outfile);
@@ -743,10 +883,10 @@ static int report_print_standard_section(const seaudit_log_t * log, const seaudi
 	return 0;
 }
 
-static int report_print_loaded_view(const seaudit_log_t * log, const seaudit_report_t * report, xmlChar * view_filePath,
-				    FILE * outfile)
+static int report_print_loaded_view(const seaudit_log_t * log, const seaudit_report_t * report, report_stream_t * stream,
+				    xmlChar * view_filePath, FILE * outfile)
 {
-	size_t i, filters_added = 0;
+	size_t i;
 	apol_vector_t *loaded_filters = NULL;
 	seaudit_model_t *dup_model = NULL;
 	seaudit_filter_t *filter;
@@ -755,6 +895,14 @@ static int report_print_loaded_view(const seaudit_log_t * log, const seaudit_rep
 	apol_vector_t *v = NULL;
 	int retval = -1, error = 0;
 
+	if (stream != NULL) {
+		if (report->format == SEAUDIT_REPORT_FORMAT_HTML) {
+			fprintf(outfile, "View file: %s<br>\n", view_filePath);
+		} else {
+			fprintf(outfile, "View file: %s\n", view_filePath);
+		}
+		return report_stream_print_section(log, report, stream, REPORT_STREAM_VIEW, outfile);
+	}
 	if ((loaded_filters = seaudit_filter_create_from_file((char *)view_filePath)) == NULL) {
 		error = errno;
 		ERR(log, "Error parsing file %s.", view_filePath);
@@ -765,10 +913,13 @@ static int report_print_loaded_view(const seaudit_log_t * log, const seaudit_rep
 		ERR(log, "%s", strerror(error));
 		goto cleanup;
 	}
-	for (i = 0; i < apol_vector_get_size(loaded_filters); i++, filters_added++) {
+	for (i = 0; i < apol_vector_get_size(loaded_filters); i++) {
+		/* the vector still owns the loaded filters, so give the
+		 * model copies of them */
 		filter = apol_vector_get_element(loaded_filters, i);
-		if (seaudit_model_append_filter(dup_model, filter) < 0) {
+		if ((filter = seaudit_filter_create_from_filter(filter)) == NULL || seaudit_model_append_filter(dup_model, filter) < 0) {
 			error = errno;
+			seaudit_filter_destroy(&filter);
 			ERR(log, "%s", strerror(error));
 			goto cleanup;
 		}
@@ -806,15 +957,7 @@ static int report_print_loaded_view(const seaudit_log_t * log, const seaudit_rep
 	}
 	retval = 0;
       cleanup:
-	/* only destroy filters that were not added to the model
-	 * (recall that model takes ownership of filters) */
-	if (loaded_filters != NULL) {
-		for (i = filters_added; i < apol_vector_get_size(loaded_filters); i++) {
-			filter = apol_vector_get_element(loaded_filters, i);
-			seaudit_filter_destroy(&filter);
-		}
-		apol_vector_destroy(&loaded_filters);
-	}
+	apol_vector_destroy(&loaded_filters);
 	seaudit_model_destroy(&dup_model);
 	apol_vector_destroy(&v);
 	if (error != 0) {
@@ -823,7 +966,7 @@ static int report_print_loaded_view(const seaudit_log_t * log, const seaudit_rep
 	return retval;
 }
 
-static int report_print_custom_section(const seaudit_log_t * log, const seaudit_report_t * report,
+static int report_print_custom_section(const seaudit_log_t * log, const seaudit_report_t * report, report_stream_t * stream,
 				       xmlTextReaderPtr reader, xmlChar * title, FILE * outfile)
 {
 	size_t len, i;
@@ -868,7 +1011,7 @@ static int report_print_custom_section(const seaudit_log_t * log, const seaudit_
 				ERR(log, "%s", "Error getting file attribute for view node.");
 				goto cleanup;
 			}
-			if (report_print_loaded_view(log, report, view_filePath, outfile) < 0) {
+			if (report_print_loaded_view(log, report, stream, view_filePath, outfile) < 0) {
 				error = errno;
 				goto cleanup;
 			}
@@ -905,8 +1048,8 @@ static int report_print_custom_section(const seaudit_log_t * log, const seaudit_
 	return retval;
 }
 
-static int report_process_xmlNode(const seaudit_log_t * log, const seaudit_report_t * report, xmlTextReaderPtr reader,
-				  FILE * outfile)
+static int report_process_xmlNode(const seaudit_log_t * log, const seaudit_report_t * report, report_stream_t * stream,
+				  xmlTextReaderPtr reader, FILE * outfile)
 {
 	xmlChar *name = NULL, *id_attr = NULL, *title_attr = NULL;
 	int retval = -1, error = 0;
@@ -943,7 +1086,7 @@ static int report_process_xmlNode(const seaudit_log_t * log, const seaudit_repor
 			goto cleanup;
 		}
 		/* NOTE: If a title wasn't provided, we still continue. */
-		if (report_print_standard_section(log, report, id_attr, title_attr, outfile) < 0) {
+		if (report_print_standard_section(log, report, stream, id_attr, title_attr, outfile) < 0) {
 			error = errno;
 			goto cleanup;
 		}
@@ -953,7 +1096,7 @@ static int report_process_xmlNode(const seaudit_log_t * log, const seaudit_repor
 			goto cleanup;
 		}
 		/* NOTE: If a title wasn't provided, we still continue. */
-		if (report_print_custom_section(log, report, reader, title_attr, outfile) < 0) {
+		if (report_print_custom_section(log, report, stream, reader, title_attr, outfile) < 0) {
 			error = errno;
 			goto cleanup;
 		}
@@ -970,11 +1113,12 @@ static int report_process_xmlNode(const seaudit_log_t * log, const seaudit_repor
 	return retval;
 }
 
-static int report_print_malformed(const seaudit_log_t * log, const seaudit_report_t * report, FILE * outfile)
+static int report_print_malformed(const seaudit_log_t * log, const seaudit_report_t * report, report_stream_t * stream,
+				  FILE * outfile)
 {
 	size_t i, len;
-	apol_vector_t *v = seaudit_model_get_malformed_messages(log, report->model);
-	if (v == NULL) {
+	apol_vector_t *v = NULL;
+	if (stream == NULL && (v = seaudit_model_get_malformed_messages(log, report->model)) == NULL) {
 		return -1;
 	}
 	if (report->format == SEAUDIT_REPORT_FORMAT_HTML) {
@@ -988,6 +1132,9 @@ static int report_print_malformed(const seaudit_log_t * log, const seaudit_repor
 		}
 		fprintf(outfile, "\n");
 	}
+	if (stream != NULL && report_stream_copy(log, stream->malformed, outfile) < 0) {
+		return -1;
+	}
 	for (i = 0; i < apol_vector_get_size(v); i++) {
 		char *malformed_msg;
 		malformed_msg = apol_vector_get_element(v, i);
@@ -1001,7 +1148,11 @@ static int report_print_malformed(const seaudit_log_t * log, const seaudit_repor
 	return 0;
 }
 
-int seaudit_report_write(const seaudit_log_t * log, const seaudit_report_t * report, const char *out_file)
+/**
+ * Write a report, taking the messages either from the report's model
+ * or, if stream is not NULL, from what was gathered while streaming.
+ */
+static int report_write(const seaudit_log_t * log, const seaudit_report_t * report, report_stream_t * stream, const char *out_file)
 {
 	xmlTextReaderPtr reader;
 	FILE *outfile = NULL;
@@ -1033,7 +1184,7 @@ int seaudit_report_write(const seaudit_log_t * log, const seaudit_report_t * rep
 	}
 	rt = xmlTextReaderRead(reader);
 	while (rt == 1) {
-		report_process_xmlNode(log, report, reader, outfile);
+		report_process_xmlNode(log, report, stream, reader, outfile);
 		rt = xmlTextReaderRead(reader);
 	}
 	error = errno;
@@ -1042,7 +1193,7 @@ int seaudit_report_write(const seaudit_log_t * log, const seaudit_report_t * rep
 		ERR(log, "Failed to parse config file %s.", report->config);
 		goto cleanup;
 	}
-	if (report->malformed && report_print_malformed(log, report, outfile) < 0) {
+	if (report->malformed && report_print_malformed(log, report, stream, outfile) < 0) {
 		error = errno;
 		goto cleanup;
 	}
@@ -1058,3 +1209,476 @@ int seaudit_report_write(const seaudit_log_t * log, const seaudit_report_t * rep
 	}
 	return retval;
 }
+
+int seaudit_report_write(const seaudit_log_t * log, const seaudit_report_t * report, const char *out_file)
+{
+	return report_write(log, report, NULL, out_file);
+}
+
+static void report_stream_section_free(void *elem)
+{
+	report_stream_section_t *sec = elem;
+	if (sec != NULL) {
+		if (sec->spool != NULL) {
+			fclose(sec->spool);
+		}
+		free(sec);
+	}
+}
+
+static void report_stream_model_free(void *elem)
+{
+	seaudit_model_t *model = elem;
+	seaudit_model_destroy(&model);
+}
+
+static void report_stream_destroy(report_stream_t ** stream)
+{
+	if (stream == NULL || *stream == NULL) {
+		return;
+	}
+	apol_vector_destroy(&(*stream)->sections);
+	apol_vector_destroy(&(*stream)->models);
+	if ((*stream)->malformed != NULL) {
+		fclose((*stream)->malformed);
+	}
+	free(*stream);
+	*stream = NULL;
+}
+
+/**
+ * Allocate a model that selects the same messages as the report's
+ * model, but leaves them in log order.  The stream owns the new model.
+ */
+static seaudit_model_t *report_stream_model_create(const seaudit_log_t * log, const seaudit_report_t * report,
+						   report_stream_t * stream)
+{
+	seaudit_model_t *model = NULL;
+	int error;
+
+	if ((model = seaudit_model_create_from_model(report->model)) == NULL ||
+	    seaudit_model_clear_sorts(model) < 0 || apol_vector_append(stream->models, model) < 0) {
+		error = errno;
+		seaudit_model_destroy(&model);
+		ERR(log, "%s", strerror(error));
+		errno = error;
+		return NULL;
+	}
+	return model;
+}
+
+static int report_stream_add_section(const seaudit_log_t * log, report_stream_t * stream, report_stream_kind_e kind,
+				     seaudit_model_t * model)
+{
+	report_stream_section_t *sec = NULL;
+	int error;
+
+	if ((sec = calloc(1, sizeof(*sec))) == NULL ||
+	    (kind != REPORT_STREAM_STATS && (sec->spool = tmpfile()) == NULL) || apol_vector_append(stream->sections, sec) < 0) {
+		error = errno;
+		report_stream_section_free(sec);
+		ERR(log, "%s", strerror(error));
+		errno = error;
+		return -1;
+	}
+	sec->kind = kind;
+	sec->model = model;
+	return 0;
+}
+
+static int report_stream_add_standard(const seaudit_log_t * log, const seaudit_report_t * report, report_stream_t * stream,
+				      report_stream_kind_e kind)
+{
+	seaudit_filter_t *filter = NULL;
+	seaudit_model_t *model;
+	int error;
+
+	if (kind == REPORT_STREAM_TOGGLES) {
+		if ((filter = report_enforce_toggle_filter_create(log, report)) == NULL ||
+		    (model = report_stream_model_create(log, report, stream)) == NULL) {
+			error = errno;
+			seaudit_filter_destroy(&filter);
+			errno = error;
+			return -1;
+		}
+		if (seaudit_model_append_filter(model, filter) < 0) {
+			error = errno;
+			seaudit_filter_destroy(&filter);
+			ERR(log, "%s", strerror(error));
+			errno = error;
+			return -1;
+		}
+	} else {
+		if (stream->base == NULL && (stream->base = report_stream_model_create(log, report, stream)) == NULL) {
+			return -1;
+		}
+		model = stream->base;
+	}
+	return report_stream_add_section(log, stream, kind, model);
+}
+
+static int report_stream_add_view(const seaudit_log_t * log, const seaudit_report_t * report, report_stream_t * stream,
+				  xmlChar * view_filePath)
+{
+	size_t i;
+	apol_vector_t *loaded_filters = NULL;
+	seaudit_model_t *model;
+	seaudit_filter_t *filter;
+	int retval = -1, error = 0;
+
+	if ((loaded_filters = seaudit_filter_create_from_file((char *)view_filePath)) == NULL) {
+		error = errno;
+		ERR(log, "Error parsing file %s.", view_filePath);
+		goto cleanup;
+	}
+	if ((model = report_stream_model_create(log, report, stream)) == NULL) {
+		error = errno;
+		goto cleanup;
+	}
+	for (i = 0; i < apol_vector_get_size(loaded_filters); i++) {
+		/* the vector still owns the loaded filters, so give the
+		 * model copies of them */
+		filter = apol_vector_get_element(loaded_filters, i);
+		if ((filter = seaudit_filter_create_from_filter(filter)) == NULL || seaudit_model_append_filter(model, filter) < 0) {
+			error = errno;
+			seaudit_filter_destroy(&filter);
+			ERR(log, "%s", strerror(error));
+			goto cleanup;
+		}
+	}
+	if (report_stream_add_section(log, stream, REPORT_STREAM_VIEW, model) < 0) {
+		error = errno;
+		goto cleanup;
+	}
+	retval = 0;
+      cleanup:
+	apol_vector_destroy(&loaded_filters);
+	if (error != 0) {
+		errno = error;
+	}
+	return retval;
+}
+
+/**
+ * Read the configuration file and add a section to the stream for
+ * every standard section and view that report_write() will print, in
+ * the same order.
+ */
+static int report_stream_collect(const seaudit_log_t * log, const seaudit_report_t * report, report_stream_t * stream)
+{
+	xmlTextReaderPtr reader;
+	xmlChar *name = NULL, *attr = NULL;
+	int rt, kind, in_custom = 0, retval = -1, error = 0;
+
+	if ((reader = xmlNewTextReaderFilename(report->config)) == NULL) {
+		error = errno;
+		ERR(log, "Unable to open config file (%s).", report->config);
+		goto cleanup;
+	}
+	while ((rt = xmlTextReaderRead(reader)) == 1) {
+		if ((name = xmlTextReaderName(reader)) == NULL) {
+			error = errno;
+			ERR(log, "%s", "Unavailable node name.");
+			goto cleanup;
+		}
+		if (strcmp((char *)name, "custom-section") == 0) {
+			in_custom = (xmlTextReaderNodeType(reader) == 1);
+		} else if (xmlTextReaderNodeType(reader) != 1) {
+			/* only the starts of elements name sections */
+		} else if (!in_custom && strcmp((char *)name, "standard-section") == 0) {
+			/* invalid sections are reported when printing */
+			if ((attr = xmlTextReaderGetAttribute(reader, (const xmlChar *)"id")) != NULL &&
+			    (kind = report_get_section_index((char *)attr)) >= 0 &&
+			    report_stream_add_standard(log, report, stream, kind) < 0) {
+				error = errno;
+				goto cleanup;
+			}
+		} else if (in_custom && strcmp((char *)name, "view") == 0 && xmlTextReaderHasAttributes(reader)) {
+			if ((attr = xmlTextReaderGetAttribute(reader, (const xmlChar *)"file")) == NULL) {
+				error = errno;
+				ERR(log, "%s", "Error getting file attribute for view node.");
+				goto cleanup;
+			}
+			if (report_stream_add_view(log, report, stream, attr) < 0) {
+				error = errno;
+				goto cleanup;
+			}
+		}
+		xmlFree(name);
+		xmlFree(attr);
+		name = attr = NULL;
+	}
+	if (rt != 0) {
+		error = EIO;
+		ERR(log, "Failed to parse config file %s.", report->config);
+		goto cleanup;
+	}
+	retval = 0;
+      cleanup:
+	xmlFree(name);
+	xmlFree(attr);
+	if (reader != NULL) {
+		xmlFreeTextReader(reader);
+	}
+	if (retval < 0) {
+		errno = error;
+	}
+	return retval;
+}
+
+static report_stream_t *report_stream_create(const seaudit_log_t * log, const seaudit_report_t * report)
+{
+	report_stream_t *stream = NULL;
+	int error;
+
+	if ((stream = calloc(1, sizeof(*stream))) == NULL ||
+	    (stream->sections = apol_vector_create(report_stream_section_free)) == NULL ||
+	    (stream->models = apol_vector_create(report_stream_model_free)) == NULL ||
+	    (report->malformed && (stream->malformed = tmpfile()) == NULL)) {
+		error = errno;
+		report_stream_destroy(&stream);
+		ERR(log, "%s", strerror(error));
+		errno = error;
+		return NULL;
+	}
+	if (report_stream_collect(log, report, stream) < 0) {
+		error = errno;
+		report_stream_destroy(&stream);
+		errno = error;
+		return NULL;
+	}
+	return stream;
+}
+
+/**
+ * Return non-zero if a message belongs within a section, given that
+ * the section's model has already selected it.
+ */
+static int report_stream_section_selects(const report_stream_section_t * sec, const seaudit_message_t * msg)
+{
+	seaudit_message_type_e type;
+	seaudit_avc_message_t *avc = seaudit_message_get_data(msg, &type);
+	size_t i;
+
+	switch (sec->kind) {
+	case REPORT_STREAM_LOADS:
+		return type == SEAUDIT_MESSAGE_TYPE_LOAD;
+	case REPORT_STREAM_BOOLS:
+		return type == SEAUDIT_MESSAGE_TYPE_BOOL;
+	case REPORT_STREAM_TOGGLES:
+		/* filters cannot select by permission */
+		return type == SEAUDIT_MESSAGE_TYPE_AVC && avc->msg != SEAUDIT_AVC_DENIED &&
+			apol_vector_get_index(avc->perms, "setenforce", apol_str_strcmp, NULL, &i) == 0;
+	case REPORT_STREAM_ALLOWS:
+		return type == SEAUDIT_MESSAGE_TYPE_AVC && avc->msg == SEAUDIT_AVC_GRANTED;
+	case REPORT_STREAM_DENIES:
+		return type == SEAUDIT_MESSAGE_TYPE_AVC && avc->msg == SEAUDIT_AVC_DENIED;
+	default:
+		return 1;
+	}
+}
+
+/**
+ * Add to a section the messages its model selected from the log's
+ * current block.
+ */
+static int report_stream_section_feed(const seaudit_log_t * log, const seaudit_report_t * report, report_stream_section_t * sec)
+{
+	apol_vector_t *v;
+	seaudit_message_t *msg;
+	size_t i;
+	char *s;
+	int retval = -1, error = 0;
+
+	if ((v = seaudit_model_get_messages(log, sec->model)) == NULL) {
+		error = errno;
+		ERR(log, "%s", strerror(error));
+		goto cleanup;
+	}
+	if (sec->kind == REPORT_STREAM_STATS) {
+		sec->num_messages += apol_vector_get_size(v);
+		sec->num_loads += seaudit_model_get_num_loads(log, sec->model);
+		sec->num_bools += seaudit_model_get_num_bools(log, sec->model);
+		sec->num_allows += seaudit_model_get_num_allows(log, sec->model);
+		sec->num_denies += seaudit_model_get_num_denies(log, sec->model);
+		retval = 0;
+		goto cleanup;
+	}
+	for (i = 0; i < apol_vector_get_size(v); i++) {
+		msg = apol_vector_get_element(v, i);
+		if (!report_stream_section_selects(sec, msg)) {
+			continue;
+		}
+		if (report->format == SEAUDIT_REPORT_FORMAT_HTML) {
+			s = seaudit_message_to_string_html(msg);
+		} else {
+			s = seaudit_message_to_string(msg);
+		}
+		if (s == NULL || fputs(s, sec->spool) == EOF || fputc('\n', sec->spool) == EOF) {
+			error = errno;
+			free(s);
+			ERR(log, "%s", strerror(error));
+			goto cleanup;
+		}
+		free(s);
+		sec->num_messages++;
+	}
+	retval = 0;
+      cleanup:
+	apol_vector_destroy(&v);
+	if (retval < 0) {
+		errno = error;
+	}
+	return retval;
+}
+
+/**
+ * Feed the messages parsed so far to every section, all of whose
+ * models are refreshed in a single pass, then discard them.
+ */
+static int report_stream_feed(seaudit_log_t * log, const seaudit_report_t * report, report_stream_t * stream)
+{
+	const apol_vector_t *v;
+	size_t i;
+	int error;
+
+	if (model_refresh_batch(log, stream->models, 0) < 0) {
+		return -1;
+	}
+	for (i = 0; i < apol_vector_get_size(stream->sections); i++) {
+		if (report_stream_section_feed(log, report, apol_vector_get_element(stream->sections, i)) < 0) {
+			return -1;
+		}
+	}
+	if (stream->malformed != NULL) {
+		v = log_get_malformed_messages(log);
+		for (i = 0; i < apol_vector_get_size(v); i++) {
+			if (fprintf(stream->malformed, (report->format == SEAUDIT_REPORT_FORMAT_HTML ? "%s<br>\n" : "%s\n"),
+				    (char *)apol_vector_get_element(v, i)) < 0) {
+				error = errno;
+				ERR(log, "%s", strerror(error));
+				errno = error;
+				return -1;
+			}
+		}
+	}
+	seaudit_log_clear(log);
+	return 0;
+}
+
+/**
+ * Parse a file a block at a time, feeding each block to the stream.
+ * The buffer is enlarged should a single line not fit within it.  A
+ * multi-line message still unterminated after
+ * REPORT_STREAM_MAX_PENDING blocks is ended where it is, so that the
+ * log never holds more than that many blocks' messages.
+ */
+static int report_stream_file(seaudit_log_t * log, const seaudit_report_t * report, report_stream_t * stream, FILE * f,
+			      char **buf, size_t * size)
+{
+	size_t len = 0, n, end, num_pending = 0;
+	const char *eol;
+	char *t;
+	int eof = 0, rt, error;
+
+	while (!eof) {
+		if (len == *size) {
+			if ((t = realloc(*buf, *size * 2)) == NULL) {
+				error = errno;
+				ERR(log, "%s", strerror(error));
+				errno = error;
+				return -1;
+			}
+			*buf = t;
+			*size *= 2;
+		}
+		n = fread(*buf + len, 1, *size - len, f);
+		if (n < *size - len) {
+			if (ferror(f)) {
+				error = errno;
+				ERR(log, "%s", strerror(error));
+				errno = error;
+				return -1;
+			}
+			eof = 1;
+		}
+		len += n;
+		if (eof) {
+			end = len;
+		} else if ((eol = memrchr(*buf, '\n', len)) != NULL) {
+			end = eol - *buf + 1;
+		} else {
+			continue;
+		}
+		if (end > 0) {
+			if ((rt = parse_buffer_quietly(log, *buf, end, 0)) < 0) {
+				return -1;
+			} else if (rt > 0) {
+				stream->has_warnings = 1;
+			}
+			memmove(*buf, *buf + end, len - end);
+			len -= end;
+		}
+		/* a multi-line message may continue into the next
+		 * block, so keep it until it is complete */
+		if (!eof && log->next_line) {
+			if (++num_pending < REPORT_STREAM_MAX_PENDING) {
+				continue;
+			}
+			/* feeding clears the log, after which the lines
+			 * that would have continued the message are
+			 * ignored */
+			stream->has_warnings = 1;
+		}
+		if (report_stream_feed(log, report, stream) < 0) {
+			return -1;
+		}
+		num_pending = 0;
+	}
+	return 0;
+}
+
+int seaudit_report_write_stream(seaudit_log_t * log, const seaudit_report_t * report, FILE ** files, size_t num_files,
+				const char *out_file)
+{
+	report_stream_t *stream = NULL;
+	char *buf = NULL;
+	size_t i, size = REPORT_STREAM_BLOCK_SIZE;
+	int retval = -1, error = 0;
+
+	if (log == NULL || report == NULL || (files == NULL && num_files > 0)) {
+		ERR(log, "%s", strerror(EINVAL));
+		errno = EINVAL;
+		return -1;
+	}
+	if ((stream = report_stream_create(log, report)) == NULL) {
+		error = errno;
+		goto cleanup;
+	}
+	if ((buf = malloc(size)) == NULL) {
+		error = errno;
+		ERR(log, "%s", strerror(error));
+		goto cleanup;
+	}
+	for (i = 0; i < num_files; i++) {
+		if (report_stream_file(log, report, stream, files[i], &buf, &size) < 0) {
+			error = errno;
+			goto cleanup;
+		}
+	}
+	if (stream->has_warnings) {
+		WARN(log, "%s", "Audit log was parsed, but there were one or more invalid message found within it.");
+	}
+	if (report_write(log, report, stream, out_file) < 0) {
+		error = errno;
+		goto cleanup;
+	}
+	retval = 0;
+      cleanup:
+	free(buf);
+	report_stream_destroy(&stream);
+	if (retval < 0) {
+		errno = error;
+	}
+	return retval;
+}
@@ -42,6 +42,10 @@
 
 #include <libxml/uri.h>
 
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+
 #define FILTER_FILE_FORMAT_VERSION "1.3"
 
 /*************** master seaudit log object (defined in log.c) ***************/
@@ -58,6 +62,24 @@ struct seaudit_log
 	apol_bst_t *types, *classes, *roles, *users;
 	apol_bst_t *perms, *hosts, *bools, *managers;
 	apol_bst_t *mls_lvl, *mls_clr;
+	/** non-zero if messages are stored compactly, as per
+	 *  seaudit_log_set_compact() */
+	int compact;
+	/** for compact logs, the free-form strings (executables,
+	 *  paths, addresses, etc.) of AVC messages */
+	apol_bst_t *strings;
+	/** for compact logs, each distinct list of permissions; these
+	 *  are vectors of pointers into perms, each shared by all AVC
+	 *  messages with that list */
+	apol_bst_t *perm_lists;
+	/** for compact logs, blocks of memory from which AVC messages
+	 *  are allocated */
+	apol_vector_t *slabs;
+	/** number of messages allocated from the last block */
+	size_t slab_used;
+	/** for compact logs, permissions of the AVC message being
+	 *  parsed, before they are interned into perm_lists */
+	apol_vector_t *parse_perms;
 	seaudit_log_type_e logtype;
 	seaudit_handle_fn_t fn;
 	void *handle_arg;
@@ -65,6 +87,23 @@ struct seaudit_log
 	int tz_initialized;
 	/** non-zero if the parser is in the middle of a line */
 	int next_line;
+	/** scratch space into which the parser copies and splits each
+	 *  line, reused from line to line */
+	char *parse_buf;
+	size_t parse_buf_size;
+	/** pointers into parse_buf for each token of the current line */
+	char **parse_tokens;
+	size_t parse_tokens_size;
+	/** path to the file being followed, or NULL if not following */
+	char *follow_path;
+	/** open handle to the followed file; this may refer to an
+	 *  older file than follow_path after the log was rotated */
+	FILE *follow_file;
+	/** device and inode of follow_file, to detect rotation */
+	dev_t follow_dev;
+	ino_t follow_ino;
+	/** offset into follow_file just past the last line parsed */
+	off_t follow_offset;
 };
 
 /**
@@ -108,6 +147,27 @@ const apol_vector_t *log_get_messages(const seaudit_log_t * log);
  */
 const apol_vector_t *log_get_malformed_messages(const seaudit_log_t * log);
 
+/**
+ * Find the log's copy of a list of permissions, adding a copy if the
+ * log does not yet have one.  This is only for compact logs.
+ *
+ * @param log Log whose permission lists to search.
+ * @param perms Vector of pointers into the log's perms BST.
+ * @param result Reference to where to write the log's list.  The
+ * caller must not destroy or modify this vector.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+int log_intern_perms(const seaudit_log_t * log, const apol_vector_t * perms, apol_vector_t ** result);
+
+/**
+ * Free the blocks from which a compact log allocated its AVC
+ * messages.  The messages within them must no longer be used.
+ *
+ * @param log Log whose blocks to free.
+ */
+void log_free_slabs(seaudit_log_t * log);
+
 /*************** messages (defined in message.c) ***************/
 
 struct seaudit_message
@@ -151,6 +211,27 @@ seaudit_message_t *message_create(seaudit_log_t * log, seaudit_message_type_e ty
  */
 void message_free(void *msg);
 
+/**
+ * Deallocate a message that belongs to a compact log.  AVC messages
+ * are left alone, because their memory belongs to the log's blocks
+ * and their strings to its pools; other messages are freed as per
+ * message_free().
+ *
+ * @param msg If not NULL, message to free.
+ */
+void message_free_compact(void *msg);
+
+/**
+ * Give a message space for its date stamp, if it does not already
+ * have it.  The new date stamp is zeroed.
+ *
+ * @param log Log to which the message belongs.
+ * @param msg Message whose date_stamp to set.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+int message_create_date(const seaudit_log_t * log, seaudit_message_t * msg);
+
 /*************** avc messages (defined in avc_message.c) ***************/
 
 typedef enum seaudit_avc_message_class
@@ -166,6 +247,9 @@ typedef enum seaudit_avc_message_class
 /**
  * Definition of an avc message.  Note that unless stated otherwise,
  * character pointers are into the message's log's respective BST.
+ * The exceptions are the free-form strings exe through ipaddr, which
+ * are owned by the message unless its log is compact, in which case
+ * they are within log->strings.
  */
 struct seaudit_avc_message
 {
@@ -173,27 +257,27 @@ struct seaudit_avc_message
 	/** type of avc message this is, either a deny or a granted
 	 * (i.e., auditallow) */
 	seaudit_avc_message_class_e avc_type;
-	/** executable and path - free() this */
+	/** executable and path */
 	char *exe;
-	/** command - free() this */
+	/** command */
 	char *comm;
-	/** path of the OBJECT - free() this */
+	/** path of the OBJECT */
 	char *path;
-	/** device for the object - free() this */
+	/** device for the object */
 	char *dev;
-	/** network interface - free() this */
+	/** network interface */
 	char *netif;
-	/** local address - free() this */
+	/** local address */
 	char *laddr;
-	/** foreign address - free() this */
+	/** foreign address */
 	char *faddr;
-	/** source address - free() this */
+	/** source address */
 	char *saddr;
-	/** destination address - free() this */
+	/** destination address */
 	char *daddr;
-	/** free() this */
+	/** name of the object */
 	char *name;
-	/** free() this */
+	/** IP address */
 	char *ipaddr;
 	/** source context's user */
 	char *suser;
@@ -223,7 +307,8 @@ struct seaudit_avc_message
 	long tm_stmp_nano;
 	/** audit header serial number */
 	unsigned int serial;
-	/** pointers into log->perms BST (hence char *) */
+	/** pointers into log->perms BST (hence char *); for compact
+	 *  logs this vector is from log->perm_lists */
 	apol_vector_t *perms;
 	/** key for an IPC call */
 	int key;
@@ -454,6 +539,25 @@ char *load_message_to_string_html(const seaudit_message_t * msg, const char *dat
  */
 char *load_message_to_misc_string(const seaudit_load_message_t * load);
 
+/*************** parsing functions (defined in parse.c) ***************/
+
+/**
+ * Parse a buffer as per seaudit_log_parse_buffer_parallel(), but
+ * without warning about invalid messages.  This is for callers that
+ * parse a log a piece at a time and warn at most once at the end.
+ *
+ * @param log Log to which append messages; its models are notified
+ * afterwards.
+ * @param buffer Buffer of complete lines to parse.
+ * @param bufsize Number of bytes within buffer.
+ * @param num_threads Maximum number of threads to use; if 0, use one
+ * per online processor.
+ *
+ * @return 0 on success, > 0 if any invalid messages were found, < 0
+ * on error.
+ */
+int parse_buffer_quietly(seaudit_log_t * log, const char *buffer, size_t bufsize, unsigned int num_threads);
+
 /*************** model functions (defined in model.h) ***************/
 
 /**
@@ -473,6 +577,20 @@ void model_remove_log(seaudit_model_t * model, seaudit_log_t * log);
  */
 void model_notify_log_changed(seaudit_model_t * model, seaudit_log_t * log);
 
+/**
+ * Notify a model that messages have been appended to a log.  If the
+ * model has not otherwise changed then only the new messages need to
+ * be considered the next time it is recalculated.
+ *
+ * @param model Model to notify.
+ * @param log Log that has been appended to.
+ * @param first_message Index of the first message within the log
+ * that is new or that may have been modified.
+ * @param first_malformed Index of the first new malformed message
+ * within the log.
+ */
+void model_notify_log_appended(seaudit_model_t * model, seaudit_log_t * log, size_t first_message, size_t first_malformed);
+
 /**
  * Notify a model that a filter has been changed; the model will need
  * to recalculate its messages.
@@ -482,6 +600,21 @@ void model_notify_log_changed(seaudit_model_t * model, seaudit_log_t * log);
  */
 void model_notify_filter_changed(seaudit_model_t * model, seaudit_filter_t * filter);
 
+/**
+ * Bring up to date every model that needs recalculating, as per
+ * seaudit_log_refresh_models().  Models that watch only the given log
+ * are filtered in a single pass over its messages, divided among
+ * several threads; any others are refreshed individually.
+ *
+ * @param log Log whose messages to filter; errors are reported to it.
+ * @param models Vector of models watching the log.
+ * @param num_threads Maximum number of threads to use; if 0, use one
+ * per online processor.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+int model_refresh_batch(const seaudit_log_t * log, const apol_vector_t * models, unsigned int num_threads);
+
 /*************** filter functions (defined in filter.c) ***************/
 
 /**
@@ -524,18 +657,48 @@ struct filter_parse_state
 	filter_read_func *cur_filter_read;
 };
 
+/**
+ * Compile a filter's criteria against the strings that a log has
+ * interned, so that subsequent calls to filter_is_accepted() for
+ * that log's messages compare pointers rather than strings.  Glob
+ * criteria upon permissions and hosts are evaluated once for each
+ * distinct string within the log.  The compiled program is kept
+ * until the filter changes, the filter is compiled against another
+ * log, or the log has interned new strings; in the last case this
+ * compiles it again.
+ *
+ * @param filter Filter to compile.
+ * @param log Log whose messages will be filtered.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+int filter_compile(seaudit_filter_t * filter, const seaudit_log_t * log);
+
+/**
+ * Destroy a filter's compiled program, if it has one.  This must be
+ * called whenever a criterion changes or the log against which the
+ * filter was compiled changes its strings.
+ *
+ * @param filter Filter whose program to discard.
+ */
+void filter_discard_program(seaudit_filter_t * filter);
+
 /**
  * Given a filter and a message, return non-zero if the msg is
  * accepted by the filter according to the filter's criteria.  If the
  * filter does not have enough information to decide (because the
- * message is incomplete) then this should return 0.
+ * message is incomplete) then this should return 0.  If the filter
+ * was compiled against the message's log then the compiled program is
+ * used; the caller must have called filter_compile() after the log
+ * last interned new strings.
  *
  * @param filter Filter to apply.
+ * @param log Log to which the message belongs.
  * @param msg Message to check.
  *
  * @return Non-zero if message is accepted, 0 if not.
  */
-int filter_is_accepted(const seaudit_filter_t * filter, const seaudit_message_t * msg);
+int filter_is_accepted(const seaudit_filter_t * filter, const seaudit_log_t * log, const seaudit_message_t * msg);
 
 /**
  * Parse the given XML file and fill in the passed in struct.  The
@@ -612,6 +775,46 @@ int sort_is_supported(const seaudit_sort_t * sort, const seaudit_message_t * msg
  */
 int sort_comp(const seaudit_sort_t * sort, const seaudit_message_t * a, const seaudit_message_t * b);
 
+/** largest key of a message that a sort supports */
+#define SORT_KEY_MAX ((uint64_t) INT64_MAX)
+/** key of every message that a sort does not support */
+#define SORT_KEY_UNSUPPORTED UINT64_MAX
+
+/**
+ * Prepare a sort object to calculate the keys of a set of messages,
+ * such as by ranking the distinct strings among them.  Any keys
+ * prepared previously are discarded.
+ *
+ * @param log Error handling log.
+ * @param sort Sort object to prepare.
+ * @param messages Vector of messages whose keys will be calculated.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+int sort_prepare_keys(const seaudit_log_t * log, seaudit_sort_t * sort, const apol_vector_t * messages);
+
+/**
+ * Return a message's key for a prepared sort object.  Among the
+ * messages given to sort_prepare_keys(), comparing keys as unsigned
+ * integers orders messages the same as sort_comp(), with messages
+ * that the sort does not support last.  This function only reads the
+ * sort object, so it may be called by several threads at once.
+ *
+ * @param sort Sort object to query.
+ * @param msg Message whose key to calculate.
+ *
+ * @return The message's key, or SORT_KEY_UNSUPPORTED if the sort does
+ * not support the message.
+ */
+uint64_t sort_get_key(const seaudit_sort_t * sort, const seaudit_message_t * msg);
+
+/**
+ * Free the space used by a sort object to calculate keys.
+ *
+ * @param sort Sort object whose keys to discard.
+ */
+void sort_discard_keys(seaudit_sort_t * sort);
+
 /**
  * Return the type of sort this sort object is.  The name is valid for
  * sort_create_from_name()'s first parameter.
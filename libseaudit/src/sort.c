@@ -28,6 +28,8 @@
 #include <apol/util.h>
 
 #include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 /**
@@ -41,12 +43,55 @@ typedef int (sort_comp_func) (const seaudit_sort_t * sort, const seaudit_message
  */
 typedef int (sort_supported_func) (const seaudit_sort_t * sort, const seaudit_message_t * m);
 
+/**
+ * Callback that examines all of the messages about to be sorted,
+ * before any of their keys are calculated.
+ */
+typedef int (sort_prepare_func) (const seaudit_log_t * log, seaudit_sort_t * sort, const apol_vector_t * messages);
+
+/**
+ * Callback that returns a supported message's key, at most
+ * SORT_KEY_MAX.  Keys order messages the same way that the
+ * comparison function does (in ascending order).
+ */
+typedef uint64_t(sort_key_func) (const seaudit_sort_t * sort, const seaudit_message_t * m);
+
+/**
+ * Callback that returns the field of a supported message by which a
+ * ranked sort orders messages.  Messages whose fields are the same
+ * pointer compare equal.
+ */
+typedef const void *(sort_value_func) (const seaudit_message_t * m);
+
+/**
+ * A distinct field value among the messages being sorted, along with
+ * its position among all of those values.
+ */
+typedef struct sort_rank
+{
+	const void *value;
+	/** a message with this value, used to compare values */
+	const seaudit_message_t *msg;
+	uint64_t rank;
+} sort_rank_t;
+
 struct seaudit_sort
 {
 	const char *name;
 	sort_comp_func *comp;
 	sort_supported_func *support;
+	sort_prepare_func *prepare;
+	sort_key_func *key;
+	/** for ranked sorts, accessor to the field being ranked */
+	sort_value_func *value;
 	int direction;
+	/** for ranked sorts, array of ranks ordered by their value's
+	 * address (only valid after sort_prepare_keys()) */
+	sort_rank_t *ranks;
+	size_t num_ranks;
+	/** for date sorts, non-zero if some message's date lacks a
+	 * year (only valid after sort_prepare_keys()) */
+	int ignore_year;
 };
 
 seaudit_sort_t *seaudit_sort_create_from_sort(const seaudit_sort_t * sort)
@@ -62,6 +107,9 @@ seaudit_sort_t *seaudit_sort_create_from_sort(const seaudit_sort_t * sort)
 	s->name = sort->name;
 	s->comp = sort->comp;
 	s->support = sort->support;
+	s->prepare = sort->prepare;
+	s->key = sort->key;
+	s->value = sort->value;
 	s->direction = sort->direction;
 	return s;
 }
@@ -69,12 +117,14 @@ seaudit_sort_t *seaudit_sort_create_from_sort(const seaudit_sort_t * sort)
 void seaudit_sort_destroy(seaudit_sort_t ** sort)
 {
 	if (sort != NULL && *sort != NULL) {
+		free((*sort)->ranks);
 		free(*sort);
 		*sort = NULL;
 	}
 }
 
-static seaudit_sort_t *sort_create(const char *name, sort_comp_func * comp, sort_supported_func support, const int direction)
+static seaudit_sort_t *sort_create(const char *name, sort_comp_func * comp, sort_supported_func support,
+				   sort_prepare_func * prepare, sort_key_func * key, sort_value_func * value, const int direction)
 {
 	seaudit_sort_t *s = calloc(1, sizeof(*s));
 	if (s == NULL) {
@@ -83,6 +133,9 @@ static seaudit_sort_t *sort_create(const char *name, sort_comp_func * comp, sort
 	s->name = name;
 	s->comp = comp;
 	s->support = support;
+	s->prepare = prepare;
+	s->key = key;
+	s->value = value;
 	s->direction = direction;
 	return s;
 }
@@ -93,7 +146,127 @@ seaudit_sort_t *sort_create_from_sort(const seaudit_sort_t * sort)
 		errno = EINVAL;
 		return NULL;
 	}
-	return sort_create(sort->name, sort->comp, sort->support, sort->direction);
+	return sort_create(sort->name, sort->comp, sort->support, sort->prepare, sort->key, sort->value, sort->direction);
+}
+
+/**
+ * Order ranks by the address of their values.
+ */
+static int sort_rank_address_comp(const void *a, const void *b)
+{
+	uintptr_t v1 = (uintptr_t) ((const sort_rank_t *)a)->value;
+	uintptr_t v2 = (uintptr_t) ((const sort_rank_t *)b)->value;
+	if (v1 < v2) {
+		return -1;
+	}
+	return v1 > v2;
+}
+
+/**
+ * Order ranks by their values, using the sort's comparison function.
+ */
+static int sort_rank_value_comp(const void *a, const void *b, void *data)
+{
+	const seaudit_sort_t *sort = data;
+	return sort->comp(sort, ((const sort_rank_t *)a)->msg, ((const sort_rank_t *)b)->msg);
+}
+
+/**
+ * Rank every distinct value among the supported messages.  Values
+ * are first made unique by address, so that fields pointing into the
+ * log's interned strings are compared once per distinct string
+ * rather than once per message.
+ */
+static int sort_rank_prepare(const seaudit_log_t * log, seaudit_sort_t * sort, const apol_vector_t * messages)
+{
+	size_t i, j, num_messages = apol_vector_get_size(messages);
+	apol_vector_t *v = NULL;
+	seaudit_message_t *m;
+	sort_rank_t *r;
+	uint64_t rank = 0;
+	int error;
+
+	if (num_messages == 0) {
+		return 0;
+	}
+	if ((sort->ranks = malloc(num_messages * sizeof(*sort->ranks))) == NULL) {
+		error = errno;
+		ERR(log, "%s", strerror(error));
+		errno = error;
+		return -1;
+	}
+	for (i = 0, j = 0; i < num_messages; i++) {
+		m = apol_vector_get_element(messages, i);
+		if (sort->support(sort, m)) {
+			sort->ranks[j].value = sort->value(m);
+			sort->ranks[j].msg = m;
+			j++;
+		}
+	}
+	qsort(sort->ranks, j, sizeof(*sort->ranks), sort_rank_address_comp);
+	for (i = 0, sort->num_ranks = 0; i < j; i++) {
+		if (sort->num_ranks == 0 || sort->ranks[sort->num_ranks - 1].value != sort->ranks[i].value) {
+			sort->ranks[sort->num_ranks++] = sort->ranks[i];
+		}
+	}
+	if ((v = apol_vector_create_with_capacity(sort->num_ranks, NULL)) == NULL) {
+		error = errno;
+		ERR(log, "%s", strerror(error));
+		errno = error;
+		return -1;
+	}
+	for (i = 0; i < sort->num_ranks; i++) {
+		apol_vector_append(v, sort->ranks + i);
+	}
+	apol_vector_sort(v, sort_rank_value_comp, sort);
+	for (i = 0; i < sort->num_ranks; i++) {
+		r = apol_vector_get_element(v, i);
+		if (i > 0 && sort_rank_value_comp(apol_vector_get_element(v, i - 1), r, sort) != 0) {
+			rank++;
+		}
+		r->rank = rank;
+	}
+	apol_vector_destroy(&v);
+	return 0;
+}
+
+/**
+ * Look up the rank of a message's value.
+ */
+static uint64_t sort_rank_key(const seaudit_sort_t * sort, const seaudit_message_t * m)
+{
+	uintptr_t value = (uintptr_t) sort->value(m);
+	size_t lo = 0, hi = sort->num_ranks, mid;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if ((uintptr_t) sort->ranks[mid].value < value) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	if (lo == sort->num_ranks || (uintptr_t) sort->ranks[lo].value != value) {
+		/* message was not among those prepared */
+		return SORT_KEY_MAX;
+	}
+	return sort->ranks[lo].rank;
+}
+
+/**
+ * Create a sort whose keys are the ranks of a field's values.
+ */
+static seaudit_sort_t *sort_create_ranked(const char *name, sort_comp_func * comp, sort_supported_func support,
+					  sort_value_func * value, const int direction)
+{
+	return sort_create(name, comp, support, sort_rank_prepare, sort_rank_key, value, direction);
+}
+
+/**
+ * Return a signed integer's key.
+ */
+static uint64_t sort_int_key(int i)
+{
+	return (uint64_t) ((uint32_t) i ^ 0x80000000U);
 }
 
 static int sort_message_type_comp(const seaudit_sort_t * sort
@@ -113,9 +286,19 @@ static int sort_message_type_support(const seaudit_sort_t * sort __attribute__ (
 	return msg->type != SEAUDIT_MESSAGE_TYPE_INVALID;
 }
 
+static uint64_t sort_message_type_key(const seaudit_sort_t * sort __attribute__ ((unused)), const seaudit_message_t * msg)
+{
+	uint64_t key = (uint64_t) msg->type << 8;
+	if (msg->type == SEAUDIT_MESSAGE_TYPE_AVC) {
+		key |= (uint8_t) msg->data.avc->msg;
+	}
+	return key;
+}
+
 seaudit_sort_t *seaudit_sort_by_message_type(const int direction)
 {
-	return sort_create("message_type", sort_message_type_comp, sort_message_type_support, direction);
+	return sort_create("message_type", sort_message_type_comp, sort_message_type_support, NULL, sort_message_type_key,
+			   NULL, direction);
 }
 
 /**
@@ -156,9 +339,46 @@ static int sort_date_support(const seaudit_sort_t * sort __attribute__ ((unused)
 	return msg->date_stamp != NULL;
 }
 
+/**
+ * The date comparison only considers years when both dates have one,
+ * which does not order a mixture of dates with and without years.
+ * Keys therefore ignore all years whenever any date lacks one; this
+ * agrees with the comparison for every pair of dates that it orders
+ * consistently.
+ */
+static int sort_date_prepare(const seaudit_log_t * log
+			     __attribute__ ((unused)), seaudit_sort_t * sort, const apol_vector_t * messages)
+{
+	size_t i;
+	const seaudit_message_t *m;
+	sort->ignore_year = 0;
+	for (i = 0; i < apol_vector_get_size(messages) && !sort->ignore_year; i++) {
+		m = apol_vector_get_element(messages, i);
+		if (m->date_stamp != NULL && m->date_stamp->tm_year == 0) {
+			sort->ignore_year = 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Pack a date's components into a key, sixteen bits for the year and
+ * eight bits for each of the rest.
+ */
+static uint64_t sort_date_key(const seaudit_sort_t * sort, const seaudit_message_t * msg)
+{
+	const struct tm *t = msg->date_stamp;
+	uint64_t key = (sort->ignore_year ? 0 : (uint16_t) (t->tm_year + 0x8000));
+	key = (key << 8) | (uint8_t) t->tm_mon;
+	key = (key << 8) | (uint8_t) t->tm_mday;
+	key = (key << 8) | (uint8_t) t->tm_hour;
+	key = (key << 8) | (uint8_t) t->tm_min;
+	return (key << 8) | (uint8_t) t->tm_sec;
+}
+
 seaudit_sort_t *seaudit_sort_by_date(const int direction)
 {
-	return sort_create("date", sort_date_comp, sort_date_support, direction);
+	return sort_create("date", sort_date_comp, sort_date_support, sort_date_prepare, sort_date_key, NULL, direction);
 }
 
 static int sort_host_comp(const seaudit_sort_t * sort
@@ -172,9 +392,14 @@ static int sort_host_support(const seaudit_sort_t * sort __attribute__ ((unused)
 	return msg->host != NULL;
 }
 
+static const void *sort_host_value(const seaudit_message_t * msg)
+{
+	return msg->host;
+}
+
 seaudit_sort_t *seaudit_sort_by_host(const int direction)
 {
-	return sort_create("host", sort_host_comp, sort_host_support, direction);
+	return sort_create_ranked("host", sort_host_comp, sort_host_support, sort_host_value, direction);
 }
 
 static int sort_perm_comp(const seaudit_sort_t * sort
@@ -190,9 +415,14 @@ static int sort_perm_support(const seaudit_sort_t * sort __attribute__ ((unused)
 		msg->data.avc->perms != NULL && apol_vector_get_size(msg->data.avc->perms) >= 1;
 }
 
+static const void *sort_perm_value(const seaudit_message_t * msg)
+{
+	return msg->data.avc->perms;
+}
+
 seaudit_sort_t *seaudit_sort_by_permission(const int direction)
 {
-	return sort_create("permission", sort_perm_comp, sort_perm_support, direction);
+	return sort_create_ranked("permission", sort_perm_comp, sort_perm_support, sort_perm_value, direction);
 }
 
 static int sort_source_user_comp(const seaudit_sort_t * sort
@@ -206,9 +436,14 @@ static int sort_source_user_support(const seaudit_sort_t * sort __attribute__ ((
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->suser != NULL;
 }
 
+static const void *sort_source_user_value(const seaudit_message_t * msg)
+{
+	return msg->data.avc->suser;
+}
+
 seaudit_sort_t *seaudit_sort_by_source_user(const int direction)
 {
-	return sort_create("source_user", sort_source_user_comp, sort_source_user_support, direction);
+	return sort_create_ranked("source_user", sort_source_user_comp, sort_source_user_support, sort_source_user_value, direction);
 }
 
 static int sort_source_role_comp(const seaudit_sort_t * sort __attribute((unused)), const seaudit_message_t * a,
@@ -222,9 +457,14 @@ static int sort_source_role_support(const seaudit_sort_t * sort __attribute__ ((
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->srole != NULL;
 }
 
+static const void *sort_source_role_value(const seaudit_message_t * msg)
+{
+	return msg->data.avc->srole;
+}
+
 seaudit_sort_t *seaudit_sort_by_source_role(const int direction)
 {
-	return sort_create("source_role", sort_source_role_comp, sort_source_role_support, direction);
+	return sort_create_ranked("source_role", sort_source_role_comp, sort_source_role_support, sort_source_role_value, direction);
 }
 
 static int sort_source_type_comp(const seaudit_sort_t * sort
@@ -238,9 +478,14 @@ static int sort_source_type_support(const seaudit_sort_t * sort __attribute__ ((
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->stype != NULL;
 }
 
+static const void *sort_source_type_value(const seaudit_message_t * msg)
+{
+	return msg->data.avc->stype;
+}
+
 seaudit_sort_t *seaudit_sort_by_source_type(const int direction)
 {
-	return sort_create("source_type", sort_source_type_comp, sort_source_type_support, direction);
+	return sort_create_ranked("source_type", sort_source_type_comp, sort_source_type_support, sort_source_type_value, direction);
 }
 
 static int sort_source_mls_lvl_comp(const seaudit_sort_t * sort
@@ -254,9 +499,14 @@ static int sort_source_mls_lvl_support(const seaudit_sort_t * sort __attribute__
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->smls_lvl != NULL;
 }
 
+static const void *sort_source_mls_lvl_value(const seaudit_message_t * msg)
+{
+	return msg->data.avc->smls_lvl;
+}
+
 seaudit_sort_t *seaudit_sort_by_source_mls_lvl(const int direction)
 {
-	return sort_create("source_mls_lvl", sort_source_mls_lvl_comp, sort_source_mls_lvl_support, direction);
+	return sort_create_ranked("source_mls_lvl", sort_source_mls_lvl_comp, sort_source_mls_lvl_support, sort_source_mls_lvl_value, direction);
 }
 
 static int sort_source_mls_clr_comp(const seaudit_sort_t * sort
@@ -270,9 +520,14 @@ static int sort_source_mls_clr_support(const seaudit_sort_t * sort __attribute__
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->smls_clr != NULL;
 }
 
+static const void *sort_source_mls_clr_value(const seaudit_message_t * msg)
+{
+	return msg->data.avc->smls_clr;
+}
+
 seaudit_sort_t *seaudit_sort_by_source_mls_clr(const int direction)
 {
-	return sort_create("source_mls_clr", sort_source_mls_clr_comp, sort_source_mls_clr_support, direction);
+	return sort_create_ranked("source_mls_clr", sort_source_mls_clr_comp, sort_source_mls_clr_support, sort_source_mls_clr_value, direction);
 }
 
 static int sort_target_user_comp(const seaudit_sort_t * sort
@@ -286,9 +541,14 @@ static int sort_target_user_support(const seaudit_sort_t * sort __attribute__ ((
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->tuser != NULL;
 }
 
+static const void *sort_target_user_value(const seaudit_message_t * msg)
+{
+	return msg->data.avc->tuser;
+}
+
 seaudit_sort_t *seaudit_sort_by_target_user(const int direction)
 {
-	return sort_create("target_user", sort_target_user_comp, sort_target_user_support, direction);
+	return sort_create_ranked("target_user", sort_target_user_comp, sort_target_user_support, sort_target_user_value, direction);
 }
 
 static int sort_target_role_comp(const seaudit_sort_t * sort
@@ -302,9 +562,14 @@ static int sort_target_role_support(const seaudit_sort_t * sort __attribute__ ((
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->trole != NULL;
 }
 
+static const void *sort_target_role_value(const seaudit_message_t * msg)
+{
+	return msg->data.avc->trole;
+}
+
 seaudit_sort_t *seaudit_sort_by_target_role(const int direction)
 {
-	return sort_create("target_role", sort_target_role_comp, sort_target_role_support, direction);
+	return sort_create_ranked("target_role", sort_target_role_comp, sort_target_role_support, sort_target_role_value, direction);
 }
 
 static int sort_target_type_comp(const seaudit_sort_t * sort
@@ -318,9 +583,14 @@ static int sort_target_type_support(const seaudit_sort_t * sort __attribute__ ((
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->ttype != NULL;
 }
 
+static const void *sort_target_type_value(const seaudit_message_t * msg)
+{
+	return msg->data.avc->ttype;
+}
+
 seaudit_sort_t *seaudit_sort_by_target_type(const int direction)
 {
-	return sort_create("target_type", sort_target_type_comp, sort_target_type_support, direction);
+	return sort_create_ranked("target_type", sort_target_type_comp, sort_target_type_support, sort_target_type_value, direction);
 }
 
 static int sort_target_mls_lvl_comp(const seaudit_sort_t * sort
@@ -334,9 +604,14 @@ static int sort_target_mls_lvl_support(const seaudit_sort_t * sort __attribute__
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->tmls_lvl != NULL;
 }
 
+static const void *sort_target_mls_lvl_value(const seaudit_message_t * msg)
+{
+	return msg->data.avc->tmls_lvl;
+}
+
 seaudit_sort_t *seaudit_sort_by_target_mls_lvl(const int direction)
 {
-	return sort_create("target_mls_lvl", sort_target_mls_lvl_comp, sort_target_mls_lvl_support, direction);
+	return sort_create_ranked("target_mls_lvl", sort_target_mls_lvl_comp, sort_target_mls_lvl_support, sort_target_mls_lvl_value, direction);
 }
 
 static int sort_target_mls_clr_comp(const seaudit_sort_t * sort
@@ -350,9 +625,14 @@ static int sort_target_mls_clr_support(const seaudit_sort_t * sort __attribute__
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->tmls_clr != NULL;
 }
 
+static const void *sort_target_mls_clr_value(const seaudit_message_t * msg)
+{
+	return msg->data.avc->tmls_clr;
+}
+
 seaudit_sort_t *seaudit_sort_by_target_mls_clr(const int direction)
 {
-	return sort_create("target_mls_clr", sort_target_mls_clr_comp, sort_target_mls_clr_support, direction);
+	return sort_create_ranked("target_mls_clr", sort_target_mls_clr_comp, sort_target_mls_clr_support, sort_target_mls_clr_value, direction);
 }
 
 static int sort_object_class_comp(const seaudit_sort_t * sort
@@ -366,9 +646,14 @@ static int sort_object_class_support(const seaudit_sort_t * sort __attribute__ (
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->tclass != NULL;
 }
 
+static const void *sort_object_class_value(const seaudit_message_t * msg)
+{
+	return msg->data.avc->tclass;
+}
+
 seaudit_sort_t *seaudit_sort_by_object_class(const int direction)
 {
-	return sort_create("object_class", sort_object_class_comp, sort_object_class_support, direction);
+	return sort_create_ranked("object_class", sort_object_class_comp, sort_object_class_support, sort_object_class_value, direction);
 }
 
 static int sort_executable_comp(const seaudit_sort_t * sort
@@ -382,9 +667,14 @@ static int sort_executable_support(const seaudit_sort_t * sort __attribute__ ((u
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->exe != NULL;
 }
 
+static const void *sort_executable_value(const seaudit_message_t * msg)
+{
+	return msg->data.avc->exe;
+}
+
 seaudit_sort_t *seaudit_sort_by_executable(const int direction)
 {
-	return sort_create("executable", sort_executable_comp, sort_executable_support, direction);
+	return sort_create_ranked("executable", sort_executable_comp, sort_executable_support, sort_executable_value, direction);
 }
 
 static int sort_command_comp(const seaudit_sort_t * sort
@@ -398,9 +688,14 @@ static int sort_command_support(const seaudit_sort_t * sort __attribute__ ((unus
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->comm != NULL;
 }
 
+static const void *sort_command_value(const seaudit_message_t * msg)
+{
+	return msg->data.avc->comm;
+}
+
 seaudit_sort_t *seaudit_sort_by_command(const int direction)
 {
-	return sort_create("command", sort_command_comp, sort_command_support, direction);
+	return sort_create_ranked("command", sort_command_comp, sort_command_support, sort_command_value, direction);
 }
 
 static int sort_name_comp(const seaudit_sort_t * sort
@@ -414,9 +709,14 @@ static int sort_name_support(const seaudit_sort_t * sort __attribute__ ((unused)
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->name != NULL;
 }
 
+static const void *sort_name_value(const seaudit_message_t * msg)
+{
+	return msg->data.avc->name;
+}
+
 seaudit_sort_t *seaudit_sort_by_name(const int direction)
 {
-	return sort_create("name", sort_name_comp, sort_name_support, direction);
+	return sort_create_ranked("name", sort_name_comp, sort_name_support, sort_name_value, direction);
 }
 
 static int sort_path_comp(const seaudit_sort_t * sort
@@ -430,9 +730,14 @@ static int sort_path_support(const seaudit_sort_t * sort __attribute__ ((unused)
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->path != NULL;
 }
 
+static const void *sort_path_value(const seaudit_message_t * msg)
+{
+	return msg->data.avc->path;
+}
+
 seaudit_sort_t *seaudit_sort_by_path(const int direction)
 {
-	return sort_create("path", sort_path_comp, sort_path_support, direction);
+	return sort_create_ranked("path", sort_path_comp, sort_path_support, sort_path_value, direction);
 }
 
 static int sort_device_comp(const seaudit_sort_t * sort
@@ -446,9 +751,14 @@ static int sort_device_support(const seaudit_sort_t * sort __attribute__ ((unuse
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->dev != NULL;
 }
 
+static const void *sort_device_value(const seaudit_message_t * msg)
+{
+	return msg->data.avc->dev;
+}
+
 seaudit_sort_t *seaudit_sort_by_device(const int direction)
 {
-	return sort_create("device", sort_device_comp, sort_device_support, direction);
+	return sort_create_ranked("device", sort_device_comp, sort_device_support, sort_device_value, direction);
 }
 
 static int sort_inode_comp(const seaudit_sort_t * sort
@@ -467,9 +777,15 @@ static int sort_inode_support(const seaudit_sort_t * sort __attribute__ ((unused
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->inode > 0;
 }
 
+static uint64_t sort_inode_key(const seaudit_sort_t * sort __attribute__ ((unused)), const seaudit_message_t * msg)
+{
+	uint64_t inode = msg->data.avc->inode;
+	return (inode > SORT_KEY_MAX ? SORT_KEY_MAX : inode);
+}
+
 seaudit_sort_t *seaudit_sort_by_inode(const int direction)
 {
-	return sort_create("inode", sort_inode_comp, sort_inode_support, direction);
+	return sort_create("inode", sort_inode_comp, sort_inode_support, NULL, sort_inode_key, NULL, direction);
 }
 
 static int sort_pid_comp(const seaudit_sort_t * sort
@@ -488,9 +804,14 @@ static int sort_pid_support(const seaudit_sort_t * sort __attribute__ ((unused))
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->pid > 0;
 }
 
+static uint64_t sort_pid_key(const seaudit_sort_t * sort __attribute__ ((unused)), const seaudit_message_t * msg)
+{
+	return msg->data.avc->pid;
+}
+
 seaudit_sort_t *seaudit_sort_by_pid(const int direction)
 {
-	return sort_create("pid", sort_pid_comp, sort_pid_support, direction);
+	return sort_create("pid", sort_pid_comp, sort_pid_support, NULL, sort_pid_key, NULL, direction);
 }
 
 static int sort_port_comp(const seaudit_sort_t * sort
@@ -504,9 +825,14 @@ static int sort_port_support(const seaudit_sort_t * sort __attribute__ ((unused)
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->port > 0;
 }
 
+static uint64_t sort_port_key(const seaudit_sort_t * sort __attribute__ ((unused)), const seaudit_message_t * msg)
+{
+	return sort_int_key(msg->data.avc->port);
+}
+
 seaudit_sort_t *seaudit_sort_by_port(const int direction)
 {
-	return sort_create("port", sort_port_comp, sort_port_support, direction);
+	return sort_create("port", sort_port_comp, sort_port_support, NULL, sort_port_key, NULL, direction);
 }
 
 static int sort_laddr_comp(const seaudit_sort_t * sort
@@ -520,9 +846,14 @@ static int sort_laddr_support(const seaudit_sort_t * sort __attribute__ ((unused
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->laddr != NULL;
 }
 
+static const void *sort_laddr_value(const seaudit_message_t * msg)
+{
+	return msg->data.avc->laddr;
+}
+
 seaudit_sort_t *seaudit_sort_by_laddr(const int direction)
 {
-	return sort_create("laddr", sort_laddr_comp, sort_laddr_support, direction);
+	return sort_create_ranked("laddr", sort_laddr_comp, sort_laddr_support, sort_laddr_value, direction);
 }
 
 static int sort_lport_comp(const seaudit_sort_t * sort
@@ -536,9 +867,14 @@ static int sort_lport_support(const seaudit_sort_t * sort __attribute__ ((unused
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->lport > 0;
 }
 
+static uint64_t sort_lport_key(const seaudit_sort_t * sort __attribute__ ((unused)), const seaudit_message_t * msg)
+{
+	return sort_int_key(msg->data.avc->lport);
+}
+
 seaudit_sort_t *seaudit_sort_by_lport(const int direction)
 {
-	return sort_create("lport", sort_lport_comp, sort_lport_support, direction);
+	return sort_create("lport", sort_lport_comp, sort_lport_support, NULL, sort_lport_key, NULL, direction);
 }
 
 static int sort_faddr_comp(const seaudit_sort_t * sort
@@ -552,9 +888,14 @@ static int sort_faddr_support(const seaudit_sort_t * sort __attribute__ ((unused
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->faddr != NULL;
 }
 
+static const void *sort_faddr_value(const seaudit_message_t * msg)
+{
+	return msg->data.avc->faddr;
+}
+
 seaudit_sort_t *seaudit_sort_by_faddr(const int direction)
 {
-	return sort_create("faddr", sort_faddr_comp, sort_faddr_support, direction);
+	return sort_create_ranked("faddr", sort_faddr_comp, sort_faddr_support, sort_faddr_value, direction);
 }
 
 static int sort_fport_comp(const seaudit_sort_t * sort
@@ -568,9 +909,14 @@ static int sort_fport_support(const seaudit_sort_t * sort __attribute__ ((unused
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->fport > 0;
 }
 
+static uint64_t sort_fport_key(const seaudit_sort_t * sort __attribute__ ((unused)), const seaudit_message_t * msg)
+{
+	return sort_int_key(msg->data.avc->fport);
+}
+
 seaudit_sort_t *seaudit_sort_by_fport(const int direction)
 {
-	return sort_create("fport", sort_fport_comp, sort_fport_support, direction);
+	return sort_create("fport", sort_fport_comp, sort_fport_support, NULL, sort_fport_key, NULL, direction);
 }
 
 static int sort_saddr_comp(const seaudit_sort_t * sort
@@ -584,9 +930,14 @@ static int sort_saddr_support(const seaudit_sort_t * sort __attribute__ ((unused
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->saddr != NULL;
 }
 
+static const void *sort_saddr_value(const seaudit_message_t * msg)
+{
+	return msg->data.avc->saddr;
+}
+
 seaudit_sort_t *seaudit_sort_by_saddr(const int direction)
 {
-	return sort_create("saddr", sort_saddr_comp, sort_saddr_support, direction);
+	return sort_create_ranked("saddr", sort_saddr_comp, sort_saddr_support, sort_saddr_value, direction);
 }
 
 static int sort_sport_comp(const seaudit_sort_t * sort
@@ -600,9 +951,14 @@ static int sort_sport_support(const seaudit_sort_t * sort __attribute__ ((unused
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->source > 0;
 }
 
+static uint64_t sort_sport_key(const seaudit_sort_t * sort __attribute__ ((unused)), const seaudit_message_t * msg)
+{
+	return sort_int_key(msg->data.avc->source);
+}
+
 seaudit_sort_t *seaudit_sort_by_sport(const int direction)
 {
-	return sort_create("sport", sort_sport_comp, sort_sport_support, direction);
+	return sort_create("sport", sort_sport_comp, sort_sport_support, NULL, sort_sport_key, NULL, direction);
 }
 
 static int sort_daddr_comp(const seaudit_sort_t * sort
@@ -616,9 +972,14 @@ static int sort_daddr_support(const seaudit_sort_t * sort __attribute__ ((unused
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->daddr != NULL;
 }
 
+static const void *sort_daddr_value(const seaudit_message_t * msg)
+{
+	return msg->data.avc->daddr;
+}
+
 seaudit_sort_t *seaudit_sort_by_daddr(const int direction)
 {
-	return sort_create("daddr", sort_daddr_comp, sort_daddr_support, direction);
+	return sort_create_ranked("daddr", sort_daddr_comp, sort_daddr_support, sort_daddr_value, direction);
 }
 
 static int sort_dport_comp(const seaudit_sort_t * sort
@@ -632,9 +993,14 @@ static int sort_dport_support(const seaudit_sort_t * sort __attribute__ ((unused
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->dest > 0;
 }
 
+static uint64_t sort_dport_key(const seaudit_sort_t * sort __attribute__ ((unused)), const seaudit_message_t * msg)
+{
+	return sort_int_key(msg->data.avc->dest);
+}
+
 seaudit_sort_t *seaudit_sort_by_dport(const int direction)
 {
-	return sort_create("dport", sort_dport_comp, sort_dport_support, direction);
+	return sort_create("dport", sort_dport_comp, sort_dport_support, NULL, sort_dport_key, NULL, direction);
 }
 
 static int sort_key_comp(const seaudit_sort_t * sort
@@ -648,9 +1014,14 @@ static int sort_key_support(const seaudit_sort_t * sort __attribute__ ((unused))
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->is_key;
 }
 
+static uint64_t sort_key_key(const seaudit_sort_t * sort __attribute__ ((unused)), const seaudit_message_t * msg)
+{
+	return sort_int_key(msg->data.avc->key);
+}
+
 seaudit_sort_t *seaudit_sort_by_key(const int direction)
 {
-	return sort_create("key", sort_key_comp, sort_key_support, direction);
+	return sort_create("key", sort_key_comp, sort_key_support, NULL, sort_key_key, NULL, direction);
 }
 
 static int sort_cap_comp(const seaudit_sort_t * sort
@@ -664,9 +1035,14 @@ static int sort_cap_support(const seaudit_sort_t * sort __attribute__ ((unused))
 	return msg->type == SEAUDIT_MESSAGE_TYPE_AVC && msg->data.avc->is_capability;
 }
 
+static uint64_t sort_cap_key(const seaudit_sort_t * sort __attribute__ ((unused)), const seaudit_message_t * msg)
+{
+	return sort_int_key(msg->data.avc->capability);
+}
+
 seaudit_sort_t *seaudit_sort_by_cap(const int direction)
 {
-	return sort_create("cap", sort_cap_comp, sort_cap_support, direction);
+	return sort_create("cap", sort_cap_comp, sort_cap_support, NULL, sort_cap_key, NULL, direction);
 }
 
 /******************** protected functions below ********************/
@@ -733,6 +1109,35 @@ int sort_comp(const seaudit_sort_t * sort, const seaudit_message_t * a, const se
 	return (sort->direction >= 0 ? retval : -1 * retval);
 }
 
+int sort_prepare_keys(const seaudit_log_t * log, seaudit_sort_t * sort, const apol_vector_t * messages)
+{
+	sort_discard_keys(sort);
+	if (sort->prepare != NULL && sort->prepare(log, sort, messages) < 0) {
+		int error = errno;
+		sort_discard_keys(sort);
+		errno = error;
+		return -1;
+	}
+	return 0;
+}
+
+uint64_t sort_get_key(const seaudit_sort_t * sort, const seaudit_message_t * msg)
+{
+	uint64_t key;
+	if (!sort->support(sort, msg)) {
+		return SORT_KEY_UNSUPPORTED;
+	}
+	key = sort->key(sort, msg);
+	return (sort->direction >= 0 ? key : SORT_KEY_MAX - key);
+}
+
+void sort_discard_keys(seaudit_sort_t * sort)
+{
+	free(sort->ranks);
+	sort->ranks = NULL;
+	sort->num_ranks = 0;
+}
+
 const char *sort_get_name(const seaudit_sort_t * sort)
 {
 	return sort->name;
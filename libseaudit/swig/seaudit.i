@@ -298,6 +298,30 @@ typedef struct seaudit_log {} seaudit_log_t;
 	void wrap_clear () {
 		seaudit_log_clear(self);
 	};
+	%rename(set_compact) wrap_set_compact;
+	void wrap_set_compact(bool compact) {
+		BEGIN_EXCEPTION
+		if (seaudit_log_set_compact(self, compact)) {
+			SWIG_exception(SWIG_RuntimeError, "Could not set log storage");
+		}
+		END_EXCEPTION
+	fail:
+		return;
+	};
+	%rename(get_compact) wrap_get_compact;
+	bool wrap_get_compact() {
+		return seaudit_log_get_compact(self);
+	};
+	%rename(refresh_models) wrap_refresh_models;
+	void wrap_refresh_models(unsigned int num_threads) {
+		BEGIN_EXCEPTION
+		if (seaudit_log_refresh_models(self, num_threads)) {
+			SWIG_exception(SWIG_RuntimeError, "Could not refresh models");
+		}
+		END_EXCEPTION
+	fail:
+		return;
+	};
 	%newobject get_users();
 	%rename(get_users) wrap_get_users;
 	apol_string_vector_t *wrap_get_users() {
@@ -626,8 +650,13 @@ typedef struct seaudit_avc_message {} seaudit_avc_message_t;
    be done through a memory buffer. */
 #ifndef SWIGJAVA
 int seaudit_log_parse(seaudit_log_t * log, FILE * syslog);
+int seaudit_log_parse_file(seaudit_log_t * log, FILE * syslog);
+int seaudit_log_parse_file_parallel(seaudit_log_t * log, FILE * syslog, unsigned int num_threads);
 #endif
 int seaudit_log_parse_buffer(seaudit_log_t * log, const char *buffer, const size_t bufsize);
+int seaudit_log_parse_buffer_parallel(seaudit_log_t * log, const char *buffer, const size_t bufsize, unsigned int num_threads);
+int seaudit_log_follow(seaudit_log_t * log, const char *filename);
+int seaudit_log_follow_update(seaudit_log_t * log);
 
 /* seaudit filter */
 typedef enum seaudit_filter_match
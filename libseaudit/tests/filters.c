@@ -32,8 +32,10 @@
 #include <seaudit/model.h>
 #include <seaudit/parse.h>
 
+#include <fnmatch.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 
 #define MESSAGES_NOWARNS TEST_POLICIES "/setools-3.1/seaudit/messages-nowarns"
 
@@ -75,8 +77,113 @@ static void filters_simple()
 	apol_vector_destroy(&v);
 }
 
+#define COMPILED_LINES 300
+
+static const char *compiled_comms[] = { "cat", "cattle", "scat", "ls" };
+static const char *compiled_types[] = { "user_t", "staff_t", "sysadm_t" };
+static const char *compiled_perms[] = { "read", "write", "getattr" };
+static const char *compiled_hosts[] = { "host1", "host2", "host3", "hostx" };
+
+static size_t filters_compiled_count(seaudit_log_t * log, seaudit_model_t * model)
+{
+	apol_vector_t *v = seaudit_model_get_messages(log, model);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+	size_t n = apol_vector_get_size(v);
+	apol_vector_destroy(&v);
+	return n;
+}
+
+static void filters_compiled()
+{
+	/* for each generated line, indices into the above arrays */
+	size_t comm[COMPILED_LINES], type[COMPILED_LINES], perm[COMPILED_LINES], host[COMPILED_LINES];
+	const char *globs[] = { "cat", "cat*", "*cat", "*at*", "*", "?at", "c[a]t*", "\\cat", "**", "" };
+	char line[512];
+	size_t i, j, expected;
+	unsigned int seed = 1;
+
+	seaudit_log_t *log = seaudit_log_create(NULL, NULL);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(log);
+	seaudit_model_t *model = seaudit_model_create(NULL, log);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(model);
+	seaudit_filter_t *f = seaudit_filter_create(NULL);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(f);
+	CU_ASSERT(seaudit_filter_set_strict(f, true) == 0);
+	CU_ASSERT(seaudit_model_append_filter(model, f) == 0);
+
+	for (i = 0; i < COMPILED_LINES; i++) {
+		seed = seed * 1103515245 + 12345;
+		comm[i] = seed / 16 % 4;
+		type[i] = seed / 64 % 3;
+		perm[i] = seed / 256 % 3;
+		host[i] = seed / 1024 % 4;
+		snprintf(line, sizeof(line), "Jun 12 10:00:%02zu %s kernel: avc:  denied  { %s } for  pid=%zu comm=\"%s\" "
+			 "exe=/usr/bin/%s scontext=user_u:system_r:%s tcontext=system_u:object_r:etc_t tclass=file\n", i % 60,
+			 compiled_hosts[host[i]], compiled_perms[perm[i]], i + 1, compiled_comms[comm[i]], compiled_comms[comm[i]],
+			 compiled_types[type[i]]);
+		CU_ASSERT(seaudit_log_parse_buffer(log, line, strlen(line)) == 0);
+	}
+
+	/* each kind of glob expression must agree with fnmatch() */
+	for (j = 0; j < sizeof(globs) / sizeof(globs[0]); j++) {
+		CU_ASSERT(seaudit_filter_set_command(f, globs[j]) == 0);
+		for (i = expected = 0; i < COMPILED_LINES; i++) {
+			expected += (fnmatch(globs[j], compiled_comms[comm[i]], 0) == 0);
+		}
+		CU_ASSERT(filters_compiled_count(log, model) == expected);
+	}
+	CU_ASSERT(seaudit_filter_set_command(f, NULL) == 0);
+
+	CU_ASSERT(seaudit_filter_set_executable(f, "/usr/bin/*at*") == 0);
+	for (i = expected = 0; i < COMPILED_LINES; i++) {
+		expected += (strstr(compiled_comms[comm[i]], "at") != NULL);
+	}
+	CU_ASSERT(filters_compiled_count(log, model) == expected);
+	CU_ASSERT(seaudit_filter_set_executable(f, NULL) == 0);
+
+	/* permissions and hosts are matched against the log's strings */
+	CU_ASSERT(seaudit_filter_set_permission(f, "*t*") == 0);
+	for (i = expected = 0; i < COMPILED_LINES; i++) {
+		expected += (strchr(compiled_perms[perm[i]], 't') != NULL);
+	}
+	CU_ASSERT(filters_compiled_count(log, model) == expected);
+	CU_ASSERT(seaudit_filter_set_permission(f, NULL) == 0);
+
+	CU_ASSERT(seaudit_filter_set_host(f, "host[12]") == 0);
+	for (i = expected = 0; i < COMPILED_LINES; i++) {
+		expected += (host[i] == 0 || host[i] == 1);
+	}
+	CU_ASSERT(filters_compiled_count(log, model) == expected);
+	CU_ASSERT(seaudit_filter_set_host(f, NULL) == 0);
+
+	/* a type that the log has not yet seen must match once it
+	 * appears */
+	apol_vector_t *v = apol_str_split("staff_t:new_t", ":");
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+	CU_ASSERT(seaudit_filter_set_source_type(f, v) == 0);
+	apol_vector_destroy(&v);
+	for (i = expected = 0; i < COMPILED_LINES; i++) {
+		expected += (type[i] == 1);
+	}
+	CU_ASSERT(filters_compiled_count(log, model) == expected);
+	snprintf(line, sizeof(line), "Jun 12 10:01:00 host1 kernel: avc:  denied  { read } for  pid=1 comm=\"cat\" "
+		 "scontext=user_u:system_r:new_t tcontext=system_u:object_r:etc_t tclass=file\n");
+	CU_ASSERT(seaudit_log_parse_buffer(log, line, strlen(line)) == 0);
+	CU_ASSERT(filters_compiled_count(log, model) == expected + 1);
+
+	/* after clearing the log its strings are gone */
+	seaudit_log_clear(log);
+	CU_ASSERT(filters_compiled_count(log, model) == 0);
+	CU_ASSERT(seaudit_log_parse_buffer(log, line, strlen(line)) == 0);
+	CU_ASSERT(filters_compiled_count(log, model) == 1);
+
+	seaudit_model_destroy(&model);
+	seaudit_log_destroy(&log);
+}
+
 CU_TestInfo filters_tests[] = {
 	{"simple filter", filters_simple},
+	{"compiled criteria", filters_compiled},
 	CU_TEST_INFO_NULL
 };
 
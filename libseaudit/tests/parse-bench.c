@@ -0,0 +1,140 @@
+/**
+ *  @file
+ *
+ *  Throughput benchmark for the audit log parser.  Run as
+ *  "parse-bench [number of lines]"; a synthetic log is generated in
+ *  memory and the time to parse it is written to standard output.
+ *
+ *  @author agent agent@local
+ *
+ *  Copyright (C) 2026 agent
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <config.h>
+
+#include <seaudit/log.h>
+#include <seaudit/parse.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char *bench_types[] = { "httpd_t", "sshd_t", "user_t", "var_log_t", "etc_t", "tmp_t", "home_root_t" };
+static const char *bench_perms[] = { "read", "write", "getattr", "open", "search", "{ read write }", "{ create unlink }" };
+
+#define BENCH_NUM(a) (sizeof(a) / sizeof(a[0]))
+
+static void bench_quiet(void *arg __attribute__ ((unused)), const seaudit_log_t * log __attribute__ ((unused)),
+			int level __attribute__ ((unused)), const char *fmt __attribute__ ((unused)),
+			va_list va_args __attribute__ ((unused)))
+{
+}
+
+static double bench_elapsed(const struct timespec *start)
+{
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (double)(end.tv_sec - start->tv_sec) + (double)(end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * Append one line to the log: mostly AVC denials in both syslog and
+ * auditd formats, along with unrelated lines that must be skipped.
+ */
+static int bench_append_line(FILE * f, size_t i)
+{
+	const char *perm = bench_perms[random() % BENCH_NUM(bench_perms)];
+	const char *stype = bench_types[random() % BENCH_NUM(bench_types)];
+	const char *ttype = bench_types[random() % BENCH_NUM(bench_types)];
+	switch (random() % 4) {
+	case 0:
+		return fprintf(f, "Jun %2zu 10:%02zu:%02zu host%zu kernel: audit(1150000000.%03zu:%zu): avc:  denied  { %s } "
+			       "for  pid=%ld comm=\"cat\" name=\"file%zu\" dev=dm-0 ino=%zu scontext=user_u:system_r:%s "
+			       "tcontext=system_u:object_r:%s tclass=file\n", i % 28 + 1, i % 60, i % 60, i % 4, i % 1000, i,
+			       perm[0] == '{' ? perm + 2 : perm, random() % 32768, i % 100, i, stype, ttype);
+	case 1:
+		return fprintf(f, "type=AVC msg=audit(1150000000.%03zu:%zu): avc:  denied  %s for  pid=%ld comm=\"ls\" "
+			       "path=\"/var/lib/dir%zu\" dev=sda1 ino=%zu scontext=system_u:system_r:%s:s0 "
+			       "tcontext=system_u:object_r:%s:s0 tclass=dir\n", i % 1000, i,
+			       perm[0] == '{' ? perm : "{ search }", random() % 32768, i % 100, i, stype, ttype);
+	case 2:
+		return fprintf(f, "type=SYSCALL msg=audit(1150000000.%03zu:%zu): arch=c000003e syscall=2 success=no exit=-13 "
+			       "a0=7fff a1=0 a2=1b6 items=0 ppid=1 pid=%ld uid=0 gid=0 comm=\"cat\" exe=\"/bin/cat\"\n", i % 1000, i,
+			       random() % 32768);
+	default:
+		return fprintf(f, "Jun %2zu 10:%02zu:%02zu host%zu sshd[%ld]: Accepted publickey for user from 10.0.0.%zu\n",
+			       i % 28 + 1, i % 60, i % 60, i % 4, random() % 32768, i % 255);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	size_t n = 1000000, i, size;
+	char *buf = NULL;
+	FILE *f;
+	struct timespec start;
+	seaudit_log_t *log;
+	double secs;
+
+	if (argc > 1) {
+		n = strtoul(argv[1], NULL, 10);
+	}
+	srandom(1);
+	if ((f = open_memstream(&buf, &size)) == NULL) {
+		perror("open_memstream");
+		return 1;
+	}
+	for (i = 0; i < n; i++) {
+		if (bench_append_line(f, i) < 0) {
+			perror("fprintf");
+			return 1;
+		}
+	}
+	fclose(f);
+
+	if ((log = seaudit_log_create(bench_quiet, NULL)) == NULL) {
+		perror("seaudit_log_create");
+		return 1;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if (seaudit_log_parse_buffer(log, buf, size) < 0) {
+		perror("seaudit_log_parse_buffer");
+		return 1;
+	}
+	secs = bench_elapsed(&start);
+	printf("parse_buffer %10zu lines %8.1f MB %8.3f s %10.0f lines/s %8.1f MB/s\n", n, size / 1e6, secs, n / secs,
+	       size / 1e6 / secs);
+	seaudit_log_destroy(&log);
+
+	if ((log = seaudit_log_create(bench_quiet, NULL)) == NULL || (f = fmemopen(buf, size, "r")) == NULL) {
+		perror("seaudit_log_create");
+		return 1;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if (seaudit_log_parse(log, f) < 0) {
+		perror("seaudit_log_parse");
+		return 1;
+	}
+	secs = bench_elapsed(&start);
+	printf("parse        %10zu lines %8.1f MB %8.3f s %10.0f lines/s %8.1f MB/s\n", n, size / 1e6, secs, n / secs,
+	       size / 1e6 / secs);
+	fclose(f);
+	seaudit_log_destroy(&log);
+	free(buf);
+	return 0;
+}
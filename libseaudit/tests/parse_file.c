@@ -26,11 +26,17 @@
 #include <config.h>
 
 #include <CUnit/CUnit.h>
+#include <seaudit/avc_message.h>
 #include <seaudit/log.h>
+#include <seaudit/model.h>
 #include <seaudit/parse.h>
+#include <seaudit/report.h>
 
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 struct log_answer
 {
@@ -54,8 +60,39 @@ static void parse_file_test(const struct log_answer *la)
 		CU_ASSERT(retval == 0);
 	}
 
+	/* memory-mapped parsing must find the same messages */
+	seaudit_log_t *ml = seaudit_log_create(NULL, NULL);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(ml);
+	seaudit_model_t *m = seaudit_model_create(NULL, l);
+	seaudit_model_t *mm = seaudit_model_create(NULL, ml);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(m);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(mm);
+	rewind(f);
+	retval = seaudit_log_parse_file(ml, f);
+	if (la->has_warnings) {
+		CU_ASSERT(retval > 0);
+	} else {
+		CU_ASSERT(retval == 0);
+	}
+	apol_vector_t *v = seaudit_model_get_messages(l, m), *mv = seaudit_model_get_messages(ml, mm);
+	CU_ASSERT(v != NULL && mv != NULL && apol_vector_get_size(v) == apol_vector_get_size(mv));
+	apol_vector_destroy(&v);
+	apol_vector_destroy(&mv);
+	v = seaudit_model_get_malformed_messages(l, m);
+	mv = seaudit_model_get_malformed_messages(ml, mm);
+	CU_ASSERT(v != NULL && mv != NULL && apol_vector_get_size(v) == apol_vector_get_size(mv));
+	apol_vector_destroy(&v);
+	apol_vector_destroy(&mv);
+
+	/* nothing new was appended, so nothing more is parsed */
+	retval = seaudit_log_parse_file(ml, f);
+	CU_ASSERT(retval == 0);
+
 	fclose(f);
+	seaudit_model_destroy(&m);
+	seaudit_model_destroy(&mm);
 	seaudit_log_destroy(&l);
+	seaudit_log_destroy(&ml);
 }
 
 static void parse_file_fc4()
@@ -94,11 +131,817 @@ static void parse_file_warnings()
 	parse_file_test(&l);
 }
 
+static void parse_buffer_lines()
+{
+	/* lines that only look like SELinux messages once split up
+	 * must be skipped, and a malformed message must be kept
+	 * intact */
+	const char *buffer =
+		"Jun 12 10:00:00 host kernel: eth0: avc:\n"
+		"Jun 12 10:00:00 host kernel: committed  booleans { a:1 }\n"
+		"Jun 12 10:00:00 host sshd[1]: avc:  denied  { read } for pid=1\n"
+		"type=AVC msg=audit(1150000000.123:42): avc:  denied  { read write } for  pid=1 comm=\"cat\" "
+		"scontext=user_u:system_r:user_t tcontext=system_u:object_r:etc_t tclass=file\n"
+		"\n"
+		"  Jun 12 10:00:01 host kernel: security: committed booleans { a:1, b:0 }\t\n"
+		"type=AVC msg=audit(1150000000.124:43): avc:  denied  { read } for  pid=1 bogus";
+	seaudit_log_t *l = seaudit_log_create(NULL, NULL);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(l);
+	seaudit_model_t *m = seaudit_model_create(NULL, l);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(m);
+
+	int retval = seaudit_log_parse_buffer(l, buffer, strlen(buffer));
+	CU_ASSERT(retval > 0);
+
+	apol_vector_t *v = seaudit_model_get_messages(l, m);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+	CU_ASSERT(apol_vector_get_size(v) == 3);
+	apol_vector_destroy(&v);
+	v = seaudit_model_get_malformed_messages(l, m);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+	CU_ASSERT(apol_vector_get_size(v) == 1);
+	if (apol_vector_get_size(v) == 1) {
+		CU_ASSERT_STRING_EQUAL(apol_vector_get_element(v, 0),
+				       "type=AVC msg=audit(1150000000.124:43): avc:  denied  { read } for  pid=1 bogus");
+	}
+	apol_vector_destroy(&v);
+
+	seaudit_model_destroy(&m);
+	seaudit_log_destroy(&l);
+}
+
+static void parse_buffer_parallel()
+{
+	/* messages spanning several lines are repeated enough times
+	 * that some are divided among threads */
+	const char *lines[] = {
+		"Jun 12 10:00:00 host kernel: security: committed booleans { a:1,\n",
+		"Jun 12 10:00:00 host kernel: b:0,\n",
+		"Jun 12 10:00:00 host kernel: c:1 }\n",
+		"Jun 12 10:00:01 host2 kernel: security:  3 users, 6 roles, 1331 types, 135 bools\n",
+		"Jun 12 10:00:01 host2 kernel: security:  55 classes, 19919 rules\n",
+		"type=AVC msg=audit(1150000000.123:42): avc:  denied  { read write } for  pid=1 comm=\"cat\" "
+			"scontext=user_u:system_r:user_t:s0 tcontext=system_u:object_r:etc_t:s0-s1 tclass=file\n",
+		"Jun 12 10:00:02 host kernel: eth0: link up\n",
+		"Jun 12 10:00:03 host kernel: security: committed booleans { d:1\n",
+		"Jun 12 10:00:03 host kernel: avc:  denied  { getattr } for  pid=2 "
+			"scontext=root:system_r:init_t:s0 tcontext=root:object_r:var_t:s0 tclass=dir\n",
+		"type=AVC msg=audit(1150000000.124:43): avc:  denied  { read } for  pid=1 bogus "
+			"scontext=user_u:system_r:user_t:s0 tcontext=user_u:system_r:user_t:s0 tclass=process\n"
+	};
+	const size_t num_lines = sizeof(lines) / sizeof(lines[0]);
+	size_t bufsize = 0, len, i;
+	char *buffer = NULL;
+
+	/* vary which line starts each repetition */
+	for (i = 0; bufsize < 4 * 1024 * 1024; i++) {
+		const char *line = lines[(i + i / 7) % num_lines];
+		len = strlen(line);
+		buffer = realloc(buffer, bufsize + len);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(buffer);
+		memcpy(buffer + bufsize, line, len);
+		bufsize += len;
+	}
+
+	seaudit_log_t *l = seaudit_log_create(NULL, NULL), *pl = seaudit_log_create(NULL, NULL);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(l);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(pl);
+	seaudit_model_t *m = seaudit_model_create(NULL, l), *pm = seaudit_model_create(NULL, pl);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(m);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(pm);
+
+	int retval = seaudit_log_parse_buffer(l, buffer, bufsize);
+	CU_ASSERT(retval > 0);
+	retval = seaudit_log_parse_buffer_parallel(pl, buffer, bufsize, 4);
+	CU_ASSERT(retval > 0);
+
+	apol_vector_t *v = seaudit_model_get_messages(l, m), *pv = seaudit_model_get_messages(pl, pm);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(pv);
+	CU_ASSERT_FATAL(apol_vector_get_size(v) == apol_vector_get_size(pv));
+	for (i = 0; i < apol_vector_get_size(v); i++) {
+		char *s = seaudit_message_to_string(apol_vector_get_element(v, i));
+		char *ps = seaudit_message_to_string(apol_vector_get_element(pv, i));
+		CU_ASSERT(s != NULL && ps != NULL && strcmp(s, ps) == 0);
+		free(s);
+		free(ps);
+	}
+	apol_vector_destroy(&v);
+	apol_vector_destroy(&pv);
+
+	v = seaudit_model_get_malformed_messages(l, m);
+	pv = seaudit_model_get_malformed_messages(pl, pm);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(pv);
+	CU_ASSERT_FATAL(apol_vector_get_size(v) == apol_vector_get_size(pv));
+	for (i = 0; i < apol_vector_get_size(v); i++) {
+		CU_ASSERT_STRING_EQUAL(apol_vector_get_element(v, i), apol_vector_get_element(pv, i));
+	}
+	apol_vector_destroy(&v);
+	apol_vector_destroy(&pv);
+
+	v = seaudit_log_get_types(l);
+	pv = seaudit_log_get_types(pl);
+	CU_ASSERT(v != NULL && pv != NULL && apol_vector_get_size(v) == apol_vector_get_size(pv));
+	apol_vector_destroy(&v);
+	apol_vector_destroy(&pv);
+
+	seaudit_model_destroy(&m);
+	seaudit_model_destroy(&pm);
+	seaudit_log_destroy(&l);
+	seaudit_log_destroy(&pl);
+	free(buffer);
+}
+
+/**
+ * Assert that two models show identical messages and malformed
+ * messages.
+ */
+static void parse_compare_models(seaudit_log_t * l, seaudit_model_t * m, seaudit_log_t * l2, seaudit_model_t * m2)
+{
+	size_t i;
+	apol_vector_t *v = seaudit_model_get_messages(l, m), *v2 = seaudit_model_get_messages(l2, m2);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v2);
+	CU_ASSERT_FATAL(apol_vector_get_size(v) == apol_vector_get_size(v2));
+	for (i = 0; i < apol_vector_get_size(v); i++) {
+		char *s = seaudit_message_to_string(apol_vector_get_element(v, i));
+		char *s2 = seaudit_message_to_string(apol_vector_get_element(v2, i));
+		CU_ASSERT(s != NULL && s2 != NULL && strcmp(s, s2) == 0);
+		free(s);
+		free(s2);
+	}
+	apol_vector_destroy(&v);
+	apol_vector_destroy(&v2);
+
+	v = seaudit_model_get_malformed_messages(l, m);
+	v2 = seaudit_model_get_malformed_messages(l2, m2);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v2);
+	CU_ASSERT_FATAL(apol_vector_get_size(v) == apol_vector_get_size(v2));
+	for (i = 0; i < apol_vector_get_size(v); i++) {
+		CU_ASSERT_STRING_EQUAL(apol_vector_get_element(v, i), apol_vector_get_element(v2, i));
+	}
+	apol_vector_destroy(&v);
+	apol_vector_destroy(&v2);
+}
+
+static void parse_compact()
+{
+	const char *comms[] = { "cat", "ls", "vi" };
+	const char *perms[] = { "read", "read write", "getattr", "read write append" };
+	const char *paths[] = { "/etc/passwd", "/tmp/a file with spaces", "/var/log/messages" };
+	char line[512];
+	size_t bufsize = 0, len, i;
+	char *buffer = NULL;
+	unsigned int seed = 1;
+
+	for (i = 0; bufsize < 2 * 1024 * 1024; i++) {
+		seed = seed * 1103515245 + 12345;
+		switch (seed / 16 % 4) {
+		case 0:
+			snprintf(line, sizeof(line), "Jun 12 10:%02zu:%02zu host%u kernel: security: committed booleans { b%u:1 }\n",
+				 i / 60 % 60, i % 60, seed / 64 % 3, seed / 256 % 10);
+			break;
+		case 1:
+			snprintf(line, sizeof(line), "Jun 12 10:%02zu:%02zu host%u kernel: avc:  denied  { %s } for  pid=%zu "
+				 "comm=\"%s\" exe=/usr/bin/%s path=%s dev=sda%u ino=%zu "
+				 "scontext=user_u:system_r:user_t:s0 tcontext=system_u:object_r:etc_t:s0 tclass=file\n", i / 60 % 60, i % 60,
+				 seed / 64 % 3, perms[seed / 256 % 4], i, comms[seed / 1024 % 3], comms[seed / 1024 % 3],
+				 paths[seed / 4096 % 3], seed / 8192 % 2, i);
+			break;
+		case 2:
+			snprintf(line, sizeof(line), "type=AVC msg=audit(%zu.000:%zu): avc:  granted  { %s } for  pid=%zu "
+				 "comm=\"%s\" laddr=10.0.0.%u lport=%u faddr=10.0.1.%u fport=80 netif=eth%u "
+				 "scontext=user_u:system_r:user_t:s0 tcontext=system_u:object_r:port_t:s0 tclass=tcp_socket\n",
+				 1150000000 + i, i, perms[seed / 256 % 4], i, comms[seed / 1024 % 3], seed / 64 % 4,
+				 1024 + seed / 4096 % 8, seed / 32768 % 4, seed / 65536 % 2);
+			break;
+		default:
+			/* has no permissions at all */
+			snprintf(line, sizeof(line), "type=AVC msg=audit(%zu.000:%zu): avc:  denied  for  pid=%zu "
+				 "scontext=user_u:system_r:user_t:s0 tcontext=user_u:system_r:user_t:s0 tclass=process\n",
+				 1150000000 + i, i, i);
+			break;
+		}
+		len = strlen(line);
+		buffer = realloc(buffer, bufsize + len);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(buffer);
+		memcpy(buffer + bufsize, line, len);
+		bufsize += len;
+	}
+
+	seaudit_log_t *l = seaudit_log_create(NULL, NULL), *cl = seaudit_log_create(NULL, NULL), *pl =
+		seaudit_log_create(NULL, NULL);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(l);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(cl);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(pl);
+	CU_ASSERT(seaudit_log_get_compact(cl) == false);
+	CU_ASSERT(seaudit_log_set_compact(cl, true) == 0);
+	CU_ASSERT(seaudit_log_set_compact(pl, true) == 0);
+	CU_ASSERT(seaudit_log_get_compact(cl) == true);
+	seaudit_model_t *m = seaudit_model_create(NULL, l), *cm = seaudit_model_create(NULL, cl), *pm = seaudit_model_create(NULL, pl);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(m);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(cm);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(pm);
+
+	int retval = seaudit_log_parse_buffer(l, buffer, bufsize);
+	CU_ASSERT(retval == seaudit_log_parse_buffer(cl, buffer, bufsize));
+	CU_ASSERT(retval == seaudit_log_parse_buffer_parallel(pl, buffer, bufsize, 4));
+	parse_compare_models(l, m, cl, cm);
+	parse_compare_models(l, m, pl, pm);
+
+	/* compact logs share strings and permission lists among
+	 * messages */
+	apol_vector_t *v = seaudit_model_get_messages(pl, pm);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+	const seaudit_avc_message_t *first[3] = { NULL, NULL, NULL };
+	size_t num_shared = 0;
+	for (i = 0; i < apol_vector_get_size(v); i++) {
+		seaudit_message_type_e type;
+		const seaudit_avc_message_t *avc = seaudit_message_get_data(apol_vector_get_element(v, i), &type);
+		const char *exe;
+		if (type != SEAUDIT_MESSAGE_TYPE_AVC || (exe = seaudit_avc_message_get_exe(avc)) == NULL) {
+			continue;
+		}
+		size_t j = (exe[9] == 'c' ? 0 : exe[9] == 'l' ? 1 : 2);
+		if (first[j] == NULL) {
+			first[j] = avc;
+		} else {
+			CU_ASSERT(exe == seaudit_avc_message_get_exe(first[j]));
+			CU_ASSERT(seaudit_avc_message_get_comm(avc) == seaudit_avc_message_get_comm(first[j]));
+			if (apol_vector_compare(seaudit_avc_message_get_perm(avc), seaudit_avc_message_get_perm(first[j]), NULL, NULL, &len)
+			    == 0) {
+				CU_ASSERT(seaudit_avc_message_get_perm(avc) == seaudit_avc_message_get_perm(first[j]));
+				num_shared++;
+			}
+		}
+	}
+	CU_ASSERT(num_shared > 0);
+	apol_vector_destroy(&v);
+
+	/* storage may only change while the log is empty */
+	CU_ASSERT(seaudit_log_set_compact(cl, false) < 0);
+	seaudit_log_clear(cl);
+	CU_ASSERT(seaudit_log_set_compact(cl, false) == 0);
+	CU_ASSERT(seaudit_log_parse_buffer(cl, buffer, bufsize) == retval);
+	parse_compare_models(l, m, cl, cm);
+
+	seaudit_model_destroy(&m);
+	seaudit_model_destroy(&cm);
+	seaudit_model_destroy(&pm);
+	seaudit_log_destroy(&l);
+	seaudit_log_destroy(&cl);
+	seaudit_log_destroy(&pl);
+	free(buffer);
+}
+
+static void parse_follow_append(const char *path, const char *mode, const char *text)
+{
+	FILE *f = fopen(path, mode);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(f);
+	CU_ASSERT(fputs(text, f) >= 0);
+	CU_ASSERT(fclose(f) == 0);
+}
+
+static size_t parse_follow_num_messages(seaudit_log_t * l, seaudit_model_t * m)
+{
+	apol_vector_t *v = seaudit_model_get_messages(l, m);
+	size_t n;
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+	n = apol_vector_get_size(v);
+	apol_vector_destroy(&v);
+	return n;
+}
+
+static void parse_follow()
+{
+	const char *deny = "type=AVC msg=audit(1150000000.123:42): avc:  denied  { read } for  pid=1 comm=\"cat\" "
+		"scontext=user_u:system_r:user_t:s0 tcontext=system_u:object_r:etc_t:s0 tclass=file\n";
+	const char *grant = "type=AVC msg=audit(1150000001.123:43): avc:  granted  { write } for  pid=2 comm=\"ls\" "
+		"scontext=user_u:system_r:user_t:s0 tcontext=system_u:object_r:etc_t:s0 tclass=file\n";
+	const char *boolm = "Jun 12 10:00:00 host kernel: security: committed booleans { a:1, b:0 }\n";
+	char path[] = "/tmp/seaudit-follow-XXXXXX", rotated[64];
+	int fd = mkstemp(path);
+	CU_ASSERT_FATAL(fd >= 0);
+	close(fd);
+	snprintf(rotated, sizeof(rotated), "%s.1", path);
+
+	seaudit_log_t *l = seaudit_log_create(NULL, NULL);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(l);
+	seaudit_model_t *m = seaudit_model_create(NULL, l), *fm = seaudit_model_create(NULL, l);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(m);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(fm);
+	seaudit_sort_t *sort = seaudit_sort_by_date(-1);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(sort);
+	CU_ASSERT(seaudit_model_append_sort(m, sort) == 0);
+	seaudit_filter_t *filter = seaudit_filter_create(NULL);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(filter);
+	CU_ASSERT(seaudit_filter_set_command(filter, "cat") == 0);
+	CU_ASSERT(seaudit_filter_set_strict(filter, true) == 0);
+	CU_ASSERT(seaudit_model_append_filter(fm, filter) == 0);
+
+	/* a trailing partial line is not parsed until it is finished */
+	parse_follow_append(path, "w", deny);
+	parse_follow_append(path, "a", grant);
+	parse_follow_append(path, "a", "type=AVC msg=audit(1150000002.123:44): avc:  denied  { getattr } for  pid=3 ");
+	CU_ASSERT(seaudit_log_follow(l, path) == 0);
+	CU_ASSERT(seaudit_log_follow_update(l) == 0);
+	CU_ASSERT(parse_follow_num_messages(l, m) == 2);
+	CU_ASSERT(parse_follow_num_messages(l, fm) == 1);
+	CU_ASSERT(seaudit_model_is_changed(m) == 0);
+	CU_ASSERT(seaudit_log_follow_update(l) == 0);
+	CU_ASSERT(seaudit_model_is_changed(m) == 0);
+
+	parse_follow_append(path, "a", "comm=\"cat\" scontext=user_u:system_r:user_t:s0 "
+			    "tcontext=system_u:object_r:etc_t:s0 tclass=file\n");
+	parse_follow_append(path, "a", boolm);
+	CU_ASSERT(seaudit_log_follow_update(l) == 0);
+	CU_ASSERT(seaudit_model_is_changed(m) != 0);
+	CU_ASSERT(parse_follow_num_messages(l, m) == 4);
+	CU_ASSERT(parse_follow_num_messages(l, fm) == 2);
+	CU_ASSERT(seaudit_model_get_num_denies(l, m) == 2);
+	CU_ASSERT(seaudit_model_get_num_allows(l, m) == 1);
+	CU_ASSERT(seaudit_model_get_num_bools(l, m) == 1);
+
+	/* rotate the log; the unterminated last line of the old file
+	 * is still parsed */
+	parse_follow_append(path, "a", grant);
+	parse_follow_append(path, "a", "Jun 12 10:00:01 host kernel: security: committed booleans { c:1 }");
+	CU_ASSERT(rename(path, rotated) == 0);
+	parse_follow_append(path, "w", deny);
+	parse_follow_append(path, "a", deny);
+	CU_ASSERT(seaudit_log_follow_update(l) == 0);
+	CU_ASSERT(parse_follow_num_messages(l, m) == 8);
+	CU_ASSERT(parse_follow_num_messages(l, fm) == 4);
+	CU_ASSERT(seaudit_model_get_num_denies(l, m) == 4);
+	CU_ASSERT(seaudit_model_get_num_bools(l, m) == 2);
+
+	/* truncate the log in place */
+	parse_follow_append(path, "w", boolm);
+	CU_ASSERT(seaudit_log_follow_update(l) == 0);
+	CU_ASSERT(parse_follow_num_messages(l, m) == 9);
+	CU_ASSERT(seaudit_model_get_num_bools(l, m) == 3);
+
+	/* the incrementally updated models agree with new ones */
+	seaudit_model_t *m2 = seaudit_model_create_from_model(m), *fm2 = seaudit_model_create_from_model(fm);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(m2);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(fm2);
+	apol_vector_t *v = seaudit_model_get_messages(l, m), *v2 = seaudit_model_get_messages(l, m2);
+	CU_ASSERT(v != NULL && v2 != NULL && apol_vector_compare(v, v2, NULL, NULL, NULL) == 0);
+	apol_vector_destroy(&v);
+	apol_vector_destroy(&v2);
+	v = seaudit_model_get_messages(l, fm);
+	v2 = seaudit_model_get_messages(l, fm2);
+	CU_ASSERT(v != NULL && v2 != NULL && apol_vector_compare(v, v2, NULL, NULL, NULL) == 0);
+	apol_vector_destroy(&v);
+	apol_vector_destroy(&v2);
+
+	seaudit_model_destroy(&m);
+	seaudit_model_destroy(&fm);
+	seaudit_model_destroy(&m2);
+	seaudit_model_destroy(&fm2);
+	seaudit_log_destroy(&l);
+	unlink(path);
+	unlink(rotated);
+}
+
+static int model_incremental_strcmp(const void *a, const void *b, void *data __attribute__ ((unused)))
+{
+	return strcmp(a, b);
+}
+
+/**
+ * Check that an incrementally updated model holds the same messages,
+ * in the same order, and statistics as a newly calculated one.
+ */
+static void model_incremental_compare(seaudit_log_t * l, seaudit_model_t * m, const apol_vector_t * hidden)
+{
+	seaudit_model_t *m2 = seaudit_model_create_from_model(m);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(m2);
+	size_t i;
+	for (i = 0; i < apol_vector_get_size(hidden); i++) {
+		seaudit_model_hide_message(m2, apol_vector_get_element(hidden, i));
+	}
+	apol_vector_t *v = seaudit_model_get_messages(l, m), *v2 = seaudit_model_get_messages(l, m2);
+	apol_vector_t *s = apol_vector_create(free), *s2 = apol_vector_create(free);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v2);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(s);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(s2);
+	CU_ASSERT_FATAL(apol_vector_get_size(v) == apol_vector_get_size(v2));
+	for (i = 0; i < apol_vector_get_size(v); i++) {
+		CU_ASSERT(apol_vector_get_element(v, i) == apol_vector_get_element(v2, i));
+		CU_ASSERT(apol_vector_append(s, seaudit_message_to_string(apol_vector_get_element(v, i))) == 0);
+		CU_ASSERT(apol_vector_append(s2, seaudit_message_to_string(apol_vector_get_element(v2, i))) == 0);
+	}
+	CU_ASSERT(apol_vector_compare(s, s2, model_incremental_strcmp, NULL, &i) == 0);
+	CU_ASSERT(seaudit_model_get_num_allows(l, m) == seaudit_model_get_num_allows(l, m2));
+	CU_ASSERT(seaudit_model_get_num_denies(l, m) == seaudit_model_get_num_denies(l, m2));
+	CU_ASSERT(seaudit_model_get_num_bools(l, m) == seaudit_model_get_num_bools(l, m2));
+	CU_ASSERT(seaudit_model_get_num_loads(l, m) == seaudit_model_get_num_loads(l, m2));
+	apol_vector_destroy(&v);
+	apol_vector_destroy(&v2);
+	apol_vector_destroy(&s);
+	apol_vector_destroy(&s2);
+	seaudit_model_destroy(&m2);
+}
+
+static void model_incremental()
+{
+	const char *comms[] = { "cat", "ls", "vi" };
+	char line[512];
+	size_t i, part;
+	unsigned int seed = 1;
+
+	seaudit_log_t *l = seaudit_log_create(NULL, NULL);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(l);
+	seaudit_model_t *m = seaudit_model_create(NULL, l), *u = seaudit_model_create(NULL, l), *fm = seaudit_model_create(NULL, l);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(m);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(u);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(fm);
+	seaudit_sort_t *sort = seaudit_sort_by_date(1);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(sort);
+	CU_ASSERT(seaudit_model_append_sort(m, sort) == 0);
+	sort = seaudit_sort_by_date(-1);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(sort);
+	CU_ASSERT(seaudit_model_append_sort(fm, sort) == 0);
+	seaudit_filter_t *filter = seaudit_filter_create(NULL);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(filter);
+	CU_ASSERT(seaudit_filter_set_command(filter, "cat") == 0);
+	CU_ASSERT(seaudit_filter_set_strict(filter, true) == 0);
+	CU_ASSERT(seaudit_model_append_filter(fm, filter) == 0);
+	apol_vector_t *hidden = apol_vector_create(NULL);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(hidden);
+
+	for (part = 0; part < 5; part++) {
+		for (i = 0; i < 200; i++) {
+			seed = seed * 1103515245 + 12345;
+			if (seed % 10 == 0) {
+				snprintf(line, sizeof(line), "Jun %u 10:00:%02u host kernel: security: committed booleans { b%u:1 }\n",
+					 10 + seed / 16 % 5, seed / 128 % 60, seed / 1024 % 10);
+			} else {
+				snprintf(line, sizeof(line), "type=AVC msg=audit(%u.000:%zu): avc:  %s  { read } for  pid=%u comm=\"%s\" "
+					 "scontext=user_u:system_r:user_t:s0 tcontext=system_u:object_r:etc_t:s0 tclass=file\n",
+					 1149940800 + seed / 16 % 259200, part * 200 + i, (seed / 8 % 2 ? "denied" : "granted"),
+					 seed / 256 % 1000, comms[seed / 4096 % 3]);
+			}
+			CU_ASSERT(seaudit_log_parse_buffer(l, line, strlen(line)) == 0);
+		}
+		apol_vector_t *v = seaudit_model_get_messages(l, m);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+		/* syslog dates lack years, so compare only the rest */
+		long prev = 0;
+		for (i = 0; i < apol_vector_get_size(v); i++) {
+			const struct tm *t = seaudit_message_get_time(apol_vector_get_element(v, i));
+			long cur = (((t->tm_mon * 32L + t->tm_mday) * 24 + t->tm_hour) * 60 + t->tm_min) * 60 + t->tm_sec;
+			CU_ASSERT(cur >= prev);
+			prev = cur;
+		}
+		/* hide messages from models that are up to date */
+		for (i = part; i < apol_vector_get_size(v); i += 7) {
+			seaudit_message_t *msg = apol_vector_get_element(v, i);
+			seaudit_model_hide_message(m, msg);
+			seaudit_model_hide_message(u, msg);
+			seaudit_model_hide_message(fm, msg);
+			CU_ASSERT(apol_vector_append(hidden, msg) == 0);
+		}
+		CU_ASSERT(seaudit_model_is_changed(m) != 0);
+		apol_vector_destroy(&v);
+		v = seaudit_model_get_messages(l, u);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+		apol_vector_destroy(&v);
+		v = seaudit_model_get_messages(l, fm);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+		apol_vector_destroy(&v);
+	}
+	model_incremental_compare(l, m, hidden);
+	model_incremental_compare(l, u, hidden);
+	model_incremental_compare(l, fm, hidden);
+
+	apol_vector_destroy(&hidden);
+	seaudit_model_destroy(&m);
+	seaudit_model_destroy(&u);
+	seaudit_model_destroy(&fm);
+	seaudit_log_destroy(&l);
+}
+
+/**
+ * Check that consecutive messages of a model sorted by permission
+ * (descending), then command, then pid (descending) are in order.
+ * Messages that compare equal must remain in the order that they
+ * were logged, given by their inodes.
+ */
+static void model_sort_keys_check(seaudit_log_t * l, seaudit_model_t * m, size_t num_avcs, size_t num_bools)
+{
+	apol_vector_t *v = seaudit_model_get_messages(l, m);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+	CU_ASSERT_FATAL(apol_vector_get_size(v) == num_avcs + num_bools);
+	seaudit_message_type_e type;
+	const seaudit_avc_message_t *prev = NULL, *avc;
+	size_t i, j;
+	int compval;
+	for (i = 0; i < num_avcs; i++) {
+		avc = seaudit_message_get_data(apol_vector_get_element(v, i), &type);
+		CU_ASSERT_FATAL(type == SEAUDIT_MESSAGE_TYPE_AVC);
+		if (prev != NULL) {
+			compval = -apol_vector_compare(seaudit_avc_message_get_perm(prev), seaudit_avc_message_get_perm(avc),
+						       model_incremental_strcmp, NULL, &j);
+			if (compval == 0) {
+				compval = strcmp(seaudit_avc_message_get_comm(prev), seaudit_avc_message_get_comm(avc));
+			}
+			if (compval == 0) {
+				compval = (int)seaudit_avc_message_get_pid(avc) - (int)seaudit_avc_message_get_pid(prev);
+			}
+			if (compval == 0) {
+				compval = (int)seaudit_avc_message_get_inode(prev) - (int)seaudit_avc_message_get_inode(avc);
+			}
+			CU_ASSERT(compval <= 0);
+		}
+		prev = avc;
+	}
+	/* messages without permissions come last */
+	for (; i < apol_vector_get_size(v); i++) {
+		seaudit_message_get_data(apol_vector_get_element(v, i), &type);
+		CU_ASSERT(type == SEAUDIT_MESSAGE_TYPE_BOOL);
+	}
+	apol_vector_destroy(&v);
+}
+
+static void model_sort_keys()
+{
+	const char *comms[] = { "cat", "ls", "vi", "cp" };
+	const char *perms[] = { "read", "read write", "write", "getattr read", "getattr" };
+	char line[512];
+	size_t i, num_avcs = 0, num_bools = 0;
+	unsigned int seed = 1;
+	int compact;
+
+	for (compact = 0; compact < 2; compact++) {
+		seaudit_log_t *l = seaudit_log_create(NULL, NULL);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(l);
+		CU_ASSERT(seaudit_log_set_compact(l, compact) == 0);
+		seaudit_model_t *m = seaudit_model_create(NULL, l);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(m);
+		seaudit_sort_t *sort = seaudit_sort_by_permission(-1);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(sort);
+		CU_ASSERT(seaudit_model_append_sort(m, sort) == 0);
+		sort = seaudit_sort_by_command(1);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(sort);
+		CU_ASSERT(seaudit_model_append_sort(m, sort) == 0);
+		sort = seaudit_sort_by_pid(-1);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(sort);
+		CU_ASSERT(seaudit_model_append_sort(m, sort) == 0);
+		seaudit_model_t *u = seaudit_model_create_from_model(m);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(u);
+
+		seed = 1;
+		num_avcs = num_bools = 0;
+		for (i = 0; i < 5000; i++) {
+			seed = seed * 1103515245 + 12345;
+			if (seed % 20 == 0) {
+				snprintf(line, sizeof(line), "Jun 10 10:00:00 host kernel: security: committed booleans { b%u:1 }\n",
+					 seed / 1024 % 10);
+				num_bools++;
+			} else {
+				snprintf(line, sizeof(line), "type=AVC msg=audit(1149940800.000:%zu): avc:  denied  { %s } for  pid=%u "
+					 "comm=\"%s\" ino=%zu scontext=user_u:system_r:user_t:s0 "
+					 "tcontext=system_u:object_r:etc_t:s0 tclass=file\n",
+					 i, perms[seed / 16 % 5], seed / 256 % 50 + 1, comms[seed / 4096 % 4], i + 1);
+				num_avcs++;
+			}
+			CU_ASSERT(seaudit_log_parse_buffer(l, line, strlen(line)) == 0);
+			if (i == 2500) {
+				/* calculate one model partway through, so that its
+				 * remaining messages are merged into it */
+				apol_vector_t *v = seaudit_model_get_messages(l, u);
+				CU_ASSERT_PTR_NOT_NULL_FATAL(v);
+				apol_vector_destroy(&v);
+			}
+		}
+		model_sort_keys_check(l, m, num_avcs, num_bools);
+		model_sort_keys_check(l, u, num_avcs, num_bools);
+		model_incremental_compare(l, u, NULL);
+		seaudit_model_destroy(&m);
+		seaudit_model_destroy(&u);
+		seaudit_log_destroy(&l);
+	}
+}
+
+static void model_batch_refresh()
+{
+	const char *comms[] = { "cat", "ls", "vi" };
+	char line[512];
+	size_t i, k, part;
+	unsigned int seed = 7;
+
+	seaudit_log_t *l = seaudit_log_create(NULL, NULL);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(l);
+	seaudit_model_t *models[4];
+	for (k = 0; k < 4; k++) {
+		models[k] = seaudit_model_create(NULL, l);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(models[k]);
+	}
+	seaudit_sort_t *sort = seaudit_sort_by_command(1);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(sort);
+	CU_ASSERT(seaudit_model_append_sort(models[1], sort) == 0);
+	seaudit_filter_t *filter = seaudit_filter_create(NULL);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(filter);
+	CU_ASSERT(seaudit_filter_set_command(filter, "vi") == 0);
+	CU_ASSERT(seaudit_model_append_filter(models[1], filter) == 0);
+	filter = seaudit_filter_create(NULL);
+	CU_ASSERT_PTR_NOT_NULL_FATAL(filter);
+	CU_ASSERT(seaudit_filter_set_command(filter, "cat") == 0);
+	CU_ASSERT(seaudit_model_append_filter(models[2], filter) == 0);
+	CU_ASSERT(seaudit_model_set_filter_visible(models[2], SEAUDIT_FILTER_VISIBLE_HIDE) == 0);
+
+	for (part = 0; part < 3; part++) {
+		for (i = 0; i < 3000; i++) {
+			seed = seed * 1103515245 + 12345;
+			snprintf(line, sizeof(line), "type=AVC msg=audit(%u.000:%zu): avc:  denied  { read } for  pid=%u comm=\"%s\" "
+				 "scontext=user_u:system_r:user_t:s0 tcontext=system_u:object_r:etc_t:s0 tclass=file\n",
+				 1149940800 + seed / 16 % 259200, part * 3000 + i, seed / 256 % 1000, comms[seed / 4096 % 3]);
+			CU_ASSERT(seaudit_log_parse_buffer(l, line, strlen(line)) == 0);
+		}
+		if (part == 1) {
+			/* models already calculated need only consider the
+			 * appended messages, except for one whose filter
+			 * changed */
+			CU_ASSERT(seaudit_filter_set_command(filter, "ls") == 0);
+		}
+		CU_ASSERT(seaudit_log_refresh_models(l, 4) == 0);
+		for (k = 0; k < 4; k++) {
+			CU_ASSERT(seaudit_model_is_changed(models[k]) != 0);
+			model_incremental_compare(l, models[k], NULL);
+			CU_ASSERT(seaudit_model_is_changed(models[k]) == 0);
+		}
+		/* refreshing models that are up to date does nothing */
+		CU_ASSERT(seaudit_log_refresh_models(l, 4) == 0);
+		for (k = 0; k < 4; k++) {
+			CU_ASSERT(seaudit_model_is_changed(models[k]) == 0);
+		}
+	}
+
+	for (k = 0; k < 4; k++) {
+		seaudit_model_destroy(&models[k]);
+	}
+	seaudit_log_destroy(&l);
+}
+
+/**
+ * Read a report, leaving out the line giving when it was generated.
+ */
+static char *report_stream_read(const char *path)
+{
+	FILE *f = fopen(path, "r");
+	CU_ASSERT_PTR_NOT_NULL_FATAL(f);
+	char *line = NULL, *s = NULL;
+	size_t line_size = 0, len = 0, n;
+	while (getline(&line, &line_size, f) >= 0) {
+		if (strstr(line, "Report generated") != NULL) {
+			continue;
+		}
+		n = strlen(line);
+		s = realloc(s, len + n + 1);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(s);
+		memcpy(s + len, line, n + 1);
+		len += n;
+	}
+	free(line);
+	fclose(f);
+	return s;
+}
+
+static void report_stream()
+{
+	const char *lines[] = {
+		"Jun 12 10:00:00 host kernel: security: committed booleans { a:1,\n",
+		"Jun 12 10:00:00 host kernel: b:0,\n",
+		"Jun 12 10:00:00 host kernel: c:1 }\n",
+		"Jun 12 10:00:01 host2 kernel: security:  3 users, 6 roles, 1331 types, 135 bools\n",
+		"Jun 12 10:00:01 host2 kernel: security:  55 classes, 19919 rules\n",
+		"type=AVC msg=audit(1150000000.123:42): avc:  denied  { read write } for  pid=1 comm=\"cat\" "
+			"scontext=user_u:system_r:user_t:s0 tcontext=system_u:object_r:etc_t:s0 tclass=file\n",
+		"type=AVC msg=audit(1150000000.124:43): avc:  granted  { setenforce } for  pid=2 comm=\"setenforce\" "
+			"scontext=root:system_r:unconfined_t:s0 tcontext=system_u:object_r:security_t:s0 tclass=security\n",
+		"type=AVC msg=audit(1150000000.125:44): avc:  granted  { write } for  pid=3 comm=\"vi\" "
+			"scontext=user_u:system_r:user_t:s0 tcontext=system_u:object_r:etc_t:s0 tclass=file\n",
+		"type=AVC msg=audit(1150000000.126:45): avc:  denied  { read } for  pid=4 bogus "
+			"scontext=user_u:system_r:user_t:s0 tcontext=user_u:system_r:user_t:s0 tclass=process\n"
+	};
+	const size_t num_lines = sizeof(lines) / sizeof(lines[0]);
+	char path[] = "/tmp/seaudit-report-XXXXXX", config[64], view[64], out[64], stream_out[64];
+	size_t bufsize = 0, i;
+	int fd = mkstemp(path), html;
+	CU_ASSERT_FATAL(fd >= 0);
+	close(fd);
+	snprintf(config, sizeof(config), "%s.conf", path);
+	snprintf(view, sizeof(view), "%s.view", path);
+	snprintf(out, sizeof(out), "%s.out", path);
+	snprintf(stream_out, sizeof(stream_out), "%s.stream", path);
+
+	FILE *f = fopen(path, "w");
+	CU_ASSERT_PTR_NOT_NULL_FATAL(f);
+	for (i = 0; bufsize < 1024 * 1024; i++) {
+		const char *line = lines[(i + i / 7) % num_lines];
+		fputs(line, f);
+		bufsize += strlen(line);
+	}
+	fclose(f);
+	seaudit_filter_t *filter = seaudit_filter_create("vi");
+	CU_ASSERT_PTR_NOT_NULL_FATAL(filter);
+	CU_ASSERT(seaudit_filter_set_command(filter, "vi") == 0);
+	CU_ASSERT(seaudit_filter_save_to_file(filter, view) == 0);
+	seaudit_filter_destroy(&filter);
+	f = fopen(config, "w");
+	CU_ASSERT_PTR_NOT_NULL_FATAL(f);
+	fprintf(f, "<?xml version=\"1.0\" ?>\n<seaudit-report title=\"Streamed\">\n"
+		"<standard-section id=\"Statistics\" title=\"Statistics\"/>\n"
+		"<standard-section id=\"PolicyLoads\" title=\"Loads\"/>\n"
+		"<standard-section id=\"EnforcementToggles\" title=\"Toggles\"/>\n"
+		"<standard-section id=\"PolicyBooleans\" title=\"Booleans\"/>\n"
+		"<custom-section title=\"Editors\">\n<view file=\"%s\"/>\n</custom-section>\n"
+		"<standard-section id=\"AllowListing\" title=\"Allows\"/>\n"
+		"<standard-section id=\"DenyListing\" title=\"Denies\"/>\n" "</seaudit-report>\n", view);
+	fclose(f);
+
+	/* a report streamed from two files must match one written from
+	 * two logs that were each parsed beforehand */
+	for (html = 0; html < 2; html++) {
+		seaudit_report_format_e format = (html ? SEAUDIT_REPORT_FORMAT_HTML : SEAUDIT_REPORT_FORMAT_TEXT);
+		seaudit_log_t *l = seaudit_log_create(NULL, NULL), *l2 = seaudit_log_create(NULL, NULL);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(l);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(l2);
+		seaudit_model_t *m = seaudit_model_create(NULL, l);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(m);
+		CU_ASSERT(seaudit_model_append_log(m, l2) == 0);
+		FILE *files[2];
+		for (i = 0; i < 2; i++) {
+			files[i] = fopen(path, "r");
+			CU_ASSERT_PTR_NOT_NULL_FATAL(files[i]);
+			CU_ASSERT(seaudit_log_parse(i ? l2 : l, files[i]) > 0);
+			rewind(files[i]);
+		}
+		seaudit_report_t *r = seaudit_report_create(m);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(r);
+		CU_ASSERT(seaudit_report_set_format(l, r, format) == 0);
+		CU_ASSERT(seaudit_report_set_configuration(l, r, config) == 0);
+		CU_ASSERT(seaudit_report_set_malformed(l, r, 1) == 0);
+		CU_ASSERT(seaudit_report_write(l, r, out) == 0);
+
+		seaudit_log_t *sl = seaudit_log_create(NULL, NULL);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(sl);
+		seaudit_model_t *sm = seaudit_model_create(NULL, sl);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(sm);
+		seaudit_report_t *sr = seaudit_report_create(sm);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(sr);
+		CU_ASSERT(seaudit_report_set_format(sl, sr, format) == 0);
+		CU_ASSERT(seaudit_report_set_configuration(sl, sr, config) == 0);
+		CU_ASSERT(seaudit_report_set_malformed(sl, sr, 1) == 0);
+		CU_ASSERT(seaudit_report_write_stream(sl, sr, files, 2, stream_out) == 0);
+		apol_vector_t *v = seaudit_model_get_messages(sl, sm);
+		CU_ASSERT(v != NULL && apol_vector_get_size(v) == 0);
+		apol_vector_destroy(&v);
+
+		char *expected = report_stream_read(out), *streamed = report_stream_read(stream_out);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(expected);
+		CU_ASSERT_PTR_NOT_NULL_FATAL(streamed);
+		CU_ASSERT(strstr(expected, "setenforce") != NULL && strstr(expected, "bogus") != NULL);
+		CU_ASSERT(strcmp(expected, streamed) == 0);
+		free(expected);
+		free(streamed);
+
+		for (i = 0; i < 2; i++) {
+			fclose(files[i]);
+		}
+		seaudit_report_destroy(&r);
+		seaudit_report_destroy(&sr);
+		seaudit_model_destroy(&m);
+		seaudit_model_destroy(&sm);
+		seaudit_log_destroy(&l);
+		seaudit_log_destroy(&l2);
+		seaudit_log_destroy(&sl);
+	}
+	unlink(path);
+	unlink(config);
+	unlink(view);
+	unlink(out);
+	unlink(stream_out);
+}
+
 CU_TestInfo parse_file_tests[] = {
 	{"FC4 log", parse_file_fc4},
 	{"FC5 log", parse_file_fc5},
 	{"messages-nowarns", parse_file_nowarns},
 	{"messages-warnings", parse_file_warnings},
+	{"buffer of lines", parse_buffer_lines},
+	{"parallel parsing", parse_buffer_parallel},
+	{"compact storage", parse_compact},
+	{"following a log", parse_follow},
+	{"incremental model refresh", model_incremental},
+	{"sort keys", model_sort_keys},
+	{"batched model refresh", model_batch_refresh},
+	{"streamed report", report_stream},
 	CU_TEST_INFO_NULL
 };
 
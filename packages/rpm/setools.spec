@@ -287,6 +287,7 @@ rm -rf ${RPM_BUILD_ROOT}
 %defattr(-,root,root,-)
 %{_bindir}/seinfo
 %{_bindir}/sesearch
+%{_bindir}/seconstraint
 %{_bindir}/indexcon
 %{_bindir}/findcon
 %{_bindir}/replcon
@@ -303,6 +304,7 @@ rm -rf ${RPM_BUILD_ROOT}
 %{_mandir}/man1/replcon.1.gz
 %{_mandir}/man1/sechecker.1.gz
 %{_mandir}/man1/sediff.1.gz
+%{_mandir}/man1/seconstraint.1.gz
 %{_mandir}/man1/seinfo.1.gz
 %{_mandir}/man1/sesearch.1.gz
 %{_mandir}/man8/seaudit-report.8.gz
@@ -47,7 +47,7 @@
 
 enum opts
 {
-	OPT_HTML = 256, OPT_STYLESHEET
+	OPT_HTML = 256, OPT_STYLESHEET, OPT_STREAM
 };
 
 static struct option const longopts[] = {
@@ -55,6 +55,7 @@ static struct option const longopts[] = {
 	{"malformed", no_argument, NULL, 'm'},
 	{"output", required_argument, NULL, 'o'},
 	{"stylesheet", required_argument, NULL, OPT_STYLESHEET},
+	{"stream", no_argument, NULL, OPT_STREAM},
 	{"stdin", no_argument, NULL, 's'},
 	{"config", required_argument, NULL, 'c'},
 	{"help", no_argument, NULL, 'h'},
@@ -89,6 +90,13 @@ static seaudit_report_t *report = NULL;
  */
 static char *outfile = NULL;
 
+/**
+ * If streaming, the log files to read while writing the report;
+ * otherwise NULL, and every log is parsed beforehand.
+ */
+static FILE **stream_files = NULL;
+static size_t num_stream_files = 0;
+
 static void seaudit_report_info_usage(const char *program_name, int brief)
 {
 	printf("Usage: %s [OPTIONS] LOGFILE ...\n\n", program_name);
@@ -101,6 +109,7 @@ static void seaudit_report_info_usage(const char *program_name, int brief)
 	printf("  -m, --malformed          include malformed log messages\n");
 	printf("  -o FILE, --output=FILE   output to FILE\n");
 	printf("  -c FILE, --config=FILE   read configuration from FILE\n");
+	printf("  --stream                 read logs in one pass, with bounded memory\n");
 	printf("  --html                   set output format to HTML\n");
 	printf("  --stylesheet=FILE        HTML style sheet for formatting HTML report\n");
 	printf("                           (ignored if --html is not given)\n");
@@ -113,7 +122,7 @@ static void seaudit_report_info_usage(const char *program_name, int brief)
 static void parse_command_line_args(int argc, char **argv)
 {
 	int optc, i;
-	int do_malformed = 0, do_style = 0, read_stdin = 0;
+	int do_malformed = 0, do_style = 0, read_stdin = 0, do_stream = 0;
 	seaudit_report_format_e format = SEAUDIT_REPORT_FORMAT_TEXT;
 	char *configfile = NULL, *stylesheet = NULL;
 
@@ -140,6 +149,9 @@ static void parse_command_line_args(int argc, char **argv)
 			stylesheet = optarg;
 			do_style = 1;
 			break;
+		case OPT_STREAM:      /* read logs a block at a time */
+			do_stream = 1;
+			break;
 		case 'h':
 			/* display help */
 			seaudit_report_info_usage(argv[0], 0);
@@ -185,7 +197,25 @@ static void parse_command_line_args(int argc, char **argv)
 		if (optind < argc) {
 			fprintf(stderr, "WARNING: %s\n", "Command line filename(s) will be ignored. Reading from stdin.");
 		}
-		if (seaudit_log_parse(first_log, stdin) < 0) {
+	}
+	if (do_stream) {
+		/* Open the logs now, but read them only while writing
+		 * the report */
+		num_stream_files = (read_stdin ? 1 : argc - optind);
+		if ((stream_files = calloc(num_stream_files, sizeof(*stream_files))) == NULL) {
+			fprintf(stderr, "ERROR: %s\n", strerror(errno));
+			exit(-1);
+		}
+		for (i = 0; i < (int)num_stream_files; i++) {
+			if (read_stdin) {
+				stream_files[i] = stdin;
+			} else if ((stream_files[i] = fopen(argv[optind + i], "r")) == NULL) {
+				fprintf(stderr, "ERROR: %s\n", strerror(errno));
+				exit(-1);
+			}
+		}
+	} else if (read_stdin) {
+		if (seaudit_log_parse_file_parallel(first_log, stdin, 0) < 0) {
 			exit(-1);
 		}
 	} else {
@@ -196,7 +226,7 @@ static void parse_command_line_args(int argc, char **argv)
 			fprintf(stderr, "ERROR: %s\n", strerror(errno));
 			exit(-1);
 		}
-		if (seaudit_log_parse(first_log, f) < 0) {
+		if (seaudit_log_parse_file_parallel(first_log, f, 0) < 0) {
 			exit(-1);
 		}
 		fclose(f);
@@ -212,7 +242,7 @@ static void parse_command_line_args(int argc, char **argv)
 				fprintf(stderr, "ERROR: %s\n", strerror(errno));
 				exit(-1);
 			}
-			if (seaudit_log_parse(l, f) < 0) {
+			if (seaudit_log_parse_file_parallel(l, f, 0) < 0) {
 				exit(-1);
 			}
 			fclose(f);
@@ -232,7 +262,17 @@ int main(int argc, char **argv)
 {
 	size_t i;
 	parse_command_line_args(argc, argv);
-	if (seaudit_report_write(first_log, report, outfile) < 0) {
+	if (stream_files != NULL) {
+		if (seaudit_report_write_stream(first_log, report, stream_files, num_stream_files, outfile) < 0) {
+			return -1;
+		}
+		for (i = 0; i < num_stream_files; i++) {
+			if (stream_files[i] != stdin) {
+				fclose(stream_files[i]);
+			}
+		}
+		free(stream_files);
+	} else if (seaudit_report_write(first_log, report, outfile) < 0) {
 		return -1;
 	}
 	seaudit_report_destroy(&report);
@@ -48,7 +48,6 @@ struct seaudit
 	apol_policy_t *policy;
 	apol_policy_path_t *policy_path;
 	seaudit_log_t *log;
-	FILE *file;
 	char *log_path;
 	size_t num_log_messages;
 	const struct tm *first, *last;
@@ -97,12 +96,8 @@ apol_policy_path_t *seaudit_get_policy_path(seaudit_t * s)
 	return s->policy_path;
 }
 
-void seaudit_set_log(seaudit_t * s, seaudit_log_t * log, FILE * f, const char *filename)
+void seaudit_set_log(seaudit_t * s, seaudit_log_t * log, const char *filename)
 {
-	if (s->file != NULL) {
-		fclose(s->file);
-		s->file = NULL;
-	}
 	if (log != NULL) {
 		seaudit_model_t *model = NULL;
 		apol_vector_t *messages = NULL;
@@ -121,7 +116,6 @@ void seaudit_set_log(seaudit_t * s, seaudit_log_t * log, FILE * f, const char *f
 		 * s->log_path */
 		seaudit_log_destroy(&s->log);
 		s->log = log;
-		s->file = f;
 		free(s->log_path);
 		s->log_path = t;
 		s->num_log_messages = apol_vector_get_size(messages);
@@ -146,7 +140,7 @@ void seaudit_set_log(seaudit_t * s, seaudit_log_t * log, FILE * f, const char *f
 
 int seaudit_parse_log(seaudit_t * s)
 {
-	return seaudit_log_parse(s->log, s->file);
+	return seaudit_log_follow_update(s->log);
 }
 
 seaudit_log_t *seaudit_get_log(seaudit_t * s)
@@ -242,9 +236,6 @@ static void seaudit_destroy(seaudit_t ** s)
 	if (s != NULL && *s != NULL) {
 		apol_policy_destroy(&(*s)->policy);
 		seaudit_log_destroy(&(*s)->log);
-		if ((*s)->file != NULL) {
-			fclose((*s)->file);
-		}
 		preferences_destroy(&(*s)->prefs);
 		toplevel_destroy(&(*s)->top);
 		free((*s)->policy_path);
@@ -88,15 +88,15 @@ apol_policy_path_t *seaudit_get_policy_path(seaudit_t * s);
  * @param s seaudit object to modify.
  * @param log New log file for seaudit.  If NULL then seaudit has no
  * log files opened.  Afterwards seaudit takes ownership of the log.
- * @param f File handler that was used to open the log.  Afterwards
- * seaudit takes ownership of this handler.
  * @param filename If log is not NULL, then add this filename to the
  * most recently used files.
  */
-void seaudit_set_log(seaudit_t * s, seaudit_log_t * log, FILE * f, const char *filename);
+void seaudit_set_log(seaudit_t * s, seaudit_log_t * log, const char *filename);
 
 /**
- * Command seaudit to (re)parse its log file.
+ * Command seaudit to parse whatever has been appended to its log file
+ * since the log was last parsed.  The log file is followed across
+ * rotations.
  *
  * @param s seaudit object containing the log.
  *
@@ -490,7 +490,6 @@ void toplevel_destroy(toplevel_t ** top)
 struct log_run_datum
 {
 	toplevel_t *top;
-	FILE *file;
 	const char *filename;
 	seaudit_log_t *log;
 	int result;
@@ -519,6 +518,7 @@ static gboolean toplevel_monitor_log_timer(gpointer data)
 		int retval;
 		gint i = gtk_notebook_get_n_pages(top->notebook) - 1;
 		uint delay;
+		seaudit_log_t *log;
 		retval = seaudit_parse_log(top->s);
 		if (retval < 0) {
 			GtkCheckMenuItem *w;
@@ -528,6 +528,12 @@ static gboolean toplevel_monitor_log_timer(gpointer data)
 			gtk_check_menu_item_set_active(w, 0);
 			return FALSE;
 		}
+		/* filter new messages through every view's model at once,
+		 * rather than once per view */
+		log = toplevel_get_log(top);
+		if (log != NULL && seaudit_log_refresh_models(log, 0) < 0) {
+			toplevel_ERR(top, "Error while monitoring log: %s", strerror(errno));
+		}
 		while (i >= 0) {
 			GtkWidget *child = gtk_notebook_get_nth_page(top->notebook, i);
 			GtkWidget *tab = gtk_notebook_get_tab_label(top->notebook, child);
@@ -574,10 +580,10 @@ static void toplevel_monitor_log(toplevel_t * top)
 
 /**
  * Thread that loads and parses a log file.  It will write to
- * progress_seaudit_handle_func() its status during the load.  Note
- * that the file handle is not closed upon completion; it is left open
- * so that subsequent calls to seaudit_log_parse(), such as
- * forreal-time monitoring.
+ * progress_seaudit_handle_func() its status during the load.  The
+ * log continues to follow the file upon completion, so that
+ * subsequent calls to seaudit_log_follow_update() will read only new
+ * messages, such as for real-time monitoring.
  *
  * @param data Pointer to a struct log_run_datum, for control
  * information.
@@ -586,23 +592,18 @@ static gpointer toplevel_open_log_runner(gpointer data)
 {
 	struct log_run_datum *run = (struct log_run_datum *)data;
 	progress_update(run->top->progress, "Parsing %s", run->filename);
-	if ((run->file = fopen(run->filename, "r")) == NULL) {
-		progress_update(run->top->progress, "Could not open %s for reading.", run->filename);
+	if ((run->log = seaudit_log_create(progress_seaudit_handle_func, run->top->progress)) == NULL) {
+		progress_update(run->top->progress, "%s", strerror(errno));
 		run->result = -1;
 		goto cleanup;
 	}
-	if ((run->log = seaudit_log_create(progress_seaudit_handle_func, run->top->progress)) == NULL) {
-		progress_update(run->top->progress, "%s", strerror(errno));
+	if (seaudit_log_follow(run->log, run->filename) < 0) {
 		run->result = -1;
 		goto cleanup;
 	}
-	run->result = seaudit_log_parse(run->log, run->file);
+	run->result = seaudit_log_follow_update(run->log);
       cleanup:
 	if (run->result < 0) {
-		if (run->file != NULL) {
-			fclose(run->file);
-		}
-		run->file = NULL;
 		seaudit_log_destroy(&run->log);
 		progress_abort(run->top->progress, NULL);
 	} else if (run->result > 0) {
@@ -630,7 +631,7 @@ static void toplevel_destroy_views(toplevel_t * top)
 
 void toplevel_open_log(toplevel_t * top, const char *filename)
 {
-	struct log_run_datum run = { top, NULL, filename, NULL, 0 };
+	struct log_run_datum run = { top, filename, NULL, 0 };
 	int was_monitor_running;
 	GtkCheckMenuItem *w;
 
@@ -654,7 +655,7 @@ void toplevel_open_log(toplevel_t * top, const char *filename)
 
 	toplevel_destroy_views(top);
 	top->next_model_number = 1;
-	seaudit_set_log(top->s, run.log, run.file, filename);
+	seaudit_set_log(top->s, run.log, filename);
 	toplevel_set_recent_logs_submenu(top);
 	toplevel_enable_log_items(top, TRUE);
 	toplevel_add_new_model(top);
@@ -0,0 +1,372 @@
+/**
+ *  @file
+ *  Command line tool to check concrete accesses against a policy's
+ *  constraints and validatetrans statements.
+ *
+ *  @author agent agent@local
+ *
+ *  Copyright (C) 2026 agent
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <config.h>
+
+/* libapol */
+#include <apol/policy.h>
+#include <apol/policy-query.h>
+#include <apol/util.h>
+#include <apol/vector.h>
+
+/* libqpol*/
+#include <qpol/policy.h>
+#include <qpol/util.h>
+
+/* other */
+#include <errno.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <getopt.h>
+#include <string.h>
+#include <stdbool.h>
+
+#define COPYRIGHT_INFO "Copyright (C) 2026 agent"
+
+static struct option const longopts[] = {
+	{"file", required_argument, NULL, 'f'},
+	{"validatetrans", no_argument, NULL, 'v'},
+	{"denied", no_argument, NULL, 'd'},
+	{"threads", required_argument, NULL, 'j'},
+	{"help", no_argument, NULL, 'h'},
+	{"version", no_argument, NULL, 'V'},
+	{NULL, 0, NULL, 0}
+};
+
+typedef struct options
+{
+	char *file;
+	bool validatetrans;
+	bool denied_only;
+	unsigned int num_threads;
+} options_t;
+
+static void usage(const char *program_name, int brief)
+{
+	printf("Usage: %s [OPTIONS] [POLICY ...]\n\n", program_name);
+	if (brief) {
+		printf("\tTry %s --help for more help.\n\n", program_name);
+		return;
+	}
+	printf("Check accesses against the constraints in a SELinux policy.\n\n");
+	printf("OPTIONS:\n");
+	printf("  -f FILE, --file=FILE      read requests from FILE instead of stdin\n");
+	printf("  -v, --validatetrans       check relabels against validatetrans statements\n");
+	printf("  -d, --denied              only print requests that are denied\n");
+	printf("  -j N, --threads=N         evaluate using N threads (default: one per CPU)\n");
+	printf("  -h, --help                print this help text and exit\n");
+	printf("  -V, --version             print version information and exit\n");
+	printf("\n");
+	printf("Each line of input is a request of the form\n");
+	printf("    SCONTEXT TCONTEXT CLASS PERM\n");
+	printf("or with --validatetrans\n");
+	printf("    OLDCONTEXT NEWCONTEXT TASKCONTEXT CLASS\n");
+	printf("Blank lines and lines starting with # are ignored.\n");
+	printf("\n");
+	printf("The default source policy, or if that is unavailable the default binary\n");
+	printf("policy, will be opened if no policy is provided.\n\n");
+}
+
+/**
+ * Parse a context string and resolve its range against the policy.
+ */
+static apol_context_t *parse_context(const apol_policy_t * policy, const char *str)
+{
+	apol_context_t *context = apol_context_create_from_literal(str);
+	if (!context || apol_context_convert(policy, context) < 0) {
+		apol_context_destroy(&context);
+		return NULL;
+	}
+	return context;
+}
+
+/**
+ * Parse a single line of input into a request.
+ *
+ * @return 1 if a request was parsed, 0 if the line holds no request,
+ * or < 0 on error.
+ */
+static int parse_request(const apol_policy_t * policy, const options_t * opt, char *line, apol_constraint_request_t ** r)
+{
+	char *fields[4], *s = line, *tok;
+	apol_context_t *contexts[3] = { NULL, NULL, NULL };
+	size_t num_fields = 0, num_contexts = (opt->validatetrans ? 3 : 2), i;
+	int retval = -1;
+
+	*r = NULL;
+	while ((tok = strtok(s, " \t\r\n")) != NULL && num_fields < 4) {
+		fields[num_fields++] = tok;
+		s = NULL;
+	}
+	if (num_fields == 0 || fields[0][0] == '#')
+		return 0;
+	if (num_fields != 4 || tok != NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	for (i = 0; i < num_contexts; i++) {
+		if (!(contexts[i] = parse_context(policy, fields[i])))
+			goto cleanup;
+	}
+	if (opt->validatetrans)
+		*r = apol_constraint_request_create_validatetrans(policy, contexts[0], contexts[1], contexts[2], fields[3]);
+	else
+		*r = apol_constraint_request_create(policy, contexts[0], contexts[1], fields[2], fields[3]);
+	if (*r)
+		retval = 1;
+      cleanup:
+	for (i = 0; i < num_contexts; i++)
+		apol_context_destroy(&contexts[i]);
+	return retval;
+}
+
+/**
+ * Read every request from a stream, keeping each request's line for
+ * printing its result.
+ */
+static int read_requests(const apol_policy_t * policy, const options_t * opt, FILE * fp, apol_vector_t * requests,
+			 apol_vector_t * lines)
+{
+	char *line = NULL, *copy = NULL;
+	size_t line_sz = 0, lineno = 0;
+	apol_constraint_request_t *r = NULL;
+	int retval = -1, rt;
+
+	while (getline(&line, &line_sz, fp) >= 0) {
+		lineno++;
+		apol_str_trim(line);
+		if (!(copy = strdup(line))) {
+			ERR(policy, "%s", strerror(errno));
+			goto cleanup;
+		}
+		if ((rt = parse_request(policy, opt, line, &r)) < 0) {
+			ERR(policy, "Invalid request on line %zu: %s", lineno, copy);
+			goto cleanup;
+		}
+		if (rt == 0) {
+			free(copy);
+			copy = NULL;
+			continue;
+		}
+		if (apol_vector_append(requests, r) < 0) {
+			ERR(policy, "%s", strerror(errno));
+			goto cleanup;
+		}
+		r = NULL;
+		if (apol_vector_append(lines, copy) < 0) {
+			ERR(policy, "%s", strerror(errno));
+			goto cleanup;
+		}
+		copy = NULL;
+	}
+	retval = 0;
+      cleanup:
+	apol_constraint_request_destroy(&r);
+	free(copy);
+	free(line);
+	return retval;
+}
+
+/**
+ * Print the statement that denied a request: its class, and for a
+ * constraint, the permissions to which it applies.
+ */
+static void print_denier(const apol_policy_t * policy, const apol_constraint_request_t * r)
+{
+	qpol_policy_t *q = apol_policy_get_qpol(policy);
+	const qpol_constraint_t *constraint = apol_constraint_request_get_constraint(r);
+	const qpol_validatetrans_t *validatetrans = apol_constraint_request_get_validatetrans(r);
+	const qpol_class_t *obj_class = NULL;
+	const char *class_name;
+	qpol_iterator_t *iter = NULL;
+	char *perm;
+
+	if (validatetrans) {
+		if (qpol_validatetrans_get_class(q, validatetrans, &obj_class) == 0 &&
+		    qpol_class_get_name(q, obj_class, &class_name) == 0)
+			printf("    by validatetrans %s\n", class_name);
+		return;
+	}
+	if (!constraint || qpol_constraint_get_class(q, constraint, &obj_class) < 0 ||
+	    qpol_class_get_name(q, obj_class, &class_name) < 0 || qpol_constraint_get_perm_iter(q, constraint, &iter) < 0)
+		return;
+	printf("    by constrain %s {", class_name);
+	for (; !qpol_iterator_end(iter); qpol_iterator_next(iter)) {
+		if (qpol_iterator_get_item(iter, (void **)&perm) < 0)
+			break;
+		printf(" %s", perm);
+		free(perm);
+	}
+	printf(" }\n");
+	qpol_iterator_destroy(&iter);
+}
+
+int main(int argc, char **argv)
+{
+	options_t cmd_opts;
+	int optc, rt = 1;
+	char *policy_file = NULL, *end;
+	unsigned long num;
+	size_t i, num_denied = 0;
+	FILE *fp = stdin;
+
+	apol_policy_t *policy = NULL;
+	apol_policy_path_t *pol_path = NULL;
+	apol_vector_t *mod_paths = NULL;
+	apol_policy_path_type_e path_type = APOL_POLICY_PATH_TYPE_MONOLITHIC;
+	apol_constraint_engine_t *engine = NULL;
+	apol_vector_t *requests = NULL, *lines = NULL;
+
+	memset(&cmd_opts, 0, sizeof(cmd_opts));
+	while ((optc = getopt_long(argc, argv, "f:vdj:hV", longopts, NULL)) != -1) {
+		switch (optc) {
+		case 0:
+			break;
+		case 'f':	       /* file */
+			cmd_opts.file = optarg;
+			break;
+		case 'v':	       /* validatetrans */
+			cmd_opts.validatetrans = true;
+			break;
+		case 'd':	       /* denied */
+			cmd_opts.denied_only = true;
+			break;
+		case 'j':	       /* threads */
+			errno = 0;
+			num = strtoul(optarg, &end, 10);
+			if (errno || *end != '\0' || num > 1024) {
+				usage(argv[0], 1);
+				printf("Invalid number of threads for -j (--threads)\n");
+				exit(1);
+			}
+			cmd_opts.num_threads = (unsigned int)num;
+			break;
+		case 'h':	       /* help */
+			usage(argv[0], 0);
+			exit(0);
+		case 'V':	       /* version */
+			printf("seconstraint %s\n%s\n", VERSION, COPYRIGHT_INFO);
+			exit(0);
+		default:
+			usage(argv[0], 1);
+			exit(1);
+		}
+	}
+
+	int pol_opt = QPOL_POLICY_OPTION_NO_NEVERALLOWS | QPOL_POLICY_OPTION_NO_RULES;
+	if (argc - optind < 1) {
+		int found = qpol_default_policy_find(&policy_file);
+		if (found < 0) {
+			fprintf(stderr, "Default policy search failed: %s\n", strerror(errno));
+			exit(1);
+		} else if (found != 0) {
+			fprintf(stderr, "No default policy found.\n");
+			exit(1);
+		}
+		pol_opt |= QPOL_POLICY_OPTION_MATCH_SYSTEM;
+	} else {
+		if ((policy_file = strdup(argv[optind])) == NULL) {
+			fprintf(stderr, "%s\n", strerror(errno));
+			exit(1);
+		}
+		optind++;
+	}
+
+	if (argc - optind > 0) {
+		path_type = APOL_POLICY_PATH_TYPE_MODULAR;
+		if (!(mod_paths = apol_vector_create(NULL))) {
+			ERR(policy, "%s", strerror(ENOMEM));
+			exit(1);
+		}
+		for (; argc - optind; optind++) {
+			if (apol_vector_append(mod_paths, (void *)argv[optind])) {
+				ERR(policy, "Error loading module %s", argv[optind]);
+				apol_vector_destroy(&mod_paths);
+				free(policy_file);
+				exit(1);
+			}
+		}
+	} else if (apol_file_is_policy_path_list(policy_file) > 0) {
+		pol_path = apol_policy_path_create_from_file(policy_file);
+		if (!pol_path) {
+			ERR(policy, "%s", "invalid policy list");
+			free(policy_file);
+			exit(1);
+		}
+	}
+
+	if (!pol_path)
+		pol_path = apol_policy_path_create(path_type, policy_file, mod_paths);
+	if (!pol_path) {
+		ERR(policy, "%s", strerror(ENOMEM));
+		free(policy_file);
+		apol_vector_destroy(&mod_paths);
+		exit(1);
+	}
+	free(policy_file);
+	apol_vector_destroy(&mod_paths);
+
+	policy = apol_policy_create_from_policy_path(pol_path, pol_opt, NULL, NULL);
+	apol_policy_path_destroy(&pol_path);
+	if (!policy) {
+		ERR(policy, "%s", strerror(errno));
+		exit(1);
+	}
+
+	if (cmd_opts.file && !(fp = fopen(cmd_opts.file, "r"))) {
+		ERR(policy, "Could not open %s: %s", cmd_opts.file, strerror(errno));
+		goto cleanup;
+	}
+	if (!(requests = apol_vector_create(apol_constraint_request_free)) || !(lines = apol_vector_create(free))) {
+		ERR(policy, "%s", strerror(errno));
+		goto cleanup;
+	}
+	if (read_requests(policy, &cmd_opts, fp, requests, lines) < 0)
+		goto cleanup;
+	if (!(engine = apol_constraint_engine_create(policy)) ||
+	    apol_constraint_engine_check_batch(policy, engine, requests, cmd_opts.num_threads) < 0)
+		goto cleanup;
+
+	for (i = 0; i < apol_vector_get_size(requests); i++) {
+		const apol_constraint_request_t *r = apol_vector_get_element(requests, i);
+		if (apol_constraint_request_get_result(r) == 0) {
+			num_denied++;
+			printf("denied  %s\n", (char *)apol_vector_get_element(lines, i));
+			print_denier(policy, r);
+		} else if (!cmd_opts.denied_only) {
+			printf("allowed %s\n", (char *)apol_vector_get_element(lines, i));
+		}
+	}
+	printf("\n%zu of %zu requests denied.\n", num_denied, apol_vector_get_size(requests));
+	rt = 0;
+
+      cleanup:
+	if (fp && fp != stdin)
+		fclose(fp);
+	apol_constraint_engine_destroy(&engine);
+	apol_vector_destroy(&requests);
+	apol_vector_destroy(&lines);
+	apol_policy_destroy(&policy);
+	return rt;
+}
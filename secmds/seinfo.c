@@ -68,7 +68,7 @@ enum opt_values
 {
 	OPT_SENSITIVITY = 256, OPT_CATEGORY,
 	OPT_INITIALSID, OPT_FS_USE, OPT_GENFSCON,
-	OPT_NETIFCON, OPT_NODECON, OPT_PORTCON, OPT_PROTOCOL,
+	OPT_NETIFCON, OPT_NODECON, OPT_PORTCON, OPT_PROTOCOL, OPT_RESOLVE,
 	OPT_PERMISSIVE, OPT_POLCAP,
 	OPT_ALL, OPT_STATS, OPT_CONSTRAIN
 };
@@ -92,6 +92,7 @@ static struct option const longopts[] = {
 	{"polcap", optional_argument, NULL, OPT_POLCAP},
 	{"portcon", optional_argument, NULL, OPT_PORTCON},
 	{"protocol", required_argument, NULL, OPT_PROTOCOL},
+	{"resolve", no_argument, NULL, OPT_RESOLVE},
 	{"stats", no_argument, NULL, OPT_STATS},
 	{"all", no_argument, NULL, OPT_ALL},
 	{"line-breaks", no_argument, NULL, 'l'},
@@ -135,6 +136,8 @@ void usage(const char *program_name, int brief)
 	printf("  --polcap                         print policy capabilities\n");
 	printf("  --portcon[=PORT]                 print port contexts\n");
 	printf("  --protocol=PROTO                 specify a protocol for portcons\n");
+	printf("  --resolve                        with --portcon=PORT or --nodecon=ADDR, print\n");
+	printf("                                   only the statement the kernel would use\n");
 	printf("  --all                            print all of the above\n");
 	printf("OPTIONS:\n");
 	printf("  -x, --expand                     show more info for specified components\n");
@@ -1123,6 +1126,92 @@ static int print_nodecon(FILE * fp, const char *addr, const apol_policy_t * poli
 	return retval;
 }
 
+/**
+ * Prints the nodecon that the kernel would use to label an address,
+ * that being the first one in the policy to match it.
+ *
+ * @param fp Reference to a file to which to print
+ * @param addr Reference to a textually represented IP address
+ * @param policydb Reference to a policy
+ *
+ * @return 0 on success, > 0 if no nodecon matches, < 0 on error.
+ */
+static int resolve_nodecon(FILE * fp, const char *addr, const apol_policy_t * policydb)
+{
+	int protocol;
+	uint32_t address[4] = { 0, 0, 0, 0 };
+	const qpol_nodecon_t *nodecon = NULL;
+	char *tmp = NULL;
+
+	protocol = apol_str_to_internal_ip(addr, address);
+	if (protocol < 0) {
+		ERR(policydb, "%s", "Unable to parse IP address");
+		return -1;
+	}
+	if (apol_nodecon_resolve(policydb, address, protocol, &nodecon))
+		return -1;
+	if (!nodecon) {
+		ERR(policydb, "No matching nodecon for address %s.", addr);
+		return 1;
+	}
+	if (!(tmp = apol_nodecon_render(policydb, nodecon)))
+		return -1;
+	fprintf(fp, "   %s\n", tmp);
+	free(tmp);
+	return 0;
+}
+
+/**
+ * Prints the portcon that the kernel would use to label a port, that
+ * being the first one in the policy to match it.
+ *
+ * @param fp Reference to a file to which to print
+ * @param num Reference to a port number
+ * @param protocol Reference to the name of the port's protocol; if
+ * NULL, resolve the port for both tcp and udp
+ * @param policydb Reference to a policy
+ *
+ * @return 0 on success, > 0 if no portcon matches, < 0 on error.
+ */
+static int resolve_portcon(FILE * fp, const char *num, const char *protocol, const apol_policy_t * policydb)
+{
+	const qpol_portcon_t *portcon = NULL;
+	const char *proto_names[] = { "tcp", "udp" };
+	const int protos[] = { IPPROTO_TCP, IPPROTO_UDP };
+	char *end = NULL, *tmp = NULL;
+	long port;
+	size_t i;
+	int found = 0;
+
+	port = strtol(num, &end, 10);
+	if (*num == '\0' || *end != '\0' || port < 0 || port > UINT16_MAX) {
+		ERR(policydb, "Invalid port number %s.", num);
+		return -1;
+	}
+	if (protocol && strcmp(protocol, "tcp") && strcmp(protocol, "udp")) {
+		ERR(policydb, "Unable to get portcon by protocol: bad protocol %s.", protocol);
+		return -1;
+	}
+	for (i = 0; i < sizeof(protos) / sizeof(protos[0]); i++) {
+		if (protocol && strcmp(protocol, proto_names[i]))
+			continue;
+		if (apol_portcon_resolve(policydb, protos[i], (uint16_t) port, &portcon))
+			return -1;
+		if (!portcon)
+			continue;
+		if (!(tmp = apol_portcon_render(policydb, portcon)))
+			return -1;
+		fprintf(fp, "   %s\n", tmp);
+		free(tmp);
+		found = 1;
+	}
+	if (!found) {
+		ERR(policydb, "No matching portcon for port %s.", num);
+		return 1;
+	}
+	return 0;
+}
+
 /**
  * Prints statistics regarding a policy's portcons.
  * If this function is given a name, it will attempt to
@@ -1665,7 +1754,7 @@ int main(int argc, char **argv)
 {
 	int rc = 0;
 	int classes, types, attribs, roles, users, all, expand, stats, rt, optc, isids, bools, sens, cats, fsuse, genfs, netif,
-		node, port, permissives, polcaps, constrain, linebreaks;
+		node, port, permissives, polcaps, constrain, linebreaks, resolve;
 	apol_policy_t *policydb = NULL;
 	apol_policy_path_t *pol_path = NULL;
 	apol_vector_t *mod_paths = NULL;
@@ -1677,7 +1766,7 @@ int main(int argc, char **argv)
 	class_name = type_name = attrib_name = role_name = user_name = isid_name = bool_name = sens_name = cat_name = fsuse_type =
 		genfs_type = netif_name = node_addr = port_num = permissive_name = polcap_name = NULL;
 	classes = types = attribs = roles = users = all = expand = stats = isids = bools = sens = cats = fsuse = genfs = netif =
-		node = port = permissives = polcaps = constrain = linebreaks = 0;
+		node = port = permissives = polcaps = constrain = linebreaks = resolve = 0;
 	while ((optc = getopt_long(argc, argv, "c::t::a::r::u::b::lxhV", longopts, NULL)) != -1) {
 		switch (optc) {
 		case 0:
@@ -1766,6 +1855,9 @@ int main(int argc, char **argv)
 			if (optarg != 0)
 				protocol = optarg;
 			break;
+		case OPT_RESOLVE:
+			resolve = 1;
+			break;
 		case OPT_ALL:
 			all = 1;
 			break;
@@ -1798,6 +1890,10 @@ int main(int argc, char **argv)
 		fprintf(stderr, "The --protocol flag requires either --portcon or --ALL.\n");
 		exit(1);
 	}
+	if (resolve && !(port_num || node_addr)) {
+		fprintf(stderr, "The --resolve flag requires either --portcon=PORT or --nodecon=ADDR.\n");
+		exit(1);
+	}
 
 	/* if no options, then show stats */
 	if (classes + types + attribs + roles + users + isids + bools + sens + cats + fsuse + genfs + netif + node + port + permissives + polcaps + constrain + all < 1) {
@@ -1892,9 +1988,13 @@ int main(int argc, char **argv)
 		rc = print_genfscon(stdout, genfs_type, policydb);
 	if (netif || all)
 		rc = print_netifcon(stdout, netif_name, policydb);
-	if (node || all)
+	if ((node || all) && resolve && node_addr)
+		rc = resolve_nodecon(stdout, node_addr, policydb);
+	else if (node || all)
 		rc = print_nodecon(stdout, node_addr, policydb);
-	if (port || all)
+	if ((port || all) && resolve && port_num)
+		rc = resolve_portcon(stdout, port_num, protocol, policydb);
+	else if (port || all)
 		rc = print_portcon(stdout, port_num, protocol, policydb);
 	if (isids || all)
 		rc = print_isids(stdout, isid_name, expand, policydb);
@@ -270,6 +270,7 @@ static void print_syn_av_results(const apol_policy_t * policy, const options_t *
 	const apol_vector_t *syn_list = NULL;
 	const qpol_syn_avrule_t *rule = NULL;
 	char *tmp = NULL, *rule_str = NULL, *expr = NULL;
+	size_t rule_sz = 0;
 	char enable_char = ' ', branch_char = ' ';
 	const qpol_cond_t *cond = NULL;
 	uint32_t enabled = 0, is_true = 0;
@@ -306,7 +307,7 @@ static void print_syn_av_results(const apol_policy_t * policy, const options_t *
 					goto cleanup;
 			}
 		}
-		if (!(rule_str = apol_syn_avrule_render(policy, rule)))
+		if (apol_syn_avrule_render_buf(policy, rule, &rule_str, &rule_sz) < 0)
 			goto cleanup;
 		if (opt->lineno) {
 			if (qpol_syn_avrule_get_lineno(q, rule, &lineno))
@@ -315,8 +316,6 @@ static void print_syn_av_results(const apol_policy_t * policy, const options_t *
 		} else {
 			fprintf(stdout, "%c%c %s %s\n", enable_char, branch_char, rule_str, expr ? expr : "");
 		}
-		free(rule_str);
-		rule_str = NULL;
 		free(expr);
 		expr = NULL;
 	}
@@ -333,6 +332,7 @@ static void print_av_results(const apol_policy_t * policy, const options_t * opt
 	size_t i, num_rules = 0;
 	const qpol_avrule_t *rule = NULL;
 	char *tmp = NULL, *rule_str = NULL, *expr = NULL;
+	size_t rule_sz = 0;
 	char enable_char = ' ', branch_char = ' ';
 	qpol_iterator_t *iter = NULL;
 	const qpol_cond_t *cond = NULL;
@@ -372,11 +372,9 @@ static void print_av_results(const apol_policy_t * policy, const options_t * opt
 					goto cleanup;
 			}
 		}
-		if (!(rule_str = apol_avrule_render(policy, rule)))
+		if (apol_avrule_render_buf(policy, rule, &rule_str, &rule_sz) < 0)
 			goto cleanup;
 		fprintf(stdout, "%c%c %s %s\n", enable_char, branch_char, rule_str, expr ? expr : "");
-		free(rule_str);
-		rule_str = NULL;
 		free(expr);
 		expr = NULL;
 	}
@@ -536,6 +534,7 @@ static void print_te_results(const apol_policy_t * policy, const options_t * opt
 	size_t i, num_rules = 0;
 	const qpol_terule_t *rule = NULL;
 	char *tmp = NULL, *rule_str = NULL, *expr = NULL;
+	size_t rule_sz = 0;
 	char enable_char = ' ', branch_char = ' ';
 	qpol_iterator_t *iter = NULL;
 	const qpol_cond_t *cond = NULL;
@@ -577,11 +576,9 @@ static void print_te_results(const apol_policy_t * policy, const options_t * opt
 					goto cleanup;
 			}
 		}
-		if (!(rule_str = apol_terule_render(policy, rule)))
+		if (apol_terule_render_buf(policy, rule, &rule_str, &rule_sz) < 0)
 			goto cleanup;
 		fprintf(stdout, "%c%c %s %s\n", enable_char, branch_char, rule_str, expr ? expr : "");
-		free(rule_str);
-		rule_str = NULL;
 		free(expr);
 		expr = NULL;
 	}